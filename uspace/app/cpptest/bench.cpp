@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <execution>
+#include <flat_hash_map>
+#include <map>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t int_keys{100'000};
+    constexpr std::size_t string_keys{20'000};
+    constexpr std::size_t parallel_elements{2'000'000};
+    constexpr std::size_t sort_elements{200'000};
+
+    std::uint64_t next_random(std::uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+        return state >> 11;
+    }
+
+    template<class F>
+    unsigned long long measure_usecs(F&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+
+        return static_cast<unsigned long long>(
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+        );
+    }
+
+    /**
+     * Inserts all keys, looks them up, looks up keys that
+     * are not in the map and then erases everything.
+     */
+    template<class Map>
+    void bench_map(const char* name, const std::vector<typename Map::key_type>& keys,
+                   const std::vector<typename Map::key_type>& misses)
+    {
+        Map map{};
+        std::size_t found{};
+
+        auto insert = measure_usecs([&](){
+            for (const auto& key: keys)
+                map[key] = found;
+        });
+
+        auto hit = measure_usecs([&](){
+            for (const auto& key: keys)
+            {
+                if (map.find(key) != map.end())
+                    ++found;
+            }
+        });
+
+        auto miss = measure_usecs([&](){
+            for (const auto& key: misses)
+            {
+                if (map.find(key) != map.end())
+                    ++found;
+            }
+        });
+
+        auto erase = measure_usecs([&](){
+            for (const auto& key: keys)
+                map.erase(key);
+        });
+
+        std::printf(
+            "%-36s insert %8llu us, hit %8llu us, miss %8llu us, erase %8llu us (%zu)\n",
+            name, insert, hit, miss, erase, found
+        );
+    }
+
+    /**
+     * Builds a map from sorted keys with the range constructor,
+     * with hinted inserts at the end and with plain inserts.
+     */
+    void bench_sorted_build(const std::vector<std::uint64_t>& keys)
+    {
+        std::vector<std::pair<std::uint64_t, std::size_t>> values{};
+        for (const auto& key: keys)
+            values.emplace_back(key, values.size());
+        std::sort(values.begin(), values.end());
+
+        std::size_t size{};
+        auto range = measure_usecs([&](){
+            std::map<std::uint64_t, std::size_t> map{values.begin(), values.end()};
+            size += map.size();
+        });
+
+        auto hinted = measure_usecs([&](){
+            std::map<std::uint64_t, std::size_t> map{};
+            for (const auto& val: values)
+                map.emplace_hint(map.end(), val);
+            size += map.size();
+        });
+
+        auto plain = measure_usecs([&](){
+            std::map<std::uint64_t, std::size_t> map{};
+            for (const auto& val: values)
+                map.emplace(val);
+            size += map.size();
+        });
+
+        std::printf(
+            "%-36s range %8llu us, hinted %8llu us, plain %8llu us (%zu)\n",
+            "sorted map<uint64_t, size_t> build", range, hinted, plain, size
+        );
+    }
+
+    /**
+     * Fills data with one of the common input patterns
+     * of sorting algorithms.
+     */
+    void fill_sort_pattern(std::vector<std::uint64_t>& data, std::size_t pattern,
+                           std::uint64_t& state)
+    {
+        auto count = data.size();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            switch (pattern)
+            {
+                case 0:
+                    data[i] = next_random(state);
+                    break;
+                case 1:
+                    data[i] = i;
+                    break;
+                case 2:
+                    data[i] = count - i;
+                    break;
+                case 3:
+                    data[i] = (i < count / 2) ? i : count - i;
+                    break;
+                default:
+                    data[i] = next_random(state) % 16;
+                    break;
+            }
+        }
+    }
+
+    /**
+     * Times the sorting algorithms on each input pattern,
+     * every run works on a fresh copy of the input.
+     */
+    void bench_sorting(std::uint64_t& state)
+    {
+        const char* patterns[] = {
+            "random", "sorted", "reversed", "organ pipe", "few unique"
+        };
+
+        std::printf("%zu uint64_t elements:\n", sort_elements);
+
+        std::vector<std::uint64_t> data(sort_elements);
+        std::size_t failed{};
+        for (std::size_t pattern = 0; pattern < 5; ++pattern)
+        {
+            fill_sort_pattern(data, pattern, state);
+            auto mid = sort_elements / 2;
+            auto head = sort_elements / 10;
+
+            auto copy = data;
+            auto sort = measure_usecs([&](){
+                std::sort(copy.begin(), copy.end());
+            });
+            failed += !std::is_sorted(copy.begin(), copy.end());
+
+            copy = data;
+            auto stable = measure_usecs([&](){
+                std::stable_sort(copy.begin(), copy.end());
+            });
+            failed += !std::is_sorted(copy.begin(), copy.end());
+
+            copy = data;
+            auto partial = measure_usecs([&](){
+                std::partial_sort(copy.begin(), copy.begin() + head, copy.end());
+            });
+            failed += !std::is_sorted(copy.begin(), copy.begin() + head);
+
+            copy = data;
+            auto nth = measure_usecs([&](){
+                std::nth_element(copy.begin(), copy.begin() + mid, copy.end());
+            });
+            failed += std::any_of(copy.begin(), copy.begin() + mid, [&](auto x){
+                return x > copy[mid];
+            });
+
+            copy = data;
+            auto heap = measure_usecs([&](){
+                std::make_heap(copy.begin(), copy.end());
+                std::sort_heap(copy.begin(), copy.end());
+            });
+            failed += !std::is_sorted(copy.begin(), copy.end());
+
+            std::printf(
+                "%-12s sort %7llu us, stable_sort %7llu us, partial_sort %7llu us, "
+                "nth_element %7llu us, heapsort %7llu us\n",
+                patterns[pattern], sort, stable, partial, nth, heap
+            );
+        }
+
+        if (failed > 0)
+            std::printf("%zu sorting results were wrong!\n", failed);
+    }
+
+    /**
+     * Runs the same work with the sequential and the parallel
+     * policy, the ratio shows how the algorithm scales with
+     * the number of CPUs.
+     */
+    template<class F>
+    void bench_policies(const char* name, F&& f)
+    {
+        auto seq = measure_usecs([&](){ f(std::execution::seq); });
+        auto par = measure_usecs([&](){ f(std::execution::par); });
+
+        std::printf(
+            "%-36s seq %8llu us, par %8llu us, speedup %llu.%02llux\n",
+            name, seq, par, seq / (par ? par : 1), (seq * 100 / (par ? par : 1)) % 100
+        );
+    }
+
+    void bench_parallel(std::uint64_t& state)
+    {
+        std::vector<std::uint64_t> data{};
+        for (std::size_t i = 0; i < parallel_elements; ++i)
+            data.push_back(next_random(state));
+
+        std::printf("%zu uint64_t elements:\n", parallel_elements);
+
+        bench_policies("for_each", [&](const auto& policy){
+            std::for_each(policy, data.begin(), data.end(), [](auto& x){
+                x = x * 6364136223846793005ULL + 1;
+            });
+        });
+
+        std::uint64_t sum{};
+        bench_policies("transform_reduce", [&](const auto& policy){
+            sum += std::transform_reduce(
+                policy, data.begin(), data.end(), data.begin(), std::uint64_t{}
+            );
+        });
+
+        bench_policies("inclusive_scan", [&](const auto& policy){
+            std::vector<std::uint64_t> res(data.size());
+            std::inclusive_scan(policy, data.begin(), data.end(), res.begin());
+            sum += res.back();
+        });
+
+        bench_policies("sort", [&](const auto& policy){
+            auto copy = data;
+            std::sort(policy, copy.begin(), copy.end());
+            sum += copy.front();
+        });
+
+        std::printf("(%llu)\n", static_cast<unsigned long long>(sum));
+    }
+}
+
+void run_benchmarks()
+{
+    std::uint64_t state{42};
+
+    std::vector<std::uint64_t> ints{};
+    std::vector<std::uint64_t> int_misses{};
+    for (std::size_t i = 0; i < int_keys; ++i)
+    {
+        // Keep the lowest bit for the misses.
+        ints.push_back(next_random(state) << 1);
+        int_misses.push_back((next_random(state) << 1) | 1);
+    }
+
+    std::printf("%zu uint64_t keys:\n", int_keys);
+    bench_map<std::unordered_map<std::uint64_t, std::size_t>>(
+        "unordered_map<uint64_t, size_t>", ints, int_misses
+    );
+    bench_map<std::flat_hash_map<std::uint64_t, std::size_t>>(
+        "flat_hash_map<uint64_t, size_t>", ints, int_misses
+    );
+    bench_map<std::map<std::uint64_t, std::size_t>>(
+        "map<uint64_t, size_t>", ints, int_misses
+    );
+    bench_sorted_build(ints);
+
+    std::vector<std::string> strings{};
+    std::vector<std::string> string_misses{};
+    for (std::size_t i = 0; i < string_keys; ++i)
+    {
+        strings.push_back("key-" + std::to_string(next_random(state)));
+        string_misses.push_back("miss-" + std::to_string(next_random(state)));
+    }
+
+    std::printf("%zu string keys:\n", string_keys);
+    bench_map<std::unordered_map<std::string, std::size_t>>(
+        "unordered_map<string, size_t>", strings, string_misses
+    );
+    bench_map<std::flat_hash_map<std::string, std::size_t>>(
+        "flat_hash_map<string, size_t>", strings, string_misses
+    );
+    bench_map<std::map<std::string, std::size_t>>(
+        "map<string, size_t>", strings, string_misses
+    );
+
+    bench_sorting(state);
+    bench_parallel(state);
+}
@@ -27,6 +27,7 @@
  */
 
 #include <__bits/test/tests.hpp>
+#include "bench.hpp"
 
 /* using namespace std::chrono_literals; */
 
@@ -47,10 +48,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <exception>
+#include <execution>
 #include <fstream>
 #include <functional>
 #include <initializer_list>
@@ -63,6 +66,7 @@
 #include <list>
 #include <locale>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <new>
 #include <numeric>
@@ -93,6 +97,8 @@
 #include <complex>
 #include <future>
 #include <shared_mutex>
+#include <flat_hash_map>
+#include <flat_hash_set>
 
 #include <__bits/adt/hash_table.hpp>
 #include <__bits/adt/rbtree.hpp>
@@ -100,8 +106,15 @@
 
 #include <__bits/trycatch.hpp>
 
-int main()
+int main(int argc, char* argv[])
 {
+    if (argc > 1 && std::string{argv[1]} == "--bench")
+    {
+        run_benchmarks();
+
+        return 0;
+    }
+
     std::test::test_set ts{};
     ts.add<std::test::vector_test>();
     ts.add<std::test::string_test>();
@@ -113,13 +126,19 @@ int main()
     ts.add<std::test::set_test>();
     ts.add<std::test::unordered_map_test>();
     ts.add<std::test::unordered_set_test>();
+    ts.add<std::test::flat_hash_test>();
     ts.add<std::test::numeric_test>();
     ts.add<std::test::adaptors_test>();
     ts.add<std::test::memory_test>();
+    ts.add<std::test::memory_resource_test>();
     ts.add<std::test::list_test>();
     ts.add<std::test::ratio_test>();
     ts.add<std::test::functional_test>();
     ts.add<std::test::algorithm_test>();
+    ts.add<std::test::atomic_test>();
+    ts.add<std::test::future_test>();
+    ts.add<std::test::io_test>();
+    ts.add<std::test::parallel_test>();
 
     return ts.run(true) ? 0 : 1;
 }
@@ -36,6 +36,7 @@
 
 #include <errno.h>
 #include <inet/addr.h>
+#include <inttypes.h>
 #include <inet/dnsr.h>
 #include <ipc/services.h>
 #include <loc.h>
@@ -53,6 +54,8 @@ static void print_syntax(void)
 	printf("\t%s get-ns\n", NAME);
 	printf("\t%s set-ns <server-addr>\n", NAME);
 	printf("\t%s unset-ns\n", NAME);
+	printf("\t%s cache\n", NAME);
+	printf("\t%s flush-cache\n", NAME);
 }
 
 static errno_t dnscfg_set_ns(int argc, char *argv[])
@@ -125,6 +128,36 @@ static errno_t dnscfg_print(void)
 	return EOK;
 }
 
+static errno_t dnscfg_cache(void)
+{
+	dnsr_cache_stat_t stat;
+	errno_t rc = dnsr_get_cache_stat(&stat);
+	if (rc != EOK) {
+		printf("%s: Failed getting cache statistics (%s)\n", NAME,
+		    str_error(rc));
+		return rc;
+	}
+
+	printf("Entries: %zu (%zu negative)\n", stat.entries, stat.negative);
+	printf("Hits: %" PRIu64 " (%" PRIu64 " negative)\n", stat.hits +
+	    stat.neg_hits, stat.neg_hits);
+	printf("Misses: %" PRIu64 "\n", stat.misses);
+	printf("Coalesced: %" PRIu64 "\n", stat.coalesced);
+	printf("Prefetches: %" PRIu64 "\n", stat.prefetches);
+	return EOK;
+}
+
+static errno_t dnscfg_flush_cache(void)
+{
+	errno_t rc = dnsr_flush_cache();
+	if (rc != EOK) {
+		printf("%s: Failed flushing cache (%s)\n", NAME, str_error(rc));
+		return rc;
+	}
+
+	return EOK;
+}
+
 int main(int argc, char *argv[])
 {
 	if ((argc < 2) || (str_cmp(argv[1], "get-ns") == 0))
@@ -133,6 +166,10 @@ int main(int argc, char *argv[])
 		return dnscfg_set_ns(argc - 2, argv + 2);
 	else if (str_cmp(argv[1], "unset-ns") == 0)
 		return dnscfg_unset_ns();
+	else if (str_cmp(argv[1], "cache") == 0)
+		return dnscfg_cache();
+	else if (str_cmp(argv[1], "flush-cache") == 0)
+		return dnscfg_flush_cache();
 	else {
 		printf("%s: Unknown command '%s'.\n", NAME, argv[1]);
 		print_syntax();
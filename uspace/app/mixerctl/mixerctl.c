@@ -38,7 +38,9 @@
 #include <str_error.h>
 #include <str.h>
 #include <audio_mixer_iface.h>
+#include <hound/protocol.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #define DEFAULT_SERVICE "devices/\\hw\\pci0\\00:01.0\\sb16\\control"
 
@@ -125,11 +127,57 @@ static void get_level(async_exch_t *exch, int argc, char *argv[])
 	printf("Control item %u level: %u.\n", item, value);
 }
 
+/**
+ * Print playback statistics of all audio sinks known to the audio daemon.
+ * @return Error code.
+ */
+static errno_t print_stats(void)
+{
+	hound_sess_t *sess = hound_service_connect(HOUND_SERVICE);
+	if (!sess) {
+		printf("Failed to connect to the audio service.\n");
+		return ENOENT;
+	}
+
+	char **names = NULL;
+	size_t count = 0;
+	errno_t ret = hound_service_get_list_all(sess, &names, &count,
+	    HOUND_SINK_DEVS);
+	if (ret != EOK) {
+		printf("Failed to get list of sinks: %s.\n", str_error(ret));
+		hound_service_disconnect(sess);
+		return ret;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		hound_stats_t stats;
+		ret = hound_service_get_stats(sess, names[i], &stats);
+		if (ret != EOK) {
+			printf("Failed to get stats of `%s': %s.\n",
+			    names[i], str_error(ret));
+		} else {
+			printf("Sink `%s':\n", names[i]);
+			printf("\tperiod: %" PRIu32 " us, latency: %" PRIu32
+			    " us, max mix time: %" PRIu32 " us\n",
+			    stats.period, stats.latency, stats.mix_time_max);
+			printf("\tdevice xruns: %" PRIu32 ", stream xruns: %"
+			    PRIu32 "\n", stats.xruns, stats.stream_xruns);
+		}
+		free(names[i]);
+	}
+	free(names);
+	hound_service_disconnect(sess);
+	return EOK;
+}
+
 int main(int argc, char *argv[])
 {
 	const char *service = DEFAULT_SERVICE;
 	void (*command)(async_exch_t *, int, char *[]) = NULL;
 
+	if (argc == 2 && str_cmp(argv[1], "stats") == 0)
+		return print_stats() == EOK ? 0 : 1;
+
 	if (argc >= 2 && str_cmp(argv[1], "setlevel") == 0) {
 		command = set_level;
 		if (argc == 5)
@@ -175,6 +223,8 @@ int main(int argc, char *argv[])
 		    "settings\n", argv[0]);
 		printf("Use '%s setlevel idx' command to change "
 		    "settings\n", argv[0]);
+		printf("Use '%s stats' command to show audio playback "
+		    "statistics\n", argv[0]);
 	}
 
 	async_exchange_end(exch);
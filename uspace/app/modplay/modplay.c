@@ -125,7 +125,8 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	format.channels = 1;
+	/* Match the default sink format, hound then mixes us in directly */
+	format.channels = 2;
 	format.sampling_rate = 44100;
 #ifdef __LE__
 	format.sample_format = PCM_SAMPLE_SINT16_LE;
@@ -163,7 +164,8 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	rc = trackmod_modplay_create(mod, format.sampling_rate, &modplay);
+	rc = trackmod_modplay_create(mod, format.sampling_rate,
+	    format.channels, &modplay);
 	if (rc != EOK) {
 		printf("Error setting up playback.\n");
 		return 1;
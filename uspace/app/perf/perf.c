@@ -44,6 +44,7 @@ benchmark_t benchmarks[] = {
 #include "ipc/ping_pong.def"
 #include "malloc/malloc1.def"
 #include "malloc/malloc2.def"
+#include "trackmod/modrender.def"
 	{ NULL, NULL, NULL }
 };
 
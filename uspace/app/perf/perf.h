@@ -47,6 +47,7 @@ typedef struct {
 
 extern const char *bench_malloc1(void);
 extern const char *bench_malloc2(void);
+extern const char *bench_modrender(void);
 extern const char *bench_ns_ping(void);
 extern const char *bench_ping_pong(void);
 
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <trackmod.h>
+#include "../perf.h"
+
+#define MIN_DURATION_SECS  10
+#define NUM_SAMPLES 10
+
+enum {
+	/** Output sampling rate */
+	smp_freq = 44100,
+	/** Output channels */
+	out_channels = 2,
+	/** Frames rendered per call (100 ms) */
+	buf_frames = smp_freq / 10,
+	/** Module channels */
+	mod_channels = 8,
+	/** Pattern rows */
+	mod_rows = 64,
+	/** Sample length in frames */
+	smp_length = 4096
+};
+
+/** Create a sample.
+ *
+ * @param sample    Sample to fill in
+ * @param bytes_smp Bytes per sample
+ * @param loop_type Loop type
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t modrender_sample(trackmod_sample_t *sample, size_t bytes_smp,
+    trackmod_looptype_t loop_type)
+{
+	size_t i;
+
+	sample->data = malloc(smp_length * bytes_smp);
+	if (sample->data == NULL)
+		return ENOMEM;
+
+	/* Decaying sawtooth */
+	for (i = 0; i < smp_length; i++) {
+		int v = (int)(i % 64) * 4 - 128;
+		v = v * (int)(smp_length - i / 2) / smp_length;
+		if (bytes_smp == 1)
+			((int8_t *)sample->data)[i] = v;
+		else
+			((int16_t *)sample->data)[i] = v * 256;
+	}
+
+	sample->length = smp_length;
+	sample->bytes_smp = bytes_smp;
+	sample->loop_type = loop_type;
+	sample->loop_start = smp_length / 2;
+	sample->loop_len = smp_length / 2;
+	sample->def_vol = 48;
+	return EOK;
+}
+
+/** Create a module playing notes on all channels.
+ *
+ * Instruments alternate between 8-bit and 16-bit, looped and
+ * non-looped samples, so that all mixing paths are exercised.
+ *
+ * @param rmodule Place to store pointer to the new module
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t modrender_module(trackmod_module_t **rmodule)
+{
+	trackmod_module_t *module;
+	trackmod_cell_t *cell;
+	size_t row;
+	size_t i;
+	errno_t rc;
+
+	module = trackmod_module_new();
+	if (module == NULL)
+		return ENOMEM;
+
+	module->channels = mod_channels;
+	module->def_bpm = 125;
+	module->def_tpr = 6;
+
+	module->instrs = 2;
+	module->instr = calloc(module->instrs, sizeof(trackmod_instr_t));
+	if (module->instr == NULL)
+		goto error;
+
+	for (i = 0; i < module->instrs; i++) {
+		module->instr[i].sample = calloc(1, sizeof(trackmod_sample_t));
+		if (module->instr[i].sample == NULL)
+			goto error;
+		module->instr[i].samples = 1;
+
+		rc = modrender_sample(module->instr[i].sample, i + 1,
+		    i == 0 ? tl_no_loop : tl_forward_loop);
+		if (rc != EOK)
+			goto error;
+	}
+
+	module->patterns = 1;
+	module->pattern = calloc(1, sizeof(trackmod_pattern_t));
+	if (module->pattern == NULL)
+		goto error;
+
+	module->pattern->rows = mod_rows;
+	module->pattern->channels = mod_channels;
+	module->pattern->data = calloc(mod_rows * mod_channels,
+	    sizeof(trackmod_cell_t));
+	if (module->pattern->data == NULL)
+		goto error;
+
+	for (row = 0; row < mod_rows; row += 2) {
+		for (i = 0; i < mod_channels; i++) {
+			cell = &module->pattern->data[row * mod_channels + i];
+			cell->note = 24 + (row + i * 5) % 36;
+			cell->instr = 1 + (row / 2 + i) % module->instrs;
+		}
+	}
+
+	module->ord_list_len = 1;
+	module->ord_list = calloc(1, sizeof(size_t));
+	if (module->ord_list == NULL)
+		goto error;
+
+	*rmodule = module;
+	return EOK;
+error:
+	trackmod_module_destroy(module);
+	return ENOMEM;
+}
+
+static errno_t modrender_measure(trackmod_module_t *module, void *buffer,
+    uint64_t niter, uint64_t *rduration)
+{
+	trackmod_modplay_t *modplay;
+	struct timespec start;
+	uint64_t count;
+	size_t i;
+	errno_t rc;
+
+	rc = trackmod_modplay_create(module, smp_freq, out_channels, &modplay);
+	if (rc != EOK)
+		return rc;
+
+	getuptime(&start);
+
+	/* One iteration is one second of audio */
+	for (count = 0; count < niter; count++) {
+		for (i = 0; i < smp_freq / buf_frames; i++) {
+			trackmod_modplay_get_samples(modplay, buffer,
+			    buf_frames * modplay->frame_size);
+		}
+	}
+
+	struct timespec now;
+	getuptime(&now);
+
+	trackmod_modplay_destroy(modplay);
+
+	*rduration = ts_sub_diff(&now, &start) / 1000;
+	return EOK;
+}
+
+static void modrender_report(uint64_t niter, uint64_t duration)
+{
+	printf("Rendered %" PRIu64 " seconds of audio in %" PRIu64 " us",
+	    niter, duration);
+
+	if (duration > 0) {
+		printf(", %" PRIu64 " times real time.\n",
+		    niter * 1000 * 1000 / duration);
+	} else {
+		printf(".\n");
+	}
+}
+
+const char *bench_modrender(void)
+{
+	errno_t rc;
+	uint64_t duration;
+	uint64_t dsmp[NUM_SAMPLES];
+	trackmod_module_t *module = NULL;
+	void *buffer = NULL;
+	const char *msg;
+
+	rc = modrender_module(&module);
+	if (rc != EOK) {
+		msg = "Failed creating module.";
+		goto error;
+	}
+
+	buffer = malloc(buf_frames * out_channels * sizeof(int16_t));
+	if (buffer == NULL) {
+		msg = "Failed allocating buffer.";
+		goto error;
+	}
+
+	printf("Warm up and determine work size...\n");
+
+	uint64_t niter = 1;
+
+	while (true) {
+		rc = modrender_measure(module, buffer, niter, &duration);
+		if (rc != EOK) {
+			msg = "Failed.";
+			goto error;
+		}
+
+		modrender_report(niter, duration);
+
+		if (duration >= MIN_DURATION_SECS * 1000000)
+			break;
+
+		niter *= 2;
+	}
+
+	printf("Measure %d samples...\n", NUM_SAMPLES);
+
+	int i;
+
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		rc = modrender_measure(module, buffer, niter, &dsmp[i]);
+		if (rc != EOK) {
+			msg = "Failed.";
+			goto error;
+		}
+
+		modrender_report(niter, dsmp[i]);
+	}
+
+	double sum = 0.0;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		sum += (double)niter / ((double)dsmp[i] / 1000000.0l);
+
+	double avg = sum / NUM_SAMPLES;
+
+	double qd = 0.0;
+	double d;
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		d = (double)niter / ((double)dsmp[i] / 1000000.0l) - avg;
+		qd += d * d;
+	}
+
+	double stddev = qd / (NUM_SAMPLES - 1); // XXX sqrt
+
+	printf("Average: %.0f times real time Std.dev^2: %.0f Samples: %d\n",
+	    avg, stddev, NUM_SAMPLES);
+
+	free(buffer);
+	trackmod_module_destroy(module);
+	return NULL;
+error:
+	free(buffer);
+	if (module != NULL)
+		trackmod_module_destroy(module);
+	return msg;
+}
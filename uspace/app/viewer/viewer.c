@@ -34,14 +34,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <vfs/vfs.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <window.h>
 #include <canvas.h>
 #include <surface.h>
-#include <codec/tga.h>
+#include <image_cache.h>
 #include <task.h>
 #include <str.h>
 
@@ -109,42 +108,10 @@ static void on_keyboard_event(widget_t *widget, void *data)
 
 static bool img_load(const char *fname, surface_t **p_local_surface)
 {
-	int fd;
-	errno_t rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ, &fd);
-	if (rc != EOK)
+	*p_local_surface = image_cache_load(fname, 0, 0, 0);
+	if (*p_local_surface == NULL)
 		return false;
 
-	vfs_stat_t stat;
-	rc = vfs_stat(fd, &stat);
-	if (rc != EOK) {
-		vfs_put(fd);
-		return false;
-	}
-
-	void *tga = malloc(stat.size);
-	if (tga == NULL) {
-		vfs_put(fd);
-		return false;
-	}
-
-	size_t nread;
-	rc = vfs_read(fd, (aoff64_t []) { 0 }, tga, stat.size, &nread);
-	if (rc != EOK || nread != stat.size) {
-		free(tga);
-		vfs_put(fd);
-		return false;
-	}
-
-	vfs_put(fd);
-
-	*p_local_surface = decode_tga(tga, stat.size, 0);
-	if (*p_local_surface == NULL) {
-		free(tga);
-		return false;
-	}
-
-	free(tga);
-
 	surface_get_resolution(*p_local_surface, &img_width, &img_height);
 
 	return true;
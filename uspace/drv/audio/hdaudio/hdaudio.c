@@ -387,16 +387,11 @@ static void hdaudio_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 	if (IPC_GET_ARG3(*icall) != 0) {
 		/* Buffer completed */
 		hda_lock(hda);
-		if (hda->playing) {
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-		} else if (hda->capturing) {
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
+		for (size_t i = 0; i < hda->pcm_events; i++) {
+			if (hda->playing)
+				hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
+			else if (hda->capturing)
+				hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
 		}
 
 		hda_unlock(hda);
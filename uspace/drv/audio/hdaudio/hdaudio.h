@@ -57,6 +57,8 @@ typedef struct hda {
 	struct hda_stream_buffers *pcm_buffers;
 	bool playing;
 	bool capturing;
+	/** Frames played/captured events sent per completed buffer */
+	size_t pcm_events;
 } hda_t;
 
 extern void hda_lock(hda_t *);
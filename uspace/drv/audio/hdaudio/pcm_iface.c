@@ -36,6 +36,7 @@
 #include <audio_pcm_iface.h>
 #include <ddf/log.h>
 #include <errno.h>
+#include <macros.h>
 #include <pcm/sample_format.h>
 #include <stdbool.h>
 
@@ -233,6 +234,28 @@ static errno_t hda_release_buffer(ddf_fun_t *fun)
 	return EOK;
 }
 
+/** Interrupt once every @a frames frames, if the buffer can be split so.
+ *
+ * Otherwise all fragments of a completed buffer are reported at once.
+ */
+static void hda_pcm_set_fragment(hda_t *hda, unsigned frames,
+    unsigned channels, pcm_sample_format_t format)
+{
+	hda->pcm_events = 1;
+	if (frames == 0 || hda->pcm_buffers == NULL)
+		return;
+
+	const size_t fragment = frames *
+	    pcm_sample_format_frame_size(channels, format);
+	if (fragment == 0)
+		return;
+	if (hda_stream_buffers_set_fragment(hda->pcm_buffers, fragment) == EOK)
+		return;
+
+	ddf_msg(LVL_NOTE, "Cannot interrupt every %u frames", frames);
+	hda->pcm_events = max(hda->pcm_buffers->bufsize / fragment, (size_t) 1);
+}
+
 static errno_t hda_start_playback(ddf_fun_t *fun, unsigned frames,
     unsigned channels, unsigned rate, pcm_sample_format_t format)
 {
@@ -252,6 +275,8 @@ static errno_t hda_start_playback(ddf_fun_t *fun, unsigned frames,
 	/* 48 kHz, 16-bits, 1 channel */
 	fmt = (fmt_base_44khz << fmt_base) | (fmt_bits_16 << fmt_bits_l) | 1;
 
+	hda_pcm_set_fragment(hda, frames, channels, format);
+
 	ddf_msg(LVL_NOTE, "hda_start_playback() - create output stream");
 	hda->pcm_stream = hda_stream_create(hda, sdir_output, hda->pcm_buffers,
 	    fmt);
@@ -311,6 +336,8 @@ static errno_t hda_start_capture(ddf_fun_t *fun, unsigned frames, unsigned chann
 	/* 48 kHz, 16-bits, 1 channel */
 	fmt = (fmt_base_44khz << fmt_base) | (fmt_bits_16 << fmt_bits_l) | 1;
 
+	hda_pcm_set_fragment(hda, frames, channels, format);
+
 	ddf_msg(LVL_NOTE, "hda_start_capture() - create input stream");
 	hda->pcm_stream = hda_stream_create(hda, sdir_input, hda->pcm_buffers,
 	    fmt);
@@ -48,6 +48,31 @@
 #include "spec/bdl.h"
 #include "stream.h"
 
+/** Maximum number of Buffer Descriptor List entries */
+#define BDL_MAX_ENTRIES  256
+
+/** Buffer lengths must be a multiple of 128 bytes */
+#define BDL_ALIGN  128
+
+/** Split contiguous buffer into nbuffers BDL entries of bufsize bytes */
+static void hda_stream_buffers_fill(hda_stream_buffers_t *bufs, void *buffer,
+    uintptr_t buffer_phys)
+{
+	size_t i;
+
+	for (i = 0; i < bufs->nbuffers; i++) {
+		bufs->buf[i] = buffer + i * bufs->bufsize;
+		bufs->buf_phys[i] = buffer_phys + i * bufs->bufsize;
+	}
+
+	/* Fill in BDL */
+	for (i = 0; i < bufs->nbuffers; i++) {
+		bufs->bdl[i].address = host2uint64_t_le(bufs->buf_phys[i]);
+		bufs->bdl[i].length = host2uint32_t_le(bufs->bufsize);
+		bufs->bdl[i].flags = BIT_V(uint32_t, bdf_ioc);
+	}
+}
+
 errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 {
 	void *bdl;
@@ -72,7 +97,7 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 	 * it must be within the 32-bit address space.
 	 */
 	bdl = AS_AREA_ANY;
-	rc = dmamem_map_anonymous(bufs->nbuffers * sizeof(hda_buffer_desc_t),
+	rc = dmamem_map_anonymous(BDL_MAX_ENTRIES * sizeof(hda_buffer_desc_t),
 	    hda->ctl->ok64bit ? 0 : DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE,
 	    0, &bufs->bdl_phys, &bdl);
 	if (rc != EOK)
@@ -82,11 +107,11 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 
 	/* Allocate arrays of buffer pointers */
 
-	bufs->buf = calloc(bufs->nbuffers, sizeof(void *));
+	bufs->buf = calloc(BDL_MAX_ENTRIES, sizeof(void *));
 	if (bufs->buf == NULL)
 		goto error;
 
-	bufs->buf_phys = calloc(bufs->nbuffers, sizeof(uintptr_t));
+	bufs->buf_phys = calloc(BDL_MAX_ENTRIES, sizeof(uintptr_t));
 	if (bufs->buf_phys == NULL)
 		goto error;
 
@@ -126,22 +151,13 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 		goto error;
 	}
 
+	hda_stream_buffers_fill(bufs, buffer, buffer_phys);
 	for (i = 0; i < bufs->nbuffers; i++) {
-		bufs->buf[i] = buffer + i * bufs->bufsize;
-		bufs->buf_phys[i] = buffer_phys + i * bufs->bufsize;
-
 		ddf_msg(LVL_NOTE, "Stream buf phys=0x%llx virt=%p",
 		    (long long unsigned)(uintptr_t)bufs->buf[i],
 		    (void *)bufs->buf_phys[i]);
 	}
 
-	/* Fill in BDL */
-	for (i = 0; i < bufs->nbuffers; i++) {
-		bufs->bdl[i].address = host2uint64_t_le(bufs->buf_phys[i]);
-		bufs->bdl[i].length = host2uint32_t_le(bufs->bufsize);
-		bufs->bdl[i].flags = BIT_V(uint32_t, bdf_ioc);
-	}
-
 	*rbufs = bufs;
 	return EOK;
 error:
@@ -149,6 +165,34 @@ error:
 	return ENOMEM;
 }
 
+/** Split stream buffer into entries of the given size.
+ *
+ * The controller interrupts after each entry, so this sets the
+ * period in which the client gets frames played/captured events.
+ *
+ * @param bufs Stream buffers, not used by a running stream
+ * @param fragment Entry size in bytes
+ * @return EOK on success, EINVAL if the buffer can't be split into
+ *         valid entries of that size
+ */
+errno_t hda_stream_buffers_set_fragment(hda_stream_buffers_t *bufs,
+    size_t fragment)
+{
+	const size_t size = bufs->nbuffers * bufs->bufsize;
+
+	if (fragment == 0 || (fragment % BDL_ALIGN) != 0 ||
+	    (size % fragment) != 0 || size / fragment < 2 ||
+	    size / fragment > BDL_MAX_ENTRIES)
+		return EINVAL;
+
+	void *buffer = bufs->buf[0];
+	uintptr_t buffer_phys = bufs->buf_phys[0];
+	bufs->nbuffers = size / fragment;
+	bufs->bufsize = fragment;
+	hda_stream_buffers_fill(bufs, buffer, buffer_phys);
+	return EOK;
+}
+
 void hda_stream_buffers_free(hda_stream_buffers_t *bufs)
 {
 	if (bufs == NULL)
@@ -32,6 +32,8 @@
 #include <stdint.h>
 
 #include <as.h>
+#include <byteorder.h>
+#include <macros.h>
 #include <ddf/driver.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -45,17 +47,26 @@
 
 #define NAME	"virtio-net"
 
-#define VIRTIO_NET_NUM_QUEUES	3
-
-#define RX_QUEUE_1	0
-#define TX_QUEUE_1	1
-#define CT_QUEUE_1	2
-
 #define BUFFER_SIZE	2048
 #define RX_BUF_SIZE	BUFFER_SIZE
 #define TX_BUF_SIZE	BUFFER_SIZE
 #define CT_BUF_SIZE	BUFFER_SIZE
 
+/** How long to wait for the device to process a control command */
+#define CT_TIMEOUT	1000000
+
+#define ETH_TYPE_OFFSET	12
+#define ETH_HDR_SIZE	14
+#define ETH_TYPE_IPV4	0x0800
+#define ETH_TYPE_IPV6	0x86dd
+
+/** Offset and size of the source and destination IPv4 addresses */
+#define IPV4_ADDRS_OFFSET	12
+#define IPV4_ADDRS_SIZE		8
+/** Offset and size of the source and destination IPv6 addresses */
+#define IPV6_ADDRS_OFFSET	8
+#define IPV6_ADDRS_SIZE		32
+
 static ddf_dev_ops_t virtio_net_dev_ops;
 
 static errno_t virtio_net_dev_add(ddf_dev_t *dev);
@@ -69,45 +80,151 @@ static driver_t virtio_net_driver = {
 	.driver_ops = &virtio_net_driver_ops
 };
 
-static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
+/** Reclaim transmit descriptors already used by the device
+ *
+ * Transmit interrupts are kept disabled, so the completed descriptors are
+ * returned to the free list in batches whenever we get to it.
+ */
+static void virtio_net_tx_reclaim(virtio_net_t *virtio_net,
+    virtio_net_queue_pair_t *pair)
 {
-	nic_t *nic = ddf_dev_data_get(dev);
-	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
 
 	uint16_t descno;
 	uint32_t len;
-	while (virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
+	while (virtio_virtq_consume_used(vdev, pair->tx_queue, &descno, &len)) {
+		virtio_free_desc(vdev, pair->tx_queue, &pair->tx_free_head,
+		    descno);
+	}
+}
+
+/** Assemble a received frame
+ *
+ * If VIRTIO_NET_F_MRG_RXBUF has been negotiated, the frame can span several
+ * receive buffers, which are then consumed from the used ring as well. All
+ * consumed buffers are put back into the available ring, but the device is
+ * not notified.
+ *
+ * @param nic         NIC.
+ * @param pair        Virtqueue pair on which the frame was received.
+ * @param descno      First descriptor of the frame.
+ * @param len         Length of data in the first descriptor.
+ *
+ * @return  Received frame or NULL if the frame was dropped.
+ */
+static nic_frame_t *virtio_net_rx_frame(nic_t *nic,
+    virtio_net_queue_pair_t *pair, uint16_t descno, uint32_t len)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	size_t hdr_size = virtio_net->hdr_size;
+
+	uint16_t descs[RX_BUFFERS];
+	uint32_t lens[RX_BUFFERS];
+	unsigned count = 1;
+	nic_frame_t *frame = NULL;
+
+	descs[0] = descno;
+	lens[0] = len;
+
+	if (len <= hdr_size) {
+		ddf_msg(LVL_WARN, "RX data length too short, packet dropped");
+		goto out;
+	}
+
+	unsigned num_buffers = 1;
+	if (hdr_size == sizeof(virtio_net_hdr_t)) {
 		virtio_net_hdr_t *hdr =
-		    (virtio_net_hdr_t *) virtio_net->rx_buf[descno];
-		if (len <= sizeof(*hdr)) {
-			ddf_msg(LVL_WARN,
-			    "RX data length too short, packet dropped");
-			virtio_virtq_produce_available(vdev, RX_QUEUE_1,
-			    descno);
-			continue;
+		    (virtio_net_hdr_t *) pair->rx_buf[descno];
+		num_buffers = uint16_t_le2host(hdr->num_buffers);
+		if (num_buffers < 1 || num_buffers > RX_BUFFERS) {
+			ddf_msg(LVL_WARN, "Bad RX buffer count, packet dropped");
+			goto out;
 		}
+	}
 
-		nic_frame_t *frame = nic_alloc_frame(nic, len - sizeof(*hdr));
-		if (frame) {
-			memcpy(frame->data, &hdr[1], len - sizeof(*hdr));
-			nic_received_frame(nic, frame);
-		} else {
-			ddf_msg(LVL_WARN,
-			    "Cannot allocate RX frame, packet dropped");
-		}
+	size_t size = len - hdr_size;
+	while (count < num_buffers) {
+		if (!virtio_virtq_consume_used(vdev, pair->rx_queue,
+		    &descs[count], &lens[count]))
+			break;
+		size += lens[count++];
+	}
 
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, descno);
+	if (count < num_buffers) {
+		ddf_msg(LVL_WARN, "Incomplete RX frame, packet dropped");
+		goto out;
 	}
 
-	while (virtio_virtq_consume_used(vdev, TX_QUEUE_1, &descno, &len)) {
-		virtio_free_desc(vdev, TX_QUEUE_1, &virtio_net->tx_free_head,
-		    descno);
+	frame = nic_alloc_frame(nic, size);
+	if (!frame) {
+		ddf_msg(LVL_WARN, "Cannot allocate RX frame, packet dropped");
+		goto out;
 	}
-	while (virtio_virtq_consume_used(vdev, CT_QUEUE_1, &descno, &len)) {
-		virtio_free_desc(vdev, CT_QUEUE_1, &virtio_net->ct_free_head,
-		    descno);
+
+	uint8_t *dst = frame->data;
+	memcpy(dst, pair->rx_buf[descs[0]] + hdr_size, lens[0] - hdr_size);
+	dst += lens[0] - hdr_size;
+	for (unsigned i = 1; i < count; i++) {
+		memcpy(dst, pair->rx_buf[descs[i]], lens[i]);
+		dst += lens[i];
+	}
+
+out:
+	for (unsigned i = 0; i < count; i++)
+		virtio_virtq_enqueue_available(vdev, pair->rx_queue, descs[i]);
+	return frame;
+}
+
+static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
+{
+	nic_t *nic = ddf_dev_data_get(dev);
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+
+	/*
+	 * Collect all frames received during this interrupt and pass them up
+	 * the stack as a single batch.
+	 */
+	nic_frame_list_t *frames = nic_alloc_frame_list();
+
+	uint16_t descno;
+	uint32_t len;
+	for (unsigned i = 0; i < virtio_net->num_pairs; i++) {
+		virtio_net_queue_pair_t *pair = &virtio_net->pairs[i];
+
+		do {
+			while (virtio_virtq_consume_used(vdev, pair->rx_queue,
+			    &descno, &len)) {
+				nic_frame_t *frame = virtio_net_rx_frame(nic,
+				    pair, descno, len);
+				if (!frame)
+					continue;
+				if (frames)
+					nic_frame_list_append(frames, frame);
+				else
+					nic_received_frame(nic, frame);
+			}
+
+			/* Return all recycled RX buffers to the device at once */
+			virtio_virtq_notify(vdev, pair->rx_queue);
+		} while (virtio_virtq_irq_enable(vdev, pair->rx_queue, 1));
+
+		virtio_net_tx_reclaim(virtio_net, pair);
 	}
+
+	if (frames)
+		nic_received_frame_list(nic, frames);
+
+	do {
+		while (virtio_virtq_consume_used(vdev, virtio_net->ct_queue,
+		    &descno, &len)) {
+			fibril_mutex_lock(&virtio_net->ct_lock);
+			virtio_net->ct_done = true;
+			fibril_condvar_broadcast(&virtio_net->ct_cv);
+			fibril_mutex_unlock(&virtio_net->ct_lock);
+		}
+	} while (virtio_virtq_irq_enable(vdev, virtio_net->ct_queue, 1));
 }
 
 static errno_t virtio_net_register_interrupt(ddf_dev_t *dev)
@@ -166,6 +283,161 @@ static errno_t virtio_net_register_interrupt(ddf_dev_t *dev)
 	    virtio_net_irq_handler, &irq_code, &virtio_net->irq_handle);
 }
 
+/** Execute a command on the control virtqueue
+ *
+ * @param virtio_net  VIRTIO net device.
+ * @param class       Command class.
+ * @param command     Command within the class.
+ * @param data        Command-specific data.
+ * @param size        Size of @a data.
+ *
+ * @return  EOK if the device acknowledged the command, EIO if it refused it,
+ *          ETIMEOUT if the device did not respond or other error code.
+ */
+static errno_t virtio_net_ctrl_cmd(virtio_net_t *virtio_net, uint8_t class,
+    uint8_t command, const void *data, size_t size)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t queue = virtio_net->ct_queue;
+
+	if (sizeof(virtio_net_ctrl_hdr_t) + size > CT_BUF_SIZE)
+		return EINVAL;
+
+	fibril_mutex_lock(&virtio_net->ct_lock);
+
+	uint16_t cmd_desc = virtio_alloc_desc(vdev, queue,
+	    &virtio_net->ct_free_head);
+	uint16_t ack_desc = virtio_alloc_desc(vdev, queue,
+	    &virtio_net->ct_free_head);
+	if (cmd_desc == (uint16_t) -1U || ack_desc == (uint16_t) -1U) {
+		if (cmd_desc != (uint16_t) -1U) {
+			virtio_free_desc(vdev, queue, &virtio_net->ct_free_head,
+			    cmd_desc);
+		}
+		fibril_mutex_unlock(&virtio_net->ct_lock);
+		return ENOMEM;
+	}
+
+	virtio_net_ctrl_hdr_t *hdr = virtio_net->ct_buf[cmd_desc];
+	hdr->class = class;
+	hdr->command = command;
+	memcpy(&hdr[1], data, size);
+
+	uint8_t *ack = virtio_net->ct_buf[ack_desc];
+	*ack = VIRTIO_NET_ERR;
+
+	/*
+	 * The command is a chain of the device-readable command and the
+	 * device-writable acknowledgement.
+	 */
+	virtio_virtq_desc_set(vdev, queue, cmd_desc,
+	    virtio_net->ct_buf_p[cmd_desc], sizeof(*hdr) + size,
+	    VIRTQ_DESC_F_NEXT, ack_desc);
+	virtio_virtq_desc_set(vdev, queue, ack_desc,
+	    virtio_net->ct_buf_p[ack_desc], sizeof(*ack), VIRTQ_DESC_F_WRITE,
+	    0);
+
+	virtio_net->ct_done = false;
+	virtio_virtq_produce_available(vdev, queue, cmd_desc);
+
+	errno_t rc = EOK;
+	while (!virtio_net->ct_done && rc == EOK) {
+		rc = fibril_condvar_wait_timeout(&virtio_net->ct_cv,
+		    &virtio_net->ct_lock, CT_TIMEOUT);
+	}
+
+	if (rc == EOK) {
+		if (*ack != VIRTIO_NET_OK)
+			rc = EIO;
+		virtio_free_desc(vdev, queue, &virtio_net->ct_free_head,
+		    ack_desc);
+		virtio_free_desc(vdev, queue, &virtio_net->ct_free_head,
+		    cmd_desc);
+	}
+
+	/*
+	 * On timeout, the descriptors still belong to the device and are
+	 * deliberately not returned to the free list.
+	 */
+
+	fibril_mutex_unlock(&virtio_net->ct_lock);
+	return rc;
+}
+
+/** Set up one RX/TX virtqueue pair
+ *
+ * @param virtio_net  VIRTIO net device.
+ * @param pair        Virtqueue pair to set up.
+ * @param index       Index of the pair.
+ *
+ * @return  EOK on success or error code.
+ */
+static errno_t virtio_net_pair_setup(virtio_net_t *virtio_net,
+    virtio_net_queue_pair_t *pair, unsigned index)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+
+	/* Receive queues have even and transmit queues odd indices */
+	pair->rx_queue = 2 * index;
+	pair->tx_queue = 2 * index + 1;
+
+	errno_t rc = virtio_virtq_setup(vdev, pair->rx_queue, RX_BUFFERS);
+	if (rc != EOK)
+		return rc;
+	rc = virtio_virtq_setup(vdev, pair->tx_queue, TX_BUFFERS);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Setup DMA buffers
+	 */
+	rc = virtio_setup_dma_bufs(RX_BUFFERS, RX_BUF_SIZE, false,
+	    pair->rx_buf, pair->rx_buf_p);
+	if (rc != EOK)
+		return rc;
+	rc = virtio_setup_dma_bufs(TX_BUFFERS, TX_BUF_SIZE, true,
+	    pair->tx_buf, pair->tx_buf_p);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Give all RX buffers to the NIC
+	 */
+	for (unsigned i = 0; i < RX_BUFFERS; i++) {
+		/*
+		 * Associtate the buffer with the descriptor, set length and
+		 * flags.
+		 */
+		virtio_virtq_desc_set(vdev, pair->rx_queue, i,
+		    pair->rx_buf_p[i], RX_BUF_SIZE, VIRTQ_DESC_F_WRITE, 0);
+		/*
+		 * Put the set descriptor into the available ring of the RX
+		 * queue.
+		 */
+		virtio_virtq_enqueue_available(vdev, pair->rx_queue, i);
+	}
+	virtio_virtq_notify(vdev, pair->rx_queue);
+
+	/*
+	 * Put all TX buffers on a free list and let the transmit path reclaim
+	 * them instead of taking an interrupt for each sent frame.
+	 */
+	virtio_create_desc_free_list(vdev, pair->tx_queue, TX_BUFFERS,
+	    &pair->tx_free_head);
+	virtio_virtq_irq_disable(vdev, pair->tx_queue);
+
+	return EOK;
+}
+
+static void virtio_net_teardown_bufs(virtio_net_t *virtio_net)
+{
+	for (unsigned i = 0; i < VIRTIO_NET_MAX_QUEUE_PAIRS; i++) {
+		virtio_teardown_dma_bufs(virtio_net->pairs[i].rx_buf);
+		virtio_teardown_dma_bufs(virtio_net->pairs[i].tx_buf);
+	}
+	virtio_teardown_dma_bufs(virtio_net->ct_buf);
+}
+
 static errno_t virtio_net_initialize(ddf_dev_t *dev)
 {
 	nic_t *nic = nic_create_and_bind(dev);
@@ -180,6 +452,9 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 
 	nic_set_specific(nic, virtio_net);
 
+	fibril_mutex_initialize(&virtio_net->ct_lock);
+	fibril_condvar_initialize(&virtio_net->ct_cv);
+
 	errno_t rc = virtio_pci_dev_initialize(dev, &virtio_net->virtio_dev);
 	if (rc != EOK)
 		return rc;
@@ -197,47 +472,52 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 
 	/* Reset the device and negotiate the feature bits */
 	rc = virtio_device_setup_start(vdev,
-	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ);
+	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ,
+	    VIRTIO_NET_F_MQ | VIRTIO_NET_F_MRG_RXBUF | VIRTIO_F_RING_EVENT_IDX);
 	if (rc != EOK)
 		goto fail;
 
 	/* Perform device-specific setup */
+	if (vdev->features & VIRTIO_NET_F_MRG_RXBUF)
+		virtio_net->hdr_size = sizeof(virtio_net_hdr_t);
+	else
+		virtio_net->hdr_size = VIRTIO_NET_HDR_SIZE_LEGACY;
+
+	unsigned max_pairs = 1;
+	if (vdev->features & VIRTIO_NET_F_MQ)
+		max_pairs = pio_read_le16(&netcfg->max_virtqueue_pairs);
 
 	/*
 	 * Discover and configure the virtqueues
+	 *
+	 * The control virtqueue follows all max_pairs RX/TX pairs, even though
+	 * we may end up using only some of them.
 	 */
 	uint16_t num_queues = pio_read_le16(&cfg->num_queues);
-	if (num_queues != VIRTIO_NET_NUM_QUEUES) {
+	if (max_pairs < 1 || num_queues < 2 * max_pairs + 1) {
 		ddf_msg(LVL_NOTE, "Unsupported number of virtqueues: %u",
 		    num_queues);
+		rc = ENOTSUP;
 		goto fail;
 	}
 
+	virtio_net->num_pairs = min(max_pairs, VIRTIO_NET_MAX_QUEUE_PAIRS);
+	virtio_net->ct_queue = 2 * max_pairs;
+
 	vdev->queues = calloc(sizeof(virtq_t), num_queues);
 	if (!vdev->queues) {
 		rc = ENOMEM;
 		goto fail;
 	}
 
-	rc = virtio_virtq_setup(vdev, RX_QUEUE_1, RX_BUFFERS);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_virtq_setup(vdev, TX_QUEUE_1, TX_BUFFERS);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_virtq_setup(vdev, CT_QUEUE_1, CT_BUFFERS);
-	if (rc != EOK)
-		goto fail;
+	for (unsigned i = 0; i < virtio_net->num_pairs; i++) {
+		rc = virtio_net_pair_setup(virtio_net, &virtio_net->pairs[i],
+		    i);
+		if (rc != EOK)
+			goto fail;
+	}
 
-	/*
-	 * Setup DMA buffers
-	 */
-	rc = virtio_setup_dma_bufs(RX_BUFFERS, RX_BUF_SIZE, false,
-	    virtio_net->rx_buf, virtio_net->rx_buf_p);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_setup_dma_bufs(TX_BUFFERS, TX_BUF_SIZE, true,
-	    virtio_net->tx_buf, virtio_net->tx_buf_p);
+	rc = virtio_virtq_setup(vdev, virtio_net->ct_queue, CT_BUFFERS);
 	if (rc != EOK)
 		goto fail;
 	rc = virtio_setup_dma_bufs(CT_BUFFERS, CT_BUF_SIZE, true,
@@ -246,29 +526,9 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/*
-	 * Give all RX buffers to the NIC
+	 * Put all CT buffers on a free list
 	 */
-	for (unsigned i = 0; i < RX_BUFFERS; i++) {
-		/*
-		 * Associtate the buffer with the descriptor, set length and
-		 * flags.
-		 */
-		virtio_virtq_desc_set(vdev, RX_QUEUE_1, i,
-		    virtio_net->rx_buf_p[i], RX_BUF_SIZE, VIRTQ_DESC_F_WRITE,
-		    0);
-		/*
-		 * Put the set descriptor into the available ring of the RX
-		 * queue.
-		 */
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, i);
-	}
-
-	/*
-	 * Put all TX and CT buffers on a free list
-	 */
-	virtio_create_desc_free_list(vdev, TX_QUEUE_1, TX_BUFFERS,
-	    &virtio_net->tx_free_head);
-	virtio_create_desc_free_list(vdev, CT_QUEUE_1, CT_BUFFERS,
+	virtio_create_desc_free_list(vdev, virtio_net->ct_queue, CT_BUFFERS,
 	    &virtio_net->ct_free_head);
 
 	/*
@@ -298,12 +558,30 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 	/* Go live */
 	virtio_device_setup_finalize(vdev);
 
+	/*
+	 * The device starts with a single virtqueue pair and multiqueue has to
+	 * be enabled using the control virtqueue once the device is live.
+	 */
+	if (virtio_net->num_pairs > 1) {
+		virtio_net_ctrl_mq_t mq = {
+			.virtqueue_pairs = host2uint16_t_le(virtio_net->num_pairs)
+		};
+
+		rc = virtio_net_ctrl_cmd(virtio_net, VIRTIO_NET_CTRL_MQ,
+		    VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET, &mq, sizeof(mq));
+		if (rc != EOK) {
+			ddf_msg(LVL_WARN, "Failed to enable multiqueue, using "
+			    "a single virtqueue pair");
+			virtio_net->num_pairs = 1;
+		}
+	}
+
+	ddf_msg(LVL_NOTE, "Using %u virtqueue pair(s)", virtio_net->num_pairs);
+
 	return EOK;
 
 fail:
-	virtio_teardown_dma_bufs(virtio_net->rx_buf);
-	virtio_teardown_dma_bufs(virtio_net->tx_buf);
-	virtio_teardown_dma_bufs(virtio_net->ct_buf);
+	virtio_net_teardown_bufs(virtio_net);
 
 	virtio_device_setup_fail(vdev);
 	virtio_pci_dev_cleanup(vdev);
@@ -315,26 +593,75 @@ static void virtio_net_uninitialize(ddf_dev_t *dev)
 	nic_t *nic = ddf_dev_data_get(dev);
 	virtio_net_t *virtio_net = (virtio_net_t *) nic_get_specific(nic);
 
-	virtio_teardown_dma_bufs(virtio_net->rx_buf);
-	virtio_teardown_dma_bufs(virtio_net->tx_buf);
-	virtio_teardown_dma_bufs(virtio_net->ct_buf);
+	virtio_net_teardown_bufs(virtio_net);
 
 	virtio_device_setup_fail(&virtio_net->virtio_dev);
 	virtio_pci_dev_cleanup(&virtio_net->virtio_dev);
 }
 
+/** Select a virtqueue pair for transmitting a frame
+ *
+ * Frames are distributed among the virtqueue pairs according to a hash of
+ * their IP addresses, so that frames of one flow are never reordered.
+ *
+ * @param virtio_net  VIRTIO net device.
+ * @param frame       Frame data.
+ * @param size        Frame size.
+ *
+ * @return  Virtqueue pair to use.
+ */
+static virtio_net_queue_pair_t *virtio_net_tx_select(virtio_net_t *virtio_net,
+    const uint8_t *frame, size_t size)
+{
+	if (virtio_net->num_pairs == 1 || size < ETH_HDR_SIZE)
+		return &virtio_net->pairs[0];
+
+	uint16_t type = (frame[ETH_TYPE_OFFSET] << 8) |
+	    frame[ETH_TYPE_OFFSET + 1];
+	size_t offset;
+	size_t len;
+
+	switch (type) {
+	case ETH_TYPE_IPV4:
+		offset = ETH_HDR_SIZE + IPV4_ADDRS_OFFSET;
+		len = IPV4_ADDRS_SIZE;
+		break;
+	case ETH_TYPE_IPV6:
+		offset = ETH_HDR_SIZE + IPV6_ADDRS_OFFSET;
+		len = IPV6_ADDRS_SIZE;
+		break;
+	default:
+		return &virtio_net->pairs[0];
+	}
+
+	if (offset + len > size)
+		return &virtio_net->pairs[0];
+
+	uint32_t hash = 0;
+	for (size_t i = 0; i < len; i++)
+		hash = hash * 31 + frame[offset + i];
+
+	return &virtio_net->pairs[hash % virtio_net->num_pairs];
+}
+
 static void virtio_net_send(nic_t *nic, void *data, size_t size)
 {
 	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
 
-	if (size > sizeof(virtio_net) + TX_BUF_SIZE) {
+	if (virtio_net->hdr_size + size > TX_BUF_SIZE) {
 		ddf_msg(LVL_WARN, "TX data too big, frame dropped");
 		return;
 	}
 
-	uint16_t descno = virtio_alloc_desc(vdev, TX_QUEUE_1,
-	    &virtio_net->tx_free_head);
+	virtio_net_queue_pair_t *pair = virtio_net_tx_select(virtio_net, data,
+	    size);
+
+	/* Return descriptors of already transmitted frames to the free list */
+	virtio_net_tx_reclaim(virtio_net, pair);
+
+	uint16_t descno = virtio_alloc_desc(vdev, pair->tx_queue,
+	    &pair->tx_free_head);
 	if (descno == (uint16_t) -1U) {
 		ddf_msg(LVL_WARN, "No TX buffers available, frame dropped");
 		return;
@@ -342,19 +669,19 @@ static void virtio_net_send(nic_t *nic, void *data, size_t size)
 	assert(descno < TX_BUFFERS);
 
 	/* Setup the packed header */
-	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) virtio_net->tx_buf[descno];
-	memset(hdr, 0, sizeof(virtio_net_hdr_t));
+	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) pair->tx_buf[descno];
+	memset(hdr, 0, virtio_net->hdr_size);
 	hdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
 
 	/* Copy packet data into the buffer just past the header */
-	memcpy(&hdr[1], data, size);
+	memcpy(pair->tx_buf[descno] + virtio_net->hdr_size, data, size);
 
 	/*
 	 * Set the descriptor, put it into the virtqueue and notify the device
 	 */
-	virtio_virtq_desc_set(vdev, TX_QUEUE_1, descno,
-	    virtio_net->tx_buf_p[descno], sizeof(virtio_net_hdr_t) + size, 0, 0);
-	virtio_virtq_produce_available(vdev, TX_QUEUE_1, descno);
+	virtio_virtq_desc_set(vdev, pair->tx_queue, descno,
+	    pair->tx_buf_p[descno], virtio_net->hdr_size + size, 0, 0);
+	virtio_virtq_produce_available(vdev, pair->tx_queue, descno);
 }
 
 static errno_t virtio_net_on_multicast_mode_change(nic_t *nic,
@@ -32,19 +32,30 @@
 #include <virtio-pci.h>
 #include <abi/cap.h>
 #include <nic/nic.h>
+#include <fibril_synch.h>
+#include <stddef.h>
 
-#define RX_BUFFERS	8
-#define TX_BUFFERS	8
+#define RX_BUFFERS	64
+#define TX_BUFFERS	64
 #define CT_BUFFERS	4
 
+/** Maximum number of RX/TX virtqueue pairs the driver will use */
+#define VIRTIO_NET_MAX_QUEUE_PAIRS	4
+
 /** Device handles packets with partial checksum. */
 #define VIRTIO_NET_F_CSUM		(1U << 0)
 /** Driver handles packets with partial checksum. */
 #define VIRTIO_NET_F_GUEST_CSUM		(1U << 2)
 /** Device has given MAC address. */
 #define VIRTIO_NET_F_MAC		(1U << 5)
+/** Driver can merge receive buffers. */
+#define VIRTIO_NET_F_MRG_RXBUF		(1U << 15)
+/** Configuration status field is available. */
+#define VIRTIO_NET_F_STATUS		(1U << 16)
 /** Control channel is available */
 #define VIRTIO_NET_F_CTRL_VQ		(1U << 17)
+/** Device supports multiqueue with automatic receive steering. */
+#define VIRTIO_NET_F_MQ			(1U << 22)
 
 #define VIRTIO_NET_HDR_GSO_NONE 0
 typedef struct {
@@ -55,28 +66,78 @@ typedef struct {
 	uint16_t csum_start;
 	uint16_t csum_offset;
 
-	// XXX: QEMU uses the legacy layout for some reason
-#if 0
+	/*
+	 * We do not negotiate VIRTIO_F_VERSION_1, so the device uses the
+	 * legacy header layout in which num_buffers is present only if
+	 * VIRTIO_NET_F_MRG_RXBUF has been negotiated.
+	 */
 	uint16_t num_buffers;
-#endif
 } virtio_net_hdr_t;
 
+/** Size of the header without the num_buffers field */
+#define VIRTIO_NET_HDR_SIZE_LEGACY	offsetof(virtio_net_hdr_t, num_buffers)
+
+/** Control virtqueue command header */
+typedef struct {
+	uint8_t class;
+	uint8_t command;
+} __attribute__((packed)) virtio_net_ctrl_hdr_t;
+
+#define VIRTIO_NET_OK		0
+#define VIRTIO_NET_ERR		1
+
+#define VIRTIO_NET_CTRL_MQ			4
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET		0
+
+typedef struct {
+	uint16_t virtqueue_pairs;
+} virtio_net_ctrl_mq_t;
+
 typedef struct {
 	uint8_t mac[ETH_ADDR];
+	uint16_t status;
+	uint16_t max_virtqueue_pairs;
 } virtio_net_cfg_t;
 
+/** RX/TX virtqueue pair and its DMA buffers */
 typedef struct {
-	virtio_dev_t virtio_dev;
+	/** Index of the receive virtqueue */
+	uint16_t rx_queue;
+	/** Index of the transmit virtqueue */
+	uint16_t tx_queue;
+
 	void *rx_buf[RX_BUFFERS];
 	uintptr_t rx_buf_p[RX_BUFFERS];
 	void *tx_buf[TX_BUFFERS];
 	uintptr_t tx_buf_p[TX_BUFFERS];
-	void *ct_buf[CT_BUFFERS];
-	uintptr_t ct_buf_p[CT_BUFFERS];
 
 	uint16_t tx_free_head;
+} virtio_net_queue_pair_t;
+
+typedef struct {
+	virtio_dev_t virtio_dev;
+
+	/** RX/TX virtqueue pairs in use */
+	virtio_net_queue_pair_t pairs[VIRTIO_NET_MAX_QUEUE_PAIRS];
+	/** Number of virtqueue pairs in use */
+	unsigned num_pairs;
+
+	/** Index of the control virtqueue */
+	uint16_t ct_queue;
+	void *ct_buf[CT_BUFFERS];
+	uintptr_t ct_buf_p[CT_BUFFERS];
 	uint16_t ct_free_head;
 
+	/** Serializes control commands */
+	fibril_mutex_t ct_lock;
+	/** Signalled when the control virtqueue returns a command */
+	fibril_condvar_t ct_cv;
+	/** Set by the interrupt handler when a command completes */
+	bool ct_done;
+
+	/** Size of the virtio_net_hdr_t in use */
+	size_t hdr_size;
+
 	int irq;
 	cap_irq_handle_t irq_handle;
 } virtio_net_t;
@@ -233,6 +233,59 @@ static void inet_ev_recv(ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void inet_ev_recv_batch(ipc_call_t *icall)
+{
+	inet_ev_recv_desc_t *desc;
+	inet_dgram_t dgram;
+	uint8_t *data;
+	size_t size;
+
+	size_t count = IPC_GET_ARG1(*icall);
+	if (count < 1 || count > INET_EV_RECV_BATCH_MAX) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	errno_t rc = async_data_write_accept((void **) &desc, false,
+	    count * sizeof(inet_ev_recv_desc_t),
+	    count * sizeof(inet_ev_recv_desc_t), 0, &size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	rc = async_data_write_accept((void **) &data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		free(desc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	size_t offs = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (desc[i].size > size - offs) {
+			rc = EINVAL;
+			break;
+		}
+
+		dgram.src = desc[i].src;
+		dgram.dest = desc[i].dest;
+		dgram.tos = desc[i].tos;
+		dgram.iplink = desc[i].iplink;
+		dgram.data = data + offs;
+		dgram.size = desc[i].size;
+		offs += desc[i].size;
+
+		errno_t rc1 = inet_ev_ops->recv(&dgram);
+		if (rc1 != EOK)
+			rc = rc1;
+	}
+
+	free(data);
+	free(desc);
+	async_answer_0(icall, rc);
+}
+
 static void inet_cb_conn(ipc_call_t *icall, void *arg)
 {
 	while (true) {
@@ -248,6 +301,9 @@ static void inet_cb_conn(ipc_call_t *icall, void *arg)
 		case INET_EV_RECV:
 			inet_ev_recv(&call);
 			break;
+		case INET_EV_RECV_BATCH:
+			inet_ev_recv_batch(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -33,6 +33,7 @@
 /** @file Internet address parsing and formatting.
  */
 
+#include <adt/hash.h>
 #include <assert.h>
 #include <errno.h>
 #include <inet/addr.h>
@@ -231,6 +232,35 @@ int inet_addr_is_any(const inet_addr_t *addr)
 	    (inet_addr_compare(addr, &inet_addr_any_addr6)));
 }
 
+/** Compute hash of an address.
+ *
+ * Addresses equal according to inet_addr_compare() have equal hashes.
+ *
+ * @param addr Address
+ * @return Hash suitable for use with hash_table_t
+ */
+size_t inet_addr_hash(const inet_addr_t *addr)
+{
+	size_t hash = addr->version;
+
+	switch (addr->version) {
+	case ip_v4:
+		hash = hash_combine(hash, addr->addr);
+		break;
+	case ip_v6:
+		for (size_t i = 0; i < sizeof(addr128_t); i += 4) {
+			hash = hash_combine(hash, ((uint32_t) addr->addr6[i] << 24) |
+			    (addr->addr6[i + 1] << 16) |
+			    (addr->addr6[i + 2] << 8) | addr->addr6[i + 3]);
+		}
+		break;
+	default:
+		break;
+	}
+
+	return hash_mix(hash);
+}
+
 int inet_naddr_compare(const inet_naddr_t *naddr, const inet_addr_t *addr)
 {
 	if (naddr->version != addr->version)
@@ -41,6 +41,7 @@
 #include <io/input.h>
 #include <ipc/input.h>
 #include <stdlib.h>
+#include <time.h>
 
 static void input_cb_conn(ipc_call_t *icall, void *arg);
 
@@ -93,12 +94,14 @@ errno_t input_activate(input_t *input)
 
 static void input_ev_active(input_t *input, ipc_call_t *call)
 {
+	getuptime(&input->ev_time);
 	errno_t rc = input->ev_ops->active(input);
 	async_answer_0(call, rc);
 }
 
 static void input_ev_deactive(input_t *input, ipc_call_t *call)
 {
+	getuptime(&input->ev_time);
 	errno_t rc = input->ev_ops->deactive(input);
 	async_answer_0(call, rc);
 }
@@ -116,6 +119,7 @@ static void input_ev_key(input_t *input, ipc_call_t *call)
 	mods = IPC_GET_ARG3(*call);
 	c = IPC_GET_ARG4(*call);
 
+	getuptime(&input->ev_time);
 	rc = input->ev_ops->key(input, type, key, mods, c);
 	async_answer_0(call, rc);
 }
@@ -129,6 +133,7 @@ static void input_ev_move(input_t *input, ipc_call_t *call)
 	dx = IPC_GET_ARG1(*call);
 	dy = IPC_GET_ARG2(*call);
 
+	getuptime(&input->ev_time);
 	rc = input->ev_ops->move(input, dx, dy);
 	async_answer_0(call, rc);
 }
@@ -146,6 +151,7 @@ static void input_ev_abs_move(input_t *input, ipc_call_t *call)
 	max_x = IPC_GET_ARG3(*call);
 	max_y = IPC_GET_ARG4(*call);
 
+	getuptime(&input->ev_time);
 	rc = input->ev_ops->abs_move(input, x, y, max_x, max_y);
 	async_answer_0(call, rc);
 }
@@ -159,10 +165,81 @@ static void input_ev_button(input_t *input, ipc_call_t *call)
 	bnum = IPC_GET_ARG1(*call);
 	press = IPC_GET_ARG2(*call);
 
+	getuptime(&input->ev_time);
 	rc = input->ev_ops->button(input, bnum, press);
 	async_answer_0(call, rc);
 }
 
+/** Pass one event of a batch to the client
+ *
+ * @param input Input
+ * @param event Event
+ *
+ * @return EOK on success or an error code returned by the client
+ */
+static errno_t input_ev_dispatch(input_t *input,
+    const input_batch_event_t *event)
+{
+	input->ev_time.tv_sec = event->usec / 1000000;
+	input->ev_time.tv_nsec = (event->usec % 1000000) * 1000;
+
+	switch (event->type) {
+	case INPUT_EVENT_ACTIVE:
+		return input->ev_ops->active(input);
+	case INPUT_EVENT_DEACTIVE:
+		return input->ev_ops->deactive(input);
+	case INPUT_EVENT_KEY:
+		return input->ev_ops->key(input, event->arg[0], event->arg[1],
+		    event->arg[2], event->arg[3]);
+	case INPUT_EVENT_MOVE:
+		return input->ev_ops->move(input, (int32_t) event->arg[0],
+		    (int32_t) event->arg[1]);
+	case INPUT_EVENT_ABS_MOVE:
+		return input->ev_ops->abs_move(input, event->arg[0],
+		    event->arg[1], event->arg[2], event->arg[3]);
+	case INPUT_EVENT_BUTTON:
+		return input->ev_ops->button(input, (int32_t) event->arg[0],
+		    (int32_t) event->arg[1]);
+	default:
+		return ENOTSUP;
+	}
+}
+
+static void input_ev_batch(input_t *input, ipc_call_t *call)
+{
+	input_batch_event_t events[INPUT_BATCH_MAX];
+	ipc_call_t data;
+	size_t size;
+
+	if (!async_data_write_receive(&data, &size)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if ((size > sizeof(events)) ||
+	    ((size % sizeof(input_batch_event_t)) != 0)) {
+		async_answer_0(&data, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	errno_t rc = async_data_write_finalize(&data, events, size);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	/* Report the first failure, but do not lose the other events */
+	size_t count = size / sizeof(input_batch_event_t);
+	for (size_t i = 0; i < count; i++) {
+		errno_t erc = input_ev_dispatch(input, &events[i]);
+		if (rc == EOK)
+			rc = erc;
+	}
+
+	async_answer_0(call, rc);
+}
+
 static void input_cb_conn(ipc_call_t *icall, void *arg)
 {
 	input_t *input = (input_t *) arg;
@@ -195,6 +272,9 @@ static void input_cb_conn(ipc_call_t *icall, void *arg)
 		case INPUT_EVENT_BUTTON:
 			input_ev_button(input, &call);
 			break;
+		case INPUT_EVENT_BATCH:
+			input_ev_batch(input, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
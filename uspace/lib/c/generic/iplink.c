@@ -261,6 +261,68 @@ static void iplink_ev_recv(iplink_t *iplink, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void iplink_ev_recv_batch(iplink_t *iplink, ipc_call_t *icall)
+{
+	iplink_ev_recv_desc_t *desc;
+	iplink_recv_sdu_t sdus[IPLINK_EV_RECV_BATCH_MAX];
+	ip_ver_t vers[IPLINK_EV_RECV_BATCH_MAX];
+	uint8_t *data;
+	size_t size;
+
+	size_t count = IPC_GET_ARG1(*icall);
+	if (count < 1 || count > IPLINK_EV_RECV_BATCH_MAX) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	errno_t rc = async_data_write_accept((void **) &desc, false,
+	    count * sizeof(iplink_ev_recv_desc_t),
+	    count * sizeof(iplink_ev_recv_desc_t), 0, &size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	rc = async_data_write_accept((void **) &data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		free(desc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	size_t offs = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (desc[i].size > size - offs) {
+			rc = EINVAL;
+			count = i;
+			break;
+		}
+
+		sdus[i].data = data + offs;
+		sdus[i].size = desc[i].size;
+		vers[i] = (ip_ver_t) desc[i].ver;
+		offs += desc[i].size;
+	}
+
+	if (iplink->ev_ops->recv_batch != NULL) {
+		errno_t rc1 = iplink->ev_ops->recv_batch(iplink, sdus, vers,
+		    count);
+		if (rc1 != EOK)
+			rc = rc1;
+	} else {
+		for (size_t i = 0; i < count; i++) {
+			errno_t rc1 = iplink->ev_ops->recv(iplink, &sdus[i],
+			    vers[i]);
+			if (rc1 != EOK)
+				rc = rc1;
+		}
+	}
+
+	free(data);
+	free(desc);
+	async_answer_0(icall, rc);
+}
+
 static void iplink_ev_change_addr(iplink_t *iplink, ipc_call_t *icall)
 {
 	addr48_t *addr;
@@ -298,6 +360,9 @@ static void iplink_cb_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_EV_CHANGE_ADDR:
 			iplink_ev_change_addr(iplink, &call);
 			break;
+		case IPLINK_EV_RECV_BATCH:
+			iplink_ev_recv_batch(iplink, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
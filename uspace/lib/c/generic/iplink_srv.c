@@ -36,6 +36,7 @@
 
 #include <errno.h>
 #include <ipc/iplink.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <inet/addr.h>
@@ -321,6 +322,74 @@ errno_t iplink_ev_recv(iplink_srv_t *srv, iplink_recv_sdu_t *sdu, ip_ver_t ver)
 	return EOK;
 }
 
+/** Deliver several received SDUs in a single exchange
+ *
+ * The SDUs are copied back to back into one buffer, which is sent after the
+ * array of their descriptions.
+ *
+ * @param srv    IP link server
+ * @param sdus   Array of received SDUs
+ * @param vers   IP versions of the SDUs
+ * @param count  Number of SDUs, at most IPLINK_EV_RECV_BATCH_MAX
+ *
+ * @return EOK on success or an error code
+ */
+errno_t iplink_ev_recv_batch(iplink_srv_t *srv, iplink_recv_sdu_t *sdus,
+    ip_ver_t *vers, size_t count)
+{
+	iplink_ev_recv_desc_t desc[IPLINK_EV_RECV_BATCH_MAX];
+	size_t total = 0;
+
+	if (srv->client_sess == NULL)
+		return EIO;
+
+	if (count > IPLINK_EV_RECV_BATCH_MAX)
+		return EINVAL;
+
+	if (count == 1)
+		return iplink_ev_recv(srv, &sdus[0], vers[0]);
+
+	for (size_t i = 0; i < count; i++) {
+		desc[i].size = sdus[i].size;
+		desc[i].ver = vers[i];
+		total += sdus[i].size;
+	}
+
+	uint8_t *data = malloc(total);
+	if (data == NULL)
+		return ENOMEM;
+
+	uint8_t *dst = data;
+	for (size_t i = 0; i < count; i++) {
+		memcpy(dst, sdus[i].data, sdus[i].size);
+		dst += sdus[i].size;
+	}
+
+	async_exch_t *exch = async_exchange_begin(srv->client_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, IPLINK_EV_RECV_BATCH, count, &answer);
+
+	errno_t rc = async_data_write_start(exch, desc,
+	    count * sizeof(iplink_ev_recv_desc_t));
+	if (rc == EOK)
+		rc = async_data_write_start(exch, data, total);
+	async_exchange_end(exch);
+	free(data);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	return EOK;
+}
+
 errno_t iplink_ev_change_addr(iplink_srv_t *srv, addr48_t *addr)
 {
 	if (srv->client_sess == NULL)
@@ -36,6 +36,7 @@
 #define LIBC_INET_ADDR_H_
 
 #include <errno.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef uint32_t addr32_t;
@@ -107,6 +108,7 @@ extern void inet_naddr_any(inet_naddr_t *);
 
 extern int inet_addr_compare(const inet_addr_t *, const inet_addr_t *);
 extern int inet_addr_is_any(const inet_addr_t *);
+extern size_t inet_addr_hash(const inet_addr_t *);
 
 extern int inet_naddr_compare(const inet_naddr_t *, const inet_addr_t *);
 extern int inet_naddr_compare_mask(const inet_naddr_t *, const inet_addr_t *);
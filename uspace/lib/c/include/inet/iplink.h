@@ -78,6 +78,9 @@ typedef struct {
 
 typedef struct iplink_ev_ops {
 	errno_t (*recv)(iplink_t *, iplink_recv_sdu_t *, ip_ver_t);
+	/** Several SDUs received at once (optional, defaults to @c recv) */
+	errno_t (*recv_batch)(iplink_t *, iplink_recv_sdu_t *, ip_ver_t *,
+	    size_t);
 	errno_t (*change_addr)(iplink_t *, addr48_t);
 } iplink_ev_ops_t;
 
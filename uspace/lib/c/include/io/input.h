@@ -37,6 +37,7 @@
 
 #include <async.h>
 #include <io/kbd_event.h>
+#include <time.h>
 
 struct input_ev_ops;
 
@@ -44,6 +45,8 @@ typedef struct {
 	async_sess_t *sess;
 	struct input_ev_ops *ev_ops;
 	void *user;
+	/** Time of the event being handled (system uptime) */
+	struct timespec ev_time;
 } input_t;
 
 typedef struct input_ev_ops {
@@ -35,6 +35,7 @@
 #ifndef LIBC_IPC_INET_H_
 #define LIBC_IPC_INET_H_
 
+#include <inet/addr.h>
 #include <ipc/common.h>
 
 /** Requests on Inet default port */
@@ -47,9 +48,27 @@ typedef enum {
 
 /** Events on Inet default port */
 typedef enum {
-	INET_EV_RECV = IPC_FIRST_USER_METHOD
+	INET_EV_RECV = IPC_FIRST_USER_METHOD,
+	INET_EV_RECV_BATCH
 } inet_event_t;
 
+/** Maximum number of datagrams delivered by one INET_EV_RECV_BATCH event */
+#define INET_EV_RECV_BATCH_MAX	64
+
+/** Description of one datagram in an INET_EV_RECV_BATCH event */
+typedef struct {
+	/** Source address */
+	inet_addr_t src;
+	/** Destination address */
+	inet_addr_t dest;
+	/** Type of service */
+	sysarg_t tos;
+	/** Local IP link service ID */
+	sysarg_t iplink;
+	/** Datagram size */
+	size_t size;
+} inet_ev_recv_desc_t;
+
 /** Requests on Inet configuration port */
 typedef enum {
 	INETCFG_ADDR_CREATE_STATIC = IPC_FIRST_USER_METHOD,
@@ -36,6 +36,7 @@
 #define LIBC_IPC_INPUT_H_
 
 #include <ipc/common.h>
+#include <stdint.h>
 
 typedef enum {
 	INPUT_ACTIVATE = IPC_FIRST_USER_METHOD
@@ -47,9 +48,27 @@ typedef enum {
 	INPUT_EVENT_KEY,
 	INPUT_EVENT_MOVE,
 	INPUT_EVENT_ABS_MOVE,
-	INPUT_EVENT_BUTTON
+	INPUT_EVENT_BUTTON,
+	INPUT_EVENT_BATCH
 } input_notif_t;
 
+/** Maximum number of events in one INPUT_EVENT_BATCH */
+#define INPUT_BATCH_MAX  64
+
+/** Event delivered as a part of INPUT_EVENT_BATCH
+ *
+ * The arguments are those of the respective single event
+ * notification, signed values are cast to uint32_t.
+ */
+typedef struct {
+	/** Event notification method (input_notif_t) */
+	uint32_t type;
+	/** Event arguments */
+	uint32_t arg[4];
+	/** System uptime when the event occurred (in microseconds) */
+	uint64_t usec;
+} input_batch_event_t;
+
 #endif
 
 /**
@@ -50,8 +50,20 @@ typedef enum {
 typedef enum {
 	IPLINK_EV_RECV = IPC_FIRST_USER_METHOD,
 	IPLINK_EV_CHANGE_ADDR,
+	IPLINK_EV_RECV_BATCH
 } iplink_event_t;
 
+/** Maximum number of SDUs delivered by one IPLINK_EV_RECV_BATCH event */
+#define IPLINK_EV_RECV_BATCH_MAX	64
+
+/** Description of one SDU in an IPLINK_EV_RECV_BATCH event */
+typedef struct {
+	/** SDU size */
+	size_t size;
+	/** IP version (ip_ver_t) */
+	sysarg_t ver;
+} iplink_ev_recv_desc_t;
+
 #endif
 
 /**
@@ -61,30 +61,20 @@ typedef struct {
 	uint32_t size;
 } __attribute__((packed)) gzip_footer_t;
 
-/** Expand GZIP compressed data
- *
- * The routine allocates the output buffer based
- * on the size encoded in the input stream. This
- * effectively limits the size of the uncompressed
- * data to 4 GiB (expanding input streams that actually
- * encode more data will always fail).
+/** Locate the deflate stream in GZIP compressed data
  *
- * So far, no CRC is perfomed.
- *
- * @param[in]  src     Source data buffer.
- * @param[in]  srclen  Source buffer size (bytes).
- * @param[out] dest    Destination data buffer.
- * @param[out] destlen Destination buffer size (bytes).
+ * @param[in]  src        Source data buffer.
+ * @param[in]  srclen     Source buffer size (bytes).
+ * @param[out] pstream        Start of the deflate stream.
+ * @param[out] pstream_length Length of the deflate stream (bytes).
+ * @param[out] size           Uncompressed size stored in the footer.
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code, invalid deflate data,
- *                   invalid compression method or invalid stream.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EINVAL on invalid compression method or invalid stream.
  *
  */
-errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
+static errno_t gzip_parse(void *src, size_t srclen, void **pstream,
+    size_t *pstream_length, size_t *size)
 {
 	gzip_header_t header;
 	gzip_footer_t footer;
@@ -103,7 +93,7 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 	    ((header.flags & (~GZIP_FLAGS_MASK)) != 0))
 		return EINVAL;
 
-	*destlen = uint32_t_le2host(footer.size);
+	*size = uint32_t_le2host(footer.size);
 
 	/* Ignore extra metadata */
 
@@ -167,17 +157,112 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 		stream_length -= 2;
 	}
 
+	*pstream = stream;
+	*pstream_length = stream_length;
+	return EOK;
+}
+
+/** Expand GZIP compressed data
+ *
+ * The routine allocates the output buffer based
+ * on the size encoded in the input stream. This
+ * effectively limits the size of the uncompressed
+ * data to 4 GiB (expanding input streams that actually
+ * encode more data will always fail).
+ *
+ * So far, no CRC is perfomed.
+ *
+ * @param[in]  src     Source data buffer.
+ * @param[in]  srclen  Source buffer size (bytes).
+ * @param[out] dest    Destination data buffer.
+ * @param[out] destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code, invalid deflate data,
+ *                   invalid compression method or invalid stream.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun.
+ *
+ */
+errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
+{
+	void *stream;
+	size_t stream_length;
+
+	errno_t ret = gzip_parse(src, srclen, &stream, &stream_length,
+	    destlen);
+	if (ret != EOK)
+		return ret;
+
 	/* Allocate output buffer and inflate the data */
 
 	*dest = malloc(*destlen);
 	if (*dest == NULL)
 		return ENOMEM;
 
-	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
+	ret = inflate(stream, stream_length, *dest, *destlen);
 	if (ret != EOK) {
-		free(dest);
+		free(*dest);
 		return ret;
 	}
 
 	return EOK;
 }
+
+typedef struct {
+	inflate_sink_t sink;
+	void *arg;
+	size_t left;
+} gzip_sink_t;
+
+static errno_t gzip_sink(void *arg, const void *data, size_t size)
+{
+	gzip_sink_t *gzip = (gzip_sink_t *) arg;
+
+	if (size > gzip->left)
+		return EINVAL;
+
+	gzip->left -= size;
+	return gzip->sink(gzip->arg, data, size);
+}
+
+/** Expand GZIP compressed data into a consumer
+ *
+ * Unlike gzip_expand(), the uncompressed data is never kept in
+ * memory as a whole, it is passed to the consumer piece by piece.
+ *
+ * @param[in] src    Source data buffer.
+ * @param[in] srclen Source buffer size (bytes).
+ * @param[in] sink   Consumer of the uncompressed data.
+ * @param[in] arg    Argument passed to the consumer.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid data or if the size of the uncompressed
+ *                data does not match the size in the footer.
+ * @return Other error codes as gzip_expand() or the consumer.
+ *
+ */
+errno_t gzip_expand_stream(void *src, size_t srclen, inflate_sink_t sink,
+    void *arg)
+{
+	void *stream;
+	size_t stream_length;
+	size_t size;
+
+	errno_t ret = gzip_parse(src, srclen, &stream, &stream_length, &size);
+	if (ret != EOK)
+		return ret;
+
+	gzip_sink_t gzip = {
+		.sink = sink,
+		.arg = arg,
+		.left = size
+	};
+
+	ret = inflate_stream(stream, stream_length, gzip_sink, &gzip);
+	if (ret != EOK)
+		return ret;
+
+	return (gzip.left == 0) ? EOK : EINVAL;
+}
@@ -30,7 +30,9 @@
 #define LIBCOMPRESS_GZIP_H_
 
 #include <stddef.h>
+#include "inflate.h"
 
 extern errno_t gzip_expand(void *, size_t, void **, size_t *);
+extern errno_t gzip_expand_stream(void *, size_t, inflate_sink_t, void *);
 
 #endif
@@ -68,6 +68,7 @@
 #include <stdbool.h>
 #include <errno.h>
 #include <mem.h>
+#include <stdlib.h>
 #include "inflate.h"
 
 /** Maximum bits in the Huffman code */
@@ -87,6 +88,12 @@
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
+/** Maximum distance of a back reference */
+#define MAX_DISTANCE  32768
+
+/** Size of the output window used by inflate_stream() */
+#define STREAM_WINDOW  (4 * MAX_DISTANCE)
+
 /** Check for input buffer overrun condition */
 #define CHECK_OVERRUN(state) \
 	do { \
@@ -102,6 +109,10 @@ typedef struct {
 	size_t destlen;   /**< Output buffer size */
 	size_t destcnt;   /**< Position in the output buffer */
 
+	inflate_sink_t sink;  /**< Consumer of the output (if streaming) */
+	void *sink_arg;       /**< Argument of the consumer */
+	size_t flushed;       /**< Output already passed to the consumer */
+
 	uint8_t *src;     /**< Input buffer */
 	size_t srclen;    /**< Input buffer size */
 	size_t srccnt;    /**< Position in the input buffer */
@@ -258,6 +269,57 @@ static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
 	return ((uint16_t) (val & ((1 << cnt) - 1)));
 }
 
+/** Pass the output not yet seen by the consumer to it
+ *
+ * @param state Inflate state.
+ *
+ * @return EOK on success or an error code returned by the consumer.
+ *
+ */
+static errno_t inflate_flush(inflate_state_t *state)
+{
+	if ((state->sink == NULL) || (state->flushed == state->destcnt))
+		return EOK;
+
+	errno_t ret = state->sink(state->sink_arg,
+	    state->dest + state->flushed, state->destcnt - state->flushed);
+	state->flushed = state->destcnt;
+	return ret;
+}
+
+/** Make room for output data
+ *
+ * When streaming, the output window is flushed to the consumer and
+ * only the last MAX_DISTANCE bytes are kept for back references.
+ *
+ * @param state Inflate state.
+ * @param len   Number of bytes to be written (at most STREAM_WINDOW -
+ *              MAX_DISTANCE when streaming).
+ *
+ * @return EOK on success.
+ * @return ENOMEM on output buffer overrun.
+ * @return Error code returned by the consumer.
+ *
+ */
+static errno_t inflate_reserve(inflate_state_t *state, size_t len)
+{
+	if (state->destcnt + len <= state->destlen)
+		return EOK;
+
+	if (state->sink == NULL)
+		return ENOMEM;
+
+	errno_t ret = inflate_flush(state);
+	if (ret != EOK)
+		return ret;
+
+	memmove(state->dest, state->dest + state->destcnt - MAX_DISTANCE,
+	    MAX_DISTANCE);
+	state->destcnt = MAX_DISTANCE;
+	state->flushed = MAX_DISTANCE;
+	return EOK;
+}
+
 /** Decode `stored' block
  *
  * @param state Inflate state.
@@ -292,14 +354,23 @@ static errno_t inflate_stored(inflate_state_t *state)
 	if (state->srccnt + len > state->srclen)
 		return ELIMIT;
 
-	/* Check output buffer size */
-	if (state->destcnt + len > state->destlen)
-		return ENOMEM;
-
-	/* Copy data */
-	memcpy(state->dest + state->destcnt, state->src + state->srccnt, len);
-	state->srccnt += len;
-	state->destcnt += len;
+	while (len > 0) {
+		size_t chunk = len;
+		if ((state->sink != NULL) && (chunk > MAX_DISTANCE))
+			chunk = MAX_DISTANCE;
+
+		/* Check output buffer size */
+		errno_t ret = inflate_reserve(state, chunk);
+		if (ret != EOK)
+			return ret;
+
+		/* Copy data */
+		memcpy(state->dest + state->destcnt, state->src + state->srccnt,
+		    chunk);
+		state->srccnt += chunk;
+		state->destcnt += chunk;
+		len -= chunk;
+	}
 
 	return EOK;
 }
@@ -439,8 +510,9 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
 
 		if (symbol < 256) {
 			/* Write out literal */
-			if (state->destcnt == state->destlen)
-				return ENOMEM;
+			err = inflate_reserve(state, 1);
+			if (err != EOK)
+				return err;
 
 			state->dest[state->destcnt] = (uint8_t) symbol;
 			state->destcnt++;
@@ -462,8 +534,9 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
 			if (dist > state->destcnt)
 				return ENOENT;
 
-			if (state->destcnt + len > state->destlen)
-				return ENOMEM;
+			err = inflate_reserve(state, len);
+			if (err != EOK)
+				return err;
 
 			while (len > 0) {
 				/* Copy len bytes from distance bytes back */
@@ -611,21 +684,20 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
 }
 
-/** Inflate data
+/** Run the inflate algorithm
  *
  * @param src     Source data buffer.
  * @param srclen  Source buffer size (bytes).
- * @param dest    Destination data buffer.
+ * @param dest    Destination data buffer (the window when streaming).
  * @param destlen Destination buffer size (bytes).
+ * @param sink    Consumer of the output or NULL.
+ * @param arg     Argument passed to the consumer.
  *
- * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code or invalid deflate data.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EOK on success or an error code (see inflate()).
  *
  */
-errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+static errno_t inflate_run(void *src, size_t srclen, void *dest,
+    size_t destlen, inflate_sink_t sink, void *arg)
 {
 	/* Initialize the state */
 	inflate_state_t state;
@@ -634,6 +706,10 @@ errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
 	state.destlen = destlen;
 	state.destcnt = 0;
 
+	state.sink = sink;
+	state.sink_arg = arg;
+	state.flushed = 0;
+
 	state.src = (uint8_t *) src;
 	state.srclen = srclen;
 	state.srccnt = 0;
@@ -670,5 +746,59 @@ errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
 		}
 	} while ((!last) && (ret == 0));
 
+	if (ret == EOK)
+		ret = inflate_flush(&state);
+
+	return ret;
+}
+
+/** Inflate data
+ *
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun.
+ *
+ */
+errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+{
+	return inflate_run(src, srclen, dest, destlen, NULL, NULL);
+}
+
+/** Inflate data into a consumer
+ *
+ * The output is decoded into a small window and passed to the
+ * consumer in order, so that the consumer does not need to keep
+ * the whole uncompressed data in memory. Decoding stops when the
+ * consumer returns an error.
+ *
+ * @param src    Source data buffer.
+ * @param srclen Source buffer size (bytes).
+ * @param sink   Consumer of the uncompressed data.
+ * @param arg    Argument passed to the consumer.
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM if the window cannot be allocated.
+ * @return Error code returned by the consumer.
+ *
+ */
+errno_t inflate_stream(void *src, size_t srclen, inflate_sink_t sink,
+    void *arg)
+{
+	void *window = malloc(STREAM_WINDOW);
+	if (window == NULL)
+		return ENOMEM;
+
+	errno_t ret = inflate_run(src, srclen, window, STREAM_WINDOW, sink, arg);
+	free(window);
 	return ret;
 }
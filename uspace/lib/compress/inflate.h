@@ -29,8 +29,17 @@
 #ifndef LIBCOMPRESS_INFLATE_H_
 #define LIBCOMPRESS_INFLATE_H_
 
+#include <errno.h>
 #include <stddef.h>
 
+/** Consumer of inflated data
+ *
+ * Called with consecutive pieces of the uncompressed data,
+ * an error code other than EOK stops the decoding.
+ */
+typedef errno_t (*inflate_sink_t)(void *, const void *, size_t);
+
 extern errno_t inflate(void *, size_t, void *, size_t);
+extern errno_t inflate_stream(void *, size_t, inflate_sink_t, void *);
 
 #endif
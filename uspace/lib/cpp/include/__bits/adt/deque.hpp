@@ -34,6 +34,7 @@
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 
 namespace std
 {
@@ -379,7 +380,7 @@ namespace std
                 init_();
 
                 for (size_type i = 0; i < size_; ++i)
-                    (*this)[i] = value;
+                    allocator_.construct(&(*this)[i], value);
                 back_bucket_idx_ = size_ % bucket_size_;
             }
 
@@ -419,7 +420,7 @@ namespace std
             deque(deque&& other, const allocator_type& alloc)
                 : allocator_{alloc},
                   front_bucket_idx_{other.front_bucket_idx_},
-                  back_bucket_idx_{other.front_bucket_idx_},
+                  back_bucket_idx_{other.back_bucket_idx_},
                   front_bucket_{other.front_bucket_},
                   back_bucket_{other.back_bucket_},
                   bucket_count_{other.bucket_count_},
@@ -446,6 +447,9 @@ namespace std
 
             deque& operator=(const deque& other)
             {
+                if (this == &other)
+                    return *this;
+
                 if (data_)
                     fini_();
 
@@ -485,9 +489,8 @@ namespace std
                 init_();
                 size_ = n;
 
-                auto it = begin();
                 for (size_type i = size_type{}; i < n; ++i)
-                    *it++ = value;
+                    allocator_.construct(&(*this)[i], value);
             }
 
             void assign(initializer_list<T> init)
@@ -705,82 +708,87 @@ namespace std
             template<class... Args>
             iterator emplace(const_iterator position, Args&&... args)
             {
+                /**
+                 * Note: One may notice that when working with the deque
+                 *       iterator, we use its index without any checks.
+                 *       This is because a valid iterator will always have
+                 *       a valid index as functions like pop_back or erase
+                 *       invalidate iterators.
+                 */
                 auto idx = position.idx();
-                shift_right_(idx, 1);
 
-                allocator_traits<allocator_type>::construct(
-                    allocator_,
-                    &data_[get_bucket_index_(idx)][get_element_index_(idx)],
-                    forward<Args>(args)...
-                );
-                ++size_;
+                if (idx == size_)
+                {
+                    emplace_back(forward<Args>(args)...);
+
+                    return iterator{*this, idx};
+                }
+                else if (idx == 0)
+                {
+                    emplace_front(forward<Args>(args)...);
+
+                    return begin();
+                }
+
+                // The arguments may refer to an element we are about to move.
+                value_type tmp(forward<Args>(args)...);
+
+                /**
+                 * We grow the deque at the end closer to the position
+                 * and move the elements in between by one, so that
+                 * the new element is only ever assigned to a live slot.
+                 */
+                if (idx < size_ / 2)
+                {
+                    emplace_front(move(front()));
+                    move(
+                        iterator{*this, 2}, iterator{*this, idx + 1},
+                        iterator{*this, 1}
+                    );
+                }
+                else
+                {
+                    auto old_size = size_;
+                    emplace_back(move(back()));
+                    move_backward(
+                        iterator{*this, idx}, iterator{*this, old_size - 1},
+                        iterator{*this, old_size}
+                    );
+                }
+
+                (*this)[idx] = move(tmp);
 
                 return iterator{*this, idx};
             }
 
             void push_front(const value_type& value)
             {
-                if (front_bucket_idx_ == 0)
-                    add_new_bucket_front_();
-
-                data_[front_bucket_][--front_bucket_idx_] = value;
-                ++size_;
+                emplace_front(value);
             }
 
             void push_front(value_type&& value)
             {
-                if (front_bucket_idx_ == 0)
-                    add_new_bucket_front_();
-
-                data_[front_bucket_][--front_bucket_idx_] = forward<value_type>(value);
-                ++size_;
+                emplace_front(move(value));
             }
 
             void push_back(const value_type& value)
             {
-                data_[back_bucket_][back_bucket_idx_++] = value;
-                ++size_;
-
-                if (back_bucket_idx_ >= bucket_size_)
-                    add_new_bucket_back_();
+                emplace_back(value);
             }
 
             void push_back(value_type&& value)
             {
-                data_[back_bucket_][back_bucket_idx_++] = forward<value_type>(value);
-                ++size_;
-
-                if (back_bucket_idx_ >= bucket_size_)
-                    add_new_bucket_back_();
+                emplace_back(move(value));
             }
 
             iterator insert(const_iterator position, const value_type& value)
             {
-                auto idx = position.idx();
-                shift_right_(idx, 1);
-
-                /**
-                 * Note: One may notice that when working with the deque
-                 *       iterator, we use its index without any checks.
-                 *       This is because a valid iterator will always have
-                 *       a valid index as functions like pop_back or erase
-                 *       invalidate iterators.
-                 */
-                data_[get_bucket_index_(idx)][get_element_index_(idx)] = value;
-                ++size_;
-
-                return iterator{*this, idx};
+                return emplace(position, value);
             }
 
             iterator insert(const_iterator position, value_type&& value)
             {
-                auto idx = position.idx();
-                shift_right_(idx, 1);
-
-                data_[get_bucket_index_(idx)][get_element_index_(idx)] = forward<value_type>(value);
-                ++size_;
-
-                return iterator{*this, idx};
+                return emplace(position, move(value));
             }
 
             iterator insert(const_iterator position, size_type n, const value_type& value)
@@ -873,7 +881,7 @@ namespace std
             iterator erase(const_iterator position)
             {
                 auto idx = position.idx();
-                copy(
+                move(
                     iterator{*this, idx + 1},
                     end(),
                     iterator{*this, idx}
@@ -899,7 +907,7 @@ namespace std
                 auto last_idx = last.idx();
                 auto count = distance(first, last);
 
-                copy(
+                move(
                     iterator{*this, last_idx},
                     end(),
                     iterator{*this, first_idx}
@@ -991,13 +999,13 @@ namespace std
             template<class Iterator>
             void copy_from_range_(Iterator first, Iterator last)
             {
-                size_ = distance(first, last);
-                prepare_for_size_(size_);
+                auto size = static_cast<size_type>(distance(first, last));
+                prepare_for_size_(size);
                 init_();
+                size_ = size;
 
-                auto it = begin();
-                while (first != last)
-                    *it++ = *first++;
+                for (size_type i = 0; first != last; ++i)
+                    allocator_.construct(&(*this)[i], *first++);
             }
 
             void ensure_space_front_(size_type idx, size_type count)
@@ -1063,6 +1071,12 @@ namespace std
 
             void fini_()
             {
+                if constexpr (!is_trivially_destructible_v<value_type>)
+                {
+                    for (size_type i = 0; i < size_; ++i)
+                        allocator_.destroy(&(*this)[i]);
+                }
+
                 for (size_type i = front_bucket_; i <= back_bucket_; ++i)
                     allocator_.deallocate(data_[i], bucket_size_);
 
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_FLAT_HASH_MAP
+#define LIBCPP_BITS_ADT_FLAT_HASH_MAP
+
+#include <__bits/adt/flat_hash_table.hpp>
+#include <__bits/trycatch.hpp>
+#include <cstdlib>
+#include <initializer_list>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace std
+{
+    /**
+     * HelenOS extension, class template flat_hash_map:
+     * Note: This has the interface of unordered_map minus
+     *       the bucket interface, but stores its elements
+     *       in one open addressed table (see flat_hash_table.hpp),
+     *       so inserting does not allocate a node for every element.
+     *       The price is that any insertion may invalidate
+     *       iterators, references and pointers to elements.
+     *       If both the hasher and the key equality predicate
+     *       are transparent, lookups accept any key type
+     *       they can handle.
+     */
+
+    template<
+        class Key, class Value,
+        class Hash = hash<Key>,
+        class Pred = equal_to<Key>,
+        class Alloc = allocator<pair<const Key, Value>>
+    >
+    class flat_hash_map
+    {
+        public:
+            using key_type        = Key;
+            using mapped_type     = Value;
+            using value_type      = pair<const key_type, mapped_type>;
+            using hasher          = Hash;
+            using key_equal       = Pred;
+            using allocator_type  = Alloc;
+            using pointer         = typename allocator_traits<allocator_type>::pointer;
+            using const_pointer   = typename allocator_traits<allocator_type>::const_pointer;
+            using reference       = value_type&;
+            using const_reference = const value_type&;
+            using size_type       = size_t;
+            using difference_type = ptrdiff_t;
+
+            using iterator       = aux::flat_hash_table_iterator<
+                value_type, reference, pointer
+            >;
+            using const_iterator = aux::flat_hash_table_iterator<
+                value_type, const_reference, const_pointer
+            >;
+
+            flat_hash_map()
+                : flat_hash_map{size_type{}}
+            { /* DUMMY BODY */ }
+
+            explicit flat_hash_map(size_type count,
+                                   const hasher& hf = hasher{},
+                                   const key_equal& eql = key_equal{},
+                                   const allocator_type& alloc = allocator_type{})
+                : table_{count, hf, eql, alloc}
+            { /* DUMMY BODY */ }
+
+            template<class InputIterator>
+            flat_hash_map(InputIterator first, InputIterator last,
+                          size_type count = size_type{},
+                          const hasher& hf = hasher{},
+                          const key_equal& eql = key_equal{},
+                          const allocator_type& alloc = allocator_type{})
+                : flat_hash_map{count, hf, eql, alloc}
+            {
+                insert(first, last);
+            }
+
+            flat_hash_map(const flat_hash_map& other)
+                : table_{other.table_}
+            { /* DUMMY BODY */ }
+
+            flat_hash_map(flat_hash_map&& other)
+                : table_{move(other.table_)}
+            { /* DUMMY BODY */ }
+
+            explicit flat_hash_map(const allocator_type& alloc)
+                : flat_hash_map{size_type{}, hasher{}, key_equal{}, alloc}
+            { /* DUMMY BODY */ }
+
+            flat_hash_map(const flat_hash_map& other, const allocator_type& alloc)
+                : table_{other.table_, alloc}
+            { /* DUMMY BODY */ }
+
+            flat_hash_map(initializer_list<value_type> init,
+                          size_type count = size_type{},
+                          const hasher& hf = hasher{},
+                          const key_equal& eql = key_equal{},
+                          const allocator_type& alloc = allocator_type{})
+                : flat_hash_map{count, hf, eql, alloc}
+            {
+                insert(init.begin(), init.end());
+            }
+
+            flat_hash_map& operator=(const flat_hash_map& other)
+            {
+                table_ = other.table_;
+
+                return *this;
+            }
+
+            flat_hash_map& operator=(flat_hash_map&& other)
+            {
+                table_ = move(other.table_);
+
+                return *this;
+            }
+
+            flat_hash_map& operator=(initializer_list<value_type> init)
+            {
+                table_.clear();
+                insert(init.begin(), init.end());
+
+                return *this;
+            }
+
+            allocator_type get_allocator() const noexcept
+            {
+                return table_.get_allocator();
+            }
+
+            bool empty() const noexcept
+            {
+                return table_.empty();
+            }
+
+            size_type size() const noexcept
+            {
+                return table_.size();
+            }
+
+            size_type max_size() const noexcept
+            {
+                return table_.max_size();
+            }
+
+            iterator begin() noexcept
+            {
+                return table_.begin();
+            }
+
+            const_iterator begin() const noexcept
+            {
+                return table_.begin();
+            }
+
+            iterator end() noexcept
+            {
+                return table_.end();
+            }
+
+            const_iterator end() const noexcept
+            {
+                return table_.end();
+            }
+
+            const_iterator cbegin() const noexcept
+            {
+                return table_.cbegin();
+            }
+
+            const_iterator cend() const noexcept
+            {
+                return table_.cend();
+            }
+
+            template<class... Args>
+            pair<iterator, bool> emplace(Args&&... args)
+            {
+                return table_.emplace(forward<Args>(args)...);
+            }
+
+            pair<iterator, bool> insert(const value_type& val)
+            {
+                return table_.insert(val);
+            }
+
+            pair<iterator, bool> insert(value_type&& val)
+            {
+                return table_.insert(move(val));
+            }
+
+            template<class T>
+            enable_if_t<is_constructible_v<value_type, T&&>, pair<iterator, bool>>
+            insert(T&& val)
+            {
+                return emplace(forward<T>(val));
+            }
+
+            template<class InputIterator>
+            void insert(InputIterator first, InputIterator last)
+            {
+                while (first != last)
+                    insert(*first++);
+            }
+
+            void insert(initializer_list<value_type> init)
+            {
+                insert(init.begin(), init.end());
+            }
+
+            template<class... Args>
+            pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+            {
+                return table_.insert_with(key, [&](value_type* slot){
+                    table_.construct(slot, key, mapped_type(forward<Args>(args)...));
+                });
+            }
+
+            template<class... Args>
+            pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+            {
+                return table_.insert_with(key, [&](value_type* slot){
+                    table_.construct(slot, move(key), mapped_type(forward<Args>(args)...));
+                });
+            }
+
+            template<class T>
+            pair<iterator, bool> insert_or_assign(const key_type& key, T&& val)
+            {
+                auto res = try_emplace(key, forward<T>(val));
+                if (!res.second)
+                    res.first->second = forward<T>(val);
+
+                return res;
+            }
+
+            template<class T>
+            pair<iterator, bool> insert_or_assign(key_type&& key, T&& val)
+            {
+                auto res = try_emplace(move(key), forward<T>(val));
+                if (!res.second)
+                    res.first->second = forward<T>(val);
+
+                return res;
+            }
+
+            iterator erase(const_iterator position)
+            {
+                return table_.erase(position);
+            }
+
+            size_type erase(const key_type& key)
+            {
+                return table_.erase(key);
+            }
+
+            template<
+                class K, class H = hasher, class E = key_equal,
+                class = enable_if_t<aux::is_transparent_v<H> && aux::is_transparent_v<E>>
+            >
+            size_type erase(const K& key)
+            {
+                return table_.erase(key);
+            }
+
+            iterator erase(const_iterator first, const_iterator last)
+            {
+                return table_.erase(first, last);
+            }
+
+            void clear() noexcept
+            {
+                table_.clear();
+            }
+
+            void swap(flat_hash_map& other)
+            {
+                table_.swap(other.table_);
+            }
+
+            hasher hash_function() const
+            {
+                return table_.hash_function();
+            }
+
+            key_equal key_eq() const
+            {
+                return table_.key_eq();
+            }
+
+            iterator find(const key_type& key)
+            {
+                return table_.find(key);
+            }
+
+            const_iterator find(const key_type& key) const
+            {
+                return table_.find(key);
+            }
+
+            template<
+                class K, class H = hasher, class E = key_equal,
+                class = enable_if_t<aux::is_transparent_v<H> && aux::is_transparent_v<E>>
+            >
+            iterator find(const K& key)
+            {
+                return table_.find(key);
+            }
+
+            template<
+                class K, class H = hasher, class E = key_equal,
+                class = enable_if_t<aux::is_transparent_v<H> && aux::is_transparent_v<E>>
+            >
+            const_iterator find(const K& key) const
+            {
+                return table_.find(key);
+            }
+
+            size_type count(const key_type& key) const
+            {
+                return table_.count(key);
+            }
+
+            template<
+                class K, class H = hasher, class E = key_equal,
+                class = enable_if_t<aux::is_transparent_v<H> && aux::is_transparent_v<E>>
+            >
+            size_type count(const K& key) const
+            {
+                return table_.count(key);
+            }
+
+            pair<iterator, iterator> equal_range(const key_type& key)
+            {
+                auto it = find(key);
+                if (it == end())
+                    return make_pair(it, it);
+
+                auto last = it;
+                return make_pair(it, ++last);
+            }
+
+            pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+            {
+                auto it = find(key);
+                if (it == end())
+                    return make_pair(it, it);
+
+                auto last = it;
+                return make_pair(it, ++last);
+            }
+
+            mapped_type& operator[](const key_type& key)
+            {
+                return try_emplace(key).first->second;
+            }
+
+            mapped_type& operator[](key_type&& key)
+            {
+                return try_emplace(move(key)).first->second;
+            }
+
+            mapped_type& at(const key_type& key)
+            {
+                auto it = find(key);
+                if (it == end())
+                {
+                    throw out_of_range{"flat_hash_map::at"};
+                    ::std::abort();
+                }
+
+                return it->second;
+            }
+
+            const mapped_type& at(const key_type& key) const
+            {
+                auto it = find(key);
+                if (it == end())
+                {
+                    throw out_of_range{"flat_hash_map::at"};
+                    ::std::abort();
+                }
+
+                return it->second;
+            }
+
+            size_type bucket_count() const noexcept
+            {
+                return table_.bucket_count();
+            }
+
+            float load_factor() const noexcept
+            {
+                return table_.load_factor();
+            }
+
+            float max_load_factor() const noexcept
+            {
+                return table_.max_load_factor();
+            }
+
+            void max_load_factor(float)
+            {
+                // Note: The table uses a fixed load factor of 7/8.
+            }
+
+            void rehash(size_type count)
+            {
+                table_.rehash(count);
+            }
+
+            void reserve(size_type count)
+            {
+                table_.reserve(count);
+            }
+
+        private:
+            using table_type = aux::flat_hash_table<
+                value_type, key_type,
+                aux::key_value_key_extractor<key_type, mapped_type>,
+                hasher, key_equal, allocator_type,
+                iterator, const_iterator
+            >;
+
+            table_type table_;
+    };
+
+    template<class Key, class Value, class Hash, class Pred, class Alloc>
+    void swap(flat_hash_map<Key, Value, Hash, Pred, Alloc>& lhs,
+              flat_hash_map<Key, Value, Hash, Pred, Alloc>& rhs)
+        noexcept(noexcept(lhs.swap(rhs)))
+    {
+        lhs.swap(rhs);
+    }
+
+    template<class Key, class Value, class Hash, class Pred, class Alloc>
+    bool operator==(const flat_hash_map<Key, Value, Hash, Pred, Alloc>& lhs,
+                    const flat_hash_map<Key, Value, Hash, Pred, Alloc>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (const auto& val: lhs)
+        {
+            auto it = rhs.find(val.first);
+            if (it == rhs.end() || !(it->second == val.second))
+                return false;
+        }
+
+        return true;
+    }
+
+    template<class Key, class Value, class Hash, class Pred, class Alloc>
+    bool operator!=(const flat_hash_map<Key, Value, Hash, Pred, Alloc>& lhs,
+                    const flat_hash_map<Key, Value, Hash, Pred, Alloc>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+}
+
+#endif
@@ -0,0 +1,753 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_FLAT_HASH_TABLE
+#define LIBCPP_BITS_ADT_FLAT_HASH_TABLE
+
+#include <__bits/adt/key_extractors.hpp>
+#include <__bits/builtins.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * Note: The flat hash table stores its elements directly
+     *       in one array of slots (open addressing) and keeps
+     *       a parallel array of control bytes, one per slot.
+     *       A control byte is either empty, deleted or contains
+     *       the low 7 bits of the hash of the element in its
+     *       slot (h2). The rest of the hash (h1) selects the group
+     *       of slots at which the probing starts.
+     *       Lookups compare a whole group of control bytes
+     *       at once, so most misses never touch the slots
+     *       and most hits compare a single key.
+     *       A group is a 64 bit word handled with ordinary integer
+     *       arithmetic instead of vector instructions, which works
+     *       on all of our architectures.
+     */
+    class flat_hash_group
+    {
+        public:
+            static constexpr size_t width{8};
+
+            static constexpr uint8_t empty{0x80};
+            static constexpr uint8_t deleted{0xFE};
+
+            explicit flat_hash_group(const uint8_t* ctrl) noexcept
+            {
+                ::std::memcpy(&ctrl_, ctrl, width);
+#ifdef __BE__
+                ctrl_ = __builtin_bswap64(ctrl_);
+#endif
+            }
+
+            /**
+             * Note: This may report a false positive in a byte
+             *       following a real match, which is fine as
+             *       we compare the keys anyway.
+             */
+            uint64_t match(uint8_t h2) const noexcept
+            {
+                auto x = ctrl_ ^ (lsbs_ * h2);
+
+                return (x - lsbs_) & ~x & msbs_;
+            }
+
+            uint64_t match_empty() const noexcept
+            {
+                // Only empty has the top bit set and the second lowest clear.
+                return ctrl_ & ~(ctrl_ << 6) & msbs_;
+            }
+
+            uint64_t match_empty_or_deleted() const noexcept
+            {
+                return ctrl_ & msbs_;
+            }
+
+            static size_t lowest(uint64_t mask) noexcept
+            {
+                return count_trailing_zeros(mask) / 8;
+            }
+
+            static uint64_t next(uint64_t mask) noexcept
+            {
+                return mask & (mask - 1);
+            }
+
+            static bool is_full(uint8_t ctrl) noexcept
+            {
+                return (ctrl & 0x80) == 0;
+            }
+
+        private:
+            static constexpr uint64_t lsbs_{0x0101010101010101ULL};
+            static constexpr uint64_t msbs_{0x8080808080808080ULL};
+
+            uint64_t ctrl_;
+    };
+
+    template<class Value, class Reference, class Pointer>
+    class flat_hash_table_iterator
+    {
+        public:
+            using value_type        = Value;
+            using size_type         = size_t;
+            using reference         = Reference;
+            using pointer           = Pointer;
+            using difference_type   = ptrdiff_t;
+            using iterator_category = forward_iterator_tag;
+
+            flat_hash_table_iterator(const uint8_t* ctrl = nullptr,
+                                     const uint8_t* ctrl_end = nullptr,
+                                     value_type* slot = nullptr)
+                : ctrl_{ctrl}, ctrl_end_{ctrl_end}, slot_{slot}
+            {
+                skip_free_();
+            }
+
+            flat_hash_table_iterator(const flat_hash_table_iterator&) = default;
+            flat_hash_table_iterator& operator=(const flat_hash_table_iterator&) = default;
+
+            template<
+                class R, class P,
+                class = enable_if_t<is_convertible_v<P, Pointer>>
+            >
+            flat_hash_table_iterator(const flat_hash_table_iterator<Value, R, P>& other)
+                : ctrl_{other.ctrl_}, ctrl_end_{other.ctrl_end_}, slot_{other.slot_}
+            { /* DUMMY BODY */ }
+
+            reference operator*() const
+            {
+                return *slot_;
+            }
+
+            pointer operator->() const
+            {
+                return slot_;
+            }
+
+            flat_hash_table_iterator& operator++()
+            {
+                ++ctrl_;
+                ++slot_;
+                skip_free_();
+
+                return *this;
+            }
+
+            flat_hash_table_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+            template<class R, class P>
+            bool operator==(const flat_hash_table_iterator<Value, R, P>& other) const
+            {
+                return ctrl_ == other.ctrl_;
+            }
+
+            template<class R, class P>
+            bool operator!=(const flat_hash_table_iterator<Value, R, P>& other) const
+            {
+                return ctrl_ != other.ctrl_;
+            }
+
+            value_type* slot() const
+            {
+                return slot_;
+            }
+
+        private:
+            const uint8_t* ctrl_;
+            const uint8_t* ctrl_end_;
+            value_type* slot_;
+
+            void skip_free_()
+            {
+                while (ctrl_ != ctrl_end_ && !flat_hash_group::is_full(*ctrl_))
+                {
+                    ++ctrl_;
+                    ++slot_;
+                }
+            }
+
+            template<class, class, class>
+            friend class flat_hash_table_iterator;
+    };
+
+    /**
+     * The inner table shared by flat_hash_map and flat_hash_set,
+     * see hash_table.hpp for the idea behind the key extractor.
+     * Unlike hash_table, this one only supports unique keys.
+     */
+    template<
+        class Value, class Key, class KeyExtractor,
+        class Hasher, class KeyEq, class Alloc,
+        class Iterator, class ConstIterator
+    >
+    class flat_hash_table
+    {
+        public:
+            using value_type     = Value;
+            using key_type       = Key;
+            using size_type      = size_t;
+            using allocator_type = Alloc;
+            using key_equal      = KeyEq;
+            using hasher         = Hasher;
+            using key_extract    = KeyExtractor;
+
+            using iterator       = Iterator;
+            using const_iterator = ConstIterator;
+
+            flat_hash_table(size_type capacity, const hasher& hf,
+                            const key_equal& eql, const allocator_type& alloc)
+                : ctrl_{}, slots_{}, capacity_{}, size_{}, growth_left_{},
+                  hasher_{hf}, key_eq_{eql}, key_extractor_{}, allocator_{alloc}
+            {
+                if (capacity > 0)
+                    resize_(capacity_for_(capacity));
+            }
+
+            flat_hash_table(const flat_hash_table& other)
+                : flat_hash_table{other, other.allocator_}
+            { /* DUMMY BODY */ }
+
+            flat_hash_table(const flat_hash_table& other, const allocator_type& alloc)
+                : flat_hash_table{other.size_, other.hasher_, other.key_eq_, alloc}
+            {
+                // No duplicates, so we can skip the key comparisons.
+                for (const auto& val: other)
+                {
+                    auto hash = hash_(key_extractor_(val));
+                    auto idx = find_free_slot_(hash);
+                    allocator_traits<allocator_type>::construct(
+                        allocator_, slots_ + idx, val
+                    );
+                    occupy_(idx, hash);
+                }
+            }
+
+            flat_hash_table(flat_hash_table&& other)
+                : ctrl_{other.ctrl_}, slots_{other.slots_},
+                  capacity_{other.capacity_}, size_{other.size_},
+                  growth_left_{other.growth_left_},
+                  hasher_{move(other.hasher_)}, key_eq_{move(other.key_eq_)},
+                  key_extractor_{move(other.key_extractor_)},
+                  allocator_{move(other.allocator_)}
+            {
+                other.ctrl_ = nullptr;
+                other.slots_ = nullptr;
+                other.capacity_ = size_type{};
+                other.size_ = size_type{};
+                other.growth_left_ = size_type{};
+            }
+
+            flat_hash_table& operator=(const flat_hash_table& other)
+            {
+                flat_hash_table tmp{other};
+                tmp.swap(*this);
+
+                return *this;
+            }
+
+            flat_hash_table& operator=(flat_hash_table&& other)
+            {
+                flat_hash_table tmp{move(other)};
+                tmp.swap(*this);
+
+                return *this;
+            }
+
+            ~flat_hash_table()
+            {
+                release_();
+            }
+
+            bool empty() const noexcept
+            {
+                return size_ == 0;
+            }
+
+            size_type size() const noexcept
+            {
+                return size_;
+            }
+
+            size_type max_size() const noexcept
+            {
+                return allocator_traits<allocator_type>::max_size(allocator_);
+            }
+
+            allocator_type get_allocator() const noexcept
+            {
+                return allocator_;
+            }
+
+            iterator begin() noexcept
+            {
+                return iterator{ctrl_, ctrl_ + capacity_, slots_};
+            }
+
+            const_iterator begin() const noexcept
+            {
+                return cbegin();
+            }
+
+            iterator end() noexcept
+            {
+                return iterator{ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_};
+            }
+
+            const_iterator end() const noexcept
+            {
+                return cend();
+            }
+
+            const_iterator cbegin() const noexcept
+            {
+                return const_iterator{ctrl_, ctrl_ + capacity_, slots_};
+            }
+
+            const_iterator cend() const noexcept
+            {
+                return const_iterator{
+                    ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_
+                };
+            }
+
+            /**
+             * Inserts an element with the given key unless one
+             * is already present, construct is called with the
+             * slot the new element should be constructed in.
+             */
+            template<class K, class Constructor>
+            pair<iterator, bool> insert_with(const K& key, Constructor&& construct)
+            {
+                auto hash = hash_(key);
+                auto idx = find_(key, hash);
+                if (idx != npos_)
+                    return make_pair(iterator_at_(idx), false);
+
+                if (growth_left_ == 0)
+                    grow_();
+
+                idx = find_free_slot_(hash);
+                construct(slots_ + idx);
+                occupy_(idx, hash);
+
+                return make_pair(iterator_at_(idx), true);
+            }
+
+            template<class... Args>
+            void construct(value_type* slot, Args&&... args)
+            {
+                allocator_traits<allocator_type>::construct(
+                    allocator_, slot, forward<Args>(args)...
+                );
+            }
+
+            pair<iterator, bool> insert(const value_type& val)
+            {
+                return insert_with(key_extractor_(val), [&](value_type* slot){
+                    construct(slot, val);
+                });
+            }
+
+            pair<iterator, bool> insert(value_type&& val)
+            {
+                return insert_with(key_extractor_(val), [&](value_type* slot){
+                    construct(slot, move(val));
+                });
+            }
+
+            template<class... Args>
+            pair<iterator, bool> emplace(Args&&... args)
+            {
+                value_type val(forward<Args>(args)...);
+
+                return insert(move(val));
+            }
+
+            iterator erase(const_iterator it)
+            {
+                auto idx = static_cast<size_type>(it.slot() - slots_);
+                erase_at_(idx);
+
+                return iterator{ctrl_ + idx + 1, ctrl_ + capacity_, slots_ + idx + 1};
+            }
+
+            /**
+             * Note: Erasing never moves the other elements,
+             *       so last stays valid.
+             */
+            iterator erase(const_iterator first, const_iterator last)
+            {
+                while (first != last)
+                    first = erase(first);
+
+                auto idx = static_cast<size_type>(last.slot() - slots_);
+
+                return iterator{ctrl_ + idx, ctrl_ + capacity_, slots_ + idx};
+            }
+
+            template<class K>
+            size_type erase(const K& key)
+            {
+                auto idx = find_(key, hash_(key));
+                if (idx == npos_)
+                    return 0;
+
+                erase_at_(idx);
+
+                return 1;
+            }
+
+            void clear() noexcept
+            {
+                if (capacity_ == 0)
+                    return;
+
+                destroy_all_();
+                ::std::memset(ctrl_, flat_hash_group::empty, capacity_);
+                size_ = 0;
+                growth_left_ = max_load_(capacity_);
+            }
+
+            void swap(flat_hash_table& other)
+            {
+                std::swap(ctrl_, other.ctrl_);
+                std::swap(slots_, other.slots_);
+                std::swap(capacity_, other.capacity_);
+                std::swap(size_, other.size_);
+                std::swap(growth_left_, other.growth_left_);
+                std::swap(hasher_, other.hasher_);
+                std::swap(key_eq_, other.key_eq_);
+                std::swap(key_extractor_, other.key_extractor_);
+                std::swap(allocator_, other.allocator_);
+            }
+
+            hasher hash_function() const
+            {
+                return hasher_;
+            }
+
+            key_equal key_eq() const
+            {
+                return key_eq_;
+            }
+
+            template<class K>
+            iterator find(const K& key)
+            {
+                auto idx = find_(key, hash_(key));
+
+                return idx == npos_ ? end() : iterator_at_(idx);
+            }
+
+            template<class K>
+            const_iterator find(const K& key) const
+            {
+                auto idx = find_(key, hash_(key));
+                if (idx == npos_)
+                    return cend();
+
+                return const_iterator{ctrl_ + idx, ctrl_ + capacity_, slots_ + idx};
+            }
+
+            template<class K>
+            size_type count(const K& key) const
+            {
+                return find_(key, hash_(key)) == npos_ ? 0 : 1;
+            }
+
+            size_type bucket_count() const noexcept
+            {
+                return capacity_;
+            }
+
+            float load_factor() const noexcept
+            {
+                if (capacity_ == 0)
+                    return 0.f;
+
+                return size_ / static_cast<float>(capacity_);
+            }
+
+            float max_load_factor() const noexcept
+            {
+                return 7 / 8.f;
+            }
+
+            void rehash(size_type count)
+            {
+                auto capacity = capacity_for_(max(count, size_));
+                if (capacity != capacity_)
+                    resize_(capacity);
+            }
+
+            /**
+             * Note: Unlike rehash, this guarantees that inserting
+             *       until size() == count will not rehash, as it
+             *       also accounts for slots wasted on deleted
+             *       elements.
+             */
+            void reserve(size_type count)
+            {
+                if (count > size_ + growth_left_)
+                    resize_(capacity_for_(count));
+            }
+
+        private:
+            uint8_t* ctrl_;
+            value_type* slots_;
+            size_type capacity_;
+            size_type size_;
+
+            // Inserts left before we have to rehash.
+            size_type growth_left_;
+
+            hasher hasher_;
+            key_equal key_eq_;
+            key_extract key_extractor_;
+            allocator_type allocator_;
+
+            static constexpr size_type npos_{::std::numeric_limits<size_type>::max()};
+
+            static constexpr size_type max_load_(size_type capacity) noexcept
+            {
+                return capacity - capacity / 8;
+            }
+
+            static size_type capacity_for_(size_type count) noexcept
+            {
+                size_type capacity{flat_hash_group::width};
+                while (max_load_(capacity) < count)
+                    capacity *= 2;
+
+                return capacity;
+            }
+
+            /**
+             * Note: std::hash of integral types is the identity,
+             *       so we have to mix the bits to get anything
+             *       useful out of the low 7 bits and the group index.
+             */
+            template<class K>
+            size_t hash_(const K& key) const
+            {
+                auto h = static_cast<uint64_t>(hasher_(key));
+                h ^= h >> 33;
+                h *= 0xFF51AFD7ED558CCDULL;
+                h ^= h >> 33;
+
+                return static_cast<size_t>(h);
+            }
+
+            static uint8_t h2_(size_t hash) noexcept
+            {
+                return static_cast<uint8_t>(hash & 0x7F);
+            }
+
+            static size_t h1_(size_t hash) noexcept
+            {
+                return hash >> 7;
+            }
+
+            /**
+             * We probe whole groups, moving by 1, 2, 3 ... groups,
+             * which visits every group once when their number is
+             * a power of two.
+             */
+            template<class K>
+            size_type find_(const K& key, size_t hash) const
+            {
+                if (capacity_ == 0)
+                    return npos_;
+
+                auto group_mask = capacity_ / flat_hash_group::width - 1;
+                auto group_idx = h1_(hash) & group_mask;
+                for (size_type step = 0; step <= group_mask;)
+                {
+                    auto offset = group_idx * flat_hash_group::width;
+                    flat_hash_group group{ctrl_ + offset};
+
+                    for (auto m = group.match(h2_(hash)); m; m = flat_hash_group::next(m))
+                    {
+                        auto idx = offset + flat_hash_group::lowest(m);
+                        if (key_eq_(key, key_extractor_(slots_[idx])))
+                            return idx;
+                    }
+
+                    if (group.match_empty())
+                        return npos_;
+
+                    group_idx = (group_idx + ++step) & group_mask;
+                }
+
+                return npos_;
+            }
+
+            size_type find_free_slot_(size_t hash) const
+            {
+                auto group_mask = capacity_ / flat_hash_group::width - 1;
+                auto group_idx = h1_(hash) & group_mask;
+                for (size_type step = 0;;)
+                {
+                    auto offset = group_idx * flat_hash_group::width;
+                    flat_hash_group group{ctrl_ + offset};
+
+                    auto m = group.match_empty_or_deleted();
+                    if (m)
+                        return offset + flat_hash_group::lowest(m);
+
+                    group_idx = (group_idx + ++step) & group_mask;
+                }
+            }
+
+            void occupy_(size_type idx, size_t hash)
+            {
+                // Reusing a deleted slot does not make probing longer.
+                if (ctrl_[idx] == flat_hash_group::empty)
+                    --growth_left_;
+
+                ctrl_[idx] = h2_(hash);
+                ++size_;
+            }
+
+            void erase_at_(size_type idx)
+            {
+                allocator_traits<allocator_type>::destroy(allocator_, slots_ + idx);
+                --size_;
+
+                /**
+                 * Probing never continues past a group with an empty
+                 * slot, so if there is one in this group, nobody
+                 * relies on this slot being occupied and it can
+                 * become empty again instead of deleted.
+                 */
+                auto offset = idx - idx % flat_hash_group::width;
+                flat_hash_group group{ctrl_ + offset};
+                if (group.match_empty())
+                {
+                    ctrl_[idx] = flat_hash_group::empty;
+                    ++growth_left_;
+                }
+                else
+                    ctrl_[idx] = flat_hash_group::deleted;
+            }
+
+            iterator iterator_at_(size_type idx)
+            {
+                return iterator{ctrl_ + idx, ctrl_ + capacity_, slots_ + idx};
+            }
+
+            void grow_()
+            {
+                if (capacity_ == 0)
+                    resize_(flat_hash_group::width);
+                else if (size_ * 32 <= capacity_ * 25)
+                    resize_(capacity_); // Mostly deleted slots, just clean up.
+                else
+                    resize_(capacity_ * 2);
+            }
+
+            void resize_(size_type capacity)
+            {
+                auto old_ctrl = ctrl_;
+                auto old_slots = slots_;
+                auto old_capacity = capacity_;
+
+                ctrl_ = new uint8_t[capacity];
+                ::std::memset(ctrl_, flat_hash_group::empty, capacity);
+                slots_ = allocator_.allocate(capacity);
+                capacity_ = capacity;
+                growth_left_ = max_load_(capacity) - size_;
+
+                for (size_type i = 0; i < old_capacity; ++i)
+                {
+                    if (!flat_hash_group::is_full(old_ctrl[i]))
+                        continue;
+
+                    auto hash = hash_(key_extractor_(old_slots[i]));
+                    auto idx = find_free_slot_(hash);
+                    allocator_traits<allocator_type>::construct(
+                        allocator_, slots_ + idx, move(old_slots[i])
+                    );
+                    allocator_traits<allocator_type>::destroy(allocator_, old_slots + i);
+                    ctrl_[idx] = h2_(hash);
+                }
+
+                if (old_ctrl)
+                {
+                    delete[] old_ctrl;
+                    allocator_.deallocate(old_slots, old_capacity);
+                }
+            }
+
+            void destroy_all_()
+            {
+                if constexpr (!is_trivially_destructible_v<value_type>)
+                {
+                    for (size_type i = 0; i < capacity_; ++i)
+                    {
+                        if (flat_hash_group::is_full(ctrl_[i]))
+                            allocator_traits<allocator_type>::destroy(allocator_, slots_ + i);
+                    }
+                }
+            }
+
+            void release_()
+            {
+                if (!ctrl_)
+                    return;
+
+                destroy_all_();
+                delete[] ctrl_;
+                allocator_.deallocate(slots_, capacity_);
+
+                ctrl_ = nullptr;
+                slots_ = nullptr;
+                capacity_ = size_type{};
+                size_ = size_type{};
+                growth_left_ = size_type{};
+            }
+    };
+}
+
+#endif
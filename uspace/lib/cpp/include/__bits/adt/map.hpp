@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_ADT_MAP
 #define LIBCPP_BITS_ADT_MAP
 
+#include <__bits/adt/node_handle.hpp>
 #include <__bits/adt/rbtree.hpp>
 #include <functional>
 #include <iterator>
@@ -38,6 +39,9 @@
 
 namespace std
 {
+    template<class Key, class Value, class Compare, class Alloc>
+    class multimap;
+
     /**
      * 23.4.4, class template map:
      */
@@ -62,18 +66,24 @@ namespace std
             using size_type       = size_t;
             using difference_type = ptrdiff_t;
 
-            using node_type = aux::rbtree_single_node<value_type>;
-
             using iterator             = aux::rbtree_iterator<
-                value_type, reference, pointer, size_type, node_type
+                value_type, reference, pointer, size_type,
+                aux::rbtree_single_node<value_type>
             >;
             using const_iterator       = aux::rbtree_const_iterator<
-                value_type, const_reference, const_pointer, size_type, node_type
+                value_type, const_reference, const_pointer, size_type,
+                aux::rbtree_single_node<value_type>
             >;
 
             using reverse_iterator       = std::reverse_iterator<iterator>;
             using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+            using node_type = aux::map_node_handle<
+                aux::rbtree_single_node<value_type>, allocator_type,
+                key_type, mapped_type
+            >;
+            using insert_return_type = aux::node_insert_return<iterator, node_type>;
+
             class value_compare
             {
                 friend class map;
@@ -277,7 +287,7 @@ namespace std
                 if (parent && tree_.keys_equal(tree_.get_key(parent->value), key))
                     return parent->value.second;
 
-                auto node = new node_type{value_type{key, mapped_type{}}};
+                auto node = tree_.create_node(value_type{key, mapped_type{}});
                 tree_.insert_node(node, parent);
 
                 return node->value.second;
@@ -289,7 +299,7 @@ namespace std
                 if (parent && tree_.keys_equal(tree_.get_key(parent->value), key))
                     return parent->value.second;
 
-                auto node = new node_type{value_type{move(key), mapped_type{}}};
+                auto node = tree_.create_node(value_type{move(key), mapped_type{}});
                 tree_.insert_node(node, parent);
 
                 return node->value.second;
@@ -322,9 +332,9 @@ namespace std
             }
 
             template<class... Args>
-            iterator emplace_hint(const_iterator, Args&&... args)
+            iterator emplace_hint(const_iterator hint, Args&&... args)
             {
-                return emplace(forward<Args>(args)...).first;
+                return tree_.emplace_hint(hint, forward<Args>(args)...);
             }
 
             pair<iterator, bool> insert(const value_type& val)
@@ -346,14 +356,14 @@ namespace std
                 return emplace(forward<T>(val));
             }
 
-            iterator insert(const_iterator, const value_type& val)
+            iterator insert(const_iterator hint, const value_type& val)
             {
-                return insert(val).first;
+                return tree_.emplace_hint(hint, val);
             }
 
-            iterator insert(const_iterator, value_type&& val)
+            iterator insert(const_iterator hint, value_type&& val)
             {
-                return insert(forward<value_type>(val)).first;
+                return tree_.emplace_hint(hint, forward<value_type>(val));
             }
 
             template<class T>
@@ -369,8 +379,7 @@ namespace std
             template<class InputIterator>
             void insert(InputIterator first, InputIterator last)
             {
-                while (first != last)
-                    insert(*first++);
+                tree_.insert_range(first, last);
             }
 
             void insert(initializer_list<value_type> init)
@@ -378,6 +387,48 @@ namespace std
                 insert(init.begin(), init.end());
             }
 
+            node_type extract(const_iterator position)
+            {
+                return node_type{tree_.extract_node(position), allocator_};
+            }
+
+            node_type extract(const key_type& key)
+            {
+                auto it = find(key);
+                if (it == end())
+                    return node_type{};
+
+                return extract(it);
+            }
+
+            insert_return_type insert(node_type&& nh)
+            {
+                if (nh.empty())
+                    return insert_return_type{end(), false, node_type{}};
+
+                const auto& key = nh.key();
+                auto parent = tree_.find_parent_for_insertion(key);
+                if (parent && tree_.keys_equal(tree_.get_key(parent->value), key))
+                    return insert_return_type{iterator{parent, false}, false, move(nh)};
+
+                auto node = nh.release_node();
+                tree_.adopt_node(node, parent);
+
+                return insert_return_type{iterator{node, false}, true, node_type{}};
+            }
+
+            /**
+             * Note: The hint is not used, checking for a duplicate
+             *       key costs a search anyway.
+             */
+            iterator insert(const_iterator, node_type&& nh)
+            {
+                auto res = insert(move(nh));
+                nh = move(res.node);
+
+                return res.position;
+            }
+
             template<class... Args>
             pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
             {
@@ -386,7 +437,7 @@ namespace std
                     return make_pair(iterator{parent, false}, false);
                 else
                 {
-                    auto node = new node_type{value_type{key, forward<Args>(args)...}};
+                    auto node = tree_.create_node(value_type{key, forward<Args>(args)...});
                     tree_.insert_node(node, parent);
 
                     return make_pair(iterator{node, false}, true);
@@ -401,7 +452,7 @@ namespace std
                     return make_pair(iterator{parent, false}, false);
                 else
                 {
-                    auto node = new node_type{value_type{move(key), forward<Args>(args)...}};
+                    auto node = tree_.create_node(value_type{move(key), forward<Args>(args)...});
                     tree_.insert_node(node, parent);
 
                     return make_pair(iterator{node, false}, true);
@@ -432,7 +483,7 @@ namespace std
                 }
                 else
                 {
-                    auto node = new node_type{value_type{key, forward<T>(val)}};
+                    auto node = tree_.create_node(value_type{key, forward<T>(val)});
                     tree_.insert_node(node, parent);
 
                     return make_pair(iterator{node, false}, true);
@@ -451,7 +502,7 @@ namespace std
                 }
                 else
                 {
-                    auto node = new node_type{value_type{move(key), forward<T>(val)}};
+                    auto node = tree_.create_node(value_type{move(key), forward<T>(val)});
                     tree_.insert_node(node, parent);
 
                     return make_pair(iterator{node, false}, true);
@@ -503,6 +554,45 @@ namespace std
                 tree_.clear();
             }
 
+            template<class C2>
+            void merge(map<key_type, mapped_type, C2, allocator_type>& source)
+            {
+                tree_.merge(source.tree_);
+            }
+
+            template<class C2>
+            void merge(map<key_type, mapped_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
+            /**
+             * Note: Nodes of multimaps differ from ours (they keep
+             *       lists of equivalent elements), so in this case
+             *       the elements are moved to new nodes.
+             */
+            template<class C2>
+            void merge(multimap<key_type, mapped_type, C2, allocator_type>& source)
+            {
+                auto it = source.begin();
+                while (it != source.end())
+                {
+                    if (find(it->first) == end())
+                    {
+                        emplace(move(*it));
+                        it = source.erase(it);
+                    }
+                    else
+                        ++it;
+                }
+            }
+
+            template<class C2>
+            void merge(multimap<key_type, mapped_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
             key_compare key_comp() const
             {
                 return tree_.key_comp();
@@ -644,12 +734,15 @@ namespace std
                 value_type, key_type, aux::key_value_key_extractor<key_type, mapped_type>,
                 key_compare, allocator_type, size_type,
                 iterator, const_iterator,
-                aux::rbtree_single_policy, node_type
+                aux::rbtree_single_policy, aux::rbtree_single_node<value_type>
             >;
 
             tree_type tree_;
             allocator_type allocator_;
 
+            template<class, class, class, class>
+            friend class map;
+
             template<class K, class C, class A>
             friend bool operator==(const map<K, C, A>&,
                                    const map<K, C, A>&);
@@ -725,8 +818,6 @@ namespace std
             using size_type       = size_t;
             using difference_type = ptrdiff_t;
 
-            using node_type = aux::rbtree_multi_node<value_type>;
-
             class value_compare
             {
                 friend class multimap;
@@ -750,15 +841,22 @@ namespace std
             };
 
             using iterator             = aux::rbtree_iterator<
-                value_type, reference, pointer, size_type, node_type
+                value_type, reference, pointer, size_type,
+                aux::rbtree_multi_node<value_type>
             >;
             using const_iterator       = aux::rbtree_const_iterator<
-                value_type, const_reference, const_pointer, size_type, node_type
+                value_type, const_reference, const_pointer, size_type,
+                aux::rbtree_multi_node<value_type>
             >;
 
             using reverse_iterator       = std::reverse_iterator<iterator>;
             using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+            using node_type = aux::map_node_handle<
+                aux::rbtree_multi_node<value_type>, allocator_type,
+                key_type, mapped_type
+            >;
+
             multimap()
                 : multimap{key_compare{}}
             { /* DUMMY BODY */ }
@@ -933,9 +1031,9 @@ namespace std
             }
 
             template<class... Args>
-            iterator emplace_hint(const_iterator, Args&&... args)
+            iterator emplace_hint(const_iterator hint, Args&&... args)
             {
-                return emplace(forward<Args>(args)...);
+                return tree_.emplace_hint(hint, forward<Args>(args)...);
             }
 
             iterator insert(const value_type& val)
@@ -957,14 +1055,14 @@ namespace std
                 return emplace(forward<T>(val));
             }
 
-            iterator insert(const_iterator, const value_type& val)
+            iterator insert(const_iterator hint, const value_type& val)
             {
-                return insert(val);
+                return tree_.emplace_hint(hint, val);
             }
 
-            iterator insert(const_iterator, value_type&& val)
+            iterator insert(const_iterator hint, value_type&& val)
             {
-                return insert(forward<value_type>(val));
+                return tree_.emplace_hint(hint, forward<value_type>(val));
             }
 
             template<class T>
@@ -980,8 +1078,7 @@ namespace std
             template<class InputIterator>
             void insert(InputIterator first, InputIterator last)
             {
-                while (first != last)
-                    insert(*first++);
+                tree_.insert_range(first, last);
             }
 
             void insert(initializer_list<value_type> init)
@@ -989,6 +1086,36 @@ namespace std
                 insert(init.begin(), init.end());
             }
 
+            node_type extract(const_iterator position)
+            {
+                return node_type{tree_.extract_node(position), allocator_};
+            }
+
+            node_type extract(const key_type& key)
+            {
+                auto it = find(key);
+                if (it == end())
+                    return node_type{};
+
+                return extract(it);
+            }
+
+            iterator insert(node_type&& nh)
+            {
+                if (nh.empty())
+                    return end();
+
+                return tree_.adopt_node(nh.release_node(), nullptr);
+            }
+
+            iterator insert(const_iterator hint, node_type&& nh)
+            {
+                if (nh.empty())
+                    return end();
+
+                return tree_.adopt_node(hint, nh.release_node());
+            }
+
             iterator erase(const_iterator position)
             {
                 return tree_.erase(position);
@@ -1022,6 +1149,36 @@ namespace std
                 tree_.clear();
             }
 
+            template<class C2>
+            void merge(multimap<key_type, mapped_type, C2, allocator_type>& source)
+            {
+                tree_.merge(source.tree_);
+            }
+
+            template<class C2>
+            void merge(multimap<key_type, mapped_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
+            /**
+             * Note: Nodes of maps differ from ours, so in this
+             *       case the elements are moved to new nodes.
+             */
+            template<class C2>
+            void merge(map<key_type, mapped_type, C2, allocator_type>& source)
+            {
+                for (auto& val: source)
+                    emplace(move(val));
+                source.clear();
+            }
+
+            template<class C2>
+            void merge(map<key_type, mapped_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
             key_compare key_comp() const
             {
                 return tree_.key_comp();
@@ -1163,12 +1320,15 @@ namespace std
                 value_type, key_type, aux::key_value_key_extractor<key_type, mapped_type>,
                 key_compare, allocator_type, size_type,
                 iterator, const_iterator,
-                aux::rbtree_multi_policy, node_type
+                aux::rbtree_multi_policy, aux::rbtree_multi_node<value_type>
             >;
 
             tree_type tree_;
             allocator_type allocator_;
 
+            template<class, class, class, class>
+            friend class multimap;
+
             template<class K, class C, class A>
             friend bool operator==(const multimap<K, C, A>&,
                                    const multimap<K, C, A>&);
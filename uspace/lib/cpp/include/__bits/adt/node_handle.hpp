@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_NODE_HANDLE
+#define LIBCPP_BITS_ADT_NODE_HANDLE
+
+#include <__bits/adt/rbtree_node_pool.hpp>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * 23.2.4 (C++17), node handles:
+     * Owns a node extracted from an associative container,
+     * which can be inserted into another container without
+     * copying or moving the element.
+     */
+
+    template<class Node, class Alloc>
+    class node_handle_base
+    {
+        public:
+            using allocator_type = Alloc;
+
+            constexpr node_handle_base() noexcept
+                : node_{nullptr}, alloc_{}
+            { /* DUMMY BODY */ }
+
+            node_handle_base(node_handle_base&& other) noexcept
+                : node_{other.node_}, alloc_{move(other.alloc_)}
+            {
+                other.node_ = nullptr;
+            }
+
+            node_handle_base& operator=(node_handle_base&& other)
+            {
+                if (this != &other)
+                {
+                    rbtree_node_pool<Node>::destroy_detached(node_);
+
+                    node_ = other.node_;
+                    alloc_ = move(other.alloc_);
+                    other.node_ = nullptr;
+                }
+
+                return *this;
+            }
+
+            ~node_handle_base()
+            {
+                rbtree_node_pool<Node>::destroy_detached(node_);
+            }
+
+            allocator_type get_allocator() const
+            {
+                return alloc_;
+            }
+
+            explicit operator bool() const noexcept
+            {
+                return node_ != nullptr;
+            }
+
+            [[nodiscard]] bool empty() const noexcept
+            {
+                return node_ == nullptr;
+            }
+
+            node_handle_base(Node* node, const allocator_type& alloc)
+                : node_{node}, alloc_{alloc}
+            { /* DUMMY BODY */ }
+
+            /**
+             * The container takes ownership of the node
+             * once it has been inserted.
+             */
+            Node* release_node()
+            {
+                auto res = node_;
+                node_ = nullptr;
+
+                return res;
+            }
+
+            Node* node() const
+            {
+                return node_;
+            }
+
+        protected:
+            void swap_(node_handle_base& other) noexcept
+            {
+                std::swap(node_, other.node_);
+                std::swap(alloc_, other.alloc_);
+            }
+
+            Node* node_;
+            allocator_type alloc_;
+    };
+
+    template<class Node, class Alloc, class Key, class Mapped>
+    class map_node_handle: public node_handle_base<Node, Alloc>
+    {
+        public:
+            using key_type    = Key;
+            using mapped_type = Mapped;
+
+            using node_handle_base<Node, Alloc>::node_handle_base;
+
+            constexpr map_node_handle() noexcept = default;
+            map_node_handle(map_node_handle&&) = default;
+            map_node_handle& operator=(map_node_handle&&) = default;
+
+            /**
+             * Note: The key is const in the container, but can
+             *       be modified while it is owned by the handle.
+             */
+            key_type& key() const
+            {
+                return const_cast<key_type&>(this->node_->value.first);
+            }
+
+            mapped_type& mapped() const
+            {
+                return this->node_->value.second;
+            }
+
+            void swap(map_node_handle& other) noexcept
+            {
+                this->swap_(other);
+            }
+    };
+
+    template<class Node, class Alloc, class Key, class Mapped>
+    void swap(map_node_handle<Node, Alloc, Key, Mapped>& lhs,
+              map_node_handle<Node, Alloc, Key, Mapped>& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    template<class Node, class Alloc, class Value>
+    class set_node_handle: public node_handle_base<Node, Alloc>
+    {
+        public:
+            using value_type = Value;
+
+            using node_handle_base<Node, Alloc>::node_handle_base;
+
+            constexpr set_node_handle() noexcept = default;
+            set_node_handle(set_node_handle&&) = default;
+            set_node_handle& operator=(set_node_handle&&) = default;
+
+            value_type& value() const
+            {
+                return this->node_->value;
+            }
+
+            void swap(set_node_handle& other) noexcept
+            {
+                this->swap_(other);
+            }
+    };
+
+    template<class Node, class Alloc, class Value>
+    void swap(set_node_handle<Node, Alloc, Value>& lhs,
+              set_node_handle<Node, Alloc, Value>& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    template<class Iterator, class NodeType>
+    struct node_insert_return
+    {
+        Iterator position;
+        bool inserted;
+        NodeType node;
+    };
+}
+
+#endif
@@ -32,6 +32,7 @@
 #include <__bits/adt/key_extractors.hpp>
 #include <__bits/adt/rbtree_iterators.hpp>
 #include <__bits/adt/rbtree_node.hpp>
+#include <__bits/adt/rbtree_node_pool.hpp>
 #include <__bits/adt/rbtree_policies.hpp>
 
 namespace std::aux
@@ -61,23 +62,28 @@ namespace std::aux
             using node_type = Node;
 
             rbtree(const key_compare& kcmp = key_compare{})
-                : root_{nullptr}, size_{}, key_compare_{},
-                  key_extractor_{}
+                : root_{nullptr}, smallest_{nullptr}, largest_{nullptr},
+                  size_{}, key_compare_{kcmp}, key_extractor_{},
+                  node_pool_{}
             { /* DUMMY BODY */ }
 
             rbtree(const rbtree& other)
                 : rbtree{other.key_compare_}
             {
-                for (const auto& x: other)
-                    insert(x);
+                // The source is sorted, so this takes linear time.
+                insert_range(other.begin(), other.end());
             }
 
             rbtree(rbtree&& other)
-                : root_{other.root_}, size_{other.size_},
+                : root_{other.root_}, smallest_{other.smallest_},
+                  largest_{other.largest_}, size_{other.size_},
                   key_compare_{move(other.key_compare_)},
-                  key_extractor_{move(other.key_extractor_)}
+                  key_extractor_{move(other.key_extractor_)},
+                  node_pool_{move(other.node_pool_)}
             {
                 other.root_ = nullptr;
+                other.smallest_ = nullptr;
+                other.largest_ = nullptr;
                 other.size_ = size_type{};
             }
 
@@ -97,6 +103,11 @@ namespace std::aux
                 return *this;
             }
 
+            ~rbtree()
+            {
+                clear();
+            }
+
             bool empty() const noexcept
             {
                 return size_ == 0U;
@@ -114,6 +125,9 @@ namespace std::aux
 
             iterator begin()
             {
+                if (!smallest_)
+                    return end();
+
                 return iterator{find_smallest_(), false};
             }
 
@@ -163,6 +177,9 @@ namespace std::aux
 
             const_iterator cbegin() const
             {
+                if (!smallest_)
+                    return cend();
+
                 return const_iterator{find_smallest_(), false};
             }
 
@@ -191,6 +208,18 @@ namespace std::aux
                 return Policy::emplace(*this, forward<Args>(args)...);
             }
 
+            /**
+             * Takes amortized constant time if the new element
+             * belongs right before the hint (in particular, when
+             * appending sorted elements with end() as the hint),
+             * otherwise falls back to a regular insert.
+             */
+            template<class... Args>
+            iterator emplace_hint(const_iterator hint, Args&&... args)
+            {
+                return Policy::emplace_hint(*this, hint, forward<Args>(args)...);
+            }
+
             auto insert(const value_type& val)
             {
                 return Policy::insert(*this, val);
@@ -201,6 +230,77 @@ namespace std::aux
                 return Policy::insert(*this, forward<value_type>(val));
             }
 
+            /**
+             * If the tree is empty and the input sorted, the tree
+             * is built bottom up in linear time, which is much cheaper
+             * than inserting (and rebalancing) element by element.
+             * Otherwise, the elements are inserted with end() as
+             * the hint, so sorted input stays cheap even then.
+             */
+            template<class InputIterator>
+            void insert_range(InputIterator first, InputIterator last)
+            {
+                if (root_)
+                {
+                    while (first != last)
+                        emplace_hint(cend(), *first++);
+
+                    return;
+                }
+
+                /**
+                 * The nodes are chained through their right links
+                 * until we either run out of input or find out it
+                 * is not sorted.
+                 */
+                node_type* chain{};
+                node_type* tail{};
+                node_type* tail_last{}; // Last node in the list of tail.
+                size_type count{};
+                size_type total{};
+
+                while (first != last)
+                {
+                    auto node = create_node(*first++);
+                    if (!tail)
+                    {
+                        chain = tail = tail_last = node;
+                        count = total = 1;
+
+                        continue;
+                    }
+
+                    const auto& tail_key = get_key(tail->value);
+                    if (key_compare_(tail_key, get_key(node->value)))
+                    {
+                        tail->right(node);
+                        tail = tail_last = node;
+                        ++count;
+                        ++total;
+                    }
+                    else if (!key_compare_(get_key(node->value), tail_key))
+                    {
+                        if (Policy::add_equivalent(*this, tail_last, node))
+                        {
+                            tail_last = node;
+                            ++total;
+                        }
+                    }
+                    else
+                    {
+                        build_sorted_(chain, count, total, tail);
+                        Policy::insert_hint(*this, cend(), node);
+
+                        while (first != last)
+                            emplace_hint(cend(), *first++);
+
+                        return;
+                    }
+                }
+
+                build_sorted_(chain, count, total, tail);
+            }
+
             size_type erase(const key_type& key)
             {
                 return Policy::erase(*this, key);
@@ -215,29 +315,59 @@ namespace std::aux
 
                 node = delete_node(node);
                 if (!node)
-                    return iterator{find_largest_(), true};
+                    return end();
                 else
                     return iterator{const_cast<node_type*>(node), false};
             }
 
             void clear() noexcept
             {
-                if (root_)
+                /**
+                 * Post-order walk that detaches every node
+                 * from its parent before destroying it, so
+                 * that we need neither recursion nor a stack.
+                 */
+                auto node = root_;
+                while (node)
                 {
-                    delete root_;
-                    root_ = nullptr;
-                    size_ = size_type{};
+                    if (node->left())
+                        node = node->left();
+                    else if (node->right())
+                        node = node->right();
+                    else
+                    {
+                        auto parent = node->parent();
+                        if (parent)
+                        {
+                            if (parent->left() == node)
+                                parent->left(nullptr);
+                            else
+                                parent->right(nullptr);
+                        }
+
+                        destroy_list_(node);
+                        node = parent;
+                    }
                 }
+
+                root_ = nullptr;
+                smallest_ = nullptr;
+                largest_ = nullptr;
+                size_ = size_type{};
+                node_pool_.release();
             }
 
             void swap(rbtree& other)
                 noexcept(allocator_traits<allocator_type>::is_always_equal::value &&
-                         noexcept(swap(declval<KeyComp&>(), declval<KeyComp&>())))
+                         noexcept(std::swap(declval<KeyComp&>(), declval<KeyComp&>())))
             {
                 std::swap(root_, other.root_);
+                std::swap(smallest_, other.smallest_);
+                std::swap(largest_, other.largest_);
                 std::swap(size_, other.size_);
                 std::swap(key_compare_, other.key_compare_);
                 std::swap(key_extractor_, other.key_extractor_);
+                node_pool_.swap(other.node_pool_);
             }
 
             key_compare key_comp() const
@@ -270,31 +400,49 @@ namespace std::aux
 
             iterator upper_bound(const key_type& key)
             {
+                if (!root_)
+                    return end();
+
                 return Policy::upper_bound(*this, key);
             }
 
             const_iterator upper_bound(const key_type& key) const
             {
+                if (!root_)
+                    return end();
+
                 return Policy::upper_bound_const(*this, key);
             }
 
             iterator lower_bound(const key_type& key)
             {
+                if (!root_)
+                    return end();
+
                 return Policy::lower_bound(*this, key);
             }
 
             const_iterator lower_bound(const key_type& key) const
             {
+                if (!root_)
+                    return end();
+
                 return Policy::lower_bound_const(*this, key);
             }
 
             pair<iterator, iterator> equal_range(const key_type& key)
             {
+                if (!root_)
+                    return make_pair(end(), end());
+
                 return Policy::equal_range(*this, key);
             }
 
             pair<const_iterator, const_iterator> equal_range(const key_type& key) const
             {
+                if (!root_)
+                    return make_pair(end(), end());
+
                 return Policy::equal_range_const(*this, key);
             }
 
@@ -347,90 +495,121 @@ namespace std::aux
                 return parent;
             }
 
+            template<class... Args>
+            node_type* create_node(Args&&... args)
+            {
+                return node_pool_.create(forward<Args>(args)...);
+            }
+
+            void destroy_node(node_type* node)
+            {
+                node_pool_.destroy(node);
+            }
+
+            /**
+             * Returns the successor of the deleted node.
+             */
             node_type* delete_node(const node_type* n)
             {
                 auto node = const_cast<node_type*>(n);
                 if (!node)
                     return nullptr;
 
-                --size_;
-
+                /**
+                 * Nodes keep their values when the tree gets
+                 * restructured, so the successor stays valid.
+                 */
                 auto succ = node->successor();
-                if (auto tmp = node->get_node_for_deletion(); tmp != nullptr)
-                {
-                    /**
-                     * This will kick in multi containers,
-                     * we popped one node from a list of nodes
-                     * with equivalent keys and we can delete it
-                     * and return the successor which was the next
-                     * in the list.
-                     */
-                    delete tmp;
+                unlink_node_(node);
+                node_pool_.destroy(node);
 
-                    update_root_(succ); // Incase the first in list was root.
-                    return succ;
-                }
-                else if (node == root_)
-                { // Only executed if root_ is unique.
-                    root_ = nullptr;
-                    delete node;
+                return succ;
+            }
 
+            void insert_node(node_type* node, node_type* parent)
+            {
+                Policy::insert(*this, node, parent);
+            }
+
+            /**
+             * Removes the node from the tree without destroying it,
+             * the caller takes ownership (this is what node handles
+             * are made of).
+             */
+            node_type* extract_node(const_iterator it)
+            {
+                if (it == cend())
                     return nullptr;
-                }
 
-                if (node->left() && node->right())
-                {
-                    node->swap(succ);
-                    if (succ && !succ->parent())
-                        root_ = succ;
+                auto node = const_cast<node_type*>(it.node());
+                unlink_node_(node);
+                node_pool_.node_left();
 
-                    // Node now has at most one child.
-                    // Also: If succ was nullptr, the swap
-                    //       didn't do anything and we can
-                    //       safely delete node.
-                    return delete_node(node);
-                }
+                return node;
+            }
 
-                auto child = node->right() ? node->right() : node->left();
-                if (!child)
-                {
-                    // Simply remove the node.
-                    // TODO: repair here too?
-                    node->unlink();
-                    delete node;
-                }
-                else
-                {
-                    // Replace with the child.
-                    child->parent(node->parent());
-                    if (node->is_left_child())
-                        child->parent()->left(child);
-                    else if (node->is_right_child())
-                        child->parent()->right(child);
-                    node->parent(nullptr);
-                    node->left(nullptr);
-                    node->right(nullptr);
-
-                    // Repair if needed.
-                    repair_after_erase_(node, child);
-                    update_root_(child);
-
-                    delete node;
-                }
+            /**
+             * Inserts a node extracted from another tree,
+             * parent has to be found for the node's key.
+             */
+            auto adopt_node(node_type* node, node_type* parent)
+            {
+                node_pool_.node_joined();
 
-                return succ;
+                return Policy::insert(*this, node, parent);
             }
 
-            void insert_node(node_type* node, node_type* parent)
+            auto adopt_node(const_iterator hint, node_type* node)
             {
-                Policy::insert(*this, node, parent);
+                node_pool_.node_joined();
+
+                return Policy::insert_hint(*this, hint, node);
+            }
+
+            /**
+             * Moves the nodes of source into this tree (unless this
+             * tree already contains their keys and allows only unique
+             * keys). No element gets copied or moved, the nodes are
+             * just relinked.
+             */
+            template<class Tree>
+            void merge(Tree& source)
+            {
+                if (static_cast<void*>(&source) == static_cast<void*>(this))
+                    return;
+
+                auto node = source.smallest_;
+                while (node)
+                {
+                    auto next = node->successor();
+
+                    const auto& key = get_key(node->value);
+                    auto parent = find_parent_for_insertion(key);
+                    if (!Policy::has_equivalent(*this, parent, key))
+                    {
+                        source.unlink_node_(node);
+                        source.node_pool_.node_left();
+                        adopt_node(node, parent);
+                    }
+
+                    node = next;
+                }
             }
 
         private:
             node_type* root_;
+
+            /**
+             * The extremes are cached so that begin(), end()
+             * and hints at either end take constant time.
+             */
+            node_type* smallest_;
+            node_type* largest_;
+
             size_type size_;
             key_compare key_compare_;
             key_extract key_extractor_;
+            rbtree_node_pool<node_type> node_pool_;
 
             node_type* find_(const key_type& key) const
             {
@@ -450,41 +629,436 @@ namespace std::aux
 
             node_type* find_smallest_() const
             {
-                if (root_)
-                    return root_->find_smallest();
-                else
-                    return nullptr;
+                return smallest_;
             }
 
             node_type* find_largest_() const
             {
-                if (root_)
-                    return root_->find_largest();
-                else
-                    return nullptr;
+                return largest_;
             }
 
-            void update_root_(const node_type* node)
+            /**
+             * Finds where a node with the given key can be attached
+             * if it belongs right before hint (or right after it,
+             * which is a common mistake). Returns false if the hint
+             * is of no use, that includes keys equivalent to
+             * the hint or its neighbours.
+             */
+            bool find_parent_for_hint_(const_iterator hint, const key_type& key,
+                                       node_type*& parent, bool& left) const
             {
+                if (!root_)
+                    return false;
+
+                // End iterators hold the largest node (if it has not changed).
+                if (hint.end())
+                {
+                    if (!key_compare_(key_extractor_(largest_->value), key))
+                        return false;
+
+                    parent = largest_;
+                    left = false;
+
+                    return true;
+                }
+
+                auto node = const_cast<node_type*>(hint.node());
                 if (!node)
+                    return false;
+                node = node->get_first();
+
+                const auto& node_key = key_extractor_(node->value);
+                if (key_compare_(key, node_key))
+                {
+                    if (node != smallest_)
+                    {
+                        auto prev = node_type::utils::predecessor(node);
+                        if (!key_compare_(key_extractor_(prev->value), key))
+                            return false;
+
+                        // Prev is the largest node in the left subtree.
+                        if (node->left())
+                        {
+                            parent = prev;
+                            left = false;
+
+                            return true;
+                        }
+                    }
+
+                    parent = node;
+                    left = true;
+
+                    return true;
+                }
+                else if (key_compare_(node_key, key))
+                {
+                    if (node != largest_)
+                    {
+                        auto next = node_type::utils::successor(node);
+                        if (!key_compare_(key, key_extractor_(next->value)))
+                            return false;
+
+                        // Next is the smallest node in the right subtree.
+                        if (node->right())
+                        {
+                            parent = next;
+                            left = true;
+
+                            return true;
+                        }
+                    }
+
+                    parent = node;
+                    left = false;
+
+                    return true;
+                }
+
+                return false;
+            }
+
+            /**
+             * Links node as a child of parent (which has to have the
+             * corresponding child slot empty) or as the root if parent
+             * is null and restores the red-black properties.
+             */
+            void attach_node_(node_type* node, node_type* parent, bool left)
+            {
+                ++size_;
+                if (!parent)
+                {
+                    node->color = rbcolor::black;
+                    root_ = node;
+                    smallest_ = node;
+                    largest_ = node;
+
                     return;
+                }
 
-                root_ = const_cast<node_type*>(node);
-                while (root_->parent())
-                    root_ = root_->parent();
+                if (left)
+                {
+                    parent->add_left_child(node);
+                    if (parent == smallest_)
+                        smallest_ = node;
+                }
+                else
+                {
+                    parent->add_right_child(node);
+                    if (parent == largest_)
+                        largest_ = node;
+                }
+
+                repair_after_insert_(node);
             }
 
-            void repair_after_insert_(const node_type* node)
+            /**
+             * Removes node from the tree (or from its list of nodes
+             * with equivalent keys) and leaves it detached.
+             */
+            void unlink_node_(node_type* node)
             {
-                // TODO: implement
+                --size_;
+
+                auto first = node->get_first();
+                auto next = node->next();
+                if (auto tmp = node->get_node_for_deletion(); tmp != nullptr)
+                {
+                    /**
+                     * This will kick in multi containers,
+                     * we popped one node from a list of nodes
+                     * with equivalent keys. If it was the one
+                     * linked into the tree, the next one in the
+                     * list took its place.
+                     */
+                    if (first == node)
+                    {
+                        if (root_ == node)
+                            root_ = next;
+                        if (smallest_ == node)
+                            smallest_ = next;
+                        if (largest_ == node)
+                            largest_ = next;
+                    }
+
+                    return;
+                }
+
+                if (node == smallest_)
+                    smallest_ = node_type::utils::successor(node);
+                if (node == largest_)
+                    largest_ = node_type::utils::predecessor(node);
+
+                if (node->left() && node->right())
+                {
+                    /**
+                     * Swap the node (and its color) with its successor,
+                     * which has at most one child, instead of moving
+                     * values around, so that iterators stay valid.
+                     */
+                    auto succ = node_type::utils::find_smallest(node->right());
+                    node->swap(succ);
+                    std::swap(node->color, succ->color);
+                    if (!succ->parent())
+                        root_ = succ;
+                }
+
+                auto parent = node->parent();
+                auto child = node->left() ? node->left() : node->right();
+                if (child)
+                {
+                    // The only child of a node must be red, the node black.
+                    child->parent(parent);
+                    if (!parent)
+                        root_ = child;
+                    else if (parent->left() == node)
+                        parent->left(child);
+                    else
+                        parent->right(child);
+
+                    child->color = rbcolor::black;
+                }
+                else
+                {
+                    // The node is kept in place as a leaf while we repair.
+                    if (node != root_ && node->color == rbcolor::black)
+                        repair_after_erase_(node);
+
+                    parent = node->parent();
+                    if (!parent)
+                        root_ = nullptr;
+                    else if (parent->left() == node)
+                        parent->left(nullptr);
+                    else
+                        parent->right(nullptr);
+                }
+
+                node->reset();
+            }
+
+            void destroy_list_(node_type* node)
+            {
+                while (node)
+                {
+                    auto next = node->next();
+                    node_pool_.destroy(node);
+                    node = next;
+                }
+            }
+
+            /**
+             * Builds a balanced tree out of count nodes chained
+             * through their right links. All nodes are black except
+             * for the lowest level, which is incomplete (unless count
+             * is 2^k - 1) and red, so all paths have the same number
+             * of black nodes.
+             */
+            void build_sorted_(node_type* chain, size_type count,
+                               size_type total, node_type* last)
+            {
+                if (!chain)
+                    return;
+
+                size_type red_depth{};
+                while ((size_type{2} << red_depth) <= count)
+                    ++red_depth;
+
+                root_ = build_balanced_(chain, count, size_type{}, red_depth);
+                root_->color = rbcolor::black;
+                smallest_ = root_->find_smallest();
+                largest_ = last;
+                size_ = total;
+            }
+
+            node_type* build_balanced_(node_type*& chain, size_type count,
+                                       size_type depth, size_type red_depth)
+            {
+                if (count == 0)
+                    return nullptr;
+
+                auto left_count = count / 2;
+                auto left = build_balanced_(chain, left_count, depth + 1, red_depth);
+
+                auto node = chain;
+                chain = chain->right();
+
+                node->left(left);
+                if (left)
+                    left->parent(node);
+
+                auto right = build_balanced_(chain, count - left_count - 1, depth + 1, red_depth);
+                node->right(right);
+                if (right)
+                    right->parent(node);
+
+                node->color = (depth == red_depth) ? rbcolor::red : rbcolor::black;
+
+                return node;
+            }
+
+            static bool is_red_(const node_type* node)
+            {
+                return node && node->color == rbcolor::red;
             }
 
-            void repair_after_erase_(const node_type* node, const node_type* child)
+            void rotate_left_(node_type* node)
             {
-                // TODO: implement
+                node->rotate_left();
+                if (root_ == node)
+                    root_ = node->parent();
+            }
+
+            void rotate_right_(node_type* node)
+            {
+                node->rotate_right();
+                if (root_ == node)
+                    root_ = node->parent();
+            }
+
+            void repair_after_insert_(node_type* node)
+            {
+                while (node != root_ && is_red_(node->parent()))
+                {
+                    auto parent = node->parent();
+                    auto grandparent = parent->parent(); // Red nodes are not roots.
+
+                    if (parent == grandparent->left())
+                    {
+                        auto uncle = grandparent->right();
+                        if (is_red_(uncle))
+                        {
+                            parent->color = rbcolor::black;
+                            uncle->color = rbcolor::black;
+                            grandparent->color = rbcolor::red;
+                            node = grandparent;
+
+                            continue;
+                        }
+
+                        if (node == parent->right())
+                        {
+                            node = parent;
+                            rotate_left_(node);
+                            parent = node->parent();
+                        }
+
+                        parent->color = rbcolor::black;
+                        grandparent->color = rbcolor::red;
+                        rotate_right_(grandparent);
+                    }
+                    else
+                    {
+                        auto uncle = grandparent->left();
+                        if (is_red_(uncle))
+                        {
+                            parent->color = rbcolor::black;
+                            uncle->color = rbcolor::black;
+                            grandparent->color = rbcolor::red;
+                            node = grandparent;
+
+                            continue;
+                        }
+
+                        if (node == parent->left())
+                        {
+                            node = parent;
+                            rotate_right_(node);
+                            parent = node->parent();
+                        }
+
+                        parent->color = rbcolor::black;
+                        grandparent->color = rbcolor::red;
+                        rotate_left_(grandparent);
+                    }
+                }
+
+                root_->color = rbcolor::black;
+            }
+
+            /**
+             * Node is a black leaf that is about to be removed,
+             * so its path is one black node short.
+             */
+            void repair_after_erase_(node_type* node)
+            {
+                while (node != root_ && !is_red_(node))
+                {
+                    auto parent = node->parent();
+                    if (node == parent->left())
+                    {
+                        auto brother = parent->right();
+                        if (is_red_(brother))
+                        {
+                            brother->color = rbcolor::black;
+                            parent->color = rbcolor::red;
+                            rotate_left_(parent);
+                            brother = parent->right();
+                        }
+
+                        if (!is_red_(brother->left()) && !is_red_(brother->right()))
+                        {
+                            brother->color = rbcolor::red;
+                            node = parent;
+
+                            continue;
+                        }
+
+                        if (!is_red_(brother->right()))
+                        {
+                            brother->left()->color = rbcolor::black;
+                            brother->color = rbcolor::red;
+                            rotate_right_(brother);
+                            brother = parent->right();
+                        }
+
+                        brother->color = parent->color;
+                        parent->color = rbcolor::black;
+                        brother->right()->color = rbcolor::black;
+                        rotate_left_(parent);
+                        node = root_;
+                    }
+                    else
+                    {
+                        auto brother = parent->left();
+                        if (is_red_(brother))
+                        {
+                            brother->color = rbcolor::black;
+                            parent->color = rbcolor::red;
+                            rotate_right_(parent);
+                            brother = parent->left();
+                        }
+
+                        if (!is_red_(brother->left()) && !is_red_(brother->right()))
+                        {
+                            brother->color = rbcolor::red;
+                            node = parent;
+
+                            continue;
+                        }
+
+                        if (!is_red_(brother->left()))
+                        {
+                            brother->right()->color = rbcolor::black;
+                            brother->color = rbcolor::red;
+                            rotate_left_(brother);
+                            brother = parent->left();
+                        }
+
+                        brother->color = parent->color;
+                        parent->color = rbcolor::black;
+                        brother->left()->color = rbcolor::black;
+                        rotate_right_(parent);
+                        node = root_;
+                    }
+                }
+
+                node->color = rbcolor::black;
             }
 
             friend Policy;
+
+            template<class, class, class, class, class, class, class, class, class, class>
+            friend class rbtree;
     };
 }
 
@@ -99,14 +99,56 @@ namespace std::aux
                 return false;
         }
 
+        /**
+         * Moves the right child of node to its place, node
+         * becomes the left child of its former right child.
+         */
         static void rotate_left(Node* node)
         {
-            // TODO: implement
+            auto child = node ? node->right() : nullptr;
+            if (!child)
+                return;
+
+            auto parent = node->parent();
+            auto was_left = is_left_child(node);
+            auto was_right = is_right_child(node);
+
+            node->right(child->left());
+            if (node->right())
+                node->right()->parent(node);
+
+            child->parent(parent);
+            if (was_left)
+                parent->left(child);
+            else if (was_right)
+                parent->right(child);
+
+            child->left(node);
+            node->parent(child);
         }
 
         static void rotate_right(Node* node)
         {
-            // TODO: implement
+            auto child = node ? node->left() : nullptr;
+            if (!child)
+                return;
+
+            auto parent = node->parent();
+            auto was_left = is_left_child(node);
+            auto was_right = is_right_child(node);
+
+            node->left(child->right());
+            if (node->left())
+                node->left()->parent(node);
+
+            child->parent(parent);
+            if (was_left)
+                parent->left(child);
+            else if (was_right)
+                parent->right(child);
+
+            child->right(node);
+            node->parent(child);
         }
 
         static Node* find_smallest(Node* node)
@@ -222,6 +264,28 @@ namespace std::aux
             auto right2 = node2->right();
             auto is_right2 = is_right_child(node2);
 
+            /**
+             * If one of the nodes is a child of the other
+             * (e.g. a node and its successor), the links
+             * between them have to point the other way.
+             */
+            if (parent1 == node2)
+            {
+                parent1 = node1;
+                if (left2 == node1)
+                    left2 = node2;
+                else
+                    right2 = node2;
+            }
+            else if (parent2 == node1)
+            {
+                parent2 = node2;
+                if (left1 == node2)
+                    left1 = node1;
+                else
+                    right1 = node1;
+            }
+
             assimilate(node1, parent2, left2, right2, is_right2);
             assimilate(node2, parent1, left1, right1, is_right1);
         }
@@ -400,23 +464,36 @@ namespace std::aux
                 return nullptr;
             }
 
-            rbtree_single_node* get_end()
+            rbtree_single_node* get_first()
             {
                 return this;
             }
 
-            const rbtree_single_node* get_end() const
+            rbtree_single_node* next() const
             {
-                return this;
+                return nullptr;
             }
 
-            ~rbtree_single_node()
+            /**
+             * Detaches the node, so that it can be
+             * inserted into a (possibly different) tree.
+             */
+            void reset()
             {
+                color = rbcolor::red;
                 parent_ = nullptr;
-                if (left_)
-                    delete left_;
-                if (right_)
-                    delete right_;
+                left_ = nullptr;
+                right_ = nullptr;
+            }
+
+            rbtree_single_node* get_end()
+            {
+                return this;
+            }
+
+            const rbtree_single_node* get_end() const
+            {
+                return this;
             }
 
         private:
@@ -560,7 +637,7 @@ namespace std::aux
                 if (next_)
                     return next_;
                 else
-                    return utils::successor(this);
+                    return utils::successor(first_);
             }
 
             rbtree_multi_node* predecessor()
@@ -589,7 +666,7 @@ namespace std::aux
                      * to the first node in the list. So we need
                      * to move to the end.
                      */
-                    while (tmp->next_ != nullptr)
+                    while (tmp && tmp->next_)
                         tmp = tmp->next_;
 
                     return tmp;
@@ -613,6 +690,19 @@ namespace std::aux
 
             rbtree_multi_node* get_node_for_deletion()
             {
+                if (this != first_)
+                {
+                    // Not in the tree, just remove it from the list.
+                    auto prev = first_;
+                    while (prev->next_ != this)
+                        prev = prev->next_;
+                    prev->next_ = next_;
+
+                    reset();
+
+                    return this;
+                }
+
                 /**
                  * To make sure we delete nodes in
                  * the order of their insertion
@@ -623,37 +713,31 @@ namespace std::aux
                 if (next_)
                 {
                     // Make next the new this.
-                    next_->first_ = next_;
+                    auto succ = next_;
+                    for (auto tmp = succ; tmp; tmp = tmp->next_)
+                    {
+                        tmp->first_ = succ;
+                        tmp->parent_ = parent_;
+                        tmp->left_ = left_;
+                        tmp->right_ = right_;
+                    }
+                    succ->color = color;
+
+                    /**
+                     * The setters make sure the lists of the
+                     * neighbours stay consistent.
+                     */
                     if (is_left_child())
-                        parent_->left_ = next_;
+                        parent_->left(succ);
                     else if (is_right_child())
-                        parent_->right_ = next_;
+                        parent_->right(succ);
 
                     if (left_)
-                        left_->parent_ = next_;
+                        left_->parent(succ);
                     if (right_)
-                        right_->parent_ = next_;
+                        right_->parent(succ);
 
-                    /**
-                     * Update the first_ pointer
-                     * of the rest of the list.
-                     */
-                    auto tmp = next_->next_;
-                    while (tmp)
-                    {
-                        tmp->first_ = next_;
-                        tmp = tmp->next_;
-                    }
-
-                    /**
-                     * Otherwise destructor could
-                     * destroy them.
-                     */
-                    parent_ = nullptr;
-                    left_ = nullptr;
-                    right_ = nullptr;
-                    next_ = nullptr;
-                    first_ = nullptr;
+                    reset();
 
                     return this; // This will get deleted.
                 }
@@ -669,18 +753,46 @@ namespace std::aux
                     parent_->right_ = nullptr;
             }
 
+            rbtree_multi_node* get_first()
+            {
+                return first_;
+            }
+
+            rbtree_multi_node* next() const
+            {
+                return next_;
+            }
+
+            /**
+             * Detaches the node, so that it can be
+             * inserted into a (possibly different) tree.
+             */
+            void reset()
+            {
+                color = rbcolor::red;
+                parent_ = nullptr;
+                left_ = nullptr;
+                right_ = nullptr;
+                next_ = nullptr;
+                first_ = this;
+            }
+
+            /**
+             * Appends node to the list of nodes with
+             * equivalent keys, in O(1) if called on
+             * the last node of the list.
+             */
             void add(rbtree_multi_node* node)
             {
-                if (next_)
-                    next_->add(node);
-                else
-                {
-                    next_ = node;
-                    next_->first_ = first_;
-                    next_->parent_ = parent_;
-                    next_->left_ = left_;
-                    next_->right_ = right_;
-                }
+                auto last = this;
+                while (last->next_)
+                    last = last->next_;
+
+                last->next_ = node;
+                node->first_ = first_;
+                node->parent_ = first_->parent_;
+                node->left_ = first_->left_;
+                node->right_ = first_->right_;
             }
 
             rbtree_multi_node* get_end()
@@ -704,17 +816,6 @@ namespace std::aux
                 }
             }
 
-            ~rbtree_multi_node()
-            {
-                parent_ = nullptr;
-                if (left_)
-                    delete left_;
-                if (right_)
-                    delete right_;
-
-                // TODO: delete the list
-            }
-
         private:
             rbtree_multi_node* parent_;
             rbtree_multi_node* left_;
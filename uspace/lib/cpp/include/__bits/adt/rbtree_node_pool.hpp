@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_RBTREE_NODE_POOL
+#define LIBCPP_BITS_ADT_RBTREE_NODE_POOL
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * Creates and destroys the nodes of a single tree. The storage
+     * of erased nodes is kept on a free list and reused by later
+     * inserts, so workloads that keep inserting and erasing do not
+     * go through the heap for every element.
+     *
+     * Every node still has storage of its own (instead of being
+     * carved from a larger slab), because extracted nodes can move
+     * to another tree and outlive this one. For the same reason,
+     * nodes can be destroyed by a pool other than the one that
+     * created them.
+     */
+    template<class Node>
+    class rbtree_node_pool
+    {
+        public:
+            rbtree_node_pool()
+                : free_{nullptr}, cached_{}, live_{}
+            { /* DUMMY BODY */ }
+
+            rbtree_node_pool(const rbtree_node_pool&) = delete;
+            rbtree_node_pool& operator=(const rbtree_node_pool&) = delete;
+
+            rbtree_node_pool(rbtree_node_pool&& other)
+                : free_{other.free_}, cached_{other.cached_},
+                  live_{other.live_}
+            {
+                other.free_ = nullptr;
+                other.cached_ = size_t{};
+                other.live_ = size_t{};
+            }
+
+            rbtree_node_pool& operator=(rbtree_node_pool&& other)
+            {
+                rbtree_node_pool tmp{move(other)};
+                swap(tmp);
+
+                return *this;
+            }
+
+            ~rbtree_node_pool()
+            {
+                release();
+            }
+
+            template<class... Args>
+            Node* create(Args&&... args)
+            {
+                void* storage{};
+                if (free_)
+                {
+                    storage = free_;
+                    free_ = free_->next;
+                    --cached_;
+                }
+                else
+                    storage = ::operator new(sizeof(Node));
+
+                ++live_;
+
+                return ::new(storage) Node{forward<Args>(args)...};
+            }
+
+            /**
+             * The free list is kept at most as long as the number
+             * of live nodes (with some slack for small trees), so
+             * a tree that shrinks for good does not hold on to all
+             * of its old memory.
+             */
+            void destroy(Node* node)
+            {
+                if (!node)
+                    return;
+
+                node->~Node();
+
+                if (live_ > 0)
+                    --live_;
+
+                if (cached_ < live_ || cached_ < min_cached)
+                {
+                    auto entry = ::new(static_cast<void*>(node)) free_entry{};
+                    entry->next = free_;
+                    free_ = entry;
+                    ++cached_;
+                }
+                else
+                    ::operator delete(static_cast<void*>(node));
+            }
+
+            /**
+             * Called when a node leaves the tree (extract)
+             * or joins it (merge, node handle insert).
+             */
+            void node_left()
+            {
+                if (live_ > 0)
+                    --live_;
+            }
+
+            void node_joined()
+            {
+                ++live_;
+            }
+
+            void release()
+            {
+                while (free_)
+                {
+                    auto entry = free_;
+                    free_ = free_->next;
+                    ::operator delete(static_cast<void*>(entry));
+                }
+                cached_ = size_t{};
+            }
+
+            void swap(rbtree_node_pool& other) noexcept
+            {
+                std::swap(free_, other.free_);
+                std::swap(cached_, other.cached_);
+                std::swap(live_, other.live_);
+            }
+
+            /**
+             * Destroys a node that does not belong to any tree
+             * (i.e. one owned by a node handle).
+             */
+            static void destroy_detached(Node* node)
+            {
+                if (!node)
+                    return;
+
+                node->~Node();
+                ::operator delete(static_cast<void*>(node));
+            }
+
+        private:
+            struct free_entry
+            {
+                free_entry* next;
+            };
+
+            static_assert(sizeof(Node) >= sizeof(free_entry));
+
+            static constexpr size_t min_cached{64};
+
+            free_entry* free_;
+            size_t cached_;
+            size_t live_;
+    };
+}
+
+#endif
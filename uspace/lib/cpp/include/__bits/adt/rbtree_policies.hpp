@@ -164,7 +164,6 @@ namespace std::aux
         {
             using value_type = typename Tree::value_type;
             using iterator   = typename Tree::iterator;
-            using node_type  = typename Tree::node_type;
 
             auto val = value_type{forward<Args>(args)...};
             auto parent = tree.find_parent_for_insertion(tree.get_key(val));
@@ -172,7 +171,7 @@ namespace std::aux
             if (parent && tree.keys_equal(tree.get_key(parent->value), tree.get_key(val)))
                 return make_pair(iterator{parent, false}, false);
 
-            auto node = new node_type{move(val)};
+            auto node = tree.create_node(move(val));
 
             return insert(tree, node, parent);
         }
@@ -182,14 +181,13 @@ namespace std::aux
             typename Tree::iterator, bool
         > insert(Tree& tree, const Value& val)
         {
-            using iterator  = typename Tree::iterator;
-            using node_type = typename Tree::node_type;
+            using iterator = typename Tree::iterator;
 
             auto parent = tree.find_parent_for_insertion(tree.get_key(val));
             if (parent && tree.keys_equal(tree.get_key(parent->value), tree.get_key(val)))
                 return make_pair(iterator{parent, false}, false);
 
-            auto node = new node_type{val};
+            auto node = tree.create_node(val);
 
             return insert(tree, node, parent);
         }
@@ -199,14 +197,13 @@ namespace std::aux
             typename Tree::iterator, bool
         > insert(Tree& tree, Value&& val)
         {
-            using iterator  = typename Tree::iterator;
-            using node_type = typename Tree::node_type;
+            using iterator = typename Tree::iterator;
 
             auto parent = tree.find_parent_for_insertion(tree.get_key(val));
             if (parent && tree.keys_equal(tree.get_key(parent->value), tree.get_key(val)))
                 return make_pair(iterator{parent, false}, false);
 
-            auto node = new node_type{forward<Value>(val)};
+            auto node = tree.create_node(forward<Value>(val));
 
             return insert(tree, node, parent);
         }
@@ -224,24 +221,76 @@ namespace std::aux
             if (!node)
                 return make_pair(tree.end(), false);
 
-            ++tree.size_;
-            if (!parent)
+            tree.attach_node_(
+                node, parent,
+                parent && tree.keys_comp(tree.get_key(node->value), parent->value)
+            );
+
+            return make_pair(iterator{node, false}, true);
+        }
+
+        template<class Tree, class... Args>
+        static typename Tree::iterator emplace_hint(
+            Tree& tree, typename Tree::const_iterator hint, Args&&... args
+        )
+        {
+            auto node = tree.create_node(forward<Args>(args)...);
+
+            return insert_hint(tree, hint, node).first;
+        }
+
+        template<class Tree>
+        static pair<
+            typename Tree::iterator, bool
+        > insert_hint(
+            Tree& tree, typename Tree::const_iterator hint,
+            typename Tree::node_type* node
+        )
+        {
+            using iterator  = typename Tree::iterator;
+            using node_type = typename Tree::node_type;
+
+            const auto& key = tree.get_key(node->value);
+
+            node_type* parent{};
+            bool left{};
+            if (tree.find_parent_for_hint_(hint, key, parent, left))
             {
-                node->color = rbcolor::black;
-                tree.root_ = node;
+                tree.attach_node_(node, parent, left);
+
+                return make_pair(iterator{node, false}, true);
             }
-            else
+
+            parent = tree.find_parent_for_insertion(key);
+            if (has_equivalent(tree, parent, key))
             {
-                if (tree.keys_comp(tree.get_key(node->value), parent->value))
-                    parent->add_left_child(node);
-                else
-                    parent->add_right_child(node);
+                tree.destroy_node(node);
 
-                tree.repair_after_insert_(node);
-                tree.update_root_(node);
+                return make_pair(iterator{parent, false}, false);
             }
 
-            return make_pair(iterator{node, false}, true);
+            return insert(tree, node, parent);
+        }
+
+        /**
+         * Used when building a tree from sorted input,
+         * the first of the equivalent elements is kept.
+         */
+        template<class Tree>
+        static bool add_equivalent(Tree& tree, typename Tree::node_type*,
+                                   typename Tree::node_type* node)
+        {
+            tree.destroy_node(node);
+
+            return false;
+        }
+
+        template<class Tree, class Key>
+        static bool has_equivalent(const Tree& tree,
+                                   const typename Tree::node_type* parent,
+                                   const Key& key)
+        {
+            return parent && tree.keys_equal(tree.get_key(parent->value), key);
         }
     };
 
@@ -385,9 +434,7 @@ namespace std::aux
         template<class Tree, class... Args>
         static typename Tree::iterator emplace(Tree& tree, Args&&... args)
         {
-            using node_type  = typename Tree::node_type;
-
-            auto node = new node_type{forward<Args>(args)...};
+            auto node = tree.create_node(forward<Args>(args)...);
 
             return insert(tree, node);
         }
@@ -395,9 +442,7 @@ namespace std::aux
         template<class Tree, class Value>
         static typename Tree::iterator insert(Tree& tree, const Value& val)
         {
-            using node_type = typename Tree::node_type;
-
-            auto node = new node_type{val};
+            auto node = tree.create_node(val);
 
             return insert(tree, node);
         }
@@ -405,9 +450,7 @@ namespace std::aux
         template<class Tree, class Value>
         static typename Tree::iterator insert(Tree& tree, Value&& val)
         {
-            using node_type = typename Tree::node_type;
-
-            auto node = new node_type{forward<Value>(val)};
+            auto node = tree.create_node(forward<Value>(val));
 
             return insert(tree, node);
         }
@@ -423,33 +466,71 @@ namespace std::aux
             if (!node)
                 return tree.end();
 
-            auto parent = tree.find_parent_for_insertion(tree.get_key(node->value));
+            const auto& key = tree.get_key(node->value);
+            auto parent = tree.find_parent_for_insertion(key);
 
-            ++tree.size_;
-            if (!parent)
+            if (parent && tree.keys_equal(tree.get_key(parent->value), key))
             {
-                node->color = rbcolor::black;
-                tree.root_ = node;
+                // List of nodes with equivalent keys.
+                ++tree.size_;
+                parent->add(node);
             }
             else
-            {
-                if (tree.keys_comp(tree.get_key(node->value), parent->value))
-                    parent->add_left_child(node);
-                else if (tree.keys_comp(tree.get_key(parent->value), node->value))
-                    parent->add_right_child(node);
-                else
-                {
-                    parent->add(node); // List of nodes with equivalent keys.
-                    tree.update_root_(parent);
+                tree.attach_node_(node, parent, parent && tree.keys_comp(key, parent->value));
 
-                    return iterator{node, false};
-                }
+            return iterator{node, false};
+        }
+
+        template<class Tree, class... Args>
+        static typename Tree::iterator emplace_hint(
+            Tree& tree, typename Tree::const_iterator hint, Args&&... args
+        )
+        {
+            auto node = tree.create_node(forward<Args>(args)...);
+
+            return insert_hint(tree, hint, node);
+        }
 
-                tree.repair_after_insert_(node);
-                tree.update_root_(node);
+        template<class Tree>
+        static typename Tree::iterator insert_hint(
+            Tree& tree, typename Tree::const_iterator hint,
+            typename Tree::node_type* node
+        )
+        {
+            using iterator  = typename Tree::iterator;
+            using node_type = typename Tree::node_type;
+
+            node_type* parent{};
+            bool left{};
+            if (tree.find_parent_for_hint_(hint, tree.get_key(node->value), parent, left))
+            {
+                tree.attach_node_(node, parent, left);
+
+                return iterator{node, false};
             }
 
-            return iterator{node, false};
+            // Equivalent keys go to the end of their list.
+            return insert(tree, node);
+        }
+
+        /**
+         * Used when building a tree from sorted input, last
+         * has to be the last node of its list.
+         */
+        template<class Tree>
+        static bool add_equivalent(Tree&, typename Tree::node_type* last,
+                                   typename Tree::node_type* node)
+        {
+            last->add(node);
+
+            return true;
+        }
+
+        template<class Tree, class Key>
+        static bool has_equivalent(const Tree&, const typename Tree::node_type*,
+                                   const Key&)
+        {
+            return false;
         }
     };
 }
@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_ADT_SET
 #define LIBCPP_BITS_ADT_SET
 
+#include <__bits/adt/node_handle.hpp>
 #include <__bits/adt/rbtree.hpp>
 #include <functional>
 #include <iterator>
@@ -37,6 +38,9 @@
 
 namespace std
 {
+    template<class Key, class Compare, class Alloc>
+    class multiset;
+
     /**
      * 23.4.6, class template set:
      */
@@ -61,7 +65,6 @@ namespace std
             using size_type       = size_t;
             using difference_type = ptrdiff_t;
 
-            using node_type = aux::rbtree_single_node<value_type>;
 
             /**
              * Note: Both the iterator and const_iterator (and their local variants)
@@ -69,13 +72,19 @@ namespace std
              *       to be the same type, but why not? :)
              */
             using iterator             = aux::rbtree_const_iterator<
-                value_type, const_reference, const_pointer, size_type, node_type
+                value_type, const_reference, const_pointer, size_type,
+                aux::rbtree_single_node<value_type>
             >;
             using const_iterator       = iterator;
 
             using reverse_iterator       = std::reverse_iterator<iterator>;
             using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+            using node_type = aux::set_node_handle<
+                aux::rbtree_single_node<value_type>, allocator_type, value_type
+            >;
+            using insert_return_type = aux::node_insert_return<iterator, node_type>;
+
             set()
                 : set{key_compare{}}
             { /* DUMMY BODY */ }
@@ -250,9 +259,9 @@ namespace std
             }
 
             template<class... Args>
-            iterator emplace_hint(const_iterator, Args&&... args)
+            iterator emplace_hint(const_iterator hint, Args&&... args)
             {
-                return emplace(forward<Args>(args)...).first;
+                return tree_.emplace_hint(hint, forward<Args>(args)...);
             }
 
             pair<iterator, bool> insert(const value_type& val)
@@ -265,21 +274,20 @@ namespace std
                 return tree_.insert(forward<value_type>(val));
             }
 
-            iterator insert(const_iterator, const value_type& val)
+            iterator insert(const_iterator hint, const value_type& val)
             {
-                return insert(val).first;
+                return tree_.emplace_hint(hint, val);
             }
 
-            iterator insert(const_iterator, value_type&& val)
+            iterator insert(const_iterator hint, value_type&& val)
             {
-                return insert(forward<value_type>(val)).first;
+                return tree_.emplace_hint(hint, forward<value_type>(val));
             }
 
             template<class InputIterator>
             void insert(InputIterator first, InputIterator last)
             {
-                while (first != last)
-                    insert(*first++);
+                tree_.insert_range(first, last);
             }
 
             void insert(initializer_list<value_type> init)
@@ -287,6 +295,48 @@ namespace std
                 insert(init.begin(), init.end());
             }
 
+            node_type extract(const_iterator position)
+            {
+                return node_type{tree_.extract_node(position), allocator_};
+            }
+
+            node_type extract(const key_type& key)
+            {
+                auto it = find(key);
+                if (it == end())
+                    return node_type{};
+
+                return extract(it);
+            }
+
+            insert_return_type insert(node_type&& nh)
+            {
+                if (nh.empty())
+                    return insert_return_type{end(), false, node_type{}};
+
+                const auto& key = nh.value();
+                auto parent = tree_.find_parent_for_insertion(key);
+                if (parent && tree_.keys_equal(tree_.get_key(parent->value), key))
+                    return insert_return_type{iterator{parent, false}, false, move(nh)};
+
+                auto node = nh.release_node();
+                tree_.adopt_node(node, parent);
+
+                return insert_return_type{iterator{node, false}, true, node_type{}};
+            }
+
+            /**
+             * Note: The hint is not used, checking for a duplicate
+             *       key costs a search anyway.
+             */
+            iterator insert(const_iterator, node_type&& nh)
+            {
+                auto res = insert(move(nh));
+                nh = move(res.node);
+
+                return res.position;
+            }
+
             iterator erase(const_iterator position)
             {
                 return tree_.erase(position);
@@ -320,6 +370,45 @@ namespace std
                 tree_.clear();
             }
 
+            template<class C2>
+            void merge(set<key_type, C2, allocator_type>& source)
+            {
+                tree_.merge(source.tree_);
+            }
+
+            template<class C2>
+            void merge(set<key_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
+            /**
+             * Note: Nodes of multisets differ from ours (they keep
+             *       lists of equivalent elements), so in this case
+             *       the elements are moved to new nodes.
+             */
+            template<class C2>
+            void merge(multiset<key_type, C2, allocator_type>& source)
+            {
+                auto it = source.begin();
+                while (it != source.end())
+                {
+                    if (find(*it) == end())
+                    {
+                        emplace(move(const_cast<value_type&>(*it)));
+                        it = source.erase(it);
+                    }
+                    else
+                        ++it;
+                }
+            }
+
+            template<class C2>
+            void merge(multiset<key_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
             key_compare key_comp() const
             {
                 return tree_.key_comp();
@@ -461,12 +550,15 @@ namespace std
                 key_type, key_type, aux::key_no_value_key_extractor<key_type>,
                 key_compare, allocator_type, size_type,
                 iterator, const_iterator,
-                aux::rbtree_single_policy, node_type
+                aux::rbtree_single_policy, aux::rbtree_single_node<value_type>
             >;
 
             tree_type tree_;
             allocator_type allocator_;
 
+            template<class, class, class>
+            friend class set;
+
             template<class K, class C, class A>
             friend bool operator==(const set<K, C, A>&,
                                    const set<K, C, A>&);
@@ -542,7 +634,6 @@ namespace std
             using size_type       = size_t;
             using difference_type = ptrdiff_t;
 
-            using node_type = aux::rbtree_multi_node<value_type>;
 
             /**
              * Note: Both the iterator and const_iterator types are constant
@@ -550,13 +641,18 @@ namespace std
              *       to be the same type, but why not? :)
              */
             using iterator             = aux::rbtree_const_iterator<
-                value_type, const_reference, const_pointer, size_type, node_type
+                value_type, const_reference, const_pointer, size_type,
+                aux::rbtree_multi_node<value_type>
             >;
             using const_iterator       = iterator;
 
             using reverse_iterator       = std::reverse_iterator<iterator>;
             using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+            using node_type = aux::set_node_handle<
+                aux::rbtree_multi_node<value_type>, allocator_type, value_type
+            >;
+
             multiset()
                 : multiset{key_compare{}}
             { /* DUMMY BODY */ }
@@ -731,9 +827,9 @@ namespace std
             }
 
             template<class... Args>
-            iterator emplace_hint(const_iterator, Args&&... args)
+            iterator emplace_hint(const_iterator hint, Args&&... args)
             {
-                return emplace(forward<Args>(args)...);
+                return tree_.emplace_hint(hint, forward<Args>(args)...);
             }
 
             iterator insert(const value_type& val)
@@ -746,21 +842,20 @@ namespace std
                 return tree_.insert(forward<value_type>(val));
             }
 
-            iterator insert(const_iterator, const value_type& val)
+            iterator insert(const_iterator hint, const value_type& val)
             {
-                return insert(val);
+                return tree_.emplace_hint(hint, val);
             }
 
-            iterator insert(const_iterator, value_type&& val)
+            iterator insert(const_iterator hint, value_type&& val)
             {
-                return insert(forward<value_type>(val));
+                return tree_.emplace_hint(hint, forward<value_type>(val));
             }
 
             template<class InputIterator>
             void insert(InputIterator first, InputIterator last)
             {
-                while (first != last)
-                    insert(*first++);
+                tree_.insert_range(first, last);
             }
 
             void insert(initializer_list<value_type> init)
@@ -768,6 +863,36 @@ namespace std
                 insert(init.begin(), init.end());
             }
 
+            node_type extract(const_iterator position)
+            {
+                return node_type{tree_.extract_node(position), allocator_};
+            }
+
+            node_type extract(const key_type& key)
+            {
+                auto it = find(key);
+                if (it == end())
+                    return node_type{};
+
+                return extract(it);
+            }
+
+            iterator insert(node_type&& nh)
+            {
+                if (nh.empty())
+                    return end();
+
+                return tree_.adopt_node(nh.release_node(), nullptr);
+            }
+
+            iterator insert(const_iterator hint, node_type&& nh)
+            {
+                if (nh.empty())
+                    return end();
+
+                return tree_.adopt_node(hint, nh.release_node());
+            }
+
             iterator erase(const_iterator position)
             {
                 return tree_.erase(position);
@@ -801,6 +926,36 @@ namespace std
                 tree_.clear();
             }
 
+            template<class C2>
+            void merge(multiset<key_type, C2, allocator_type>& source)
+            {
+                tree_.merge(source.tree_);
+            }
+
+            template<class C2>
+            void merge(multiset<key_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
+            /**
+             * Note: Nodes of sets differ from ours, so in this
+             *       case the elements are moved to new nodes.
+             */
+            template<class C2>
+            void merge(set<key_type, C2, allocator_type>& source)
+            {
+                for (const auto& val: source)
+                    emplace(move(const_cast<value_type&>(val)));
+                source.clear();
+            }
+
+            template<class C2>
+            void merge(set<key_type, C2, allocator_type>&& source)
+            {
+                merge(source);
+            }
+
             key_compare key_comp() const
             {
                 return tree_.key_comp();
@@ -942,12 +1097,15 @@ namespace std
                 key_type, key_type, aux::key_no_value_key_extractor<key_type>,
                 key_compare, allocator_type, size_type,
                 iterator, const_iterator,
-                aux::rbtree_multi_policy, node_type
+                aux::rbtree_multi_policy, aux::rbtree_multi_node<value_type>
             >;
 
             tree_type tree_;
             allocator_type allocator_;
 
+            template<class, class, class>
+            friend class multiset;
+
             template<class K, class C, class A>
             friend bool operator==(const multiset<K, C, A>&,
                                    const multiset<K, C, A>&);
@@ -29,10 +29,14 @@
 #ifndef LIBCPP_BITS_ADT_VECTOR
 #define LIBCPP_BITS_ADT_VECTOR
 
+#include <__bits/insert_iterator.hpp>
+#include <__bits/memory/memory_resource.hpp>
 #include <algorithm>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 namespace std
@@ -52,7 +56,7 @@ namespace std
             using size_type              = size_t;
             using difference_type        = ptrdiff_t;
             using pointer                = typename allocator_traits<Allocator>::pointer;
-            using const_pointer          = typename allocator_traits<Allocator>::pointer;
+            using const_pointer          = typename allocator_traits<Allocator>::const_pointer;
             using iterator               = pointer;
             using const_iterator         = const_pointer;
             using reverse_iterator       = std::reverse_iterator<iterator>;
@@ -68,40 +72,53 @@ namespace std
             { /* DUMMY BODY */ }
 
             explicit vector(size_type n, const Allocator& alloc = Allocator{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{nullptr}, size_{}, capacity_{}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
+                allocate_(n);
 
-                for (size_type i = 0; i < size_; ++i)
-                    allocator_traits<Allocator>::construct(allocator_, data_ + i);
+                for (; size_ < n; ++size_)
+                    allocator_traits<Allocator>::construct(allocator_, data_ + size_);
             }
 
             vector(size_type n, const T& val, const Allocator& alloc = Allocator{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{nullptr}, size_{}, capacity_{}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
+                allocate_(n);
 
-                for (size_type i = 0; i < size_; ++i)
-                    data_[i] = val;
+                for (; size_ < n; ++size_)
+                    allocator_traits<Allocator>::construct(allocator_, data_ + size_, val);
             }
 
-            template<class InputIterator>
+            template<
+                class InputIterator,
+                class = enable_if_t<!is_integral_v<InputIterator>>
+            >
             vector(InputIterator first, InputIterator last,
                    const Allocator& alloc = Allocator{})
+                : data_{nullptr}, size_{}, capacity_{}, allocator_{alloc}
             {
-                // TODO: research constraints and provide multiple
-                //       implementations via enable_if
+                using category = typename iterator_traits<InputIterator>::iterator_category;
+
+                if constexpr (is_base_of_v<forward_iterator_tag, category>)
+                {
+                    allocate_(static_cast<size_type>(distance(first, last)));
+                    size_ = construct_from_(first, last, data_);
+                }
+                else
+                {
+                    while (first != last)
+                        emplace_back(*first++);
+                }
             }
 
             vector(const vector& other)
-                : data_{nullptr}, size_{other.size_}, capacity_{other.capacity_},
-                  allocator_{other.allocator_}
-            {
-                data_ = allocator_.allocate(capacity_);
-
-                for (size_type i = 0; i < size_; ++i)
-                    data_[i] = other.data_[i];
-            }
+                : vector{
+                    other,
+                    allocator_traits<Allocator>::select_on_container_copy_construction(
+                        other.allocator_
+                    )
+                }
+            { /* DUMMY BODY */ }
 
             vector(vector&& other) noexcept
                 : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_},
@@ -113,37 +130,28 @@ namespace std
             }
 
             vector(const vector& other, const Allocator& alloc)
-                : data_{nullptr}, size_{other.size_}, capacity_{other.capacity_},
-                  allocator_{alloc}
+                : data_{nullptr}, size_{}, capacity_{}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
-
-                for (size_type i = 0; i < size_; ++i)
-                    data_[i] = other.data_[i];
+                allocate_(other.size_);
+                size_ = construct_from_(other.begin(), other.end(), data_);
             }
 
             vector(initializer_list<T> init, const Allocator& alloc = Allocator{})
-                : data_{nullptr}, size_{init.size()}, capacity_{init.size()},
-                  allocator_{alloc}
+                : data_{nullptr}, size_{}, capacity_{}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
-
-                auto it = init.begin();
-                for (size_type i = 0; it != init.end(); ++i, ++it)
-                {
-                    data_[i] = *it;
-                }
+                allocate_(init.size());
+                size_ = construct_from_(init.begin(), init.end(), data_);
             }
 
             ~vector()
             {
-                allocator_.deallocate(data_, capacity_);
+                release_();
             }
 
             vector& operator=(const vector& other)
             {
-                vector tmp{other};
-                swap(tmp);
+                if (this != &other)
+                    assign(other.begin(), other.end());
 
                 return *this;
             }
@@ -152,49 +160,126 @@ namespace std
                 noexcept(allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
                          allocator_traits<Allocator>::is_always_equal::value)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                using traits = allocator_traits<Allocator>;
+
+                if (this == &other)
+                    return *this;
+
+                if constexpr (!traits::propagate_on_container_move_assignment::value &&
+                              !traits::is_always_equal::value)
+                {
+                    /**
+                     * We cannot deallocate memory obtained from a different
+                     * allocator (e.g. a different memory resource), so the
+                     * elements have to be moved one by one.
+                     */
+                    if (allocator_ != other.allocator_)
+                    {
+                        assign(make_move_iterator(other.begin()), make_move_iterator(other.end()));
+                        other.clear();
+
+                        return *this;
+                    }
+                }
+
+                release_();
 
-                // TODO: test this
                 data_ = other.data_;
                 size_ = other.size_;
                 capacity_ = other.capacity_;
-                allocator_ = move(other.allocator_);
+                if constexpr (traits::propagate_on_container_move_assignment::value)
+                    allocator_ = move(other.allocator_);
 
                 other.data_ = nullptr;
                 other.size_ = size_type{};
                 other.capacity_ = size_type{};
-                other.allocator_ = allocator_type{};
+
                 return *this;
             }
 
             vector& operator=(initializer_list<T> init)
             {
-                vector tmp{init, allocator_};
-                swap(tmp);
+                assign(init.begin(), init.end());
 
                 return *this;
             }
 
-            template<class InputIterator>
+            /**
+             * Note: The assign functions reuse both the storage
+             *       and the existing elements whenever possible.
+             */
+            template<
+                class InputIterator,
+                class = enable_if_t<!is_integral_v<InputIterator>>
+            >
             void assign(InputIterator first, InputIterator last)
             {
-                vector tmp{first, last};
-                swap(tmp);
+                using category = typename iterator_traits<InputIterator>::iterator_category;
+
+                if constexpr (is_base_of_v<forward_iterator_tag, category>)
+                {
+                    auto count = static_cast<size_type>(distance(first, last));
+                    if (count > capacity_)
+                    {
+                        vector tmp{first, last, allocator_};
+                        swap(tmp);
+
+                        return;
+                    }
+
+                    auto it = begin();
+                    for (; it != end() && first != last; ++it, ++first)
+                        *it = *first;
+
+                    if (first != last)
+                        size_ += construct_from_(first, last, end());
+                    else
+                        erase(it, end());
+                }
+                else
+                {
+                    auto it = begin();
+                    for (; it != end() && first != last; ++it, ++first)
+                        *it = *first;
+
+                    if (first != last)
+                    {
+                        while (first != last)
+                            emplace_back(*first++);
+                    }
+                    else
+                        erase(it, end());
+                }
             }
 
             void assign(size_type size, const T& val)
             {
-                // Parenthesies required to avoid initializer list
-                // construction.
-                vector tmp(size, val);
-                swap(tmp);
+                if (size > capacity_)
+                {
+                    // Parenthesies required to avoid initializer list
+                    // construction.
+                    vector tmp(size, val, allocator_);
+                    swap(tmp);
+
+                    return;
+                }
+
+                auto to_assign = min(size, size_);
+                for (size_type i = 0; i < to_assign; ++i)
+                    data_[i] = val;
+
+                if (size > size_)
+                {
+                    for (; size_ < size; ++size_)
+                        allocator_traits<Allocator>::construct(allocator_, data_ + size_, val);
+                }
+                else
+                    erase(begin() + size, end());
             }
 
             void assign(initializer_list<T> init)
             {
-                vector tmp{init};
-                swap(tmp);
+                assign(init.begin(), init.end());
             }
 
             allocator_type get_allocator() const noexcept
@@ -274,16 +359,30 @@ namespace std
 
             void resize(size_type sz)
             {
-                resize_with_copy_(size_, capacity_);
+                if (sz <= size_)
+                {
+                    destroy_from_end_until_(begin() + sz);
+                    size_ = sz;
+
+                    return;
+                }
+
+                if (sz > capacity_)
+                    reallocate_(max(sz, next_capacity_()));
+
+                for (; size_ < sz; ++size_)
+                    allocator_traits<Allocator>::construct(allocator_, data_ + size_);
             }
 
             void resize(size_type sz, const value_type& val)
             {
-                auto old_size = size_;
-                resize_with_copy_(sz, capacity_);
-
-                for (size_type i = old_size - 1; i < size_; ++i)
-                    data_[i] = val;
+                if (sz <= size_)
+                {
+                    destroy_from_end_until_(begin() + sz);
+                    size_ = sz;
+                }
+                else
+                    insert(cend(), sz - size_, val);
             }
 
             size_type capacity() const noexcept
@@ -302,12 +401,15 @@ namespace std
                 //       length_error (this function shall have no
                 //       effect in such case)
                 if (new_capacity > capacity_)
-                    resize_with_copy_(size_, new_capacity);
+                    reallocate_(new_capacity);
             }
 
             void shrink_to_fit()
             {
-                resize_with_copy_(size_, size_);
+                if (size_ == 0)
+                    release_();
+                else if (size_ < capacity_)
+                    reallocate_(size_);
             }
 
             reference operator[](size_type idx)
@@ -356,7 +458,7 @@ namespace std
 
             const_reference back() const
             {
-                return at(size - 1);
+                return at(size_ - 1);
             }
 
             T* data() noexcept
@@ -372,27 +474,43 @@ namespace std
             template<class... Args>
             reference emplace_back(Args&&... args)
             {
-                if (size_ >= capacity_)
-                    resize_with_copy_(size_, next_capacity_());
+                if (size_ < capacity_)
+                {
+                    allocator_traits<Allocator>::construct(
+                        allocator_, data_ + size_, forward<Args>(args)...
+                    );
+                }
+                else
+                {
+                    /**
+                     * The arguments may refer to our own elements,
+                     * so we construct the new element before the
+                     * old ones are relocated.
+                     */
+                    auto new_capacity = next_capacity_();
+                    auto new_data = allocator_.allocate(new_capacity);
+
+                    allocator_traits<Allocator>::construct(
+                        allocator_, new_data + size_, forward<Args>(args)...
+                    );
+                    relocate_(data_, data_ + size_, new_data);
+
+                    replace_storage_(new_data, new_capacity);
+                }
 
-                allocator_traits<Allocator>::construct(allocator_,
-                                                       begin() + size_, forward<Args>(args)...);
+                ++size_;
 
                 return back();
             }
 
             void push_back(const T& x)
             {
-                if (size_ >= capacity_)
-                    resize_with_copy_(size_, next_capacity_());
-                data_[size_++] = x;
+                emplace_back(x);
             }
 
             void push_back(T&& x)
             {
-                if (size_ >= capacity_)
-                    resize_with_copy_(size_, next_capacity_());
-                data_[size_++] = forward<T>(x);
+                emplace_back(move(x));
             }
 
             void pop_back()
@@ -404,74 +522,104 @@ namespace std
             template<class... Args>
             iterator emplace(const_iterator position, Args&&... args)
             {
-                auto pos = const_cast<iterator>(position);
+                auto idx = static_cast<size_type>(position - cbegin());
 
-                pos = shift_(pos, 1);
-                allocator_.construct(pos, forward<Args>(args)...);
+                if (size_ == capacity_)
+                {
+                    auto new_capacity = next_capacity_();
+                    auto new_data = allocator_.allocate(new_capacity);
 
-                return pos;
+                    allocator_traits<Allocator>::construct(
+                        allocator_, new_data + idx, forward<Args>(args)...
+                    );
+                    relocate_(data_, data_ + idx, new_data);
+                    relocate_(data_ + idx, data_ + size_, new_data + idx + 1);
+
+                    replace_storage_(new_data, new_capacity);
+                }
+                else if (idx == size_)
+                {
+                    allocator_traits<Allocator>::construct(
+                        allocator_, data_ + size_, forward<Args>(args)...
+                    );
+                }
+                else
+                {
+                    // The arguments may refer to an element we are about to move.
+                    value_type tmp(forward<Args>(args)...);
+
+                    allocator_traits<Allocator>::construct(
+                        allocator_, data_ + size_, move(data_[size_ - 1])
+                    );
+                    move_backward(data_ + idx, data_ + size_ - 1, data_ + size_);
+                    data_[idx] = move(tmp);
+                }
+
+                ++size_;
+
+                return begin() + idx;
             }
 
             iterator insert(const_iterator position, const value_type& x)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, 1);
-                *pos = x;
-
-                return pos;
+                return emplace(position, x);
             }
 
             iterator insert(const_iterator position, value_type&& x)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, 1);
-                *pos = forward<value_type>(x);
-
-                return pos;
+                return emplace(position, move(x));
             }
 
             iterator insert(const_iterator position, size_type count, const value_type& x)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, count);
-                auto copy_target = pos;
-                for (size_type i = 0; i < count; ++i)
-                    *copy_target++ = x;
-
-                return pos;
+                /**
+                 * Note: The iterator holds a copy of x,
+                 *       which may be one of our elements.
+                 */
+                return insert_(
+                    position, aux::insert_iterator<value_type>{0u, x}, count
+                );
             }
 
-            template<class InputIterator>
+            template<
+                class InputIterator,
+                class = enable_if_t<!is_integral_v<InputIterator>>
+            >
             iterator insert(const_iterator position, InputIterator first,
                             InputIterator last)
             {
-                auto pos = const_cast<iterator>(position);
-                auto count = static_cast<size_type>(last - first);
+                using category = typename iterator_traits<InputIterator>::iterator_category;
+
+                if constexpr (is_base_of_v<forward_iterator_tag, category>)
+                {
+                    return insert_(
+                        position, first,
+                        static_cast<size_type>(distance(first, last))
+                    );
+                }
+                else
+                {
+                    auto idx = static_cast<size_type>(position - cbegin());
+                    auto old_size = size_;
 
-                pos = shift_(pos, count);
-                copy(first, last, pos);
+                    while (first != last)
+                        emplace_back(*first++);
+                    rotate(begin() + idx, begin() + old_size, end());
 
-                return pos;
+                    return begin() + idx;
+                }
             }
 
             iterator insert(const_iterator position, initializer_list<T> init)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, init.size());
-                copy(init.begin(), init.end(), pos);
-
-                return pos;
+                return insert_(position, init.begin(), init.size());
             }
 
             iterator erase(const_iterator position)
             {
                 iterator pos = const_cast<iterator>(position);
-                copy(position + 1, cend(), pos);
-                --size_;
+                move(pos + 1, end(), pos);
+                pop_back();
 
                 return pos;
             }
@@ -479,8 +627,12 @@ namespace std
             iterator erase(const_iterator first, const_iterator last)
             {
                 iterator pos = const_cast<iterator>(first);
-                copy(last, cend(), pos);
-                size_ -= static_cast<size_type>(last - first);
+                if (first == last)
+                    return pos;
+
+                auto new_end = move(const_cast<iterator>(last), end(), pos);
+                destroy_from_end_until_(new_end);
+                size_ = static_cast<size_type>(new_end - begin());
 
                 return pos;
             }
@@ -507,88 +659,195 @@ namespace std
             size_type capacity_;
             allocator_type allocator_;
 
-            void resize_without_copy_(size_type capacity)
+            /**
+             * Trivially copyable elements can be relocated by
+             * copying their bytes, everything else is moved
+             * (or copied if the move could throw) one by one.
+             */
+            static constexpr bool relocate_by_memcpy_{
+                is_trivially_copyable_v<value_type> &&
+                is_trivially_destructible_v<value_type>
+            };
+
+            void allocate_(size_type capacity)
+            {
+                if (capacity > 0)
+                    data_ = allocator_.allocate(capacity);
+                capacity_ = capacity;
+            }
+
+            void release_()
             {
                 if (data_)
+                {
+                    destroy_from_end_until_(begin());
                     allocator_.deallocate(data_, capacity_);
+                }
 
-                data_ = allocator_.allocate(capacity);
+                data_ = nullptr;
                 size_ = 0;
-                capacity_ = capacity;
+                capacity_ = 0;
             }
 
-            void resize_with_copy_(size_type size, size_type capacity)
+            /**
+             * Moves the elements in [first, last) to the
+             * uninitialized storage at target and destroys
+             * the originals.
+             */
+            void relocate_(value_type* first, value_type* last, value_type* target)
             {
-                if (size < size_)
-                    destroy_from_end_until_(begin() + size);
+                if (first == last)
+                    return;
 
-                if(capacity_ == 0 || capacity_ < capacity)
+                if constexpr (relocate_by_memcpy_)
                 {
-                    auto new_data = allocator_.allocate(capacity);
-
-                    auto to_copy = min(size, size_);
-                    for (size_type i = 0; i < to_copy; ++i)
-                        new_data[i] = move(data_[i]);
-
-                    std::swap(data_, new_data);
-
-                    allocator_.deallocate(new_data, capacity_);
+                    ::std::memcpy(
+                        static_cast<void*>(target), static_cast<const void*>(first),
+                        static_cast<size_type>(last - first) * sizeof(value_type)
+                    );
                 }
+                else
+                {
+                    for (auto it = first; it != last; ++it, ++target)
+                    {
+                        allocator_traits<Allocator>::construct(
+                            allocator_, target, move_if_noexcept(*it)
+                        );
+                    }
+
+                    if constexpr (!is_trivially_destructible_v<value_type>)
+                    {
+                        for (auto it = first; it != last; ++it)
+                            allocator_traits<Allocator>::destroy(allocator_, it);
+                    }
+                }
+            }
 
-                capacity_ = capacity;
-                size_ = size;
+            /**
+             * Frees the current storage (which is expected to
+             * be relocated already) and starts using new_data.
+             */
+            void replace_storage_(value_type* new_data, size_type new_capacity)
+            {
+                if (data_)
+                    allocator_.deallocate(data_, capacity_);
+
+                data_ = new_data;
+                capacity_ = new_capacity;
             }
 
-            void destroy_from_end_until_(iterator target)
+            void reallocate_(size_type capacity)
             {
-                if (!empty())
-                {
-                    auto last = end();
-                    while(last != target)
-                        allocator_traits<Allocator>::destroy(allocator_, --last);
-                }
+                auto new_data = allocator_.allocate(capacity);
+                relocate_(data_, data_ + size_, new_data);
+
+                replace_storage_(new_data, capacity);
             }
 
-            size_type next_capacity_(size_type hint = 0) const noexcept
+            /**
+             * Copy constructs the elements of the given range in
+             * the uninitialized storage at target, returns the
+             * number of constructed elements.
+             */
+            template<class Iterator>
+            size_type construct_from_(Iterator first, Iterator last, value_type* target)
             {
-                if (hint != 0)
-                    return max(capacity_ * 2, hint);
-                else
-                    return max(capacity_ * 2, size_type{2u});
+                size_type count{};
+                for (; first != last; ++first, ++count)
+                    allocator_traits<Allocator>::construct(allocator_, target + count, *first);
+
+                return count;
             }
 
-            iterator shift_(iterator position, size_type count)
+            /**
+             * Inserts count elements from the range starting
+             * at first before position.
+             */
+            template<class Iterator>
+            iterator insert_(const_iterator position, Iterator first, size_type count)
             {
-                if (size_ + count < capacity_)
-                {
-                    copy_backward(position, end(), end() + count);
-                    size_ += count;
+                auto idx = static_cast<size_type>(position - cbegin());
+                if (count == 0)
+                    return begin() + idx;
 
-                    return position;
+                if (size_ + count > capacity_)
+                {
+                    auto new_capacity = max(next_capacity_(), size_ + count);
+                    auto new_data = allocator_.allocate(new_capacity);
+
+                    for (size_type i = 0; i < count; ++i, ++first)
+                    {
+                        allocator_traits<Allocator>::construct(
+                            allocator_, new_data + idx + i, *first
+                        );
+                    }
+                    relocate_(data_, data_ + idx, new_data);
+                    relocate_(data_ + idx, data_ + size_, new_data + idx + count);
+
+                    replace_storage_(new_data, new_capacity);
                 }
                 else
                 {
-                    auto start_idx = static_cast<size_type>(position - begin());
-                    auto end_idx = start_idx + count;
-                    auto new_size = size_ + count;
-
-                    // Auxiliary vector for easier swap.
-                    vector tmp{};
-                    tmp.resize_without_copy_(max(new_size, capacity_));
-                    tmp.size_ = new_size;
-
-                    // Copy before insertion index.
-                    copy(begin(), begin() + start_idx, tmp.begin());
+                    auto pos = data_ + idx;
+                    auto old_end = data_ + size_;
+                    auto elements_after = size_ - idx;
+
+                    if (elements_after > count)
+                    {
+                        // The new elements only overwrite existing ones.
+                        for (auto it = old_end - count; it != old_end; ++it)
+                        {
+                            allocator_traits<Allocator>::construct(
+                                allocator_, it + count, move(*it)
+                            );
+                        }
+                        move_backward(pos, old_end - count, old_end);
+
+                        for (size_type i = 0; i < count; ++i, ++first)
+                            pos[i] = *first;
+                    }
+                    else
+                    {
+                        // Some of the new elements go to uninitialized storage.
+                        for (auto it = pos; it != old_end; ++it)
+                        {
+                            allocator_traits<Allocator>::construct(
+                                allocator_, it + count, move(*it)
+                            );
+                        }
+
+                        for (size_type i = 0; i < elements_after; ++i, ++first)
+                            pos[i] = *first;
+                        for (size_type i = elements_after; i < count; ++i, ++first)
+                            allocator_traits<Allocator>::construct(allocator_, pos + i, *first);
+                    }
+                }
 
-                    // Copy after insertion index.
-                    copy(begin() + start_idx, end(), tmp.begin() + end_idx);
+                size_ += count;
 
-                    swap(tmp);
+                return begin() + idx;
+            }
 
-                    // Position was invalidated!
-                    return begin() + start_idx;
+            void destroy_from_end_until_(iterator target)
+            {
+                if constexpr (!is_trivially_destructible_v<value_type>)
+                {
+                    if (!empty())
+                    {
+                        auto last = end();
+                        while(last != target)
+                            allocator_traits<Allocator>::destroy(allocator_, --last);
+                    }
                 }
             }
+
+            size_type next_capacity_(size_type hint = 0) const noexcept
+            {
+                if (hint != 0)
+                    return max(capacity_ * 2, hint);
+                else
+                    return max(capacity_ * 2, size_type{2u});
+            }
     };
 
     template<class T, class Alloc>
@@ -661,6 +920,12 @@ namespace std
      */
 
     // TODO: implement
+
+    namespace pmr
+    {
+        template<class T>
+        using vector = std::vector<T, polymorphic_allocator<T>>;
+    }
 }
 
 #endif
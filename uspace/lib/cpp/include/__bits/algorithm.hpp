@@ -30,6 +30,7 @@
 #define LIBCPP_BITS_ALGORITHM
 
 #include <iterator>
+#include <new>
 #include <utility>
 
 namespace std
@@ -408,9 +409,11 @@ namespace std
     BidirectionalIterator2 move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last,
                                          BidirectionalIterator2 result)
     {
-        // Note: We're copying [first, last) so we need to skip the initial value of last.
-        while (last-- != first)
-            *result-- = move(*last);
+        // Note: Unlike our copy_backward, result is one past the last destination.
+        while (first != last)
+            *--result = move(*--last);
+
+        return result;
     }
 
     /**
@@ -653,7 +656,50 @@ namespace std
      * 25.3.11, rotate:
      */
 
-    // TODO: implement
+    template<class ForwardIterator>
+    ForwardIterator rotate(ForwardIterator first, ForwardIterator middle,
+                           ForwardIterator last)
+    {
+        if (first == middle)
+            return last;
+        if (middle == last)
+            return first;
+
+        /**
+         * Swap the elements of [middle, last) into their final
+         * positions and then rotate the rest of the range
+         * the same way until nothing is left.
+         */
+        auto next = middle;
+        do
+        {
+            iter_swap(first++, next++);
+            if (first == middle)
+                middle = next;
+        } while (next != last);
+
+        auto res = first;
+        next = middle;
+        while (next != last)
+        {
+            iter_swap(first++, next++);
+            if (first == middle)
+                middle = next;
+            else if (next == last)
+                next = middle;
+        }
+
+        return res;
+    }
+
+    template<class ForwardIterator, class OutputIterator>
+    OutputIterator rotate_copy(ForwardIterator first, ForwardIterator middle,
+                               ForwardIterator last, OutputIterator result)
+    {
+        result = copy(middle, last, result);
+
+        return copy(first, middle, result);
+    }
 
     /**
      * 25.3.12, shuffle:
@@ -687,6 +733,303 @@ namespace std
     void sort_heap(RandomAccessIterator, RandomAccessIterator,
                    Compare);
 
+    template<class ForwardIterator, class T, class Compare>
+    ForwardIterator lower_bound(ForwardIterator, ForwardIterator,
+                                const T&, Compare);
+
+    template<class ForwardIterator, class T, class Compare>
+    ForwardIterator upper_bound(ForwardIterator, ForwardIterator,
+                                const T&, Compare);
+
+    namespace aux
+    {
+        template<class RandomAccessIterator, class Size, class Compare>
+        void correct_children(RandomAccessIterator, Size, Size, Compare);
+
+        /**
+         * Ranges up to this size are sorted by insertion sort,
+         * which is faster than partitioning them any further.
+         */
+        constexpr int sort_threshold{16};
+
+        /**
+         * Ranges larger than this use the median of three
+         * medians of three (Tukey's ninther) as a pivot.
+         */
+        constexpr int ninther_threshold{128};
+
+        template<class RandomAccessIterator, class Compare>
+        void insertion_sort(RandomAccessIterator first,
+                            RandomAccessIterator last, Compare comp)
+        {
+            if (first == last)
+                return;
+
+            for (auto it = first + 1; it != last; ++it)
+            {
+                auto tmp = move(*it);
+                auto hole = it;
+
+                while (hole != first && comp(tmp, *(hole - 1)))
+                {
+                    *hole = move(*(hole - 1));
+                    --hole;
+                }
+
+                *hole = move(tmp);
+            }
+        }
+
+        /**
+         * Orders the three elements so that *a <= *b <= *c.
+         */
+        template<class RandomAccessIterator, class Compare>
+        void sort3(RandomAccessIterator a, RandomAccessIterator b,
+                   RandomAccessIterator c, Compare comp)
+        {
+            if (comp(*b, *a))
+                iter_swap(a, b);
+
+            if (comp(*c, *b))
+            {
+                iter_swap(b, c);
+
+                if (comp(*b, *a))
+                    iter_swap(a, b);
+            }
+        }
+
+        /**
+         * Partitions the range around a pivot chosen from
+         * a sample of its elements and returns the final
+         * position of the pivot. Elements equal to the pivot
+         * may end up on both sides, which keeps ranges with
+         * many duplicates balanced.
+         */
+        template<class RandomAccessIterator, class Compare>
+        RandomAccessIterator partition_pivot(RandomAccessIterator first,
+                                             RandomAccessIterator last,
+                                             Compare comp)
+        {
+            auto count = last - first;
+            auto mid = first + count / 2;
+
+            if (count > ninther_threshold)
+            {
+                sort3(first, mid, last - 1, comp);
+                sort3(first + 1, mid - 1, last - 2, comp);
+                sort3(first + 2, mid + 1, last - 3, comp);
+                sort3(mid - 1, mid, mid + 1, comp);
+            }
+            else
+                sort3(first, mid, last - 1, comp);
+            iter_swap(first, mid);
+
+            auto pivot = first;
+            auto left = first;
+            auto right = last;
+            while (true)
+            {
+                do
+                    ++left;
+                while (left != last && comp(*left, *pivot));
+
+                // Stops at the pivot at the latest.
+                do
+                    --right;
+                while (comp(*pivot, *right));
+
+                if (!(left < right))
+                    break;
+
+                iter_swap(left, right);
+            }
+
+            iter_swap(pivot, right);
+
+            return right;
+        }
+
+        /**
+         * Returns the recursion depth after which introsort
+         * and introselect switch to heap based algorithms
+         * to guarantee O(n log n) time.
+         */
+        template<class Size>
+        Size sort_depth_limit(Size count)
+        {
+            Size depth{};
+            while (count > 1)
+            {
+                count /= 2;
+                ++depth;
+            }
+
+            return 2 * depth;
+        }
+
+        template<class RandomAccessIterator, class Size, class Compare>
+        void introsort_loop(RandomAccessIterator first,
+                            RandomAccessIterator last,
+                            Size depth, Compare comp)
+        {
+            while (last - first > sort_threshold)
+            {
+                if (depth == 0)
+                {
+                    make_heap(first, last, comp);
+                    sort_heap(first, last, comp);
+
+                    return;
+                }
+                --depth;
+
+                auto cut = partition_pivot(first, last, comp);
+
+                /**
+                 * Recurse into the smaller part only so that
+                 * the stack depth stays logarithmic.
+                 */
+                if (cut - first < last - cut)
+                {
+                    introsort_loop(first, cut, depth, comp);
+                    first = cut + 1;
+                }
+                else
+                {
+                    introsort_loop(cut + 1, last, depth, comp);
+                    last = cut;
+                }
+            }
+        }
+
+        /**
+         * Moves the smallest middle - first elements of the range
+         * to [first, middle), organized as a heap.
+         */
+        template<class RandomAccessIterator, class Compare>
+        void heap_select(RandomAccessIterator first,
+                         RandomAccessIterator middle,
+                         RandomAccessIterator last, Compare comp)
+        {
+            if (first == middle)
+                return;
+
+            make_heap(first, middle, comp);
+
+            auto count = middle - first;
+            for (auto it = middle; it != last; ++it)
+            {
+                if (comp(*it, *first))
+                {
+                    iter_swap(it, first);
+                    correct_children(first, decltype(count){}, count, comp);
+                }
+            }
+        }
+
+        /**
+         * Merges [first, middle) and [middle, last) using
+         * uninitialized storage for middle - first elements.
+         */
+        template<class RandomAccessIterator, class T, class Compare>
+        void merge_with_buffer(RandomAccessIterator first,
+                               RandomAccessIterator middle,
+                               RandomAccessIterator last,
+                               T* buffer, Compare comp)
+        {
+            auto buffer_end = buffer;
+            for (auto it = first; it != middle; ++it, ++buffer_end)
+                ::new(static_cast<void*>(buffer_end)) T(move(*it));
+
+            auto left = buffer;
+            auto right = middle;
+            auto out = first;
+            while (left != buffer_end && right != last)
+            {
+                // Ties are taken from the left to keep the sort stable.
+                if (comp(*right, *left))
+                    *out++ = move(*right++);
+                else
+                    *out++ = move(*left++);
+            }
+
+            // Elements left in [right, last) are already in place.
+            while (left != buffer_end)
+                *out++ = move(*left++);
+
+            for (auto it = buffer; it != buffer_end; ++it)
+                it->~T();
+        }
+
+        /**
+         * Merges [first, middle) and [middle, last) in place
+         * by recursively rotating their parts, used when no
+         * memory is available for a buffer.
+         */
+        template<class RandomAccessIterator, class Compare>
+        void merge_without_buffer(RandomAccessIterator first,
+                                  RandomAccessIterator middle,
+                                  RandomAccessIterator last,
+                                  Compare comp)
+        {
+            auto count1 = middle - first;
+            auto count2 = last - middle;
+            if (count1 == 0 || count2 == 0)
+                return;
+
+            if (count1 + count2 == 2)
+            {
+                if (comp(*middle, *first))
+                    iter_swap(first, middle);
+
+                return;
+            }
+
+            RandomAccessIterator cut1, cut2;
+            if (count1 > count2)
+            {
+                cut1 = first + count1 / 2;
+                cut2 = lower_bound(middle, last, *cut1, comp);
+            }
+            else
+            {
+                cut2 = middle + count2 / 2;
+                cut1 = upper_bound(first, middle, *cut2, comp);
+            }
+
+            auto new_middle = rotate(cut1, middle, cut2);
+            merge_without_buffer(first, cut1, new_middle, comp);
+            merge_without_buffer(new_middle, cut2, last, comp);
+        }
+
+        template<class RandomAccessIterator, class T, class Compare>
+        void merge_sort(RandomAccessIterator first,
+                        RandomAccessIterator last,
+                        T* buffer, Compare comp)
+        {
+            if (last - first <= sort_threshold)
+            {
+                insertion_sort(first, last, comp);
+
+                return;
+            }
+
+            auto middle = first + (last - first) / 2;
+            merge_sort(first, middle, buffer, comp);
+            merge_sort(middle, last, buffer, comp);
+
+            // Already ordered, common with partially sorted input.
+            if (!comp(*middle, *(middle - 1)))
+                return;
+
+            if (buffer)
+                merge_with_buffer(first, middle, last, buffer, comp);
+            else
+                merge_without_buffer(first, middle, last, comp);
+        }
+    }
+
     template<class RandomAccessIterator>
     void sort(RandomAccessIterator first, RandomAccessIterator last)
     {
@@ -700,89 +1043,231 @@ namespace std
               Compare comp)
     {
         /**
-         * Note: This isn't the most effective approach,
-         *       but since we already have these two functions
-         *       and they satisfy asymptotic limitations
-         *       imposed by the standard, we're using them at
-         *       the moment. Might be good to change it to qsort
-         *       or merge sort later.
+         * Introsort: quicksort that falls back to heapsort
+         * when the recursion gets too deep. Small partitions
+         * are left unsorted and finished by a single pass of
+         * insertion sort over the whole range, since every
+         * element is at most sort_threshold positions away
+         * from its final place by then.
          */
+        auto count = last - first;
+        if (count < 2)
+            return;
 
-        make_heap(first, last, comp);
-        sort_heap(first, last, comp);
+        aux::introsort_loop(first, last, aux::sort_depth_limit(count), comp);
+        aux::insertion_sort(first, last, comp);
     }
 
     /**
      * 25.4.1.2, stable_sort:
      */
 
-    // TODO: implement
+    template<class RandomAccessIterator>
+    void stable_sort(RandomAccessIterator first, RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        stable_sort(first, last, less<value_type>{});
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void stable_sort(RandomAccessIterator first, RandomAccessIterator last,
+                     Compare comp)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        auto count = last - first;
+        if (count <= aux::sort_threshold)
+        {
+            aux::insertion_sort(first, last, comp);
+
+            return;
+        }
+
+        /**
+         * The left half of a merge is never longer than
+         * count / 2 elements. If there is not enough memory
+         * for the buffer, we merge in place instead, which
+         * results in O(n log^2 n) time.
+         */
+        auto buffer = static_cast<value_type*>(::operator new(
+            sizeof(value_type) * (count / 2), nothrow
+        ));
+
+        aux::merge_sort(first, last, buffer, comp);
+
+        if (buffer)
+            ::operator delete(buffer);
+    }
 
     /**
      * 25.4.1.3, partial_sort:
      */
 
-    // TODO: implement
+    template<class RandomAccessIterator>
+    void partial_sort(RandomAccessIterator first,
+                      RandomAccessIterator middle,
+                      RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
 
-    /**
-     * 25.4.1.4, partial_sort_copy:
-     */
+        partial_sort(first, middle, last, less<value_type>{});
+    }
 
-    // TODO: implement
+    template<class RandomAccessIterator, class Compare>
+    void partial_sort(RandomAccessIterator first,
+                      RandomAccessIterator middle,
+                      RandomAccessIterator last,
+                      Compare comp)
+    {
+        aux::heap_select(first, middle, last, comp);
+        sort_heap(first, middle, comp);
+    }
 
     /**
-     * 25.4.1.5, is_sorted:
+     * 25.4.1.4, partial_sort_copy:
      */
 
-    template<class ForwardIterator>
-    bool is_sorted(ForwardIterator first, ForwardIterator last)
+    template<class InputIterator, class RandomAccessIterator>
+    RandomAccessIterator partial_sort_copy(InputIterator first,
+                                           InputIterator last,
+                                           RandomAccessIterator result_first,
+                                           RandomAccessIterator result_last)
     {
-        return is_sorted_until(first, last) == last;
-    }
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
 
-    template<class ForwardIterator, class Comp>
-    bool is_sorted(ForwardIterator first, ForwardIterator last,
-                   Comp comp)
-    {
-        return is_sorted_until(first, last, comp) == last;
+        return partial_sort_copy(
+            first, last, result_first, result_last,
+            less<value_type>{}
+        );
     }
 
-    template<class ForwardIterator>
-    ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last)
+    template<class InputIterator, class RandomAccessIterator, class Compare>
+    RandomAccessIterator partial_sort_copy(InputIterator first,
+                                           InputIterator last,
+                                           RandomAccessIterator result_first,
+                                           RandomAccessIterator result_last,
+                                           Compare comp)
     {
-        if (distance(first, last) < 2)
-            return last;
+        if (result_first == result_last)
+            return result_last;
 
-        while (first != last)
+        auto result = result_first;
+        while (first != last && result != result_last)
+            *result++ = *first++;
+
+        make_heap(result_first, result, comp);
+
+        auto count = result - result_first;
+        for (; first != last; ++first)
         {
-            if (*first > *(++first))
-                return first;
+            if (comp(*first, *result_first))
+            {
+                *result_first = *first;
+                aux::correct_children(
+                    result_first, decltype(count){}, count, comp
+                );
+            }
         }
 
-        return last;
+        sort_heap(result_first, result, comp);
+
+        return result;
     }
 
+    /**
+     * 25.4.1.5, is_sorted:
+     */
+
     template<class ForwardIterator, class Comp>
     ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last,
                                     Comp comp)
     {
-        if (distance(first, last) < 2)
+        if (first == last)
             return last;
 
-        while (first != last)
+        auto next = first;
+        while (++next != last)
         {
-            if (!comp(*first, *(++first)))
-                return first;
+            if (comp(*next, *first))
+                return next;
+            first = next;
         }
 
         return last;
     }
 
+    template<class ForwardIterator>
+    ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last)
+    {
+        using value_type = typename iterator_traits<ForwardIterator>::value_type;
+
+        return is_sorted_until(first, last, less<value_type>{});
+    }
+
+    template<class ForwardIterator>
+    bool is_sorted(ForwardIterator first, ForwardIterator last)
+    {
+        return is_sorted_until(first, last) == last;
+    }
+
+    template<class ForwardIterator, class Comp>
+    bool is_sorted(ForwardIterator first, ForwardIterator last,
+                   Comp comp)
+    {
+        return is_sorted_until(first, last, comp) == last;
+    }
+
     /**
      * 25.4.2, nth_element:
      */
 
-    // TODO: implement
+    template<class RandomAccessIterator>
+    void nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                     RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        nth_element(first, nth, last, less<value_type>{});
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                     RandomAccessIterator last, Compare comp)
+    {
+        if (nth == last)
+            return;
+
+        /**
+         * Introselect: quickselect with the same pivot selection
+         * as sort, falling back to heap selection when partitioning
+         * does not shrink the range fast enough.
+         */
+        auto depth = aux::sort_depth_limit(last - first);
+        while (last - first > aux::sort_threshold)
+        {
+            if (depth == 0)
+            {
+                aux::heap_select(first, nth + 1, last, comp);
+
+                // The largest of the selected elements is the nth.
+                iter_swap(first, nth);
+
+                return;
+            }
+            --depth;
+
+            auto cut = aux::partition_pivot(first, last, comp);
+            if (cut == nth)
+                return;
+            else if (nth < cut)
+                last = cut;
+            else
+                first = cut + 1;
+        }
+
+        aux::insertion_sort(first, last, comp);
+    }
 
     /**
      * 25.4.3, binary search:
@@ -792,13 +1277,79 @@ namespace std
      * 25.4.3.1, lower_bound
      */
 
-    // TODO: implement
+    template<class ForwardIterator, class T>
+    ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last,
+                                const T& value)
+    {
+        return lower_bound(
+            first, last, value,
+            [](const auto& lhs, const auto& rhs){
+                return lhs < rhs;
+            }
+        );
+    }
+
+    template<class ForwardIterator, class T, class Compare>
+    ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last,
+                                const T& value, Compare comp)
+    {
+        auto count = distance(first, last);
+        while (count > 0)
+        {
+            auto step = count / 2;
+            auto it = first;
+            advance(it, step);
+
+            if (comp(*it, value))
+            {
+                first = ++it;
+                count -= step + 1;
+            }
+            else
+                count = step;
+        }
+
+        return first;
+    }
 
     /**
      * 25.4.3.2, upper_bound
      */
 
-    // TODO: implement
+    template<class ForwardIterator, class T>
+    ForwardIterator upper_bound(ForwardIterator first, ForwardIterator last,
+                                const T& value)
+    {
+        return upper_bound(
+            first, last, value,
+            [](const auto& lhs, const auto& rhs){
+                return lhs < rhs;
+            }
+        );
+    }
+
+    template<class ForwardIterator, class T, class Compare>
+    ForwardIterator upper_bound(ForwardIterator first, ForwardIterator last,
+                                const T& value, Compare comp)
+    {
+        auto count = distance(first, last);
+        while (count > 0)
+        {
+            auto step = count / 2;
+            auto it = first;
+            advance(it, step);
+
+            if (!comp(value, *it))
+            {
+                first = ++it;
+                count -= step + 1;
+            }
+            else
+                count = step;
+        }
+
+        return first;
+    }
 
     /**
      * 25.4.3.3, equal_range:
@@ -883,32 +1434,22 @@ namespace std
             using aux::heap_left_child;
             using aux::heap_right_child;
 
-            auto left = heap_left_child(idx);
-            auto right = heap_right_child(idx);
-
-            bool left_incorrect{comp(first[idx], first[left])};
-            bool right_incorrect{comp(first[idx], first[right])};
-            while ((left < count && left_incorrect) ||
-                   (right < count && right_incorrect))
+            while (true)
             {
-                if (right >= count || (left_incorrect && comp(first[right], first[left])))
-                {
-                    swap(first[idx], first[left]);
-
-                    idx = left;
-                }
-                else if (right < count && right_incorrect)
-                {
-                    swap(first[idx], first[right]);
+                auto left = heap_left_child(idx);
+                auto right = heap_right_child(idx);
+                auto largest = idx;
 
-                    idx = right;
-                } // Else should not happen because of the while condition.
+                if (left < count && comp(first[largest], first[left]))
+                    largest = left;
+                if (right < count && comp(first[largest], first[right]))
+                    largest = right;
 
-                left = heap_left_child(idx);
-                right = heap_right_child(idx);
+                if (largest == idx)
+                    return;
 
-                left_incorrect = comp(first[idx], first[left]);
-                right_incorrect = comp(first[idx], first[right]);
+                swap(first[idx], first[largest]);
+                idx = largest;
             }
         }
     }
@@ -971,7 +1512,7 @@ namespace std
             return;
 
         swap(first[0], first[count - 1]);
-        aux::correct_children(first, decltype(count){}, count - 2, comp);
+        aux::correct_children(first, decltype(count){}, count - 1, comp);
     }
 
     /**
@@ -996,7 +1537,8 @@ namespace std
         if (count <= 1)
             return;
 
-        for (auto i = count; i > 0; --i)
+        // Leaves are heaps already.
+        for (auto i = count / 2; i > 0; --i)
         {
             auto idx = i - 1;
 
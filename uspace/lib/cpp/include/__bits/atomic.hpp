@@ -29,6 +29,726 @@
 #ifndef LIBCPP_BITS_ATOMIC
 #define LIBCPP_BITS_ATOMIC
 
-#error "<atomic> is not implemented"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * 29.4, lock-free property:
+ */
+
+#define ATOMIC_BOOL_LOCK_FREE     __GCC_ATOMIC_BOOL_LOCK_FREE
+#define ATOMIC_CHAR_LOCK_FREE     __GCC_ATOMIC_CHAR_LOCK_FREE
+#define ATOMIC_CHAR16_T_LOCK_FREE __GCC_ATOMIC_CHAR16_T_LOCK_FREE
+#define ATOMIC_CHAR32_T_LOCK_FREE __GCC_ATOMIC_CHAR32_T_LOCK_FREE
+#define ATOMIC_WCHAR_T_LOCK_FREE  __GCC_ATOMIC_WCHAR_T_LOCK_FREE
+#define ATOMIC_SHORT_LOCK_FREE    __GCC_ATOMIC_SHORT_LOCK_FREE
+#define ATOMIC_INT_LOCK_FREE      __GCC_ATOMIC_INT_LOCK_FREE
+#define ATOMIC_LONG_LOCK_FREE     __GCC_ATOMIC_LONG_LOCK_FREE
+#define ATOMIC_LLONG_LOCK_FREE    __GCC_ATOMIC_LLONG_LOCK_FREE
+#define ATOMIC_POINTER_LOCK_FREE  __GCC_ATOMIC_POINTER_LOCK_FREE
+
+/**
+ * 29.6.5, requirements for operations on atomic types:
+ */
+
+#define ATOMIC_VAR_INIT(value) {value}
+
+/**
+ * 29.7, flag type and operations:
+ */
+
+#define ATOMIC_FLAG_INIT {false}
+
+namespace std
+{
+    /**
+     * 29.3, order and consistency:
+     * Note: The values match those of the __ATOMIC_*
+     *       macros, so orders can be passed straight
+     *       to the compiler builtins.
+     */
+
+    enum memory_order
+    {
+        memory_order_relaxed = __ATOMIC_RELAXED,
+        memory_order_consume = __ATOMIC_CONSUME,
+        memory_order_acquire = __ATOMIC_ACQUIRE,
+        memory_order_release = __ATOMIC_RELEASE,
+        memory_order_acq_rel = __ATOMIC_ACQ_REL,
+        memory_order_seq_cst = __ATOMIC_SEQ_CST
+    };
+
+    template<class T>
+    T kill_dependency(T y) noexcept
+    {
+        return y;
+    }
+
+    namespace aux
+    {
+        /**
+         * The failure order of a compare exchange cannot
+         * contain a release, this derives it from the
+         * success order when the user specifies only one.
+         */
+        constexpr memory_order cmpxchg_failure_order(memory_order order) noexcept
+        {
+            if (order == memory_order_acq_rel)
+                return memory_order_acquire;
+            else if (order == memory_order_release)
+                return memory_order_relaxed;
+            else
+                return order;
+        }
+
+        /**
+         * Objects whose size is a power of two need to be
+         * naturally aligned for the hardware to operate
+         * on them atomically, for other objects this
+         * is just the alignment of the type.
+         */
+        template<class T>
+        inline constexpr size_t atomic_alignment =
+            ((sizeof(T) & (sizeof(T) - 1)) == 0 && sizeof(T) > alignof(T))
+            ? sizeof(T) : alignof(T);
+
+        /**
+         * Note: Operations are declared volatile only,
+         *       non-volatile objects bind to them through
+         *       a qualification conversion, so we avoid
+         *       duplicating every member. The exception
+         *       is operator=, which would otherwise be
+         *       ambiguous with the deleted copy assignment.
+         */
+        template<class T>
+        class atomic_base
+        {
+            static_assert(is_trivially_copyable_v<T>);
+
+            public:
+                static constexpr bool is_always_lock_free =
+                    __atomic_always_lock_free(sizeof(T), 0);
+
+                atomic_base() noexcept = default;
+
+                constexpr atomic_base(T desired) noexcept
+                    : value_{desired}
+                { /* DUMMY BODY */ }
+
+                atomic_base(const atomic_base&) = delete;
+                atomic_base& operator=(const atomic_base&) = delete;
+                atomic_base& operator=(const atomic_base&) volatile = delete;
+
+                /**
+                 * Note: Since value_ is naturally aligned, we can
+                 *       answer this at compile time and avoid
+                 *       the libatomic call.
+                 */
+                bool is_lock_free() const volatile noexcept
+                {
+                    return is_always_lock_free;
+                }
+
+                void store(T desired, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    __atomic_store(&value_, &desired, order);
+                }
+
+                T load(memory_order order = memory_order_seq_cst) const volatile noexcept
+                {
+                    alignas(T) unsigned char buffer[sizeof(T)];
+                    T* res = reinterpret_cast<T*>(buffer);
+
+                    __atomic_load(&value_, res, order);
+
+                    return *res;
+                }
+
+                operator T() const volatile noexcept
+                {
+                    return load();
+                }
+
+                T operator=(T desired) noexcept
+                {
+                    store(desired);
+
+                    return desired;
+                }
+
+                T operator=(T desired) volatile noexcept
+                {
+                    store(desired);
+
+                    return desired;
+                }
+
+                T exchange(T desired, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    alignas(T) unsigned char buffer[sizeof(T)];
+                    T* res = reinterpret_cast<T*>(buffer);
+
+                    __atomic_exchange(&value_, &desired, res, order);
+
+                    return *res;
+                }
+
+                bool compare_exchange_weak(T& expected, T desired, memory_order success,
+                                           memory_order failure) volatile noexcept
+                {
+                    return __atomic_compare_exchange(&value_, &expected, &desired,
+                                                     true, success, failure);
+                }
+
+                bool compare_exchange_weak(T& expected, T desired,
+                                           memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return compare_exchange_weak(
+                        expected, desired, order, cmpxchg_failure_order(order)
+                    );
+                }
+
+                bool compare_exchange_strong(T& expected, T desired, memory_order success,
+                                             memory_order failure) volatile noexcept
+                {
+                    return __atomic_compare_exchange(&value_, &expected, &desired,
+                                                     false, success, failure);
+                }
+
+                bool compare_exchange_strong(T& expected, T desired,
+                                             memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return compare_exchange_strong(
+                        expected, desired, order, cmpxchg_failure_order(order)
+                    );
+                }
+
+            protected:
+                alignas(atomic_alignment<T>) T value_;
+        };
+
+        /**
+         * Integral types additionally get the fetch-and-modify
+         * operations, all of which map to a single builtin.
+         */
+        template<class T>
+        class atomic_integral_base: public atomic_base<T>
+        {
+            public:
+                using atomic_base<T>::atomic_base;
+                using atomic_base<T>::operator=;
+
+                T fetch_add(T arg, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return __atomic_fetch_add(&this->value_, arg, order);
+                }
+
+                T fetch_sub(T arg, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return __atomic_fetch_sub(&this->value_, arg, order);
+                }
+
+                T fetch_and(T arg, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return __atomic_fetch_and(&this->value_, arg, order);
+                }
+
+                T fetch_or(T arg, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return __atomic_fetch_or(&this->value_, arg, order);
+                }
+
+                T fetch_xor(T arg, memory_order order = memory_order_seq_cst) volatile noexcept
+                {
+                    return __atomic_fetch_xor(&this->value_, arg, order);
+                }
+
+                T operator++(int) volatile noexcept
+                {
+                    return fetch_add(1);
+                }
+
+                T operator--(int) volatile noexcept
+                {
+                    return fetch_sub(1);
+                }
+
+                T operator++() volatile noexcept
+                {
+                    return __atomic_add_fetch(&this->value_, 1, memory_order_seq_cst);
+                }
+
+                T operator--() volatile noexcept
+                {
+                    return __atomic_sub_fetch(&this->value_, 1, memory_order_seq_cst);
+                }
+
+                T operator+=(T arg) volatile noexcept
+                {
+                    return __atomic_add_fetch(&this->value_, arg, memory_order_seq_cst);
+                }
+
+                T operator-=(T arg) volatile noexcept
+                {
+                    return __atomic_sub_fetch(&this->value_, arg, memory_order_seq_cst);
+                }
+
+                T operator&=(T arg) volatile noexcept
+                {
+                    return __atomic_and_fetch(&this->value_, arg, memory_order_seq_cst);
+                }
+
+                T operator|=(T arg) volatile noexcept
+                {
+                    return __atomic_or_fetch(&this->value_, arg, memory_order_seq_cst);
+                }
+
+                T operator^=(T arg) volatile noexcept
+                {
+                    return __atomic_xor_fetch(&this->value_, arg, memory_order_seq_cst);
+                }
+        };
+    }
+
+    /**
+     * 29.5, atomic types:
+     */
+
+    template<class T>
+    struct atomic: aux::atomic_base<T>
+    {
+        using aux::atomic_base<T>::atomic_base;
+        using aux::atomic_base<T>::operator=;
+    };
+
+    /**
+     * Note: The builtins do not scale the argument of
+     *       fetch_add and fetch_sub on pointers, so we
+     *       have to do that ourselves.
+     */
+    template<class T>
+    struct atomic<T*>: aux::atomic_base<T*>
+    {
+        using aux::atomic_base<T*>::atomic_base;
+        using aux::atomic_base<T*>::operator=;
+
+        T* fetch_add(ptrdiff_t arg, memory_order order = memory_order_seq_cst) volatile noexcept
+        {
+            return __atomic_fetch_add(&this->value_, arg * sizeof(T), order);
+        }
+
+        T* fetch_sub(ptrdiff_t arg, memory_order order = memory_order_seq_cst) volatile noexcept
+        {
+            return __atomic_fetch_sub(&this->value_, arg * sizeof(T), order);
+        }
+
+        T* operator++(int) volatile noexcept
+        {
+            return fetch_add(1);
+        }
+
+        T* operator--(int) volatile noexcept
+        {
+            return fetch_sub(1);
+        }
+
+        T* operator++() volatile noexcept
+        {
+            return fetch_add(1) + 1;
+        }
+
+        T* operator--() volatile noexcept
+        {
+            return fetch_sub(1) - 1;
+        }
+
+        T* operator+=(ptrdiff_t arg) volatile noexcept
+        {
+            return fetch_add(arg) + arg;
+        }
+
+        T* operator-=(ptrdiff_t arg) volatile noexcept
+        {
+            return fetch_sub(arg) - arg;
+        }
+    };
+
+    template<>
+    struct atomic<bool>: aux::atomic_base<bool>
+    {
+        using aux::atomic_base<bool>::atomic_base;
+        using aux::atomic_base<bool>::operator=;
+    };
+
+    template<>
+    struct atomic<char>: aux::atomic_integral_base<char>
+    {
+        using aux::atomic_integral_base<char>::atomic_integral_base;
+        using aux::atomic_integral_base<char>::operator=;
+    };
+
+    template<>
+    struct atomic<signed char>: aux::atomic_integral_base<signed char>
+    {
+        using aux::atomic_integral_base<signed char>::atomic_integral_base;
+        using aux::atomic_integral_base<signed char>::operator=;
+    };
+
+    template<>
+    struct atomic<unsigned char>: aux::atomic_integral_base<unsigned char>
+    {
+        using aux::atomic_integral_base<unsigned char>::atomic_integral_base;
+        using aux::atomic_integral_base<unsigned char>::operator=;
+    };
+
+    template<>
+    struct atomic<char16_t>: aux::atomic_integral_base<char16_t>
+    {
+        using aux::atomic_integral_base<char16_t>::atomic_integral_base;
+        using aux::atomic_integral_base<char16_t>::operator=;
+    };
+
+    template<>
+    struct atomic<char32_t>: aux::atomic_integral_base<char32_t>
+    {
+        using aux::atomic_integral_base<char32_t>::atomic_integral_base;
+        using aux::atomic_integral_base<char32_t>::operator=;
+    };
+
+    template<>
+    struct atomic<wchar_t>: aux::atomic_integral_base<wchar_t>
+    {
+        using aux::atomic_integral_base<wchar_t>::atomic_integral_base;
+        using aux::atomic_integral_base<wchar_t>::operator=;
+    };
+
+    template<>
+    struct atomic<short>: aux::atomic_integral_base<short>
+    {
+        using aux::atomic_integral_base<short>::atomic_integral_base;
+        using aux::atomic_integral_base<short>::operator=;
+    };
+
+    template<>
+    struct atomic<unsigned short>: aux::atomic_integral_base<unsigned short>
+    {
+        using aux::atomic_integral_base<unsigned short>::atomic_integral_base;
+        using aux::atomic_integral_base<unsigned short>::operator=;
+    };
+
+    template<>
+    struct atomic<int>: aux::atomic_integral_base<int>
+    {
+        using aux::atomic_integral_base<int>::atomic_integral_base;
+        using aux::atomic_integral_base<int>::operator=;
+    };
+
+    template<>
+    struct atomic<unsigned int>: aux::atomic_integral_base<unsigned int>
+    {
+        using aux::atomic_integral_base<unsigned int>::atomic_integral_base;
+        using aux::atomic_integral_base<unsigned int>::operator=;
+    };
+
+    template<>
+    struct atomic<long>: aux::atomic_integral_base<long>
+    {
+        using aux::atomic_integral_base<long>::atomic_integral_base;
+        using aux::atomic_integral_base<long>::operator=;
+    };
+
+    template<>
+    struct atomic<unsigned long>: aux::atomic_integral_base<unsigned long>
+    {
+        using aux::atomic_integral_base<unsigned long>::atomic_integral_base;
+        using aux::atomic_integral_base<unsigned long>::operator=;
+    };
+
+    template<>
+    struct atomic<long long>: aux::atomic_integral_base<long long>
+    {
+        using aux::atomic_integral_base<long long>::atomic_integral_base;
+        using aux::atomic_integral_base<long long>::operator=;
+    };
+
+    template<>
+    struct atomic<unsigned long long>: aux::atomic_integral_base<unsigned long long>
+    {
+        using aux::atomic_integral_base<unsigned long long>::atomic_integral_base;
+        using aux::atomic_integral_base<unsigned long long>::operator=;
+    };
+
+    using atomic_bool           = atomic<bool>;
+    using atomic_char           = atomic<char>;
+    using atomic_schar          = atomic<signed char>;
+    using atomic_uchar          = atomic<unsigned char>;
+    using atomic_short          = atomic<short>;
+    using atomic_ushort         = atomic<unsigned short>;
+    using atomic_int            = atomic<int>;
+    using atomic_uint           = atomic<unsigned int>;
+    using atomic_long           = atomic<long>;
+    using atomic_ulong          = atomic<unsigned long>;
+    using atomic_llong          = atomic<long long>;
+    using atomic_ullong         = atomic<unsigned long long>;
+    using atomic_char16_t       = atomic<char16_t>;
+    using atomic_char32_t       = atomic<char32_t>;
+    using atomic_wchar_t        = atomic<wchar_t>;
+
+    using atomic_int8_t         = atomic<int8_t>;
+    using atomic_uint8_t        = atomic<uint8_t>;
+    using atomic_int16_t        = atomic<int16_t>;
+    using atomic_uint16_t       = atomic<uint16_t>;
+    using atomic_int32_t        = atomic<int32_t>;
+    using atomic_uint32_t       = atomic<uint32_t>;
+    using atomic_int64_t        = atomic<int64_t>;
+    using atomic_uint64_t       = atomic<uint64_t>;
+
+    using atomic_int_least8_t   = atomic<int_least8_t>;
+    using atomic_uint_least8_t  = atomic<uint_least8_t>;
+    using atomic_int_least16_t  = atomic<int_least16_t>;
+    using atomic_uint_least16_t = atomic<uint_least16_t>;
+    using atomic_int_least32_t  = atomic<int_least32_t>;
+    using atomic_uint_least32_t = atomic<uint_least32_t>;
+    using atomic_int_least64_t  = atomic<int_least64_t>;
+    using atomic_uint_least64_t = atomic<uint_least64_t>;
+    using atomic_int_fast8_t    = atomic<int_fast8_t>;
+    using atomic_uint_fast8_t   = atomic<uint_fast8_t>;
+    using atomic_int_fast16_t   = atomic<int_fast16_t>;
+    using atomic_uint_fast16_t  = atomic<uint_fast16_t>;
+    using atomic_int_fast32_t   = atomic<int_fast32_t>;
+    using atomic_uint_fast32_t  = atomic<uint_fast32_t>;
+    using atomic_int_fast64_t   = atomic<int_fast64_t>;
+    using atomic_uint_fast64_t  = atomic<uint_fast64_t>;
+
+    using atomic_intptr_t       = atomic<intptr_t>;
+    using atomic_uintptr_t      = atomic<uintptr_t>;
+    using atomic_size_t         = atomic<size_t>;
+    using atomic_ptrdiff_t      = atomic<ptrdiff_t>;
+    using atomic_intmax_t       = atomic<intmax_t>;
+    using atomic_uintmax_t      = atomic<uintmax_t>;
+
+    /**
+     * 29.6, operations on atomic types:
+     */
+
+    template<class T>
+    bool atomic_is_lock_free(const volatile atomic<T>* obj) noexcept
+    {
+        return obj->is_lock_free();
+    }
+
+    template<class T>
+    void atomic_init(volatile atomic<T>* obj, T desired) noexcept
+    {
+        obj->store(desired, memory_order_relaxed);
+    }
+
+    template<class T>
+    void atomic_store(volatile atomic<T>* obj, T desired) noexcept
+    {
+        obj->store(desired);
+    }
+
+    template<class T>
+    void atomic_store_explicit(volatile atomic<T>* obj, T desired,
+                               memory_order order) noexcept
+    {
+        obj->store(desired, order);
+    }
+
+    template<class T>
+    T atomic_load(const volatile atomic<T>* obj) noexcept
+    {
+        return obj->load();
+    }
+
+    template<class T>
+    T atomic_load_explicit(const volatile atomic<T>* obj,
+                           memory_order order) noexcept
+    {
+        return obj->load(order);
+    }
+
+    template<class T>
+    T atomic_exchange(volatile atomic<T>* obj, T desired) noexcept
+    {
+        return obj->exchange(desired);
+    }
+
+    template<class T>
+    T atomic_exchange_explicit(volatile atomic<T>* obj, T desired,
+                               memory_order order) noexcept
+    {
+        return obj->exchange(desired, order);
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_weak(volatile atomic<T>* obj,
+                                      T* expected, T desired) noexcept
+    {
+        return obj->compare_exchange_weak(*expected, desired);
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_strong(volatile atomic<T>* obj,
+                                        T* expected, T desired) noexcept
+    {
+        return obj->compare_exchange_strong(*expected, desired);
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_weak_explicit(volatile atomic<T>* obj,
+                                               T* expected, T desired,
+                                               memory_order success,
+                                               memory_order failure) noexcept
+    {
+        return obj->compare_exchange_weak(*expected, desired, success, failure);
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_strong_explicit(volatile atomic<T>* obj,
+                                                 T* expected, T desired,
+                                                 memory_order success,
+                                                 memory_order failure) noexcept
+    {
+        return obj->compare_exchange_strong(*expected, desired, success, failure);
+    }
+
+    template<class T, class U>
+    T atomic_fetch_add(volatile atomic<T>* obj, U arg) noexcept
+    {
+        return obj->fetch_add(arg);
+    }
+
+    template<class T, class U>
+    T atomic_fetch_add_explicit(volatile atomic<T>* obj, U arg,
+                                memory_order order) noexcept
+    {
+        return obj->fetch_add(arg, order);
+    }
+
+    template<class T, class U>
+    T atomic_fetch_sub(volatile atomic<T>* obj, U arg) noexcept
+    {
+        return obj->fetch_sub(arg);
+    }
+
+    template<class T, class U>
+    T atomic_fetch_sub_explicit(volatile atomic<T>* obj, U arg,
+                                memory_order order) noexcept
+    {
+        return obj->fetch_sub(arg, order);
+    }
+
+    template<class T>
+    T atomic_fetch_and(volatile atomic<T>* obj, T arg) noexcept
+    {
+        return obj->fetch_and(arg);
+    }
+
+    template<class T>
+    T atomic_fetch_and_explicit(volatile atomic<T>* obj, T arg,
+                                memory_order order) noexcept
+    {
+        return obj->fetch_and(arg, order);
+    }
+
+    template<class T>
+    T atomic_fetch_or(volatile atomic<T>* obj, T arg) noexcept
+    {
+        return obj->fetch_or(arg);
+    }
+
+    template<class T>
+    T atomic_fetch_or_explicit(volatile atomic<T>* obj, T arg,
+                               memory_order order) noexcept
+    {
+        return obj->fetch_or(arg, order);
+    }
+
+    template<class T>
+    T atomic_fetch_xor(volatile atomic<T>* obj, T arg) noexcept
+    {
+        return obj->fetch_xor(arg);
+    }
+
+    template<class T>
+    T atomic_fetch_xor_explicit(volatile atomic<T>* obj, T arg,
+                                memory_order order) noexcept
+    {
+        return obj->fetch_xor(arg, order);
+    }
+
+    /**
+     * 29.7, flag type and operations:
+     */
+
+    struct atomic_flag
+    {
+        atomic_flag() noexcept = default;
+
+        /**
+         * Note: Only here so that ATOMIC_FLAG_INIT
+         *       can be implemented.
+         */
+        constexpr atomic_flag(bool value) noexcept
+            : value_{value}
+        { /* DUMMY BODY */ }
+
+        atomic_flag(const atomic_flag&) = delete;
+        atomic_flag& operator=(const atomic_flag&) = delete;
+        atomic_flag& operator=(const atomic_flag&) volatile = delete;
+
+        bool test_and_set(memory_order order = memory_order_seq_cst) volatile noexcept
+        {
+            return __atomic_test_and_set(&value_, order);
+        }
+
+        void clear(memory_order order = memory_order_seq_cst) volatile noexcept
+        {
+            __atomic_clear(&value_, order);
+        }
+
+        private:
+            bool value_;
+    };
+
+    inline bool atomic_flag_test_and_set(volatile atomic_flag* flag) noexcept
+    {
+        return flag->test_and_set();
+    }
+
+    inline bool atomic_flag_test_and_set_explicit(volatile atomic_flag* flag,
+                                                  memory_order order) noexcept
+    {
+        return flag->test_and_set(order);
+    }
+
+    inline void atomic_flag_clear(volatile atomic_flag* flag) noexcept
+    {
+        flag->clear();
+    }
+
+    inline void atomic_flag_clear_explicit(volatile atomic_flag* flag,
+                                           memory_order order) noexcept
+    {
+        flag->clear(order);
+    }
+
+    /**
+     * 29.8, fences:
+     */
+
+    inline void atomic_thread_fence(memory_order order) noexcept
+    {
+        __atomic_thread_fence(order);
+    }
+
+    inline void atomic_signal_fence(memory_order order) noexcept
+    {
+        __atomic_signal_fence(order);
+    }
+}
 
 #endif
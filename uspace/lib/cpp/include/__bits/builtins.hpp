@@ -82,6 +82,14 @@ namespace std::aux
     {
         return static_cast<size_t>(__builtin_floor(static_cast<double>(val)));
     }
+
+    template<class T>
+    constexpr size_t count_trailing_zeros(T val)
+    {
+        return static_cast<size_t>(
+            __builtin_ctzll(static_cast<unsigned long long>(val))
+        );
+    }
 }
 
 #endif
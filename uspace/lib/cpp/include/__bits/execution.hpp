@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_EXECUTION
+#define LIBCPP_BITS_EXECUTION
+
+#include <__bits/algorithm.hpp>
+#include <__bits/numeric.hpp>
+#include <__bits/thread/thread_pool.hpp>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace std
+{
+    /**
+     * 23.19 (C++17), execution policies:
+     */
+
+    namespace execution
+    {
+        class sequenced_policy
+        { /* DUMMY BODY */ };
+
+        class parallel_policy
+        { /* DUMMY BODY */ };
+
+        /**
+         * Note: We do not vectorize, so this policy
+         *       behaves the same as parallel_policy.
+         */
+        class parallel_unsequenced_policy
+        { /* DUMMY BODY */ };
+
+        inline constexpr sequenced_policy seq{};
+        inline constexpr parallel_policy par{};
+        inline constexpr parallel_unsequenced_policy par_unseq{};
+    }
+
+    template<class T>
+    struct is_execution_policy: false_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::sequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_unsequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<class T>
+    inline constexpr bool is_execution_policy_v = is_execution_policy<T>::value;
+
+    namespace aux
+    {
+        template<class ExecutionPolicy, class T = void>
+        using enable_if_policy_t = enable_if_t<
+            is_execution_policy_v<decay_t<ExecutionPolicy>>, T
+        >;
+
+        /**
+         * Work is only split among threads for the parallel
+         * policies and if all iterators involved allow us to
+         * jump to the start of a chunk in constant time,
+         * otherwise the algorithm runs serially.
+         */
+        template<class ExecutionPolicy, class... Iterators>
+        inline constexpr bool run_in_parallel_v =
+            !is_same_v<decay_t<ExecutionPolicy>, execution::sequenced_policy> &&
+            (is_base_of_v<
+                random_access_iterator_tag,
+                typename iterator_traits<Iterators>::iterator_category
+            > && ...);
+
+        struct parallel_plus
+        {
+            template<class T, class U>
+            auto operator()(T&& lhs, U&& rhs) const
+            {
+                return forward<T>(lhs) + forward<U>(rhs);
+            }
+        };
+
+        struct parallel_multiplies
+        {
+            template<class T, class U>
+            auto operator()(T&& lhs, U&& rhs) const
+            {
+                return forward<T>(lhs) * forward<U>(rhs);
+            }
+        };
+
+        /**
+         * Reduces elem(0), ..., elem(count - 1) with op. Every chunk
+         * is reduced separately and the partial results are then
+         * combined in order, so op needs to be associative
+         * but not commutative.
+         */
+        template<class T, class BinaryOperation, class Element>
+        T parallel_reduce(size_t count, T init, BinaryOperation& op, Element elem)
+        {
+            parallel_partition part{count, parallel_job::chunks_for(count)};
+
+            // T does not have to be default constructible.
+            T* partials{};
+            if (part.chunks > 1)
+                partials = static_cast<T*>(::operator new(sizeof(T) * part.chunks, nothrow));
+
+            if (!partials)
+            {
+                for (size_t i = 0; i < count; ++i)
+                    init = op(move(init), elem(i));
+
+                return init;
+            }
+
+            auto body = [&op, &elem, partials](size_t i, size_t begin, size_t end) {
+                T acc(elem(begin));
+                for (++begin; begin < end; ++begin)
+                    acc = op(move(acc), elem(begin));
+
+                ::new(static_cast<void*>(partials + i)) T(move(acc));
+            };
+            parallel_for_chunks(part, body);
+
+            for (size_t i = 0; i < part.chunks; ++i)
+            {
+                init = op(move(init), move(partials[i]));
+                partials[i].~T();
+            }
+            ::operator delete(partials);
+
+            return init;
+        }
+
+        /**
+         * Runs in three phases: the chunks are reduced in parallel,
+         * the carry into every chunk is computed serially from these
+         * sums and finally every chunk is scanned, again in parallel,
+         * starting from its carry. Elements are read twice, but that
+         * is the price for not having to synchronize the chunks.
+         */
+        template<class T, class RandomAccessIterator1,
+                 class RandomAccessIterator2, class BinaryOperation>
+        RandomAccessIterator2 parallel_inclusive_scan(
+            RandomAccessIterator1 first, size_t count,
+            RandomAccessIterator2 result, BinaryOperation& op,
+            const T* init
+        )
+        {
+            parallel_partition part{count, parallel_job::chunks_for(count)};
+
+            T* carries{};
+            if (part.chunks > 1)
+                carries = static_cast<T*>(::operator new(sizeof(T) * (part.chunks - 1), nothrow));
+
+            if (!carries)
+            {
+                if (init)
+                    return inclusive_scan(first, first + count, result, op, *init);
+                else
+                    return inclusive_scan(first, first + count, result, op);
+            }
+
+            // The sum of the last chunk is not needed by anyone.
+            auto sum = [&op, &first, &part, carries](size_t i, size_t begin, size_t end) {
+                if (i == part.chunks - 1)
+                    return;
+
+                ::new(static_cast<void*>(carries + i)) T(
+                    reduce(first + begin + 1, first + end, T(first[begin]), op)
+                );
+            };
+            parallel_for_chunks(part, sum);
+
+            if (init)
+                carries[0] = op(*init, move(carries[0]));
+            for (size_t i = 1; i < part.chunks - 1; ++i)
+                carries[i] = op(carries[i - 1], move(carries[i]));
+
+            auto scan = [&op, &first, &result, carries, init](size_t i, size_t begin, size_t end) {
+                if (i > 0)
+                    inclusive_scan(first + begin, first + end, result + begin, op, carries[i - 1]);
+                else if (init)
+                    inclusive_scan(first + begin, first + end, result + begin, op, *init);
+                else
+                    inclusive_scan(first + begin, first + end, result + begin, op);
+            };
+            parallel_for_chunks(part, scan);
+
+            for (size_t i = 0; i < part.chunks - 1; ++i)
+                carries[i].~T();
+            ::operator delete(carries);
+
+            return result + count;
+        }
+
+        // Sorting a chunk is more work than a loop iteration.
+        inline constexpr size_t parallel_sort_min_grain{4096};
+
+        /**
+         * Chunks get sorted in parallel and are then merged
+         * pairwise in rounds, the merges of a round run in parallel.
+         * The last round is a single serial merge, so this scales
+         * worse than the chunk sorting, but it is still linear.
+         */
+        template<class RandomAccessIterator, class Compare>
+        void parallel_sort(RandomAccessIterator first, RandomAccessIterator last,
+                           Compare& comp)
+        {
+            using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+            size_t count = static_cast<size_t>(last - first);
+            auto chunks = parallel_job::chunks_for(count, parallel_sort_min_grain);
+            if (chunks <= 1)
+            {
+                sort(first, last, comp);
+
+                return;
+            }
+
+            parallel_partition part{count, chunks};
+            auto sort_chunk = [&first, &comp](size_t, size_t begin, size_t end) {
+                sort(first + begin, first + end, comp);
+            };
+            parallel_for_chunks(part, sort_chunk);
+
+            /**
+             * Merge j of a round uses the part of the buffer that
+             * corresponds to its left run, so the merges never share
+             * buffer space.
+             */
+            size_t bounds[parallel_job::max_chunks + 1];
+            for (size_t i = 0; i < chunks; ++i)
+                bounds[i] = part.begin(i);
+            bounds[chunks] = count;
+
+            auto buffer = static_cast<value_type*>(::operator new(
+                sizeof(value_type) * count, nothrow
+            ));
+
+            struct context
+            {
+                RandomAccessIterator first;
+                size_t* bounds;
+                value_type* buffer;
+                Compare& comp;
+            } ctx{first, bounds, buffer, comp};
+
+            for (size_t runs = chunks; runs > 1; runs = (runs + 1) / 2)
+            {
+                parallel_job::run(runs / 2, [](void* arg, size_t j) {
+                    auto& ctx = *static_cast<context*>(arg);
+
+                    auto begin = ctx.first + ctx.bounds[2 * j];
+                    auto middle = ctx.first + ctx.bounds[2 * j + 1];
+                    auto end = ctx.first + ctx.bounds[2 * j + 2];
+
+                    // Already ordered, common with partially sorted input.
+                    if (!ctx.comp(*middle, *(middle - 1)))
+                        return;
+
+                    if (ctx.buffer)
+                        merge_with_buffer(begin, middle, end, ctx.buffer + ctx.bounds[2 * j], ctx.comp);
+                    else
+                        merge_without_buffer(begin, middle, end, ctx.comp);
+                }, &ctx);
+
+                // An odd run at the end is carried over to the next round.
+                for (size_t i = 1; i < (runs + 1) / 2; ++i)
+                    bounds[i] = bounds[2 * i];
+                bounds[(runs + 1) / 2] = count;
+            }
+
+            if (buffer)
+                ::operator delete(buffer);
+        }
+    }
+
+    /**
+     * 25.2.4 (C++17), for each:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Function>
+    aux::enable_if_policy_t<ExecutionPolicy>
+    for_each(ExecutionPolicy&&, ForwardIterator first,
+             ForwardIterator last, Function f)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            aux::parallel_for(static_cast<size_t>(last - first), [&first, &f](size_t begin, size_t end) {
+                for (auto it = first + begin; it != first + end; ++it)
+                    f(*it);
+            });
+        }
+        else
+            for_each(first, last, f);
+    }
+
+    /**
+     * 25.3.4 (C++17), transform:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class UnaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+    transform(ExecutionPolicy&&, ForwardIterator1 first, ForwardIterator1 last,
+              ForwardIterator2 result, UnaryOperation op)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator1, ForwardIterator2>)
+        {
+            auto count = static_cast<size_t>(last - first);
+            aux::parallel_for(count, [&first, &result, &op](size_t begin, size_t end) {
+                for (; begin < end; ++begin)
+                    result[begin] = op(first[begin]);
+            });
+
+            return result + count;
+        }
+        else
+            return transform(first, last, result, op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+             class ForwardIterator3, class BinaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator3>
+    transform(ExecutionPolicy&&, ForwardIterator1 first1, ForwardIterator1 last1,
+              ForwardIterator2 first2, ForwardIterator3 result, BinaryOperation op)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator1,
+                                             ForwardIterator2, ForwardIterator3>)
+        {
+            auto count = static_cast<size_t>(last1 - first1);
+            aux::parallel_for(count, [&first1, &first2, &result, &op](size_t begin, size_t end) {
+                for (; begin < end; ++begin)
+                    result[begin] = op(first1[begin], first2[begin]);
+            });
+
+            return result + count;
+        }
+        else
+            return transform(first1, last1, first2, result, op);
+    }
+
+    /**
+     * 25.4.1.1 (C++17), sort:
+     */
+
+    template<class ExecutionPolicy, class RandomAccessIterator, class Compare>
+    aux::enable_if_policy_t<ExecutionPolicy>
+    sort(ExecutionPolicy&&, RandomAccessIterator first,
+         RandomAccessIterator last, Compare comp)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, RandomAccessIterator>)
+            aux::parallel_sort(first, last, comp);
+        else
+            sort(first, last, comp);
+    }
+
+    template<class ExecutionPolicy, class RandomAccessIterator>
+    aux::enable_if_policy_t<ExecutionPolicy>
+    sort(ExecutionPolicy&& policy, RandomAccessIterator first,
+         RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        sort(forward<ExecutionPolicy>(policy), first, last, less<value_type>{});
+    }
+
+    /**
+     * 29.8.3 (C++17), reduce:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator,
+             class T, class BinaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    reduce(ExecutionPolicy&&, ForwardIterator first, ForwardIterator last,
+           T init, BinaryOperation op)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            return aux::parallel_reduce(
+                static_cast<size_t>(last - first), move(init), op,
+                [&first](size_t i) -> decltype(auto) { return first[i]; }
+            );
+        }
+        else
+            return reduce(first, last, move(init), op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    reduce(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last, T init)
+    {
+        return reduce(
+            forward<ExecutionPolicy>(policy), first, last,
+            move(init), aux::parallel_plus{}
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator>
+    aux::enable_if_policy_t<
+        ExecutionPolicy, typename iterator_traits<ForwardIterator>::value_type
+    >
+    reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last)
+    {
+        return reduce(
+            forward<ExecutionPolicy>(policy), first, last,
+            typename iterator_traits<ForwardIterator>::value_type{}
+        );
+    }
+
+    /**
+     * 29.8.5 (C++17), transform reduce:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+             class T, class BinaryOperation1, class BinaryOperation2>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&&, ForwardIterator1 first1,
+                     ForwardIterator1 last1, ForwardIterator2 first2, T init,
+                     BinaryOperation1 op1, BinaryOperation2 op2)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator1, ForwardIterator2>)
+        {
+            return aux::parallel_reduce(
+                static_cast<size_t>(last1 - first1), move(init), op1,
+                [&first1, &first2, &op2](size_t i) { return op2(first1[i], first2[i]); }
+            );
+        }
+        else
+            return transform_reduce(first1, last1, first2, move(init), op1, op2);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&& policy, ForwardIterator1 first1,
+                     ForwardIterator1 last1, ForwardIterator2 first2, T init)
+    {
+        return transform_reduce(
+            forward<ExecutionPolicy>(policy), first1, last1, first2, move(init),
+            aux::parallel_plus{}, aux::parallel_multiplies{}
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class T,
+             class BinaryOperation, class UnaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&&, ForwardIterator first,
+                     ForwardIterator last, T init,
+                     BinaryOperation op1, UnaryOperation op2)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            return aux::parallel_reduce(
+                static_cast<size_t>(last - first), move(init), op1,
+                [&first, &op2](size_t i) { return op2(first[i]); }
+            );
+        }
+        else
+            return transform_reduce(first, last, move(init), op1, op2);
+    }
+
+    /**
+     * 29.8.8 (C++17), inclusive scan:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+             class BinaryOperation, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+    inclusive_scan(ExecutionPolicy&&, ForwardIterator1 first, ForwardIterator1 last,
+                   ForwardIterator2 result, BinaryOperation op, T init)
+    {
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator1, ForwardIterator2>)
+        {
+            return aux::parallel_inclusive_scan(
+                first, static_cast<size_t>(last - first), result, op, &init
+            );
+        }
+        else
+            return inclusive_scan(first, last, result, op, move(init));
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class BinaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+    inclusive_scan(ExecutionPolicy&&, ForwardIterator1 first, ForwardIterator1 last,
+                   ForwardIterator2 result, BinaryOperation op)
+    {
+        using value_type = typename iterator_traits<ForwardIterator1>::value_type;
+
+        if constexpr (aux::run_in_parallel_v<ExecutionPolicy, ForwardIterator1, ForwardIterator2>)
+        {
+            return aux::parallel_inclusive_scan<value_type>(
+                first, static_cast<size_t>(last - first), result, op, nullptr
+            );
+        }
+        else
+            return inclusive_scan(first, last, result, op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+    inclusive_scan(ExecutionPolicy&& policy, ForwardIterator1 first,
+                   ForwardIterator1 last, ForwardIterator2 result)
+    {
+        return inclusive_scan(
+            forward<ExecutionPolicy>(policy), first, last,
+            result, aux::parallel_plus{}
+        );
+    }
+}
+
+#endif
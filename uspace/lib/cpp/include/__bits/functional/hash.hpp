@@ -75,7 +75,7 @@ namespace std
             static_assert(is_arithmetic<T>::value || is_pointer<T>::value,
                           "invalid type passed to aux::hash");
 
-            converter<T> conv;
+            converter<T> conv{};
             conv.value = x;
 
             return hash_<size_t>(conv.converted);
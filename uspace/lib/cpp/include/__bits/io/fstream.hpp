@@ -29,17 +29,64 @@
 #ifndef LIBCPP_BITS_IO_FSTREAM
 #define LIBCPP_BITS_IO_FSTREAM
 
-#include <cstdio>
+#include <algorithm>
+#include <cstdint>
 #include <ios>
 #include <iosfwd>
+#include <istream>
+#include <limits>
 #include <locale>
+#include <ostream>
 #include <streambuf>
 #include <string>
 
+namespace std::aux
+{
+    /**
+     * Thin layer over the vfs interface of libc, keeps
+     * the libc headers out of fstream. Positions and
+     * sizes are in bytes.
+     */
+    struct file
+    {
+        static constexpr int invalid{-1};
+
+        static int open(const char* name, ios_base::openmode mode);
+        static void close(int fd);
+
+        static bool size(int fd, uint64_t& res);
+
+        /**
+         * Returns the number of bytes read, which can be less
+         * than requested, 0 at the end of the file and -1 on error.
+         */
+        static int64_t read(int fd, uint64_t pos, void* buf, size_t bytes);
+
+        /**
+         * Either writes all bytes or fails.
+         */
+        static bool write(int fd, uint64_t pos, const void* buf, size_t bytes);
+
+        /**
+         * Maps the first bytes of the file read only using
+         * the vfs pager, returns nullptr on failure.
+         */
+        static void* map(int fd, size_t bytes, void*& pager);
+        static void unmap(void* area, void* pager);
+    };
+}
+
 namespace std
 {
     /**
      * 27.9.1.1, class template basic_filebuf:
+     * Note: The file is accessed directly through vfs with
+     *       positional reads and writes, libc stdio and its
+     *       buffer are not involved. Both get and put areas
+     *       share one buffer (its size can be set by setbuf),
+     *       at most one of them is active at any time and pos_
+     *       is the position in the file that corresponds to the
+     *       start of the active one.
      */
     template<class Char, class Traits>
     class basic_filebuf: public basic_streambuf<Char, Traits>
@@ -57,26 +104,26 @@ namespace std
 
             basic_filebuf()
                 : basic_streambuf<char_type, traits_type>{},
-                  obuf_{nullptr}, ibuf_{nullptr}, mode_{}, file_{nullptr}
+                  fd_{aux::file::invalid}, mode_{}, buf_{nullptr},
+                  buf_size_{default_buf_size_}, own_buf_{false}, pos_{},
+                  map_{nullptr}, map_size_{}, pager_{nullptr}
             { /* DUMMY BODY */ }
 
             basic_filebuf(const basic_filebuf&) = delete;
 
             basic_filebuf(basic_filebuf&& other)
-                : mode_{other.mode_}
+                : basic_filebuf{}
             {
-                close();
-                std::swap(obuf_, other.obuf_);
-                std::swap(ibuf_, other.ibuf_);
-                std::swap(file_, other.file_);
-
-                basic_streambuf<char_type, traits_type>::swap(other);
+                swap(other);
             }
 
             virtual ~basic_filebuf()
             {
                 // TODO: exception here caught and not rethrown
                 close();
+
+                if (own_buf_)
+                    delete[] buf_;
             }
 
             /**
@@ -95,9 +142,15 @@ namespace std
 
             void swap(basic_filebuf& rhs)
             {
+                std::swap(fd_, rhs.fd_);
                 std::swap(mode_, rhs.mode_);
-                std::swap(obuf_, rhs.obuf_);
-                std::swap(ibuf_, rhs.ibuf_);
+                std::swap(buf_, rhs.buf_);
+                std::swap(buf_size_, rhs.buf_size_);
+                std::swap(own_buf_, rhs.own_buf_);
+                std::swap(pos_, rhs.pos_);
+                std::swap(map_, rhs.map_);
+                std::swap(map_size_, rhs.map_size_);
+                std::swap(pager_, rhs.pager_);
 
                 basic_streambuf<char_type, traits_type>::swap(rhs);
             }
@@ -108,39 +161,33 @@ namespace std
 
             bool is_open() const
             {
-                return file_ != nullptr;
+                return fd_ != aux::file::invalid;
             }
 
             basic_filebuf<char_type, traits_type>* open(const char* name, ios_base::openmode mode)
             {
-                if (file_)
+                if (is_open())
                     return nullptr;
 
-                mode_ = mode;
-                mode = (mode & (~ios_base::ate));
-                const char* mode_str = get_mode_str_(mode);
-
-                if (!mode_str)
+                fd_ = aux::file::open(name, mode);
+                if (fd_ == aux::file::invalid)
                     return nullptr;
 
-                file_ = fopen(name, mode_str);
-                if (!file_)
-                    return nullptr;
+                mode_ = mode;
+                pos_ = 0;
 
-                if ((mode_ & ios_base::ate) != 0)
+                // Appending writes always go to the end of the file.
+                if ((mode_ & (ios_base::ate | ios_base::app)) != 0)
                 {
-                    if (fseek(file_, 0, SEEK_END) != 0)
+                    uint64_t size{};
+                    if (!aux::file::size(fd_, size))
                     {
                         close();
                         return nullptr;
                     }
-                }
 
-                if (!ibuf_ && mode_is_in_(mode_))
-                    ibuf_ = new char_type[buf_size_];
-                if (!obuf_ && mode_is_out_(mode_))
-                    obuf_ = new char_type[buf_size_];
-                init_();
+                    pos_ = size / sizeof(char_type);
+                }
 
                 return this;
             }
@@ -150,21 +197,67 @@ namespace std
                 return open(name.c_str(), mode);
             }
 
+            /**
+             * Note: This is an extension, the file is opened
+             *       for reading and its contents are mapped into
+             *       memory through the vfs pager, so that the whole
+             *       file is the get area and no reads are needed.
+             *       If the file cannot be mapped, this is the same
+             *       as open(name, ios_base::in).
+             */
+            basic_filebuf<char_type, traits_type>* open_mapped(const char* name)
+            {
+                if (!open(name, ios_base::in))
+                    return nullptr;
+
+                uint64_t size{};
+                if (!aux::file::size(fd_, size) || size < sizeof(char_type) ||
+                    size > numeric_limits<size_t>::max())
+                {
+                    return this;
+                }
+
+                map_ = aux::file::map(fd_, static_cast<size_t>(size), pager_);
+                if (map_)
+                {
+                    map_size_ = static_cast<size_t>(size / sizeof(char_type));
+
+                    auto data = static_cast<char_type*>(map_);
+                    this->setg(data, data, data + map_size_);
+                }
+
+                return this;
+            }
+
+            basic_filebuf<char_type, traits_type>* open_mapped(const string& name)
+            {
+                return open_mapped(name.c_str());
+            }
+
             basic_filebuf<char_type, traits_type>* close()
             {
                 // TODO: caught exceptions are to be rethrown after closing the file
-                if (!file_)
+                if (!is_open())
                     return nullptr;
-                // TODO: deallocate buffers?
 
-                if (this->output_next_ != this->output_begin_)
-                    overflow(traits_type::eof());
                 // TODO: unshift? (p. 1084 at the top)
+                auto res = flush_();
+
+                if (map_)
+                {
+                    aux::file::unmap(map_, pager_);
+                    map_ = nullptr;
+                    map_size_ = 0;
+                    pager_ = nullptr;
+                }
 
-                fclose(file_);
-                file_ = nullptr;
+                aux::file::close(fd_);
+                fd_ = aux::file::invalid;
 
-                return this;
+                this->setg(nullptr, nullptr, nullptr);
+                this->setp(nullptr, nullptr);
+
+                return res ? this : nullptr;
             }
 
         protected:
@@ -172,50 +265,109 @@ namespace std
              * 27.9.1.5, overriden virtual functions:
              */
 
+            streamsize showmanyc() override
+            {
+                if (!is_open() || !mode_is_in_(mode_))
+                    return -1;
+
+                if (map_)
+                    return streamsize{};
+
+                uint64_t size{};
+                if (!aux::file::size(fd_, size))
+                    return streamsize{};
+
+                auto pos = position_();
+                size /= sizeof(char_type);
+                if (size <= pos)
+                    return -1;
+
+                return static_cast<streamsize>(size - pos);
+            }
+
             int_type underflow() override
             {
                 // TODO: use codecvt
-                if (!mode_is_in_(mode_))
+                if (this->read_avail_())
+                    return traits_type::to_int_type(*this->input_next_);
+
+                if (!is_open() || !mode_is_in_(mode_) || map_)
                     return traits_type::eof();
 
-                if (!ibuf_)
-                {
-                    ibuf_ = new char_type[buf_size_];
-                    this->input_begin_ = this->input_next_ = this->input_end_ = ibuf_;
-                }
+                if (!flush_())
+                    return traits_type::eof();
+                this->setp(nullptr, nullptr);
+                drop_get_area_();
 
-                off_type i{};
-                if (this->input_next_ < this->input_end_)
+                if (!ensure_buffer_())
+                    return traits_type::eof();
+
+                auto res = aux::file::read(
+                    fd_, pos_ * sizeof(char_type),
+                    buf_, buf_size_ * sizeof(char_type)
+                );
+                if (res < static_cast<int64_t>(sizeof(char_type)))
                 {
-                    auto idx = static_cast<off_type>(this->input_next_ - this->input_begin_);
-                    auto count = static_cast<off_type>(buf_size_) - idx;
+                    this->setg(buf_, buf_, buf_);
 
-                    for (; i < count; ++i, ++idx)
-                        ibuf_[i] = ibuf_[idx];
+                    return traits_type::eof();
                 }
 
-                for (; i < static_cast<off_type>(buf_size_); ++i)
-                {
-                    auto c = fgetc(file_);
-                    if (c == traits_type::eof())
-                        break;
+                this->setg(buf_, buf_, buf_ + res / sizeof(char_type));
 
-                    ibuf_[i] = static_cast<char_type>(c);
+                return traits_type::to_int_type(*this->input_next_);
+            }
 
-                    if (ibuf_[i] == '\n')
+            streamsize xsgetn(char_type* s, streamsize n) override
+            {
+                streamsize count{};
+                while (count < n)
+                {
+                    if (this->read_avail_())
                     {
-                        ++i;
-                        break;
+                        auto chunk = min(n - count, static_cast<streamsize>(
+                            this->input_end_ - this->input_next_
+                        ));
+                        traits_type::copy(s + count, this->input_next_, chunk);
+
+                        this->input_next_ += chunk;
+                        count += chunk;
+
+                        continue;
                     }
-                }
 
-                this->input_next_ = this->input_begin_;
-                this->input_end_ = this->input_begin_ + i;
+                    /**
+                     * Large reads go directly to the destination,
+                     * there is no point in copying them through
+                     * our buffer.
+                     */
+                    auto rest = static_cast<size_t>(n - count);
+                    if (rest >= buf_size_ && is_open() && mode_is_in_(mode_) && !map_)
+                    {
+                        if (!flush_())
+                            break;
+                        this->setp(nullptr, nullptr);
+                        drop_get_area_();
+
+                        auto res = aux::file::read(
+                            fd_, pos_ * sizeof(char_type),
+                            s + count, rest * sizeof(char_type)
+                        );
+                        if (res < static_cast<int64_t>(sizeof(char_type)))
+                            break;
+
+                        auto read = static_cast<streamsize>(res / sizeof(char_type));
+                        pos_ += read;
+                        count += read;
+
+                        continue;
+                    }
 
-                if (i == 0)
-                    return traits_type::eof();
+                    if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+                        break;
+                }
 
-                return traits_type::to_int_type(*this->input_next_);
+                return count;
             }
 
             int_type pbackfail(int_type c = traits_type::eof()) override
@@ -230,7 +382,8 @@ namespace std
                     return c;
                 }
                 else if (!traits_type::eq_int_type(c, traits_type::eof()) &&
-                         this->putback_avail_() && (mode_ & ios_base::out) != 0)
+                         this->putback_avail_() && (mode_ & ios_base::out) != 0 &&
+                         !map_)
                 {
                     *--this->input_next_ = cc;
 
@@ -250,45 +403,156 @@ namespace std
             int_type overflow(int_type c = traits_type::eof()) override
             {
                 // TODO: use codecvt
-                if (!mode_is_out_(mode_))
+                if (!is_open() || !mode_is_out_(mode_))
                     return traits_type::eof();
 
-                auto count = static_cast<size_t>(this->output_next_ - this->output_begin_);
-                fwrite(obuf_, sizeof(char_type), count, file_);
-                fflush(file_);
+                if (this->eback())
+                {
+                    drop_get_area_();
+                    this->setg(nullptr, nullptr, nullptr);
+                }
 
-                this->output_next_ = this->output_begin_;
+                if (!ensure_buffer_())
+                    return traits_type::eof();
+
+                if (!this->pbase())
+                    this->setp(buf_, buf_ + buf_size_);
+                else if (!flush_())
+                    return traits_type::eof();
+
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    traits_type::assign(*this->output_next_++, traits_type::to_char_type(c));
 
                 return traits_type::not_eof(c);
             }
 
+            streamsize xsputn(const char_type* s, streamsize n) override
+            {
+                if (n <= 0 || traits_type::eq_int_type(overflow_if_full_(), traits_type::eof()))
+                    return streamsize{};
+
+                auto room = static_cast<streamsize>(this->output_end_ - this->output_next_);
+                if (n <= room)
+                {
+                    traits_type::copy(this->output_next_, s, n);
+                    this->output_next_ += n;
+
+                    return n;
+                }
+
+                /**
+                 * Top up the buffer and write it out, whatever does
+                 * not fit into an empty buffer is written directly.
+                 */
+                traits_type::copy(this->output_next_, s, room);
+                this->output_next_ += room;
+                if (!flush_())
+                    return room;
+
+                auto rest = n - room;
+                if (static_cast<size_t>(rest) >= buf_size_)
+                {
+                    if (!write_(s + room, static_cast<size_t>(rest)))
+                        return room;
+                }
+                else
+                {
+                    traits_type::copy(this->output_next_, s + room, rest);
+                    this->output_next_ += rest;
+                }
+
+                return n;
+            }
+
             basic_streambuf<char_type, traits_type>*
             setbuf(char_type* s, streamsize n) override
             {
-                // TODO: implement
-                return nullptr;
+                // The buffer can be only changed before any I/O.
+                if (this->eback() || this->pbase())
+                    return nullptr;
+
+                if (own_buf_)
+                    delete[] buf_;
+
+                /**
+                 * Note: As an extension, setbuf(nullptr, n) with non-zero
+                 *       n sets the size of the buffer we allocate.
+                 *       Unbuffered I/O uses a buffer of one character.
+                 */
+                if (s && n > 0)
+                {
+                    buf_ = s;
+                    buf_size_ = static_cast<size_t>(n);
+                }
+                else
+                {
+                    buf_ = nullptr;
+                    buf_size_ = n > 0 ? static_cast<size_t>(n) : 1;
+                }
+                own_buf_ = false;
+
+                return this;
             }
 
             pos_type seekoff(off_type off, ios_base::seekdir dir,
                              ios_base::openmode mode = ios_base::in | ios_base::out) override
             {
-                // TODO: implement
-                return pos_type{};
+                // TODO: use codecvt
+                if (!is_open())
+                    return pos_type(off_type(-1));
+
+                off_type base{};
+                if (dir == ios_base::cur)
+                    base = static_cast<off_type>(position_());
+                else if (dir == ios_base::end)
+                {
+                    uint64_t size{map_size_ * sizeof(char_type)};
+                    if (!map_ && !aux::file::size(fd_, size))
+                        return pos_type(off_type(-1));
+
+                    base = static_cast<off_type>(size / sizeof(char_type));
+                }
+
+                if (!flush_())
+                    return pos_type(off_type(-1));
+
+                /**
+                 * Note: Unlike C stdio, we do not allow seeking past
+                 *       the end of a mapped file as it cannot grow.
+                 */
+                auto target = base + off;
+                if (target < 0 || (map_ && static_cast<size_t>(target) > map_size_))
+                    return pos_type(off_type(-1));
+
+                auto pos = static_cast<uint64_t>(target);
+                if (this->eback())
+                {
+                    // Seeks within the get area need no I/O.
+                    auto avail = static_cast<uint64_t>(this->input_end_ - this->input_begin_);
+                    if (pos_ <= pos && pos <= pos_ + avail)
+                    {
+                        this->input_next_ = this->input_begin_ + (pos - pos_);
+
+                        return pos_type(target);
+                    }
+                }
+
+                this->setg(nullptr, nullptr, nullptr);
+                this->setp(nullptr, nullptr);
+                pos_ = pos;
+
+                return pos_type(target);
             }
 
             pos_type seekpos(pos_type pos,
                              ios_base::openmode mode = ios_base::in | ios_base::out) override
             {
-                // TODO: implement
-                return pos_type{};
+                return seekoff(off_type(pos), ios_base::beg, mode);
             }
 
             int sync() override
             {
-                if (mode_is_out_(mode_))
-                    overflow();
-
-                return 0; // TODO: what is the correct return value?
+                return flush_() ? 0 : -1;
             }
 
             void imbue(const locale& loc) override
@@ -298,56 +562,21 @@ namespace std
             }
 
         private:
-            char_type* obuf_;
-            char_type* ibuf_;
-
+            int fd_;
             ios_base::openmode mode_;
 
-            FILE* file_;
+            char_type* buf_;
+            size_t buf_size_;
+            bool own_buf_;
 
-            static constexpr size_t buf_size_{128};
+            // Position (in characters) of the start of the active area.
+            uint64_t pos_;
 
-            const char* get_mode_str_(ios_base::openmode mode)
-            {
-                /**
-                 * See table 132.
-                 */
-                switch (mode)
-                {
-                    case ios_base::out:
-                    case ios_base::out | ios_base::trunc:
-                        return "w";
-                    case ios_base::out | ios_base::app:
-                    case ios_base::app:
-                        return "a";
-                    case ios_base::in:
-                        return "r";
-                    case ios_base::in | ios_base::out:
-                        return "r+";
-                    case ios_base::in | ios_base::out | ios_base::trunc:
-                        return "w+";
-                    case ios_base::in | ios_base::out | ios_base::app:
-                    case ios_base::in | ios_base::app:
-                        return "a+";
-                    case ios_base::binary | ios_base::out:
-                    case ios_base::binary | ios_base::out | ios_base::trunc:
-                        return "wb";
-                    case ios_base::binary | ios_base::out | ios_base::app:
-                    case ios_base::binary | ios_base::app:
-                        return "ab";
-                    case ios_base::binary | ios_base::in:
-                        return "rb";
-                    case ios_base::binary | ios_base::in | ios_base::out:
-                        return "r+b";
-                    case ios_base::binary | ios_base::in | ios_base::out | ios_base::trunc:
-                        return "w+b";
-                    case ios_base::binary | ios_base::in | ios_base::out | ios_base::app:
-                    case ios_base::binary | ios_base::in | ios_base::app:
-                        return "a+b";
-                    default:
-                        return nullptr;
-                }
-            }
+            void* map_;
+            size_t map_size_;
+            void* pager_;
+
+            static constexpr size_t default_buf_size_{16384};
 
             bool mode_is_in_(ios_base::openmode mode)
             {
@@ -359,17 +588,85 @@ namespace std
                 return (mode & (ios_base::out | ios_base::app | ios_base::trunc)) != 0;
             }
 
-            void init_()
+            bool ensure_buffer_()
+            {
+                if (!buf_)
+                {
+                    buf_ = new char_type[buf_size_];
+                    own_buf_ = true;
+                }
+
+                return buf_ != nullptr;
+            }
+
+            uint64_t position_()
             {
-                if (ibuf_)
-                    this->input_begin_ = this->input_next_ = this->input_end_ = ibuf_;
+                if (this->pbase())
+                    return pos_ + (this->output_next_ - this->output_begin_);
+                else if (this->eback())
+                    return pos_ + (this->input_next_ - this->input_begin_);
+                else
+                    return pos_;
+            }
 
-                if (obuf_)
+            /**
+             * Forgets the get area, so that the next read or write
+             * starts at the current position.
+             */
+            void drop_get_area_()
+            {
+                if (this->eback() && !map_)
                 {
-                    this->output_begin_ = this->output_next_ = obuf_;
-                    this->output_end_ = obuf_ + buf_size_;
+                    pos_ += this->input_next_ - this->input_begin_;
+                    this->setg(nullptr, nullptr, nullptr);
                 }
             }
+
+            int_type overflow_if_full_()
+            {
+                if (this->write_avail_())
+                    return traits_type::not_eof(traits_type::eof());
+                else
+                    return overflow();
+            }
+
+            /**
+             * Writes the put area out and empties it.
+             */
+            bool flush_()
+            {
+                if (!this->pbase())
+                    return true;
+
+                auto count = static_cast<size_t>(this->output_next_ - this->output_begin_);
+                this->output_next_ = this->output_begin_;
+
+                return write_(this->output_begin_, count);
+            }
+
+            bool write_(const char_type* data, size_t count)
+            {
+                if (count == 0)
+                    return true;
+
+                if (!aux::file::write(fd_, pos_ * sizeof(char_type),
+                                      data, count * sizeof(char_type)))
+                {
+                    return false;
+                }
+
+                if ((mode_ & ios_base::app) != 0)
+                {
+                    // The file server writes to the end of the file.
+                    uint64_t size{};
+                    if (aux::file::size(fd_, size))
+                        pos_ = size / sizeof(char_type);
+                }
+                else
+                    pos_ += count;
+
+                return true;
+            }
     };
 
     template<class Char, class Traits>
@@ -421,7 +718,7 @@ namespace std
 
             basic_ifstream(basic_ifstream&& other)
                 : basic_istream<char_type, traits_type>{move(other)},
-                  rdbuf_{other.rdbuf_}
+                  rdbuf_{move(other.rdbuf_)}
             {
                 basic_istream<char_type, traits_type>::set_rdbuf(&rdbuf_);
             }
@@ -470,6 +767,22 @@ namespace std
                 open(name.c_str(), mode);
             }
 
+            /**
+             * Note: Extension, see basic_filebuf::open_mapped.
+             */
+            void open_mapped(const char* name)
+            {
+                if (!rdbuf_.open_mapped(name))
+                    this->setstate(ios_base::failbit);
+                else
+                    this->clear();
+            }
+
+            void open_mapped(const string& name)
+            {
+                open_mapped(name.c_str());
+            }
+
             void close()
             {
                 if (!rdbuf_.close())
@@ -530,7 +843,7 @@ namespace std
 
             basic_ofstream(basic_ofstream&& other)
                 : basic_ostream<char_type, traits_type>{move(other)},
-                  rdbuf_{other.rdbuf_}
+                  rdbuf_{move(other.rdbuf_)}
             {
                 basic_ostream<char_type, traits_type>::set_rdbuf(&rdbuf_);
             }
@@ -641,7 +954,7 @@ namespace std
 
             basic_fstream(basic_fstream&& other)
                 : basic_iostream<char_type, traits_type>{move(other)},
-                  rdbuf_{other.rdbuf_}
+                  rdbuf_{move(other.rdbuf_)}
             {
                 basic_iostream<char_type, traits_type>::set_rdbuf(&rdbuf_);
             }
@@ -479,9 +479,9 @@ namespace std
                 width_      = rhs.width_;
                 precision_  = rhs.precision_;
                 fill_       = rhs.fill_;
-                locale_     = move(rhs.locale_);
+                locale_     = std::move(rhs.locale_);
                 rdstate_    = rhs.rdstate_;
-                callbacks_  = move(rhs.callbacks_);
+                callbacks_  = std::move(rhs.callbacks_);
 
                 delete[] iarray_;
                 iarray_      = rhs.iarray_;
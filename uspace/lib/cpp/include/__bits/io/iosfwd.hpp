@@ -63,6 +63,12 @@ namespace std
     template<class Char, class Traits = char_traits<Char>>
     class basic_streambuf;
 
+    namespace aux
+    {
+        template<class Char, class Traits>
+        struct get_area;
+    }
+
     template<class Char, class Traits = char_traits<Char>>
     class basic_istream;
 
@@ -518,9 +518,37 @@ namespace std
 
                 if (sen)
                 {
+                    using get_area = aux::get_area<Char, Traits>;
+                    auto& buf = *this->rdbuf();
+                    streamsize stored{};
+
                     while (true)
-                    { // We have exactly specified order of checks, easier to do them in the body.
-                        auto c = this->rdbuf()->sbumpc();
+                    {
+                        /**
+                         * Copy whatever we can from the get area in one go,
+                         * the character that ends the loop is then handled
+                         * by the checks below.
+                         */
+                        const char_type* data{};
+                        auto avail = get_area::fill(buf, data);
+                        auto room = n - 1 - stored;
+                        if (avail > 0 && room > 0)
+                        {
+                            auto len = min(avail, room);
+                            auto found = traits_type::find(data, static_cast<size_t>(len), delim);
+                            if (found)
+                                len = static_cast<streamsize>(found - data);
+
+                            traits_type::copy(s + stored, data, static_cast<size_t>(len));
+                            get_area::consume(buf, len);
+                            stored += len;
+
+                            if (!found)
+                                continue;
+                        }
+
+                        // We have exactly specified order of checks, easier to do them in the body.
+                        auto c = buf.sgetc();
 
                         if (traits_type::eq_int_type(c, traits_type::eof()))
                         {
@@ -529,21 +557,29 @@ namespace std
                         }
 
                         if (traits_type::eq_int_type(c, traits_type::to_int_type(delim)))
+                        {
+                            // The delimiter is extracted and counted, but not stored.
+                            buf.sbumpc();
+                            ++gcount_;
                             break;
+                        }
 
-                        if (n < 1 || gcount_ >= n - 1)
+                        // The character that does not fit stays in the stream.
+                        if (n < 1 || stored >= n - 1)
                         {
                             this->setstate(ios_base::failbit);
                             break;
                         }
 
-                        s[gcount_++] = traits_type::to_char_type(c);
+                        s[stored++] = traits_type::to_char_type(c);
+                        buf.sbumpc();
                     }
 
+                    gcount_ += stored;
                     if (gcount_ == 0)
                         this->setstate(ios_base::failbit);
                     if (n > 0)
-                        s[gcount_] = char_type{};
+                        s[stored] = char_type{};
                 }
 
                 return *this;
@@ -595,17 +631,12 @@ namespace std
                     return *this;
                 }
 
-                while (gcount_ < n)
-                {
-                    auto c = this->rdbuf()->sbumpc();
-                    if (traits_type::eq_int_type(c, traits_type::eof()))
-                    {
-                        this->setstate(ios_base::failbit | ios_base::eofbit);
-                        break;
-                    }
+                // The buffer can copy (or read directly into s) in bulk.
+                if (n > 0)
+                    gcount_ = this->rdbuf()->sgetn(s, n);
 
-                    s[gcount_++] = traits_type::to_char_type(c);
-                }
+                if (gcount_ < n)
+                    this->setstate(ios_base::failbit | ios_base::eofbit);
 
                 return *this;
             }
@@ -748,7 +779,7 @@ namespace std
 
             basic_istream(basic_istream&& rhs)
             {
-                gcount_ = rhs.gcout_;
+                gcount_ = rhs.gcount_;
 
                 basic_ios<Char, Traits>::move(rhs);
 
@@ -72,9 +72,13 @@ namespace std
             basic_stringbuf(const basic_stringbuf&) = delete;
 
             basic_stringbuf(basic_stringbuf&& other)
-                : mode_{move(other.mode_)}, str_{move(other.str_)}
+                : mode_{move(other.mode_)}, str_{}
             {
+                auto old_data = other.str_.data();
+                str_ = move(other.str_);
+
                 basic_streambuf<char_type, traits_type>::swap(other);
+                rebase_(old_data);
             }
 
             /**
@@ -90,10 +94,15 @@ namespace std
 
             void swap(basic_stringbuf& rhs)
             {
+                auto data = str_.data();
+                auto rhs_data = rhs.str_.data();
+
                 std::swap(mode_, rhs.mode_);
                 std::swap(str_, rhs.str_);
 
                 basic_streambuf<char_type, traits_type>::swap(rhs);
+                rebase_(rhs_data);
+                rhs.rebase_(data);
             }
 
             /**
@@ -250,6 +259,26 @@ namespace std
                 }
             }
 
+            /**
+             * Short strings are stored inside the string object,
+             * so the buffer pointers have to follow the characters
+             * when the string is moved to another stringbuf.
+             */
+            void rebase_(const char_type* old_data)
+            {
+                auto rebase = [&](char_type*& ptr){
+                    if (ptr)
+                        ptr = str_.begin() + (ptr - old_data);
+                };
+
+                rebase(this->input_begin_);
+                rebase(this->input_next_);
+                rebase(this->input_end_);
+                rebase(this->output_begin_);
+                rebase(this->output_next_);
+                rebase(this->output_end_);
+            }
+
             bool ensure_free_space_(size_t n = 1)
             {
                 str_.ensure_free_space_(n);
@@ -214,15 +214,15 @@ namespace std
 
             void swap(basic_streambuf& rhs)
             {
-                swap(input_begin_, rhs.input_begin_);
-                swap(input_next_, rhs.input_next_);
-                swap(input_end_, rhs.input_end_);
+                std::swap(input_begin_, rhs.input_begin_);
+                std::swap(input_next_, rhs.input_next_);
+                std::swap(input_end_, rhs.input_end_);
 
-                swap(output_begin_, rhs.output_begin_);
-                swap(output_next_, rhs.output_next_);
-                swap(output_end_, rhs.output_end_);
+                std::swap(output_begin_, rhs.output_begin_);
+                std::swap(output_next_, rhs.output_next_);
+                std::swap(output_end_, rhs.output_end_);
 
-                swap(locale_, rhs.locale_);
+                std::swap(locale_, rhs.locale_);
             }
 
             /**
@@ -337,9 +337,9 @@ namespace std
 
                 streamsize i{0};
                 auto eof = traits_type::eof();
-                for (; i <= n; ++i)
+                for (; i < n; ++i)
                 {
-                    if (!read_avail_() && traits_type::eq_int_type(uflow(), eof))
+                    if (!read_avail_() && traits_type::eq_int_type(underflow(), eof))
                         break;
 
                     *s++ = *input_next_++;
@@ -381,12 +381,13 @@ namespace std
                     return 0;
 
                 streamsize i{0};
-                for (; i <= n; ++i)
+                for (; i < n; ++i, ++s)
                 {
-                    if (!write_avail_() && traits_type::eq_int_type(overflow(), traits_type::eof()))
+                    if (write_avail_())
+                        *output_next_++ = *s;
+                    else if (traits_type::eq_int_type(overflow(traits_type::to_int_type(*s)),
+                                                      traits_type::eof()))
                         break;
-
-                    *output_next_++ = *s++;
                 }
 
                 return i;
@@ -422,8 +423,48 @@ namespace std
             {
                 return input_next_ && input_next_ < input_end_;
             }
+
+            friend struct aux::get_area<Char, Traits>;
     };
 
+    namespace aux
+    {
+        /**
+         * Gives the extraction functions direct access to the
+         * get area, so that they can scan it in bulk instead
+         * of calling sbumpc for every character.
+         */
+        template<class Char, class Traits>
+        struct get_area
+        {
+            /**
+             * Refills the get area if it is empty, points data
+             * to its contents and returns their length. Returns 0
+             * at the end of the input or if the buffer does not
+             * use a get area, in which case the caller has to
+             * fall back to sbumpc.
+             */
+            static streamsize fill(basic_streambuf<Char, Traits>& buf, const Char*& data)
+            {
+                if (!buf.read_avail_())
+                {
+                    if (Traits::eq_int_type(buf.underflow(), Traits::eof()) ||
+                        !buf.read_avail_())
+                        return streamsize{};
+                }
+
+                data = buf.input_next_;
+
+                return static_cast<streamsize>(buf.input_end_ - buf.input_next_);
+            }
+
+            static void consume(basic_streambuf<Char, Traits>& buf, streamsize n)
+            {
+                buf.input_next_ += n;
+            }
+        };
+    }
+
     using streambuf  = basic_streambuf<char>;
     using wstreambuf = basic_streambuf<wchar_t>;
 }
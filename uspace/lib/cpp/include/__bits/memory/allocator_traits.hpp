@@ -64,6 +64,9 @@ namespace std
     >
     { /* DUMMY BODY */ };
 
+    template<class T, class Alloc>
+    inline constexpr bool uses_allocator_v = uses_allocator<T, Alloc>::value;
+
     /**
      * 20.7.8, allocator traits:
      */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_MEMORY_MEMORY_RESOURCE
+#define LIBCPP_BITS_MEMORY_MEMORY_RESOURCE
+
+#include <__bits/memory/allocator_arg.hpp>
+#include <__bits/memory/allocator_traits.hpp>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+namespace std::pmr
+{
+    /**
+     * Note: We do not have max_align_t, this is
+     *       the alignment malloc guarantees.
+     */
+    inline constexpr size_t default_alignment{16};
+
+    /**
+     * 23.12.2, class memory_resource:
+     */
+
+    class memory_resource
+    {
+        public:
+            virtual ~memory_resource();
+
+            void* allocate(size_t bytes, size_t alignment = default_alignment)
+            {
+                return do_allocate(bytes, alignment);
+            }
+
+            void deallocate(void* ptr, size_t bytes, size_t alignment = default_alignment)
+            {
+                do_deallocate(ptr, bytes, alignment);
+            }
+
+            bool is_equal(const memory_resource& other) const noexcept
+            {
+                return do_is_equal(other);
+            }
+
+        private:
+            virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+            virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) = 0;
+            virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+    };
+
+    inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept
+    {
+        return &lhs == &rhs || lhs.is_equal(rhs);
+    }
+
+    inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /**
+     * 23.12.4, global memory resources:
+     * Note: As we cannot throw bad_alloc, allocations
+     *       that cannot be satisfied return nullptr.
+     */
+
+    memory_resource* new_delete_resource() noexcept;
+    memory_resource* null_memory_resource() noexcept;
+    memory_resource* set_default_resource(memory_resource* res) noexcept;
+    memory_resource* get_default_resource() noexcept;
+
+    /**
+     * HelenOS extension, returns a resource that maps every
+     * allocation as a separate address space area, rounded
+     * up to whole pages and aligned to at most a page.
+     * This is meant as the upstream of the arenas
+     * (monotonic_buffer_resource and the pool resources),
+     * whose big chunks then bypass the heap altogether.
+     */
+    memory_resource* area_resource() noexcept;
+
+    /**
+     * 23.12.3, class template polymorphic_allocator:
+     * Note: The standard deletes the copy assignment,
+     *       but our node based containers assign their
+     *       allocators, so we keep it.
+     */
+
+    template<class T>
+    class polymorphic_allocator
+    {
+        public:
+            using value_type = T;
+
+            polymorphic_allocator() noexcept
+                : resource_{get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator(memory_resource* res)
+                : resource_{res}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator(const polymorphic_allocator&) = default;
+
+            template<class U>
+            polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+                : resource_{other.resource()}
+            { /* DUMMY BODY */ }
+
+            T* allocate(size_t n)
+            {
+                return static_cast<T*>(
+                    resource_->allocate(n * sizeof(T), alignof(T))
+                );
+            }
+
+            void deallocate(T* ptr, size_t n)
+            {
+                resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+            }
+
+            /**
+             * Uses-allocator construction, elements that
+             * use allocators (e.g. pmr::string in pmr::vector)
+             * get our resource.
+             * Note: Piecewise construction of pairs is not
+             *       supported.
+             */
+            template<class U, class... Args>
+            void construct(U* ptr, Args&&... args)
+            {
+                if constexpr (!uses_allocator_v<U, polymorphic_allocator>)
+                    ::new(static_cast<void*>(ptr)) U(forward<Args>(args)...);
+                else if constexpr (is_constructible_v<U, allocator_arg_t, polymorphic_allocator, Args...>)
+                    ::new(static_cast<void*>(ptr)) U(allocator_arg, *this, forward<Args>(args)...);
+                else
+                    ::new(static_cast<void*>(ptr)) U(forward<Args>(args)..., *this);
+            }
+
+            template<class U>
+            void destroy(U* ptr)
+            {
+                ptr->~U();
+            }
+
+            polymorphic_allocator select_on_container_copy_construction() const
+            {
+                return polymorphic_allocator{};
+            }
+
+            memory_resource* resource() const
+            {
+                return resource_;
+            }
+
+        private:
+            memory_resource* resource_;
+    };
+
+    template<class T1, class T2>
+    bool operator==(const polymorphic_allocator<T1>& lhs,
+                    const polymorphic_allocator<T2>& rhs) noexcept
+    {
+        return *lhs.resource() == *rhs.resource();
+    }
+
+    template<class T1, class T2>
+    bool operator!=(const polymorphic_allocator<T1>& lhs,
+                    const polymorphic_allocator<T2>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+}
+
+#endif
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_MEMORY_POOL_RESOURCES
+#define LIBCPP_BITS_MEMORY_POOL_RESOURCES
+
+#include <__bits/memory/memory_resource.hpp>
+#include <cstdlib>
+#include <mutex>
+
+namespace std::aux
+{
+    /**
+     * Every chunk an arena gets from its upstream resource
+     * has this footer at its end, so that release() can
+     * return all of them without any extra bookkeeping
+     * allocations.
+     */
+    struct chunk_footer
+    {
+        chunk_footer* next;
+        void* start;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    /**
+     * Allocates a chunk with at least bytes usable bytes
+     * from upstream and links it to head, returns the start
+     * of the chunk (nullptr if upstream failed).
+     */
+    void* allocate_chunk(pmr::memory_resource* upstream, chunk_footer*& head,
+                         size_t bytes, size_t alignment);
+
+    void release_chunks(pmr::memory_resource* upstream, chunk_footer*& head);
+}
+
+namespace std::pmr
+{
+    /**
+     * 23.12.6, class monotonic_buffer_resource:
+     * Note: Deallocation is a no-op, everything is
+     *       freed at once by release() or the destructor,
+     *       which makes this ideal for memory whose lifetime
+     *       is bound to a request or a frame.
+     */
+
+    class monotonic_buffer_resource: public memory_resource
+    {
+        public:
+            monotonic_buffer_resource()
+                : monotonic_buffer_resource{get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit monotonic_buffer_resource(memory_resource* upstream)
+                : monotonic_buffer_resource{default_initial_size_, upstream}
+            { /* DUMMY BODY */ }
+
+            explicit monotonic_buffer_resource(size_t initial_size)
+                : monotonic_buffer_resource{initial_size, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            monotonic_buffer_resource(size_t initial_size, memory_resource* upstream);
+
+            monotonic_buffer_resource(void* buffer, size_t buffer_size)
+                : monotonic_buffer_resource{buffer, buffer_size, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            monotonic_buffer_resource(void* buffer, size_t buffer_size,
+                                      memory_resource* upstream);
+
+            monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+            monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+            ~monotonic_buffer_resource() override;
+
+            void release();
+
+            memory_resource* upstream_resource() const
+            {
+                return upstream_;
+            }
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+
+            void do_deallocate(void*, size_t, size_t) override
+            { /* DUMMY BODY */ }
+
+            bool do_is_equal(const memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+
+        private:
+            memory_resource* upstream_;
+
+            void* initial_buffer_;
+            size_t initial_size_;
+
+            char* current_;
+            size_t space_;
+
+            // Size of the next chunk, grows geometrically.
+            size_t next_size_;
+
+            aux::chunk_footer* chunks_;
+
+            static constexpr size_t default_initial_size_{1024};
+            static constexpr size_t growth_factor_{2};
+    };
+
+    /**
+     * 23.12.5, pool resource classes:
+     */
+
+    struct pool_options
+    {
+        size_t max_blocks_per_chunk{0};
+        size_t largest_required_pool_block{0};
+    };
+
+    /**
+     * The pools serve blocks of power of two sizes, each from
+     * its own free list refilled by chunks that grow up to
+     * max_blocks_per_chunk blocks. Blocks larger than
+     * largest_required_pool_block go directly to upstream.
+     */
+    class unsynchronized_pool_resource: public memory_resource
+    {
+        public:
+            unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream);
+
+            unsynchronized_pool_resource()
+                : unsynchronized_pool_resource{pool_options{}, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit unsynchronized_pool_resource(memory_resource* upstream)
+                : unsynchronized_pool_resource{pool_options{}, upstream}
+            { /* DUMMY BODY */ }
+
+            explicit unsynchronized_pool_resource(const pool_options& opts)
+                : unsynchronized_pool_resource{opts, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+            unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+            ~unsynchronized_pool_resource() override;
+
+            void release();
+
+            memory_resource* upstream_resource() const
+            {
+                return upstream_;
+            }
+
+            pool_options options() const
+            {
+                return options_;
+            }
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+            bool do_is_equal(const memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+
+        private:
+            struct free_block
+            {
+                free_block* next;
+            };
+
+            struct pool
+            {
+                free_block* free;
+                size_t next_blocks;
+            };
+
+            /**
+             * Allocations too big for the pools are linked
+             * through a header placed after the block, which
+             * we can find as the caller gives us the size
+             * on deallocation.
+             */
+            struct oversized_footer
+            {
+                oversized_footer* prev;
+                oversized_footer* next;
+                void* start;
+                size_t bytes;
+                size_t alignment;
+            };
+
+            memory_resource* upstream_;
+            pool_options options_;
+
+            static constexpr size_t min_block_shift_{4};
+            static constexpr size_t max_pools_{16};
+            static constexpr size_t min_blocks_per_chunk_{8};
+            static constexpr size_t default_max_blocks_per_chunk_{1024};
+            static constexpr size_t default_largest_block_{4096};
+
+            pool pools_[max_pools_];
+            size_t pool_count_;
+
+            aux::chunk_footer* chunks_;
+            oversized_footer* oversized_;
+
+            size_t pool_index_(size_t bytes, size_t alignment) const;
+            bool refill_(size_t idx);
+            static size_t oversized_offset_(size_t bytes);
+    };
+
+    /**
+     * Note: This is the unsynchronized pool with a mutex,
+     *       as we do not have any thread local storage
+     *       for per-thread pools.
+     */
+    class synchronized_pool_resource: public memory_resource
+    {
+        public:
+            synchronized_pool_resource(const pool_options& opts, memory_resource* upstream)
+                : mtx_{}, pools_{opts, upstream}
+            { /* DUMMY BODY */ }
+
+            synchronized_pool_resource()
+                : synchronized_pool_resource{pool_options{}, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit synchronized_pool_resource(memory_resource* upstream)
+                : synchronized_pool_resource{pool_options{}, upstream}
+            { /* DUMMY BODY */ }
+
+            explicit synchronized_pool_resource(const pool_options& opts)
+                : synchronized_pool_resource{opts, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            synchronized_pool_resource(const synchronized_pool_resource&) = delete;
+            synchronized_pool_resource& operator=(const synchronized_pool_resource&) = delete;
+
+            ~synchronized_pool_resource() override = default;
+
+            void release()
+            {
+                lock_guard<mutex> lock{mtx_};
+                pools_.release();
+            }
+
+            memory_resource* upstream_resource() const
+            {
+                return pools_.upstream_resource();
+            }
+
+            pool_options options() const
+            {
+                return pools_.options();
+            }
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override
+            {
+                lock_guard<mutex> lock{mtx_};
+
+                return pools_.allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+            {
+                lock_guard<mutex> lock{mtx_};
+                pools_.deallocate(ptr, bytes, alignment);
+            }
+
+            bool do_is_equal(const memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+
+        private:
+            mutex mtx_;
+            unsynchronized_pool_resource pools_;
+    };
+}
+
+#endif
@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_MEMORY_SHARED_PAYLOAD
 #define LIBCPP_BITS_MEMORY_SHARED_PAYLOAD
 
+#include <atomic>
 #include <cinttypes>
 #include <utility>
 
@@ -42,10 +43,6 @@ namespace std
 
 namespace std::aux
 {
-    /**
-     * At the moment we do not have atomics, change this
-     * to std::atomic<long> once we do.
-     */
     using refcount_t = long;
 
     /**
@@ -141,20 +138,30 @@ namespace std::aux
                 return (uint8_t*)&deleter_;
             }
 
+            /**
+             * Note: Increments can be relaxed, since new references
+             *       can only be created from existing ones, which
+             *       already keep the payload alive. Decrements
+             *       release our writes to the payload and the one
+             *       dropping the last reference acquires those of
+             *       all the others before destroying it.
+             */
             void increment() noexcept override
             {
-                __atomic_add_fetch(&refcount_, 1, __ATOMIC_ACQ_REL);
+                refcount_.fetch_add(1, memory_order_relaxed);
             }
 
             void increment_weak() noexcept override
             {
-                __atomic_add_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL);
+                weak_refcount_.fetch_add(1, memory_order_relaxed);
             }
 
             bool decrement() noexcept override
             {
-                if (__atomic_sub_fetch(&refcount_, 1, __ATOMIC_ACQ_REL) == 0)
+                if (refcount_.fetch_sub(1, memory_order_release) == 1)
                 {
+                    atomic_thread_fence(memory_order_acquire);
+
                     /**
                      * First call to destroy() will delete the held object,
                      * so it doesn't matter what the weak_refcount_ is,
@@ -170,17 +177,24 @@ namespace std::aux
 
             bool decrement_weak() noexcept override
             {
-                return __atomic_sub_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL) == 0 && refs() == 0;
+                if (weak_refcount_.fetch_sub(1, memory_order_release) == 1)
+                {
+                    atomic_thread_fence(memory_order_acquire);
+
+                    return refs() == 0;
+                }
+                else
+                    return false;
             }
 
             refcount_t refs() const noexcept override
             {
-                return __atomic_load_n(&refcount_, __ATOMIC_RELAXED);
+                return refcount_.load(memory_order_relaxed);
             }
 
             refcount_t weak_refs() const noexcept override
             {
-                return __atomic_load_n(&weak_refcount_, __ATOMIC_RELAXED);
+                return weak_refcount_.load(memory_order_relaxed);
             }
 
             bool expired() const noexcept override
@@ -193,9 +207,8 @@ namespace std::aux
                 refcount_t rfs = refs();
                 while (rfs != 0L)
                 {
-                    if (__atomic_compare_exchange_n(&refcount_, &rfs, rfs + 1,
-                                                    true, __ATOMIC_RELAXED,
-                                                    __ATOMIC_RELAXED))
+                    if (refcount_.compare_exchange_weak(rfs, rfs + 1,
+                                                        memory_order_relaxed))
                     {
                         return this;
                     }
@@ -215,8 +228,8 @@ namespace std::aux
              * can't decrement the weak_refcount_ to
              * zero with shared_ptrs using this object.
              */
-            refcount_t refcount_;
-            refcount_t weak_refcount_;
+            atomic<refcount_t> refcount_;
+            atomic<refcount_t> weak_refcount_;
     };
 }
 
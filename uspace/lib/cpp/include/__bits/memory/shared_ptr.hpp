@@ -35,6 +35,8 @@
 #include <__bits/memory/shared_payload.hpp>
 #include <__bits/memory/unique_ptr.hpp>
 #include <__bits/trycatch.hpp>
+#include <atomic>
+#include <cstdint>
 #include <exception>
 #include <type_traits>
 
@@ -624,7 +626,153 @@ namespace std
      * 20.8.2.6, shared_ptr atomic access
      */
 
-    // TODO: implement
+    namespace aux
+    {
+        /**
+         * A shared_ptr is two words and its copy touches
+         * the payload, so we cannot do this lock free.
+         * Instead, we hash the address of the shared_ptr
+         * to one of a small pool of spinlocks. The critical
+         * sections only copy or swap pointers, the old
+         * values are always destroyed after unlocking.
+         */
+        inline constexpr size_t shared_ptr_lock_count = 16;
+
+        inline atomic_flag shared_ptr_locks[shared_ptr_lock_count]{};
+
+        class shared_ptr_lock_guard
+        {
+            public:
+                shared_ptr_lock_guard(const void* ptr) noexcept
+                    : flag_{shared_ptr_locks[
+                        (reinterpret_cast<uintptr_t>(ptr) >> 4) % shared_ptr_lock_count
+                      ]}
+                {
+                    while (flag_.test_and_set(memory_order_acquire))
+                    { /* DUMMY BODY */ }
+                }
+
+                ~shared_ptr_lock_guard()
+                {
+                    flag_.clear(memory_order_release);
+                }
+
+                shared_ptr_lock_guard(const shared_ptr_lock_guard&) = delete;
+                shared_ptr_lock_guard& operator=(const shared_ptr_lock_guard&) = delete;
+
+            private:
+                atomic_flag& flag_;
+        };
+    }
+
+    template<class T>
+    bool atomic_is_lock_free(const shared_ptr<T>*)
+    {
+        return false;
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_load(const shared_ptr<T>* ptr)
+    {
+        aux::shared_ptr_lock_guard guard{ptr};
+
+        return *ptr;
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_load_explicit(const shared_ptr<T>* ptr, memory_order)
+    {
+        return atomic_load(ptr);
+    }
+
+    template<class T>
+    void atomic_store(shared_ptr<T>* ptr, shared_ptr<T> desired)
+    {
+        {
+            aux::shared_ptr_lock_guard guard{ptr};
+
+            ptr->swap(desired);
+        }
+
+        // Old value gets destroyed with desired.
+    }
+
+    template<class T>
+    void atomic_store_explicit(shared_ptr<T>* ptr, shared_ptr<T> desired,
+                               memory_order)
+    {
+        atomic_store(ptr, move(desired));
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_exchange(shared_ptr<T>* ptr, shared_ptr<T> desired)
+    {
+        aux::shared_ptr_lock_guard guard{ptr};
+
+        ptr->swap(desired);
+
+        return desired;
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_exchange_explicit(shared_ptr<T>* ptr, shared_ptr<T> desired,
+                                           memory_order)
+    {
+        return atomic_exchange(ptr, move(desired));
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_strong(shared_ptr<T>* ptr, shared_ptr<T>* expected,
+                                        shared_ptr<T> desired)
+    {
+        shared_ptr<T> old{};
+
+        {
+            aux::shared_ptr_lock_guard guard{ptr};
+
+            if (ptr->get() == expected->get() &&
+                !ptr->owner_before(*expected) && !expected->owner_before(*ptr))
+            {
+                old = move(*ptr);
+                *ptr = move(desired);
+
+                return true;
+            }
+
+            old = *ptr;
+        }
+
+        /**
+         * Assigning to expected outside of the lock, as
+         * it may release the last reference of its old value.
+         */
+        expected->swap(old);
+
+        return false;
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_weak(shared_ptr<T>* ptr, shared_ptr<T>* expected,
+                                      shared_ptr<T> desired)
+    {
+        return atomic_compare_exchange_strong(ptr, expected, move(desired));
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_strong_explicit(shared_ptr<T>* ptr, shared_ptr<T>* expected,
+                                                 shared_ptr<T> desired, memory_order,
+                                                 memory_order)
+    {
+        return atomic_compare_exchange_strong(ptr, expected, move(desired));
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_weak_explicit(shared_ptr<T>* ptr, shared_ptr<T>* expected,
+                                               shared_ptr<T> desired, memory_order,
+                                               memory_order)
+    {
+        return atomic_compare_exchange_strong(ptr, expected, move(desired));
+    }
 
     /**
      * 20.8.2.7, smart pointer hash support:
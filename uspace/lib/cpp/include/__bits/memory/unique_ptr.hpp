@@ -111,7 +111,7 @@ namespace std
 
             unique_ptr(pointer ptr, /* TODO */ char d) noexcept;
 
-            unique_ptr(unique_ptr&& other)
+            unique_ptr(unique_ptr&& other) noexcept
                 : ptr_{move(other.ptr_)}, deleter_{forward<deleter_type>(other.deleter_)}
             {
                 other.ptr_ = nullptr;
@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_NUMERIC
 #define LIBCPP_BITS_NUMERIC
 
+#include <iterator>
 #include <utility>
 
 namespace std
@@ -59,6 +60,42 @@ namespace std
         return acc;
     }
 
+    /**
+     * 29.8.3 (C++17), reduce:
+     * Note: The serial versions simply reduce from the left.
+     */
+
+    template<class InputIterator, class T, class BinaryOperation>
+    T reduce(InputIterator first, InputIterator last, T init,
+             BinaryOperation op)
+    {
+        auto acc{move(init)};
+        while (first != last)
+            acc = op(move(acc), *first++);
+
+        return acc;
+    }
+
+    template<class InputIterator, class T>
+    T reduce(InputIterator first, InputIterator last, T init)
+    {
+        auto acc{move(init)};
+        while (first != last)
+            acc = move(acc) + *first++;
+
+        return acc;
+    }
+
+    template<class InputIterator>
+    typename iterator_traits<InputIterator>::value_type
+    reduce(InputIterator first, InputIterator last)
+    {
+        return reduce(
+            first, last,
+            typename iterator_traits<InputIterator>::value_type{}
+        );
+    }
+
     /**
      * 26.7.3, inner product:
      */
@@ -87,6 +124,46 @@ namespace std
         return res;
     }
 
+    /**
+     * 29.8.5 (C++17), transform reduce:
+     */
+
+    template<class InputIterator1, class InputIterator2, class T,
+             class BinaryOperation1, class BinaryOperation2>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2, T init,
+                       BinaryOperation1 op1, BinaryOperation2 op2)
+    {
+        auto acc{move(init)};
+        while (first1 != last1)
+            acc = op1(move(acc), op2(*first1++, *first2++));
+
+        return acc;
+    }
+
+    template<class InputIterator1, class InputIterator2, class T>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2, T init)
+    {
+        auto acc{move(init)};
+        while (first1 != last1)
+            acc = move(acc) + (*first1++) * (*first2++);
+
+        return acc;
+    }
+
+    template<class InputIterator, class T,
+             class BinaryOperation, class UnaryOperation>
+    T transform_reduce(InputIterator first, InputIterator last, T init,
+                       BinaryOperation op1, UnaryOperation op2)
+    {
+        auto acc{move(init)};
+        while (first != last)
+            acc = op1(move(acc), op2(*first++));
+
+        return acc;
+    }
+
     /**
      * 26.7.4, partial sum:
      */
@@ -123,6 +200,49 @@ namespace std
         return result;
     }
 
+    /**
+     * 29.8.8 (C++17), inclusive scan:
+     */
+
+    template<class InputIterator, class OutputIterator,
+             class BinaryOperation, class T>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                  OutputIterator result, BinaryOperation op,
+                                  T init)
+    {
+        auto acc{move(init)};
+        while (first != last)
+        {
+            acc = op(move(acc), *first++);
+            *result++ = acc;
+        }
+
+        return result;
+    }
+
+    template<class InputIterator, class OutputIterator, class BinaryOperation>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                  OutputIterator result, BinaryOperation op)
+    {
+        if (first == last)
+            return result;
+
+        typename iterator_traits<InputIterator>::value_type acc{*first++};
+        *result++ = acc;
+
+        return inclusive_scan(first, last, result, op, move(acc));
+    }
+
+    template<class InputIterator, class OutputIterator>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                  OutputIterator result)
+    {
+        return inclusive_scan(
+            first, last, result,
+            [](const auto& lhs, const auto& rhs) { return lhs + rhs; }
+        );
+    }
+
     /**
      * 26.7.5, adjacent difference:
      */
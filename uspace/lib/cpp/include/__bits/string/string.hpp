@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_STRING
 #define LIBCPP_BITS_STRING
 
+#include <__bits/memory/memory_resource.hpp>
 #include <__bits/string/stringfwd.hpp>
 #include <algorithm>
 #include <initializer_list>
@@ -90,8 +91,7 @@ namespace std
 
         static const char_type* find(const char_type* s, size_t n, const char_type& c)
         {
-            size_t i{};
-            while (i++ < n)
+            for (size_t i = 0; i < n; ++i)
             {
                 if (s[i] == c)
                     return s + i;
@@ -363,8 +363,7 @@ namespace std
 
         static const char_type* find(const char_type* s, size_t n, const char_type& c)
         {
-            size_t i{};
-            while (i++ < n)
+            for (size_t i = 0; i < n; ++i)
             {
                 if (s[i] == c)
                     return s + i;
@@ -454,7 +453,8 @@ namespace std
             { /* DUMMY BODY */ }
 
             explicit basic_string(const allocator_type& alloc)
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 /**
                  * Postconditions:
@@ -462,29 +462,31 @@ namespace std
                  *  size() = 0
                  *  capacity() = unspecified
                  */
-                data_ = allocator_.allocate(default_capacity_);
-                capacity_ = default_capacity_;
+                ensure_null_terminator_();
             }
 
             basic_string(const basic_string& other)
-                : data_{}, size_{other.size_}, capacity_{other.capacity_},
-                  allocator_{other.allocator_}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{
+                      allocator_traits<allocator_type>::select_on_container_copy_construction(
+                          other.allocator_
+                      )
+                  }
             {
-                init_(other.data(), size_);
+                init_(other.data(), other.size_);
             }
 
-            basic_string(basic_string&& other)
-                : data_{other.data_}, size_{other.size_},
-                  capacity_{other.capacity_}, allocator_{move(other.allocator_)}
+            basic_string(basic_string&& other) noexcept
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{move(other.allocator_)}
             {
-                other.data_ = nullptr;
-                other.size_ = 0;
-                other.capacity_ = 0;
+                steal_(other);
             }
 
             basic_string(const basic_string& other, size_type pos, size_type n = npos,
                          const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 // TODO: if pos < other.size() throw out_of_range.
                 auto len = min(n, other.size() - pos);
@@ -492,40 +494,38 @@ namespace std
             }
 
             basic_string(const value_type* str, size_type n, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                init_(str, size_);
+                init_(str, n);
             }
 
             basic_string(const value_type* str, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 init_(str, traits_type::length(str));
             }
 
             basic_string(size_type n, value_type c, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
-                for (size_type i = 0; i < size_; ++i)
-                    traits_type::assign(data_[i], c);
-                ensure_null_terminator_();
+                fill_(n, c);
             }
 
             template<class InputIterator>
             basic_string(InputIterator first, InputIterator last,
                          const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 if constexpr (is_integral<InputIterator>::value)
                 { // Required by the standard.
-                    size_ = static_cast<size_type>(first);
-                    capacity_ = size_;
-                    data_ = allocator_.allocate(capacity_);
-
-                    for (size_type i = 0; i < size_; ++i)
-                        traits_type::assign(data_[i], static_cast<value_type>(last));
-                    ensure_null_terminator_();
+                    fill_(
+                        static_cast<size_type>(first),
+                        static_cast<value_type>(last)
+                    );
                 }
                 else
                 {
@@ -539,31 +539,32 @@ namespace std
             { /* DUMMY BODY */ }
 
             basic_string(const basic_string& other, const allocator_type& alloc)
-                : data_{}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                init_(other.data(), size_);
+                init_(other.data(), other.size_);
             }
 
             basic_string(basic_string&& other, const allocator_type& alloc)
-                : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                other.data_ = nullptr;
-                other.size_ = 0;
-                other.capacity_ = 0;
+                if (allocator_ == other.allocator_)
+                    steal_(other);
+                else
+                    init_(other.data(), other.size_);
             }
 
             ~basic_string()
             {
-                allocator_.deallocate(data_, capacity_);
+                if (!is_local_())
+                    allocator_.deallocate(data_, capacity_);
             }
 
             basic_string& operator=(const basic_string& other)
             {
                 if (this != &other)
-                {
-                    basic_string tmp{other};
-                    swap(tmp);
-                }
+                    assign(other.data(), other.size());
 
                 return *this;
             }
@@ -572,24 +573,39 @@ namespace std
                 noexcept(allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
                          allocator_traits<allocator_type>::is_always_equal::value)
             {
-                if (this != &other)
-                    swap(other);
+                using traits = allocator_traits<allocator_type>;
+
+                if (this == &other)
+                    return *this;
+
+                if constexpr (!traits::propagate_on_container_move_assignment::value &&
+                              !traits::is_always_equal::value)
+                {
+                    // Cannot take over memory from a different allocator.
+                    if (allocator_ != other.allocator_)
+                    {
+                        assign(other.data(), other.size_);
+
+                        return *this;
+                    }
+                }
+
+                release_();
+                if constexpr (traits::propagate_on_container_move_assignment::value)
+                    allocator_ = move(other.allocator_);
+                steal_(other);
 
                 return *this;
             }
 
             basic_string& operator=(const value_type* other)
             {
-                *this = basic_string{other};
-
-                return *this;
+                return assign(other);
             }
 
             basic_string& operator=(value_type c)
             {
-                *this = basic_string{1, c};
-
-                return *this;
+                return assign(&c, 1);
             }
 
             basic_string& operator=(initializer_list<value_type> init)
@@ -690,7 +706,7 @@ namespace std
                 {
                     ensure_free_space_(new_size - size_ + 1);
                     for (size_type i = size_; i < new_size; ++i)
-                        traits_type::assign(data_[i], i);
+                        traits_type::assign(data_[i], c);
                 }
 
                 size_ = new_size;
@@ -720,13 +736,27 @@ namespace std
 
             void shrink_to_fit()
             {
-                if (size_ != capacity_)
-                    resize_with_copy_(size_, capacity_);
+                if (is_local_() || size_ + 1 == capacity_)
+                    return;
+
+                auto old_data = data_;
+                auto old_capacity = capacity_;
+                if (size_ < local_capacity_)
+                    set_local_();
+                else
+                {
+                    data_ = allocator_.allocate(size_ + 1);
+                    capacity_ = size_ + 1;
+                }
+
+                traits_type::copy(data_, old_data, size_ + 1);
+                allocator_.deallocate(old_data, old_capacity);
             }
 
             void clear() noexcept
             {
                 size_ = 0;
+                ensure_null_terminator_();
             }
 
             bool empty() const noexcept
@@ -868,9 +898,7 @@ namespace std
 
             basic_string& assign(basic_string&& str)
             {
-                swap(str);
-
-                return *this;
+                return *this = move(str);
             }
 
             basic_string& assign(const basic_string& str, size_type pos,
@@ -879,7 +907,6 @@ namespace std
                 if (pos < str.size())
                 {
                     auto len = min(n, str.size() - pos);
-                    ensure_free_space_(len);
 
                     return assign(str.data() + pos, len);
                 }
@@ -891,8 +918,21 @@ namespace std
             basic_string& assign(const value_type* str, size_type n)
             {
                 // TODO: if (n > max_size()) throw length_error.
-                resize_without_copy_(n);
-                traits_type::copy(begin(), str, n);
+                if (n < capacity_)
+                {
+                    // Reuse the buffer, str may point into it.
+                    traits_type::move(data_, str, n);
+                }
+                else
+                {
+                    auto new_data = allocator_.allocate(n + 1);
+                    traits_type::copy(new_data, str, n);
+
+                    release_();
+                    data_ = new_data;
+                    capacity_ = n + 1;
+                }
+
                 size_ = n;
                 ensure_null_terminator_();
 
@@ -906,7 +946,9 @@ namespace std
 
             basic_string& assign(size_type n, value_type c)
             {
-                return assign(basic_string(n, c));
+                fill_(n, c);
+
+                return *this;
             }
 
             template<class InputIterator>
@@ -1066,8 +1108,8 @@ namespace std
                 // TODO: if size() - len > max_size() - n2 throw length_error
                 auto len = min(n1, size_ - pos);
 
-                basic_string tmp{};
-                tmp.resize_without_copy_(size_ - len + n2);
+                basic_string tmp{get_allocator()};
+                tmp.resize_without_copy_(size_ - len + n2 + 1);
 
                 // Prefix.
                 copy_(begin(), begin() + pos, tmp.begin());
@@ -1079,6 +1121,7 @@ namespace std
                 copy_(begin() + pos + len, end(), tmp.begin() + pos + n2);
 
                 tmp.size_ = size_ - len + n2;
+                tmp.ensure_null_terminator_();
                 swap(tmp);
                 return *this;
             }
@@ -1144,9 +1187,24 @@ namespace std
                 noexcept(allocator_traits<allocator_type>::propagate_on_container_swap::value ||
                          allocator_traits<allocator_type>::is_always_equal::value)
             {
-                std::swap(data_, other.data_);
+                if (!is_local_() && !other.is_local_())
+                {
+                    std::swap(data_, other.data_);
+                    std::swap(capacity_, other.capacity_);
+                }
+                else if (is_local_() && other.is_local_())
+                {
+                    value_type tmp[local_capacity_];
+                    traits_type::copy(tmp, local_, size_ + 1);
+                    traits_type::copy(local_, other.local_, other.size_ + 1);
+                    traits_type::copy(other.local_, tmp, size_ + 1);
+                }
+                else if (is_local_())
+                    swap_local_with_heap_(other);
+                else
+                    other.swap_local_with_heap_(*this);
+
                 std::swap(size_, other.size_);
-                std::swap(capacity_, other.capacity_);
             }
 
             /**
@@ -1460,35 +1518,103 @@ namespace std
             }
 
         private:
+            /**
+             * Number of characters (including the null terminator)
+             * stored inside the string object itself, so that short
+             * strings need no allocation.
+             */
+            static constexpr size_type local_capacity_{16 / sizeof(value_type)};
+
             value_type* data_;
             size_type size_;
             size_type capacity_;
             allocator_type allocator_;
+            value_type local_[local_capacity_];
 
             template<class C, class T, class A>
             friend class basic_stringbuf;
 
+            bool is_local_() const noexcept
+            {
+                return data_ == local_;
+            }
+
+            void set_local_() noexcept
+            {
+                data_ = local_;
+                capacity_ = local_capacity_;
+            }
+
+            void release_()
+            {
+                if (!is_local_())
+                    allocator_.deallocate(data_, capacity_);
+                set_local_();
+            }
+
+            /**
+             * Takes over the contents of other, leaving
+             * it empty. This string must not own any memory.
+             */
+            void steal_(basic_string& other) noexcept
+            {
+                if (other.is_local_())
+                    traits_type::copy(local_, other.local_, other.size_ + 1);
+                else
+                {
+                    data_ = other.data_;
+                    capacity_ = other.capacity_;
+                }
+                size_ = other.size_;
+
+                other.set_local_();
+                other.size_ = 0;
+                other.ensure_null_terminator_();
+            }
+
             /**
-             * Arbitrary value, standard just requires
-             * data() to have some capacity.
-             * (Well, we could've done data_ = &data_ and
-             * set capacity to 0, but that would be too cryptic.)
+             * Exchanges buffers with other, which owns allocated
+             * memory, while this string is stored locally.
+             * Sizes are left to the caller.
              */
-            static constexpr size_type default_capacity_{4};
+            void swap_local_with_heap_(basic_string& other) noexcept
+            {
+                auto heap_data = other.data_;
+                auto heap_capacity = other.capacity_;
+
+                traits_type::copy(other.local_, local_, size_ + 1);
+                other.set_local_();
 
+                data_ = heap_data;
+                capacity_ = heap_capacity;
+            }
+
+            /**
+             * Initializes a newly constructed string.
+             */
             void init_(const value_type* str, size_type size)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                if (size >= capacity_)
+                {
+                    data_ = allocator_.allocate(size + 1);
+                    capacity_ = size + 1;
+                }
 
                 size_ = size;
-                capacity_ = size + 1;
-
-                data_ = allocator_.allocate(capacity_);
                 traits_type::copy(data_, str, size);
                 ensure_null_terminator_();
             }
 
+            void fill_(size_type n, value_type c)
+            {
+                resize_without_copy_(n + 1);
+
+                for (size_type i = 0; i < n; ++i)
+                    traits_type::assign(data_[i], c);
+                size_ = n;
+                ensure_null_terminator_();
+            }
+
             size_type next_capacity_(size_type hint = 0) const noexcept
             {
                 if (hint != 0)
@@ -1508,32 +1634,41 @@ namespace std
                     resize_with_copy_(size_, max(size_ + 1 + n, next_capacity_()));
             }
 
+            /**
+             * Makes room for capacity characters (including
+             * the null terminator), discarding the contents.
+             */
             void resize_without_copy_(size_type capacity)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                if (capacity > capacity_)
+                {
+                    release_();
+
+                    if (capacity > capacity_)
+                    {
+                        data_ = allocator_.allocate(capacity);
+                        capacity_ = capacity;
+                    }
+                }
 
-                data_ = allocator_.allocate(capacity);
                 size_ = 0;
-                capacity_ = capacity;
                 ensure_null_terminator_();
             }
 
             void resize_with_copy_(size_type size, size_type capacity)
             {
-                if(capacity_ == 0 || capacity_ < capacity)
+                if (capacity > capacity_)
                 {
                     auto new_data = allocator_.allocate(capacity);
 
                     auto to_copy = min(size, size_);
-                    traits_type::move(new_data, data_, to_copy);
-
-                    std::swap(data_, new_data);
+                    traits_type::copy(new_data, data_, to_copy);
 
-                    allocator_.deallocate(new_data, capacity_);
+                    release_();
+                    data_ = new_data;
+                    capacity_ = capacity;
                 }
 
-                capacity_ = capacity;
                 size_ = size;
                 ensure_null_terminator_();
             }
@@ -1593,6 +1728,17 @@ namespace std
     using u32string = basic_string<char32_t>;
     using wstring   = basic_string<wchar_t>;
 
+    namespace pmr
+    {
+        template<class Char, class Traits = char_traits<Char>>
+        using basic_string = std::basic_string<Char, Traits, polymorphic_allocator<Char>>;
+
+        using string    = basic_string<char>;
+        using u16string = basic_string<char16_t>;
+        using u32string = basic_string<char32_t>;
+        using wstring   = basic_string<wchar_t>;
+    }
+
     /**
      * 21.4.8, basic_string non-member functions:
      */
@@ -31,6 +31,7 @@
 
 #include <__bits/string/string.hpp>
 #include <ios>
+#include <iosfwd>
 
 namespace std
 {
@@ -131,33 +132,50 @@ namespace std
 
         if (sen)
         {
+            using get_area = aux::get_area<Char, Traits>;
+
             str.clear();
-            streamsize count{};
+            auto& buf = *is.rdbuf();
+            bool extracted{false};
 
             while (true)
             {
-                auto ic = is.rdbuf()->sbumpc();
+                // Scan the buffered input for the delimiter at once.
+                const Char* data{};
+                auto avail = get_area::fill(buf, data);
+                if (avail > 0)
+                {
+                    auto found = Traits::find(data, static_cast<size_t>(avail), delim);
+                    auto len = found ? static_cast<streamsize>(found - data) : avail;
+
+                    str.append(data, static_cast<size_t>(len));
+                    get_area::consume(buf, found ? len + 1 : len);
+                    extracted = true;
+
+                    if (found)
+                        break;
+                    else
+                        continue;
+                }
+
+                auto ic = buf.sbumpc();
                 if (Traits::eq_int_type(ic, Traits::eof()))
                 {
                     is.setstate(ios_base::eofbit);
                     break;
                 }
 
+                extracted = true;
+
                 auto c = Traits::to_char_type(ic);
                 if (Traits::eq(c, delim))
                     break;
 
                 str.push_back(c);
-                ++count;
-
-                if (count >= static_cast<streamsize>(str.max_size()))
-                {
-                    is.setstate(ios_base::failbit);
-                    break;
-                }
             }
 
-            if (count == 0)
+            // Note: The delimiter counts as extracted, so empty lines do not fail.
+            if (!extracted)
                 is.setstate(ios_base::failbit);
         }
         else
@@ -30,6 +30,7 @@
 #define LIBCPP_BITS_TEST_MOCK
 
 #include <cstdlib>
+#include <memory>
 #include <tuple>
 
 namespace std::test
@@ -75,6 +76,64 @@ namespace std::test
             move_constructor_calls = size_t{};
         }
     };
+
+    /**
+     * Allocator that counts the number of allocations
+     * and deallocations made through any of its instances.
+     */
+    struct allocation_counter
+    {
+        static size_t allocations;
+        static size_t deallocations;
+
+        static void clear()
+        {
+            allocations = size_t{};
+            deallocations = size_t{};
+        }
+    };
+
+    template<class T>
+    struct counting_allocator: public allocator<T>
+    {
+        template<class U>
+        struct rebind
+        {
+            using other = counting_allocator<U>;
+        };
+
+        counting_allocator() noexcept = default;
+
+        template<class U>
+        counting_allocator(const counting_allocator<U>&) noexcept
+        { /* DUMMY BODY */ }
+
+        T* allocate(size_t n, const void* = nullptr)
+        {
+            ++allocation_counter::allocations;
+
+            return allocator<T>::allocate(n);
+        }
+
+        void deallocate(T* ptr, size_t n)
+        {
+            ++allocation_counter::deallocations;
+
+            allocator<T>::deallocate(ptr, n);
+        }
+    };
+
+    template<class T, class U>
+    bool operator==(const counting_allocator<T>&, const counting_allocator<U>&)
+    {
+        return true;
+    }
+
+    template<class T, class U>
+    bool operator!=(const counting_allocator<T>&, const counting_allocator<U>&)
+    {
+        return false;
+    }
 }
 
 #endif
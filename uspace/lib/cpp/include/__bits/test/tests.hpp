@@ -105,6 +105,7 @@ namespace std::test
             void test_construction_and_assignment();
             void test_insert();
             void test_erase();
+            void test_emplace();
     };
 
     class string_test: public test_suite
@@ -123,6 +124,7 @@ namespace std::test
             void test_find();
             void test_substr();
             void test_compare();
+            void test_allocations();
     };
 
     class bitset_test: public test_suite
@@ -148,6 +150,7 @@ namespace std::test
             void test_resizing();
             void test_push_pop();
             void test_operations();
+            void test_emplace_erase();
     };
 
     class tuple_test: public test_suite
@@ -177,6 +180,8 @@ namespace std::test
             void test_multi();
             void test_reverse_iterators();
             void test_multi_bounds_and_ranges();
+            void test_sorted_build_and_hints();
+            void test_extract_and_merge();
     };
 
     class set_test: public test_suite
@@ -192,6 +197,8 @@ namespace std::test
             void test_multi();
             void test_reverse_iterators();
             void test_multi_bounds_and_ranges();
+            void test_sorted_build_and_hints();
+            void test_extract_and_merge();
     };
 
     class unordered_map_test: public test_suite
@@ -219,6 +226,20 @@ namespace std::test
             void test_multi();
     };
 
+    class flat_hash_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_constructors_and_assignment();
+            void test_insert_erase();
+            void test_reserve();
+            void test_heterogeneous();
+            void test_set();
+    };
+
     class numeric_test: public test_suite
     {
         public:
@@ -256,6 +277,33 @@ namespace std::test
             void test_pointers();
     };
 
+    class memory_resource_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_monotonic();
+            void test_pools();
+            void test_containers();
+            void test_area();
+    };
+
+    class parallel_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_policies();
+            void test_loops();
+            void test_reductions();
+            void test_scans();
+            void test_sort();
+    };
+
     class list_test: public test_suite
     {
         public:
@@ -293,6 +341,44 @@ namespace std::test
         private:
             void test_non_modifying();
             void test_mutating();
+            void test_sorting();
+            void test_sorting_large();
+    };
+
+    class atomic_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+        private:
+            void test_integral();
+            void test_pointer();
+            void test_flag();
+            void test_shared_ptr();
+    };
+
+    class future_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+        private:
+            void test_promise();
+            void test_packaged_task();
+            void test_shared_future();
+            void test_async();
+    };
+
+    class io_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+        private:
+            void test_filebuf();
+            void test_getline();
+            void test_getline_limits();
+            void test_bulk();
     };
 }
 
@@ -29,6 +29,10 @@
 #ifndef LIBCPP_BITS_THREAD_FUTURE
 #define LIBCPP_BITS_THREAD_FUTURE
 
+#include <__bits/thread/shared_state.hpp>
+#include <__bits/thread/thread_pool.hpp>
+#include <__bits/trycatch.hpp>
+#include <cstdlib>
 #include <memory>
 #include <system_error>
 #include <type_traits>
@@ -49,10 +53,53 @@ namespace std
 
     enum class launch
     {
-        async,
-        deferred
+        async    = 0b01,
+        deferred = 0b10
     };
 
+    constexpr launch operator&(launch lhs, launch rhs)
+    {
+        return static_cast<launch>(
+            static_cast<int>(lhs) & static_cast<int>(rhs)
+        );
+    }
+
+    constexpr launch operator|(launch lhs, launch rhs)
+    {
+        return static_cast<launch>(
+            static_cast<int>(lhs) | static_cast<int>(rhs)
+        );
+    }
+
+    constexpr launch operator^(launch lhs, launch rhs)
+    {
+        return static_cast<launch>(
+            static_cast<int>(lhs) ^ static_cast<int>(rhs)
+        );
+    }
+
+    constexpr launch operator~(launch l)
+    {
+        return static_cast<launch>(
+            ~static_cast<int>(l) & 0b11
+        );
+    }
+
+    inline launch& operator&=(launch& lhs, launch rhs)
+    {
+        return lhs = lhs & rhs;
+    }
+
+    inline launch& operator|=(launch& lhs, launch rhs)
+    {
+        return lhs = lhs | rhs;
+    }
+
+    inline launch& operator^=(launch& lhs, launch rhs)
+    {
+        return lhs = lhs ^ rhs;
+    }
+
     enum class future_status
     {
         ready,
@@ -88,23 +135,357 @@ namespace std
             error_code code_;
     };
 
+    template<class R>
+    class future;
+
+    template<class R>
+    class shared_future;
+
+    namespace aux
+    {
+        template<class R>
+        using shared_state_ptr = shared_ptr<shared_state<R>>;
+
+        template<class R>
+        future<R> make_future(shared_state_ptr<R> state)
+        {
+            if (!state->acquire_retrieval())
+            {
+                throw future_error{make_error_code(future_errc::future_already_retrieved)};
+                return future<R>{};
+            }
+
+            return future<R>{move(state)};
+        }
+
+        /**
+         * Common functionality of promise<R>, promise<R&>
+         * and promise<void>, they differ only in set_value.
+         */
+        template<class R>
+        class promise_base
+        {
+            public:
+                promise_base()
+                    : state_{new shared_state<R>{}}
+                { /* DUMMY BODY */ }
+
+                template<class Alloc>
+                promise_base(allocator_arg_t, const Alloc&)
+                    : promise_base{}
+                { /* DUMMY BODY */ }
+
+                promise_base(promise_base&& other) noexcept
+                    : state_{move(other.state_)}
+                { /* DUMMY BODY */ }
+
+                promise_base(const promise_base&) = delete;
+
+                ~promise_base()
+                {
+                    abandon_();
+                }
+
+                promise_base& operator=(promise_base&& rhs) noexcept
+                {
+                    abandon_();
+                    state_ = move(rhs.state_);
+
+                    return *this;
+                }
+
+                promise_base& operator=(const promise_base&) = delete;
+
+                void swap(promise_base& other) noexcept
+                {
+                    std::swap(state_, other.state_);
+                }
+
+                future<R> get_future()
+                {
+                    if (!state_)
+                    {
+                        throw future_error{make_error_code(future_errc::no_state)};
+                        return future<R>{};
+                    }
+
+                    return make_future(state_);
+                }
+
+                void set_exception(exception_ptr ptr)
+                {
+                    acquire_satisfaction_();
+
+                    state_->set_exception(ptr);
+                }
+
+                /**
+                 * Note: We do not have thread exit hooks for
+                 *       fibrils, so the state becomes ready
+                 *       immediately.
+                 */
+                void set_exception_at_thread_exit(exception_ptr ptr)
+                {
+                    set_exception(ptr);
+                }
+
+            protected:
+                void acquire_satisfaction_()
+                {
+                    // Callers use the state, so do not return if throw does.
+                    if (!state_)
+                    {
+                        throw future_error{make_error_code(future_errc::no_state)};
+                        ::std::abort();
+                    }
+                    if (!state_->acquire_satisfaction())
+                    {
+                        throw future_error{make_error_code(future_errc::promise_already_satisfied)};
+                        ::std::abort();
+                    }
+                }
+
+                void abandon_()
+                {
+                    if (state_ && state_->acquire_satisfaction())
+                    {
+                        state_->set_exception(make_exception_ptr(
+                            future_error{make_error_code(future_errc::broken_promise)}
+                        ));
+                    }
+                }
+
+                shared_state_ptr<R> state_;
+        };
+
+        /**
+         * Common functionality of futures and shared futures,
+         * they differ in the way they pass the value.
+         */
+        template<class R>
+        class future_base
+        {
+            public:
+                future_base() noexcept
+                    : state_{}
+                { /* DUMMY BODY */ }
+
+                future_base(const future_base& other)
+                    : state_{other.state_}
+                {
+                    if (state_)
+                        state_->attach_future();
+                }
+
+                future_base(future_base&& other) noexcept
+                    : state_{move(other.state_)}
+                { /* DUMMY BODY */ }
+
+                future_base(shared_state_ptr<R>&& state) noexcept
+                    : state_{move(state)}
+                {
+                    if (state_)
+                        state_->attach_future();
+                }
+
+                ~future_base()
+                {
+                    release_();
+                }
+
+                future_base& operator=(const future_base& rhs)
+                {
+                    if (this != &rhs)
+                    {
+                        release_();
+                        state_ = rhs.state_;
+
+                        if (state_)
+                            state_->attach_future();
+                    }
+
+                    return *this;
+                }
+
+                future_base& operator=(future_base&& rhs) noexcept
+                {
+                    if (this != &rhs)
+                    {
+                        release_();
+                        state_ = move(rhs.state_);
+                    }
+
+                    return *this;
+                }
+
+                bool valid() const noexcept
+                {
+                    return static_cast<bool>(state_);
+                }
+
+                void wait() const
+                {
+                    check_state_();
+
+                    state_->wait();
+                }
+
+                template<class Rep, class Period>
+                future_status wait_for(const chrono::duration<Rep, Period>& rel_time) const
+                {
+                    check_state_();
+
+                    if (state_->is_deferred())
+                        return future_status::deferred;
+                    else if (state_->wait_for(rel_time))
+                        return future_status::ready;
+                    else
+                        return future_status::timeout;
+                }
+
+                template<class Clock, class Duration>
+                future_status wait_until(const chrono::time_point<Clock, Duration>& abs_time) const
+                {
+                    return wait_for(abs_time - Clock::now());
+                }
+
+            protected:
+                void check_state_() const
+                {
+                    if (!state_)
+                    {
+                        throw future_error{make_error_code(future_errc::no_state)};
+                        ::std::abort();
+                    }
+                }
+
+                /**
+                 * Waits for the state to become ready and
+                 * returns a reference to the stored value.
+                 */
+                decltype(auto) wait_for_value_() const
+                {
+                    wait();
+
+                    if (state_->has_exception())
+                        rethrow_exception(state_->get_exception());
+
+                    return state_->get();
+                }
+
+                void release_()
+                {
+                    if (!state_)
+                        return;
+
+                    if (state_->detach_future() && state_->blocks_on_release())
+                        state_->wait();
+
+                    state_.reset();
+                }
+
+                shared_state_ptr<R> state_;
+        };
+    }
+
     /**
-     * 30.6.4, shared state:
+     * 30.6.5, class template promise:
      */
 
     template<class R>
-    class promise
+    class promise: public aux::promise_base<R>
     {
+        public:
+            using aux::promise_base<R>::promise_base;
+
+            promise() = default;
+            promise(promise&&) noexcept = default;
+            promise& operator=(promise&&) noexcept = default;
+
+            void swap(promise& other) noexcept
+            {
+                aux::promise_base<R>::swap(other);
+            }
+
+            void set_value(const R& value)
+            {
+                this->acquire_satisfaction_();
+
+                this->state_->set_value(value);
+            }
+
+            void set_value(R&& value)
+            {
+                this->acquire_satisfaction_();
+
+                this->state_->set_value(move(value));
+            }
+
+            void set_value_at_thread_exit(const R& value)
+            {
+                set_value(value);
+            }
+
+            void set_value_at_thread_exit(R&& value)
+            {
+                set_value(move(value));
+            }
     };
 
     template<class R>
-    class promise<R&>
+    class promise<R&>: public aux::promise_base<R&>
     {
+        public:
+            using aux::promise_base<R&>::promise_base;
+
+            promise() = default;
+            promise(promise&&) noexcept = default;
+            promise& operator=(promise&&) noexcept = default;
+
+            void swap(promise& other) noexcept
+            {
+                aux::promise_base<R&>::swap(other);
+            }
+
+            void set_value(R& value)
+            {
+                this->acquire_satisfaction_();
+
+                this->state_->set_value(value);
+            }
+
+            void set_value_at_thread_exit(R& value)
+            {
+                set_value(value);
+            }
     };
 
     template<>
-    class promise<void>
+    class promise<void>: public aux::promise_base<void>
     {
+        public:
+            using aux::promise_base<void>::promise_base;
+
+            promise() = default;
+            promise(promise&&) noexcept = default;
+            promise& operator=(promise&&) noexcept = default;
+
+            void swap(promise& other) noexcept
+            {
+                aux::promise_base<void>::swap(other);
+            }
+
+            void set_value()
+            {
+                acquire_satisfaction_();
+
+                state_->set_value();
+            }
+
+            void set_value_at_thread_exit()
+            {
+                set_value();
+            }
     };
 
     template<class R>
@@ -117,42 +498,338 @@ namespace std
     struct uses_allocator<promise<R>, Alloc>: true_type
     { /* DUMMY BODY */ };
 
+    /**
+     * 30.6.6, class template future:
+     */
+
     template<class R>
-    class future
+    class future: public aux::future_base<R>
     {
+        public:
+            future() noexcept = default;
+            future(future&&) noexcept = default;
+            future(const future&) = delete;
+
+            future& operator=(future&&) noexcept = default;
+            future& operator=(const future&) = delete;
+
+            shared_future<R> share()
+            {
+                return shared_future<R>{move(*this)};
+            }
+
+            R get()
+            {
+                R res{move(this->wait_for_value_())};
+                this->release_();
+
+                return res;
+            }
+
+        private:
+            future(aux::shared_state_ptr<R>&& state)
+                : aux::future_base<R>{move(state)}
+            { /* DUMMY BODY */ }
+
+            friend future<R> aux::make_future<R>(aux::shared_state_ptr<R>);
     };
 
     template<class R>
-    class future<R&>
+    class future<R&>: public aux::future_base<R&>
     {
+        public:
+            future() noexcept = default;
+            future(future&&) noexcept = default;
+            future(const future&) = delete;
+
+            future& operator=(future&&) noexcept = default;
+            future& operator=(const future&) = delete;
+
+            shared_future<R&> share()
+            {
+                return shared_future<R&>{move(*this)};
+            }
+
+            R& get()
+            {
+                auto& res = this->wait_for_value_();
+                this->release_();
+
+                return res;
+            }
+
+        private:
+            future(aux::shared_state_ptr<R&>&& state)
+                : aux::future_base<R&>{move(state)}
+            { /* DUMMY BODY */ }
+
+            friend future<R&> aux::make_future<R&>(aux::shared_state_ptr<R&>);
     };
 
     template<>
-    class future<void>
+    class future<void>: public aux::future_base<void>
     {
+        public:
+            future() noexcept = default;
+            future(future&&) noexcept = default;
+            future(const future&) = delete;
+
+            future& operator=(future&&) noexcept = default;
+            future& operator=(const future&) = delete;
+
+            shared_future<void> share();
+
+            void get()
+            {
+                wait_for_value_();
+                release_();
+            }
+
+        private:
+            future(aux::shared_state_ptr<void>&& state)
+                : aux::future_base<void>{move(state)}
+            { /* DUMMY BODY */ }
+
+            friend future<void> aux::make_future<void>(aux::shared_state_ptr<void>);
     };
 
+    /**
+     * 30.6.7, class template shared_future:
+     */
+
     template<class R>
-    class shared_future
+    class shared_future: public aux::future_base<R>
     {
+        public:
+            shared_future() noexcept = default;
+            shared_future(const shared_future&) = default;
+            shared_future(shared_future&&) noexcept = default;
+
+            shared_future(future<R>&& other) noexcept
+                : aux::future_base<R>{move(other)}
+            { /* DUMMY BODY */ }
+
+            shared_future& operator=(const shared_future&) = default;
+            shared_future& operator=(shared_future&&) noexcept = default;
+
+            const R& get() const
+            {
+                return this->wait_for_value_();
+            }
     };
 
     template<class R>
-    class shared_future<R&>
+    class shared_future<R&>: public aux::future_base<R&>
     {
+        public:
+            shared_future() noexcept = default;
+            shared_future(const shared_future&) = default;
+            shared_future(shared_future&&) noexcept = default;
+
+            shared_future(future<R&>&& other) noexcept
+                : aux::future_base<R&>{move(other)}
+            { /* DUMMY BODY */ }
+
+            shared_future& operator=(const shared_future&) = default;
+            shared_future& operator=(shared_future&&) noexcept = default;
+
+            R& get() const
+            {
+                return this->wait_for_value_();
+            }
     };
 
     template<>
-    class shared_future<void>
+    class shared_future<void>: public aux::future_base<void>
     {
+        public:
+            shared_future() noexcept = default;
+            shared_future(const shared_future&) = default;
+            shared_future(shared_future&&) noexcept = default;
+
+            shared_future(future<void>&& other) noexcept
+                : aux::future_base<void>{move(other)}
+            { /* DUMMY BODY */ }
+
+            shared_future& operator=(const shared_future&) = default;
+            shared_future& operator=(shared_future&&) noexcept = default;
+
+            void get() const
+            {
+                wait_for_value_();
+            }
     };
 
+    inline shared_future<void> future<void>::share()
+    {
+        return shared_future<void>{move(*this)};
+    }
+
+    /**
+     * 30.6.9, class template packaged_task:
+     */
+
+    namespace aux
+    {
+        /**
+         * Type erased callable, unlike std::function this
+         * allows move only callables.
+         */
+        template<class R, class... Args>
+        class task_callable_base
+        {
+            public:
+                virtual R operator()(Args&&...) = 0;
+
+                virtual ~task_callable_base() = default;
+        };
+
+        template<class F, class R, class... Args>
+        class task_callable: public task_callable_base<R, Args...>
+        {
+            public:
+                template<class G>
+                task_callable(G&& func)
+                    : func_{forward<G>(func)}
+                { /* DUMMY BODY */ }
+
+                R operator()(Args&&... args) override
+                {
+                    return INVOKE(func_, forward<Args>(args)...);
+                }
+
+            private:
+                F func_;
+        };
+    }
+
     template<class>
     class packaged_task; // undefined
 
     template<class R, class... Args>
     class packaged_task<R(Args...)>
     {
+        public:
+            packaged_task() noexcept
+                : func_{}, state_{}
+            { /* DUMMY BODY */ }
+
+            template<
+                class F, class = enable_if_t<
+                    !is_same_v<decay_t<F>, packaged_task>
+                >
+            >
+            explicit packaged_task(F&& f)
+                : func_{new aux::task_callable<decay_t<F>, R, Args...>{forward<F>(f)}},
+                  state_{new aux::shared_state<R>{}}
+            { /* DUMMY BODY */ }
+
+            template<class F, class Alloc>
+            explicit packaged_task(allocator_arg_t, const Alloc&, F&& f)
+                : packaged_task{forward<F>(f)}
+            { /* DUMMY BODY */ }
+
+            ~packaged_task()
+            {
+                abandon_();
+            }
+
+            packaged_task(const packaged_task&) = delete;
+            packaged_task& operator=(const packaged_task&) = delete;
+
+            packaged_task(packaged_task&& other) noexcept
+                : func_{move(other.func_)}, state_{move(other.state_)}
+            { /* DUMMY BODY */ }
+
+            packaged_task& operator=(packaged_task&& rhs) noexcept
+            {
+                abandon_();
+
+                func_ = move(rhs.func_);
+                state_ = move(rhs.state_);
+
+                return *this;
+            }
+
+            void swap(packaged_task& other) noexcept
+            {
+                std::swap(func_, other.func_);
+                std::swap(state_, other.state_);
+            }
+
+            bool valid() const noexcept
+            {
+                return static_cast<bool>(state_);
+            }
+
+            future<R> get_future()
+            {
+                if (!state_)
+                {
+                    throw future_error{make_error_code(future_errc::no_state)};
+                    return future<R>{};
+                }
+
+                return aux::make_future(state_);
+            }
+
+            void operator()(Args... args)
+            {
+                if (!state_)
+                {
+                    throw future_error{make_error_code(future_errc::no_state)};
+                    return;
+                }
+                if (!state_->acquire_satisfaction())
+                {
+                    throw future_error{make_error_code(future_errc::promise_already_satisfied)};
+                    return;
+                }
+
+                if constexpr (is_void_v<R>)
+                {
+                    (*func_)(forward<Args>(args)...);
+                    state_->set_value();
+                }
+                else
+                    state_->set_value((*func_)(forward<Args>(args)...));
+            }
+
+            /**
+             * Note: We do not have thread exit hooks for
+             *       fibrils, so the state becomes ready
+             *       immediately.
+             */
+            void make_ready_at_thread_exit(Args... args)
+            {
+                (*this)(forward<Args>(args)...);
+            }
+
+            void reset()
+            {
+                if (!state_)
+                {
+                    throw future_error{make_error_code(future_errc::no_state)};
+                    return;
+                }
+
+                abandon_();
+                state_ = aux::shared_state_ptr<R>{new aux::shared_state<R>{}};
+            }
+
+        private:
+            void abandon_()
+            {
+                if (state_ && state_->acquire_satisfaction())
+                {
+                    state_->set_exception(make_exception_ptr(
+                        future_error{make_error_code(future_errc::broken_promise)}
+                    ));
+                }
+            }
+
+            unique_ptr<aux::task_callable_base<R, Args...>> func_;
+            aux::shared_state_ptr<R> state_;
     };
 
     template<class R, class... Args>
@@ -165,18 +842,66 @@ namespace std
     struct uses_allocator<packaged_task<R>, Alloc>: true_type
     { /* DUMMY BODY */ };
 
+    /**
+     * 30.6.8, function template async:
+     */
+
     template<class F, class... Args>
     future<result_of_t<decay_t<F>(decay_t<Args>...)>>
-    async(F&& f, Args&&... args)
+    async(launch policy, F&& f, Args&&... args)
     {
-        // TODO: implement
+        using result_t = result_of_t<decay_t<F>(decay_t<Args>...)>;
+        using state_t = aux::shared_state<result_t>;
+
+        if ((policy & launch::async) == launch::async)
+        {
+            aux::shared_state_ptr<result_t> state{new state_t{}};
+            state->block_on_release();
+
+            auto task = new aux::async_task<result_t, decay_t<F>, decay_t<Args>...>{
+                state, forward<F>(f), forward<Args>(args)...
+            };
+
+            /**
+             * Note: If no worker is available, we run the function
+             *       right away, which is a valid (though not
+             *       concurrent) execution of it.
+             */
+            if (!aux::thread_pool::instance().submit(task))
+            {
+                task->run();
+                delete task;
+            }
+
+            return aux::make_future(move(state));
+        }
+
+        using deferred_t = aux::deferred_shared_state<
+            result_t, decay_t<F>, decay_t<Args>...
+        >;
+
+        /**
+         * Note: Going through a base pointer makes shared_ptr
+         *       pick its constructor from a pointer instead
+         *       of forwarding the derived pointer to the
+         *       payload as a constructor argument.
+         */
+        state_t* state = new deferred_t{forward<F>(f), forward<Args>(args)...};
+
+        return aux::make_future(aux::shared_state_ptr<result_t>{state});
     }
 
-    template<class F, class... Args>
+    template<
+        class F, class... Args,
+        class = enable_if_t<!is_same_v<decay_t<F>, launch>>
+    >
     future<result_of_t<decay_t<F>(decay_t<Args>...)>>
-    async(launch, F&& f, Args&&... args)
+    async(F&& f, Args&&... args)
     {
-        // TODO: implement
+        return async(
+            launch::async | launch::deferred,
+            forward<F>(f), forward<Args>(args)...
+        );
     }
 }
 
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_THREAD_SHARED_STATE
+#define LIBCPP_BITS_THREAD_SHARED_STATE
+
+#include <__bits/functional/invoke.hpp>
+#include <__bits/thread/thread_pool.hpp>
+#include <__bits/thread/threading.hpp>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * 30.6.4, shared state:
+     * The state is shared between the providers (promise,
+     * packaged_task, async) and the future(s) through a
+     * shared_ptr. Readiness is published through an atomic
+     * flag, so waiting on a ready state never touches the
+     * mutex and setting a state nobody waits on never
+     * touches the condvar.
+     */
+    class shared_state_base
+    {
+        public:
+            shared_state_base()
+                : mtx_{}, cv_{}, ready_{false}, satisfied_{false},
+                  retrieved_{false}, futures_{}, waiters_{}, exception_{},
+                  has_exception_{false}, blocks_on_release_{false}
+            {
+                threading::mutex::init(mtx_);
+                threading::condvar::init(cv_);
+            }
+
+            virtual ~shared_state_base() = default;
+
+            shared_state_base(const shared_state_base&) = delete;
+            shared_state_base& operator=(const shared_state_base&) = delete;
+
+            bool is_ready() const noexcept
+            {
+                return ready_.load(memory_order_acquire);
+            }
+
+            virtual bool is_deferred() const noexcept
+            {
+                return false;
+            }
+
+            virtual void wait()
+            {
+                if (is_ready())
+                    return;
+
+                threading::mutex::lock(mtx_);
+                ++waiters_;
+                while (!ready_.load(memory_order_relaxed))
+                    threading::condvar::wait(cv_, mtx_);
+                --waiters_;
+                threading::mutex::unlock(mtx_);
+            }
+
+            /**
+             * Returns true if the state is ready, deferred
+             * states have to be checked by the caller.
+             */
+            template<class Rep, class Period>
+            bool wait_for(const chrono::duration<Rep, Period>& rel_time)
+            {
+                if (is_ready())
+                    return true;
+
+                return wait_until(chrono::steady_clock::now() + rel_time);
+            }
+
+            /**
+             * Note: The condvar can wake us up spuriously, so
+             *       we keep waiting for the rest of the time.
+             */
+            template<class Clock, class Duration>
+            bool wait_until(const chrono::time_point<Clock, Duration>& abs_time)
+            {
+                if (is_ready())
+                    return true;
+
+                threading::mutex::lock(mtx_);
+                ++waiters_;
+                while (!ready_.load(memory_order_relaxed))
+                {
+                    // Zero would mean no timeout at all.
+                    auto left = threading::time::convert(abs_time - Clock::now());
+                    if (left <= 0)
+                        break;
+
+                    threading::condvar::wait_for(cv_, mtx_, left);
+                }
+                --waiters_;
+                threading::mutex::unlock(mtx_);
+
+                return is_ready();
+            }
+
+            /**
+             * Reserves the right to satisfy the state, returns
+             * false if it has already been satisfied.
+             */
+            bool acquire_satisfaction() noexcept
+            {
+                return !satisfied_.exchange(true, memory_order_acq_rel);
+            }
+
+            /**
+             * Returns false if a future has already
+             * been retrieved from this state.
+             */
+            bool acquire_retrieval() noexcept
+            {
+                return !retrieved_.exchange(true, memory_order_acq_rel);
+            }
+
+            void set_exception(exception_ptr ptr)
+            {
+                exception_ = ptr;
+                has_exception_ = true;
+
+                mark_ready();
+            }
+
+            bool has_exception() const noexcept
+            {
+                return has_exception_;
+            }
+
+            exception_ptr get_exception() const noexcept
+            {
+                return exception_;
+            }
+
+            /**
+             * The destructor of the last future referring
+             * to the state of an async call blocks until
+             * the call has finished.
+             */
+            void block_on_release() noexcept
+            {
+                blocks_on_release_ = true;
+            }
+
+            bool blocks_on_release() const noexcept
+            {
+                return blocks_on_release_;
+            }
+
+            void attach_future() noexcept
+            {
+                futures_.fetch_add(1, memory_order_relaxed);
+            }
+
+            /**
+             * Returns true if the last future
+             * referring to this state detached.
+             */
+            bool detach_future() noexcept
+            {
+                return futures_.fetch_sub(1, memory_order_acq_rel) == 1;
+            }
+
+        protected:
+            void mark_ready()
+            {
+                threading::mutex::lock(mtx_);
+                ready_.store(true, memory_order_release);
+                if (waiters_ > 0)
+                    threading::condvar::broadcast(cv_);
+                threading::mutex::unlock(mtx_);
+            }
+
+            mutex_t mtx_;
+            condvar_t cv_;
+
+            atomic<bool> ready_;
+            atomic<bool> satisfied_;
+            atomic<bool> retrieved_;
+            atomic<size_t> futures_;
+            size_t waiters_;
+
+            exception_ptr exception_;
+            bool has_exception_;
+            bool blocks_on_release_;
+    };
+
+    template<class R>
+    class shared_state: public shared_state_base
+    {
+        public:
+            shared_state()
+                : shared_state_base{}, has_value_{false}
+            { /* DUMMY BODY */ }
+
+            ~shared_state() override
+            {
+                if (has_value_)
+                    value_()->~R();
+            }
+
+            template<class... Args>
+            void set_value(Args&&... args)
+            {
+                ::new(static_cast<void*>(storage_)) R(forward<Args>(args)...);
+                has_value_ = true;
+
+                mark_ready();
+            }
+
+            R& get()
+            {
+                return *value_();
+            }
+
+        private:
+            R* value_()
+            {
+                return reinterpret_cast<R*>(storage_);
+            }
+
+            alignas(R) unsigned char storage_[sizeof(R)];
+            bool has_value_;
+    };
+
+    template<class R>
+    class shared_state<R&>: public shared_state_base
+    {
+        public:
+            shared_state()
+                : shared_state_base{}, value_{nullptr}
+            { /* DUMMY BODY */ }
+
+            void set_value(R& value)
+            {
+                value_ = &value;
+
+                mark_ready();
+            }
+
+            R& get()
+            {
+                return *value_;
+            }
+
+        private:
+            R* value_;
+    };
+
+    template<>
+    class shared_state<void>: public shared_state_base
+    {
+        public:
+            void set_value()
+            {
+                mark_ready();
+            }
+
+            void get()
+            { /* DUMMY BODY */ }
+    };
+
+    /**
+     * Note: Our tuple<> cannot be instantiated,
+     *       so we avoid it for calls without arguments.
+     */
+    struct no_args
+    { /* DUMMY BODY */ };
+
+    template<class... Args>
+    using stored_args_t = conditional_t<
+        sizeof...(Args) == 0, no_args, tuple<Args...>
+    >;
+
+    /**
+     * Calls the stored function with the stored arguments
+     * and puts the result into the given state.
+     */
+    template<class R, class F, class Tuple, size_t... Is>
+    void invoke_into_state(shared_state<R>& state, F& func,
+                           Tuple& args, index_sequence<Is...>)
+    {
+        if constexpr (is_void_v<R>)
+        {
+            INVOKE(move(func), move(get<Is>(args))...);
+            state.set_value();
+        }
+        else
+            state.set_value(INVOKE(move(func), move(get<Is>(args))...));
+    }
+
+    /**
+     * State of std::async(launch::deferred, ...), the function
+     * is called by the first waiting thread.
+     */
+    template<class R, class F, class... Args>
+    class deferred_shared_state: public shared_state<R>
+    {
+        public:
+            template<class G, class... As>
+            deferred_shared_state(G&& func, As&&... args)
+                : shared_state<R>{}, started_{false},
+                  func_{forward<G>(func)}, args_{forward<As>(args)...}
+            { /* DUMMY BODY */ }
+
+            bool is_deferred() const noexcept override
+            {
+                return true;
+            }
+
+            void wait() override
+            {
+                threading::mutex::lock(this->mtx_);
+                bool run = !started_;
+                started_ = true;
+                threading::mutex::unlock(this->mtx_);
+
+                if (run)
+                {
+                    invoke_into_state(
+                        *this, func_, args_,
+                        make_index_sequence<sizeof...(Args)>{}
+                    );
+                }
+                else
+                    shared_state<R>::wait();
+            }
+
+        private:
+            bool started_;
+            F func_;
+            stored_args_t<Args...> args_;
+    };
+
+    /**
+     * Pool task of std::async(launch::async, ...), it keeps
+     * the state alive until the function has finished.
+     */
+    template<class R, class F, class... Args>
+    class async_task: public pool_task
+    {
+        public:
+            template<class G, class... As>
+            async_task(shared_ptr<shared_state<R>> state, G&& func, As&&... args)
+                : pool_task{}, state_{move(state)},
+                  func_{forward<G>(func)}, args_{forward<As>(args)...}
+            { /* DUMMY BODY */ }
+
+            void run() override
+            {
+                invoke_into_state(
+                    *state_, func_, args_,
+                    make_index_sequence<sizeof...(Args)>{}
+                );
+            }
+
+        private:
+            shared_ptr<shared_state<R>> state_;
+            F func_;
+            stored_args_t<Args...> args_;
+    };
+}
+
+#endif
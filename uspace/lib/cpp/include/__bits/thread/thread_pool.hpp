@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_THREAD_THREAD_POOL
+#define LIBCPP_BITS_THREAD_THREAD_POOL
+
+#include <__bits/thread/threading.hpp>
+#include <cstddef>
+
+namespace std::aux
+{
+    /**
+     * Unit of work that can be handed to the thread pool,
+     * the pool deletes the task once it has been run.
+     */
+    class pool_task
+    {
+        public:
+            virtual void run() = 0;
+
+            virtual ~pool_task() = default;
+
+        private:
+            pool_task* next_{nullptr};
+
+            friend class thread_pool;
+    };
+
+    /**
+     * Process wide pool of worker fibrils used by std::async
+     * (and anything else that needs to run work concurrently).
+     * The first use of the pool enables multithreaded fibril
+     * scheduling, so the workers are spread over multiple
+     * kernel threads.
+     *
+     * Because a task is supposed to behave as if it was run
+     * in a new thread, it may block on the results of tasks
+     * submitted after it. To avoid deadlocks, we therefore
+     * never queue a task without a worker to run it. If all
+     * workers are busy, a new one is created. Once the work
+     * dries up, workers above max_idle_workers exit.
+     */
+    class thread_pool
+    {
+        public:
+            static thread_pool& instance();
+
+            /**
+             * Returns false if the task could not be scheduled
+             * (no free worker and a new one could not be created),
+             * in which case the caller keeps ownership of the task.
+             */
+            bool submit(pool_task* task);
+
+            size_t workers() const;
+
+            /**
+             * Number of kernel threads running fibrils that can
+             * be expected to run in parallel, i.e. how many pieces
+             * data parallel work should be split into.
+             */
+            size_t concurrency() const;
+
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator=(const thread_pool&) = delete;
+
+        private:
+            thread_pool();
+
+            static int worker_main(void*);
+
+            void worker_loop_();
+
+            static constexpr size_t max_idle_workers{8};
+
+            // Runners used by fibril_enable_multithreaded.
+            static constexpr size_t default_runners{4};
+
+            mutable mutex_t mtx_;
+            condvar_t cv_;
+
+            pool_task* head_;
+            pool_task* tail_;
+
+            /**
+             * Invariant: idle_ >= queued_, i.e. every queued task
+             * has a worker that is guaranteed to pick it up.
+             */
+            size_t queued_;
+            size_t idle_;
+            size_t workers_;
+
+            size_t concurrency_;
+    };
+
+    /**
+     * Fork-join execution of data parallel loops (used by the
+     * parallel algorithms). The loop is split into chunks, which
+     * are initially distributed evenly among the participants:
+     * the caller and helper tasks in the thread pool. Once a
+     * participant runs out of its chunks, it steals half of the
+     * chunks left to the participant with the most remaining
+     * work, so uneven chunks do not leave CPUs idle.
+     */
+    class parallel_job
+    {
+        public:
+            using body_type = void (*)(void*, size_t);
+
+            /**
+             * Calls body(arg, i) for every i in [0, chunks)
+             * and returns once all calls have finished.
+             */
+            static void run(size_t chunks, body_type body, void* arg);
+
+            // Upper bounds on how a loop is split.
+            static constexpr size_t max_chunks{1024};
+            static constexpr size_t max_participants{64};
+
+            /**
+             * Grain size heuristic: loops over less than twice the
+             * minimal grain run serially, otherwise we aim for a few
+             * chunks per participant so that stealing can balance
+             * the load, but keep them at least min_grain long.
+             */
+            static size_t chunks_for(size_t count, size_t min_grain = default_min_grain);
+
+        private:
+            static constexpr size_t default_min_grain{512};
+            static constexpr size_t chunks_per_participant{8};
+    };
+
+    /**
+     * Split of count iterations into chunks that differ
+     * in length by at most one.
+     */
+    struct parallel_partition
+    {
+        parallel_partition(size_t count, size_t chunks)
+            : chunks{chunks}, size{count / chunks}, rest{count % chunks}
+        { /* DUMMY BODY */ }
+
+        size_t begin(size_t i) const
+        {
+            return i * size + (i < rest ? i : rest);
+        }
+
+        size_t end(size_t i) const
+        {
+            return begin(i) + size + (i < rest ? 1 : 0);
+        }
+
+        size_t chunks;
+        size_t size;
+        size_t rest;
+    };
+
+    /**
+     * Calls f(i, begin, end) for every chunk of the
+     * partition, in parallel if there is more than one.
+     */
+    template<class F>
+    void parallel_for_chunks(const parallel_partition& part, F& f)
+    {
+        if (part.chunks == 1)
+        {
+            f(size_t{}, part.begin(0), part.end(0));
+
+            return;
+        }
+
+        struct context
+        {
+            const parallel_partition& part;
+            F& f;
+        } ctx{part, f};
+
+        parallel_job::run(part.chunks, [](void* arg, size_t i) {
+            auto& ctx = *static_cast<context*>(arg);
+
+            ctx.f(i, ctx.part.begin(i), ctx.part.end(i));
+        }, &ctx);
+    }
+
+    /**
+     * Splits count iterations into chunks and calls
+     * f(begin, end) for each of them.
+     */
+    template<class F>
+    void parallel_for(size_t count, F f)
+    {
+        if (count == 0)
+            return;
+
+        parallel_partition part{count, parallel_job::chunks_for(count)};
+        auto body = [&f](size_t, size_t begin, size_t end) {
+            f(begin, end);
+        };
+
+        parallel_for_chunks(part, body);
+    }
+}
+
+#endif
@@ -107,6 +107,9 @@ namespace std
             char16_t, char32_t, wchar_t>
     { /* DUMMY BODY */ };
 
+    template<class T>
+    inline constexpr bool is_integral_v = is_integral<T>::value;
+
     template<class T>
     struct is_floating_point
         : aux::is_one_of<remove_cv_t<T>, float, double, long double>
@@ -103,6 +103,31 @@ namespace std
         return old_val;
     }
 
+    /**
+     * 20.2.4, forward/move helpers:
+     * Note: Our is_nothrow_move_constructible does
+     *       not work for this, so we test the move
+     *       constructor with noexcept directly.
+     */
+
+    namespace aux
+    {
+        template<class T>
+        struct move_if_noexcept_result
+            : conditional<
+                !noexcept(T(declval<T&&>())) && is_constructible_v<T, const T&>,
+                const T&, T&&
+            >
+        { /* DUMMY BODY */ };
+    }
+
+    template<class T>
+    constexpr typename aux::move_if_noexcept_result<T>::type
+    move_if_noexcept(T& x) noexcept
+    {
+        return move(x);
+    }
+
     /**
      * 20.5.2, class template integer_sequence:
      */
@@ -29,8 +29,10 @@
 #include <__bits/test/tests.hpp>
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace std::test
 {
@@ -41,6 +43,8 @@ namespace std::test
 
         test_non_modifying();
         test_mutating();
+        test_sorting();
+        test_sorting_large();
 
         return end();
     }
@@ -255,6 +259,18 @@ namespace std::test
         );
         test_eq("move pt3", res4, data7.end());
 
+        auto check_mb = {1, 1, 2, 3, 4};
+        std::array<int, 5> data_mb{1, 2, 3, 4, 5};
+
+        auto res_mb = std::move_backward(
+            data_mb.begin(), data_mb.begin() + 4, data_mb.end()
+        );
+        test_eq(
+            "move_backward pt1", check_mb.begin(), check_mb.end(),
+            data_mb.begin(), data_mb.end()
+        );
+        test_eq("move_backward pt2", res_mb, data_mb.begin() + 1);
+
         auto check5 = {1, 2, 3, 4};
         auto check6 = {10, 20, 30, 40};
         std::array<int, 4> data8{1, 2, 3, 4};
@@ -293,4 +309,146 @@ namespace std::test
         );
         test_eq("transform pt2", res6, data10.end());
     }
+
+    void algorithm_test::test_sorting()
+    {
+        auto check1 = {1, 2, 2, 3, 5, 7, 8, 9};
+        std::array<int, 8> data1{8, 2, 7, 1, 9, 2, 5, 3};
+
+        std::sort(data1.begin(), data1.end());
+        test_eq(
+            "sort pt1", check1.begin(), check1.end(),
+            data1.begin(), data1.end()
+        );
+
+        auto check2 = {9, 8, 7, 5, 3, 2, 2, 1};
+        std::sort(data1.begin(), data1.end(), std::greater<int>{});
+        test_eq(
+            "sort pt2", check2.begin(), check2.end(),
+            data1.begin(), data1.end()
+        );
+
+        std::vector<int> data2(1000);
+        for (std::size_t i = 0; i < data2.size(); ++i)
+            data2[i] = (i * 7919) % 1009;
+        std::sort(data2.begin(), data2.end());
+        test("sort pt3", std::is_sorted(data2.begin(), data2.end()));
+
+        std::vector<int> data3(1000, 42);
+        std::sort(data3.begin(), data3.end());
+        test("sort pt4", std::is_sorted(data3.begin(), data3.end()));
+
+        std::vector<std::pair<int, int>> data4{};
+        for (int i = 0; i < 200; ++i)
+            data4.emplace_back((i * 37) % 5, i);
+        std::stable_sort(
+            data4.begin(), data4.end(),
+            [](const auto& lhs, const auto& rhs){
+                return lhs.first < rhs.first;
+            }
+        );
+
+        bool stable{true};
+        for (std::size_t i = 1; i < data4.size(); ++i)
+        {
+            if (data4[i - 1].first > data4[i].first ||
+                (data4[i - 1].first == data4[i].first &&
+                 data4[i - 1].second > data4[i].second))
+                stable = false;
+        }
+        test("stable_sort", stable);
+
+        auto check3 = {1, 2, 3, 4};
+        std::array<int, 9> data5{9, 4, 8, 1, 7, 3, 6, 2, 5};
+        std::partial_sort(data5.begin(), data5.begin() + 4, data5.end());
+        test_eq(
+            "partial_sort", check3.begin(), check3.end(),
+            data5.begin(), data5.begin() + 4
+        );
+
+        std::array<int, 9> data6{9, 4, 8, 1, 7, 3, 6, 2, 5};
+        std::array<int, 4> data7{};
+        auto res1 = std::partial_sort_copy(
+            data6.begin(), data6.end(),
+            data7.begin(), data7.end()
+        );
+        test_eq(
+            "partial_sort_copy pt1", check3.begin(), check3.end(),
+            data7.begin(), data7.end()
+        );
+        test_eq("partial_sort_copy pt2", res1, data7.end());
+
+        std::vector<int> data8(1000);
+        for (std::size_t i = 0; i < data8.size(); ++i)
+            data8[i] = (i * 7919) % 1000;
+        auto nth = data8.begin() + 500;
+        std::nth_element(data8.begin(), nth, data8.end());
+        test_eq("nth_element pt1", *nth, 500);
+
+        bool partitioned{true};
+        for (auto it = data8.begin(); it != data8.end(); ++it)
+        {
+            if ((it < nth && *it > *nth) || (it > nth && *it < *nth))
+                partitioned = false;
+        }
+        test("nth_element pt2", partitioned);
+    }
+
+    void algorithm_test::test_sorting_large()
+    {
+        /**
+         * Makes sure the algorithms behave on large inputs
+         * with common input patterns.
+         */
+        constexpr std::size_t count{100000};
+
+        std::vector<unsigned int> input(count);
+        std::vector<unsigned int> data(count);
+        unsigned int seed{1};
+
+        bool sorted{true};
+        bool stable_sorted{true};
+        bool heap_sorted{true};
+        for (std::size_t pattern = 0; pattern < 5; ++pattern)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                seed = seed * 1103515245 + 12345;
+                switch (pattern)
+                {
+                    case 0: // Random.
+                        input[i] = seed >> 8;
+                        break;
+                    case 1: // Sorted.
+                        input[i] = i;
+                        break;
+                    case 2: // Reversed.
+                        input[i] = count - i;
+                        break;
+                    case 3: // Organ pipe.
+                        input[i] = (i < count / 2) ? i : count - i;
+                        break;
+                    default: // Few unique.
+                        input[i] = (seed >> 8) % 8;
+                }
+            }
+
+            data = input;
+            std::sort(data.begin(), data.end());
+            sorted = sorted && std::is_sorted(data.begin(), data.end());
+
+            data = input;
+            std::stable_sort(data.begin(), data.end());
+            stable_sorted = stable_sorted && std::is_sorted(data.begin(), data.end());
+
+            data = input;
+            std::make_heap(data.begin(), data.end());
+            std::sort_heap(data.begin(), data.end());
+            heap_sorted = heap_sorted && std::is_sorted(data.begin(), data.end());
+        }
+
+        test("sort large", sorted);
+        test("stable_sort large", stable_sorted);
+        test("sort_heap large", heap_sorted);
+    }
 }
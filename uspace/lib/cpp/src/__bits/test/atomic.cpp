@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/mock.hpp>
+#include <__bits/test/tests.hpp>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace std::test
+{
+    bool atomic_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_integral();
+        test_pointer();
+        test_flag();
+        test_shared_ptr();
+
+        return end();
+    }
+
+    const char* atomic_test::name()
+    {
+        return "atomic";
+    }
+
+    void atomic_test::test_integral()
+    {
+        std::atomic<int> a{5};
+        test_eq("load", a.load(), 5);
+
+        a = 7;
+        test_eq("store via operator=", a.load(memory_order_acquire), 7);
+        test_eq("postfix increment", a++, 7);
+        test_eq("prefix increment", ++a, 9);
+        test_eq("fetch_sub", a.fetch_sub(2, memory_order_relaxed), 9);
+        test_eq("operator-=", (a -= 1), 6);
+        test_eq("operator|=", (a |= 1), 7);
+        test_eq("operator&=", (a &= 3), 3);
+        test_eq("operator^=", (a ^= 1), 2);
+        test_eq("exchange", a.exchange(10), 2);
+
+        int expected{3};
+        test("compare_exchange_strong fail", !a.compare_exchange_strong(expected, 20));
+        test_eq("compare_exchange_strong fail expected", expected, 10);
+        test("compare_exchange_strong success", a.compare_exchange_strong(expected, 20));
+        test_eq("compare_exchange_strong success value", a.load(), 20);
+
+        expected = 20;
+        while (!a.compare_exchange_weak(expected, 21, memory_order_acq_rel))
+        { /* DUMMY BODY */ }
+        test_eq("compare_exchange_weak", a.load(), 21);
+
+        std::atomic<bool> b{false};
+        test("bool exchange", !b.exchange(true));
+        test("bool load", b.load());
+
+        volatile std::atomic_long l = ATOMIC_VAR_INIT(1L);
+        test_eq("free fetch_add", std::atomic_fetch_add(&l, 2L), 1L);
+        std::atomic_store_explicit(&l, 4L, memory_order_release);
+        test_eq("free load", std::atomic_load_explicit(&l, memory_order_acquire), 4L);
+
+        test("int always lock free", std::atomic<int>::is_always_lock_free);
+        test("long always lock free", std::atomic<long>::is_always_lock_free);
+        test("pointer always lock free", std::atomic<void*>::is_always_lock_free);
+        test("is_lock_free", a.is_lock_free());
+    }
+
+    void atomic_test::test_pointer()
+    {
+        int arr[10]{};
+        std::atomic<int*> ptr{arr};
+
+        test_eq("fetch_add", ptr.fetch_add(2), &arr[0]);
+        test_eq("fetch_add scaled", ptr.load(), &arr[2]);
+        test_eq("prefix increment", ++ptr, &arr[3]);
+        test_eq("operator-=", (ptr -= 3), &arr[0]);
+        test_eq("postfix increment", ptr++, &arr[0]);
+        test_eq("postfix decrement", ptr--, &arr[1]);
+        test_eq("pointer value", ptr.load(), &arr[0]);
+    }
+
+    void atomic_test::test_flag()
+    {
+        std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+        test("test_and_set on clear flag", !flag.test_and_set());
+        test("test_and_set on set flag", flag.test_and_set());
+        flag.clear(memory_order_release);
+        test("clear", !std::atomic_flag_test_and_set(&flag));
+    }
+
+    void atomic_test::test_shared_ptr()
+    {
+        mock::clear();
+        {
+            auto ptr1 = std::make_shared<mock>();
+            auto ptr2 = std::atomic_load(&ptr1);
+            test_eq("atomic_load", ptr2.get(), ptr1.get());
+            test_eq("atomic_load refcount", ptr1.use_count(), 2L);
+
+            std::atomic_store(&ptr2, std::make_shared<mock>());
+            test("atomic_store", ptr2.get() != ptr1.get());
+            test_eq("atomic_store refcount", ptr1.use_count(), 1L);
+
+            auto expected = ptr1;
+            test("atomic_compare_exchange fail",
+                 !std::atomic_compare_exchange_strong(&ptr2, &expected, ptr1));
+            test_eq("atomic_compare_exchange fail expected", expected.get(), ptr2.get());
+
+            test("atomic_compare_exchange success",
+                 std::atomic_compare_exchange_strong(&ptr2, &expected, ptr1));
+            test_eq("atomic_compare_exchange success value", ptr2.get(), ptr1.get());
+
+            expected.reset();
+            test_eq("atomic_compare_exchange destroyed old", mock::destructor_calls, 1U);
+
+            auto old = std::atomic_exchange(&ptr2, std::shared_ptr<mock>{});
+            test_eq("atomic_exchange", old.get(), ptr1.get());
+            test("atomic_exchange value", !ptr2);
+
+            std::weak_ptr<mock> weak{ptr1};
+            ptr1.reset();
+            test("weak_ptr lock after shared_ptr reset", (bool)weak.lock());
+            old.reset();
+            test("weak_ptr expired", weak.expired());
+            test("weak_ptr lock when expired", !weak.lock());
+        }
+        test_eq("shared_ptr atomic access destructor calls", mock::destructor_calls, 2U);
+    }
+}
@@ -29,7 +29,9 @@
 #include <__bits/test/tests.hpp>
 #include <deque>
 #include <initializer_list>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace std::test
 {
@@ -42,6 +44,7 @@ namespace std::test
         test_resizing();
         test_push_pop();
         test_operations();
+        test_emplace_erase();
 
         return end();
     }
@@ -292,4 +295,87 @@ namespace std::test
             d2.begin(), d2.end()
         );
     }
+
+    void deque_test::test_emplace_erase()
+    {
+        /**
+         * Positions around the boundaries of the 16 element
+         * buckets, the deque is shifted by the push_fronts
+         * so that the front bucket is only partially used.
+         */
+        std::size_t positions[] = {
+            0, 1, 2, 14, 15, 16, 17, 24, 31, 32, 33, 40, 47, 48
+        };
+
+        std::deque<std::string> d{};
+        std::vector<std::string> v{};
+        for (int i = 0; i < 45; ++i)
+        {
+            d.push_back(std::to_string(i));
+            v.push_back(std::to_string(i));
+        }
+        for (int i = 0; i < 5; ++i)
+        {
+            d.push_front(std::to_string(-i));
+            v.insert(v.begin(), std::to_string(-i));
+        }
+
+        bool emplace_ok{true};
+        bool emplace_ret_ok{true};
+        for (auto pos: positions)
+        {
+            auto value = "e" + std::to_string(pos);
+            auto it = d.emplace(d.begin() + pos, value);
+            v.insert(v.begin() + pos, value);
+
+            emplace_ret_ok = emplace_ret_ok && (*it == value) && (it == d.begin() + pos);
+            emplace_ok = emplace_ok && (d.size() == v.size()) &&
+                std::equal(d.begin(), d.end(), v.begin());
+        }
+        test("emplace across buckets", emplace_ok);
+        test("emplace returned iterator", emplace_ret_ok);
+
+        d.emplace(d.end(), "back");
+        v.push_back("back");
+        d.emplace(d.begin(), "front");
+        v.insert(v.begin(), "front");
+        test_eq("emplace front and back size", d.size(), v.size());
+        test_eq(
+            "emplace front and back",
+            v.begin(), v.end(), d.begin(), d.end()
+        );
+
+        bool erase_ok{true};
+        bool erase_ret_ok{true};
+        for (auto it = std::end(positions); it != std::begin(positions); )
+        {
+            auto pos = *--it;
+            auto next = d.erase(d.begin() + pos);
+            v.erase(v.begin() + pos);
+
+            erase_ret_ok = erase_ret_ok && (next == d.begin() + pos);
+            erase_ok = erase_ok && (d.size() == v.size()) &&
+                std::equal(d.begin(), d.end(), v.begin());
+        }
+        test("erase across buckets", erase_ok);
+        test("erase returned iterator", erase_ret_ok);
+
+        d.erase(d.end() - 1);
+        v.pop_back();
+        d.erase(d.begin());
+        v.erase(v.begin());
+        test_eq("erase front and back size", d.size(), v.size());
+        test_eq(
+            "erase front and back",
+            v.begin(), v.end(), d.begin(), d.end()
+        );
+
+        d.erase(d.begin() + 3, d.begin() + 37);
+        v.erase(v.begin() + 3, v.begin() + 37);
+        test_eq("erase range across buckets size", d.size(), v.size());
+        test_eq(
+            "erase range across buckets",
+            v.begin(), v.end(), d.begin(), d.end()
+        );
+    }
 }
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <flat_hash_map>
+#include <flat_hash_set>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace std::test
+{
+    namespace
+    {
+        struct transparent_string_hash
+        {
+            using is_transparent = void;
+
+            size_t operator()(const std::string& str) const noexcept
+            {
+                return (*this)(str.c_str());
+            }
+
+            size_t operator()(const char* str) const noexcept
+            {
+                size_t res{};
+                while (*str)
+                    res = res * 31 + static_cast<size_t>(*str++);
+
+                return res;
+            }
+        };
+
+        struct transparent_string_equal
+        {
+            using is_transparent = void;
+
+            bool operator()(const std::string& lhs, const std::string& rhs) const noexcept
+            {
+                return lhs == rhs;
+            }
+
+            bool operator()(const char* lhs, const std::string& rhs) const noexcept
+            {
+                return rhs == lhs;
+            }
+        };
+    }
+
+    bool flat_hash_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_constructors_and_assignment();
+        test_insert_erase();
+        test_reserve();
+        test_heterogeneous();
+        test_set();
+
+        return end();
+    }
+
+    const char* flat_hash_test::name()
+    {
+        return "flat_hash";
+    }
+
+    void flat_hash_test::test_constructors_and_assignment()
+    {
+        auto check1 = {1, 2, 3, 4, 5, 6, 7};
+        auto src1 = {
+            std::pair<const int, int>{3, 3},
+            std::pair<const int, int>{1, 1},
+            std::pair<const int, int>{5, 5},
+            std::pair<const int, int>{2, 2},
+            std::pair<const int, int>{7, 7},
+            std::pair<const int, int>{6, 6},
+            std::pair<const int, int>{4, 4}
+        };
+
+        std::flat_hash_map<int, int> m1{src1};
+        test_contains(
+            "initializer list initialization",
+            check1.begin(), check1.end(), m1
+        );
+        test_eq("size", m1.size(), 7U);
+
+        std::flat_hash_map<int, int> m2{m1};
+        test_contains(
+            "copy initialization",
+            check1.begin(), check1.end(), m2
+        );
+        test("copy equality", m1 == m2);
+
+        std::flat_hash_map<int, int> m3{std::move(m1)};
+        test_contains(
+            "move initialization",
+            check1.begin(), check1.end(), m3
+        );
+        test_eq("move initialization - origin empty", m1.size(), 0U);
+
+        m1 = m3;
+        test_contains(
+            "copy assignment",
+            check1.begin(), check1.end(), m1
+        );
+
+        m2[5] = 42;
+        test("inequality", m1 != m2);
+        test_eq("operator[]", m2.at(5), 42);
+
+        size_t elements{};
+        for (const auto& x: m3)
+        {
+            if (x.first == x.second)
+                ++elements;
+        }
+        test_eq("iteration", elements, 7U);
+    }
+
+    void flat_hash_test::test_insert_erase()
+    {
+        /**
+         * Insert and erase enough keys to make the table
+         * grow and reuse deleted slots, checking it against
+         * a plain array.
+         */
+        constexpr int count{1000};
+        std::vector<int> reference(count, -1);
+        std::flat_hash_map<int, int> m{};
+
+        bool ok{true};
+        for (int i = 0; i < 10 * count; ++i)
+        {
+            auto key = (i * 7919) % count;
+            if (i % 3 == 2)
+            {
+                auto erased = m.erase(key);
+                if (erased != (reference[key] != -1 ? 1U : 0U))
+                    ok = false;
+                reference[key] = -1;
+            }
+            else
+            {
+                m.insert_or_assign(key, i);
+                reference[key] = i;
+            }
+        }
+        test("churn", ok);
+
+        size_t size{};
+        ok = true;
+        for (int key = 0; key < count; ++key)
+        {
+            auto it = m.find(key);
+            if (reference[key] == -1)
+                ok = ok && (it == m.end());
+            else
+            {
+                ok = ok && (it != m.end()) && (it->second == reference[key]);
+                ++size;
+            }
+        }
+        test("churn contents", ok);
+        test_eq("churn size", m.size(), size);
+
+        auto res1 = m.try_emplace(count + 1, 1);
+        auto res2 = m.try_emplace(count + 1, 2);
+        test("try_emplace", res1.second && !res2.second);
+        test_eq("try_emplace no overwrite", res2.first->second, 1);
+
+        for (auto it = m.begin(); it != m.end();)
+        {
+            if (it->first % 2 == 0)
+                it = m.erase(it);
+            else
+                ++it;
+        }
+        ok = true;
+        for (const auto& x: m)
+            ok = ok && (x.first % 2 != 0);
+        test("erase while iterating", ok);
+
+        m.clear();
+        test("clear", m.empty() && m.begin() == m.end());
+    }
+
+    void flat_hash_test::test_reserve()
+    {
+        std::flat_hash_map<std::string, int> m{};
+        m.reserve(100);
+
+        auto buckets = m.bucket_count();
+        for (int i = 0; i < 100; ++i)
+            m.emplace(std::to_string(i), i);
+        test_eq("reserve avoids rehash", m.bucket_count(), buckets);
+
+        for (int i = 0; i < 100; i += 2)
+            m.erase(std::to_string(i));
+        m.reserve(100);
+        buckets = m.bucket_count();
+        for (int i = 0; i < 100; i += 2)
+            m.emplace(std::to_string(i), i);
+        test_eq("reserve after erase", m.bucket_count(), buckets);
+        test_eq("reserve size", m.size(), 100U);
+        test_eq("load factor", m.load_factor() <= m.max_load_factor(), true);
+    }
+
+    void flat_hash_test::test_heterogeneous()
+    {
+        std::flat_hash_map<
+            std::string, int,
+            transparent_string_hash,
+            transparent_string_equal
+        > m{};
+
+        m["alpha"] = 1;
+        m["beta"] = 2;
+
+        auto it = m.find("beta");
+        test("heterogeneous find", it != m.end() && it->second == 2);
+        test_eq("heterogeneous count", m.count("gamma"), 0U);
+        test_eq("heterogeneous erase", m.erase("alpha"), 1U);
+        test_eq("heterogeneous erase size", m.size(), 1U);
+    }
+
+    void flat_hash_test::test_set()
+    {
+        auto check1 = {1, 2, 3, 4, 5, 6, 7};
+        std::flat_hash_set<int> s1{3, 1, 5, 2, 7, 6, 4, 1, 3};
+        test_contains(
+            "set initializer list initialization",
+            check1.begin(), check1.end(), s1
+        );
+        test_eq("set duplicates", s1.size(), 7U);
+
+        auto res = s1.insert(8);
+        test("set insert", res.second && *res.first == 8);
+        res = s1.emplace(8);
+        test("set emplace existing", !res.second);
+
+        std::flat_hash_set<int> s2{s1};
+        test("set equality", s1 == s2);
+
+        s2.erase(8);
+        test_eq("set erase", s2.count(8), 0U);
+        test("set inequality", s1 != s2);
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <chrono>
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace std::test
+{
+    bool future_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_promise();
+        test_packaged_task();
+        test_shared_future();
+        test_async();
+
+        return end();
+    }
+
+    const char* future_test::name()
+    {
+        return "future";
+    }
+
+    void future_test::test_promise()
+    {
+        std::promise<int> p1{};
+        auto f1 = p1.get_future();
+        test("future valid", f1.valid());
+        test_eq("future not ready", f1.wait_for(std::chrono::milliseconds{0}),
+                std::future_status::timeout);
+
+        auto start = std::chrono::steady_clock::now();
+        test_eq("future wait_for timeout", f1.wait_for(std::chrono::milliseconds{10}),
+                std::future_status::timeout);
+        test("future wait_for full timeout",
+             std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{10});
+
+        p1.set_value(42);
+        test_eq("future ready", f1.wait_for(std::chrono::milliseconds{0}),
+                std::future_status::ready);
+        test_eq("promise value", f1.get(), 42);
+        test("future invalid after get", !f1.valid());
+
+        int x{};
+        std::promise<int&> p2{};
+        auto f2 = p2.get_future();
+        p2.set_value(x);
+        test_eq("promise<R&> value", &f2.get(), &x);
+
+        std::promise<void> p3{};
+        auto f3 = p3.get_future();
+        p3.set_value();
+        f3.get();
+        test("promise<void>", !f3.valid());
+
+        std::future<int> f4{};
+        {
+            std::promise<int> p4{};
+            f4 = p4.get_future();
+        }
+        test_eq("broken promise makes the state ready",
+                f4.wait_for(std::chrono::milliseconds{0}),
+                std::future_status::ready);
+    }
+
+    void future_test::test_packaged_task()
+    {
+        std::packaged_task<int(int, int)> t1{[](int a, int b){ return a + b; }};
+        auto f1 = t1.get_future();
+        t1(1, 2);
+        test_eq("packaged_task result", f1.get(), 3);
+
+        t1.reset();
+        test("packaged_task valid after reset", t1.valid());
+        auto f2 = t1.get_future();
+        t1(3, 4);
+        test_eq("packaged_task result after reset", f2.get(), 7);
+
+        int calls{};
+        std::packaged_task<void()> t2{[&calls](){ ++calls; }};
+        auto f3 = t2.get_future();
+        auto t3 = std::move(t2);
+        test("packaged_task moved from", !t2.valid());
+        t3();
+        f3.get();
+        test_eq("packaged_task<void()>", calls, 1);
+    }
+
+    void future_test::test_shared_future()
+    {
+        std::promise<int> p{};
+        auto sf1 = p.get_future().share();
+        auto sf2 = sf1;
+
+        p.set_value(7);
+        test_eq("shared_future get", sf1.get(), 7);
+        test_eq("shared_future get twice", sf1.get(), 7);
+        test_eq("shared_future copy", sf2.get(), 7);
+        test("shared_future valid after get", sf1.valid());
+    }
+
+    void future_test::test_async()
+    {
+        int calls{};
+        auto f1 = std::async(std::launch::deferred, [&calls](int x){
+            ++calls;
+            return x * 2;
+        }, 21);
+        test_eq("deferred wait_for", f1.wait_for(std::chrono::milliseconds{0}),
+                std::future_status::deferred);
+        test_eq("deferred not run before get", calls, 0);
+        test_eq("deferred result", f1.get(), 42);
+        test_eq("deferred run once", calls, 1);
+
+        auto f2 = std::async(std::launch::async, [](int x, int y){
+            return x * y;
+        }, 6, 7);
+        test_eq("async result", f2.get(), 42);
+
+        std::vector<std::future<size_t>> futures{};
+        for (size_t i = 0; i < 16; ++i)
+        {
+            futures.push_back(std::async([](size_t n){
+                size_t res{};
+                for (size_t j = 0; j <= n; ++j)
+                    res += j;
+
+                return res;
+            }, i * 100));
+        }
+
+        size_t sum{};
+        for (auto& f: futures)
+            sum += f.get();
+        test_eq("async fan-out", sum, static_cast<size_t>(6206000));
+
+        /**
+         * The task blocks on a future that is only
+         * satisfied by a task submitted after it.
+         */
+        std::promise<int> p{};
+        auto pf = p.get_future().share();
+        auto f3 = std::async(std::launch::async, [pf](){ return pf.get() + 1; });
+        auto f4 = std::async(std::launch::async, [&p](){ p.set_value(1); });
+        f4.get();
+        test_eq("async dependent tasks", f3.get(), 2);
+
+        bool done{false};
+        {
+            auto f5 = std::async(std::launch::async, [&done](){ done = true; });
+        }
+        test("async future destructor blocks", done);
+    }
+}
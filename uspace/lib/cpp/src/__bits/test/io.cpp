@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <sstream>
+#include <string>
+
+namespace std::test
+{
+    namespace
+    {
+        const char* test_file{"/tmp/cpptest_io"};
+
+        std::string make_data(std::size_t size, std::size_t seed)
+        {
+            std::string res(size, ' ');
+            for (std::size_t i = 0; i < size; ++i)
+                res[i] = static_cast<char>('a' + (i * 7 + seed) % 26);
+
+            return res;
+        }
+    }
+
+    bool io_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_filebuf();
+        test_getline();
+        test_getline_limits();
+        test_bulk();
+
+        std::remove(test_file);
+
+        return end();
+    }
+
+    const char* io_test::name()
+    {
+        return "io";
+    }
+
+    void io_test::test_filebuf()
+    {
+        {
+            std::ofstream ofs{test_file};
+            test("ofstream open", ofs.is_open());
+
+            ofs << "hello world\n" << 42 << '\n';
+            test("ofstream write", ofs.good());
+        }
+
+        {
+            std::ifstream ifs{test_file};
+            test("ifstream open", ifs.is_open());
+
+            std::string word{};
+            int num{};
+            ifs >> word;
+            test_eq("ifstream read #1", word, std::string{"hello"});
+            ifs >> word;
+            test_eq("ifstream read #2", word, std::string{"world"});
+            ifs >> num;
+            test_eq("ifstream read #3", num, 42);
+
+            ifs >> word;
+            test("ifstream eof", ifs.eof() && ifs.fail());
+        }
+
+        std::filebuf fb{};
+        test("filebuf open", fb.open(
+            test_file, std::ios_base::in | std::ios_base::out | std::ios_base::trunc
+        ) == &fb);
+        test_eq("filebuf truncate", fb.pubseekoff(0, std::ios_base::end), std::streampos{0});
+
+        test_eq("filebuf sputn", fb.sputn("0123456789", 10), std::streamsize{10});
+        test_eq("filebuf seekpos", fb.pubseekpos(3), std::streampos{3});
+
+        char buf[16]{};
+        test_eq("filebuf sgetn after write", fb.sgetn(buf, 3), std::streamsize{3});
+        test_eq("filebuf read back", std::string{buf}, std::string{"345"});
+
+        test_eq("filebuf seek to end", fb.pubseekoff(0, std::ios_base::end), std::streampos{10});
+        fb.sputc('x');
+        test_eq("filebuf seek to start", fb.pubseekpos(0), std::streampos{0});
+
+        test_eq("filebuf sgetn to eof", fb.sgetn(buf, 15), std::streamsize{11});
+        buf[11] = '\0';
+        test_eq("filebuf contents", std::string{buf}, std::string{"0123456789x"});
+        test("filebuf close", fb.close() == &fb);
+
+        std::ifstream ifs{test_file};
+        std::string line{};
+        std::getline(ifs, line);
+        test_eq("filebuf persisted", line, std::string{"0123456789x"});
+    }
+
+    void io_test::test_getline()
+    {
+        /**
+         * With the buffer of 8 characters the first delimiter
+         * is the last character of the first buffer, the second
+         * line needs two refills and its delimiter is the first
+         * character of the fourth buffer.
+         */
+        {
+            std::ofstream ofs{test_file};
+            ofs << "abcdefg\n" << "0123456789ABCDEF\n" << '\n' << "xyz";
+        }
+
+        std::ifstream ifs1{};
+        ifs1.rdbuf()->pubsetbuf(nullptr, 8);
+        ifs1.open(test_file);
+
+        std::string line{};
+        std::getline(ifs1, line);
+        test_eq("getline delimiter at buffer end", line, std::string{"abcdefg"});
+        std::getline(ifs1, line);
+        test_eq("getline across refills", line, std::string{"0123456789ABCDEF"});
+        std::getline(ifs1, line);
+        test("getline empty line", line.empty() && ifs1.good());
+        std::getline(ifs1, line);
+        test_eq("getline last line", line, std::string{"xyz"});
+        test("getline last line state", ifs1.eof() && !ifs1.fail());
+        std::getline(ifs1, line);
+        test("getline at eof", ifs1.fail());
+
+        std::ifstream ifs2{};
+        ifs2.rdbuf()->pubsetbuf(nullptr, 8);
+        ifs2.open(test_file);
+
+        char buf[32]{};
+        ifs2.getline(buf, 32);
+        test_eq("istream::getline delimiter at buffer end", std::string{buf}, std::string{"abcdefg"});
+        test_eq("istream::getline gcount", ifs2.gcount(), std::streamsize{8});
+        ifs2.getline(buf, 32);
+        test_eq("istream::getline across refills", std::string{buf}, std::string{"0123456789ABCDEF"});
+        test_eq("istream::getline gcount across refills", ifs2.gcount(), std::streamsize{17});
+        ifs2.getline(buf, 32);
+        test("istream::getline empty line", buf[0] == '\0' && ifs2.good());
+        ifs2.getline(buf, 32);
+        test_eq("istream::getline last line", std::string{buf}, std::string{"xyz"});
+        test("istream::getline last line state", ifs2.eof() && !ifs2.fail());
+    }
+
+    void io_test::test_getline_limits()
+    {
+        {
+            std::ofstream ofs{test_file};
+            ofs << "abcdefg\n" << "hij\n";
+        }
+
+        std::ifstream ifs{};
+        ifs.rdbuf()->pubsetbuf(nullptr, 8);
+        ifs.open(test_file);
+
+        char buf[4]{};
+        ifs.getline(buf, 4);
+        test("getline too small fails", ifs.fail() && !ifs.eof());
+        test_eq("getline too small stores", std::string{buf}, std::string{"abc"});
+        test_eq("getline too small gcount", ifs.gcount(), std::streamsize{3});
+
+        ifs.clear();
+        test_eq("getline too small leaves rest", ifs.get(), 'd');
+
+        ifs.ignore(10, '\n');
+        ifs.getline(buf, 4);
+        test("getline exact fit", !ifs.fail());
+        test_eq("getline exact fit stores", std::string{buf}, std::string{"hij"});
+        test_eq("getline exact fit gcount", ifs.gcount(), std::streamsize{4});
+
+        std::istringstream iss{"abcdefgh\nij"};
+        char small[6]{};
+        iss.getline(small, 6);
+        test("getline too small in stringbuf", iss.fail());
+        test_eq("getline too small in stringbuf stores", std::string{small}, std::string{"abcde"});
+    }
+
+    void io_test::test_bulk()
+    {
+        /**
+         * The sizes are chosen to go through all paths of xsputn
+         * with a buffer of 16 characters: a write that fits, one
+         * that is written past the buffer, one that tops the
+         * buffer up and keeps the rest in it, then single
+         * characters that go through overflow.
+         */
+        auto data = make_data(85, 3);
+
+        std::filebuf out{};
+        out.pubsetbuf(nullptr, 16);
+        out.open(test_file, std::ios_base::out | std::ios_base::trunc);
+
+        auto ptr = data.c_str();
+        test_eq("sputn fits", out.sputn(ptr, 5), std::streamsize{5});
+        test_eq("sputn past buffer", out.sputn(ptr + 5, 40), std::streamsize{40});
+        test_eq("sputn into empty buffer", out.sputn(ptr + 45, 12), std::streamsize{12});
+        test_eq("sputn wraps", out.sputn(ptr + 57, 10), std::streamsize{10});
+
+        bool ok{true};
+        for (std::size_t i = 67; i < data.size(); ++i)
+            ok &= out.sputc(data[i]) == data[i];
+        test("sputc overflow", ok);
+        out.close();
+
+        std::filebuf in{};
+        in.pubsetbuf(nullptr, 16);
+        in.open(test_file, std::ios_base::in);
+
+        std::string res(100, ' ');
+        auto buf = &res[0];
+        test_eq("sgetn from buffer", in.sgetn(buf, 3), std::streamsize{3});
+        test_eq("sgetn past buffer", in.sgetn(buf + 3, 50), std::streamsize{50});
+        test_eq("sgetn across refills", in.sgetn(buf + 53, 20), std::streamsize{20});
+        test_eq("sgetn to eof", in.sgetn(buf + 73, 27), std::streamsize{12});
+        test("sgetc at eof", in.sgetc() == std::filebuf::traits_type::eof());
+
+        res.resize(85);
+        test_eq("bulk round trip", res, data);
+    }
+}
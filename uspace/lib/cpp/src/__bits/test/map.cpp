@@ -47,6 +47,8 @@ namespace std::test
         test_multi();
         test_reverse_iterators();
         test_multi_bounds_and_ranges();
+        test_sorted_build_and_hints();
+        test_extract_and_merge();
 
         return end();
     }
@@ -431,4 +433,149 @@ namespace std::test
             res3.first, res3.second
         );
     }
+
+    void map_test::test_sorted_build_and_hints()
+    {
+        std::map<int, int> sorted{};
+        for (int i = 0; i < 100; ++i)
+            sorted.emplace_hint(sorted.end(), i, i * 2);
+        test_eq("sorted hinted emplace size", sorted.size(), 100U);
+        test_eq("sorted hinted emplace begin", sorted.begin()->first, 0);
+        test_eq("sorted hinted emplace rbegin", sorted.rbegin()->first, 99);
+
+        auto it = sorted.find(50);
+        auto res1 = sorted.emplace_hint(it, 50, 0);
+        test_eq("hinted emplace of an existing key pt1", res1->second, 100);
+        test_eq("hinted emplace of an existing key pt2", sorted.size(), 100U);
+
+        auto res2 = sorted.insert(sorted.find(10), std::pair<const int, int>{-1, -1});
+        test_eq("insert with a wrong hint pt1", res2->first, -1);
+        test_eq("insert with a wrong hint pt2", sorted.begin()->first, -1);
+
+        auto check1 = {
+            std::pair<const int, int>{1, 1},
+            std::pair<const int, int>{2, 2},
+            std::pair<const int, int>{3, 3},
+            std::pair<const int, int>{4, 4},
+            std::pair<const int, int>{5, 5}
+        };
+        auto src1 = {
+            std::pair<const int, int>{1, 1},
+            std::pair<const int, int>{2, 2},
+            std::pair<const int, int>{2, 7},
+            std::pair<const int, int>{3, 3},
+            std::pair<const int, int>{5, 5},
+            std::pair<const int, int>{4, 4}
+        };
+
+        std::map<int, int> map1{src1};
+        test_eq(
+            "range construction with duplicates and unsorted tail",
+            check1.begin(), check1.end(),
+            map1.begin(), map1.end()
+        );
+
+        auto check2 = {
+            std::pair<const int, int>{1, 1},
+            std::pair<const int, int>{1, 2},
+            std::pair<const int, int>{2, 2},
+            std::pair<const int, int>{2, 7},
+            std::pair<const int, int>{3, 3}
+        };
+
+        std::multimap<int, int> mmap{check2};
+        test_eq(
+            "multi sorted range construction",
+            check2.begin(), check2.end(),
+            mmap.begin(), mmap.end()
+        );
+
+        std::map<int, int> map2{};
+        for (int i = 0; i < 1000; ++i)
+            map2.emplace((i * 7919) % 1000, i);
+        for (int i = 0; i < 1000; i += 2)
+            map2.erase(i);
+
+        bool ordered{true};
+        int expected{1};
+        for (auto& x: map2)
+        {
+            if (x.first != expected)
+                ordered = false;
+            expected += 2;
+        }
+        test("insert and erase keep order", ordered);
+        test_eq("insert and erase size", map2.size(), 500U);
+        test_eq("insert and erase begin", map2.begin()->first, 1);
+        test_eq("insert and erase rbegin", map2.rbegin()->first, 999);
+
+        map2.clear();
+        test("empty after clear", map2.empty());
+        test("begin is end after clear", map2.begin() == map2.end());
+    }
+
+    void map_test::test_extract_and_merge()
+    {
+        std::map<int, std::string> map1{
+            {1, "a"}, {2, "b"}, {3, "c"}
+        };
+
+        auto nh1 = map1.extract(2);
+        test("extract by key pt1", !nh1.empty());
+        test_eq("extract by key pt2", nh1.key(), 2);
+        test_eq("extract by key pt3", nh1.mapped(), std::string{"b"});
+        test_eq("extract by key pt4", map1.size(), 2U);
+        test_eq("extract by key pt5", map1.count(2), 0U);
+
+        auto nh2 = map1.extract(42);
+        test("extract of a missing key", nh2.empty());
+
+        nh1.key() = 4;
+        auto res1 = map1.insert(std::move(nh1));
+        test("insert node pt1", res1.inserted);
+        test_eq("insert node pt2", res1.position->first, 4);
+        test("insert node pt3", res1.node.empty());
+        test_eq("insert node pt4", map1.size(), 3U);
+
+        auto nh3 = map1.extract(map1.begin());
+        nh3.key() = 3;
+        auto res2 = map1.insert(std::move(nh3));
+        test("insert node with an existing key pt1", !res2.inserted);
+        test_eq("insert node with an existing key pt2", res2.position->second, std::string{"c"});
+        test_eq("insert node with an existing key pt3", res2.node.mapped(), std::string{"a"});
+        test_eq("insert node with an existing key pt4", map1.size(), 2U);
+
+        std::map<int, std::string> map2{
+            {1, "x"}, {3, "y"}, {5, "z"}
+        };
+        map1.merge(map2);
+
+        auto check1 = {
+            std::pair<const int, std::string>{1, "x"},
+            std::pair<const int, std::string>{3, "c"},
+            std::pair<const int, std::string>{4, "b"},
+            std::pair<const int, std::string>{5, "z"}
+        };
+        test_eq(
+            "merge pt1",
+            check1.begin(), check1.end(),
+            map1.begin(), map1.end()
+        );
+        test_eq("merge pt2", map2.size(), 1U);
+        test_eq("merge pt3", map2.begin()->second, std::string{"y"});
+
+        std::multimap<int, std::string> mmap{
+            {1, "a"}, {1, "b"}
+        };
+        mmap.merge(map1);
+        test_eq("multi merge pt1", mmap.size(), 6U);
+        test_eq("multi merge pt2", mmap.count(1), 3U);
+        test("multi merge pt3", map1.empty());
+
+        auto nh4 = mmap.extract(1);
+        auto res3 = mmap.insert(std::move(nh4));
+        test_eq("multi reinsert node pt1", res3->first, 1);
+        test_eq("multi reinsert node pt2", mmap.count(1), 3U);
+        test_eq("multi reinsert node pt3", mmap.size(), 6U);
+    }
 }
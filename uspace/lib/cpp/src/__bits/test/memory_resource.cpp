@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace std::test
+{
+    namespace
+    {
+        /**
+         * Forwards to new_delete_resource and keeps track
+         * of the memory that was not returned yet.
+         */
+        class counting_resource: public pmr::memory_resource
+        {
+            public:
+                size_t allocations{};
+                size_t live_bytes{};
+                size_t live_blocks{};
+
+            private:
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    ++allocations;
+                    ++live_blocks;
+                    live_bytes += bytes;
+
+                    return pmr::new_delete_resource()->allocate(bytes, alignment);
+                }
+
+                void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+                {
+                    --live_blocks;
+                    live_bytes -= bytes;
+
+                    pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+                }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        bool is_aligned(void* ptr, size_t alignment)
+        {
+            return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+        }
+    }
+
+    bool memory_resource_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_monotonic();
+        test_pools();
+        test_containers();
+        test_area();
+
+        return end();
+    }
+
+    const char* memory_resource_test::name()
+    {
+        return "memory_resource";
+    }
+
+    void memory_resource_test::test_monotonic()
+    {
+        counting_resource upstream{};
+        alignas(16) char buffer[256];
+
+        {
+            pmr::monotonic_buffer_resource mbr{buffer, sizeof(buffer), &upstream};
+
+            auto p1 = static_cast<char*>(mbr.allocate(10, 1));
+            auto p2 = static_cast<char*>(mbr.allocate(8, 8));
+            test_eq("monotonic initial buffer pt1", p1, &buffer[0]);
+            test_eq("monotonic initial buffer pt2", p2, &buffer[16]);
+            test_eq("monotonic initial buffer pt3", upstream.allocations, 0U);
+
+            mbr.deallocate(p1, 10, 1);
+            auto p3 = mbr.allocate(4, 4);
+            test("monotonic deallocate is no-op", p3 != p1);
+
+            auto big = mbr.allocate(1000, 64);
+            test("monotonic overflow to upstream pt1", big != nullptr);
+            test_eq("monotonic overflow to upstream pt2", upstream.allocations, 1U);
+            test("monotonic alignment", is_aligned(big, 64));
+
+            for (size_t i = 0; i < 100; ++i)
+                mbr.allocate(100, 8);
+            test("monotonic geometric growth", upstream.allocations < 8U);
+
+            mbr.release();
+            test_eq("monotonic release pt1", upstream.live_blocks, 0U);
+            test_eq("monotonic release pt2", mbr.allocate(10, 1), static_cast<void*>(&buffer[0]));
+
+            mbr.allocate(512, 8);
+            test_eq("monotonic reuse after release", upstream.live_blocks, 1U);
+        }
+        test_eq("monotonic destructor", upstream.live_bytes, 0U);
+    }
+
+    void memory_resource_test::test_pools()
+    {
+        counting_resource upstream{};
+
+        {
+            pmr::unsynchronized_pool_resource pool{
+                pmr::pool_options{32, 256}, &upstream
+            };
+            test_eq("pool options pt1", pool.options().max_blocks_per_chunk, 32U);
+            test_eq("pool options pt2", pool.options().largest_required_pool_block, 256U);
+
+            auto p1 = pool.allocate(24, 8);
+            auto p2 = pool.allocate(24, 8);
+            test("pool distinct blocks", p1 != p2);
+            test_eq("pool single chunk", upstream.allocations, 1U);
+
+            pool.deallocate(p1, 24, 8);
+            test_eq("pool reuse", pool.allocate(20, 8), p1);
+
+            auto aligned = pool.allocate(48, 64);
+            test("pool alignment", is_aligned(aligned, 64));
+
+            auto allocations = upstream.allocations;
+            auto big = pool.allocate(1000, 16);
+            test_eq("pool oversized pt1", upstream.allocations, allocations + 1);
+            pool.deallocate(big, 1000, 16);
+            test_eq("pool oversized pt2", upstream.live_blocks, allocations);
+
+            void* blocks[100];
+            for (size_t i = 0; i < 100; ++i)
+                blocks[i] = pool.allocate(100, 8);
+            for (size_t i = 0; i < 100; ++i)
+                pool.deallocate(blocks[i], 100, 8);
+
+            pool.allocate(5000, 16);
+            pool.release();
+            test_eq("pool release", upstream.live_blocks, 0U);
+        }
+        test_eq("pool destructor", upstream.live_bytes, 0U);
+
+        pmr::synchronized_pool_resource sync{&upstream};
+        auto ptr = sync.allocate(64);
+        test("synchronized pool", ptr != nullptr);
+        sync.deallocate(ptr, 64);
+    }
+
+    void memory_resource_test::test_containers()
+    {
+        char buffer[1024];
+        pmr::monotonic_buffer_resource mbr{buffer, sizeof(buffer), pmr::null_memory_resource()};
+
+        pmr::vector<pmr::string> vec{&mbr};
+        vec.reserve(4);
+        vec.emplace_back("a string that does not fit the local buffer");
+        vec.emplace_back("short");
+
+        test_eq("pmr vector resource", vec.get_allocator().resource(), static_cast<pmr::memory_resource*>(&mbr));
+        test_eq(
+            "pmr nested resource",
+            vec[0].get_allocator().resource(),
+            static_cast<pmr::memory_resource*>(&mbr)
+        );
+        test_eq("pmr nested value", vec[0], "a string that does not fit the local buffer");
+
+        pmr::vector<pmr::string> other{pmr::new_delete_resource()};
+        other = move(vec);
+        test_eq("pmr move unequal pt1", other.size(), 2U);
+        test_eq("pmr move unequal pt2", other[1], "short");
+        test_eq(
+            "pmr move unequal pt3",
+            other.get_allocator().resource(),
+            pmr::new_delete_resource()
+        );
+
+        auto copy = other;
+        test_eq(
+            "pmr copy uses default resource",
+            copy.get_allocator().resource(),
+            pmr::get_default_resource()
+        );
+
+        auto old = pmr::set_default_resource(&mbr);
+        test_eq("default resource pt1", old, pmr::new_delete_resource());
+        test_eq("default resource pt2", pmr::get_default_resource(), static_cast<pmr::memory_resource*>(&mbr));
+        pmr::set_default_resource(nullptr);
+        test_eq("default resource pt3", pmr::get_default_resource(), pmr::new_delete_resource());
+
+        test_eq("null resource", pmr::null_memory_resource()->allocate(16), nullptr);
+    }
+
+    void memory_resource_test::test_area()
+    {
+        pmr::monotonic_buffer_resource mbr{4096, pmr::area_resource()};
+
+        auto ptr = static_cast<char*>(mbr.allocate(3000, 16));
+        test("area upstream pt1", ptr != nullptr);
+
+        for (size_t i = 0; i < 3000; ++i)
+            ptr[i] = static_cast<char>(i);
+        test_eq("area upstream pt2", ptr[2999], static_cast<char>(2999));
+
+        mbr.release();
+    }
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <list>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace std::test
+{
+    namespace
+    {
+        /**
+         * Sizes around the grain limits, so that we test
+         * the serial fallback, uneven chunks and more
+         * chunks than there are CPUs.
+         */
+        constexpr size_t sizes[] = {0, 1, 7, 1023, 1024, 4099, 100'003};
+
+        vector<uint64_t> random_data(size_t count, uint64_t modulo)
+        {
+            uint64_t state{count};
+            vector<uint64_t> res(count);
+            for (auto& x: res)
+            {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                x = (state >> 11) % modulo;
+            }
+
+            return res;
+        }
+    }
+
+    bool parallel_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_policies();
+        test_loops();
+        test_reductions();
+        test_scans();
+        test_sort();
+
+        return end();
+    }
+
+    const char* parallel_test::name()
+    {
+        return "parallel";
+    }
+
+    void parallel_test::test_policies()
+    {
+        test("policy seq", is_execution_policy_v<execution::sequenced_policy>);
+        test("policy par", is_execution_policy_v<execution::parallel_policy>);
+        test("policy par_unseq", is_execution_policy_v<execution::parallel_unsequenced_policy>);
+        test("policy non-policy", !is_execution_policy_v<int>);
+        test("policy decay", is_execution_policy_v<decay_t<decltype(execution::par)>>);
+    }
+
+    void parallel_test::test_loops()
+    {
+        bool ok_for_each{true};
+        bool ok_transform{true};
+        bool ok_transform_binary{true};
+        for (auto size: sizes)
+        {
+            auto data = random_data(size, 1000);
+            auto expected = data;
+            for (auto& x: expected)
+                x = x * 3 + 1;
+
+            auto res = data;
+            for_each(execution::par, res.begin(), res.end(), [](auto& x) {
+                x = x * 3 + 1;
+            });
+            ok_for_each = ok_for_each && res == expected;
+
+            vector<uint64_t> out(size);
+            auto it = transform(execution::par_unseq, data.begin(), data.end(),
+                                out.begin(), [](auto x) { return x * 3 + 1; });
+            ok_transform = ok_transform && out == expected && it == out.end();
+
+            transform(execution::par, data.begin(), data.end(), expected.begin(),
+                      out.begin(), [](auto x, auto y) { return y - x; });
+            for (size_t i = 0; i < size; ++i)
+                ok_transform_binary = ok_transform_binary && out[i] == data[i] * 2 + 1;
+        }
+
+        test("parallel for_each", ok_for_each);
+        test("parallel transform unary", ok_transform);
+        test("parallel transform binary", ok_transform_binary);
+
+        // Not random access, runs serially.
+        list<int> l{1, 2, 3};
+        for_each(execution::par, l.begin(), l.end(), [](auto& x) { x *= 2; });
+        test_eq("parallel for_each list", l.begin(), l.end(), std::begin({2, 4, 6}), std::end({2, 4, 6}));
+    }
+
+    void parallel_test::test_reductions()
+    {
+        bool ok_reduce{true};
+        bool ok_transform_reduce{true};
+        bool ok_dot{true};
+        for (auto size: sizes)
+        {
+            auto data = random_data(size, 1'000'000);
+            auto sum = accumulate(data.begin(), data.end(), uint64_t{});
+
+            ok_reduce = ok_reduce && reduce(execution::par, data.begin(), data.end()) == sum;
+            ok_reduce = ok_reduce && reduce(execution::seq, data.begin(), data.end(), uint64_t{5}) == sum + 5;
+
+            auto squares = transform_reduce(
+                execution::par, data.begin(), data.end(), uint64_t{},
+                plus<uint64_t>{}, [](auto x) { return x * x; }
+            );
+            ok_transform_reduce = ok_transform_reduce && squares == inner_product(
+                data.begin(), data.end(), data.begin(), uint64_t{}
+            );
+
+            auto dot = transform_reduce(execution::par, data.begin(), data.end(),
+                                        data.begin(), uint64_t{1});
+            ok_dot = ok_dot && dot == squares + 1;
+        }
+
+        test("parallel reduce", ok_reduce);
+        test("parallel transform_reduce unary", ok_transform_reduce);
+        test("parallel transform_reduce binary", ok_dot);
+
+        // Associative but not commutative, partials have to be combined in order.
+        vector<string> strings(5000);
+        for (size_t i = 0; i < strings.size(); ++i)
+            strings[i] = string(1, static_cast<char>('a' + i % 26));
+
+        auto concat = reduce(execution::par, strings.begin(), strings.end(), string{"x"});
+        test_eq(
+            "parallel reduce order",
+            concat, accumulate(strings.begin(), strings.end(), string{"x"})
+        );
+    }
+
+    void parallel_test::test_scans()
+    {
+        bool ok_scan{true};
+        bool ok_scan_init{true};
+        bool ok_scan_in_place{true};
+        for (auto size: sizes)
+        {
+            auto data = random_data(size, 1000);
+
+            vector<uint64_t> expected(size);
+            inclusive_scan(data.begin(), data.end(), expected.begin());
+
+            vector<uint64_t> res(size);
+            auto it = inclusive_scan(execution::par, data.begin(), data.end(), res.begin());
+            ok_scan = ok_scan && res == expected && it == res.end();
+
+            inclusive_scan(execution::par, data.begin(), data.end(), res.begin(),
+                           plus<uint64_t>{}, uint64_t{10});
+            for (size_t i = 0; i < size; ++i)
+                ok_scan_init = ok_scan_init && res[i] == expected[i] + 10;
+
+            inclusive_scan(execution::par, data.begin(), data.end(), data.begin());
+            ok_scan_in_place = ok_scan_in_place && data == expected;
+        }
+
+        test("parallel inclusive_scan", ok_scan);
+        test("parallel inclusive_scan init", ok_scan_init);
+        test("parallel inclusive_scan in place", ok_scan_in_place);
+
+        vector<string> strings(10'000, string{"a"});
+        vector<string> res(strings.size());
+        inclusive_scan(execution::par, strings.begin(), strings.end(), res.begin());
+        test_eq("parallel inclusive_scan order", res.back().size(), strings.size());
+    }
+
+    void parallel_test::test_sort()
+    {
+        bool ok_sort{true};
+        bool ok_sort_duplicates{true};
+        bool ok_sort_comp{true};
+        for (auto size: sizes)
+        {
+            auto data = random_data(size, 1'000'000'000);
+            auto expected = data;
+            sort(expected.begin(), expected.end());
+
+            auto res = data;
+            sort(execution::par, res.begin(), res.end());
+            ok_sort = ok_sort && res == expected;
+
+            // Already sorted input skips the merges.
+            sort(execution::par, res.begin(), res.end());
+            ok_sort = ok_sort && res == expected;
+
+            auto duplicates = random_data(size, 10);
+            auto expected_duplicates = duplicates;
+            sort(expected_duplicates.begin(), expected_duplicates.end());
+            sort(execution::par, duplicates.begin(), duplicates.end());
+            ok_sort_duplicates = ok_sort_duplicates && duplicates == expected_duplicates;
+
+            sort(execution::par_unseq, data.begin(), data.end(), greater<uint64_t>{});
+            reverse(expected.begin(), expected.end());
+            ok_sort_comp = ok_sort_comp && data == expected;
+        }
+
+        test("parallel sort", ok_sort);
+        test("parallel sort duplicates", ok_sort_duplicates);
+        test("parallel sort comparator", ok_sort_comp);
+
+        vector<string> strings(20'000);
+        for (size_t i = 0; i < strings.size(); ++i)
+            strings[i] = to_string((i * 7919) % strings.size());
+        auto expected = strings;
+        sort(expected.begin(), expected.end());
+        sort(execution::par, strings.begin(), strings.end());
+        test("parallel sort strings", strings == expected);
+    }
+}
@@ -45,6 +45,8 @@ namespace std::test
         test_multi();
         test_reverse_iterators();
         test_multi_bounds_and_ranges();
+        test_sorted_build_and_hints();
+        test_extract_and_merge();
 
         return end();
     }
@@ -298,4 +300,112 @@ namespace std::test
             res3.first, res3.second
         );
     }
+
+    void set_test::test_sorted_build_and_hints()
+    {
+        std::set<int> sorted{};
+        for (int i = 0; i < 100; ++i)
+            sorted.emplace_hint(sorted.end(), i);
+        test_eq("sorted hinted emplace size", sorted.size(), 100U);
+        test_eq("sorted hinted emplace begin", *sorted.begin(), 0);
+        test_eq("sorted hinted emplace rbegin", *sorted.rbegin(), 99);
+
+        auto res1 = sorted.insert(sorted.find(50), 50);
+        test_eq("hinted insert of an existing key pt1", *res1, 50);
+        test_eq("hinted insert of an existing key pt2", sorted.size(), 100U);
+
+        auto res2 = sorted.insert(sorted.find(10), 200);
+        test_eq("insert with a wrong hint pt1", *res2, 200);
+        test_eq("insert with a wrong hint pt2", *sorted.rbegin(), 200);
+
+        auto check1 = {1, 2, 3, 4, 5, 6};
+        auto src1 = {1, 2, 2, 3, 4, 6, 5};
+
+        std::set<int> set1{src1};
+        test_eq(
+            "range construction with duplicates and unsorted tail",
+            check1.begin(), check1.end(),
+            set1.begin(), set1.end()
+        );
+
+        auto check2 = {1, 1, 2, 3, 3, 3, 4};
+        auto src2 = {1, 1, 2, 3, 3, 4, 3};
+
+        std::multiset<int> mset{src2};
+        test_eq(
+            "multi range construction",
+            check2.begin(), check2.end(),
+            mset.begin(), mset.end()
+        );
+
+        std::multiset<int> mset2{};
+        for (int i = 0; i < 300; ++i)
+            mset2.insert(i % 100);
+        for (int i = 0; i < 100; i += 3)
+            mset2.erase(mset2.find(i));
+
+        bool ordered{true};
+        auto prev = *mset2.begin();
+        for (auto x: mset2)
+        {
+            if (x < prev)
+                ordered = false;
+            prev = x;
+        }
+        test("multi insert and erase keep order", ordered);
+        test_eq("multi insert and erase size", mset2.size(), 266U);
+        test_eq("multi insert and erase count pt1", mset2.count(0), 2U);
+        test_eq("multi insert and erase count pt2", mset2.count(1), 3U);
+    }
+
+    void set_test::test_extract_and_merge()
+    {
+        std::set<int> set1{1, 2, 3};
+
+        auto nh1 = set1.extract(set1.find(2));
+        test("extract by iterator pt1", !nh1.empty());
+        test_eq("extract by iterator pt2", nh1.value(), 2);
+        test_eq("extract by iterator pt3", set1.size(), 2U);
+
+        nh1.value() = 5;
+        auto res1 = set1.insert(std::move(nh1));
+        test("insert node pt1", res1.inserted);
+        test_eq("insert node pt2", *res1.position, 5);
+        test_eq("insert node pt3", *set1.rbegin(), 5);
+
+        auto nh2 = set1.extract(1);
+        nh2.value() = 3;
+        auto res2 = set1.insert(std::move(nh2));
+        test("insert node with an existing key pt1", !res2.inserted);
+        test_eq("insert node with an existing key pt2", res2.node.value(), 3);
+
+        std::set<int> set2{1, 3, 7};
+        set1.merge(set2);
+
+        auto check1 = {1, 3, 5, 7};
+        test_eq(
+            "merge pt1",
+            check1.begin(), check1.end(),
+            set1.begin(), set1.end()
+        );
+        test_eq("merge pt2", set2.size(), 1U);
+        test_eq("merge pt3", *set2.begin(), 3);
+
+        std::multiset<int> mset1{3, 3, 8};
+        set1.merge(mset1);
+
+        auto check2 = {1, 3, 5, 7, 8};
+        test_eq(
+            "merge from multi pt1",
+            check2.begin(), check2.end(),
+            set1.begin(), set1.end()
+        );
+        test_eq("merge from multi pt2", mset1.size(), 2U);
+
+        std::multiset<int> mset2{1, 1};
+        mset2.merge(mset1);
+        test_eq("multi merge pt1", mset2.size(), 4U);
+        test_eq("multi merge pt2", mset2.count(3), 2U);
+        test("multi merge pt3", mset1.empty());
+    }
 }
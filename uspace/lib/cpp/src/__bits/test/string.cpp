@@ -27,9 +27,11 @@
  */
 
 #include <initializer_list>
+#include <__bits/test/mock.hpp>
 #include <__bits/test/tests.hpp>
 #include <string>
 #include <cstdio>
+#include <utility>
 
 namespace std::test
 {
@@ -47,6 +49,7 @@ namespace std::test
         test_find();
         test_substr();
         test_compare();
+        test_allocations();
 
         return end();
     }
@@ -703,4 +706,63 @@ namespace std::test
             res, 0
         );
     }
+
+    void string_test::test_allocations()
+    {
+        using counted_string = std::basic_string<
+            char, std::char_traits<char>, counting_allocator<char>
+        >;
+
+        allocation_counter::clear();
+        {
+            counted_string str1{};
+            counted_string str2{"short string"};
+            counted_string str3{str2};
+            counted_string str4{std::move(str3)};
+            str1 = str4;
+            str1 += "!";
+
+            test_eq("short strings pt1", allocation_counter::allocations, 0U);
+            test_eq("short strings pt2", str1.size(), 13U);
+            test("short strings pt3", str3.empty());
+        }
+        test_eq("short strings pt4", allocation_counter::deallocations, 0U);
+
+        allocation_counter::clear();
+        {
+            counted_string str1{"a string too long to be stored locally"};
+            test_eq("long strings pt1", allocation_counter::allocations, 1U);
+
+            counted_string str2{std::move(str1)};
+            test_eq("long strings pt2", allocation_counter::allocations, 1U);
+            test_eq("long strings pt3", str1.size(), 0U);
+
+            str1 = std::move(str2);
+            str1.swap(str2);
+            test_eq("long strings pt4", allocation_counter::allocations, 1U);
+            test_eq("long strings pt5", str2.size(), 38U);
+
+            str2.assign("short");
+            test_eq("long strings pt6", allocation_counter::allocations, 1U);
+
+            str2.shrink_to_fit();
+            test_eq("long strings pt7", allocation_counter::deallocations, 1U);
+        }
+        test_eq("long strings pt8", allocation_counter::deallocations, 1U);
+
+        allocation_counter::clear();
+        {
+            counted_string str{};
+            for (size_t i = 0; i < 1000; ++i)
+                str.push_back('a');
+
+            // Geometric growth, not an allocation per append.
+            test_eq("append pt1", str.size(), 1000U);
+            test("append pt2", allocation_counter::allocations <= 8U);
+        }
+        test_eq(
+            "append pt3", allocation_counter::allocations,
+            allocation_counter::deallocations
+        );
+    }
 }
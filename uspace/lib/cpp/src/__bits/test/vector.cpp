@@ -29,6 +29,8 @@
 #include <__bits/test/tests.hpp>
 #include <algorithm>
 #include <initializer_list>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -42,6 +44,7 @@ namespace std::test
         test_construction_and_assignment();
         test_insert();
         test_erase();
+        test_emplace();
 
         return end();
     }
@@ -227,4 +230,50 @@ namespace std::test
             check3.begin(), check3.end()
         );
     }
+
+    void vector_test::test_emplace()
+    {
+        std::vector<std::unique_ptr<int>> vec1{};
+        for (int i = 0; i < 10; ++i)
+            vec1.emplace_back(new int{i});
+        vec1.emplace(vec1.begin() + 5, new int{42});
+        test_eq("emplace_back move only size", vec1.size(), 11U);
+        test(
+            "emplace_back move only reallocation",
+            *vec1[0] == 0 && *vec1[4] == 4 && *vec1[10] == 9
+        );
+        test_eq("emplace move only", *vec1[5], 42);
+
+        std::vector<std::unique_ptr<int>> vec2{};
+        vec2.emplace_back(new int{1});
+        vec2.emplace(vec2.begin(), new int{0});
+        test(
+            "emplace at the front with reallocation",
+            *vec2[0] == 0 && *vec2[1] == 1
+        );
+
+        std::vector<std::string> vec3{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "b"};
+        vec3.push_back(vec3[0]);
+        test_eq("push_back own element", vec3[2], vec3[0]);
+
+        vec3.insert(vec3.begin(), vec3[1]);
+        test_eq("insert own element", vec3[0], std::string{"b"});
+        test_eq("insert own element shift", vec3[3], vec3[1]);
+
+        vec3.insert(vec3.begin() + 1, 2U, vec3[2]);
+        test_eq("fill insert own element", vec3[1], std::string{"b"});
+        test_eq("fill insert own element size", vec3.size(), 6U);
+
+        std::vector<std::string> vec4(3U, "abc");
+        vec4.resize(5U, "x");
+        vec4.resize(4U);
+        test_eq("resize size", vec4.size(), 4U);
+        test_eq("resize value", vec4[3], std::string{"x"});
+
+        vec4.reserve(100U);
+        test_eq("reserve capacity", vec4.capacity(), 100U);
+        test_eq("reserve keeps elements", vec4[0], std::string{"abc"});
+        vec4.shrink_to_fit();
+        test_eq("shrink_to_fit", vec4.capacity(), 4U);
+    }
 }
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/thread/thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace std::hel
+{
+    extern "C" {
+        #include <stats.h>
+        #include <stdlib.h>
+    }
+}
+
+namespace std::aux
+{
+    thread_pool& thread_pool::instance()
+    {
+        static thread_pool pool{};
+
+        return pool;
+    }
+
+    thread_pool::thread_pool()
+        : mtx_{}, cv_{}, head_{nullptr}, tail_{nullptr},
+          queued_{}, idle_{}, workers_{}, concurrency_{1}
+    {
+        threading::mutex::init(mtx_);
+        threading::condvar::init(cv_);
+
+        size_t cpus{};
+        auto stats = hel::stats_get_cpus(&cpus);
+        if (stats)
+            hel::free(stats);
+
+        /**
+         * The default number of runners is fine for std::async,
+         * but data parallel work should use all CPUs.
+         */
+        size_t runners{default_runners};
+        if (cpus > default_runners)
+            runners = 1 + static_cast<size_t>(hel::fibril_test_spawn_runners(cpus - 1));
+        else
+            hel::fibril_enable_multithreaded();
+
+        if (cpus > 0)
+            concurrency_ = min(cpus, runners);
+        else
+            concurrency_ = runners;
+    }
+
+    bool thread_pool::submit(pool_task* task)
+    {
+        if (!task)
+            return false;
+
+        threading::mutex::lock(mtx_);
+
+        if (idle_ <= queued_)
+        {
+            /**
+             * The new worker counts as idle from the start,
+             * so that subsequent submits do not spawn
+             * another one for this task.
+             */
+            auto fid = hel::fibril_create(worker_main, (void*)this);
+            if (!fid)
+            {
+                threading::mutex::unlock(mtx_);
+
+                return false;
+            }
+
+            ++idle_;
+            ++workers_;
+            threading::thread::start(fid);
+        }
+
+        task->next_ = nullptr;
+        if (tail_)
+            tail_->next_ = task;
+        else
+            head_ = task;
+        tail_ = task;
+        ++queued_;
+
+        threading::condvar::signal(cv_);
+        threading::mutex::unlock(mtx_);
+
+        return true;
+    }
+
+    size_t thread_pool::workers() const
+    {
+        threading::mutex::lock(mtx_);
+        auto res = workers_;
+        threading::mutex::unlock(mtx_);
+
+        return res;
+    }
+
+    size_t thread_pool::concurrency() const
+    {
+        // Set once in the constructor.
+        return concurrency_;
+    }
+
+    int thread_pool::worker_main(void* arg)
+    {
+        static_cast<thread_pool*>(arg)->worker_loop_();
+
+        return 0;
+    }
+
+    void thread_pool::worker_loop_()
+    {
+        threading::mutex::lock(mtx_);
+
+        while (true)
+        {
+            while (!head_)
+                threading::condvar::wait(cv_, mtx_);
+
+            auto task = head_;
+            head_ = task->next_;
+            if (!head_)
+                tail_ = nullptr;
+            --queued_;
+            --idle_;
+
+            threading::mutex::unlock(mtx_);
+
+            task->run();
+            delete task;
+
+            threading::mutex::lock(mtx_);
+
+            if (idle_ >= max_idle_workers)
+                break;
+            ++idle_;
+        }
+
+        --workers_;
+        threading::mutex::unlock(mtx_);
+    }
+
+    namespace
+    {
+        /**
+         * Range of chunks [begin, end) that belongs to one
+         * participant, packed into a single word so that the
+         * owner and thieves can update it with one CAS.
+         */
+        struct alignas(64) chunk_range
+        {
+            atomic<uint64_t> range;
+
+            static uint64_t pack(size_t begin, size_t end)
+            {
+                return (static_cast<uint64_t>(end) << 32) | static_cast<uint64_t>(begin);
+            }
+
+            static size_t begin(uint64_t range)
+            {
+                return static_cast<size_t>(range & 0xFFFF'FFFFULL);
+            }
+
+            static size_t end(uint64_t range)
+            {
+                return static_cast<size_t>(range >> 32);
+            }
+        };
+
+        class parallel_state
+        {
+            public:
+                parallel_state(size_t chunks, size_t participants,
+                               parallel_job::body_type body, void* arg)
+                    : body_{body}, arg_{arg}, participants_{participants},
+                      helpers_{}, mtx_{}, cv_{}
+                {
+                    threading::mutex::init(mtx_);
+                    threading::condvar::init(cv_);
+
+                    parallel_partition part{chunks, participants};
+                    for (size_t i = 0; i < participants; ++i)
+                    {
+                        ranges_[i].range.store(
+                            chunk_range::pack(part.begin(i), part.end(i)),
+                            memory_order_relaxed
+                        );
+                    }
+                }
+
+                void work(size_t self)
+                {
+                    do
+                    {
+                        size_t chunk{};
+                        while (pop_(self, chunk))
+                            body_(arg_, chunk);
+                    } while (steal_(self));
+                }
+
+                void helper_started()
+                {
+                    threading::mutex::lock(mtx_);
+                    ++helpers_;
+                    threading::mutex::unlock(mtx_);
+                }
+
+                void helper_finished()
+                {
+                    threading::mutex::lock(mtx_);
+                    if (--helpers_ == 0)
+                        threading::condvar::broadcast(cv_);
+                    threading::mutex::unlock(mtx_);
+                }
+
+                /**
+                 * The helpers keep a reference to this state,
+                 * so it cannot go away before they finish.
+                 */
+                void wait_for_helpers()
+                {
+                    threading::mutex::lock(mtx_);
+                    while (helpers_ > 0)
+                        threading::condvar::wait(cv_, mtx_);
+                    threading::mutex::unlock(mtx_);
+                }
+
+            private:
+                parallel_job::body_type body_;
+                void* arg_;
+
+                size_t participants_;
+                chunk_range ranges_[parallel_job::max_participants];
+
+                size_t helpers_;
+                mutex_t mtx_;
+                condvar_t cv_;
+
+                bool pop_(size_t self, size_t& chunk)
+                {
+                    auto& range = ranges_[self].range;
+                    auto old = range.load(memory_order_acquire);
+                    while (true)
+                    {
+                        auto begin = chunk_range::begin(old);
+                        auto end = chunk_range::end(old);
+                        if (begin >= end)
+                            return false;
+
+                        if (range.compare_exchange_weak(
+                            old, chunk_range::pack(begin + 1, end),
+                            memory_order_acq_rel, memory_order_acquire))
+                        {
+                            chunk = begin;
+
+                            return true;
+                        }
+                    }
+                }
+
+                /**
+                 * Takes the upper half of the chunks of the participant
+                 * with the most work left. Only the owner ever makes
+                 * its range non-empty, so nobody steals from us
+                 * while we publish the stolen chunks.
+                 */
+                bool steal_(size_t self)
+                {
+                    while (true)
+                    {
+                        size_t victim{participants_};
+                        size_t most{1};
+                        uint64_t old{};
+                        for (size_t i = 0; i < participants_; ++i)
+                        {
+                            auto range = ranges_[i].range.load(memory_order_acquire);
+                            auto left = chunk_range::end(range) - chunk_range::begin(range);
+                            if (i != self && left > most)
+                            {
+                                victim = i;
+                                most = left;
+                                old = range;
+                            }
+                        }
+
+                        // Single chunks are left to their owners.
+                        if (victim == participants_)
+                            return false;
+
+                        auto begin = chunk_range::begin(old);
+                        auto end = chunk_range::end(old);
+                        auto middle = begin + (end - begin) / 2;
+
+                        if (ranges_[victim].range.compare_exchange_strong(
+                            old, chunk_range::pack(begin, middle),
+                            memory_order_acq_rel, memory_order_acquire))
+                        {
+                            ranges_[self].range.store(
+                                chunk_range::pack(middle, end), memory_order_release
+                            );
+
+                            return true;
+                        }
+                    }
+                }
+        };
+
+        class parallel_task: public pool_task
+        {
+            public:
+                parallel_task(parallel_state& state, size_t idx)
+                    : state_{state}, idx_{idx}
+                { /* DUMMY BODY */ }
+
+                void run() override
+                {
+                    state_.work(idx_);
+                    state_.helper_finished();
+                }
+
+            private:
+                parallel_state& state_;
+                size_t idx_;
+        };
+    }
+
+    void parallel_job::run(size_t chunks, body_type body, void* arg)
+    {
+        auto& pool = thread_pool::instance();
+        auto participants = min(min(pool.concurrency(), chunks), max_participants);
+
+        if (participants <= 1)
+        {
+            for (size_t i = 0; i < chunks; ++i)
+                body(arg, i);
+
+            return;
+        }
+
+        parallel_state state{chunks, participants, body, arg};
+        size_t failed[max_participants];
+        size_t failed_count{};
+        for (size_t i = 1; i < participants; ++i)
+        {
+            state.helper_started();
+
+            auto task = new parallel_task{state, i};
+            if (!pool.submit(task))
+            {
+                delete task;
+                state.helper_finished();
+                failed[failed_count++] = i;
+            }
+        }
+
+        /**
+         * Others never steal the last chunk of a range,
+         * so we have to do the work of the helpers that
+         * could not be started ourselves.
+         */
+        state.work(0);
+        for (size_t i = 0; i < failed_count; ++i)
+            state.work(failed[i]);
+        state.wait_for_helpers();
+    }
+
+    size_t parallel_job::chunks_for(size_t count, size_t min_grain)
+    {
+        if (count < 2 * min_grain)
+            return 1;
+
+        auto participants = min(thread_pool::instance().concurrency(), max_participants);
+        if (participants <= 1)
+            return 1;
+
+        return min(min(count / min_grain, participants * chunks_per_participant), max_chunks);
+    }
+}
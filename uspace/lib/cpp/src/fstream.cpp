@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+
+namespace std::hel
+{
+    extern "C" {
+        #include <align.h>
+        #include <as.h>
+        #include <async.h>
+        #include <ns.h>
+        #include <vfs/vfs.h>
+    }
+}
+
+namespace std::aux
+{
+    int file::open(const char* name, ios_base::openmode mode)
+    {
+        /**
+         * See table 132, binary makes no difference
+         * and ate is handled by the caller.
+         */
+        int flags{hel::WALK_REGULAR};
+        int vfs_mode{};
+        bool truncate{false};
+
+        switch (mode & ~(ios_base::binary | ios_base::ate))
+        {
+            case ios_base::out:
+            case ios_base::out | ios_base::trunc:
+                flags |= hel::WALK_MAY_CREATE;
+                vfs_mode = hel::MODE_WRITE;
+                truncate = true;
+                break;
+            case ios_base::out | ios_base::app:
+            case ios_base::app:
+                flags |= hel::WALK_MAY_CREATE;
+                vfs_mode = hel::MODE_WRITE | hel::MODE_APPEND;
+                break;
+            case ios_base::in:
+                vfs_mode = hel::MODE_READ;
+                break;
+            case ios_base::in | ios_base::out:
+                vfs_mode = hel::MODE_READ | hel::MODE_WRITE;
+                break;
+            case ios_base::in | ios_base::out | ios_base::trunc:
+                flags |= hel::WALK_MAY_CREATE;
+                vfs_mode = hel::MODE_READ | hel::MODE_WRITE;
+                truncate = true;
+                break;
+            case ios_base::in | ios_base::out | ios_base::app:
+            case ios_base::in | ios_base::app:
+                flags |= hel::WALK_MAY_CREATE;
+                vfs_mode = hel::MODE_READ | hel::MODE_WRITE | hel::MODE_APPEND;
+                break;
+            default:
+                return invalid;
+        }
+
+        int fd{};
+        if (hel::vfs_lookup_open(name, flags, vfs_mode, &fd) != EOK)
+            return invalid;
+
+        if (truncate && hel::vfs_resize(fd, 0) != EOK)
+        {
+            hel::vfs_put(fd);
+
+            return invalid;
+        }
+
+        return fd;
+    }
+
+    void file::close(int fd)
+    {
+        hel::vfs_put(fd);
+    }
+
+    bool file::size(int fd, uint64_t& res)
+    {
+        hel::vfs_stat_t stat{};
+        if (hel::vfs_stat(fd, &stat) != EOK)
+            return false;
+
+        res = stat.size;
+
+        return true;
+    }
+
+    int64_t file::read(int fd, uint64_t pos, void* buf, size_t bytes)
+    {
+        hel::ssize_t res{};
+        if (hel::vfs_read_short(fd, pos, buf, bytes, &res) != EOK)
+            return -1;
+
+        return static_cast<int64_t>(res);
+    }
+
+    bool file::write(int fd, uint64_t pos, const void* buf, size_t bytes)
+    {
+        auto data = static_cast<const char*>(buf);
+        while (bytes > 0)
+        {
+            hel::ssize_t res{};
+            if (hel::vfs_write_short(fd, pos, data, bytes, &res) != EOK || res <= 0)
+                return false;
+
+            data += res;
+            pos += static_cast<uint64_t>(res);
+            bytes -= static_cast<size_t>(res);
+        }
+
+        return true;
+    }
+
+    void* file::map(int fd, size_t bytes, void*& pager)
+    {
+        auto sess = hel::service_connect_blocking(
+            hel::SERVICE_VFS, hel::INTERFACE_PAGER, 0
+        );
+        if (!sess)
+            return nullptr;
+
+        auto area = hel::async_as_area_create(
+            AS_AREA_ANY, ALIGN_UP(bytes, PAGE_SIZE),
+            AS_AREA_READ | AS_AREA_CACHEABLE, sess, fd, 0, 0
+        );
+        if (area == AS_MAP_FAILED)
+        {
+            hel::async_hangup(sess);
+
+            return nullptr;
+        }
+
+        pager = sess;
+
+        return area;
+    }
+
+    void file::unmap(void* area, void* pager)
+    {
+        hel::as_area_destroy(area);
+        hel::async_hangup(static_cast<hel::async_sess_t*>(pager));
+    }
+}
@@ -0,0 +1,439 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+
+namespace std::hel
+{
+    extern "C" {
+        #include <as.h>
+        #include <malloc.h>
+    }
+}
+
+namespace std::aux
+{
+    namespace
+    {
+        size_t align_up(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    void* allocate_chunk(pmr::memory_resource* upstream, chunk_footer*& head,
+                         size_t bytes, size_t alignment)
+    {
+        alignment = max(alignment, alignof(chunk_footer));
+
+        auto offset = align_up(bytes, alignof(chunk_footer));
+        auto total = offset + sizeof(chunk_footer);
+
+        auto start = upstream->allocate(total, alignment);
+        if (!start)
+            return nullptr;
+
+        auto footer = reinterpret_cast<chunk_footer*>(static_cast<char*>(start) + offset);
+        footer->next = head;
+        footer->start = start;
+        footer->bytes = total;
+        footer->alignment = alignment;
+        head = footer;
+
+        return start;
+    }
+
+    void release_chunks(pmr::memory_resource* upstream, chunk_footer*& head)
+    {
+        while (head)
+        {
+            // The footer is a part of the chunk.
+            auto chunk = *head;
+            upstream->deallocate(chunk.start, chunk.bytes, chunk.alignment);
+            head = chunk.next;
+        }
+    }
+}
+
+namespace std::pmr
+{
+    memory_resource::~memory_resource()
+    { /* DUMMY BODY */ }
+
+    namespace
+    {
+        class new_delete_memory_resource: public memory_resource
+        {
+            private:
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    if (bytes == 0)
+                        bytes = 1;
+
+                    if (alignment <= default_alignment)
+                        return hel::malloc(bytes);
+                    else
+                        return hel::memalign(alignment, bytes);
+                }
+
+                void do_deallocate(void* ptr, size_t, size_t) override
+                {
+                    hel::free(ptr);
+                }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        class null_memory_resource_t: public memory_resource
+        {
+            private:
+                void* do_allocate(size_t, size_t) override
+                {
+                    return nullptr;
+                }
+
+                void do_deallocate(void*, size_t, size_t) override
+                { /* DUMMY BODY */ }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        class area_memory_resource: public memory_resource
+        {
+            private:
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    // Areas are page aligned, that is all we can do.
+                    if (alignment > PAGE_SIZE)
+                        return nullptr;
+
+                    auto start = hel::as_area_create(
+                        AS_AREA_ANY, aux::align_up(max(bytes, size_t{1}), PAGE_SIZE),
+                        AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+                        AS_AREA_UNPAGED
+                    );
+
+                    return start == AS_MAP_FAILED ? nullptr : start;
+                }
+
+                void do_deallocate(void* ptr, size_t, size_t) override
+                {
+                    hel::as_area_destroy(ptr);
+                }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        atomic<memory_resource*> default_resource{nullptr};
+    }
+
+    memory_resource* new_delete_resource() noexcept
+    {
+        static new_delete_memory_resource res{};
+
+        return &res;
+    }
+
+    memory_resource* null_memory_resource() noexcept
+    {
+        static null_memory_resource_t res{};
+
+        return &res;
+    }
+
+    memory_resource* area_resource() noexcept
+    {
+        static area_memory_resource res{};
+
+        return &res;
+    }
+
+    memory_resource* set_default_resource(memory_resource* res) noexcept
+    {
+        if (!res)
+            res = new_delete_resource();
+
+        auto old = default_resource.exchange(res, memory_order_acq_rel);
+
+        return old ? old : new_delete_resource();
+    }
+
+    memory_resource* get_default_resource() noexcept
+    {
+        auto res = default_resource.load(memory_order_acquire);
+
+        return res ? res : new_delete_resource();
+    }
+
+    /**
+     * monotonic_buffer_resource:
+     */
+
+    monotonic_buffer_resource::monotonic_buffer_resource(size_t initial_size,
+                                                         memory_resource* upstream)
+        : upstream_{upstream}, initial_buffer_{nullptr}, initial_size_{},
+          current_{nullptr}, space_{}, next_size_{max(initial_size, size_t{1})},
+          chunks_{nullptr}
+    { /* DUMMY BODY */ }
+
+    monotonic_buffer_resource::monotonic_buffer_resource(void* buffer, size_t buffer_size,
+                                                         memory_resource* upstream)
+        : upstream_{upstream}, initial_buffer_{buffer}, initial_size_{buffer_size},
+          current_{static_cast<char*>(buffer)}, space_{buffer_size},
+          next_size_{max(buffer_size, size_t{1}) * growth_factor_}, chunks_{nullptr}
+    { /* DUMMY BODY */ }
+
+    monotonic_buffer_resource::~monotonic_buffer_resource()
+    {
+        release();
+    }
+
+    void monotonic_buffer_resource::release()
+    {
+        aux::release_chunks(upstream_, chunks_);
+
+        current_ = static_cast<char*>(initial_buffer_);
+        space_ = initial_size_;
+    }
+
+    void* monotonic_buffer_resource::do_allocate(size_t bytes, size_t alignment)
+    {
+        if (current_)
+        {
+            auto addr = reinterpret_cast<uintptr_t>(current_);
+            auto padding = static_cast<size_t>(-addr & (alignment - 1));
+
+            if (padding <= space_ && bytes <= space_ - padding)
+            {
+                auto res = current_ + padding;
+                current_ = res + bytes;
+                space_ -= padding + bytes;
+
+                return res;
+            }
+        }
+
+        auto size = max(next_size_, bytes);
+        auto chunk = aux::allocate_chunk(upstream_, chunks_, size, alignment);
+        if (!chunk)
+            return nullptr;
+
+        next_size_ = size * growth_factor_;
+
+        // The chunk is aligned, so the block goes to its start.
+        current_ = static_cast<char*>(chunk) + bytes;
+        space_ = size - bytes;
+
+        return chunk;
+    }
+
+    /**
+     * unsynchronized_pool_resource:
+     */
+
+    unsynchronized_pool_resource::unsynchronized_pool_resource(const pool_options& opts,
+                                                               memory_resource* upstream)
+        : upstream_{upstream}, options_{opts}, pools_{}, pool_count_{},
+          chunks_{nullptr}, oversized_{nullptr}
+    {
+        if (options_.max_blocks_per_chunk == 0)
+            options_.max_blocks_per_chunk = default_max_blocks_per_chunk_;
+        else if (options_.max_blocks_per_chunk < min_blocks_per_chunk_)
+            options_.max_blocks_per_chunk = min_blocks_per_chunk_;
+
+        if (options_.largest_required_pool_block == 0)
+            options_.largest_required_pool_block = default_largest_block_;
+
+        size_t largest{size_t{1} << min_block_shift_};
+        pool_count_ = 1;
+        while (largest < options_.largest_required_pool_block && pool_count_ < max_pools_)
+        {
+            largest <<= 1;
+            ++pool_count_;
+        }
+        options_.largest_required_pool_block = largest;
+
+        for (size_t i = 0; i < pool_count_; ++i)
+        {
+            pools_[i].free = nullptr;
+            pools_[i].next_blocks = min_blocks_per_chunk_;
+        }
+    }
+
+    unsynchronized_pool_resource::~unsynchronized_pool_resource()
+    {
+        release();
+    }
+
+    void unsynchronized_pool_resource::release()
+    {
+        while (oversized_)
+        {
+            auto footer = *oversized_;
+            upstream_->deallocate(footer.start, footer.bytes, footer.alignment);
+            oversized_ = footer.next;
+        }
+
+        aux::release_chunks(upstream_, chunks_);
+
+        for (size_t i = 0; i < pool_count_; ++i)
+        {
+            pools_[i].free = nullptr;
+            pools_[i].next_blocks = min_blocks_per_chunk_;
+        }
+    }
+
+    void* unsynchronized_pool_resource::do_allocate(size_t bytes, size_t alignment)
+    {
+        auto idx = pool_index_(bytes, alignment);
+        if (idx < pool_count_)
+        {
+            auto& pool = pools_[idx];
+            if (!pool.free && !refill_(idx))
+                return nullptr;
+
+            auto block = pool.free;
+            pool.free = block->next;
+
+            return block;
+        }
+
+        auto offset = oversized_offset_(bytes);
+        auto total = offset + sizeof(oversized_footer);
+        alignment = max(alignment, alignof(oversized_footer));
+
+        auto start = upstream_->allocate(total, alignment);
+        if (!start)
+            return nullptr;
+
+        auto footer = reinterpret_cast<oversized_footer*>(static_cast<char*>(start) + offset);
+        footer->prev = nullptr;
+        footer->next = oversized_;
+        footer->start = start;
+        footer->bytes = total;
+        footer->alignment = alignment;
+
+        if (oversized_)
+            oversized_->prev = footer;
+        oversized_ = footer;
+
+        return start;
+    }
+
+    void unsynchronized_pool_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+    {
+        auto idx = pool_index_(bytes, alignment);
+        if (idx < pool_count_)
+        {
+            auto block = static_cast<free_block*>(ptr);
+            block->next = pools_[idx].free;
+            pools_[idx].free = block;
+
+            return;
+        }
+
+        auto footer = reinterpret_cast<oversized_footer*>(
+            static_cast<char*>(ptr) + oversized_offset_(bytes)
+        );
+
+        if (footer->prev)
+            footer->prev->next = footer->next;
+        else
+            oversized_ = footer->next;
+
+        if (footer->next)
+            footer->next->prev = footer->prev;
+
+        upstream_->deallocate(footer->start, footer->bytes, footer->alignment);
+    }
+
+    size_t unsynchronized_pool_resource::pool_index_(size_t bytes, size_t alignment) const
+    {
+        // Chunks are at most page aligned, see refill_.
+        if (alignment > PAGE_SIZE)
+            return pool_count_;
+
+        auto size = max(bytes, alignment);
+
+        size_t idx{};
+        size_t block{size_t{1} << min_block_shift_};
+        while (block < size && idx < pool_count_)
+        {
+            block <<= 1;
+            ++idx;
+        }
+
+        return idx;
+    }
+
+    bool unsynchronized_pool_resource::refill_(size_t idx)
+    {
+        auto& pool = pools_[idx];
+        auto block_size = size_t{1} << (idx + min_block_shift_);
+        auto blocks = pool.next_blocks;
+
+        /**
+         * Blocks are aligned to their size (up to a page), so
+         * any alignment that fits in the block is satisfied.
+         */
+        auto chunk = static_cast<char*>(aux::allocate_chunk(
+            upstream_, chunks_, block_size * blocks,
+            min(block_size, static_cast<size_t>(PAGE_SIZE))
+        ));
+        if (!chunk)
+            return false;
+
+        for (size_t i = blocks; i > 0; --i)
+        {
+            auto block = reinterpret_cast<free_block*>(chunk + (i - 1) * block_size);
+            block->next = pool.free;
+            pool.free = block;
+        }
+
+        pool.next_blocks = min(blocks * 2, options_.max_blocks_per_chunk);
+
+        return true;
+    }
+
+    size_t unsynchronized_pool_resource::oversized_offset_(size_t bytes)
+    {
+        return aux::align_up(bytes, alignof(oversized_footer));
+    }
+}
@@ -37,6 +37,9 @@
 #include <stdlib.h>
 #include <byteorder.h>
 #include <align.h>
+#include <errno.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdbool.h>
 #include <pixconv.h>
 #include "tga.h"
@@ -91,41 +94,59 @@ typedef struct {
 	uint8_t img_alpha_bpp;
 	uint8_t img_alpha_dir;
 
-	void *id_data;
 	size_t id_length;
-
-	void *cmap_data;
 	size_t cmap_length;
-
-	void *img_data;
 	size_t img_length;
 } tga_t;
 
+/** Incremental TGA decoder
+ *
+ * The image rows are converted into the surface as soon as they
+ * are complete, so the encoded image does not need to be kept in
+ * memory as a whole. Only a partial row is buffered.
+ */
+struct tga_decoder {
+	/** Requested surface size (zero for the size of the image) */
+	surface_coord_t target_width;
+	surface_coord_t target_height;
+	surface_flags_t flags;
+
+	/** Header bytes received so far */
+	uint8_t head[sizeof(tga_header_t)];
+	size_t head_fill;
+
+	/** Decoded header */
+	tga_t tga;
+
+	/** Bytes of the image ID and color map still to be skipped */
+	size_t skip;
+
+	/** Encoded row and the number of its bytes received so far */
+	uint8_t *row;
+	size_t row_size;
+	size_t row_fill;
+
+	/** Number of rows decoded */
+	size_t rows;
+
+	/** Source column of each surface column (when scaling) */
+	size_t *xmap;
+
+	surface_t *surface;
+	bool failed;
+};
+
 /** Decode Truevision TGA header
  *
- * @param[in]  data Memory representation of TGA.
- * @param[in]  size Size of the representation (in bytes).
+ * @param[in]  head Header of the TGA.
  * @param[out] tga  Decoded TGA.
  *
- * @return True on succesful decoding.
- * @return False on failure.
- *
  */
-static bool decode_tga_header(void *data, size_t size, tga_t *tga)
+static void decode_tga_header(const tga_header_t *head, tga_t *tga)
 {
-	/* Header sanity check */
-	if (size < sizeof(tga_header_t))
-		return false;
-
-	tga_header_t *head = (tga_header_t *) data;
-
 	/* Image ID field */
-	tga->id_data = data + sizeof(tga_header_t);
 	tga->id_length = head->id_length;
 
-	if (size < sizeof(tga_header_t) + tga->id_length)
-		return false;
-
 	/* Color map type */
 	tga->cmap_type = head->cmap_type;
 
@@ -136,13 +157,8 @@ static bool decode_tga_header(void *data, size_t size, tga_t *tga)
 	tga->cmap_first_entry = uint16_t_le2host(head->cmap_first_entry);
 	tga->cmap_entries = uint16_t_le2host(head->cmap_entries);
 	tga->cmap_bpp = head->cmap_bpp;
-	tga->cmap_data = tga->id_data + tga->id_length;
 	tga->cmap_length = ALIGN_UP(tga->cmap_entries * tga->cmap_bpp, 8) >> 3;
 
-	if (size < sizeof(tga_header_t) + tga->id_length +
-	    tga->cmap_length)
-		return false;
-
 	/* Image specification */
 	tga->startx = uint16_t_le2host(head->startx);
 	tga->starty = uint16_t_le2host(head->starty);
@@ -151,110 +167,307 @@ static bool decode_tga_header(void *data, size_t size, tga_t *tga)
 	tga->img_bpp = head->img_bpp;
 	tga->img_alpha_bpp = head->img_descr & 0x0f;
 	tga->img_alpha_dir = (head->img_descr & 0xf0) >> 4;
-	tga->img_data = tga->cmap_data + tga->cmap_length;
 	tga->img_length = ALIGN_UP(tga->width * tga->height * tga->img_bpp, 8) >> 3;
-
-	if (size < sizeof(tga_header_t) + tga->id_length +
-	    tga->cmap_length + tga->img_length)
-		return false;
-
-	return true;
 }
 
-/** Decode Truevision TGA format
+/** Check the decoded header and create the surface
  *
- * Decode Truevision TGA format and create a surface
- * from it. The supported variants of TGA are currently
- * limited to uncompressed 24 bit true-color images without
- * alpha channel.
+ * The supported variants of TGA are currently limited to
+ * uncompressed 24 bit true-color and 8 bit grayscale images
+ * without alpha channel.
  *
- * @param[in] data  Memory representation of TGA.
- * @param[in] size  Size of the representation (in bytes).
- * @param[in] flags Surface creation flags.
+ * @param decoder TGA decoder with a complete header.
  *
- * @return Newly allocated surface with the decoded content.
- * @return NULL on error or unsupported format.
+ * @return True on success.
+ * @return False on error or unsupported format.
  *
  */
-surface_t *decode_tga(void *data, size_t size, surface_flags_t flags)
+static bool tga_decoder_setup(tga_decoder_t *decoder)
 {
-	tga_t tga;
-	if (!decode_tga_header(data, size, &tga))
-		return NULL;
-
-	/*
-	 * Check for unsupported features.
-	 */
+	tga_t *tga = &decoder->tga;
 
-	switch (tga.cmap_type) {
+	switch (tga->cmap_type) {
 	case CMAP_NOT_PRESENT:
 		break;
 	default:
 		/* Unsupported */
-		return NULL;
+		return false;
 	}
 
-	switch (tga.img_type) {
+	switch (tga->img_type) {
 	case IMG_BGRA:
-		if (tga.img_bpp != 24)
-			return NULL;
+		if (tga->img_bpp != 24)
+			return false;
 		break;
 	case IMG_GRAY:
-		if (tga.img_bpp != 8)
-			return NULL;
+		if (tga->img_bpp != 8)
+			return false;
 		break;
 	default:
 		/* Unsupported */
-		return NULL;
+		return false;
 	}
 
-	if (tga.img_alpha_bpp != 0)
-		return NULL;
+	if (tga->img_alpha_bpp != 0)
+		return false;
+
+	sysarg_t twidth = tga->startx + tga->width;
+	sysarg_t theight = tga->starty + tga->height;
+
+	if (decoder->target_width == 0 || decoder->target_height == 0) {
+		decoder->target_width = twidth;
+		decoder->target_height = theight;
+	}
+
+	decoder->row_size = tga->width * (tga->img_bpp >> 3);
+	decoder->row = malloc(decoder->row_size);
+	if (decoder->row == NULL)
+		return false;
+
+	if (decoder->target_width != twidth ||
+	    decoder->target_height != theight) {
+		decoder->xmap = malloc(decoder->target_width * sizeof(size_t));
+		if (decoder->xmap == NULL)
+			return false;
+
+		for (sysarg_t x = 0; x < decoder->target_width; x++) {
+			decoder->xmap[x] =
+			    ((uint64_t) x * twidth) / decoder->target_width;
+		}
+	}
+
+	decoder->surface = surface_create(decoder->target_width,
+	    decoder->target_height, NULL, decoder->flags);
+	if (decoder->surface == NULL)
+		return false;
+
+	decoder->skip = tga->id_length + tga->cmap_length;
+	return true;
+}
+
+/** Convert one encoded row into the surface
+ *
+ * TGA is encoded in a bottom-up manner, the true-color
+ * variant is in BGR 8:8:8 encoding.
+ *
+ * @param decoder TGA decoder.
+ * @param data    Encoded row.
+ *
+ */
+static void tga_decoder_row(tga_decoder_t *decoder, uint8_t *data)
+{
+	tga_t *tga = &decoder->tga;
+	pixelmap_t *pixmap = surface_pixmap_access(decoder->surface);
+	sysarg_t theight = tga->starty + tga->height;
+	size_t bpp = tga->img_bpp >> 3;
+
+	/* Row of the unscaled image */
+	uint64_t y = tga->height - decoder->rows - 1;
+
+	/* Surface rows showing it */
+	sysarg_t first = (y * decoder->target_height + theight - 1) / theight;
+	sysarg_t last = ((y + 1) * decoder->target_height + theight - 1) / theight;
+	if (first >= last)
+		return;
+
+	pixel_t *dst = pixmap->data + first * pixmap->width;
+
+	if (decoder->xmap == NULL) {
+		dst += tga->startx;
+		for (sysarg_t x = 0; x < tga->width; x++) {
+			dst[x] = (tga->img_type == IMG_BGRA) ?
+			    bgr_888_2pixel(data + x * bpp) :
+			    gray_8_2pixel(data + x * bpp);
+		}
+
+		dst -= tga->startx;
+	} else {
+		for (sysarg_t x = 0; x < decoder->target_width; x++) {
+			size_t sx = decoder->xmap[x];
+			if (sx < tga->startx)
+				continue;
+
+			uint8_t *src = data + (sx - tga->startx) * bpp;
+			dst[x] = (tga->img_type == IMG_BGRA) ?
+			    bgr_888_2pixel(src) : gray_8_2pixel(src);
+		}
+	}
 
-	sysarg_t twidth = tga.startx + tga.width;
-	sysarg_t theight = tga.starty + tga.height;
+	for (sysarg_t row = first + 1; row < last; row++) {
+		memcpy(pixmap->data + row * pixmap->width, dst,
+		    pixmap->width * sizeof(pixel_t));
+	}
+}
 
-	surface_t *surface = surface_create(twidth, theight, NULL, flags);
-	if (surface == NULL)
+/** Create incremental TGA decoder
+ *
+ * @param[in] width  Width of the decoded surface, the image is scaled
+ *                   to it. Zero for the width of the image.
+ * @param[in] height Height of the decoded surface (zero for the height
+ *                   of the image).
+ * @param[in] flags  Surface creation flags.
+ *
+ * @return New decoder or NULL if out of memory.
+ *
+ */
+tga_decoder_t *tga_decoder_create(surface_coord_t width,
+    surface_coord_t height, surface_flags_t flags)
+{
+	tga_decoder_t *decoder = calloc(1, sizeof(tga_decoder_t));
+	if (decoder == NULL)
 		return NULL;
 
-	/*
-	 * TGA is encoded in a bottom-up manner, the true-color
-	 * variant is in BGR 8:8:8 encoding.
-	 */
+	decoder->target_width = width;
+	decoder->target_height = height;
+	decoder->flags = flags;
+	return decoder;
+}
 
-	switch (tga.img_type) {
-	case IMG_BGRA:
-		for (sysarg_t y = tga.starty; y < theight; y++) {
-			for (sysarg_t x = tga.startx; x < twidth; x++) {
-				size_t offset =
-				    ((y - tga.starty) * tga.width + (x - tga.startx)) * 3;
-
-				pixel_t pixel =
-				    bgr_888_2pixel(((uint8_t *) tga.img_data) + offset);
-				surface_put_pixel(surface, x, theight - y - 1, pixel);
-			}
+/** Pass encoded data to incremental TGA decoder
+ *
+ * Data following the image are ignored.
+ *
+ * @param[in] decoder TGA decoder.
+ * @param[in] data    Next part of the memory representation of TGA.
+ * @param[in] size    Size of the part (in bytes).
+ *
+ * @return EOK on success.
+ * @return ENOTSUP on invalid or unsupported format.
+ *
+ */
+errno_t tga_decoder_feed(tga_decoder_t *decoder, const void *data, size_t size)
+{
+	const uint8_t *src = (const uint8_t *) data;
+
+	if (decoder->failed)
+		return ENOTSUP;
+
+	if (decoder->head_fill < sizeof(tga_header_t)) {
+		size_t len = min(size, sizeof(tga_header_t) - decoder->head_fill);
+		memcpy(decoder->head + decoder->head_fill, src, len);
+		decoder->head_fill += len;
+		src += len;
+		size -= len;
+
+		if (decoder->head_fill < sizeof(tga_header_t))
+			return EOK;
+
+		decode_tga_header((tga_header_t *) decoder->head, &decoder->tga);
+		if (!tga_decoder_setup(decoder)) {
+			decoder->failed = true;
+			return ENOTSUP;
 		}
-		break;
-	case IMG_GRAY:
-		for (sysarg_t y = tga.starty; y < theight; y++) {
-			for (sysarg_t x = tga.startx; x < twidth; x++) {
-				size_t offset =
-				    (y - tga.starty) * tga.width + (x - tga.startx);
-
-				pixel_t pixel =
-				    gray_8_2pixel(((uint8_t *) tga.img_data) + offset);
-				surface_put_pixel(surface, x, theight - y - 1, pixel);
+	}
+
+	size_t len = min(size, decoder->skip);
+	decoder->skip -= len;
+	src += len;
+	size -= len;
+
+	while (size > 0 && decoder->rows < decoder->tga.height) {
+		if (decoder->row_fill == 0 && size >= decoder->row_size) {
+			/* Convert complete rows without copying them */
+			tga_decoder_row(decoder, (uint8_t *) src);
+			len = decoder->row_size;
+		} else {
+			len = min(size, decoder->row_size - decoder->row_fill);
+			memcpy(decoder->row + decoder->row_fill, src, len);
+			decoder->row_fill += len;
+			if (decoder->row_fill < decoder->row_size) {
+				src += len;
+				size -= len;
+				continue;
 			}
+
+			tga_decoder_row(decoder, decoder->row);
+			decoder->row_fill = 0;
 		}
-		break;
-	default:
-		break;
+
+		decoder->rows++;
+		src += len;
+		size -= len;
 	}
 
+	return EOK;
+}
+
+/** Finish incremental TGA decoding
+ *
+ * The decoder is destroyed.
+ *
+ * @param[in] decoder TGA decoder.
+ *
+ * @return Newly allocated surface with the decoded content.
+ * @return NULL on error, unsupported format or incomplete image.
+ *
+ */
+surface_t *tga_decoder_finish(tga_decoder_t *decoder)
+{
+	surface_t *surface = decoder->surface;
+
+	if (decoder->failed || decoder->head_fill < sizeof(tga_header_t) ||
+	    decoder->skip > 0 || decoder->rows < decoder->tga.height) {
+		if (surface != NULL)
+			surface_destroy(surface);
+		surface = NULL;
+	} else {
+		surface_add_damaged_region(surface, 0, 0,
+		    decoder->target_width, decoder->target_height);
+	}
+
+	free(decoder->xmap);
+	free(decoder->row);
+	free(decoder);
 	return surface;
 }
 
+/** Decode Truevision TGA format at the given size
+ *
+ * Decode Truevision TGA format and create a surface of the
+ * given size from it. The image is scaled while it is decoded,
+ * so no surface of its original size is ever allocated.
+ *
+ * @param[in] data   Memory representation of TGA.
+ * @param[in] size   Size of the representation (in bytes).
+ * @param[in] width  Width of the surface (zero for the image width).
+ * @param[in] height Height of the surface (zero for the image height).
+ * @param[in] flags  Surface creation flags.
+ *
+ * @return Newly allocated surface with the decoded content.
+ * @return NULL on error or unsupported format.
+ *
+ */
+surface_t *decode_tga_scaled(void *data, size_t size, surface_coord_t width,
+    surface_coord_t height, surface_flags_t flags)
+{
+	tga_decoder_t *decoder = tga_decoder_create(width, height, flags);
+	if (decoder == NULL)
+		return NULL;
+
+	(void) tga_decoder_feed(decoder, data, size);
+	return tga_decoder_finish(decoder);
+}
+
+/** Decode Truevision TGA format
+ *
+ * Decode Truevision TGA format and create a surface
+ * from it. The supported variants of TGA are currently
+ * limited to uncompressed 24 bit true-color and 8 bit
+ * grayscale images without alpha channel.
+ *
+ * @param[in] data  Memory representation of TGA.
+ * @param[in] size  Size of the representation (in bytes).
+ * @param[in] flags Surface creation flags.
+ *
+ * @return Newly allocated surface with the decoded content.
+ * @return NULL on error or unsupported format.
+ *
+ */
+surface_t *decode_tga(void *data, size_t size, surface_flags_t flags)
+{
+	return decode_tga_scaled(data, size, 0, 0, flags);
+}
+
 /** Encode Truevision TGA format
  *
  * Encode Truevision TGA format into an array.
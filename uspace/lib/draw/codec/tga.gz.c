@@ -35,10 +35,47 @@
 
 #include <errno.h>
 #include <gzip.h>
-#include <stdlib.h>
 #include "tga.gz.h"
 #include "tga.h"
 
+static errno_t decode_tga_gz_sink(void *arg, const void *data, size_t size)
+{
+	return tga_decoder_feed((tga_decoder_t *) arg, data, size);
+}
+
+/** Decode gzipped Truevision TGA format at the given size
+ *
+ * The data are inflated straight into the TGA decoder, so the
+ * uncompressed image is never kept in memory as a whole.
+ *
+ * @param[in] data   Memory representation of gzipped TGA.
+ * @param[in] size   Size of the representation (in bytes).
+ * @param[in] width  Width of the surface (zero for the image width).
+ * @param[in] height Height of the surface (zero for the image height).
+ * @param[in] flags  Surface creation flags.
+ *
+ * @return Newly allocated surface with the decoded content.
+ * @return NULL on error or unsupported format.
+ *
+ */
+surface_t *decode_tga_gz_scaled(void *data, size_t size, surface_coord_t width,
+    surface_coord_t height, surface_flags_t flags)
+{
+	tga_decoder_t *decoder = tga_decoder_create(width, height, flags);
+	if (decoder == NULL)
+		return NULL;
+
+	errno_t ret = gzip_expand_stream(data, size, decode_tga_gz_sink,
+	    decoder);
+	surface_t *surface = tga_decoder_finish(decoder);
+	if (ret != EOK && surface != NULL) {
+		surface_destroy(surface);
+		return NULL;
+	}
+
+	return surface;
+}
+
 /** Decode gzipped Truevision TGA format
  *
  * Decode gzipped Truevision TGA format and create a surface
@@ -55,17 +92,7 @@
  */
 surface_t *decode_tga_gz(void *data, size_t size, surface_flags_t flags)
 {
-	void *data_expanded;
-	size_t size_expanded;
-
-	errno_t ret = gzip_expand(data, size, &data_expanded, &size_expanded);
-	if (ret != EOK)
-		return NULL;
-
-	surface_t *surface = decode_tga(data_expanded, size_expanded, flags);
-
-	free(data_expanded);
-	return surface;
+	return decode_tga_gz_scaled(data, size, 0, 0, flags);
 }
 
 /** Encode gzipped Truevision TGA format
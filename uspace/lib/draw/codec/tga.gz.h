@@ -40,6 +40,8 @@
 #include "../surface.h"
 
 extern surface_t *decode_tga_gz(void *, size_t, surface_flags_t);
+extern surface_t *decode_tga_gz_scaled(void *, size_t, surface_coord_t,
+    surface_coord_t, surface_flags_t);
 extern bool encode_tga_gz(surface_t *, void **, size_t *);
 
 #endif
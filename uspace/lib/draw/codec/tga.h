@@ -37,10 +37,21 @@
 #ifndef DRAW_CODEC_TGA_H_
 #define DRAW_CODEC_TGA_H_
 
+#include <errno.h>
 #include <stddef.h>
 #include "../surface.h"
 
+struct tga_decoder;
+typedef struct tga_decoder tga_decoder_t;
+
+extern tga_decoder_t *tga_decoder_create(surface_coord_t, surface_coord_t,
+    surface_flags_t);
+extern errno_t tga_decoder_feed(tga_decoder_t *, const void *, size_t);
+extern surface_t *tga_decoder_finish(tga_decoder_t *);
+
 extern surface_t *decode_tga(void *, size_t, surface_flags_t);
+extern surface_t *decode_tga_scaled(void *, size_t, surface_coord_t,
+    surface_coord_t, surface_flags_t);
 extern bool encode_tga(surface_t *, void **, size_t *);
 
 #endif
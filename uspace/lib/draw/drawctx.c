@@ -35,10 +35,15 @@
 
 #include <assert.h>
 #include <adt/list.h>
+#include <macros.h>
+#include <rectangle.h>
 #include <stdlib.h>
 
 #include "drawctx.h"
 
+/** Maximal number of pixels composed at once by drawctx_transfer(). */
+#define TRANSFER_SPAN  256
+
 void drawctx_init(drawctx_t *context, surface_t *surface)
 {
 	assert(surface);
@@ -121,6 +126,55 @@ void drawctx_set_font(drawctx_t *context, font_t *font)
 	context->font = font;
 }
 
+/** Transfer an untransformed texture row by row. */
+static bool transfer_direct(drawctx_t *context, compose_span_t compose,
+    sysarg_t x, sysarg_t y, sysarg_t width, sysarg_t height)
+{
+	source_t *source = context->source;
+	if (!source_is_fast(source))
+		return false;
+
+	/* The whole area has to be covered by the texture. */
+	pixel_t *src = source_direct_access(source, x, y);
+	if (!src || !source_direct_access(source, x + width - 1, y + height - 1))
+		return false;
+
+	sysarg_t src_scanline = surface_pixmap_access(source->texture)->width;
+	pixelmap_t *pixmap = surface_pixmap_access(context->surface);
+
+	for (sysarg_t _y = y; _y < y + height; ++_y) {
+		compose(pixelmap_pixel_at(pixmap, x, _y), src, width);
+		src += src_scanline;
+	}
+
+	return true;
+}
+
+/** Transfer a single color row by row. */
+static bool transfer_solid(drawctx_t *context,
+    sysarg_t x, sysarg_t y, sysarg_t width, sysarg_t height)
+{
+	source_t *source = context->source;
+	if (!source_is_solid(source))
+		return false;
+
+	void (*fill)(pixel_t *, pixel_t, size_t);
+	if (context->compose == compose_src)
+		fill = compose_fill_src;
+	else if (context->compose == compose_over)
+		fill = compose_fill_over;
+	else
+		return false;
+
+	pixel_t color = source_determine_pixel(source, x, y);
+	pixelmap_t *pixmap = surface_pixmap_access(context->surface);
+
+	for (sysarg_t _y = y; _y < y + height; ++_y)
+		fill(pixelmap_pixel_at(pixmap, x, _y), color, width);
+
+	return true;
+}
+
 void drawctx_transfer(drawctx_t *context,
     sysarg_t x, sysarg_t y, sysarg_t width, sysarg_t height)
 {
@@ -128,51 +182,59 @@ void drawctx_transfer(drawctx_t *context,
 		return;
 	}
 
-	bool transfer_fast = source_is_fast(context->source) &&
-	    (context->shall_clip == false) &&
-	    (context->mask == NULL) &&
-	    (context->compose == compose_src || context->compose == compose_over);
+	/* Only the part inside the surface and the clipping area is drawn. */
+	sysarg_t surface_width;
+	sysarg_t surface_height;
+	surface_get_resolution(context->surface, &surface_width, &surface_height);
+	if (!rectangle_intersect(x, y, width, height,
+	    0, 0, surface_width, surface_height, &x, &y, &width, &height)) {
+		return;
+	}
 
-	if (transfer_fast) {
+	if (context->shall_clip && !rectangle_intersect(x, y, width, height,
+	    context->clip_x, context->clip_y,
+	    context->clip_width, context->clip_height,
+	    &x, &y, &width, &height)) {
+		return;
+	}
 
-		for (sysarg_t _y = y; _y < y + height; ++_y) {
-			pixel_t *src = source_direct_access(context->source, x, _y);
-			pixel_t *dst = pixelmap_pixel_at(surface_pixmap_access(context->surface), x, _y);
-			if (src && dst) {
-				sysarg_t count = width;
-				while (count-- != 0) {
-					*dst++ = *src++;
-				}
-			}
-		}
-		surface_add_damaged_region(context->surface, x, y, width, height);
+	compose_span_t compose = compose_get_span(context->compose);
+	bool transfer_fast = (compose != NULL) && (context->mask == NULL) &&
+	    (transfer_direct(context, compose, x, y, width, height) ||
+	    transfer_solid(context, x, y, width, height));
 
-	} else {
+	if (!transfer_fast) {
+		pixelmap_t *pixmap = surface_pixmap_access(context->surface);
+		pixel_t span[TRANSFER_SPAN];
 
-		bool clipped = false;
-		bool masked = false;
 		for (sysarg_t _y = y; _y < y + height; ++_y) {
-			for (sysarg_t _x = x; _x < x + width; ++_x) {
-				if (context->shall_clip) {
-					clipped = _x < context->clip_x && _x >= context->clip_width &&
-					    _y < context->clip_y && _y >= context->clip_height;
-				}
+			pixel_t *dst = pixelmap_pixel_at(pixmap, x, _y);
 
-				if (context->mask) {
-					pixel_t p = surface_get_pixel(context->mask, _x, _y);
-					masked = p > 0 ? false : true;
-				}
+			for (sysarg_t done = 0; done < width; ) {
+				size_t count = min(width - done, (sysarg_t) TRANSFER_SPAN);
+				source_determine_span(context->source, x + done, _y,
+				    count, span);
 
-				if (!clipped && !masked) {
-					pixel_t p_src = source_determine_pixel(context->source, _x, _y);
-					pixel_t p_dst = surface_get_pixel(context->surface, _x, _y);
-					pixel_t p_res = context->compose(p_src, p_dst);
-					surface_put_pixel(context->surface, _x, _y, p_res);
+				if (compose && !context->mask) {
+					compose(dst + done, span, count);
+				} else {
+					for (size_t i = 0; i < count; ++i) {
+						if (context->mask && surface_get_pixel(
+						    context->mask, x + done + i, _y) == 0) {
+							continue;
+						}
+
+						dst[done + i] = context->compose(span[i],
+						    dst[done + i]);
+					}
 				}
+
+				done += count;
 			}
 		}
-
 	}
+
+	surface_add_damaged_region(context->surface, x, y, width, height);
 }
 
 void drawctx_stroke(drawctx_t *context, path_t *path)
@@ -35,14 +35,39 @@
  */
 
 #include <errno.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 
 #include "../font.h"
 #include "../drawctx.h"
 #include "bitmap_backend.h"
 
+/** Minimal size of an atlas page. */
+#define ATLAS_WIDTH   256
+#define ATLAS_HEIGHT  256
+
+/** Page of the glyph atlas.
+ *
+ * Glyph masks are packed into shelves: rows of glyphs that are filled
+ * from left to right, a new shelf starting below the tallest glyph of
+ * the previous one. Bitmap fonts have glyphs of similar heights, so
+ * little space is wasted.
+ */
 typedef struct {
 	surface_t *surface;
+	surface_coord_t width;
+	surface_coord_t height;
+	surface_coord_t shelf_x;
+	surface_coord_t shelf_y;
+	surface_coord_t shelf_height;
+} atlas_page_t;
+
+typedef struct {
+	/** Atlas page with the glyph mask or NULL if not loaded yet */
+	surface_t *atlas;
+	surface_coord_t atlas_x;
+	surface_coord_t atlas_y;
 	glyph_metrics_t metrics;
 	bool metrics_loaded;
 } glyph_cache_item_t;
@@ -52,6 +77,8 @@ typedef struct {
 	uint32_t glyph_count;
 	font_metrics_t font_metrics;
 	glyph_cache_item_t *glyph_cache;
+	atlas_page_t *atlas;
+	size_t atlas_count;
 	bitmap_font_decoder_t *decoder;
 	void *decoder_data;
 	bool scale;
@@ -112,17 +139,61 @@ static errno_t bb_get_glyph_metrics(void *backend_data, glyph_id_t glyph_id,
 	return EOK;
 }
 
-static errno_t get_glyph_surface(bitmap_backend_data_t *data, glyph_id_t glyph_id,
-    surface_t **result)
+/** Reserve a width x height area in the glyph atlas. */
+static errno_t atlas_alloc(bitmap_backend_data_t *data, surface_coord_t width,
+    surface_coord_t height, surface_t **surface, surface_coord_t *x,
+    surface_coord_t *y)
 {
-	if (glyph_id >= data->glyph_count)
-		return ENOENT;
+	atlas_page_t *page = NULL;
 
-	if (data->glyph_cache[glyph_id].surface != NULL) {
-		*result = data->glyph_cache[glyph_id].surface;
-		return EOK;
+	if (data->atlas_count > 0) {
+		page = &data->atlas[data->atlas_count - 1];
+
+		if (page->shelf_x + width > page->width) {
+			page->shelf_y += page->shelf_height;
+			page->shelf_x = 0;
+			page->shelf_height = 0;
+		}
+
+		if ((page->shelf_x + width > page->width) ||
+		    (page->shelf_y + height > page->height))
+			page = NULL;
+	}
+
+	if (page == NULL) {
+		atlas_page_t *atlas = realloc(data->atlas,
+		    (data->atlas_count + 1) * sizeof(atlas_page_t));
+		if (atlas == NULL)
+			return ENOMEM;
+
+		data->atlas = atlas;
+		page = &atlas[data->atlas_count];
+
+		page->width = max(width, (surface_coord_t) ATLAS_WIDTH);
+		page->height = max(height, (surface_coord_t) ATLAS_HEIGHT);
+		page->surface = surface_create(page->width, page->height, NULL, 0);
+		if (page->surface == NULL)
+			return ENOMEM;
+
+		page->shelf_x = 0;
+		page->shelf_y = 0;
+		page->shelf_height = 0;
+		data->atlas_count++;
 	}
 
+	*surface = page->surface;
+	*x = page->shelf_x;
+	*y = page->shelf_y;
+
+	page->shelf_x += width;
+	page->shelf_height = max(page->shelf_height, height);
+	return EOK;
+}
+
+/** Rasterize a glyph (scaled to the font size). */
+static errno_t load_glyph_surface(bitmap_backend_data_t *data,
+    glyph_id_t glyph_id, surface_t **result)
+{
 	surface_t *raw_surface;
 	errno_t rc = data->decoder->load_glyph_surface(data->decoder_data, glyph_id,
 	    &raw_surface);
@@ -165,11 +236,67 @@ static errno_t get_glyph_surface(bitmap_backend_data_t *data, glyph_id_t glyph_i
 
 	surface_destroy(raw_surface);
 
-	data->glyph_cache[glyph_id].surface = scaled_surface;
 	*result = scaled_surface;
 	return EOK;
 }
 
+/** Make sure the glyph mask is in the atlas.
+ *
+ * The area reserved for the glyph covers both the rasterized glyph
+ * and its metrics, so that rendering never samples the neighbours.
+ */
+static errno_t get_glyph_atlas(bitmap_backend_data_t *data,
+    glyph_id_t glyph_id, glyph_cache_item_t **result)
+{
+	if (glyph_id >= data->glyph_count)
+		return ENOENT;
+
+	glyph_cache_item_t *item = &data->glyph_cache[glyph_id];
+	if (item->atlas != NULL) {
+		*result = item;
+		return EOK;
+	}
+
+	glyph_metrics_t gm;
+	errno_t rc = bb_get_glyph_metrics(data, glyph_id, &gm);
+	if (rc != EOK)
+		return rc;
+
+	surface_t *glyph_surface;
+	rc = load_glyph_surface(data, glyph_id, &glyph_surface);
+	if (rc != EOK)
+		return rc;
+
+	sysarg_t w;
+	sysarg_t h;
+	surface_get_resolution(glyph_surface, &w, &h);
+
+	surface_coord_t x;
+	surface_coord_t y;
+	surface_t *atlas;
+	rc = atlas_alloc(data, max(w, (sysarg_t) gm.width),
+	    max(h, (sysarg_t) gm.height), &atlas, &x, &y);
+	if (rc != EOK) {
+		surface_destroy(glyph_surface);
+		return rc;
+	}
+
+	pixelmap_t *src = surface_pixmap_access(glyph_surface);
+	pixelmap_t *dst = surface_pixmap_access(atlas);
+	for (sysarg_t row = 0; row < h; row++) {
+		memcpy(pixelmap_pixel_at(dst, x, y + row),
+		    pixelmap_pixel_at(src, 0, row), w * sizeof(pixel_t));
+	}
+
+	surface_destroy(glyph_surface);
+
+	item->atlas = atlas;
+	item->atlas_x = x;
+	item->atlas_y = y;
+	*result = item;
+	return EOK;
+}
+
 static errno_t bb_render_glyph(void *backend_data, drawctx_t *context,
     source_t *source, sysarg_t ox, sysarg_t oy, glyph_id_t glyph_id)
 {
@@ -180,19 +307,21 @@ static errno_t bb_render_glyph(void *backend_data, drawctx_t *context,
 	if (rc != EOK)
 		return rc;
 
-	surface_t *glyph_surface;
-	rc = get_glyph_surface(data, glyph_id, &glyph_surface);
+	glyph_cache_item_t *item;
+	rc = get_glyph_atlas(data, glyph_id, &item);
 	if (rc != EOK)
 		return rc;
 
 	native_t x = ox + glyph_metrics.left_side_bearing;
 	native_t y = oy - glyph_metrics.ascender;
 
+	/* Map the glyph position to the glyph mask in the atlas. */
 	transform_t transform;
 	transform_identity(&transform);
-	transform_translate(&transform, x, y);
+	transform_translate(&transform, x - (native_t) item->atlas_x,
+	    y - (native_t) item->atlas_y);
 	source_set_transform(source, transform);
-	source_set_mask(source, glyph_surface, false);
+	source_set_mask(source, item->atlas, false);
 	drawctx_transfer(context, x, y, glyph_metrics.width,
 	    glyph_metrics.height);
 
@@ -203,11 +332,10 @@ static void bb_release(void *backend_data)
 {
 	bitmap_backend_data_t *data = (bitmap_backend_data_t *) backend_data;
 
-	for (size_t i = 0; i < data->glyph_count; ++i) {
-		if (data->glyph_cache[i].surface) {
-			surface_destroy(data->glyph_cache[i].surface);
-		}
-	}
+	for (size_t i = 0; i < data->atlas_count; ++i)
+		surface_destroy(data->atlas[i].surface);
+
+	free(data->atlas);
 	free(data->glyph_cache);
 
 	data->decoder->release(data->decoder_data);
@@ -262,10 +390,13 @@ errno_t bitmap_font_create(bitmap_font_decoder_t *decoder, void *decoder_data,
 	}
 
 	for (size_t i = 0; i < data->glyph_count; ++i) {
-		data->glyph_cache[i].surface = NULL;
+		data->glyph_cache[i].atlas = NULL;
 		data->glyph_cache[i].metrics_loaded = false;
 	}
 
+	data->atlas = NULL;
+	data->atlas_count = 0;
+
 	font_t *font = font_create(&bitmap_backend, data);
 	if (font == NULL) {
 		free(data->glyph_cache);
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup draw
+ * @{
+ */
+/**
+ * @file Decoded image cache
+ *
+ * Applications tend to load the same icons and backgrounds over and
+ * over again. The cache keeps the decoded surfaces of recently loaded
+ * image files, so that a repeated load costs just a copy of the pixels.
+ * The least recently used images are dropped once the decoded pixels
+ * exceed the memory budget.
+ *
+ * The file system does not report modification times, so the cached
+ * image is considered stale if the path no longer refers to the same
+ * file node or if the size of the file has changed.
+ */
+
+#include <adt/list.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <str.h>
+#include <vfs/vfs.h>
+#include "codec/tga.gz.h"
+#include "codec/tga.h"
+#include "image_cache.h"
+
+typedef struct {
+	link_t link;
+
+	/** Key */
+	char *path;
+	surface_coord_t width;
+	surface_coord_t height;
+
+	/** Identity of the file the image was decoded from */
+	service_id_t service_id;
+	fs_index_t index;
+	aoff64_t size;
+
+	/** Decoded image */
+	surface_t *surface;
+	size_t bytes;
+} image_cache_entry_t;
+
+static FIBRIL_MUTEX_INITIALIZE(image_cache_lock);
+
+/** Cached images, the most recently used first */
+static LIST_INITIALIZE(image_cache_list);
+
+static size_t image_cache_bytes = 0;
+static size_t image_cache_budget = IMAGE_CACHE_BUDGET;
+
+/** Duplicate a surface
+ *
+ * @param surface Surface to copy.
+ * @param flags   Flags of the new surface.
+ *
+ * @return New surface with the same content or NULL if out of memory.
+ *
+ */
+static surface_t *image_copy(surface_t *surface, surface_flags_t flags)
+{
+	surface_coord_t width;
+	surface_coord_t height;
+	surface_get_resolution(surface, &width, &height);
+
+	surface_t *copy = surface_create(width, height, NULL, flags);
+	if (copy == NULL)
+		return NULL;
+
+	memcpy(surface_direct_access(copy), surface_direct_access(surface),
+	    width * height * sizeof(pixel_t));
+	surface_add_damaged_region(copy, 0, 0, width, height);
+	return copy;
+}
+
+static void image_cache_remove(image_cache_entry_t *entry)
+{
+	list_remove(&entry->link);
+	image_cache_bytes -= entry->bytes;
+
+	surface_destroy(entry->surface);
+	free(entry->path);
+	free(entry);
+}
+
+/** Drop the least recently used images until there is enough room
+ *
+ * @param bytes Room needed.
+ *
+ */
+static void image_cache_evict(size_t bytes)
+{
+	while (image_cache_bytes + bytes > image_cache_budget &&
+	    !list_empty(&image_cache_list)) {
+		image_cache_remove(list_get_instance(list_last(&image_cache_list),
+		    image_cache_entry_t, link));
+	}
+}
+
+/** Find cached image
+ *
+ * A stale image found in the cache is dropped.
+ *
+ * @return Cached image or NULL.
+ *
+ */
+static image_cache_entry_t *image_cache_find(const char *path,
+    surface_coord_t width, surface_coord_t height, vfs_stat_t *stat)
+{
+	list_foreach(image_cache_list, link, image_cache_entry_t, entry) {
+		if (entry->width != width || entry->height != height ||
+		    str_cmp(entry->path, path) != 0)
+			continue;
+
+		if (entry->service_id != stat->service_id ||
+		    entry->index != stat->index || entry->size != stat->size) {
+			image_cache_remove(entry);
+			return NULL;
+		}
+
+		return entry;
+	}
+
+	return NULL;
+}
+
+/** Remember decoded image
+ *
+ * @param surface Decoded image, the cache keeps a copy of it.
+ *
+ */
+static void image_cache_insert(const char *path, surface_coord_t width,
+    surface_coord_t height, vfs_stat_t *stat, surface_t *surface)
+{
+	surface_coord_t swidth;
+	surface_coord_t sheight;
+	surface_get_resolution(surface, &swidth, &sheight);
+
+	size_t bytes = swidth * sheight * sizeof(pixel_t);
+	if (bytes > image_cache_budget)
+		return;
+
+	/* Another fibril might have loaded the same image meanwhile */
+	if (image_cache_find(path, width, height, stat) != NULL)
+		return;
+
+	image_cache_entry_t *entry = calloc(1, sizeof(image_cache_entry_t));
+	if (entry == NULL)
+		return;
+
+	entry->path = str_dup(path);
+	entry->surface = image_copy(surface, SURFACE_FLAG_NONE);
+	if (entry->path == NULL || entry->surface == NULL) {
+		if (entry->surface != NULL)
+			surface_destroy(entry->surface);
+		free(entry->path);
+		free(entry);
+		return;
+	}
+
+	entry->width = width;
+	entry->height = height;
+	entry->service_id = stat->service_id;
+	entry->index = stat->index;
+	entry->size = stat->size;
+	entry->bytes = bytes;
+
+	image_cache_evict(bytes);
+	list_prepend(&entry->link, &image_cache_list);
+	image_cache_bytes += bytes;
+}
+
+/** Decode image file
+ *
+ * Both plain and gzipped TGA images are recognized.
+ *
+ * @return Newly allocated surface or NULL on error.
+ *
+ */
+static surface_t *image_decode(int fd, vfs_stat_t *stat,
+    surface_coord_t width, surface_coord_t height, surface_flags_t flags)
+{
+	if (stat->size > SIZE_MAX)
+		return NULL;
+
+	void *data = malloc(stat->size);
+	if (data == NULL)
+		return NULL;
+
+	size_t nread;
+	errno_t rc = vfs_read(fd, (aoff64_t []) { 0 }, data, stat->size,
+	    &nread);
+	if (rc != EOK || nread != stat->size) {
+		free(data);
+		return NULL;
+	}
+
+	surface_t *surface;
+	uint8_t *magic = (uint8_t *) data;
+	if (nread >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+		surface = decode_tga_gz_scaled(data, nread, width, height,
+		    flags);
+	} else {
+		surface = decode_tga_scaled(data, nread, width, height, flags);
+	}
+
+	free(data);
+	return surface;
+}
+
+/** Load image file through the cache
+ *
+ * @param path   Path of the image file.
+ * @param width  Width to scale the image to (zero for the image width).
+ * @param height Height to scale the image to (zero for the image height).
+ * @param flags  Surface creation flags.
+ *
+ * @return Newly allocated surface owned by the caller.
+ * @return NULL on error or unsupported format.
+ *
+ */
+surface_t *image_cache_load(const char *path, surface_coord_t width,
+    surface_coord_t height, surface_flags_t flags)
+{
+	int fd;
+	errno_t rc = vfs_lookup_open(path, WALK_REGULAR, MODE_READ, &fd);
+	if (rc != EOK)
+		return NULL;
+
+	vfs_stat_t stat;
+	rc = vfs_stat(fd, &stat);
+	if (rc != EOK) {
+		vfs_put(fd);
+		return NULL;
+	}
+
+	fibril_mutex_lock(&image_cache_lock);
+
+	image_cache_entry_t *entry = image_cache_find(path, width, height,
+	    &stat);
+	if (entry != NULL) {
+		list_remove(&entry->link);
+		list_prepend(&entry->link, &image_cache_list);
+
+		surface_t *surface = image_copy(entry->surface, flags);
+		fibril_mutex_unlock(&image_cache_lock);
+		vfs_put(fd);
+		return surface;
+	}
+
+	fibril_mutex_unlock(&image_cache_lock);
+
+	surface_t *surface = image_decode(fd, &stat, width, height, flags);
+	vfs_put(fd);
+	if (surface == NULL)
+		return NULL;
+
+	fibril_mutex_lock(&image_cache_lock);
+	image_cache_insert(path, width, height, &stat, surface);
+	fibril_mutex_unlock(&image_cache_lock);
+
+	return surface;
+}
+
+/** Set memory budget of the cache
+ *
+ * @param budget Maximal size of the cached pixels (in bytes),
+ *               zero disables the cache.
+ *
+ */
+void image_cache_set_budget(size_t budget)
+{
+	fibril_mutex_lock(&image_cache_lock);
+	image_cache_budget = budget;
+	image_cache_evict(0);
+	fibril_mutex_unlock(&image_cache_lock);
+}
+
+/** Drop all cached images */
+void image_cache_flush(void)
+{
+	fibril_mutex_lock(&image_cache_lock);
+	while (!list_empty(&image_cache_list)) {
+		image_cache_remove(list_get_instance(list_first(&image_cache_list),
+		    image_cache_entry_t, link));
+	}
+	fibril_mutex_unlock(&image_cache_lock);
+}
+
+/** @}
+ */
@@ -34,6 +34,7 @@
  */
 
 #include <assert.h>
+#include <macros.h>
 
 #include "source.h"
 
@@ -99,6 +100,11 @@ bool source_is_fast(source_t *source)
 	    (transform_is_fast(&source->transform)));
 }
 
+bool source_is_solid(source_t *source)
+{
+	return ((source->mask == NULL) && (source->texture == NULL));
+}
+
 pixel_t *source_direct_access(source_t *source, double x, double y)
 {
 	assert(source_is_fast(source));
@@ -148,5 +154,107 @@ pixel_t source_determine_pixel(source_t *source, double x, double y)
 	}
 }
 
+/** Scale the alpha of a pixel by an 8-bit mask value. */
+static inline pixel_t apply_mask(pixel_t pix, uint32_t mask)
+{
+	if (mask == 0)
+		return 0;
+
+	if (mask < 255)
+		return PIXEL(ALPHA(pix) * mask / 255, RED(pix), GREEN(pix), BLUE(pix));
+
+	return pix;
+}
+
+/** Number of mask pixels sampled at once by source_determine_span(). */
+#define SOURCE_MASK_SPAN  64
+
+/** Determine a span of source pixels in a row.
+ *
+ * Yields the same pixels as source_determine_pixel() called for
+ * count consecutive pixels starting at x, y (up to the precision
+ * of the fixed point sampling). The transformation is applied only
+ * to the first pixel and the texture and mask are sampled by the
+ * span versions of the filter.
+ *
+ * @param source Source.
+ * @param x      Horizontal coordinate of the first pixel.
+ * @param y      Vertical coordinate of the row.
+ * @param count  Number of pixels.
+ * @param dst    Buffer for the pixels.
+ */
+void source_determine_span(source_t *source, sysarg_t x, sysarg_t y,
+    size_t count, pixel_t *dst)
+{
+	if (source_is_solid(source)) {
+		pixel_t color = source_determine_pixel(source, x, y);
+		for (size_t i = 0; i < count; i++)
+			dst[i] = color;
+		return;
+	}
+
+	filter_span_t filter = filter_get_span(source->filter);
+	if (filter == NULL) {
+		for (size_t i = 0; i < count; i++)
+			dst[i] = source_determine_pixel(source, x + i, y);
+		return;
+	}
+
+	double start_x = x;
+	double start_y = y;
+	transform_apply_affine(&source->transform, &start_x, &start_y);
+
+	filter_span_pos_t pos = {
+		.x = filter_fixed(start_x),
+		.y = filter_fixed(start_y),
+		.dx = filter_fixed(source->transform.matrix[0][0]),
+		.dy = filter_fixed(source->transform.matrix[1][0])
+	};
+
+	if (source->texture) {
+		filter(surface_pixmap_access(source->texture), &pos, count,
+		    source->texture_extend, dst);
+	} else {
+		for (size_t i = 0; i < count; i++)
+			dst[i] = source->color;
+	}
+
+	if ((source->mask) && (transform_is_fast(&source->transform)) &&
+	    (start_x >= 0) && (start_y >= 0)) {
+		/* Untransformed masks (e.g. glyphs) are read in place. */
+		pixelmap_t *pixmap = surface_pixmap_access(source->mask);
+		pixel_t *mask = pixelmap_pixel_at(pixmap,
+		    (sysarg_t) start_x, (sysarg_t) start_y);
+		pixel_t *mask_last = pixelmap_pixel_at(pixmap,
+		    (sysarg_t) start_x + count - 1, (sysarg_t) start_y);
+
+		if ((mask) && (mask_last)) {
+			for (size_t i = 0; i < count; i++)
+				dst[i] = apply_mask(dst[i], ALPHA(mask[i]));
+			return;
+		}
+	}
+
+	if (source->mask) {
+		pixel_t mask[SOURCE_MASK_SPAN];
+
+		for (size_t done = 0; done < count; ) {
+			size_t chunk = min(count - done, (size_t) SOURCE_MASK_SPAN);
+
+			filter(surface_pixmap_access(source->mask), &pos, chunk,
+			    source->mask_extend, mask);
+			for (size_t i = 0; i < chunk; i++)
+				dst[done + i] = apply_mask(dst[done + i], ALPHA(mask[i]));
+
+			pos.x += (int64_t) chunk * pos.dx;
+			pos.y += (int64_t) chunk * pos.dy;
+			done += chunk;
+		}
+	} else if (ALPHA(source->alpha) < 255) {
+		for (size_t i = 0; i < count; i++)
+			dst[i] = apply_mask(dst[i], ALPHA(source->alpha));
+	}
+}
+
 /** @}
  */
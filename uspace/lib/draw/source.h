@@ -37,6 +37,7 @@
 #define DRAW_SOURCE_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <transform.h>
 #include <filter.h>
@@ -71,8 +72,11 @@ extern void source_set_alpha(source_t *, pixel_t);
 extern void source_set_mask(source_t *, surface_t *, pixelmap_extend_t);
 
 extern bool source_is_fast(source_t *);
+extern bool source_is_solid(source_t *);
 extern pixel_t *source_direct_access(source_t *, double, double);
 extern pixel_t source_determine_pixel(source_t *, double, double);
+extern void source_determine_span(source_t *, sysarg_t, sysarg_t, size_t,
+    pixel_t *);
 
 #endif
 
@@ -92,14 +92,29 @@ surface_t *surface_create(surface_coord_t width, surface_coord_t height,
 	return surface;
 }
 
+/** Create a surface that draws into the pixels of another surface.
+ *
+ * The view tracks its damaged region separately, so that several
+ * threads can draw into disjoint parts of the same pixels. The original
+ * surface must not be destroyed before the view.
+ */
+surface_t *surface_create_view(surface_t *orig)
+{
+	return surface_create(orig->pixmap.width, orig->pixmap.height,
+	    orig->pixmap.data, SURFACE_FLAG_VIEW);
+}
+
 void surface_destroy(surface_t *surface)
 {
 	pixel_t *pixbuf = surface->pixmap.data;
 
-	if ((surface->flags & SURFACE_FLAG_SHARED) == SURFACE_FLAG_SHARED)
-		as_area_destroy((void *) pixbuf);
-	else
-		free(pixbuf);
+	/* Pixels of a view are owned by the original surface. */
+	if ((surface->flags & SURFACE_FLAG_VIEW) != SURFACE_FLAG_VIEW) {
+		if ((surface->flags & SURFACE_FLAG_SHARED) == SURFACE_FLAG_SHARED)
+			as_area_destroy((void *) pixbuf);
+		else
+			free(pixbuf);
+	}
 
 	free(surface);
 }
@@ -47,10 +47,13 @@ typedef sysarg_t surface_coord_t;
 
 typedef enum {
 	SURFACE_FLAG_NONE = 0,
-	SURFACE_FLAG_SHARED = 1
+	SURFACE_FLAG_SHARED = 1,
+	/** Pixels are owned by another surface (see surface_create_view). */
+	SURFACE_FLAG_VIEW = 2
 } surface_flags_t;
 
 extern surface_t *surface_create(surface_coord_t, surface_coord_t, pixel_t *, surface_flags_t);
+extern surface_t *surface_create_view(surface_t *);
 extern void surface_destroy(surface_t *);
 
 extern bool surface_is_shared(surface_t *);
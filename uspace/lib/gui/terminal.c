@@ -34,6 +34,8 @@
  */
 
 #include <errno.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <io/chargrid.h>
 #include <surface.h>
@@ -59,6 +61,36 @@
 #define TERM_CAPS \
 	(CONSOLE_CAP_STYLE | CONSOLE_CAP_INDEXED | CONSOLE_CAP_RGB)
 
+/** Number of colour pairs with expanded font rows kept by a terminal. */
+#define TERM_PALETTES  8
+
+/** Number of distinct font rows (one bit per pixel). */
+#define TERM_PALETTE_ROWS  (1 << FONT_WIDTH)
+
+/** Maximal number of cells of a run drawn at once. */
+#define TERM_SPAN_CELLS  32
+
+/** Font rows expanded to pixels in a colour pair.
+ *
+ * Drawing a glyph row then amounts to copying the expanded row
+ * indexed by the font bitmap row.
+ */
+struct term_palette {
+	pixel_t bgcolor;
+	pixel_t fgcolor;
+	bool valid;
+	pixel_t rows[TERM_PALETTE_ROWS][FONT_WIDTH];
+};
+
+/** Cells changed by an update, drawn row by row and damaged at once. */
+typedef struct {
+	sysarg_t first_col;
+	sysarg_t first_row;
+	sysarg_t last_col;
+	sysarg_t last_row;
+	bool empty;
+} term_dirty_t;
+
 static LIST_INITIALIZE(terms);
 
 static errno_t term_open(con_srvs_t *, con_srv_t *);
@@ -163,78 +195,315 @@ static inline void attrs_rgb(char_attrs_t attrs, pixel_t *bgcolor, pixel_t *fgco
 	}
 }
 
+/** Find (or build) the expanded font rows for a colour pair. */
+static term_palette_t *term_palette_get(terminal_t *term, pixel_t bgcolor,
+    pixel_t fgcolor)
+{
+	term_palette_t *palette = term->palettes;
+
+	for (size_t i = 0; i < TERM_PALETTES; i++) {
+		if ((palette[i].valid) && (palette[i].bgcolor == bgcolor) &&
+		    (palette[i].fgcolor == fgcolor))
+			return &palette[i];
+	}
+
+	/* Colour pairs are replaced round-robin. */
+	term_palette_t *slot = &palette[term->palette_next];
+	term->palette_next = (term->palette_next + 1) % TERM_PALETTES;
+
+	for (unsigned int bits = 0; bits < TERM_PALETTE_ROWS; bits++) {
+		for (unsigned int x = 0; x < FONT_WIDTH; x++) {
+			slot->rows[bits][x] =
+			    (bits & (1 << (FONT_WIDTH - 1 - x))) ? fgcolor : bgcolor;
+		}
+	}
+
+	slot->bgcolor = bgcolor;
+	slot->fgcolor = fgcolor;
+	slot->valid = true;
+	return slot;
+}
+
+/** Draw a run of cells of a row.
+ *
+ * Consecutive cells in the same colours share the expanded font
+ * rows, so every scanline of the run is assembled by copying whole
+ * glyph rows. The damage is left to the caller, who knows the extent
+ * of all the runs drawn in one update.
+ */
+static void term_update_span(terminal_t *term, surface_t *surface,
+    sysarg_t sx, sysarg_t sy, sysarg_t col, sysarg_t row, sysarg_t count)
+{
+	/* Only cells that fit into the surface as a whole are drawn. */
+	sysarg_t width;
+	sysarg_t height;
+	surface_get_resolution(surface, &width, &height);
+
+	if ((sx >= width) || (sy >= height))
+		return;
+
+	sysarg_t by = sy + (row * FONT_SCANLINES);
+	if (by + FONT_SCANLINES > height)
+		return;
+
+	sysarg_t cols = (width - sx) / FONT_WIDTH;
+	if (col >= cols)
+		return;
+
+	count = min(count, cols - col);
+
+	pixelmap_t *pixmap = surface_pixmap_access(surface);
+	sysarg_t cursor_col;
+	sysarg_t cursor_row;
+	chargrid_get_cursor(term->backbuf, &cursor_col, &cursor_row);
+
+	sysarg_t end = col + count;
+	while (col < end) {
+		charfield_t *field = chargrid_charfield_at(term->backbuf, col, row);
+		bool inverted = chargrid_cursor_at(term->backbuf, col, row);
+		char_attrs_t attrs = field->attrs;
+
+		/* Extend the run while the colours stay the same. */
+		sysarg_t run = 1;
+		if (!inverted) {
+			while ((col + run < end) && ((row != cursor_row) ||
+			    (col + run != cursor_col))) {
+				charfield_t *next = chargrid_charfield_at(
+				    term->backbuf, col + run, row);
+				if (!attrs_same(next->attrs, attrs))
+					break;
+
+				run++;
+			}
+		}
+
+		pixel_t bgcolor = 0;
+		pixel_t fgcolor = 0;
+
+		if (inverted)
+			attrs_rgb(attrs, &fgcolor, &bgcolor);
+		else
+			attrs_rgb(attrs, &bgcolor, &fgcolor);
+
+		term_palette_t *palette = term_palette_get(term, bgcolor,
+		    fgcolor);
+
+		// FIXME: Glyph type should be actually uint32_t
+		//        for full UTF-32 coverage.
+
+		uint16_t glyphs[TERM_SPAN_CELLS];
+		sysarg_t done = 0;
+		while (done < run) {
+			sysarg_t chunk = min(run - done, (sysarg_t) TERM_SPAN_CELLS);
+
+			for (sysarg_t i = 0; i < chunk; i++) {
+				charfield_t *cell = chargrid_charfield_at(
+				    term->backbuf, col + done + i, row);
+				glyphs[i] = fb_font_glyph(cell->ch, NULL);
+			}
+
+			sysarg_t bx = sx + ((col + done) * FONT_WIDTH);
+			for (unsigned int y = 0; y < FONT_SCANLINES; y++) {
+				pixel_t *dst = pixelmap_pixel_at(pixmap, bx, by + y);
+
+				for (sysarg_t i = 0; i < chunk; i++) {
+					memcpy(dst, palette->rows[fb_font[glyphs[i]][y]],
+					    sizeof(palette->rows[0]));
+					dst += FONT_WIDTH;
+				}
+			}
+
+			done += chunk;
+		}
+
+		col += run;
+	}
+}
+
+/** Draw a single cell and damage it. */
 static void term_update_char(terminal_t *term, surface_t *surface,
     sysarg_t sx, sysarg_t sy, sysarg_t col, sysarg_t row)
 {
-	charfield_t *field =
+	term_update_span(term, surface, sx, sy, col, row, 1);
+	surface_add_damaged_region(surface, sx + (col * FONT_WIDTH),
+	    sy + (row * FONT_SCANLINES), FONT_WIDTH, FONT_SCANLINES);
+}
+
+static void term_dirty_init(term_dirty_t *dirty)
+{
+	dirty->empty = true;
+}
+
+/** Draw the run of cells from first_col to last_col and note it. */
+static void term_dirty_span(terminal_t *term, surface_t *surface,
+    sysarg_t sx, sysarg_t sy, sysarg_t row, sysarg_t first_col,
+    sysarg_t last_col, term_dirty_t *dirty)
+{
+	term_update_span(term, surface, sx, sy, first_col, row,
+	    last_col - first_col + 1);
+
+	if (dirty->empty) {
+		dirty->first_col = first_col;
+		dirty->first_row = row;
+		dirty->last_col = last_col;
+		dirty->last_row = row;
+		dirty->empty = false;
+		return;
+	}
+
+	dirty->first_col = min(dirty->first_col, first_col);
+	dirty->first_row = min(dirty->first_row, row);
+	dirty->last_col = max(dirty->last_col, last_col);
+	dirty->last_row = max(dirty->last_row, row);
+}
+
+/** Damage the bounding box of all the cells drawn. */
+static bool term_dirty_damage(term_dirty_t *dirty, surface_t *surface,
+    sysarg_t sx, sysarg_t sy)
+{
+	if (dirty->empty)
+		return false;
+
+	surface_add_damaged_region(surface,
+	    sx + (dirty->first_col * FONT_WIDTH),
+	    sy + (dirty->first_row * FONT_SCANLINES),
+	    (dirty->last_col - dirty->first_col + 1) * FONT_WIDTH,
+	    (dirty->last_row - dirty->first_row + 1) * FONT_SCANLINES);
+	return true;
+}
+
+/** Copy a cell from the front buffer to the back buffer.
+ *
+ * @param dirty_only Only copy the cell if it is marked dirty.
+ *
+ * @return True if the back buffer cell changed.
+ */
+static bool term_sync_cell(terminal_t *term, sysarg_t col, sysarg_t row,
+    bool dirty_only)
+{
+	charfield_t *front_field =
+	    chargrid_charfield_at(term->frontbuf, col, row);
+	charfield_t *back_field =
 	    chargrid_charfield_at(term->backbuf, col, row);
+	bool update = false;
 
-	bool inverted = chargrid_cursor_at(term->backbuf, col, row);
+	if ((dirty_only) &&
+	    ((front_field->flags & CHAR_FLAG_DIRTY) != CHAR_FLAG_DIRTY))
+		return false;
 
-	sysarg_t bx = sx + (col * FONT_WIDTH);
-	sysarg_t by = sy + (row * FONT_SCANLINES);
+	if (front_field->ch != back_field->ch) {
+		back_field->ch = front_field->ch;
+		update = true;
+	}
+
+	if (!attrs_same(front_field->attrs, back_field->attrs)) {
+		back_field->attrs = front_field->attrs;
+		update = true;
+	}
+
+	front_field->flags &= ~CHAR_FLAG_DIRTY;
+	return update;
+}
+
+/** Synchronize the back buffer with the front buffer and redraw.
+ *
+ * Changed cells are drawn as one run per row, from the first to the
+ * last changed cell of the row.
+ *
+ * @param dirty_only  Only consider cells marked dirty.
+ * @param redraw_from Redraw all cells of this and the following rows,
+ *                    changed or not.
+ */
+static void term_sync_rows(terminal_t *term, surface_t *surface,
+    sysarg_t sx, sysarg_t sy, bool dirty_only, sysarg_t redraw_from,
+    term_dirty_t *dirty)
+{
+	for (sysarg_t row = 0; row < term->rows; row++) {
+		bool redraw = (row >= redraw_from);
+		sysarg_t first_col = term->cols;
+		sysarg_t last_col = 0;
 
-	pixel_t bgcolor = 0;
-	pixel_t fgcolor = 0;
-
-	if (inverted)
-		attrs_rgb(field->attrs, &fgcolor, &bgcolor);
-	else
-		attrs_rgb(field->attrs, &bgcolor, &fgcolor);
-
-	// FIXME: Glyph type should be actually uint32_t
-	//        for full UTF-32 coverage.
-
-	uint16_t glyph = fb_font_glyph(field->ch, NULL);
-
-	for (unsigned int y = 0; y < FONT_SCANLINES; y++) {
-		pixel_t *dst = pixelmap_pixel_at(
-		    surface_pixmap_access(surface), bx, by + y);
-		pixel_t *dst_max = pixelmap_pixel_at(
-		    surface_pixmap_access(surface), bx + FONT_WIDTH - 1, by + y);
-		if (!dst || !dst_max)
-			continue;
-		int count = FONT_WIDTH;
-		while (count-- != 0) {
-			*dst++ = (fb_font[glyph][y] & (1 << count)) ? fgcolor : bgcolor;
+		for (sysarg_t col = 0; col < term->cols; col++) {
+			if (term_sync_cell(term, col, row, dirty_only) || redraw) {
+				if (first_col == term->cols)
+					first_col = col;
+				last_col = col;
+			}
 		}
+
+		if (first_col < term->cols)
+			term_dirty_span(term, surface, sx, sy, row, first_col,
+			    last_col, dirty);
+	}
+}
+
+/** Move the drawn cells up by the given number of rows.
+ *
+ * The back buffer is cyclic, so it is scrolled just by moving its
+ * top row. The rows that appear at the bottom still hold the rows
+ * that disappeared at the top and have to be redrawn.
+ *
+ * @return False if the cells are not entirely visible and were
+ *         not moved.
+ */
+static bool term_scroll(terminal_t *term, surface_t *surface,
+    sysarg_t sx, sysarg_t sy, sysarg_t rows)
+{
+	sysarg_t width;
+	sysarg_t height;
+	surface_get_resolution(surface, &width, &height);
+
+	sysarg_t w = term->cols * FONT_WIDTH;
+	sysarg_t h = term->rows * FONT_SCANLINES;
+	if ((sx + w > width) || (sy + h > height))
+		return false;
+
+	pixelmap_t *pixmap = surface_pixmap_access(surface);
+	sysarg_t shift = rows * FONT_SCANLINES;
+
+	for (sysarg_t y = 0; y < h - shift; y++) {
+		memcpy(pixelmap_pixel_at(pixmap, sx, sy + y),
+		    pixelmap_pixel_at(pixmap, sx, sy + y + shift),
+		    w * sizeof(pixel_t));
 	}
-	surface_add_damaged_region(surface, bx, by, FONT_WIDTH, FONT_SCANLINES);
+
+	term->backbuf->top_row = (term->backbuf->top_row + rows) % term->rows;
+	surface_add_damaged_region(surface, sx, sy, w, h);
+	return true;
 }
 
 static bool term_update_scroll(terminal_t *term, surface_t *surface,
-    sysarg_t sx, sysarg_t sy)
+    sysarg_t sx, sysarg_t sy, term_dirty_t *dirty)
 {
 	sysarg_t top_row = chargrid_get_top_row(term->frontbuf);
 
 	if (term->top_row == top_row)
 		return false;
 
+	/*
+	 * The contents of the front buffer moved up, so the pixels are
+	 * moved as well and only the new rows at the bottom are drawn
+	 * (besides the cells that changed otherwise).
+	 */
+	sysarg_t rows = (top_row + term->rows - term->top_row) % term->rows;
 	term->top_row = top_row;
 
-	for (sysarg_t row = 0; row < term->rows; row++) {
-		for (sysarg_t col = 0; col < term->cols; col++) {
-			charfield_t *front_field =
-			    chargrid_charfield_at(term->frontbuf, col, row);
-			charfield_t *back_field =
-			    chargrid_charfield_at(term->backbuf, col, row);
-			bool update = false;
-
-			if (front_field->ch != back_field->ch) {
-				back_field->ch = front_field->ch;
-				update = true;
-			}
+	if (!term_scroll(term, surface, sx, sy, rows)) {
+		term_sync_rows(term, surface, sx, sy, false, term->rows, dirty);
+		return true;
+	}
 
-			if (!attrs_same(front_field->attrs, back_field->attrs)) {
-				back_field->attrs = front_field->attrs;
-				update = true;
-			}
+	term_sync_rows(term, surface, sx, sy, false, term->rows - rows, dirty);
 
-			front_field->flags &= ~CHAR_FLAG_DIRTY;
+	/* The image of the cursor moved along with the other pixels. */
+	if (chargrid_get_cursor_visibility(term->backbuf)) {
+		sysarg_t col;
+		sysarg_t row;
+		chargrid_get_cursor(term->backbuf, &col, &row);
 
-			if (update)
-				term_update_char(term, surface, sx, sy, col, row);
-		}
+		term_update_char(term, surface, sx, sy, col, row);
+		if (row >= rows)
+			term_update_char(term, surface, sx, sy, col, row - rows);
 	}
 
 	return true;
@@ -291,40 +560,14 @@ static void term_update(terminal_t *term)
 	sysarg_t sx = term->widget.hpos;
 	sysarg_t sy = term->widget.vpos;
 
-	if (term_update_scroll(term, surface, sx, sy)) {
-		damage = true;
-	} else {
-		for (sysarg_t y = 0; y < term->rows; y++) {
-			for (sysarg_t x = 0; x < term->cols; x++) {
-				charfield_t *front_field =
-				    chargrid_charfield_at(term->frontbuf, x, y);
-				charfield_t *back_field =
-				    chargrid_charfield_at(term->backbuf, x, y);
-				bool update = false;
-
-				if ((front_field->flags & CHAR_FLAG_DIRTY) ==
-				    CHAR_FLAG_DIRTY) {
-					if (front_field->ch != back_field->ch) {
-						back_field->ch = front_field->ch;
-						update = true;
-					}
-
-					if (!attrs_same(front_field->attrs,
-					    back_field->attrs)) {
-						back_field->attrs = front_field->attrs;
-						update = true;
-					}
-
-					front_field->flags &= ~CHAR_FLAG_DIRTY;
-				}
+	term_dirty_t dirty;
+	term_dirty_init(&dirty);
 
-				if (update) {
-					term_update_char(term, surface, sx, sy, x, y);
-					damage = true;
-				}
-			}
-		}
-	}
+	if (!term_update_scroll(term, surface, sx, sy, &dirty))
+		term_sync_rows(term, surface, sx, sy, true, term->rows, &dirty);
+
+	if (term_dirty_damage(&dirty, surface, sx, sy))
+		damage = true;
 
 	if (term_update_cursor(term, surface, sx, sy))
 		damage = true;
@@ -351,23 +594,14 @@ static void term_damage(terminal_t *term)
 	sysarg_t sx = term->widget.hpos;
 	sysarg_t sy = term->widget.vpos;
 
-	if (!term_update_scroll(term, surface, sx, sy)) {
-		for (sysarg_t y = 0; y < term->rows; y++) {
-			for (sysarg_t x = 0; x < term->cols; x++) {
-				charfield_t *front_field =
-				    chargrid_charfield_at(term->frontbuf, x, y);
-				charfield_t *back_field =
-				    chargrid_charfield_at(term->backbuf, x, y);
+	term_dirty_t dirty;
+	term_dirty_init(&dirty);
 
-				back_field->ch = front_field->ch;
-				back_field->attrs = front_field->attrs;
-				front_field->flags &= ~CHAR_FLAG_DIRTY;
-
-				term_update_char(term, surface, sx, sy, x, y);
-			}
-		}
-	}
+	/* Everything is redrawn, so there is no point in scrolling. */
+	term->top_row = chargrid_get_top_row(term->frontbuf);
+	term_sync_rows(term, surface, sx, sy, false, 0, &dirty);
 
+	term_dirty_damage(&dirty, surface, sx, sy);
 	term_update_cursor(term, surface, sx, sy);
 
 	window_yield(term->widget.window);
@@ -435,7 +669,12 @@ static errno_t term_read(con_srv_t *srv, void *buf, size_t size, size_t *nread)
 	return EOK;
 }
 
-static void term_write_char(terminal_t *term, wchar_t ch)
+/** Write a character to the terminal buffer.
+ *
+ * @return True if the terminal needs to be updated (more than the
+ *         character itself changed, e.g. the terminal scrolled).
+ */
+static bool term_write_char(terminal_t *term, wchar_t ch)
 {
 	sysarg_t updated = 0;
 
@@ -459,17 +698,23 @@ static void term_write_char(terminal_t *term, wchar_t ch)
 
 	fibril_mutex_unlock(&term->mtx);
 
-	if (updated > 1)
-		term_update(term);
+	return (updated > 1);
 }
 
 static errno_t term_write(con_srv_t *srv, void *data, size_t size, size_t *nwritten)
 {
 	terminal_t *term = srv_to_terminal(srv);
 
+	/* The terminal is updated once for the whole buffer. */
+	bool update = false;
 	size_t off = 0;
-	while (off < size)
-		term_write_char(term, str_decode(data, &off, size));
+	while (off < size) {
+		if (term_write_char(term, str_decode(data, &off, size)))
+			update = true;
+	}
+
+	if (update)
+		term_update(term);
 
 	*nwritten = size;
 	return EOK;
@@ -596,6 +841,8 @@ void deinit_terminal(terminal_t *term)
 
 	if (term->backbuf)
 		chargrid_destroy(term->backbuf);
+
+	free(term->palettes);
 }
 
 static void terminal_destroy(widget_t *widget)
@@ -727,6 +974,7 @@ bool init_terminal(terminal_t *term, widget_t *parent, const void *data,
 
 	term->frontbuf = NULL;
 	term->backbuf = NULL;
+	term->palettes = NULL;
 
 	term->frontbuf = chargrid_create(term->cols, term->rows,
 	    CHARGRID_FLAG_NONE);
@@ -742,6 +990,14 @@ bool init_terminal(terminal_t *term, widget_t *parent, const void *data,
 		return false;
 	}
 
+	term->palettes = calloc(TERM_PALETTES, sizeof(term_palette_t));
+	if (!term->palettes) {
+		widget_deinit(&term->widget);
+		return false;
+	}
+
+	term->palette_next = 0;
+
 	chargrid_clear(term->frontbuf);
 	chargrid_clear(term->backbuf);
 	term->top_row = 0;
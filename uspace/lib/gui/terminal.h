@@ -49,6 +49,8 @@
 
 #define UTF8_CHAR_BUFFER_SIZE  (STR_BOUNDS(1) + 1)
 
+typedef struct term_palette term_palette_t;
+
 typedef struct terminal {
 	widget_t widget;
 
@@ -66,6 +68,9 @@ typedef struct terminal {
 	chargrid_t *backbuf;
 	sysarg_t top_row;
 
+	term_palette_t *palettes;
+	size_t palette_next;
+
 	service_id_t dsid;
 	con_srvs_t srvs;
 } terminal_t;
@@ -39,6 +39,7 @@
 #include <async.h>
 #include <errno.h>
 #include <pcm/format.h>
+#include <hound/ring.h>
 
 extern const char *HOUND_SERVICE;
 
@@ -59,6 +60,20 @@ typedef async_sess_t hound_sess_t;
 typedef struct {
 } *hound_context_id_t;
 
+/** Device playback statistics */
+typedef struct {
+	/** Length of the mixing period, in microseconds */
+	uint32_t period;
+	/** Audio mixed ahead of the device, in microseconds */
+	uint32_t latency;
+	/** Longest time spent mixing one period, in microseconds */
+	uint32_t mix_time_max;
+	/** Number of periods the device played before they were mixed */
+	uint32_t xruns;
+	/** Number of periods client streams ran out of data */
+	uint32_t stream_xruns;
+} hound_stats_t;
+
 hound_sess_t *hound_service_connect(const char *service);
 void hound_service_disconnect(hound_sess_t *sess);
 
@@ -83,6 +98,9 @@ static inline errno_t hound_service_get_list_all(hound_sess_t *sess,
 	return hound_service_get_list(sess, ids, count, flags, NULL);
 }
 
+errno_t hound_service_get_stats(hound_sess_t *sess, const char *name,
+    hound_stats_t *stats);
+
 errno_t hound_service_connect_source_sink(hound_sess_t *sess, const char *source,
     const char *sink);
 errno_t hound_service_disconnect_source_sink(hound_sess_t *sess, const char *source,
@@ -95,6 +113,9 @@ errno_t hound_service_stream_exit(async_exch_t *exch);
 
 errno_t hound_service_stream_write(async_exch_t *exch, const void *data, size_t size);
 errno_t hound_service_stream_read(async_exch_t *exch, void *data, size_t size);
+errno_t hound_service_stream_map(async_exch_t *exch, size_t size,
+    hound_ring_t **ring);
+errno_t hound_service_stream_wait(async_exch_t *exch, size_t size);
 
 /* Server */
 
@@ -123,6 +144,12 @@ typedef struct hound_server_iface {
 	errno_t (*stream_data_write)(void *, void *, size_t);
 	/** Read data from the stream */
 	errno_t (*stream_data_read)(void *, void *, size_t);
+	/** Create shared ring buffer of the given size for the stream */
+	errno_t (*stream_map)(void *, size_t, void **);
+	/** Block until there is enough free space in the stream's ring */
+	errno_t (*stream_wait)(void *, size_t);
+	/** Get playback statistics of a sink */
+	errno_t (*get_stats)(void *, const char *, hound_stats_t *);
 	void *server;
 } hound_server_iface_t;
 
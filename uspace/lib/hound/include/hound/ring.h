@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup libhound
+ * @addtogroup audio
+ * @{
+ */
+/** @file
+ * @brief Shared memory stream buffer.
+ *
+ * Playback streams can map a ring buffer shared by the client and the
+ * daemon. The client writes audio data directly to the ring, the daemon
+ * mixes them out of it when the device asks for the next period. Each side
+ * only moves its own position, so no locking is needed. IPC is used only
+ * to sleep until there is enough space in the ring.
+ */
+
+#ifndef LIBHOUND_RING_H_
+#define LIBHOUND_RING_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Ring buffer header, placed at the beginning of the shared area */
+typedef struct {
+	/** Size of the data area, a multiple of the stream's frame size */
+	size_t size;
+	/** Total number of bytes written by the client */
+	atomic_size_t write_pos;
+	/** Total number of bytes consumed by the daemon */
+	atomic_size_t read_pos;
+	/** Number of periods the ring ran out of data */
+	atomic_uint xruns;
+} hound_ring_t;
+
+/** Offset of the audio data in the shared area */
+#define HOUND_RING_DATA_OFFSET  64
+
+/**
+ * Ring data area getter.
+ * @param ring The ring buffer.
+ * @return Pointer to the beginning of the data area.
+ */
+static inline uint8_t *hound_ring_data(hound_ring_t *ring)
+{
+	return (uint8_t *) ring + HOUND_RING_DATA_OFFSET;
+}
+
+/**
+ * Number of bytes waiting in the ring.
+ * @param ring The ring buffer.
+ * @return Number of bytes written, but not yet consumed.
+ */
+static inline size_t hound_ring_used(hound_ring_t *ring)
+{
+	return atomic_load_explicit(&ring->write_pos, memory_order_acquire) -
+	    atomic_load_explicit(&ring->read_pos, memory_order_acquire);
+}
+
+/**
+ * Free space in the ring.
+ * @param ring The ring buffer.
+ * @return Number of bytes that can be written.
+ */
+static inline size_t hound_ring_free(hound_ring_t *ring)
+{
+	return ring->size - hound_ring_used(ring);
+}
+
+extern void hound_ring_init(hound_ring_t *, size_t, size_t);
+extern size_t hound_ring_write(hound_ring_t *, const void *, size_t);
+extern const void *hound_ring_read_start(hound_ring_t *, size_t, size_t *);
+extern void hound_ring_read_finish(hound_ring_t *, size_t);
+
+#endif
+/** @}
+ */
@@ -34,9 +34,11 @@
  * Common USB functions.
  */
 #include <adt/list.h>
+#include <as.h>
 #include <errno.h>
 #include <inttypes.h>
 #include <loc.h>
+#include <macros.h>
 #include <str.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -46,6 +48,19 @@
 #include "protocol.h"
 #include "client.h"
 
+/** Nominal mixing period of the daemon */
+#define STREAM_RING_PERIOD_USEC  5000
+
+/**
+ * Number of mixing periods the ring holds for streams without server side
+ * buffer limit. More periods absorb scheduling jitter of the client, but
+ * the last written data are played that much later.
+ */
+#define STREAM_RING_DEFAULT_PERIODS  4
+
+/** Ring buffer size used if the stream format does not tell the rate */
+#define STREAM_RING_FALLBACK_SIZE  4096
+
 /** Stream structure */
 struct hound_stream {
 	/** link in context's list */
@@ -58,6 +73,8 @@ struct hound_stream {
 	hound_context_t *context;
 	/** Stream flags */
 	int flags;
+	/** Ring buffer shared with the daemon, NULL if not mapped */
+	hound_ring_t *ring;
 };
 
 /**
@@ -282,6 +299,19 @@ errno_t hound_context_disconnect_target(hound_context_t *hound, const char *targ
 	}
 }
 
+/**
+ * Default ring buffer size of a stream.
+ * @param format Format of the stream.
+ * @return Size of the ring data area in bytes.
+ */
+static size_t stream_ring_default_size(const pcm_format_t *format)
+{
+	const size_t frames = (uint64_t) format->sampling_rate *
+	    STREAM_RING_PERIOD_USEC * STREAM_RING_DEFAULT_PERIODS / 1000000;
+	const size_t size = frames * pcm_format_frame_size(format);
+	return size ? size : STREAM_RING_FALLBACK_SIZE;
+}
+
 /**
  * Create a new stream associated with the context.
  * @param hound Hound context.
@@ -304,6 +334,7 @@ hound_stream_t *hound_stream_create(hound_context_t *hound, unsigned flags,
 		new_stream->format = format;
 		new_stream->context = hound;
 		new_stream->flags = flags;
+		new_stream->ring = NULL;
 		const errno_t ret = hound_service_stream_enter(new_stream->exch,
 		    hound->id, flags, format, bsize);
 		if (ret != EOK) {
@@ -311,6 +342,17 @@ hound_stream_t *hound_stream_create(hound_context_t *hound, unsigned flags,
 			free(new_stream);
 			return NULL;
 		}
+		/*
+		 * Playback data go through shared memory if the daemon
+		 * supports it, IPC writes are used otherwise.
+		 */
+		if (!hound->record) {
+			const size_t size = HOUND_RING_DATA_OFFSET +
+			    (bsize ? bsize : stream_ring_default_size(&format));
+			if (hound_service_stream_map(new_stream->exch, size,
+			    &new_stream->ring) != EOK)
+				new_stream->ring = NULL;
+		}
 		list_append(&new_stream->link, &hound->stream_list);
 	}
 	return new_stream;
@@ -330,6 +372,8 @@ void hound_stream_destroy(hound_stream_t *stream)
 			hound_service_stream_drain(stream->exch);
 		hound_service_stream_exit(stream->exch);
 		async_exchange_end(stream->exch);
+		if (stream->ring)
+			as_area_destroy(stream->ring);
 		list_remove(&stream->link);
 		free(stream);
 	}
@@ -347,7 +391,21 @@ errno_t hound_stream_write(hound_stream_t *stream, const void *data, size_t size
 	assert(stream);
 	if (!data || size == 0)
 		return EBADMEM;
-	return hound_service_stream_write(stream->exch, data, size);
+	if (!stream->ring)
+		return hound_service_stream_write(stream->exch, data, size);
+
+	while (true) {
+		const size_t written =
+		    hound_ring_write(stream->ring, data, size);
+		data = (const uint8_t *) data + written;
+		size -= written;
+		if (size == 0)
+			return EOK;
+		const errno_t ret = hound_service_stream_wait(stream->exch,
+		    min(size, stream->ring->size));
+		if (ret != EOK)
+			return ret;
+	}
 }
 
 /**
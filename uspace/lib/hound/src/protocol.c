@@ -34,6 +34,8 @@
  * Common USB functions.
  */
 #include <adt/list.h>
+#include <abi/ipc/methods.h>
+#include <as.h>
 #include <errno.h>
 #include <loc.h>
 #include <macros.h>
@@ -64,6 +66,10 @@ enum ipc_methods {
 	IPC_M_HOUND_STREAM_EXIT,
 	/** Wait until there is no data in the stream */
 	IPC_M_HOUND_STREAM_DRAIN,
+	/** Wait until there is free space in the stream's ring buffer */
+	IPC_M_HOUND_STREAM_WAIT,
+	/** Request playback statistics */
+	IPC_M_HOUND_GET_STATS,
 };
 
 /** PCM format conversion helper structure */
@@ -239,6 +245,36 @@ errno_t hound_service_get_list(hound_sess_t *sess, char ***ids, size_t *count,
 	return ret;
 }
 
+/**
+ * Get playback statistics of a sink.
+ * @param sess Valid audio session.
+ * @param name Sink name, valid string.
+ * @param stats Place to store the statistics.
+ * @return Error code.
+ */
+errno_t hound_service_get_stats(hound_sess_t *sess, const char *name,
+    hound_stats_t *stats)
+{
+	assert(sess);
+	assert(name);
+	assert(stats);
+
+	async_exch_t *exch = async_exchange_begin(sess);
+	if (!exch)
+		return ENOMEM;
+	ipc_call_t call;
+	aid_t id = async_send_0(exch, IPC_M_HOUND_GET_STATS, &call);
+	errno_t ret = id ? EOK : EPARTY;
+	if (ret == EOK)
+		ret = async_data_write_start(exch, name, str_size(name));
+	if (ret == EOK)
+		async_wait_for(id, &ret);
+	if (ret == EOK)
+		ret = async_data_read_start(exch, stats, sizeof(hound_stats_t));
+	async_exchange_end(exch);
+	return ret;
+}
+
 /**
  * Create a new connection between a source and a sink.
  * @param sess Valid audio session.
@@ -362,6 +398,37 @@ errno_t hound_service_stream_read(async_exch_t *exch, void *data, size_t size)
 	return async_data_read_start(exch, data, size);
 }
 
+/**
+ * Map a shared ring buffer for a stream.
+ * @param exch IPC exchange in STREAM MODE.
+ * @param size Size of the shared area.
+ * @param ring Place to store the mapped ring.
+ * @return Error code.
+ *
+ * Data written to the ring replace hound_service_stream_write().
+ */
+errno_t hound_service_stream_map(async_exch_t *exch, size_t size,
+    hound_ring_t **ring)
+{
+	assert(ring);
+	void *area = NULL;
+	const errno_t ret = async_share_in_start_0_0(exch, size, &area);
+	if (ret == EOK)
+		*ring = area;
+	return ret;
+}
+
+/**
+ * Wait until there is enough free space in the stream's ring buffer.
+ * @param exch IPC exchange in STREAM MODE.
+ * @param size Number of bytes that should be free.
+ * @return Error code.
+ */
+errno_t hound_service_stream_wait(async_exch_t *exch, size_t size)
+{
+	return async_req_1_0(exch, IPC_M_HOUND_STREAM_WAIT, size);
+}
+
 /*
  * SERVER
  */
@@ -557,6 +624,30 @@ void hound_connection_handler(ipc_call_t *icall, void *arg)
 			free(sink);
 			async_answer_0(&call, ret);
 			break;
+		case IPC_M_HOUND_GET_STATS:
+			/* check interface functions */
+			if (!server_iface || !server_iface->get_stats) {
+				async_answer_0(&call, ENOTSUP);
+				break;
+			}
+
+			name = NULL;
+			hound_stats_t stats = { 0 };
+
+			/* read sink name */
+			ret = async_data_write_accept(&name, true, 0, 0, 0, 0);
+			if (ret == EOK)
+				ret = server_iface->get_stats(
+				    server_iface->server, name, &stats);
+			free(name);
+			async_answer_0(&call, ret);
+
+			/* send the statistics */
+			ipc_call_t sid;
+			if (ret == EOK && async_data_read_receive(&sid, NULL))
+				async_data_read_finalize(&sid, &stats,
+				    sizeof(stats));
+			break;
 		case IPC_M_HOUND_STREAM_ENTER:
 			/* check interface functions */
 			if (!server_iface || !server_iface->is_record_context ||
@@ -637,9 +728,11 @@ static void hound_server_read_data(void *stream)
 	size_t size = 0;
 	errno_t ret_answer = EOK;
 
-	/* accept data write or drain */
+	/* accept data write, drain, ring buffer map or wait */
 	while (async_data_write_receive(&call, &size) ||
-	    (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN)) {
+	    (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN) ||
+	    (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_WAIT) ||
+	    (IPC_GET_IMETHOD(call) == IPC_M_SHARE_IN)) {
 		/* check drain first */
 		if (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN) {
 			errno_t ret = ENOTSUP;
@@ -649,6 +742,29 @@ static void hound_server_read_data(void *stream)
 			continue;
 		}
 
+		if (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_WAIT) {
+			errno_t ret = ENOTSUP;
+			if (server_iface->stream_wait)
+				ret = server_iface->stream_wait(stream,
+				    IPC_GET_ARG1(call));
+			async_answer_0(&call, ret);
+			continue;
+		}
+
+		if (IPC_GET_IMETHOD(call) == IPC_M_SHARE_IN) {
+			void *area = NULL;
+			errno_t ret = ENOTSUP;
+			if (server_iface->stream_map)
+				ret = server_iface->stream_map(stream,
+				    IPC_GET_ARG1(call), &area);
+			if (ret == EOK)
+				async_share_in_finalize(&call, area,
+				    AS_AREA_WRITE | AS_AREA_READ);
+			else
+				async_answer_0(&call, ret);
+			continue;
+		}
+
 		/* there was an error last time */
 		if (ret_answer != EOK) {
 			async_answer_0(&call, ret_answer);
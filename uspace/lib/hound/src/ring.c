@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup libhound
+ * @addtogroup audio
+ * @{
+ */
+/** @file
+ * Shared memory stream buffer.
+ */
+
+#include <assert.h>
+#include <macros.h>
+#include <mem.h>
+
+#include "ring.h"
+
+/**
+ * Initialize ring buffer header.
+ * @param ring Beginning of the shared area.
+ * @param area_size Size of the shared area.
+ * @param frame_size Frame size of the stream.
+ */
+void hound_ring_init(hound_ring_t *ring, size_t area_size, size_t frame_size)
+{
+	assert(ring);
+	assert(frame_size);
+	assert(area_size > HOUND_RING_DATA_OFFSET);
+	static_assert(sizeof(hound_ring_t) <= HOUND_RING_DATA_OFFSET);
+
+	const size_t size = area_size - HOUND_RING_DATA_OFFSET;
+	ring->size = size - (size % frame_size);
+	atomic_init(&ring->write_pos, 0);
+	atomic_init(&ring->read_pos, 0);
+	atomic_init(&ring->xruns, 0);
+}
+
+/**
+ * Write data to the ring (client side).
+ * @param ring The ring buffer.
+ * @param data Audio data.
+ * @param size Size of the @p data buffer.
+ * @return Number of bytes written, limited by the free space.
+ */
+size_t hound_ring_write(hound_ring_t *ring, const void *data, size_t size)
+{
+	assert(ring);
+	const size_t pos =
+	    atomic_load_explicit(&ring->write_pos, memory_order_relaxed);
+	size = min(size, hound_ring_free(ring));
+
+	const size_t offset = pos % ring->size;
+	const size_t first = min(size, ring->size - offset);
+	memcpy(hound_ring_data(ring) + offset, data, first);
+	memcpy(hound_ring_data(ring), (const uint8_t *) data + first,
+	    size - first);
+
+	atomic_store_explicit(&ring->write_pos, pos + size,
+	    memory_order_release);
+	return size;
+}
+
+/**
+ * Get contiguous block of data waiting in the ring (daemon side).
+ * @param ring The ring buffer.
+ * @param ring_size Size of the ring as created, the header is writable
+ *        by the client and can't be trusted.
+ * @param size Place to store size of the block.
+ * @return Pointer to the block.
+ *
+ * Data wrapped around the end of the ring are returned by the next call,
+ * after hound_ring_read_finish().
+ */
+const void *hound_ring_read_start(hound_ring_t *ring, size_t ring_size,
+    size_t *size)
+{
+	assert(ring);
+	assert(size);
+	const size_t pos =
+	    atomic_load_explicit(&ring->read_pos, memory_order_relaxed);
+	const size_t offset = pos % ring_size;
+	*size = min(min(hound_ring_used(ring), ring_size), ring_size - offset);
+	return hound_ring_data(ring) + offset;
+}
+
+/**
+ * Release data consumed from the ring (daemon side).
+ * @param ring The ring buffer.
+ * @param size Number of bytes consumed.
+ */
+void hound_ring_read_finish(hound_ring_t *ring, size_t size)
+{
+	assert(ring);
+	atomic_fetch_add_explicit(&ring->read_pos, size, memory_order_release);
+}
+
+/** @}
+ */
@@ -42,9 +42,12 @@
 #include <stdio.h>
 #include <str_error.h>
 #include <sysinfo.h>
+#include <stdlib.h>
+#include <mem.h>
 #include <as.h>
 #include <ddf/interrupt.h>
 #include <ops/nic.h>
+#include <nic_iface.h>
 #include <errno.h>
 
 #include "nic_driver.h"
@@ -507,15 +510,14 @@ void nic_set_tx_busy(nic_t *nic_data, int busy)
 	nic_data->tx_busy = busy;
 }
 
-/**
- * This is the function that the driver should call when it receives a frame.
- * The frame is checked by filters and then sent up to the NIL layer or
- * discarded. The frame is released.
+/** Check a received frame by filters and update statistics
  *
  * @param nic_data
  * @param frame		The received frame
+ *
+ * @return True if the frame should be passed to the NIL layer.
  */
-void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+static bool nic_received_frame_accept(nic_t *nic_data, nic_frame_t *frame)
 {
 	/*
 	 * Note: this function must not lock main lock, because loopback driver
@@ -529,7 +531,8 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 	/* Update statistics */
 	fibril_rwlock_write_lock(&nic_data->stats_lock);
 
-	if (nic_data->state == NIC_STATE_ACTIVE && check) {
+	bool accept = (nic_data->state == NIC_STATE_ACTIVE && check);
+	if (accept) {
 		nic_data->stats.receive_packets++;
 		nic_data->stats.receive_bytes += frame->size;
 		switch (frame_type) {
@@ -542,9 +545,6 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 		default:
 			break;
 		}
-		fibril_rwlock_write_unlock(&nic_data->stats_lock);
-		nic_ev_received(nic_data->client_session, frame->data,
-		    frame->size);
 	} else {
 		switch (frame_type) {
 		case NIC_FRAME_UNICAST:
@@ -557,22 +557,94 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 			nic_data->stats.receive_filtered_broadcast++;
 			break;
 		}
-		fibril_rwlock_write_unlock(&nic_data->stats_lock);
+	}
+
+	fibril_rwlock_write_unlock(&nic_data->stats_lock);
+	return accept;
+}
+
+/**
+ * This is the function that the driver should call when it receives a frame.
+ * The frame is checked by filters and then sent up to the NIL layer or
+ * discarded. The frame is released.
+ *
+ * @param nic_data
+ * @param frame		The received frame
+ */
+void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+{
+	if (nic_received_frame_accept(nic_data, frame)) {
+		nic_ev_received(nic_data->client_session, frame->data,
+		    frame->size);
 	}
 	nic_release_frame(nic_data, frame);
 }
 
+/** Send a batch of accepted frames up to the NIL layer and release them
+ *
+ * @param nic_data
+ * @param batch		Accepted frames
+ * @param count		Number of frames in @a batch
+ */
+static void nic_received_batch_flush(nic_t *nic_data, nic_frame_t **batch,
+    size_t count)
+{
+	size_t sizes[NIC_EV_RECEIVED_BATCH_MAX];
+	size_t total = 0;
+
+	if (count == 0)
+		return;
+
+	if (count == 1) {
+		nic_ev_received(nic_data->client_session, batch[0]->data,
+		    batch[0]->size);
+		nic_release_frame(nic_data, batch[0]);
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		sizes[i] = batch[i]->size;
+		total += sizes[i];
+	}
+
+	uint8_t *data = malloc(total);
+	if (data != NULL) {
+		uint8_t *dst = data;
+		for (size_t i = 0; i < count; i++) {
+			memcpy(dst, batch[i]->data, sizes[i]);
+			dst += sizes[i];
+		}
+
+		nic_ev_received_batch(nic_data->client_session, data, sizes,
+		    count);
+		free(data);
+	} else {
+		/* Fall back to delivering the frames one by one */
+		for (size_t i = 0; i < count; i++) {
+			nic_ev_received(nic_data->client_session,
+			    batch[i]->data, batch[i]->size);
+		}
+	}
+
+	for (size_t i = 0; i < count; i++)
+		nic_release_frame(nic_data, batch[i]);
+}
+
 /**
  * Some NICs can receive multiple frames during single interrupt. These can
  * send them in whole list of frames (actually nic_frame_t structures), then
- * the list is deallocated and each frame is passed to the
- * nic_received_packet function.
+ * the list is deallocated and the frames which pass the filters are sent up
+ * to the NIL layer in batches of up to NIC_EV_RECEIVED_BATCH_MAX frames, each
+ * batch using a single IPC exchange.
  *
  * @param nic_data
  * @param frames		List of received frames
  */
 void nic_received_frame_list(nic_t *nic_data, nic_frame_list_t *frames)
 {
+	nic_frame_t *batch[NIC_EV_RECEIVED_BATCH_MAX];
+	size_t count = 0;
+
 	if (frames == NULL)
 		return;
 	while (!list_empty(frames)) {
@@ -580,8 +652,18 @@ void nic_received_frame_list(nic_t *nic_data, nic_frame_list_t *frames)
 		    list_get_instance(list_first(frames), nic_frame_t, link);
 
 		list_remove(&frame->link);
-		nic_received_frame(nic_data, frame);
+		if (!nic_received_frame_accept(nic_data, frame)) {
+			nic_release_frame(nic_data, frame);
+			continue;
+		}
+
+		batch[count++] = frame;
+		if (count == NIC_EV_RECEIVED_BATCH_MAX) {
+			nic_received_batch_flush(nic_data, batch, count);
+			count = 0;
+		}
 	}
+	nic_received_batch_flush(nic_data, batch, count);
 	nic_driver_release_frame_list(frames);
 }
 
@@ -93,5 +93,43 @@ errno_t nic_ev_received(async_sess_t *sess, void *data, size_t size)
 	return retval;
 }
 
+/** Several frames received.
+ *
+ * All frames are delivered in a single exchange. The client first receives
+ * the array of frame sizes and then the frames themselves stored back to back
+ * in one buffer.
+ *
+ * @param sess   Client session.
+ * @param data   Frames stored back to back.
+ * @param sizes  Sizes of the individual frames.
+ * @param count  Number of frames, at most NIC_EV_RECEIVED_BATCH_MAX.
+ */
+errno_t nic_ev_received_batch(async_sess_t *sess, void *data, size_t *sizes,
+    size_t count)
+{
+	size_t total = 0;
+	for (size_t i = 0; i < count; i++)
+		total += sizes[i];
+
+	async_exch_t *exch = async_exchange_begin(sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, NIC_EV_RECEIVED_BATCH, count, &answer);
+	errno_t retval = async_data_write_start(exch, sizes,
+	    count * sizeof(size_t));
+	if (retval == EOK)
+		retval = async_data_write_start(exch, data, total);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 /** @}
  */
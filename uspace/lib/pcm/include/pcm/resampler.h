@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup audio
+ * @brief PCM sampling rate conversion
+ * @{
+ */
+/** @file
+ */
+
+#ifndef PCM_RESAMPLER_H_
+#define PCM_RESAMPLER_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Resampling quality, higher quality costs more CPU time */
+typedef enum {
+	/** Linear interpolation */
+	PCM_RESAMPLER_LOW,
+	/** Windowed sinc filter, 16 taps (scaled up when downsampling) */
+	PCM_RESAMPLER_MEDIUM,
+	/** Windowed sinc filter, 32 taps (scaled up when downsampling) */
+	PCM_RESAMPLER_HIGH,
+} pcm_resampler_quality_t;
+
+/** Sampling rate converter working on interleaved float samples */
+typedef struct pcm_resampler pcm_resampler_t;
+
+extern errno_t pcm_resampler_create(unsigned, unsigned, unsigned,
+    pcm_resampler_quality_t, pcm_resampler_t **);
+extern void pcm_resampler_destroy(pcm_resampler_t *);
+extern bool pcm_resampler_matches(const pcm_resampler_t *, unsigned, unsigned,
+    unsigned);
+extern void pcm_resampler_reset(pcm_resampler_t *);
+extern size_t pcm_resampler_input_frames(const pcm_resampler_t *, size_t);
+extern void pcm_resampler_process(pcm_resampler_t *, const float *, size_t *,
+    float *, size_t *);
+extern size_t pcm_resampler_convert_frames(size_t, unsigned, unsigned);
+
+#endif
+
+/**
+ * @}
+ */
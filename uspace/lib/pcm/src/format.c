@@ -37,9 +37,14 @@
 #include <byteorder.h>
 #include <errno.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdio.h>
 #include <inttypes.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "format.h"
 
 // TODO float endian?
@@ -49,7 +54,7 @@
 #define host2float_le(x) (x)
 #define host2float_be(x) (x)
 
-#define from(x, type, endian) (float)(type ## _ ## endian ## 2host(x))
+#define from(x, type, endian) (float)(type)(type ## _ ## endian ## 2host(x))
 #define to(x, type, endian) (float)(host2 ## type ## _ ## endian(x))
 
 /** Default linear PCM format */
@@ -68,8 +73,26 @@ const pcm_format_t AUDIO_FORMAT_ANY = {
 	.sample_format = 0,
 };
 
-static float get_normalized_sample(const void *buffer, size_t size,
-    unsigned frame, unsigned channel, const pcm_format_t *f);
+/** Number of samples converted at once. */
+#define PCM_CHUNK  256
+
+#ifdef __BE__
+#define PCM_SAMPLE_SINT16_NATIVE  PCM_SAMPLE_SINT16_BE
+#else
+#define PCM_SAMPLE_SINT16_NATIVE  PCM_SAMPLE_SINT16_LE
+#endif
+
+static void mix_sint16(int16_t *dst, const int16_t *src, size_t count);
+static errno_t decode_samples(const void *src, size_t count,
+    pcm_sample_format_t format, float *dst);
+static void encode_samples(const float *src, size_t count,
+    pcm_sample_format_t format, void *dst);
+
+/** Clip normalized sample to <-1,1> */
+static inline float clip(float x)
+{
+	return (x < -1.0f) ? -1.0f : ((x > 1.0f) ? 1.0f : x);
+}
 
 /**
  * Compare PCM format attribtues.
@@ -173,8 +196,9 @@ errno_t pcm_format_mix(void *dst, const void *src, size_t size, const pcm_format
  * @param df Pointer to the destination format descriptor.
  * @return Error code.
  *
- * Buffers must contain entire frames. Destination buffer is always filled.
- * If there are not enough data in the source buffer silent data is assumed.
+ * Buffers must contain entire frames. If there are not enough data in
+ * the source buffer silent data is assumed. Sampling rate is not
+ * converted, use pcm_resampler_t for that.
  */
 errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
     size_t src_size, const pcm_format_t *sf, const pcm_format_t *df)
@@ -182,155 +206,287 @@ errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
 	if (!dst || !src || !sf || !df)
 		return EINVAL;
 	const size_t src_frame_size = pcm_format_frame_size(sf);
-	if ((src_size % src_frame_size) != 0)
+	if (src_frame_size == 0 || (src_size % src_frame_size) != 0)
 		return EINVAL;
 
 	const size_t dst_frame_size = pcm_format_frame_size(df);
-	if ((dst_size % dst_frame_size) != 0)
+	if (dst_frame_size == 0 || (dst_size % dst_frame_size) != 0)
 		return EINVAL;
 
-	/*
-	 * This is so ugly it eats kittens, and puppies, and ducklings,
-	 * and all little fluffy things...
-	 */
-#define LOOP_ADD(type, endian, low, high) \
+	const size_t frames = min(src_size / src_frame_size,
+	    dst_size / dst_frame_size);
+
+	if (sf->sample_format == PCM_SAMPLE_SINT16_NATIVE &&
+	    df->sample_format == PCM_SAMPLE_SINT16_NATIVE &&
+	    sf->channels == df->channels) {
+		mix_sint16(dst, src, frames * df->channels);
+		return EOK;
+	}
+
+	if (df->channels > PCM_CHUNK)
+		return ENOTSUP;
+
+	float samples[PCM_CHUNK];
+	const size_t chunk = PCM_CHUNK / df->channels;
+	for (size_t done = 0; done < frames; done += chunk) {
+		const size_t count = min(chunk, frames - done);
+		errno_t rc = pcm_format_decode(samples, df->channels,
+		    (const uint8_t *) src + done * src_frame_size, count, sf);
+		if (rc != EOK)
+			return rc;
+		rc = pcm_format_mix_float((uint8_t *) dst + done * dst_frame_size,
+		    samples, count, df);
+		if (rc != EOK)
+			return rc;
+	}
+	return EOK;
+}
+
+/**
+ * Convert audio frames to normalized float samples.
+ * @param dst Destination buffer, @p frames * @p channels samples.
+ * @param channels Number of channels in the destination buffer.
+ * @param src Source audio buffer.
+ * @param frames Number of frames to convert.
+ * @param f Pointer to the source format descriptor.
+ * @return Error code.
+ *
+ * Channels missing in the source are silent, surplus source channels are
+ * dropped.
+ */
+errno_t pcm_format_decode(float *dst, unsigned channels, const void *src,
+    size_t frames, const pcm_format_t *f)
+{
+	assert(dst);
+	assert(src);
+	assert(f);
+	if (f->channels == channels)
+		return decode_samples(src, frames * channels, f->sample_format,
+		    dst);
+
+	if (f->channels == 0 || f->channels > PCM_CHUNK)
+		return ENOTSUP;
+
+	const size_t frame_size = pcm_format_frame_size(f);
+	const size_t chunk = PCM_CHUNK / f->channels;
+	float samples[PCM_CHUNK];
+	for (size_t done = 0; done < frames; done += chunk) {
+		const size_t count = min(chunk, frames - done);
+		const errno_t rc = decode_samples(
+		    (const uint8_t *) src + done * frame_size,
+		    count * f->channels, f->sample_format, samples);
+		if (rc != EOK)
+			return rc;
+		float *out = dst + done * channels;
+		for (size_t i = 0; i < count; ++i) {
+			for (unsigned j = 0; j < channels; ++j) {
+				*out++ = (j < f->channels) ?
+				    samples[i * f->channels + j] : 0.0f;
+			}
+		}
+	}
+	return EOK;
+}
+
+/**
+ * Add normalized float samples to audio data.
+ * @param dst Destination audio buffer.
+ * @param src Samples to add, @p frames * f->channels of them.
+ * @param frames Number of frames to mix.
+ * @param f Pointer to the destination format descriptor.
+ * @return Error code.
+ */
+errno_t pcm_format_mix_float(void *dst, const float *src, size_t frames,
+    const pcm_format_t *f)
+{
+	assert(dst);
+	assert(src);
+	assert(f);
+	const size_t count = frames * f->channels;
+	const size_t sample_size = pcm_sample_format_size(f->sample_format);
+	float samples[PCM_CHUNK];
+	for (size_t done = 0; done < count; done += PCM_CHUNK) {
+		const size_t n = min((size_t) PCM_CHUNK, count - done);
+		void *buffer = (uint8_t *) dst + done * sample_size;
+		const errno_t rc =
+		    decode_samples(buffer, n, f->sample_format, samples);
+		if (rc != EOK)
+			return rc;
+		for (size_t i = 0; i < n; ++i)
+			samples[i] += src[done + i];
+		encode_samples(samples, n, f->sample_format, buffer);
+	}
+	return EOK;
+}
+
+/**
+ * Mix signed 16-bit samples in host byte order, saturating.
+ * @param dst Destination samples.
+ * @param src Source samples.
+ * @param count Number of samples.
+ */
+static void mix_sint16(int16_t *dst, const int16_t *src, size_t count)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	for (; i + 8 <= count; i += 8) {
+		const __m128i a = _mm_loadu_si128((const __m128i *) (dst + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *) (src + i));
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_adds_epi16(a, b));
+	}
+#endif
+	for (; i < count; ++i) {
+		const int32_t c = (int32_t) dst[i] + src[i];
+		dst[i] = (c > INT16_MAX) ? INT16_MAX :
+		    ((c < INT16_MIN) ? INT16_MIN : c);
+	}
+}
+
+/**
+ * Converts samples to float <-1,1>
+ * @param src Audio data
+ * @param count Number of samples to convert
+ * @param format Sample format of the audio data
+ * @param dst Destination buffer for @p count normalized samples
+ * @return Error code.
+ *
+ * One loop per format, so that the compiler can vectorize them.
+ */
+static errno_t decode_samples(const void *src, size_t count,
+    pcm_sample_format_t format, float *dst)
+{
+#define DECODE(type, endian, low, high) \
 do { \
-	const unsigned frame_count = dst_size / dst_frame_size; \
-	for (size_t i = 0; i < frame_count; ++i) { \
-		for (unsigned j = 0; j < df->channels; ++j) { \
-			const float a = \
-			    get_normalized_sample(dst, dst_size, i, j, df);\
-			const float b = \
-			    get_normalized_sample(src, src_size, i, j, sf);\
-			float c = (a + b); \
-			if (c < -1.0) c = -1.0; \
-			if (c > 1.0) c = 1.0; \
-			c += 1.0; \
-			c *= ((float)(type)high - (float)(type)low) / 2; \
-			c += (float)(type)low; \
-			type *dst_buf = dst; \
-			const unsigned pos = i * df->channels  + j; \
-			if (pos < (dst_size / sizeof(type))) \
-				dst_buf[pos] = to((type)c, type, endian); \
-		} \
-	} \
+	const type *buffer = src; \
+	const float scale = 2.0f / ((float)(type)high - (float)(type)low); \
+	const float offset = -(float)(type)low * scale - 1.0f; \
+	for (size_t i = 0; i < count; ++i) \
+		dst[i] = from(buffer[i], type, endian) * scale + offset; \
 } while (0)
 
-	switch (df->sample_format) {
+	switch (format) {
 	case PCM_SAMPLE_UINT8:
-		LOOP_ADD(uint8_t, le, UINT8_MIN, UINT8_MAX);
+		DECODE(uint8_t, le, UINT8_MIN, UINT8_MAX);
 		break;
 	case PCM_SAMPLE_SINT8:
-		LOOP_ADD(uint8_t, le, INT8_MIN, INT8_MAX);
+		DECODE(int8_t, le, INT8_MIN, INT8_MAX);
 		break;
 	case PCM_SAMPLE_UINT16_LE:
-		LOOP_ADD(uint16_t, le, UINT16_MIN, UINT16_MAX);
+		DECODE(uint16_t, le, UINT16_MIN, UINT16_MAX);
 		break;
 	case PCM_SAMPLE_SINT16_LE:
-		LOOP_ADD(int16_t, le, INT16_MIN, INT16_MAX);
+		DECODE(int16_t, le, INT16_MIN, INT16_MAX);
 		break;
 	case PCM_SAMPLE_UINT16_BE:
-		LOOP_ADD(uint16_t, be, UINT16_MIN, UINT16_MAX);
+		DECODE(uint16_t, be, UINT16_MIN, UINT16_MAX);
 		break;
 	case PCM_SAMPLE_SINT16_BE:
-		LOOP_ADD(int16_t, be, INT16_MIN, INT16_MAX);
+		DECODE(int16_t, be, INT16_MIN, INT16_MAX);
 		break;
 	case PCM_SAMPLE_UINT24_32_LE:
 	case PCM_SAMPLE_UINT32_LE: // TODO this are not right for 24bit
-		LOOP_ADD(uint32_t, le, UINT32_MIN, UINT32_MAX);
+		DECODE(uint32_t, le, UINT32_MIN, UINT32_MAX);
 		break;
 	case PCM_SAMPLE_SINT24_32_LE:
 	case PCM_SAMPLE_SINT32_LE:
-		LOOP_ADD(int32_t, le, INT32_MIN, INT32_MAX);
+		DECODE(int32_t, le, INT32_MIN, INT32_MAX);
 		break;
 	case PCM_SAMPLE_UINT24_32_BE:
 	case PCM_SAMPLE_UINT32_BE:
-		LOOP_ADD(uint32_t, be, UINT32_MIN, UINT32_MAX);
+		DECODE(uint32_t, be, UINT32_MIN, UINT32_MAX);
 		break;
 	case PCM_SAMPLE_SINT24_32_BE:
 	case PCM_SAMPLE_SINT32_BE:
-		LOOP_ADD(int32_t, be, INT32_MIN, INT32_MAX);
+		DECODE(int32_t, be, INT32_MIN, INT32_MAX);
+		break;
+	case PCM_SAMPLE_FLOAT32:
+		memcpy(dst, src, count * sizeof(float));
 		break;
 	case PCM_SAMPLE_UINT24_LE:
 	case PCM_SAMPLE_SINT24_LE:
 	case PCM_SAMPLE_UINT24_BE:
 	case PCM_SAMPLE_SINT24_BE:
-	case PCM_SAMPLE_FLOAT32:
 	default:
 		return ENOTSUP;
 	}
 	return EOK;
-#undef LOOP_ADD
+#undef DECODE
 }
 
 /**
- * Converts all sample formats to float <-1,1>
- * @param buffer Audio data
- * @param size Size of the buffer
- * @param frame Index of the frame to read
- * @param channel Channel within the frame
- * @param f Pointer to a format descriptor
- * @return Normalized sample <-1,1>, 0.0 if the data could not be read
+ * Converts float samples to the given format, clipping them to <-1,1>
+ * @param src Normalized samples
+ * @param count Number of samples to convert
+ * @param format Sample format of the destination
+ * @param dst Destination audio buffer
+ *
+ * 32-bit formats are scaled in double precision, float can't represent
+ * their extremes exactly.
  */
-static float get_normalized_sample(const void *buffer, size_t size,
-    unsigned frame, unsigned channel, const pcm_format_t *f)
+static void encode_samples(const float *src, size_t count,
+    pcm_sample_format_t format, void *dst)
 {
-	assert(f);
-	assert(buffer);
-	if (channel >= f->channels)
-		return 0.0f;
-#define GET(type, endian, low, high) \
+#define ENCODE(type, endian, low, high, ftype) \
 do { \
-	const type *src = buffer; \
-	const size_t sample_count = size / sizeof(type); \
-	const size_t sample_pos = frame * f->channels + channel; \
-	if (sample_pos >= sample_count) {\
-		return 0.0f; \
+	type *buffer = dst; \
+	const ftype scale = ((ftype)(type)high - (ftype)(type)low) / 2; \
+	const ftype offset = (ftype)(type)low + scale; \
+	for (size_t i = 0; i < count; ++i) { \
+		const float c = clip(src[i]); \
+		buffer[i] = host2 ## type ## _ ## endian( \
+		    (type)(c * scale + offset)); \
 	} \
-	float sample = from(src[sample_pos], type, endian); \
-	/* This makes it positive */ \
-	sample -= (float)(type)low; \
-	/* This makes it <0,2> */ \
-	sample /= (((float)(type)high - (float)(type)low) / 2.0f); \
-	return sample - 1.0f; \
 } while (0)
 
-	switch (f->sample_format) {
+	switch (format) {
 	case PCM_SAMPLE_UINT8:
-		GET(uint8_t, le, UINT8_MIN, UINT8_MAX);
+		ENCODE(uint8_t, le, UINT8_MIN, UINT8_MAX, float);
+		break;
 	case PCM_SAMPLE_SINT8:
-		GET(int8_t, le, INT8_MIN, INT8_MAX);
+		ENCODE(int8_t, le, INT8_MIN, INT8_MAX, float);
+		break;
 	case PCM_SAMPLE_UINT16_LE:
-		GET(uint16_t, le, UINT16_MIN, UINT16_MAX);
+		ENCODE(uint16_t, le, UINT16_MIN, UINT16_MAX, float);
+		break;
 	case PCM_SAMPLE_SINT16_LE:
-		GET(int16_t, le, INT16_MIN, INT16_MAX);
+		ENCODE(int16_t, le, INT16_MIN, INT16_MAX, float);
+		break;
 	case PCM_SAMPLE_UINT16_BE:
-		GET(uint16_t, be, UINT16_MIN, UINT16_MAX);
+		ENCODE(uint16_t, be, UINT16_MIN, UINT16_MAX, float);
+		break;
 	case PCM_SAMPLE_SINT16_BE:
-		GET(int16_t, be, INT16_MIN, INT16_MAX);
+		ENCODE(int16_t, be, INT16_MIN, INT16_MAX, float);
+		break;
 	case PCM_SAMPLE_UINT24_32_LE:
 	case PCM_SAMPLE_UINT32_LE:
-		GET(uint32_t, le, UINT32_MIN, UINT32_MAX);
+		ENCODE(uint32_t, le, UINT32_MIN, UINT32_MAX, double);
+		break;
 	case PCM_SAMPLE_SINT24_32_LE:
 	case PCM_SAMPLE_SINT32_LE:
-		GET(int32_t, le, INT32_MIN, INT32_MAX);
+		ENCODE(int32_t, le, INT32_MIN, INT32_MAX, double);
+		break;
 	case PCM_SAMPLE_UINT24_32_BE:
 	case PCM_SAMPLE_UINT32_BE:
-		GET(uint32_t, be, UINT32_MIN, UINT32_MAX);
+		ENCODE(uint32_t, be, UINT32_MIN, UINT32_MAX, double);
+		break;
 	case PCM_SAMPLE_SINT24_32_BE:
 	case PCM_SAMPLE_SINT32_BE:
-		GET(int32_t, le, INT32_MIN, INT32_MAX);
+		ENCODE(int32_t, be, INT32_MIN, INT32_MAX, double);
+		break;
+	case PCM_SAMPLE_FLOAT32:
+		for (size_t i = 0; i < count; ++i)
+			((float *) dst)[i] = clip(src[i]);
+		break;
 	case PCM_SAMPLE_UINT24_LE:
 	case PCM_SAMPLE_SINT24_LE:
 	case PCM_SAMPLE_UINT24_BE:
 	case PCM_SAMPLE_SINT24_BE:
-	case PCM_SAMPLE_FLOAT32:
 	default:
 		break;
 	}
-	return 0;
-#undef GET
+#undef ENCODE
 }
+
 /**
  * @}
  */
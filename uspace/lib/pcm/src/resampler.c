@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup audio
+ * @brief PCM sampling rate conversion
+ * @{
+ */
+/** @file
+ * Polyphase resampler. The output rate relates to the input rate as up/down.
+ * The position of every output frame is kept as an input frame index plus
+ * a fraction in 1/up units, which selects the filter phase. Filters are
+ * windowed sincs cut off at the lower of the two Nyquist frequencies, so
+ * that downsampling does not alias.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <macros.h>
+#include <math.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "resampler.h"
+
+/** Maximum number of filter phases, positions in between are rounded down. */
+#define RESAMPLER_MAX_PHASES  256
+
+/** Number of input frames buffered at once, besides the filter history. */
+#define RESAMPLER_BLOCK  256
+
+/** Part of the pass band kept, leaves room for the filter transition. */
+#define RESAMPLER_CUTOFF  0.95f
+
+/** Upper bound on the filter length when downsampling by a large factor. */
+#define RESAMPLER_MAX_TAPS  256
+
+struct pcm_resampler {
+	unsigned channels;
+	unsigned from_rate;
+	unsigned to_rate;
+
+	/** Output frames advance the input by down/up frames */
+	uint64_t up;
+	uint64_t down;
+
+	/** Filter bank, taps coefficients for each of the phases */
+	float *filter;
+	unsigned phases;
+	unsigned taps;
+
+	/** Buffered input frames, channels interleaved */
+	float *buffer;
+	size_t capacity;
+	size_t buffered;
+
+	/**
+	 * Position of the next output frame in the buffer. It may point past
+	 * the buffered frames, those are skipped once they arrive.
+	 */
+	size_t pos;
+	uint64_t frac;
+};
+
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+	while (b != 0) {
+		const uint64_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/** Compute coefficients of all filter phases */
+static void resampler_design(pcm_resampler_t *r)
+{
+	if (r->taps == 2) {
+		for (unsigned p = 0; p < r->phases; ++p) {
+			const float frac = (float) p / (float) r->phases;
+			r->filter[p * 2] = 1.0f - frac;
+			r->filter[p * 2 + 1] = frac;
+		}
+		return;
+	}
+
+	const float cutoff = RESAMPLER_CUTOFF *
+	    min(1.0f, (float) r->up / (float) r->down);
+	const float half = r->taps / 2;
+	for (unsigned p = 0; p < r->phases; ++p) {
+		float *h = r->filter + p * r->taps;
+		const float frac = (float) p / (float) r->phases;
+		float sum = 0.0f;
+		for (unsigned k = 0; k < r->taps; ++k) {
+			/* Distance of the tap from the output position */
+			const float t = (float) k - (half - 1.0f) - frac;
+			const float x = M_PI * cutoff * t;
+			const float sinc = (x == 0.0f) ? 1.0f : sinf(x) / x;
+			/* Blackman window over <-half, half> */
+			const float w = 0.42f + 0.5f * cosf(M_PI * t / half) +
+			    0.08f * cosf(2.0f * M_PI * t / half);
+			h[k] = sinc * w;
+			sum += h[k];
+		}
+		/* Unit gain at DC */
+		for (unsigned k = 0; k < r->taps; ++k)
+			h[k] /= sum;
+	}
+}
+
+/**
+ * Create a resampler.
+ * @param channels Number of interleaved channels.
+ * @param from_rate Input sampling rate.
+ * @param to_rate Output sampling rate.
+ * @param quality Filter quality.
+ * @param rres Place to store the new resampler.
+ * @return Error code.
+ */
+errno_t pcm_resampler_create(unsigned channels, unsigned from_rate,
+    unsigned to_rate, pcm_resampler_quality_t quality, pcm_resampler_t **rres)
+{
+	assert(rres);
+	if (channels == 0 || from_rate == 0 || to_rate == 0)
+		return EINVAL;
+
+	pcm_resampler_t *r = calloc(1, sizeof(pcm_resampler_t));
+	if (!r)
+		return ENOMEM;
+
+	const uint64_t g = gcd(from_rate, to_rate);
+	r->channels = channels;
+	r->from_rate = from_rate;
+	r->to_rate = to_rate;
+	r->up = to_rate / g;
+	r->down = from_rate / g;
+	r->phases = min(r->up, (uint64_t) RESAMPLER_MAX_PHASES);
+
+	switch (quality) {
+	case PCM_RESAMPLER_LOW:
+		r->taps = 2;
+		break;
+	case PCM_RESAMPLER_MEDIUM:
+		r->taps = 16;
+		break;
+	case PCM_RESAMPLER_HIGH:
+	default:
+		r->taps = 32;
+		break;
+	}
+
+	/*
+	 * Downsampling lowers the cutoff by up/down, so the filter must get
+	 * longer by down/up to keep the same transition band and stop band
+	 * attenuation. Keep the number of taps even.
+	 */
+	if (r->taps > 2 && r->down > r->up) {
+		uint64_t taps = (r->taps * r->down + r->up - 1) / r->up;
+		taps = min(taps + (taps & 1), (uint64_t) RESAMPLER_MAX_TAPS);
+		r->taps = taps;
+	}
+
+	r->capacity = r->taps - 1 + RESAMPLER_BLOCK;
+	r->filter = calloc(r->phases * r->taps, sizeof(float));
+	r->buffer = calloc(r->capacity * channels, sizeof(float));
+	if (!r->filter || !r->buffer) {
+		pcm_resampler_destroy(r);
+		return ENOMEM;
+	}
+
+	resampler_design(r);
+	pcm_resampler_reset(r);
+	*rres = r;
+	return EOK;
+}
+
+/**
+ * Destroy a resampler.
+ * @param r Resampler, may be NULL.
+ */
+void pcm_resampler_destroy(pcm_resampler_t *r)
+{
+	if (!r)
+		return;
+	free(r->filter);
+	free(r->buffer);
+	free(r);
+}
+
+/**
+ * Check whether the resampler converts the given stream.
+ * @param r Resampler.
+ * @param channels Number of channels.
+ * @param from_rate Input sampling rate.
+ * @param to_rate Output sampling rate.
+ * @return True if the parameters match, false otherwise.
+ */
+bool pcm_resampler_matches(const pcm_resampler_t *r, unsigned channels,
+    unsigned from_rate, unsigned to_rate)
+{
+	assert(r);
+	return r->channels == channels && r->from_rate == from_rate &&
+	    r->to_rate == to_rate;
+}
+
+/**
+ * Forget buffered input, the next input frame starts a new stream.
+ * @param r Resampler.
+ */
+void pcm_resampler_reset(pcm_resampler_t *r)
+{
+	assert(r);
+	/* Silent history centers the first input frame in the filter. */
+	r->buffered = r->taps / 2 - 1;
+	memset(r->buffer, 0, r->buffered * r->channels * sizeof(float));
+	r->pos = 0;
+	r->frac = 0;
+}
+
+/**
+ * Number of input frames needed to produce the given number of output frames.
+ * @param r Resampler.
+ * @param out_frames Number of output frames.
+ * @return Number of input frames pcm_resampler_process() will consume.
+ */
+size_t pcm_resampler_input_frames(const pcm_resampler_t *r, size_t out_frames)
+{
+	assert(r);
+	if (out_frames == 0)
+		return 0;
+	const size_t last = r->pos +
+	    (r->frac + (out_frames - 1) * r->down) / r->up;
+	const size_t end = last + r->taps;
+	return (end > r->buffered) ? end - r->buffered : 0;
+}
+
+/** Drop frames no longer needed and buffer more input */
+static void resampler_refill(pcm_resampler_t *r, const float **in,
+    size_t *in_left)
+{
+	const unsigned ch = r->channels;
+	if (r->pos >= r->buffered) {
+		r->pos -= r->buffered;
+		r->buffered = 0;
+	} else {
+		memmove(r->buffer, r->buffer + r->pos * ch,
+		    (r->buffered - r->pos) * ch * sizeof(float));
+		r->buffered -= r->pos;
+		r->pos = 0;
+	}
+
+	/* Input frames the output position already passed */
+	const size_t skip = min(r->pos, *in_left);
+	*in += skip * ch;
+	*in_left -= skip;
+	r->pos -= skip;
+
+	const size_t count = min(r->capacity - r->buffered, *in_left);
+	memcpy(r->buffer + r->buffered * ch, *in, count * ch * sizeof(float));
+	r->buffered += count;
+	*in += count * ch;
+	*in_left -= count;
+}
+
+/**
+ * Resample interleaved float samples.
+ * @param r Resampler.
+ * @param in Input frames.
+ * @param in_frames Number of input frames, updated to the number consumed.
+ * @param out Output buffer.
+ * @param out_frames Size of the output buffer in frames, updated to the
+ *        number of frames produced.
+ *
+ * Input is consumed only as far as the output needs it, the filter history
+ * is kept between calls.
+ */
+void pcm_resampler_process(pcm_resampler_t *r, const float *in,
+    size_t *in_frames, float *out, size_t *out_frames)
+{
+	assert(r);
+	assert(in_frames);
+	assert(out_frames);
+	const unsigned ch = r->channels;
+	size_t in_left = *in_frames;
+	size_t produced = 0;
+
+	while (produced < *out_frames) {
+		if (r->pos + r->taps > r->buffered) {
+			if (in_left == 0)
+				break;
+			resampler_refill(r, &in, &in_left);
+			continue;
+		}
+
+		const unsigned phase = (r->frac * r->phases) / r->up;
+		const float *h = r->filter + phase * r->taps;
+		const float *x = r->buffer + r->pos * ch;
+		float *y = out + produced * ch;
+		for (unsigned c = 0; c < ch; ++c)
+			y[c] = 0.0f;
+		for (unsigned k = 0; k < r->taps; ++k) {
+			const float hk = h[k];
+			for (unsigned c = 0; c < ch; ++c)
+				y[c] += hk * x[k * ch + c];
+		}
+
+		++produced;
+		r->frac += r->down;
+		r->pos += r->frac / r->up;
+		r->frac %= r->up;
+	}
+
+	*in_frames -= in_left;
+	*out_frames = produced;
+}
+
+/**
+ * Convert frame count between sampling rates, rounding up.
+ * @param frames Number of frames at @p from_rate.
+ * @param from_rate Sampling rate of @p frames.
+ * @param to_rate Sampling rate to convert to.
+ * @return Number of frames at @p to_rate covering the same time.
+ */
+size_t pcm_resampler_convert_frames(size_t frames, unsigned from_rate,
+    unsigned to_rate)
+{
+	assert(from_rate);
+	return ((uint64_t) frames * to_rate + from_rate - 1) / from_rate;
+}
+
+/**
+ * @}
+ */
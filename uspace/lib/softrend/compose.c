@@ -33,8 +33,89 @@
  * @file
  */
 
+#include <mem.h>
+#include <stdbool.h>
 #include "compose.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/** Multiply two 8-bit channel values and divide by 255, rounding. */
+static inline uint32_t mul_255(uint32_t a, uint32_t b)
+{
+	uint32_t t = a * b + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+static inline pixel_t over(pixel_t fg, pixel_t bg)
+{
+	uint32_t fg_a = ALPHA(fg);
+	uint32_t inv_a = mul_255(ALPHA(bg), 255 - fg_a);
+
+	return PIXEL(fg_a + inv_a,
+	    mul_255(RED(fg), fg_a) + mul_255(RED(bg), inv_a),
+	    mul_255(GREEN(fg), fg_a) + mul_255(GREEN(bg), inv_a),
+	    mul_255(BLUE(fg), fg_a) + mul_255(BLUE(bg), inv_a));
+}
+
+#ifdef __SSE2__
+
+/** Vector version of mul_255() working on 16-bit lanes. */
+static inline __m128i mul_255_epi16(__m128i a, __m128i b)
+{
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static inline __m128i alpha_epi16(__m128i pixels)
+{
+	pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+	return _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/** Vector version of over() for two pixels unpacked into 16-bit lanes.
+ *
+ * Forcing the multiplier of the foreground and the background itself
+ * to 255 in the alpha lanes makes the same multiply-add produce the
+ * resulting alpha.
+ */
+static inline __m128i over_epi16(__m128i fg, __m128i bg)
+{
+	const __m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+	__m128i fg_a = alpha_epi16(fg);
+	__m128i inv_a = mul_255_epi16(alpha_epi16(bg),
+	    _mm_sub_epi16(_mm_set1_epi16(255), fg_a));
+
+	return _mm_add_epi16(
+	    mul_255_epi16(fg, _mm_or_si128(fg_a, alpha_lanes)),
+	    mul_255_epi16(_mm_or_si128(bg, alpha_lanes), inv_a));
+}
+
+/** Compose four pixels over four pixels. */
+static inline __m128i over_epi32(__m128i fg, __m128i bg)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i lo = over_epi16(_mm_unpacklo_epi8(fg, zero),
+	    _mm_unpacklo_epi8(bg, zero));
+	__m128i hi = over_epi16(_mm_unpackhi_epi8(fg, zero),
+	    _mm_unpackhi_epi8(bg, zero));
+
+	return _mm_packus_epi16(lo, hi);
+}
+
+/** Check whether all four pixels are opaque. */
+static inline bool opaque_epi32(__m128i pixels)
+{
+	__m128i alpha = _mm_or_si128(pixels, _mm_set1_epi32(0x00ffffff));
+	return _mm_movemask_epi8(_mm_cmpeq_epi32(alpha,
+	    _mm_set1_epi32(-1))) == 0xffff;
+}
+
+#endif
+
 pixel_t compose_clr(pixel_t fg, pixel_t bg)
 {
 	return 0;
@@ -52,20 +133,7 @@ pixel_t compose_dst(pixel_t fg, pixel_t bg)
 
 pixel_t compose_over(pixel_t fg, pixel_t bg)
 {
-	uint8_t res_a;
-	uint8_t res_r;
-	uint8_t res_g;
-	uint8_t res_b;
-	uint32_t res_a_inv;
-
-	res_a_inv = ALPHA(bg) * (255 - ALPHA(fg));
-	res_a = ALPHA(fg) + (res_a_inv / 255);
-
-	res_r = (RED(fg) * ALPHA(fg) / 255) + (RED(bg) * res_a_inv) / (255 * 255);
-	res_g = (GREEN(fg) * ALPHA(fg) / 255) + (GREEN(bg) * res_a_inv) / (255 * 255);
-	res_b = (BLUE(fg) * ALPHA(fg) / 255) + (BLUE(bg) * res_a_inv) / (255 * 255);
-
-	return PIXEL(res_a, res_r, res_g, res_b);
+	return over(fg, bg);
 }
 
 pixel_t compose_in(pixel_t fg, pixel_t bg)
@@ -98,5 +166,92 @@ pixel_t compose_add(pixel_t fg, pixel_t bg)
 	return 0;
 }
 
+/** Copy a span of pixels. */
+void compose_span_src(pixel_t *dst, const pixel_t *src, size_t count)
+{
+	memcpy(dst, src, count * sizeof(pixel_t));
+}
+
+/** Compose a span of pixels over the destination.
+ *
+ * Yields the same results as compose_over() for each pixel.
+ */
+void compose_span_over(pixel_t *dst, const pixel_t *src, size_t count)
+{
+#ifdef __SSE2__
+	for (; count >= 4; count -= 4, src += 4, dst += 4) {
+		__m128i fg = _mm_loadu_si128((const __m128i *) src);
+
+		/* Opaque runs (e.g. window contents) are just copied. */
+		if (opaque_epi32(fg)) {
+			_mm_storeu_si128((__m128i *) dst, fg);
+			continue;
+		}
+
+		__m128i bg = _mm_loadu_si128((const __m128i *) dst);
+		_mm_storeu_si128((__m128i *) dst, over_epi32(fg, bg));
+	}
+#endif
+
+	for (size_t i = 0; i < count; i++) {
+		if (ALPHA(src[i]) == 255)
+			dst[i] = src[i];
+		else
+			dst[i] = over(src[i], dst[i]);
+	}
+}
+
+/** Fill a span of pixels with a color. */
+void compose_fill_src(pixel_t *dst, pixel_t color, size_t count)
+{
+#ifdef __SSE2__
+	__m128i fg = _mm_set1_epi32(color);
+	for (; count >= 4; count -= 4, dst += 4)
+		_mm_storeu_si128((__m128i *) dst, fg);
+#endif
+
+	for (size_t i = 0; i < count; i++)
+		dst[i] = color;
+}
+
+/** Compose a color over a span of pixels. */
+void compose_fill_over(pixel_t *dst, pixel_t color, size_t count)
+{
+	if (ALPHA(color) == 255) {
+		compose_fill_src(dst, color, count);
+		return;
+	}
+
+#ifdef __SSE2__
+	__m128i fg = _mm_set1_epi32(color);
+	for (; count >= 4; count -= 4, dst += 4) {
+		__m128i bg = _mm_loadu_si128((const __m128i *) dst);
+		_mm_storeu_si128((__m128i *) dst, over_epi32(fg, bg));
+	}
+#endif
+
+	for (size_t i = 0; i < count; i++)
+		dst[i] = over(color, dst[i]);
+}
+
+/** Get the span version of a compose function.
+ *
+ * @param compose Compose function.
+ *
+ * @return Span function with the same results or NULL if there
+ *         is none and the compose function has to be used for
+ *         each pixel.
+ */
+compose_span_t compose_get_span(compose_t compose)
+{
+	if (compose == compose_src)
+		return compose_span_src;
+
+	if (compose == compose_over)
+		return compose_span_over;
+
+	return NULL;
+}
+
 /** @}
  */
@@ -36,10 +36,14 @@
 #ifndef SOFTREND_COMPOSE_H_
 #define SOFTREND_COMPOSE_H_
 
+#include <stddef.h>
 #include <io/pixel.h>
 
 typedef pixel_t (*compose_t)(pixel_t, pixel_t);
 
+/** Compose a span of source pixels onto a span of destination pixels. */
+typedef void (*compose_span_t)(pixel_t *, const pixel_t *, size_t);
+
 extern pixel_t compose_clr(pixel_t, pixel_t);
 extern pixel_t compose_src(pixel_t, pixel_t);
 extern pixel_t compose_dst(pixel_t, pixel_t);
@@ -51,6 +55,14 @@ extern pixel_t compose_atop(pixel_t, pixel_t);
 extern pixel_t compose_xor(pixel_t, pixel_t);
 extern pixel_t compose_add(pixel_t, pixel_t);
 
+extern void compose_span_src(pixel_t *, const pixel_t *, size_t);
+extern void compose_span_over(pixel_t *, const pixel_t *, size_t);
+
+extern void compose_fill_src(pixel_t *, pixel_t, size_t);
+extern void compose_fill_over(pixel_t *, pixel_t, size_t);
+
+extern compose_span_t compose_get_span(compose_t);
+
 #endif
 
 /** @}
@@ -34,80 +34,138 @@
  * @file
  */
 
+#include <stdbool.h>
 #include "filter.h"
 #include <io/pixel.h>
 
-static long _round(double val)
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define FIXED_FRAC_MASK  (FILTER_FIXED_ONE - 1)
+
+/** Integer part of a fixed point coordinate (rounded down). */
+static inline int64_t fixed_floor(int64_t val)
 {
-	return val > 0 ? (long) (val + 0.5) : (long) (val - 0.5);
+	return val >> FILTER_FIXED_SHIFT;
 }
 
-static long _floor(double val)
+/** Fractional part of a fixed point coordinate as 8-bit weight. */
+static inline uint32_t fixed_weight(int64_t val)
 {
-	long lval = (long) val;
-	if (val < 0 && lval != val)
-		return lval - 1;
-	return lval;
+	return (val & FIXED_FRAC_MASK) >> (FILTER_FIXED_SHIFT - 8);
 }
 
-static long _ceil(double val)
+static inline bool in_bounds(pixelmap_t *pixmap, int64_t x, int64_t y)
 {
-	long lval = (long) val;
-	if (val > 0 && lval != val)
-		return lval + 1;
-	return lval;
+	return ((uint64_t) x < pixmap->width) && ((uint64_t) y < pixmap->height);
 }
 
-static inline pixel_t blend_pixels(size_t count, float *weights,
-    pixel_t *pixels)
+/** Interpolate two pixels with an 8-bit weight of the second one.
+ *
+ * Two channels are interpolated at once, each of them has
+ * 16 bits of room for the intermediate result.
+ */
+static inline pixel_t lerp(pixel_t a, pixel_t b, uint32_t weight)
 {
-	float alpha = 0, red = 0, green = 0, blue = 0;
-	for (size_t index = 0; index < count; index++) {
-		alpha += weights[index] * ALPHA(pixels[index]);
-		red   += weights[index] *   RED(pixels[index]);
-		green += weights[index] * GREEN(pixels[index]);
-		blue  += weights[index] *  BLUE(pixels[index]);
-	}
+	uint32_t a_rb = a & 0x00ff00ff;
+	uint32_t a_ag = (a >> 8) & 0x00ff00ff;
+	uint32_t b_rb = b & 0x00ff00ff;
+	uint32_t b_ag = (b >> 8) & 0x00ff00ff;
 
-	return PIXEL((uint8_t) alpha, (uint8_t) red, (uint8_t) green,
-	    (uint8_t) blue);
+	uint32_t rb = ((a_rb * (256 - weight) + b_rb * weight) >> 8) & 0x00ff00ff;
+	uint32_t ag = ((a_ag * (256 - weight) + b_ag * weight) >> 8) & 0x00ff00ff;
+
+	return rb | (ag << 8);
 }
 
-pixel_t filter_nearest(pixelmap_t *pixmap, double x, double y,
-    pixelmap_extend_t extend)
+static inline pixel_t bilinear(pixel_t top_left, pixel_t top_right,
+    pixel_t bottom_left, pixel_t bottom_right, uint32_t x_weight,
+    uint32_t y_weight)
 {
-	return pixelmap_get_extended_pixel(pixmap, _round(x), _round(y), extend);
+	return lerp(lerp(top_left, bottom_left, y_weight),
+	    lerp(top_right, bottom_right, y_weight), x_weight);
 }
 
-pixel_t filter_bilinear(pixelmap_t *pixmap, double x, double y,
+static inline pixel_t bilinear_at(pixelmap_t *pixmap, int64_t x, int64_t y,
     pixelmap_extend_t extend)
 {
-	long x1 = _floor(x);
-	long x2 = _ceil(x);
-	long y1 = _floor(y);
-	long y2 = _ceil(y);
-
-	if (y1 == y2 && x1 == x2) {
-		return pixelmap_get_extended_pixel(pixmap,
-		    (sysarg_t) x1, (sysarg_t) y1, extend);
+	int64_t x1 = fixed_floor(x);
+	int64_t y1 = fixed_floor(y);
+
+	if (in_bounds(pixmap, x1, y1) && in_bounds(pixmap, x1 + 1, y1 + 1)) {
+		const pixel_t *top = pixmap->data + y1 * pixmap->width + x1;
+		const pixel_t *bottom = top + pixmap->width;
+
+		return bilinear(top[0], top[1], bottom[0], bottom[1],
+		    fixed_weight(x), fixed_weight(y));
 	}
 
-	double x_delta = x - x1;
-	double y_delta = y - y1;
+	return bilinear(
+	    pixelmap_get_extended_pixel(pixmap, x1, y1, extend),
+	    pixelmap_get_extended_pixel(pixmap, x1 + 1, y1, extend),
+	    pixelmap_get_extended_pixel(pixmap, x1, y1 + 1, extend),
+	    pixelmap_get_extended_pixel(pixmap, x1 + 1, y1 + 1, extend),
+	    fixed_weight(x), fixed_weight(y));
+}
 
-	pixel_t pixels[4];
-	pixels[0] = pixelmap_get_extended_pixel(pixmap, x1, y1, extend);
-	pixels[1] = pixelmap_get_extended_pixel(pixmap, x2, y1, extend);
-	pixels[2] = pixelmap_get_extended_pixel(pixmap, x1, y2, extend);
-	pixels[3] = pixelmap_get_extended_pixel(pixmap, x2, y2, extend);
+#ifdef __SSE2__
 
-	float weights[4];
-	weights[0] = (1 - x_delta) * (1 - y_delta);
-	weights[1] = x_delta       * (1 - y_delta);
-	weights[2] = (1 - x_delta) * y_delta;
-	weights[3] = x_delta       * y_delta;
+/** Vector version of lerp() working on 16-bit lanes. */
+static inline __m128i lerp_epi16(__m128i a, __m128i b, __m128i weight)
+{
+	__m128i inv_weight = _mm_sub_epi16(_mm_set1_epi16(256), weight);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, inv_weight),
+	    _mm_mullo_epi16(b, weight)), 8);
+}
 
-	return blend_pixels(4, weights, pixels);
+/** Interpolate between the top and bottom pixel pairs at a position. */
+static inline __m128i bilinear_column_epi16(const pixel_t *top,
+    size_t scanline, uint32_t y_weight)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i upper = _mm_unpacklo_epi8(
+	    _mm_loadl_epi64((const __m128i *) top), zero);
+	__m128i lower = _mm_unpacklo_epi8(
+	    _mm_loadl_epi64((const __m128i *) (top + scanline)), zero);
+
+	return lerp_epi16(upper, lower, _mm_set1_epi16(y_weight));
+}
+
+#endif
+
+/** Fixed point representation of a coordinate. */
+int64_t filter_fixed(double val)
+{
+	double fixed = val * FILTER_FIXED_ONE;
+	return fixed > 0 ? (int64_t) (fixed + 0.5) : (int64_t) (fixed - 0.5);
+}
+
+pixel_t filter_nearest(pixelmap_t *pixmap, double x, double y,
+    pixelmap_extend_t extend)
+{
+	filter_span_pos_t pos = {
+		.x = filter_fixed(x),
+		.y = filter_fixed(y)
+	};
+
+	pixel_t pixel;
+	filter_nearest_span(pixmap, &pos, 1, extend, &pixel);
+	return pixel;
+}
+
+pixel_t filter_bilinear(pixelmap_t *pixmap, double x, double y,
+    pixelmap_extend_t extend)
+{
+	filter_span_pos_t pos = {
+		.x = filter_fixed(x),
+		.y = filter_fixed(y)
+	};
+
+	pixel_t pixel;
+	filter_bilinear_span(pixmap, &pos, 1, extend, &pixel);
+	return pixel;
 }
 
 pixel_t filter_bicubic(pixelmap_t *pixmap, double x, double y,
@@ -117,5 +175,131 @@ pixel_t filter_bicubic(pixelmap_t *pixmap, double x, double y,
 	return 0;
 }
 
+/** Sample a span of pixels with the nearest neighbour filter.
+ *
+ * @param pixmap Source pixelmap.
+ * @param pos    Position of the first sample and the step between samples.
+ * @param count  Number of samples.
+ * @param extend Handling of samples outside of the pixelmap.
+ * @param dst    Buffer for the samples.
+ */
+void filter_nearest_span(pixelmap_t *pixmap, const filter_span_pos_t *pos,
+    size_t count, pixelmap_extend_t extend, pixel_t *dst)
+{
+	int64_t x = pos->x + FILTER_FIXED_ONE / 2;
+	int64_t y = pos->y + FILTER_FIXED_ONE / 2;
+
+	/* Rows that are only translated are copied. */
+	if (pos->dx == FILTER_FIXED_ONE && pos->dy == 0 && count > 0 &&
+	    in_bounds(pixmap, fixed_floor(x), fixed_floor(y)) &&
+	    in_bounds(pixmap, fixed_floor(x) + count - 1, fixed_floor(y))) {
+		const pixel_t *src = pixmap->data +
+		    fixed_floor(y) * pixmap->width + fixed_floor(x);
+		for (size_t i = 0; i < count; i++)
+			dst[i] = src[i];
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		int64_t px = fixed_floor(x);
+		int64_t py = fixed_floor(y);
+
+		if (in_bounds(pixmap, px, py))
+			dst[i] = pixmap->data[py * pixmap->width + px];
+		else
+			dst[i] = pixelmap_get_extended_pixel(pixmap, px, py, extend);
+
+		x += pos->dx;
+		y += pos->dy;
+	}
+}
+
+/** Sample a span of pixels with the bilinear filter.
+ *
+ * The interpolation uses 8-bit weights, a sample that lies exactly
+ * on a pixel yields that pixel.
+ *
+ * @param pixmap Source pixelmap.
+ * @param pos    Position of the first sample and the step between samples.
+ * @param count  Number of samples.
+ * @param extend Handling of samples outside of the pixelmap.
+ * @param dst    Buffer for the samples.
+ */
+void filter_bilinear_span(pixelmap_t *pixmap, const filter_span_pos_t *pos,
+    size_t count, pixelmap_extend_t extend, pixel_t *dst)
+{
+	/* Whole pixel steps from a whole pixel never interpolate. */
+	if (((pos->x | pos->y | pos->dx | pos->dy) & FIXED_FRAC_MASK) == 0) {
+		filter_nearest_span(pixmap, pos, count, extend, dst);
+		return;
+	}
+
+	int64_t x = pos->x;
+	int64_t y = pos->y;
+	size_t i = 0;
+
+#ifdef __SSE2__
+	while (i + 1 < count) {
+		int64_t x1 = fixed_floor(x);
+		int64_t y1 = fixed_floor(y);
+		int64_t x2 = fixed_floor(x + pos->dx);
+		int64_t y2 = fixed_floor(y + pos->dy);
+
+		/* Samples near the edges take the slow way. */
+		if (!in_bounds(pixmap, x1, y1) || !in_bounds(pixmap, x1 + 1, y1 + 1) ||
+		    !in_bounds(pixmap, x2, y2) || !in_bounds(pixmap, x2 + 1, y2 + 1)) {
+			dst[i++] = bilinear_at(pixmap, x, y, extend);
+			x += pos->dx;
+			y += pos->dy;
+			continue;
+		}
+
+		__m128i first = bilinear_column_epi16(
+		    pixmap->data + y1 * pixmap->width + x1,
+		    pixmap->width, fixed_weight(y));
+		__m128i second = bilinear_column_epi16(
+		    pixmap->data + y2 * pixmap->width + x2,
+		    pixmap->width, fixed_weight(y + pos->dy));
+
+		uint32_t w1 = fixed_weight(x);
+		uint32_t w2 = fixed_weight(x + pos->dx);
+		__m128i res = lerp_epi16(
+		    _mm_unpacklo_epi64(first, second),
+		    _mm_unpackhi_epi64(first, second),
+		    _mm_set_epi16(w2, w2, w2, w2, w1, w1, w1, w1));
+
+		_mm_storel_epi64((__m128i *) (dst + i), _mm_packus_epi16(res, res));
+
+		i += 2;
+		x += 2 * pos->dx;
+		y += 2 * pos->dy;
+	}
+#endif
+
+	for (; i < count; i++) {
+		dst[i] = bilinear_at(pixmap, x, y, extend);
+		x += pos->dx;
+		y += pos->dy;
+	}
+}
+
+/** Get the span version of a filter.
+ *
+ * @param filter Filter function.
+ *
+ * @return Span function with the same results or NULL if there
+ *         is none and the filter has to be used for each pixel.
+ */
+filter_span_t filter_get_span(filter_t filter)
+{
+	if (filter == filter_nearest)
+		return filter_nearest_span;
+
+	if (filter == filter_bilinear)
+		return filter_bilinear_span;
+
+	return NULL;
+}
+
 /** @}
  */
@@ -36,14 +36,41 @@
 #ifndef SOFTREND_FILTER_H_
 #define SOFTREND_FILTER_H_
 
+#include <stddef.h>
+#include <stdint.h>
 #include <io/pixelmap.h>
 
+/** Number of fractional bits of span coordinates. */
+#define FILTER_FIXED_SHIFT  16
+#define FILTER_FIXED_ONE  (INT64_C(1) << FILTER_FIXED_SHIFT)
+
+/** Affine walk through a pixelmap in fixed point coordinates. */
+typedef struct {
+	/** Position of the first sample */
+	int64_t x;
+	int64_t y;
+
+	/** Distance between two consecutive samples */
+	int64_t dx;
+	int64_t dy;
+} filter_span_pos_t;
+
 typedef pixel_t (*filter_t)(pixelmap_t *, double, double, pixelmap_extend_t);
+typedef void (*filter_span_t)(pixelmap_t *, const filter_span_pos_t *,
+    size_t, pixelmap_extend_t, pixel_t *);
 
 extern pixel_t filter_nearest(pixelmap_t *, double, double, pixelmap_extend_t);
 extern pixel_t filter_bilinear(pixelmap_t *, double, double, pixelmap_extend_t);
 extern pixel_t filter_bicubic(pixelmap_t *, double, double, pixelmap_extend_t);
 
+extern void filter_nearest_span(pixelmap_t *, const filter_span_pos_t *,
+    size_t, pixelmap_extend_t, pixel_t *);
+extern void filter_bilinear_span(pixelmap_t *, const filter_span_pos_t *,
+    size_t, pixelmap_extend_t, pixel_t *);
+
+extern filter_span_t filter_get_span(filter_t);
+extern int64_t filter_fixed(double);
+
 #endif
 
 /** @}
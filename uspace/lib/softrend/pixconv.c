@@ -37,6 +37,10 @@
 #include <byteorder.h>
 #include "pixconv.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /** Pixel conversion and mask functions
  *
  * These functions write an ARGB pixel value to a memory location
@@ -147,6 +151,80 @@ void pixel2gray_8(void *dst, pixel_t pix)
 	*((uint8_t *) dst) = (red + green + blue) >> 24;
 }
 
+/** Span versions of the pixel conversion functions
+ *
+ * The conversion of each pixel is inlined into the loop instead of
+ * being called through a pointer. Formats that only reorder or drop
+ * channels of a 32-bit pixel are converted four pixels at a time
+ * with SSE2 (which implies a little endian host, so the vector
+ * expressions produce the visual as a little endian word).
+ */
+
+#define PIXEL2VISUAL_SPAN(name, bytes) \
+	void name##_span(void *dst, const pixel_t *src, size_t count) \
+	{ \
+		uint8_t *visual = (uint8_t *) dst; \
+		for (size_t i = 0; i < count; i++) \
+			name(visual + i * (bytes), src[i]); \
+	}
+
+#ifdef __SSE2__
+
+static inline __m128i bswap_epi32(__m128i v)
+{
+	v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+static inline __m128i rotl8_epi32(__m128i v)
+{
+	return _mm_or_si128(_mm_slli_epi32(v, 8), _mm_srli_epi32(v, 24));
+}
+
+static inline __m128i mask_epi32(__m128i v, uint32_t mask)
+{
+	return _mm_and_si128(v, _mm_set1_epi32((int) mask));
+}
+
+#define PIXEL2VISUAL_SPAN_8888(name, expr) \
+	void name##_span(void *dst, const pixel_t *src, size_t count) \
+	{ \
+		uint8_t *visual = (uint8_t *) dst; \
+		for (; count >= 4; count -= 4, src += 4, visual += 16) { \
+			__m128i v = _mm_loadu_si128((const __m128i *) src); \
+			_mm_storeu_si128((__m128i *) visual, (expr)); \
+		} \
+		for (size_t i = 0; i < count; i++) \
+			name(visual + i * 4, src[i]); \
+	}
+
+#else
+
+#define PIXEL2VISUAL_SPAN_8888(name, expr) \
+	PIXEL2VISUAL_SPAN(name, 4)
+
+#endif
+
+PIXEL2VISUAL_SPAN_8888(pixel2argb_8888, bswap_epi32(v))
+PIXEL2VISUAL_SPAN_8888(pixel2abgr_8888, rotl8_epi32(v))
+PIXEL2VISUAL_SPAN_8888(pixel2rgba_8888, bswap_epi32(rotl8_epi32(v)))
+PIXEL2VISUAL_SPAN_8888(pixel2bgra_8888, v)
+PIXEL2VISUAL_SPAN_8888(pixel2rgb_0888, mask_epi32(bswap_epi32(v), 0xffffff00))
+PIXEL2VISUAL_SPAN_8888(pixel2bgr_0888, mask_epi32(rotl8_epi32(v), 0xffffff00))
+PIXEL2VISUAL_SPAN_8888(pixel2rgb_8880,
+    mask_epi32(bswap_epi32(rotl8_epi32(v)), 0x00ffffff))
+PIXEL2VISUAL_SPAN_8888(pixel2bgr_8880, mask_epi32(v, 0x00ffffff))
+
+PIXEL2VISUAL_SPAN(pixel2rgb_888, 3)
+PIXEL2VISUAL_SPAN(pixel2bgr_888, 3)
+PIXEL2VISUAL_SPAN(pixel2rgb_555_be, 2)
+PIXEL2VISUAL_SPAN(pixel2rgb_555_le, 2)
+PIXEL2VISUAL_SPAN(pixel2rgb_565_be, 2)
+PIXEL2VISUAL_SPAN(pixel2rgb_565_le, 2)
+PIXEL2VISUAL_SPAN(pixel2bgr_323, 1)
+PIXEL2VISUAL_SPAN(pixel2gray_8, 1)
+
 void visual_mask_8888(void *dst, bool mask)
 {
 	pixel2abgr_8888(dst, mask ? 0xffffffff : 0);
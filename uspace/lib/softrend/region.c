@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup softrend
+ * @{
+ */
+/**
+ * @file
+ */
+
+#include <mem.h>
+#include <stdlib.h>
+#include "rectangle.h"
+#include "region.h"
+
+/** Number of rectangles allocated for a region at first. */
+#define REGION_INITIAL_SIZE  8
+
+static bool rect_overlap(const region_rect_t *a, const region_rect_t *b)
+{
+	return (a->x < b->x + b->w) && (b->x < a->x + a->w) &&
+	    (a->y < b->y + b->h) && (b->y < a->y + a->h);
+}
+
+/** Split a rectangle into the parts not covered by another rectangle.
+ *
+ * The rectangles must overlap. The parts are the band above and the band
+ * below the covering rectangle in full width, followed by the parts on
+ * its left and right.
+ *
+ * @param a   Rectangle to split.
+ * @param b   Covering rectangle.
+ * @param out Array of at least four rectangles for the parts.
+ *
+ * @return Number of parts.
+ */
+static size_t rect_subtract(const region_rect_t *a, const region_rect_t *b,
+    region_rect_t *out)
+{
+	sysarg_t top = a->y;
+	sysarg_t bottom = a->y + a->h;
+	size_t count = 0;
+
+	if (b->y > a->y) {
+		out[count++] = (region_rect_t) { a->x, a->y, a->w, b->y - a->y };
+		top = b->y;
+	}
+
+	if (b->y + b->h < a->y + a->h) {
+		out[count++] = (region_rect_t) {
+			a->x, b->y + b->h, a->w, a->y + a->h - b->y - b->h
+		};
+		bottom = b->y + b->h;
+	}
+
+	if (b->x > a->x)
+		out[count++] = (region_rect_t) { a->x, top, b->x - a->x, bottom - top };
+
+	if (b->x + b->w < a->x + a->w) {
+		out[count++] = (region_rect_t) {
+			b->x + b->w, top, a->x + a->w - b->x - b->w, bottom - top
+		};
+	}
+
+	return count;
+}
+
+static errno_t region_reserve(region_t *region, size_t count)
+{
+	if (count <= region->size)
+		return EOK;
+
+	size_t size = region->size ? region->size : REGION_INITIAL_SIZE;
+	while (size < count)
+		size *= 2;
+
+	region_rect_t *rects = realloc(region->rects, size * sizeof(region_rect_t));
+	if (!rects)
+		return ENOMEM;
+
+	region->rects = rects;
+	region->size = size;
+	return EOK;
+}
+
+void region_init(region_t *region)
+{
+	region->rects = NULL;
+	region->count = 0;
+	region->size = 0;
+}
+
+void region_fini(region_t *region)
+{
+	free(region->rects);
+	region_init(region);
+}
+
+/** Make the region empty, keeping the allocated memory. */
+void region_clear(region_t *region)
+{
+	region->count = 0;
+}
+
+bool region_is_empty(const region_t *region)
+{
+	return region->count == 0;
+}
+
+/** Get the bounding rectangle of a region.
+ *
+ * @return False if the region is empty.
+ */
+bool region_bounds(const region_t *region,
+    sysarg_t *x_out, sysarg_t *y_out, sysarg_t *w_out, sysarg_t *h_out)
+{
+	if (region->count == 0) {
+		(*x_out) = 0;
+		(*y_out) = 0;
+		(*w_out) = 0;
+		(*h_out) = 0;
+		return false;
+	}
+
+	const region_rect_t *rect = &region->rects[0];
+	sysarg_t x = rect->x;
+	sysarg_t y = rect->y;
+	sysarg_t w = rect->w;
+	sysarg_t h = rect->h;
+
+	for (size_t i = 1; i < region->count; ++i) {
+		rect = &region->rects[i];
+		rectangle_union(x, y, w, h, rect->x, rect->y, rect->w, rect->h,
+		    &x, &y, &w, &h);
+	}
+
+	(*x_out) = x;
+	(*y_out) = y;
+	(*w_out) = w;
+	(*h_out) = h;
+	return true;
+}
+
+errno_t region_copy(region_t *region, const region_t *src)
+{
+	if (region == src)
+		return EOK;
+
+	errno_t rc = region_reserve(region, src->count);
+	if (rc != EOK)
+		return rc;
+
+	if (src->count > 0)
+		memcpy(region->rects, src->rects, src->count * sizeof(region_rect_t));
+
+	region->count = src->count;
+	return EOK;
+}
+
+/** Add a rectangle to a region.
+ *
+ * If there is not enough memory to keep the region exact, it is replaced
+ * by its bounding rectangle. The result is then a superset of the union,
+ * which is what damage tracking needs.
+ */
+errno_t region_union_rect(region_t *region,
+    sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h)
+{
+	if ((w == 0) || (h == 0))
+		return EOK;
+
+	errno_t rc = region_subtract_rect(region, x, y, w, h);
+	if (rc == EOK)
+		rc = region_reserve(region, region->count + 1);
+
+	if (rc != EOK) {
+		sysarg_t x_bnd, y_bnd, w_bnd, h_bnd;
+		if (!region_bounds(region, &x_bnd, &y_bnd, &w_bnd, &h_bnd))
+			return rc;
+
+		rectangle_union(x_bnd, y_bnd, w_bnd, h_bnd, x, y, w, h,
+		    &x_bnd, &y_bnd, &w_bnd, &h_bnd);
+		region->rects[0] = (region_rect_t) { x_bnd, y_bnd, w_bnd, h_bnd };
+		region->count = 1;
+		return EOK;
+	}
+
+	region->rects[region->count++] = (region_rect_t) { x, y, w, h };
+	return EOK;
+}
+
+/** Remove a rectangle from a region.
+ *
+ * The region is left unchanged if there is not enough memory.
+ */
+errno_t region_subtract_rect(region_t *region,
+    sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h)
+{
+	if ((w == 0) || (h == 0))
+		return EOK;
+
+	region_rect_t cut = { x, y, w, h };
+
+	size_t hits = 0;
+	for (size_t i = 0; i < region->count; ++i) {
+		if (rect_overlap(&region->rects[i], &cut))
+			++hits;
+	}
+
+	if (hits == 0)
+		return EOK;
+
+	/* Each hit rectangle is replaced by up to four parts. */
+	errno_t rc = region_reserve(region, region->count + 3 * hits);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * The first part replaces the split rectangle, the others are appended
+	 * behind the original rectangles. Rectangles covered completely are
+	 * marked by zero width and dropped afterwards.
+	 */
+	size_t end = region->count;
+	for (size_t i = 0; i < region->count; ++i) {
+		if (!rect_overlap(&region->rects[i], &cut))
+			continue;
+
+		region_rect_t parts[4];
+		size_t count = rect_subtract(&region->rects[i], &cut, parts);
+		if (count == 0) {
+			region->rects[i].w = 0;
+			continue;
+		}
+
+		region->rects[i] = parts[0];
+		for (size_t j = 1; j < count; ++j)
+			region->rects[end++] = parts[j];
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < end; ++i) {
+		if (region->rects[i].w != 0)
+			region->rects[count++] = region->rects[i];
+	}
+
+	region->count = count;
+	return EOK;
+}
+
+/** Remove one region from another.
+ *
+ * If there is not enough memory, the region is left as a superset
+ * of the difference.
+ */
+errno_t region_subtract(region_t *region, const region_t *other)
+{
+	if (region == other) {
+		region_clear(region);
+		return EOK;
+	}
+
+	for (size_t i = 0; i < other->count; ++i) {
+		const region_rect_t *rect = &other->rects[i];
+		errno_t rc = region_subtract_rect(region,
+		    rect->x, rect->y, rect->w, rect->h);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Clip a region to a rectangle.
+ *
+ * @param region Region to clip.
+ * @param x      Left edge of the rectangle.
+ * @param y      Top edge of the rectangle.
+ * @param w      Width of the rectangle.
+ * @param h      Height of the rectangle.
+ * @param out    Region that receives the intersection, must be
+ *               different from the clipped region.
+ */
+errno_t region_intersect_rect(const region_t *region,
+    sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h, region_t *out)
+{
+	region_clear(out);
+
+	errno_t rc = region_reserve(out, region->count);
+	if (rc != EOK)
+		return rc;
+
+	for (size_t i = 0; i < region->count; ++i) {
+		const region_rect_t *rect = &region->rects[i];
+		region_rect_t *isec = &out->rects[out->count];
+		if (rectangle_intersect(rect->x, rect->y, rect->w, rect->h,
+		    x, y, w, h, &isec->x, &isec->y, &isec->w, &isec->h))
+			++out->count;
+	}
+
+	return EOK;
+}
+
+/** Replace a region by its bounding rectangle if it has too many parts.
+ *
+ * This bounds the cost of further operations at the expense of
+ * covering pixels that were not part of the region.
+ */
+void region_simplify(region_t *region, size_t max_count)
+{
+	if (region->count <= max_count)
+		return;
+
+	region_rect_t *rect = &region->rects[0];
+	region_bounds(region, &rect->x, &rect->y, &rect->w, &rect->h);
+	region->count = 1;
+}
+
+/** @}
+ */
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <pcut/pcut.h>
+#include "../region.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(region);
+
+static sysarg_t region_area(const region_t *region)
+{
+	sysarg_t area = 0;
+	for (size_t i = 0; i < region->count; ++i)
+		area += region->rects[i].w * region->rects[i].h;
+
+	return area;
+}
+
+/** Count the rectangles of a region that contain a pixel. */
+static size_t region_hits(const region_t *region, sysarg_t x, sysarg_t y)
+{
+	size_t hits = 0;
+	for (size_t i = 0; i < region->count; ++i) {
+		const region_rect_t *rect = &region->rects[i];
+		if ((x >= rect->x) && (x < rect->x + rect->w) &&
+		    (y >= rect->y) && (y < rect->y + rect->h))
+			++hits;
+	}
+
+	return hits;
+}
+
+/** Union of overlapping rectangles keeps the parts disjoint. */
+PCUT_TEST(union_overlapping)
+{
+	region_t region;
+	region_init(&region);
+
+	errno_t rc = region_union_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_union_rect(&region, 5, 5, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_union_rect(&region, 2, 2, 3, 3);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+
+	for (sysarg_t y = 0; y < 16; ++y) {
+		for (sysarg_t x = 0; x < 16; ++x) {
+			bool inside = ((x < 10) && (y < 10)) ||
+			    ((x >= 5) && (x < 15) && (y >= 5) && (y < 15));
+			PCUT_ASSERT_INT_EQUALS(inside ? 1 : 0,
+			    region_hits(&region, x, y));
+		}
+	}
+
+	region_fini(&region);
+}
+
+/** Empty rectangles do not change a region. */
+PCUT_TEST(union_empty)
+{
+	region_t region;
+	region_init(&region);
+
+	errno_t rc = region_union_rect(&region, 3, 3, 0, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(region_is_empty(&region));
+
+	region_fini(&region);
+}
+
+/** Subtracting an inner rectangle leaves a frame. */
+PCUT_TEST(subtract_hole)
+{
+	region_t region;
+	region_init(&region);
+
+	errno_t rc = region_union_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_subtract_rect(&region, 3, 3, 4, 4);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(4, region.count);
+	PCUT_ASSERT_INT_EQUALS(84, region_area(&region));
+	PCUT_ASSERT_INT_EQUALS(0, region_hits(&region, 5, 5));
+	PCUT_ASSERT_INT_EQUALS(1, region_hits(&region, 2, 5));
+	PCUT_ASSERT_INT_EQUALS(1, region_hits(&region, 7, 7));
+
+	rc = region_subtract_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(region_is_empty(&region));
+
+	region_fini(&region);
+}
+
+/** Subtracting a region removes all of its parts. */
+PCUT_TEST(subtract_region)
+{
+	region_t region;
+	region_t cover;
+	region_init(&region);
+	region_init(&cover);
+
+	errno_t rc = region_union_rect(&region, 0, 0, 20, 20);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_union_rect(&cover, 0, 0, 20, 5);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_union_rect(&cover, 10, 0, 10, 20);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = region_subtract(&region, &cover);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(150, region_area(&region));
+
+	sysarg_t x, y, w, h;
+	PCUT_ASSERT_TRUE(region_bounds(&region, &x, &y, &w, &h));
+	PCUT_ASSERT_INT_EQUALS(0, x);
+	PCUT_ASSERT_INT_EQUALS(5, y);
+	PCUT_ASSERT_INT_EQUALS(10, w);
+	PCUT_ASSERT_INT_EQUALS(15, h);
+
+	region_fini(&cover);
+	region_fini(&region);
+}
+
+/** Clipping a region to a rectangle. */
+PCUT_TEST(intersect_rect)
+{
+	region_t region;
+	region_t clipped;
+	region_init(&region);
+	region_init(&clipped);
+
+	errno_t rc = region_union_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_union_rect(&region, 20, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = region_intersect_rect(&region, 5, 5, 20, 20, &clipped);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(2, clipped.count);
+	PCUT_ASSERT_INT_EQUALS(50, region_area(&clipped));
+
+	rc = region_intersect_rect(&region, 10, 0, 10, 10, &clipped);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(region_is_empty(&clipped));
+
+	region_fini(&clipped);
+	region_fini(&region);
+}
+
+/** Copy is independent of the original. */
+PCUT_TEST(copy)
+{
+	region_t region;
+	region_t copy;
+	region_init(&region);
+	region_init(&copy);
+
+	errno_t rc = region_union_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = region_copy(&copy, &region);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = region_subtract_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(region_is_empty(&region));
+	PCUT_ASSERT_INT_EQUALS(100, region_area(&copy));
+
+	region_fini(&copy);
+	region_fini(&region);
+}
+
+/** Simplification replaces a region by its bounding rectangle. */
+PCUT_TEST(simplify)
+{
+	region_t region;
+	region_init(&region);
+
+	for (sysarg_t i = 0; i < 4; ++i) {
+		errno_t rc = region_union_rect(&region, i * 10, i * 10, 5, 5);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	region_simplify(&region, 4);
+	PCUT_ASSERT_INT_EQUALS(4, region.count);
+
+	region_simplify(&region, 2);
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS(0, region.rects[0].x);
+	PCUT_ASSERT_INT_EQUALS(0, region.rects[0].y);
+	PCUT_ASSERT_INT_EQUALS(35, region.rects[0].w);
+	PCUT_ASSERT_INT_EQUALS(35, region.rects[0].h);
+
+	region_fini(&region);
+}
+
+PCUT_EXPORT(region);
@@ -35,6 +35,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <mem.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -45,7 +46,17 @@
 
 /** Tunables */
 enum {
-	amp_factor = 16
+	amp_factor = 16,
+	/** Number of frames mixed at a time */
+	mix_chunk = 256
+};
+
+/** Fixed-point arithmetic used for mixing */
+enum {
+	/** Fractional bits of the channel volume factor */
+	vol_frac_bits = 10,
+	/** Fractional bits of the mix buffer samples */
+	mix_frac_bits = 8
 };
 
 /** Standard definitions set in stone */
@@ -107,6 +118,7 @@ static void trackmod_instr_destroy(trackmod_instr_t *instr)
 
 	for (i = 0; i < instr->samples; i++)
 		trackmod_sample_destroy(&instr->sample[i]);
+	free(instr->sample);
 }
 
 /** Destroy pattern.
@@ -279,6 +291,7 @@ static void trackmod_process_instr(trackmod_modplay_t *modplay, size_t i,
 	sidx = instr->key_smp[cell->note] % instr->samples;
 	chan->sample = &instr->sample[sidx];
 	chan->smp_pos = 0;
+	chan->smp_frac = 0;
 	chan->lsmp = 0;
 
 	chan->volume = modplay->chan[i].sample->def_vol;
@@ -297,6 +310,7 @@ static void trackmod_process_keyoff_note(trackmod_modplay_t *modplay, size_t i)
 	chan->sample = NULL;
 	chan->period = 0;
 	chan->smp_pos = 0;
+	chan->smp_frac = 0;
 	chan->lsmp = 0;
 }
 
@@ -777,23 +791,35 @@ static void trackmod_next_tick(trackmod_modplay_t *modplay)
 }
 
 /** Create module playback object.
+ *
+ * Playback produces signed 16-bit samples in host byte order. The mix is
+ * mono, with more than one output channel the same data is written to
+ * each of them, so that the output can be passed to a sink of that format
+ * as is.
  *
  * @param module   Module
  * @param smp_freq Sampling frequency
+ * @param channels Number of output channels
  * @param rmodplay Place to store pointer to module playback object
+ * @return EOK on success, EINVAL if @a channels is zero, ENOMEM if out
+ *         of memory
  */
 errno_t trackmod_modplay_create(trackmod_module_t *module,
-    unsigned smp_freq, trackmod_modplay_t **rmodplay)
+    unsigned smp_freq, unsigned channels, trackmod_modplay_t **rmodplay)
 {
 	trackmod_modplay_t *modplay = NULL;
 
+	if (channels == 0)
+		return EINVAL;
+
 	modplay = calloc(1, sizeof(trackmod_modplay_t));
 	if (modplay == NULL)
 		goto error;
 
 	modplay->module = module;
 	modplay->smp_freq = smp_freq;
-	modplay->frame_size = sizeof(int16_t);
+	modplay->channels = channels;
+	modplay->frame_size = channels * sizeof(int16_t);
 	modplay->ord_idx = 0;
 	modplay->row = 0;
 	modplay->tick = 0;
@@ -852,7 +878,8 @@ static size_t samples_remain_tick(trackmod_modplay_t *modplay)
 
 /** Get sample frame.
  *
- * Get frame at the specified sample position.
+ * Get frame at the specified sample position. 8-bit samples are scaled
+ * to the 16-bit range.
  *
  * @param sample Sample
  * @param pos	 Position (frame index)
@@ -865,14 +892,30 @@ int trackmod_sample_get_frame(trackmod_sample_t *sample, size_t pos)
 
 	if (sample->bytes_smp == 1) {
 		i8p = (int8_t *)sample->data;
-		return i8p[pos];
+		return i8p[pos] * 256;
 	} else {
 		/* chan->sample->bytes_smp == 2 */
 		i16p = (int16_t *)sample->data;
-		return i16p[pos] / 256; /* XXX Retain full precision */
+		return i16p[pos];
 	}
 }
 
+/** Get sample frame with a known sample size.
+ *
+ * @param data      Sample data
+ * @param bytes_smp Bytes per sample
+ * @param pos       Position (frame index)
+ * @return          Frame value
+ */
+static inline int32_t sample_data_frame(const void *data, size_t bytes_smp,
+    size_t pos)
+{
+	if (bytes_smp == 1)
+		return ((const int8_t *)data)[pos] * 256;
+	else
+		return ((const int16_t *)data)[pos];
+}
+
 /** Advance sample position to next frame.
  *
  * @param chan Channel playback
@@ -901,48 +944,127 @@ static void chan_smp_next_frame(trackmod_chan_t *chan)
 	}
 }
 
-/** Render next sample on channel.
+/** Mix samples of a channel with a known sample size.
  *
- * @param modplay Module playback
- * @param cidx    Channel number
- * @return        Sample value
+ * Linear interpolation. Note this is slightly simplified:
+ * We ignore the half-sample offset and the boundary condition
+ * at the end of the sample (we should extend with zero).
+ *
+ * Within the loop (or the sample) frames are read directly, only
+ * crossing its end goes through chan_smp_next_frame().
+ *
+ * @param chan      Channel playback
+ * @param mix       Mix buffer
+ * @param nsamples  Number of samples to add to @a mix
+ * @param step      Sample position increment per output sample
+ *                  (frames, 32.32 fixed point)
+ * @param vol       Volume factor (@c vol_frac_bits fixed point)
+ * @param bytes_smp Bytes per sample
  */
-static int trackmod_chan_next_sample(trackmod_modplay_t *modplay,
-    size_t cidx)
+static inline void chan_mix_frames(trackmod_chan_t *chan, int32_t *mix,
+    size_t nsamples, uint64_t step, int32_t vol, size_t bytes_smp)
 {
-	int sl, sn;
-	int period, clk;
-	int s;
+	trackmod_sample_t *sample = chan->sample;
+	const void *data = sample->data;
+	size_t end;
+	size_t pos;
+	size_t adv;
+	uint32_t frac;
+	uint64_t nfrac;
+	int32_t sl, sn;
+	int32_t s;
+	size_t i;
+
+	if (sample->loop_type == tl_forward_loop)
+		end = sample->loop_start + sample->loop_len;
+	else
+		end = sample->length;
+
+	pos = chan->smp_pos;
+	frac = chan->smp_frac;
+	sl = chan->lsmp;
+	sn = sample_data_frame(data, bytes_smp, pos);
+
+	for (i = 0; i < nsamples; i++) {
+		/* 15-bit interpolation weight keeps the product in 32 bits */
+		s = sl + (((sn - sl) * (int32_t)(frac >> 17)) >> 15);
+		mix[i] += (s * vol) >> vol_frac_bits;
+
+		nfrac = (uint64_t)frac + step;
+		frac = (uint32_t)nfrac;
+		adv = nfrac >> 32;
+		if (adv == 0)
+			continue;
+
+		if (pos + adv < end) {
+			pos += adv;
+			sl = sample_data_frame(data, bytes_smp, pos - 1);
+			sn = sample_data_frame(data, bytes_smp, pos);
+			continue;
+		}
+
+		/* Reached end of loop or sample */
+		chan->smp_pos = pos;
+		while (adv > 0 && chan->sample != NULL) {
+			chan_smp_next_frame(chan);
+			--adv;
+		}
+
+		if (chan->sample == NULL) {
+			chan->smp_frac = 0;
+			return;
+		}
+
+		pos = chan->smp_pos;
+		sl = chan->lsmp;
+		sn = sample_data_frame(data, bytes_smp, pos);
+	}
 
+	chan->smp_pos = pos;
+	chan->smp_frac = frac;
+	chan->lsmp = sl;
+}
+
+/** Mix samples of a channel.
+ *
+ * Period and volume do not change within a tick, so the resampling
+ * step and the volume are converted to fixed point once per call.
+ *
+ * @param modplay  Module playback
+ * @param cidx     Channel number
+ * @param mix      Mix buffer
+ * @param nsamples Number of samples to add to @a mix
+ */
+static void trackmod_chan_mix(trackmod_modplay_t *modplay, size_t cidx,
+    int32_t *mix, size_t nsamples)
+{
 	trackmod_chan_t *chan = &modplay->chan[cidx];
+	uint64_t step;
+	int32_t vol;
 
 	if (chan->sample == NULL || chan->period == 0)
-		return 0;
+		return;
+
+	step = ((uint64_t)base_clock << 32) /
+	    ((uint64_t)modplay->smp_freq * chan->period);
 
 	/*
-	 * Linear interpolation. Note this is slightly simplified:
-	 * We ignore the half-sample offset and the boundary condition
-	 * at the end of the sample (we should extend with zero).
+	 * Volume is relative to 8-bit samples, scale it down by another
+	 * eight bits for our 16-bit frames.
 	 */
-	sl = (int)chan->lsmp * amp_factor * chan->volume / vol_max;
-	sn = (int)trackmod_sample_get_frame(chan->sample, chan->smp_pos) *
-	    amp_factor * chan->volume / vol_max;
-
-	period = (int)chan->period;
-	clk = (int)chan->smp_clk;
-
-	s = (sl * (period - clk) + sn * clk) / period;
-
-	chan->smp_clk += base_clock / modplay->smp_freq;
-	while (chan->sample != NULL && chan->smp_clk >= chan->period) {
-		chan->smp_clk -= chan->period;
-		chan_smp_next_frame(chan);
-	}
+	vol = (int32_t)((uint32_t)amp_factor * chan->volume <<
+	    (vol_frac_bits + mix_frac_bits - 8)) / vol_max;
 
-	return s;
+	if (chan->sample->bytes_smp == 1)
+		chan_mix_frames(chan, mix, nsamples, step, vol, 1);
+	else
+		chan_mix_frames(chan, mix, nsamples, step, vol, 2);
 }
 
 /** Render a segment of samples contained entirely within a tick.
+ *
+ * Channels are mixed into a 32-bit buffer @c mix_chunk frames at a time,
+ * the result is clipped and written to every output channel.
  *
  * @param modplay Module playback
  * @param buffer  Buffer for storing audio data
@@ -951,23 +1073,38 @@ static int trackmod_chan_next_sample(trackmod_modplay_t *modplay,
 static void get_samples_within_tick(trackmod_modplay_t *modplay,
     void *buffer, size_t bufsize)
 {
+	int32_t mix[mix_chunk];
+	int16_t *out = buffer;
 	size_t nsamples;
+	size_t now;
 	size_t smpidx;
 	size_t chan;
-	int s;
+	unsigned c;
+	int32_t s;
 
 	nsamples = bufsize / modplay->frame_size;
+	modplay->smp += nsamples;
+
+	while (nsamples > 0) {
+		now = min(nsamples, (size_t)mix_chunk);
+		memset(mix, 0, now * sizeof(int32_t));
 
-	for (smpidx = 0; smpidx < nsamples; smpidx++) {
-		s = 0;
-		for (chan = 0; chan < modplay->module->channels; chan++) {
-			s += trackmod_chan_next_sample(modplay, chan);
+		for (chan = 0; chan < modplay->module->channels; chan++)
+			trackmod_chan_mix(modplay, chan, mix, now);
+
+		for (smpidx = 0; smpidx < now; smpidx++) {
+			s = mix[smpidx] >> mix_frac_bits;
+			if (s > INT16_MAX)
+				s = INT16_MAX;
+			if (s < INT16_MIN)
+				s = INT16_MIN;
+
+			for (c = 0; c < modplay->channels; c++)
+				*out++ = s;
 		}
 
-		((int16_t *)buffer)[smpidx] = s;
+		nsamples -= now;
 	}
-
-	modplay->smp += nsamples;
 }
 
 /** Render a segment of samples.
@@ -138,11 +138,11 @@ typedef struct {
 typedef struct {
 	trackmod_sample_t *sample;
 	/** Value of sample before current position */
-	int8_t lsmp;
+	int16_t lsmp;
 	/** Sample position (in frames) */
 	size_t smp_pos;
-	/** Sample position (clock ticks within frame) */
-	size_t smp_clk;
+	/** Sample position (fraction of frame, 2^32 is one frame) */
+	uint32_t smp_frac;
 	/** Current period */
 	unsigned period;
 	/** Period after note was processed, zero if no note */
@@ -165,6 +165,8 @@ typedef struct {
 	trackmod_module_t *module;
 	/** Sampling frequency */
 	unsigned smp_freq;
+	/** Number of output channels */
+	unsigned channels;
 	/** Frame size (bytes per sample * channels) */
 	size_t frame_size;
 
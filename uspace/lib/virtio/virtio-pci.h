@@ -60,6 +60,9 @@
 
 #define VIRTIO_FEATURES_0_31	0
 
+/** Driver and device use the used_event and avail_event ring fields */
+#define VIRTIO_F_RING_EVENT_IDX	(1U << 29)
+
 /** Common configuration structure layout according to VIRTIO version 1.0 */
 typedef struct virtio_pci_common_cfg {
 	ioport32_t device_feature_select;
@@ -148,6 +151,19 @@ typedef struct {
 	virtq_used_t *used;
 	uint16_t used_last_idx;
 
+	/**
+	 * Address of the used_event field trailing the available ring. Only
+	 * meaningful if VIRTIO_F_RING_EVENT_IDX has been negotiated.
+	 */
+	ioport16_t *used_event;
+	/**
+	 * Address of the avail_event field trailing the used ring. Only
+	 * meaningful if VIRTIO_F_RING_EVENT_IDX has been negotiated.
+	 */
+	ioport16_t *avail_event;
+	/** Available ring index at the time of the last device notification */
+	uint16_t notify_last_idx;
+
 	/** Address of the queue's notification register */
 	ioport16_t *notify;
 } virtq_t;
@@ -176,6 +192,9 @@ typedef struct {
 	/** Device-specific configuration */
 	void *device_cfg;
 
+	/** Feature bits accepted during device setup */
+	uint32_t features;
+
 	/** Virtqueues */
 	virtq_t *queues;
 } virtio_dev_t;
@@ -195,13 +214,17 @@ extern uint16_t virtio_alloc_desc(virtio_dev_t *, uint16_t, uint16_t *);
 extern void virtio_free_desc(virtio_dev_t *, uint16_t, uint16_t *, uint16_t);
 
 extern void virtio_virtq_produce_available(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_enqueue_available(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_notify(virtio_dev_t *, uint16_t);
 extern bool virtio_virtq_consume_used(virtio_dev_t *, uint16_t, uint16_t *,
     uint32_t *);
+extern void virtio_virtq_irq_disable(virtio_dev_t *, uint16_t);
+extern bool virtio_virtq_irq_enable(virtio_dev_t *, uint16_t, uint16_t);
 
 extern errno_t virtio_virtq_setup(virtio_dev_t *, uint16_t, uint16_t);
 extern void virtio_virtq_teardown(virtio_dev_t *, uint16_t);
 
-extern errno_t virtio_device_setup_start(virtio_dev_t *, uint32_t);
+extern errno_t virtio_device_setup_start(virtio_dev_t *, uint32_t, uint32_t);
 extern void virtio_device_setup_fail(virtio_dev_t *);
 extern void virtio_device_setup_finalize(virtio_dev_t *);
 
@@ -32,6 +32,7 @@
 #include "virtio-pci.h"
 
 #include <as.h>
+#include <assert.h>
 #include <align.h>
 #include <macros.h>
 
@@ -168,7 +169,33 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 	fibril_mutex_unlock(&q->lock);
 }
 
-void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+/** Test whether the other side asked to be notified about an index update
+ *
+ * This is the vring_need_event() test from section 2.4.7.2 of the
+ * specification.
+ *
+ * @param event    Event index published by the other side.
+ * @param new_idx  Index after the update.
+ * @param old_idx  Index before the update.
+ *
+ * @return  True if the update moved the index past @a event.
+ */
+static inline bool virtio_need_event(uint16_t event, uint16_t new_idx,
+    uint16_t old_idx)
+{
+	return (uint16_t) (new_idx - event - 1) < (uint16_t) (new_idx - old_idx);
+}
+
+/** Put a descriptor into the available ring without notifying the device
+ *
+ * Several descriptors can be enqueued this way and then announced to the
+ * device at once using virtio_virtq_notify().
+ *
+ * @param vdev[in]    VIRTIO device.
+ * @param num[in]     Index of the virtqueue.
+ * @param descno[in]  Head of the descriptor chain to make available.
+ */
+void virtio_virtq_enqueue_available(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
 {
 	virtq_t *q = &vdev->queues[num];
@@ -178,11 +205,57 @@ void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
 	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
 	write_barrier();
 	pio_write_le16(&q->avail->idx, idx + 1);
-	write_barrier();
-	pio_write_le16(q->notify, num);
 	fibril_mutex_unlock(&q->lock);
 }
 
+/** Notify the device about descriptors enqueued since the last notification
+ *
+ * The notification register is written only if the device has not suppressed
+ * notifications, either via the avail_event index or via the
+ * VIRTQ_USED_F_NO_NOTIFY flag.
+ *
+ * @param vdev[in]  VIRTIO device.
+ * @param num[in]   Index of the virtqueue.
+ */
+void virtio_virtq_notify(virtio_dev_t *vdev, uint16_t num)
+{
+	virtq_t *q = &vdev->queues[num];
+	bool notify;
+
+	fibril_mutex_lock(&q->lock);
+
+	/* Make the new available index visible before reading the event */
+	memory_barrier();
+
+	uint16_t new_idx = pio_read_le16(&q->avail->idx);
+	uint16_t old_idx = q->notify_last_idx;
+	if (new_idx == old_idx) {
+		fibril_mutex_unlock(&q->lock);
+		return;
+	}
+
+	if (vdev->features & VIRTIO_F_RING_EVENT_IDX) {
+		notify = virtio_need_event(pio_read_le16(q->avail_event),
+		    new_idx, old_idx);
+	} else {
+		notify = !(pio_read_le16(&q->used->flags) &
+		    VIRTQ_USED_F_NO_NOTIFY);
+	}
+
+	q->notify_last_idx = new_idx;
+	if (notify)
+		pio_write_le16(q->notify, num);
+
+	fibril_mutex_unlock(&q->lock);
+}
+
+void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+    uint16_t descno)
+{
+	virtio_virtq_enqueue_available(vdev, num, descno);
+	virtio_virtq_notify(vdev, num);
+}
+
 bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
     uint16_t *descno, uint32_t *len)
 {
@@ -195,6 +268,9 @@ bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
 		return false;
 	}
 
+	/* Do not read the used element before we see the updated index */
+	read_barrier();
+
 	*descno = (uint16_t) pio_read_le32(&q->used->ring[last_idx].id);
 	*len = pio_read_le32(&q->used->ring[last_idx].len);
 
@@ -204,6 +280,69 @@ bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
 	return true;
 }
 
+/** Ask the device not to interrupt on used buffers of a virtqueue
+ *
+ * With VIRTIO_F_RING_EVENT_IDX the used_event index is parked just behind the
+ * current position so that the device does not reach it again until the
+ * index wraps around. Otherwise the VIRTQ_AVAIL_F_NO_INTERRUPT hint is set.
+ * The driver is then expected to reap the used ring on its own.
+ *
+ * @param vdev[in]  VIRTIO device.
+ * @param num[in]   Index of the virtqueue.
+ */
+void virtio_virtq_irq_disable(virtio_dev_t *vdev, uint16_t num)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	fibril_mutex_lock(&q->lock);
+	if (vdev->features & VIRTIO_F_RING_EVENT_IDX) {
+		pio_write_le16(q->used_event,
+		    (uint16_t) (q->used_last_idx - 1));
+	} else {
+		pio_write_le16(&q->avail->flags,
+		    pio_read_le16(&q->avail->flags) |
+		    VIRTQ_AVAIL_F_NO_INTERRUPT);
+	}
+	fibril_mutex_unlock(&q->lock);
+}
+
+/** Ask the device to interrupt once more buffers have been used
+ *
+ * @param vdev[in]   VIRTIO device.
+ * @param num[in]    Index of the virtqueue.
+ * @param batch[in]  Number of buffers the device should use before it
+ *                   interrupts. Values greater than one are only honoured if
+ *                   VIRTIO_F_RING_EVENT_IDX has been negotiated.
+ *
+ * @return  True if there are used buffers which arrived before the interrupt
+ *          was re-enabled and which the caller should consume now, false
+ *          otherwise.
+ */
+bool virtio_virtq_irq_enable(virtio_dev_t *vdev, uint16_t num, uint16_t batch)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	assert(batch > 0);
+
+	fibril_mutex_lock(&q->lock);
+	if (vdev->features & VIRTIO_F_RING_EVENT_IDX) {
+		pio_write_le16(q->used_event,
+		    (uint16_t) (q->used_last_idx + batch - 1));
+	} else {
+		pio_write_le16(&q->avail->flags,
+		    pio_read_le16(&q->avail->flags) &
+		    ~VIRTQ_AVAIL_F_NO_INTERRUPT);
+	}
+
+	/* Publish the event before re-checking the used index */
+	memory_barrier();
+
+	bool pending = (pio_read_le16(&q->used->idx) != q->used_last_idx);
+	fibril_mutex_unlock(&q->lock);
+
+	return pending;
+}
+
 errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 {
 	virtq_t *q = &vdev->queues[num];
@@ -256,6 +395,9 @@ errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 	q->avail = q->virt + avail_offset;
 	q->used = q->virt + used_offset;
 	q->used_last_idx = 0;
+	q->used_event = &q->avail->ring[size];
+	q->avail_event = (ioport16_t *) &q->used->ring[size];
+	q->notify_last_idx = 0;
 
 	memset(q->virt, 0, q->size);
 
@@ -297,8 +439,14 @@ void virtio_virtq_teardown(virtio_dev_t *vdev, uint16_t num)
 /**
  * Perform device initialization as described in section 3.1.1 of the
  * specification, steps 1 - 6.
+ *
+ * @param vdev[in]      VIRTIO device.
+ * @param features[in]  Feature bits the driver cannot work without.
+ * @param optional[in]  Feature bits the driver accepts if the device offers
+ *                      them. The accepted set is stored in vdev->features.
  */
-errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
+errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features,
+    uint32_t optional)
 {
 	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
 
@@ -322,13 +470,14 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 
 	if (features != (features & device_features))
 		return ENOTSUP;
-	features &= device_features;
+	features |= optional & device_features;
 
 	/* 4. Write the accepted feature flags */
 	pio_write_le32(&cfg->driver_feature_select, VIRTIO_FEATURES_0_31);
 	pio_write_le32(&cfg->driver_feature, features);
 
 	ddf_msg(LVL_NOTE, "accepted features %x", features);
+	vdev->features = features;
 
 	/* 5. Set FEATURES_OK */
 	status |= VIRTIO_DEV_STATUS_FEATURES_OK;
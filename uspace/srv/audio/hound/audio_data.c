@@ -34,11 +34,19 @@
  */
 
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
+#include <str_error.h>
 
 #include "audio_data.h"
 #include "log.h"
 
+/** Number of frames resampled at once */
+#define PIPE_RESAMPLE_FRAMES  256
+
+/** Resampling quality used for data of a different rate than the target */
+#define PIPE_RESAMPLER_QUALITY  PCM_RESAMPLER_MEDIUM
+
 /**
  * Create reference counted buffer out of ordinary data buffer.
  * @param data audio buffer. The memory passed will be freed eventually.
@@ -186,6 +194,9 @@ void audio_pipe_init(audio_pipe_t *pipe)
 	fibril_mutex_initialize(&pipe->guard);
 	pipe->frames = 0;
 	pipe->bytes = 0;
+	pipe->resampler = NULL;
+	pipe->samples = NULL;
+	pipe->samples_size = 0;
 }
 
 /**
@@ -199,6 +210,11 @@ void audio_pipe_fini(audio_pipe_t *pipe)
 		audio_data_t *adata = audio_pipe_pop(pipe);
 		audio_data_unref(adata);
 	}
+	pcm_resampler_destroy(pipe->resampler);
+	pipe->resampler = NULL;
+	free(pipe->samples);
+	pipe->samples = NULL;
+	pipe->samples_size = 0;
 }
 
 /**
@@ -247,6 +263,155 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe)
 	return adata;
 }
 
+/**
+ * Consume data from the first buffer of a pipe.
+ * @param pipe The audio pipe, guard must be held.
+ * @param alink The first data link of the pipe.
+ * @param frames Number of frames to consume.
+ */
+static void audio_pipe_consume(audio_pipe_t *pipe, audio_data_link_t *alink,
+    size_t frames)
+{
+	const size_t size = frames * pcm_format_frame_size(&alink->adata->format);
+	assert(size <= audio_data_link_remain_size(alink));
+	alink->position += size;
+	pipe->bytes -= size;
+	pipe->frames -= frames;
+	if (audio_data_link_remain_size(alink) == 0) {
+		list_remove(&alink->link);
+		audio_data_link_destroy(alink);
+	}
+}
+
+/**
+ * Read frames from a pipe as normalized float samples.
+ * @param pipe The audio pipe, guard must be held.
+ * @param dst Destination buffer.
+ * @param frames Number of frames to read.
+ * @param channels Number of channels to convert the frames to.
+ * @return Number of frames read.
+ */
+static size_t audio_pipe_read_float(audio_pipe_t *pipe, float *dst,
+    size_t frames, unsigned channels)
+{
+	size_t read = 0;
+	while (read < frames && !list_empty(&pipe->list)) {
+		audio_data_link_t *alink =
+		    audio_data_link_list_instance(list_first(&pipe->list));
+		const size_t count = min(audio_data_link_available_frames(alink),
+		    frames - read);
+		float *out = dst + read * channels;
+		if (pcm_format_decode(out, channels,
+		    audio_data_link_start(alink), count,
+		    &alink->adata->format) != EOK) {
+			log_warning("Unsupported format, playing silence.");
+			memset(out, 0, count * channels * sizeof(float));
+		}
+		read += count;
+		audio_pipe_consume(pipe, alink, count);
+	}
+	return read;
+}
+
+/**
+ * Get a resampler converting pipe data to the target format.
+ * @param pipe The audio pipe, guard must be held.
+ * @param f Target data format.
+ * @param rate Sampling rate of the data in the pipe.
+ * @return Resampler, NULL if it could not be created.
+ */
+static pcm_resampler_t *audio_pipe_resampler(audio_pipe_t *pipe,
+    const pcm_format_t *f, unsigned rate)
+{
+	if (!pipe->resampler || !pcm_resampler_matches(pipe->resampler,
+	    f->channels, rate, f->sampling_rate)) {
+		pcm_resampler_destroy(pipe->resampler);
+		pipe->resampler = NULL;
+		const errno_t rc = pcm_resampler_create(f->channels, rate,
+		    f->sampling_rate, PIPE_RESAMPLER_QUALITY, &pipe->resampler);
+		if (rc != EOK) {
+			log_error("Failed to create resampler %u -> %u: %s",
+			    rate, f->sampling_rate, str_error(rc));
+			return NULL;
+		}
+	}
+	return pipe->resampler;
+}
+
+/**
+ * Resample data stored in a pipe and mix it into the provided buffer.
+ * @param pipe The audio pipe, guard must be held.
+ * @param data Target buffer.
+ * @param size Target buffer size.
+ * @param f Target data format.
+ * @param rate Sampling rate of the data in the pipe.
+ * @return Size of the target buffer used.
+ */
+static size_t audio_pipe_resample_data(audio_pipe_t *pipe, void *data,
+    size_t size, const pcm_format_t *f, unsigned rate)
+{
+	if (!audio_pipe_resampler(pipe, f, rate))
+		return 0;
+
+	const size_t frame_size = pcm_format_frame_size(f);
+	size_t needed_frames = pcm_format_size_to_frames(size, f);
+	size_t copied_size = 0;
+	while (needed_frames > 0) {
+		size_t out_frames = min(needed_frames, PIPE_RESAMPLE_FRAMES);
+		const size_t in_frames =
+		    pcm_resampler_input_frames(pipe->resampler, out_frames);
+
+		const size_t samples_size = (in_frames + out_frames) * f->channels;
+		if (samples_size > pipe->samples_size) {
+			float *samples = realloc(pipe->samples,
+			    samples_size * sizeof(float));
+			if (!samples)
+				break;
+			pipe->samples = samples;
+			pipe->samples_size = samples_size;
+		}
+		float *in = pipe->samples;
+		float *out = pipe->samples + in_frames * f->channels;
+
+		size_t read = audio_pipe_read_float(pipe, in, in_frames,
+		    f->channels);
+		const bool underrun = read < in_frames;
+		pcm_resampler_process(pipe->resampler, in, &read, out,
+		    &out_frames);
+		pcm_format_mix_float(data, out, out_frames, f);
+
+		needed_frames -= out_frames;
+		copied_size += out_frames * frame_size;
+		data += out_frames * frame_size;
+		if (underrun)
+			break;
+	}
+	return copied_size;
+}
+
+/**
+ * Number of frames missing in a pipe to produce frames at another rate.
+ * @param pipe The audio pipe.
+ * @param frames Number of frames needed at the target rate.
+ * @param f Target data format.
+ * @param rate Sampling rate of the data pushed to the pipe.
+ * @return Number of frames at @p rate the pipe lacks.
+ */
+size_t audio_pipe_missing_frames(audio_pipe_t *pipe, size_t frames,
+    const pcm_format_t *f, unsigned rate)
+{
+	assert(pipe);
+	fibril_mutex_lock(&pipe->guard);
+	pcm_resampler_t *resampler = audio_pipe_resampler(pipe, f, rate);
+	const size_t needed = resampler ?
+	    pcm_resampler_input_frames(resampler, frames) :
+	    pcm_resampler_convert_frames(frames, f->sampling_rate, rate);
+	const size_t missing = (needed > pipe->frames) ?
+	    needed - pipe->frames : 0;
+	fibril_mutex_unlock(&pipe->guard);
+	return missing;
+}
+
 /**
  * Use data store in a pipe and mix it into the provided buffer.
  * @param pipe The piep that should provide data.
@@ -254,6 +419,8 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe)
  * @param size Target buffer size.
  * @param format Target data format.
  * @return Size of the target buffer used.
+ *
+ * Data of a different sampling rate are resampled to the target rate.
  */
 size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
     size_t size, const pcm_format_t *f)
@@ -270,6 +437,13 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
 		link_t *l = list_first(&pipe->list);
 		audio_data_link_t *alink = audio_data_link_list_instance(l);
 
+		const unsigned rate = alink->adata->format.sampling_rate;
+		if (rate != f->sampling_rate) {
+			copied_size += audio_pipe_resample_data(pipe, data,
+			    needed_frames * dst_frame_size, f, rate);
+			break;
+		}
+
 		/* Get audio chunk metadata */
 		const size_t src_frame_size =
 		    pcm_format_frame_size(&alink->adata->format);
@@ -279,8 +453,6 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
 		const size_t dst_copy_size = copy_frames * dst_frame_size;
 		const size_t src_copy_size = copy_frames * src_frame_size;
 
-		assert(src_copy_size <= audio_data_link_remain_size(alink));
-
 		/* Copy audio data */
 		pcm_format_convert_and_mix(data, dst_copy_size,
 		    audio_data_link_start(alink), src_copy_size,
@@ -290,15 +462,7 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
 		needed_frames -= copy_frames;
 		copied_size += dst_copy_size;
 		data += dst_copy_size;
-		alink->position += src_copy_size;
-		pipe->bytes -= src_copy_size;
-		pipe->frames -= copy_frames;
-		if (audio_data_link_remain_size(alink) == 0) {
-			list_remove(&alink->link);
-			audio_data_link_destroy(alink);
-		} else {
-			assert(needed_frames == 0);
-		}
+		audio_pipe_consume(pipe, alink, copy_frames);
 	}
 	fibril_mutex_unlock(&pipe->guard);
 	return copied_size;
@@ -41,6 +41,7 @@
 #include <errno.h>
 #include <fibril_synch.h>
 #include <pcm/format.h>
+#include <pcm/resampler.h>
 
 /** Reference counted audio buffer */
 typedef struct {
@@ -64,6 +65,12 @@ typedef struct {
 	size_t frames;
 	/** List access synchronization */
 	fibril_mutex_t guard;
+	/** Sampling rate converter, created when rates first differ */
+	pcm_resampler_t *resampler;
+	/** Float buffer used for resampling */
+	float *samples;
+	/** Size of the samples buffer (in floats) */
+	size_t samples_size;
 } audio_pipe_t;
 
 audio_data_t *audio_data_create(void *data, size_t size,
@@ -79,6 +86,8 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe);
 
 size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *buffer, size_t size,
     const pcm_format_t *f);
+size_t audio_pipe_missing_frames(audio_pipe_t *pipe, size_t frames,
+    const pcm_format_t *f, unsigned rate);
 
 /**
  * Total bytes getter.
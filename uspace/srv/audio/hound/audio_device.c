@@ -39,6 +39,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <loc.h>
+#include <macros.h>
 #include <stdbool.h>
 #include <str.h>
 #include <str_error.h>
@@ -47,9 +48,15 @@
 #include "audio_device.h"
 #include "log.h"
 
-/* hardwired to provide ~21ms per fragment */
+/* Fallback if the device can't interrupt every DEVICE_PERIOD_USEC */
 #define BUFFER_PARTS   16
 
+/* Target mixing period, the device interrupts once per fragment */
+#define DEVICE_PERIOD_USEC  5000
+
+/* Number of fragments mixed ahead of the device */
+#define FRAGMENTS_AHEAD  2
+
 static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new);
 static errno_t device_source_connection_callback(audio_source_t *source, bool new);
 static void device_event_callback(ipc_call_t *icall, void *arg);
@@ -57,6 +64,8 @@ static errno_t device_check_format(audio_sink_t *sink);
 static errno_t get_buffer(audio_device_t *dev);
 static errno_t release_buffer(audio_device_t *dev);
 static void advance_buffer(audio_device_t *dev, size_t size);
+static void set_fragment_size(audio_device_t *dev, const pcm_format_t *f);
+static void mix_fragment(audio_device_t *dev);
 static inline bool is_running(audio_device_t *dev)
 {
 	assert(dev);
@@ -94,6 +103,9 @@ errno_t audio_device_init(audio_device_t *dev, service_id_t id, const char *name
 	dev->buffer.size = 0;
 	dev->buffer.fragment_size = 0;
 
+	dev->stats.mix_time_max = 0;
+	dev->stats.xruns = 0;
+
 	log_verbose("Initialized device (%p) '%s' with id %" PRIun ".",
 	    dev, dev->name, dev->id);
 
@@ -165,6 +177,7 @@ static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new)
 			    str_error(ret));
 			return ret;
 		}
+		set_fragment_size(dev, &dev->sink.format);
 		audio_pcm_register_event_callback(dev->sess,
 		    device_event_callback, dev);
 
@@ -174,11 +187,11 @@ static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new)
 		 */
 		pcm_format_silence(dev->buffer.base, dev->buffer.size,
 		    &dev->sink.format);
-		//TODO add underrun detection.
-		const size_t size = dev->buffer.fragment_size * 2;
+		const size_t size = dev->buffer.fragment_size * FRAGMENTS_AHEAD;
 		/* We never cross the end of the buffer here */
 		audio_sink_mix_inputs(&dev->sink, dev->buffer.position, size);
 		advance_buffer(dev, size);
+		getuptime(&dev->stats.last_event);
 
 		const unsigned frames = dev->buffer.fragment_size /
 		    pcm_format_frame_size(&dev->sink.format);
@@ -230,8 +243,9 @@ static errno_t device_source_connection_callback(audio_source_t *source, bool ne
 
 		//TODO set and test format
 
+		set_fragment_size(dev, &dev->source.format);
 		const unsigned frames = dev->buffer.fragment_size /
-		    pcm_format_frame_size(&dev->sink.format);
+		    pcm_format_frame_size(&dev->source.format);
 		ret = audio_pcm_start_capture_fragment(dev->sess, frames,
 		    dev->source.format.channels,
 		    dev->source.format.sampling_rate,
@@ -264,7 +278,6 @@ static errno_t device_source_connection_callback(audio_source_t *source, bool ne
  */
 static void device_event_callback(ipc_call_t *icall, void *arg)
 {
-	struct timespec time1;
 	errno_t ret;
 
 	audio_device_t *dev = arg;
@@ -276,16 +289,7 @@ static void device_event_callback(ipc_call_t *icall, void *arg)
 
 		switch (IPC_GET_IMETHOD(call)) {
 		case PCM_EVENT_FRAMES_PLAYED:
-			getuptime(&time1);
-			//TODO add underrun detection.
-			/* We never cross the end of the buffer here */
-			audio_sink_mix_inputs(&dev->sink, dev->buffer.position,
-			    dev->buffer.fragment_size);
-			advance_buffer(dev, dev->buffer.fragment_size);
-			struct timespec time2;
-			getuptime(&time2);
-			log_verbose("Time to mix sources: %lld\n",
-			    NSEC2USEC(ts_sub_diff(&time2, &time1)));
+			mix_fragment(dev);
 			break;
 		case PCM_EVENT_CAPTURE_TERMINATED:
 			log_verbose("Capture terminated");
@@ -321,6 +325,63 @@ static void device_event_callback(ipc_call_t *icall, void *arg)
 	}
 }
 
+/**
+ * Mix next fragment after the device finished playing one.
+ * @param dev Audio device.
+ *
+ * We are FRAGMENTS_AHEAD fragments ahead of the device after each mix, so
+ * the device ran out of mixed data if the event came more than a period
+ * late.
+ */
+static void mix_fragment(audio_device_t *dev)
+{
+	struct timespec time1;
+	getuptime(&time1);
+
+	const pcm_format_t *f = &dev->sink.format;
+	const usec_t period = (usec_t) pcm_format_size_to_usec(
+	    dev->buffer.fragment_size, f);
+	const usec_t interval =
+	    NSEC2USEC(ts_sub_diff(&time1, &dev->stats.last_event));
+	if (interval > period * FRAGMENTS_AHEAD) {
+		++dev->stats.xruns;
+		log_warning("Device %s underrun, period took %lld us",
+		    dev->name, (long long) interval);
+	}
+	dev->stats.last_event = time1;
+
+	/* We never cross the end of the buffer here */
+	audio_sink_mix_inputs(&dev->sink, dev->buffer.position,
+	    dev->buffer.fragment_size);
+	advance_buffer(dev, dev->buffer.fragment_size);
+
+	struct timespec time2;
+	getuptime(&time2);
+	const usec_t mix_time = NSEC2USEC(ts_sub_diff(&time2, &time1));
+	dev->stats.mix_time_max = max(dev->stats.mix_time_max, mix_time);
+	log_verbose("Time to mix sources: %lld\n", (long long) mix_time);
+}
+
+/**
+ * Get playback statistics.
+ * @param dev Audio device.
+ * @param stats Place to store the statistics.
+ */
+void audio_device_get_stats(audio_device_t *dev, hound_stats_t *stats)
+{
+	assert(dev);
+	assert(stats);
+	stats->period = 0;
+	stats->latency = 0;
+	if (is_running(dev) && pcm_format_frame_size(&dev->sink.format)) {
+		stats->period = pcm_format_size_to_usec(
+		    dev->buffer.fragment_size, &dev->sink.format);
+		stats->latency = stats->period * FRAGMENTS_AHEAD;
+	}
+	stats->mix_time_max = dev->stats.mix_time_max;
+	stats->xruns = dev->stats.xruns;
+}
+
 /**
  * Test format against hardware limits.
  * @param sink audio playback device.
@@ -370,6 +431,52 @@ static errno_t get_buffer(audio_device_t *dev)
 
 }
 
+/**
+ * Pick fragment size close to DEVICE_PERIOD_USEC.
+ * @param dev Audio device with a buffer.
+ * @param f Format of the audio data.
+ *
+ * The device interrupts after each fragment. Fragments have a power of two
+ * frames to divide the device buffer, within the device's interrupt
+ * limits.
+ */
+static void set_fragment_size(audio_device_t *dev, const pcm_format_t *f)
+{
+	assert(dev);
+	assert(f);
+	dev->buffer.fragment_size = dev->buffer.size / BUFFER_PARTS;
+
+	const size_t frame_size = pcm_format_frame_size(f);
+	if (frame_size == 0)
+		return;
+
+	sysarg_t min_frames = 1;
+	sysarg_t max_frames = dev->buffer.size / frame_size;
+	if (audio_pcm_query_cap(dev->sess, AUDIO_CAP_INTERRUPT_MIN_FRAMES,
+	    &min_frames) != EOK)
+		min_frames = 1;
+	if (audio_pcm_query_cap(dev->sess, AUDIO_CAP_INTERRUPT_MAX_FRAMES,
+	    &max_frames) != EOK)
+		max_frames = dev->buffer.size / frame_size;
+
+	const size_t period =
+	    (uint64_t) f->sampling_rate * DEVICE_PERIOD_USEC / 1000000;
+	size_t frames = 1;
+	while (frames * 2 <= period)
+		frames *= 2;
+	while (frames < min_frames)
+		frames *= 2;
+
+	const size_t size = frames * frame_size;
+	if (frames > max_frames || (dev->buffer.size % size) != 0 ||
+	    dev->buffer.size / size <= FRAGMENTS_AHEAD) {
+		log_verbose("Can't use %zu frame periods on %s", frames,
+		    dev->name);
+		return;
+	}
+	dev->buffer.fragment_size = size;
+}
+
 /**
  * Surrender access to device buffer.
  * @param dev Audio device.
@@ -42,6 +42,8 @@
 #include <errno.h>
 #include <ipc/loc.h>
 #include <audio_pcm_iface.h>
+#include <hound/protocol.h>
+#include <time.h>
 
 #include "audio_source.h"
 #include "audio_sink.h"
@@ -63,6 +65,15 @@ typedef struct {
 		void *position;
 		size_t fragment_size;
 	} buffer;
+	/** Playback statistics */
+	struct {
+		/** Time of the last period event */
+		struct timespec last_event;
+		/** Longest time spent mixing one period */
+		usec_t mix_time_max;
+		/** Number of periods the device played before they were mixed */
+		unsigned xruns;
+	} stats;
 	/** Capture device abstraction. */
 	audio_source_t source;
 	/** Playback device abstraction. */
@@ -81,6 +92,7 @@ audio_source_t *audio_device_get_source(audio_device_t *dev);
 audio_sink_t *audio_device_get_sink(audio_device_t *dev);
 errno_t audio_device_recorded_data(audio_device_t *dev, void **base, size_t *size);
 errno_t audio_device_available_buffer(audio_device_t *dev, void **base, size_t *size);
+void audio_device_get_stats(audio_device_t *dev, hound_stats_t *stats);
 
 #endif
 
@@ -106,12 +106,20 @@ errno_t connection_add_source_data(connection_t *connection, void *data,
 	assert(connection);
 	if (!data)
 		return EBADMEM;
-	const size_t needed_frames = pcm_format_size_to_frames(size, &format);
+	size_t needed_frames = pcm_format_size_to_frames(size, &format);
+	size_t needed_size = size;
+	const pcm_format_t *sf = audio_source_format(connection->source);
+	if (!pcm_format_is_any(sf) && !pcm_format_same(sf, &format)) {
+		/* Sources provide data in their own format and rate */
+		needed_frames = pcm_resampler_convert_frames(needed_frames,
+		    format.sampling_rate, sf->sampling_rate);
+		needed_size = needed_frames * pcm_format_frame_size(sf);
+	}
 	if (needed_frames > audio_pipe_frames(&connection->fifo) &&
 	    connection->source->update_available_data) {
 		log_debug("Asking source to provide more data");
 		connection->source->update_available_data(
-		    connection->source, size);
+		    connection->source, needed_size);
 	}
 	log_verbose("Data available after update: %zu",
 	    audio_pipe_bytes(&connection->fifo));
@@ -549,6 +549,29 @@ errno_t hound_connect(hound_t *hound, const char *source_name, const char *sink_
 	return EOK;
 }
 
+/**
+ * Get playback statistics of a device.
+ * @param hound The hound structure.
+ * @param name Device sink's string id.
+ * @param stats Place to store the statistics.
+ * @return Error code.
+ */
+errno_t hound_get_stats(hound_t *hound, const char *name, hound_stats_t *stats)
+{
+	assert(hound);
+	assert(name);
+	assert(stats);
+	fibril_mutex_lock(&hound->list_guard);
+	audio_device_t *dev = find_device_by_name(&hound->devices, name);
+	if (dev)
+		audio_device_get_stats(dev, stats);
+	fibril_mutex_unlock(&hound->list_guard);
+	if (!dev)
+		return ENOENT;
+	stats->stream_xruns = hound_ctx_stream_xruns();
+	return EOK;
+}
+
 /**
  * Find and destroy connection between source and sink.
  * @param hound The hound structure.
@@ -34,8 +34,11 @@
 /** @file
  */
 
+#include <as.h>
 #include <macros.h>
+#include <mem.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <str_error.h>
 
@@ -171,8 +174,28 @@ typedef struct hound_ctx_stream {
 	fibril_mutex_t guard;
 	/** buffer status change condition */
 	fibril_condvar_t change;
+	/** Ring buffer shared with the client, NULL if not mapped */
+	hound_ring_t *ring;
+	/** Size of the ring data area, the shared header is not trusted */
+	size_t ring_size;
 } hound_ctx_stream_t;
 
+/** Largest ring buffer a client may map */
+#define STREAM_RING_MAX_SIZE  (1024 * 1024)
+
+/** Number of periods client streams ran out of data */
+static atomic_uint stream_xruns;
+
+/**
+ * Number of bytes waiting in a stream's ring buffer.
+ * @param stream The stream, must have a ring.
+ * @return Number of bytes, limited by the ring size.
+ */
+static inline size_t stream_ring_used(hound_ctx_stream_t *stream)
+{
+	return min(hound_ring_used(stream->ring), stream->ring_size);
+}
+
 /**
  * New stream append helper.
  * @param ctx hound context.
@@ -257,6 +280,8 @@ hound_ctx_stream_t *hound_ctx_create_stream(hound_ctx_t *ctx, int flags,
 		stream->flags = flags;
 		stream->format = format;
 		stream->allowed_size = buffer_size;
+		stream->ring = NULL;
+		stream->ring_size = 0;
 		stream_append(ctx, stream);
 		log_verbose("CTX: %p added stream; flags:%#x ch: %u r:%u f:%s",
 		    ctx, flags, format.channels, format.sampling_rate,
@@ -284,6 +309,8 @@ void hound_ctx_destroy_stream(hound_ctx_stream_t *stream)
 		    stream->format.channels, stream->format.sampling_rate,
 		    pcm_sample_format_str(stream->format.sample_format));
 		audio_pipe_fini(&stream->fifo);
+		if (stream->ring)
+			as_area_destroy(stream->ring);
 		free(stream);
 	}
 }
@@ -348,6 +375,129 @@ errno_t hound_ctx_stream_read(hound_ctx_stream_t *stream, void *data, size_t siz
 	return EEMPTY;
 }
 
+/**
+ * Create ring buffer shared with the client.
+ * @param stream The stream.
+ * @param size Size of the shared area.
+ * @param area Place to store address of the shared area.
+ * @return Error code.
+ */
+errno_t hound_ctx_stream_map(hound_ctx_stream_t *stream, size_t size,
+    void **area)
+{
+	assert(stream);
+	assert(area);
+	const size_t frame_size = pcm_format_frame_size(&stream->format);
+	if (frame_size == 0 || size > STREAM_RING_MAX_SIZE ||
+	    size < HOUND_RING_DATA_OFFSET + frame_size)
+		return EINVAL;
+
+	fibril_mutex_lock(&stream->guard);
+	if (stream->ring) {
+		fibril_mutex_unlock(&stream->guard);
+		return EEXIST;
+	}
+	hound_ring_t *ring = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (ring == AS_MAP_FAILED) {
+		fibril_mutex_unlock(&stream->guard);
+		return ENOMEM;
+	}
+	hound_ring_init(ring, size, frame_size);
+	stream->ring = ring;
+	stream->ring_size = ring->size;
+	fibril_mutex_unlock(&stream->guard);
+
+	log_verbose("CTX: %p mapped stream ring of %zu bytes", stream->ctx,
+	    stream->ring_size);
+	*area = ring;
+	return EOK;
+}
+
+/**
+ * Block until there is enough free space in the stream's ring buffer.
+ * @param stream The stream.
+ * @param size Number of bytes that should be free.
+ * @return Error code.
+ */
+errno_t hound_ctx_stream_wait(hound_ctx_stream_t *stream, size_t size)
+{
+	assert(stream);
+	fibril_mutex_lock(&stream->guard);
+	if (!stream->ring) {
+		fibril_mutex_unlock(&stream->guard);
+		return EINVAL;
+	}
+	size = min(size, stream->ring_size);
+	while (stream->ring_size - stream_ring_used(stream) < size)
+		fibril_condvar_wait(&stream->change, &stream->guard);
+	fibril_mutex_unlock(&stream->guard);
+	return EOK;
+}
+
+/**
+ * Mix data from the stream's ring buffer.
+ * @param stream The source stream, guard must be held.
+ * @param data Destination audio buffer.
+ * @param size Size of the @p data buffer.
+ * @param f Destination data format.
+ * @return Size of the destination buffer touched with stream's data.
+ *
+ * Data of the destination rate are mixed straight out of the shared memory,
+ * other rates go through the fifo to be resampled.
+ */
+static size_t stream_ring_mix(hound_ctx_stream_t *stream, void *data,
+    size_t size, const pcm_format_t *f)
+{
+	const size_t src_frame_size = pcm_format_frame_size(&stream->format);
+	const size_t dst_frame_size = pcm_format_frame_size(f);
+
+	if (stream->format.sampling_rate != f->sampling_rate) {
+		/* Move only what this period needs, the rest stays shared. */
+		size_t left = audio_pipe_missing_frames(&stream->fifo,
+		    pcm_format_size_to_frames(size, f), f,
+		    stream->format.sampling_rate) * src_frame_size;
+		while (left > 0) {
+			size_t chunk_size = 0;
+			const void *chunk = hound_ring_read_start(stream->ring,
+			    stream->ring_size, &chunk_size);
+			chunk_size = min(chunk_size, left);
+			chunk_size -= chunk_size % src_frame_size;
+			if (chunk_size == 0)
+				break;
+			void *copy = malloc(chunk_size);
+			if (!copy)
+				break;
+			memcpy(copy, chunk, chunk_size);
+			hound_ring_read_finish(stream->ring, chunk_size);
+			if (audio_pipe_push_data(&stream->fifo, copy,
+			    chunk_size, stream->format) != EOK)
+				break;
+			left -= chunk_size;
+		}
+		return audio_pipe_mix_data(&stream->fifo, data, size, f);
+	}
+
+	size_t needed_frames = pcm_format_size_to_frames(size, f);
+	size_t copied_size = 0;
+	while (needed_frames > 0) {
+		size_t chunk_size = 0;
+		const void *chunk = hound_ring_read_start(stream->ring,
+		    stream->ring_size, &chunk_size);
+		const size_t frames = min(chunk_size / src_frame_size,
+		    needed_frames);
+		if (frames == 0)
+			break;
+		pcm_format_convert_and_mix(data, frames * dst_frame_size,
+		    chunk, frames * src_frame_size, &stream->format, f);
+		hound_ring_read_finish(stream->ring, frames * src_frame_size);
+		needed_frames -= frames;
+		copied_size += frames * dst_frame_size;
+		data += frames * dst_frame_size;
+	}
+	return copied_size;
+}
+
 /**
  * Add (mix) stream data to the destination buffer.
  * @param stream The source stream.
@@ -361,12 +511,31 @@ size_t hound_ctx_stream_add_self(hound_ctx_stream_t *stream, void *data,
 {
 	assert(stream);
 	fibril_mutex_lock(&stream->guard);
-	const size_t ret = audio_pipe_mix_data(&stream->fifo, data, size, f);
-	fibril_condvar_signal(&stream->change);
+	size_t ret = audio_pipe_mix_data(&stream->fifo, data, size, f);
+	if (stream->ring && ret < size) {
+		ret += stream_ring_mix(stream, data + ret, size - ret, f);
+		/* Count only streams that have already started playing */
+		if (ret < size &&
+		    atomic_load(&stream->ring->write_pos) != 0 &&
+		    !(stream->flags & HOUND_STREAM_IGNORE_UNDERFLOW)) {
+			atomic_fetch_add(&stream->ring->xruns, 1);
+			atomic_fetch_add(&stream_xruns, 1);
+		}
+	}
+	fibril_condvar_broadcast(&stream->change);
 	fibril_mutex_unlock(&stream->guard);
 	return ret;
 }
 
+/**
+ * Number of periods ring buffer streams ran out of data.
+ * @return Total count for all streams.
+ */
+unsigned hound_ctx_stream_xruns(void)
+{
+	return atomic_load(&stream_xruns);
+}
+
 /**
  * Block until the stream's buffer is empty.
  * @param stream Target stream.
@@ -376,7 +545,8 @@ void hound_ctx_stream_drain(hound_ctx_stream_t *stream)
 	assert(stream);
 	log_debug("Draining stream");
 	fibril_mutex_lock(&stream->guard);
-	while (audio_pipe_bytes(&stream->fifo))
+	while (audio_pipe_bytes(&stream->fifo) ||
+	    (stream->ring && stream_ring_used(stream) != 0))
 		fibril_condvar_wait(&stream->change, &stream->guard);
 	fibril_mutex_unlock(&stream->guard);
 }
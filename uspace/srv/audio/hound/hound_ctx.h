@@ -76,6 +76,10 @@ errno_t hound_ctx_stream_read(hound_ctx_stream_t *stream, void *buffer, size_t s
 size_t hound_ctx_stream_add_self(hound_ctx_stream_t *stream, void *data,
     size_t size, const pcm_format_t *f);
 void hound_ctx_stream_drain(hound_ctx_stream_t *stream);
+errno_t hound_ctx_stream_map(hound_ctx_stream_t *stream, size_t size,
+    void **area);
+errno_t hound_ctx_stream_wait(hound_ctx_stream_t *stream, size_t size);
+unsigned hound_ctx_stream_xruns(void);
 
 #endif
 
@@ -151,6 +151,22 @@ static errno_t iface_stream_data_write(void *stream, void *buffer, size_t size)
 	return hound_ctx_stream_write(stream, buffer, size);
 }
 
+static errno_t iface_stream_map(void *stream, size_t size, void **area)
+{
+	return hound_ctx_stream_map(stream, size, area);
+}
+
+static errno_t iface_stream_wait(void *stream, size_t size)
+{
+	return hound_ctx_stream_wait(stream, size);
+}
+
+static errno_t iface_get_stats(void *server, const char *name,
+    hound_stats_t *stats)
+{
+	return hound_get_stats(server, name, stats);
+}
+
 hound_server_iface_t hound_iface = {
 	.add_context = iface_add_context,
 	.rem_context = iface_rem_context,
@@ -163,5 +179,8 @@ hound_server_iface_t hound_iface = {
 	.drain_stream = iface_drain_stream,
 	.stream_data_write = iface_stream_data_write,
 	.stream_data_read = iface_stream_data_read,
+	.stream_map = iface_stream_map,
+	.stream_wait = iface_stream_wait,
+	.get_stats = iface_get_stats,
 	.server = NULL,
 };
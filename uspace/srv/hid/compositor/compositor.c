@@ -41,12 +41,18 @@
 #include <byteorder.h>
 #include <stdio.h>
 #include <libc.h>
+#include <macros.h>
+#include <time.h>
 
 #include <align.h>
 #include <as.h>
 #include <stdlib.h>
+#include <malloc.h>
+#include <stats.h>
+#include <stdatomic.h>
 
 #include <refcount.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <adt/prodcons.h>
 #include <adt/list.h>
@@ -66,6 +72,7 @@
 
 #include <transform.h>
 #include <rectangle.h>
+#include <region.h>
 #include <surface.h>
 #include <cursor.h>
 #include <source.h>
@@ -85,6 +92,25 @@
 #define ANIMATE_WINDOW_TRANSFORMS 0
 #endif
 
+/** Nominal interval between two repaints (in microseconds). */
+#define REPAINT_INTERVAL  16667
+
+/** Number of damaged rectangles tracked before they are merged. */
+#define DAMAGE_MAX_RECTS  16
+
+/** Size of the tiles that damage is split into for parallel painting. */
+#define TILE_WIDTH   128
+#define TILE_HEIGHT  64
+
+/** Minimal number of tiles worth painting in parallel. */
+#define TILE_MIN_PARALLEL  4
+
+/** Maximal number of fibrils painting in parallel. */
+#define PAINTER_MAX  16
+
+/** Alignment of data written by different painters (cache line size). */
+#define PAINTER_ALIGNMENT  64
+
 static char *server_name;
 static sysarg_t coord_origin;
 static pixel_t bg_color;
@@ -106,6 +132,8 @@ typedef struct {
 	double angle;
 	uint8_t opacity;
 	surface_t *surface;
+	/** Client area that may contain translucent pixels. */
+	region_rect_t translucent;
 } window_t;
 
 static service_id_t winreg_id;
@@ -128,6 +156,8 @@ typedef struct {
 	cursor_t cursor;
 	window_t ghost;
 	desktop_vector_t accum_ghost;
+	/** Relative motion not applied yet */
+	desktop_vector_t motion;
 } pointer_t;
 
 static sysarg_t pointer_id = 0;
@@ -149,6 +179,70 @@ static LIST_INITIALIZE(viewport_list);
 
 static FIBRIL_MUTEX_INITIALIZE(discovery_mtx);
 
+/** Damage waiting for repaint (in global coordinates) */
+static FIBRIL_MUTEX_INITIALIZE(damage_mtx);
+static FIBRIL_CONDVAR_INITIALIZE(damage_cv);
+static region_t damage;
+
+/** Damage could not be recorded, the whole desktop must be repainted */
+static bool damage_lost = false;
+
+/** Some pointer has motion to be applied in the next frame */
+static bool motion_pending = false;
+
+/** Window prepared for painting */
+typedef struct {
+	window_t *win;
+	/** Bounding rectangle in global coordinates */
+	sysarg_t x;
+	sysarg_t y;
+	sysarg_t w;
+	sysarg_t h;
+	/** Part of the desktop hidden by the window */
+	region_t opaque;
+} layer_t;
+
+/** Damaged part of a viewport being painted */
+typedef struct {
+	viewport_t *vp;
+	/** Damage in global coordinates */
+	const region_t *dmg;
+	/** Windows ordered from the top */
+	layer_t *layers;
+	size_t layer_count;
+	/** Grid of tiles covering the damage */
+	sysarg_t x;
+	sysarg_t y;
+	size_t cols;
+	size_t rows;
+	/** Next tile to be painted */
+	atomic_size_t next __attribute__((aligned(PAINTER_ALIGNMENT)));
+} frame_t;
+
+/** State of a fibril painting tiles */
+typedef struct {
+	frame_t *frame;
+	/** Surface to paint into */
+	surface_t *surface;
+	/** Damage within the current tile */
+	region_t dmg;
+	region_t uncovered;
+	/** Visible part of each layer */
+	region_t *visible;
+	size_t visible_size;
+} __attribute__((aligned(PAINTER_ALIGNMENT))) painter_t;
+
+static FIBRIL_MUTEX_INITIALIZE(paint_mtx);
+static FIBRIL_CONDVAR_INITIALIZE(paint_start_cv);
+static FIBRIL_CONDVAR_INITIALIZE(paint_done_cv);
+static painter_t *painters[PAINTER_MAX];
+static size_t painter_count;
+static frame_t *paint_frame;
+static size_t paint_generation;
+static size_t paint_busy;
+static layer_t *layers;
+static size_t layers_size;
+
 /** Input server proxy */
 static input_t *input;
 static bool active = false;
@@ -159,6 +253,7 @@ static errno_t comp_key_press(input_t *, kbd_event_type_t, keycode_t, keymod_t,
 static errno_t comp_mouse_move(input_t *, int, int);
 static errno_t comp_abs_move(input_t *, unsigned, unsigned, unsigned, unsigned);
 static errno_t comp_mouse_button(input_t *, int, int);
+static void comp_apply_motion(pointer_t *);
 
 static input_ev_ops_t input_ev_ops = {
 	.active = comp_active,
@@ -204,6 +299,8 @@ static pointer_t *pointer_create(void)
 	p->ghost.surface = NULL;
 	p->accum_ghost.x = 0;
 	p->accum_ghost.y = 0;
+	p->motion.x = 0;
+	p->motion.y = 0;
 
 	return p;
 }
@@ -235,6 +332,7 @@ static window_t *window_create(void)
 	win->angle = 0;
 	win->opacity = 255;
 	win->surface = NULL;
+	win->translucent = (region_rect_t) { 0, 0, 0, 0 };
 
 	return win;
 }
@@ -385,226 +483,753 @@ static void comp_restrict_pointers(void)
 	fibril_mutex_unlock(&pointer_list_mtx);
 }
 
+/** Find the translucent pixels in a damaged area of a window.
+ *
+ * The window keeps the bounding rectangle of the pixels that may be
+ * translucent. It is recomputed if the damaged area covers it and
+ * extended otherwise.
+ */
+static void comp_window_scan_translucent(window_t *win,
+    sysarg_t x_dmg, sysarg_t y_dmg, sysarg_t w_dmg, sysarg_t h_dmg)
+{
+	/* window_list_mtx locked by caller */
+
+	if (!win->surface)
+		return;
+
+	sysarg_t width, height;
+	surface_get_resolution(win->surface, &width, &height);
+	if (!rectangle_intersect(0, 0, width, height,
+	    x_dmg, y_dmg, w_dmg, h_dmg, &x_dmg, &y_dmg, &w_dmg, &h_dmg))
+		return;
+
+	pixelmap_t *pixmap = surface_pixmap_access(win->surface);
+	sysarg_t left = x_dmg + w_dmg;
+	sysarg_t right = x_dmg;
+	sysarg_t top = y_dmg + h_dmg;
+	sysarg_t bottom = y_dmg;
+
+	for (sysarg_t y = y_dmg; y < y_dmg + h_dmg; ++y) {
+		pixel_t *row = pixelmap_pixel_at(pixmap, x_dmg, y);
+
+		sysarg_t first = 0;
+		while ((first < w_dmg) && (ALPHA(row[first]) == 255))
+			++first;
+
+		if (first == w_dmg)
+			continue;
+
+		sysarg_t last = w_dmg - 1;
+		while (ALPHA(row[last]) == 255)
+			--last;
+
+		left = min(left, x_dmg + first);
+		right = max(right, x_dmg + last + 1);
+		top = min(top, y);
+		bottom = y + 1;
+	}
+
+	region_rect_t *trans = &win->translucent;
+	bool covered = (trans->w == 0) ||
+	    ((trans->x >= x_dmg) && (trans->y >= y_dmg) &&
+	    (trans->x + trans->w <= x_dmg + w_dmg) &&
+	    (trans->y + trans->h <= y_dmg + h_dmg));
+
+	if (left >= right) {
+		if (covered)
+			trans->w = trans->h = 0;
+	} else if (covered) {
+		*trans = (region_rect_t) { left, top, right - left, bottom - top };
+	} else {
+		rectangle_union(trans->x, trans->y, trans->w, trans->h,
+		    left, top, right - left, bottom - top,
+		    &trans->x, &trans->y, &trans->w, &trans->h);
+	}
+}
+
+/** Get the part of the desktop that a window covers with opaque pixels.
+ *
+ * Only windows that are merely moved by whole pixels are considered,
+ * because their pixels are put on the screen unchanged.
+ *
+ * @return False if the window is not known to hide anything.
+ */
+static bool comp_window_opaque_region(window_t *win, region_t *opaque)
+{
+	/* window_list_mtx locked by caller */
+
+	region_clear(opaque);
+
+	if ((!win->surface) || (win->opacity != 255))
+		return false;
+
+	const transform_t *transform = &win->transform;
+	double dx = transform->matrix[0][2];
+	double dy = transform->matrix[1][2];
+	if ((transform->matrix[0][0] != 1) || (transform->matrix[0][1] != 0) ||
+	    (transform->matrix[1][0] != 0) || (transform->matrix[1][1] != 1) ||
+	    (dx < 0) || (dy < 0) || (dx != (sysarg_t) dx) || (dy != (sysarg_t) dy))
+		return false;
+
+	sysarg_t width, height;
+	surface_get_resolution(win->surface, &width, &height);
+
+	const region_rect_t *trans = &win->translucent;
+	if ((region_union_rect(opaque, dx, dy, width, height) != EOK) ||
+	    (region_subtract_rect(opaque, dx + trans->x, dy + trans->y,
+	    trans->w, trans->h) != EOK))
+		return false;
+
+	return !region_is_empty(opaque);
+}
+
+static void comp_paint_background(painter_t *painter, const region_t *dmg)
+{
+	viewport_t *vp = painter->frame->vp;
+	pixelmap_t *pixmap = surface_pixmap_access(painter->surface);
+
+	for (size_t i = 0; i < dmg->count; ++i) {
+		const region_rect_t *rect = &dmg->rects[i];
+		for (sysarg_t y = rect->y; y < rect->y + rect->h; ++y) {
+			compose_fill_src(pixelmap_pixel_at(pixmap,
+			    rect->x - vp->pos.x, y - vp->pos.y), bg_color, rect->w);
+		}
+	}
+}
+
+static void comp_paint_layer(painter_t *painter, drawctx_t *context,
+    source_t *source, const layer_t *layer, const region_t *dmg)
+{
+	viewport_t *vp = painter->frame->vp;
+	window_t *win = layer->win;
+
+	/* Prepare conversion from global coordinates to viewport coordinates. */
+	transform_t transform = win->transform;
+	double_point_t pos;
+	pos.x = vp->pos.x;
+	pos.y = vp->pos.y;
+	transform_translate(&transform, -pos.x, -pos.y);
+
+	source_set_transform(source, transform);
+	source_set_texture(source, win->surface,
+	    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+	source_set_alpha(source, PIXEL(win->opacity, 0, 0, 0));
+
+	for (size_t i = 0; i < dmg->count; ++i) {
+		const region_rect_t *rect = &dmg->rects[i];
+
+		/*
+		 * Determine what part of the window intersects with the
+		 * damaged rectangle.
+		 */
+		sysarg_t x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win;
+		bool isec_win = rectangle_intersect(
+		    rect->x, rect->y, rect->w, rect->h,
+		    layer->x, layer->y, layer->w, layer->h,
+		    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
+
+		if (isec_win) {
+			drawctx_transfer(context,
+			    x_dmg_win - vp->pos.x, y_dmg_win - vp->pos.y, w_dmg_win, h_dmg_win);
+		}
+	}
+}
+
+static errno_t comp_painter_reserve(painter_t *painter, size_t count)
+{
+	if (count <= painter->visible_size)
+		return EOK;
+
+	region_t *visible = (region_t *) realloc(painter->visible,
+	    count * sizeof(region_t));
+	if (!visible)
+		return ENOMEM;
+
+	for (size_t i = painter->visible_size; i < count; ++i)
+		region_init(&visible[i]);
+
+	painter->visible = visible;
+	painter->visible_size = count;
+	return EOK;
+}
+
+/** Paint the background and the windows in a damaged region.
+ *
+ * The layers are first walked from the top to find out which part of
+ * the damage each of them can influence, since opaque windows hide
+ * everything below them. Only the visible parts are then painted from
+ * the bottom. If there is not enough memory to do that, the windows are
+ * painted over the whole damage.
+ */
+static void comp_paint_region(painter_t *painter, const region_t *dmg)
+{
+	const frame_t *frame = painter->frame;
+	region_t *uncovered = &painter->uncovered;
+
+	bool cull = (comp_painter_reserve(painter, frame->layer_count) == EOK) &&
+	    (region_copy(uncovered, dmg) == EOK);
+
+	for (size_t i = 0; cull && (i < frame->layer_count); ++i) {
+		const layer_t *layer = &frame->layers[i];
+
+		if (region_intersect_rect(uncovered, layer->x, layer->y,
+		    layer->w, layer->h, &painter->visible[i]) != EOK) {
+			cull = false;
+			break;
+		}
+
+		/*
+		 * If the subtraction fails, the uncovered region is still
+		 * a superset of the exact one, so the windows below are
+		 * only painted over needlessly.
+		 */
+		if (!region_is_empty(&layer->opaque))
+			(void) region_subtract(uncovered, &layer->opaque);
+	}
+
+	comp_paint_background(painter, cull ? uncovered : dmg);
+
+	source_t source;
+	drawctx_t context;
+
+	source_init(&source);
+	source_set_filter(&source, filter);
+	drawctx_init(&context, painter->surface);
+	drawctx_set_compose(&context, compose_over);
+	drawctx_set_source(&context, &source);
+
+	for (size_t i = frame->layer_count; i-- > 0;) {
+		const region_t *dmg_layer = cull ? &painter->visible[i] : dmg;
+		if (!region_is_empty(dmg_layer)) {
+			comp_paint_layer(painter, &context, &source,
+			    &frame->layers[i], dmg_layer);
+		}
+	}
+}
+
+static void comp_paint_tile(painter_t *painter, size_t tile)
+{
+	const frame_t *frame = painter->frame;
+	sysarg_t x = frame->x + (tile % frame->cols) * TILE_WIDTH;
+	sysarg_t y = frame->y + (tile / frame->cols) * TILE_HEIGHT;
+
+	if (region_intersect_rect(frame->dmg, x, y, TILE_WIDTH, TILE_HEIGHT,
+	    &painter->dmg) == EOK) {
+		if (!region_is_empty(&painter->dmg))
+			comp_paint_region(painter, &painter->dmg);
+		return;
+	}
+
+	/* Paint the damaged rectangles of the tile one by one. */
+	for (size_t i = 0; i < frame->dmg->count; ++i) {
+		const region_rect_t *rect = &frame->dmg->rects[i];
+		region_rect_t isec;
+		if (rectangle_intersect(rect->x, rect->y, rect->w, rect->h,
+		    x, y, TILE_WIDTH, TILE_HEIGHT,
+		    &isec.x, &isec.y, &isec.w, &isec.h)) {
+			region_t dmg = { &isec, 1, 1 };
+			comp_paint_region(painter, &dmg);
+		}
+	}
+}
+
+/** Paint tiles of the current frame until there are none left. */
+static void comp_paint_tiles(painter_t *painter)
+{
+	frame_t *frame = painter->frame;
+	size_t count = frame->cols * frame->rows;
+
+	while (true) {
+		size_t tile = atomic_fetch_add_explicit(&frame->next, 1,
+		    memory_order_relaxed);
+		if (tile >= count)
+			break;
+
+		comp_paint_tile(painter, tile);
+	}
+}
+
+static errno_t comp_painter_fibril(void *arg)
+{
+	painter_t *painter = (painter_t *) arg;
+	size_t generation = 0;
+
+	fibril_mutex_lock(&paint_mtx);
+
+	while (true) {
+		while (paint_generation == generation)
+			fibril_condvar_wait(&paint_start_cv, &paint_mtx);
+
+		generation = paint_generation;
+		frame_t *frame = paint_frame;
+		fibril_mutex_unlock(&paint_mtx);
+
+		/*
+		 * Without a view of its own, the painter would share the damage
+		 * tracking of the viewport surface with the other painters.
+		 * If the view cannot be created, the tiles are left to them.
+		 */
+		painter->surface = surface_create_view(frame->vp->surface);
+		if (painter->surface) {
+			painter->frame = frame;
+			comp_paint_tiles(painter);
+			surface_destroy(painter->surface);
+		}
+
+		fibril_mutex_lock(&paint_mtx);
+		if (--paint_busy == 0)
+			fibril_condvar_signal(&paint_done_cv);
+	}
+
+	return EOK;
+}
+
+/** Create painters for all CPUs.
+ *
+ * The first painter belongs to the repaint fibril, the others get
+ * fibrils of their own. Each of them needs a fibril runner to paint
+ * in parallel.
+ */
+static errno_t comp_painters_init(void)
+{
+	size_t cpus = 0;
+	size_t active_cpus = 0;
+	stats_cpu_t *stats = stats_get_cpus(&cpus);
+	if (stats) {
+		for (size_t i = 0; i < cpus; ++i) {
+			if (stats[i].active)
+				++active_cpus;
+		}
+
+		free(stats);
+	}
+
+	size_t count = min(max(active_cpus, 1), PAINTER_MAX);
+
+	for (size_t i = 0; i < count; ++i) {
+		painter_t *painter = (painter_t *) memalign(PAINTER_ALIGNMENT,
+		    sizeof(painter_t));
+		if (!painter)
+			break;
+
+		painter->frame = NULL;
+		painter->surface = NULL;
+		region_init(&painter->dmg);
+		region_init(&painter->uncovered);
+		painter->visible = NULL;
+		painter->visible_size = 0;
+
+		if (i > 0) {
+			fid_t fid = fibril_create(comp_painter_fibril, painter);
+			if (fid == 0) {
+				free(painter);
+				break;
+			}
+
+			fibril_add_ready(fid);
+		}
+
+		painters[painter_count++] = painter;
+	}
+
+	if (painter_count == 0)
+		return ENOMEM;
+
+	if (painter_count > 4)
+		fibril_test_spawn_runners(painter_count - 1);
+	else if (painter_count > 1)
+		fibril_enable_multithreaded();
+
+	return EOK;
+}
+
+/** Prepare the windows for painting.
+ *
+ * The layers are ordered from the top.
+ */
+static errno_t comp_prepare_layers(frame_t *frame)
+{
+	/* window_list_mtx locked by caller */
+
+	size_t count = list_count(&window_list);
+	if (count > layers_size) {
+		layer_t *new_layers = (layer_t *) realloc(layers,
+		    count * sizeof(layer_t));
+		if (!new_layers)
+			return ENOMEM;
+
+		for (size_t i = layers_size; i < count; ++i)
+			region_init(&new_layers[i].opaque);
+
+		layers = new_layers;
+		layers_size = count;
+	}
+
+	frame->layers = layers;
+	frame->layer_count = 0;
+
+	list_foreach(window_list, link, window_t, win) {
+		if (!win->surface)
+			continue;
+
+		layer_t *layer = &frame->layers[frame->layer_count++];
+		layer->win = win;
+
+		surface_get_resolution(win->surface, &layer->w, &layer->h);
+		comp_coord_bounding_rect(0, 0, layer->w, layer->h, win->transform,
+		    &layer->x, &layer->y, &layer->w, &layer->h);
+
+		(void) comp_window_opaque_region(win, &layer->opaque);
+	}
+
+	return EOK;
+}
+
+/** Paint windows in the damaged part of a viewport.
+ *
+ * Large damage is split into tiles on a grid aligned to the viewport,
+ * which are painted by all painters in parallel. The tile width is
+ * a multiple of the cache line size, so that the painters do not
+ * write into the same cache lines.
+ */
+static void comp_paint_frame(frame_t *frame)
+{
+	/* window_list_mtx locked by caller */
+
+	viewport_t *vp = frame->vp;
+	painter_t *painter = painters[0];
+
+	sysarg_t x_dmg, y_dmg, w_dmg, h_dmg;
+	region_bounds(frame->dmg, &x_dmg, &y_dmg, &w_dmg, &h_dmg);
+
+	sysarg_t col_lo = (x_dmg - vp->pos.x) / TILE_WIDTH;
+	sysarg_t col_hi = (x_dmg - vp->pos.x + w_dmg + TILE_WIDTH - 1) / TILE_WIDTH;
+	sysarg_t row_lo = (y_dmg - vp->pos.y) / TILE_HEIGHT;
+	sysarg_t row_hi = (y_dmg - vp->pos.y + h_dmg + TILE_HEIGHT - 1) / TILE_HEIGHT;
+
+	frame->x = vp->pos.x + col_lo * TILE_WIDTH;
+	frame->y = vp->pos.y + row_lo * TILE_HEIGHT;
+	frame->cols = col_hi - col_lo;
+	frame->rows = row_hi - row_lo;
+	atomic_store_explicit(&frame->next, 0, memory_order_relaxed);
+
+	painter->frame = frame;
+	painter->surface = vp->surface;
+
+	if ((painter_count == 1) || (frame->cols * frame->rows < TILE_MIN_PARALLEL)) {
+		comp_paint_region(painter, frame->dmg);
+		return;
+	}
+
+	fibril_mutex_lock(&paint_mtx);
+	paint_frame = frame;
+	paint_busy = painter_count - 1;
+	++paint_generation;
+	fibril_condvar_broadcast(&paint_start_cv);
+	fibril_mutex_unlock(&paint_mtx);
+
+	comp_paint_tiles(painter);
+
+	fibril_mutex_lock(&paint_mtx);
+	while (paint_busy > 0)
+		fibril_condvar_wait(&paint_done_cv, &paint_mtx);
+	fibril_mutex_unlock(&paint_mtx);
+}
+
+static void comp_paint_ghost(viewport_t *vp, pointer_t *ptr,
+    sysarg_t x_dmg_vp, sysarg_t y_dmg_vp, sysarg_t w_dmg_vp, sysarg_t h_dmg_vp)
+{
+	/* window_list_mtx locked by caller */
+	/* pointer_list_mtx locked by caller */
+
+	sysarg_t x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost;
+	sysarg_t x_dmg_ghost, y_dmg_ghost, w_dmg_ghost, h_dmg_ghost;
+	surface_get_resolution(ptr->ghost.surface, &w_bnd_ghost, &h_bnd_ghost);
+	comp_coord_bounding_rect(0, 0, w_bnd_ghost, h_bnd_ghost, ptr->ghost.transform,
+	    &x_bnd_ghost, &y_bnd_ghost, &w_bnd_ghost, &h_bnd_ghost);
+	bool isec_ghost = rectangle_intersect(
+	    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
+	    x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost,
+	    &x_dmg_ghost, &y_dmg_ghost, &w_dmg_ghost, &h_dmg_ghost);
+
+	if (!isec_ghost)
+		return;
+
+	/*
+	 * FIXME: Ghost is currently drawn based on the bounding
+	 * rectangle of the window, which is sufficient as long
+	 * as the windows can be rotated only by 90 degrees.
+	 * For ghost to be compatible with arbitrary-angle
+	 * rotation, it should be drawn as four lines adjusted
+	 * by the transformation matrix. That would however
+	 * require to equip libdraw with line drawing functionality.
+	 */
+
+	pixel_t ghost_color;
+
+	if (y_bnd_ghost == y_dmg_ghost) {
+		for (sysarg_t x = x_dmg_ghost - vp->pos.x;
+		    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
+			ghost_color = surface_get_pixel(vp->surface,
+			    x, y_dmg_ghost - vp->pos.y);
+			surface_put_pixel(vp->surface,
+			    x, y_dmg_ghost - vp->pos.y, INVERT(ghost_color));
+		}
+	}
+
+	if (y_bnd_ghost + h_bnd_ghost == y_dmg_ghost + h_dmg_ghost) {
+		for (sysarg_t x = x_dmg_ghost - vp->pos.x;
+		    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
+			ghost_color = surface_get_pixel(vp->surface,
+			    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1);
+			surface_put_pixel(vp->surface,
+			    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1, INVERT(ghost_color));
+		}
+	}
+
+	if (x_bnd_ghost == x_dmg_ghost) {
+		for (sysarg_t y = y_dmg_ghost - vp->pos.y;
+		    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
+			ghost_color = surface_get_pixel(vp->surface,
+			    x_dmg_ghost - vp->pos.x, y);
+			surface_put_pixel(vp->surface,
+			    x_dmg_ghost - vp->pos.x, y, INVERT(ghost_color));
+		}
+	}
+
+	if (x_bnd_ghost + w_bnd_ghost == x_dmg_ghost + w_dmg_ghost) {
+		for (sysarg_t y = y_dmg_ghost - vp->pos.y;
+		    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
+			ghost_color = surface_get_pixel(vp->surface,
+			    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y);
+			surface_put_pixel(vp->surface,
+			    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y, INVERT(ghost_color));
+		}
+	}
+}
+
+static void comp_paint_pointer(viewport_t *vp, pointer_t *ptr,
+    sysarg_t x_dmg_vp, sysarg_t y_dmg_vp, sysarg_t w_dmg_vp, sysarg_t h_dmg_vp)
+{
+	/* pointer_list_mtx locked by caller */
+
+	/*
+	 * Determine what part of the pointer intersects with the
+	 * updated area of the current viewport.
+	 */
+	sysarg_t x_dmg_ptr, y_dmg_ptr, w_dmg_ptr, h_dmg_ptr;
+	surface_t *sf_ptr = ptr->cursor.states[ptr->state];
+	surface_get_resolution(sf_ptr, &w_dmg_ptr, &h_dmg_ptr);
+	bool isec_ptr = rectangle_intersect(
+	    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
+	    ptr->pos.x, ptr->pos.y, w_dmg_ptr, h_dmg_ptr,
+	    &x_dmg_ptr, &y_dmg_ptr, &w_dmg_ptr, &h_dmg_ptr);
+
+	if (!isec_ptr)
+		return;
+
+	/*
+	 * Pointer is currently painted directly by copying pixels.
+	 * However, it is possible to draw the pointer similarly
+	 * as window by using drawctx_transfer. It would allow
+	 * more sophisticated control over drawing, but would also
+	 * cost more regarding the performance.
+	 */
+
+	sysarg_t x_vp = x_dmg_ptr - vp->pos.x;
+	sysarg_t y_vp = y_dmg_ptr - vp->pos.y;
+	sysarg_t x_ptr = x_dmg_ptr - ptr->pos.x;
+	sysarg_t y_ptr = y_dmg_ptr - ptr->pos.y;
+
+	for (sysarg_t y = 0; y < h_dmg_ptr; ++y) {
+		pixel_t *src = pixelmap_pixel_at(
+		    surface_pixmap_access(sf_ptr), x_ptr, y_ptr + y);
+		pixel_t *dst = pixelmap_pixel_at(
+		    surface_pixmap_access(vp->surface), x_vp, y_vp + y);
+		sysarg_t count = w_dmg_ptr;
+		while (count-- != 0) {
+			*dst = (*src & 0xff000000) ? *src : *dst;
+			++dst;
+			++src;
+		}
+	}
+}
+
+/** Schedule repaint of a rectangle in global coordinates. */
 static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
     sysarg_t w_dmg_glob, sysarg_t h_dmg_glob)
 {
+	fibril_mutex_lock(&damage_mtx);
+
+	errno_t rc = region_union_rect(&damage,
+	    x_dmg_glob, y_dmg_glob, w_dmg_glob, h_dmg_glob);
+	if (rc != EOK)
+		damage_lost = true;
+	region_simplify(&damage, DAMAGE_MAX_RECTS);
+
+	fibril_condvar_signal(&damage_cv);
+	fibril_mutex_unlock(&damage_mtx);
+}
+
+/** Repaint damaged parts of all viewports.
+ *
+ * @param dmg Damaged region in global coordinates.
+ */
+static void comp_repaint(const region_t *dmg)
+{
+	region_t dmg_vp;
+	region_init(&dmg_vp);
+
 	fibril_mutex_lock(&viewport_list_mtx);
-	fibril_mutex_lock(&window_list_mtx);
-	fibril_mutex_lock(&pointer_list_mtx);
 
 	list_foreach(viewport_list, link, viewport_t, vp) {
 		/* Determine what part of the viewport must be updated. */
-		sysarg_t x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp;
-		surface_get_resolution(vp->surface, &w_dmg_vp, &h_dmg_vp);
-		bool isec_vp = rectangle_intersect(
-		    x_dmg_glob, y_dmg_glob, w_dmg_glob, h_dmg_glob,
-		    vp->pos.x, vp->pos.y, w_dmg_vp, h_dmg_vp,
-		    &x_dmg_vp, &y_dmg_vp, &w_dmg_vp, &h_dmg_vp);
-
-		if (isec_vp) {
-
-			/* Paint background color. */
-			for (sysarg_t y = y_dmg_vp - vp->pos.y; y <  y_dmg_vp - vp->pos.y + h_dmg_vp; ++y) {
-				pixel_t *dst = pixelmap_pixel_at(
-				    surface_pixmap_access(vp->surface), x_dmg_vp - vp->pos.x, y);
-				sysarg_t count = w_dmg_vp;
-				while (count-- != 0) {
-					*dst++ = bg_color;
-				}
-			}
-			surface_add_damaged_region(vp->surface,
-			    x_dmg_vp - vp->pos.x, y_dmg_vp - vp->pos.y, w_dmg_vp, h_dmg_vp);
+		sysarg_t w_vp, h_vp;
+		surface_get_resolution(vp->surface, &w_vp, &h_vp);
+		errno_t rc = region_intersect_rect(dmg,
+		    vp->pos.x, vp->pos.y, w_vp, h_vp, &dmg_vp);
+		if ((rc != EOK) || region_is_empty(&dmg_vp))
+			continue;
 
-			transform_t transform;
-			source_t source;
-			drawctx_t context;
+		fibril_mutex_lock(&window_list_mtx);
 
-			source_init(&source);
-			source_set_filter(&source, filter);
-			drawctx_init(&context, vp->surface);
-			drawctx_set_compose(&context, compose_over);
-			drawctx_set_source(&context, &source);
+		frame_t frame;
+		frame.vp = vp;
+		frame.dmg = &dmg_vp;
+		if (comp_prepare_layers(&frame) != EOK) {
+			/* Try again in the next frame. */
+			fibril_mutex_unlock(&window_list_mtx);
+			for (size_t i = 0; i < dmg_vp.count; ++i) {
+				const region_rect_t *rect = &dmg_vp.rects[i];
+				comp_damage(rect->x, rect->y, rect->w, rect->h);
+			}
 
-			/* For each window. */
-			for (link_t *link = window_list.head.prev;
-			    link != &window_list.head; link = link->prev) {
+			continue;
+		}
 
-				/*
-				 * Determine what part of the window intersects with the
-				 * updated area of the current viewport.
-				 */
-				window_t *win = list_get_instance(link, window_t, link);
-				if (!win->surface) {
-					continue;
-				}
-				sysarg_t x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win;
-				surface_get_resolution(win->surface, &w_dmg_win, &h_dmg_win);
-				comp_coord_bounding_rect(0, 0, w_dmg_win, h_dmg_win, win->transform,
-				    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
-				bool isec_win = rectangle_intersect(
-				    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-				    x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win,
-				    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
-
-				if (isec_win) {
-					/*
-					 * Prepare conversion from global coordinates to viewport
-					 * coordinates.
-					 */
-					transform = win->transform;
-					double_point_t pos;
-					pos.x = vp->pos.x;
-					pos.y = vp->pos.y;
-					transform_translate(&transform, -pos.x, -pos.y);
-
-					source_set_transform(&source, transform);
-					source_set_texture(&source, win->surface,
-					    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
-					source_set_alpha(&source, PIXEL(win->opacity, 0, 0, 0));
-
-					drawctx_transfer(&context,
-					    x_dmg_win - vp->pos.x, y_dmg_win - vp->pos.y, w_dmg_win, h_dmg_win);
-				}
-			}
+		/* The painters access the windows on behalf of this fibril. */
+		comp_paint_frame(&frame);
 
-			list_foreach(pointer_list, link, pointer_t, ptr) {
-				if (ptr->ghost.surface) {
-
-					sysarg_t x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost;
-					sysarg_t x_dmg_ghost, y_dmg_ghost, w_dmg_ghost, h_dmg_ghost;
-					surface_get_resolution(ptr->ghost.surface, &w_bnd_ghost, &h_bnd_ghost);
-					comp_coord_bounding_rect(0, 0, w_bnd_ghost, h_bnd_ghost, ptr->ghost.transform,
-					    &x_bnd_ghost, &y_bnd_ghost, &w_bnd_ghost, &h_bnd_ghost);
-					bool isec_ghost = rectangle_intersect(
-					    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-					    x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost,
-					    &x_dmg_ghost, &y_dmg_ghost, &w_dmg_ghost, &h_dmg_ghost);
-
-					if (isec_ghost) {
-						/*
-						 * FIXME: Ghost is currently drawn based on the bounding
-						 * rectangle of the window, which is sufficient as long
-						 * as the windows can be rotated only by 90 degrees.
-						 * For ghost to be compatible with arbitrary-angle
-						 * rotation, it should be drawn as four lines adjusted
-						 * by the transformation matrix. That would however
-						 * require to equip libdraw with line drawing functionality.
-						 */
-
-						transform_t transform = ptr->ghost.transform;
-						double_point_t pos;
-						pos.x = vp->pos.x;
-						pos.y = vp->pos.y;
-						transform_translate(&transform, -pos.x, -pos.y);
-
-						pixel_t ghost_color;
-
-						if (y_bnd_ghost == y_dmg_ghost) {
-							for (sysarg_t x = x_dmg_ghost - vp->pos.x;
-							    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y);
-								surface_put_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y, INVERT(ghost_color));
-							}
-						}
-
-						if (y_bnd_ghost + h_bnd_ghost == y_dmg_ghost + h_dmg_ghost) {
-							for (sysarg_t x = x_dmg_ghost - vp->pos.x;
-							    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1);
-								surface_put_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1, INVERT(ghost_color));
-							}
-						}
-
-						if (x_bnd_ghost == x_dmg_ghost) {
-							for (sysarg_t y = y_dmg_ghost - vp->pos.y;
-							    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x, y);
-								surface_put_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x, y, INVERT(ghost_color));
-							}
-						}
-
-						if (x_bnd_ghost + w_bnd_ghost == x_dmg_ghost + w_dmg_ghost) {
-							for (sysarg_t y = y_dmg_ghost - vp->pos.y;
-							    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y);
-								surface_put_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y, INVERT(ghost_color));
-							}
-						}
-					}
+		/* Ghosts refer to the surfaces of their windows. */
+		fibril_mutex_lock(&pointer_list_mtx);
+		list_foreach(pointer_list, link, pointer_t, ptr) {
+			if (!ptr->ghost.surface)
+				continue;
 
-				}
+			for (size_t i = 0; i < dmg_vp.count; ++i) {
+				const region_rect_t *rect = &dmg_vp.rects[i];
+				comp_paint_ghost(vp, ptr,
+				    rect->x, rect->y, rect->w, rect->h);
 			}
+		}
+		fibril_mutex_unlock(&window_list_mtx);
 
-			list_foreach(pointer_list, link, pointer_t, ptr) {
-
-				/*
-				 * Determine what part of the pointer intersects with the
-				 * updated area of the current viewport.
-				 */
-				sysarg_t x_dmg_ptr, y_dmg_ptr, w_dmg_ptr, h_dmg_ptr;
-				surface_t *sf_ptr = ptr->cursor.states[ptr->state];
-				surface_get_resolution(sf_ptr, &w_dmg_ptr, &h_dmg_ptr);
-				bool isec_ptr = rectangle_intersect(
-				    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-				    ptr->pos.x, ptr->pos.y, w_dmg_ptr, h_dmg_ptr,
-				    &x_dmg_ptr, &y_dmg_ptr, &w_dmg_ptr, &h_dmg_ptr);
-
-				if (isec_ptr) {
-					/*
-					 * Pointer is currently painted directly by copying pixels.
-					 * However, it is possible to draw the pointer similarly
-					 * as window by using drawctx_transfer. It would allow
-					 * more sophisticated control over drawing, but would also
-					 * cost more regarding the performance.
-					 */
-
-					sysarg_t x_vp = x_dmg_ptr - vp->pos.x;
-					sysarg_t y_vp = y_dmg_ptr - vp->pos.y;
-					sysarg_t x_ptr = x_dmg_ptr - ptr->pos.x;
-					sysarg_t y_ptr = y_dmg_ptr - ptr->pos.y;
-
-					for (sysarg_t y = 0; y < h_dmg_ptr; ++y) {
-						pixel_t *src = pixelmap_pixel_at(
-						    surface_pixmap_access(sf_ptr), x_ptr, y_ptr + y);
-						pixel_t *dst = pixelmap_pixel_at(
-						    surface_pixmap_access(vp->surface), x_vp, y_vp + y);
-						sysarg_t count = w_dmg_ptr;
-						while (count-- != 0) {
-							*dst = (*src & 0xff000000) ? *src : *dst;
-							++dst;
-							++src;
-						}
-					}
-					surface_add_damaged_region(vp->surface, x_vp, y_vp, w_dmg_ptr, h_dmg_ptr);
-				}
+		list_foreach(pointer_list, link, pointer_t, ptr) {
+			for (size_t i = 0; i < dmg_vp.count; ++i) {
+				const region_rect_t *rect = &dmg_vp.rects[i];
+				comp_paint_pointer(vp, ptr,
+				    rect->x, rect->y, rect->w, rect->h);
+			}
+		}
+		fibril_mutex_unlock(&pointer_list_mtx);
 
+		/* Notify visualizer about updated regions. */
+		surface_reset_damaged_region(vp->surface);
+		if (active) {
+			for (size_t i = 0; i < dmg_vp.count; ++i) {
+				const region_rect_t *rect = &dmg_vp.rects[i];
+				visualizer_update_damaged_region(vp->sess,
+				    rect->x - vp->pos.x, rect->y - vp->pos.y,
+				    rect->w, rect->h, 0, 0);
 			}
 		}
 	}
 
+	fibril_mutex_unlock(&viewport_list_mtx);
+
+	region_fini(&dmg_vp);
+}
+
+/** Apply the motion of all pointers accumulated since the previous frame. */
+static void comp_apply_motion_all(void)
+{
+	/* Pointers are never removed from the list while running. */
+	fibril_mutex_lock(&pointer_list_mtx);
+	link_t *link = list_first(&pointer_list);
 	fibril_mutex_unlock(&pointer_list_mtx);
-	fibril_mutex_unlock(&window_list_mtx);
 
-	/* Notify visualizers about updated regions. */
-	if (active) {
-		list_foreach(viewport_list, link, viewport_t, vp) {
-			sysarg_t x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp;
-			surface_get_damaged_region(vp->surface, &x_dmg_vp, &y_dmg_vp, &w_dmg_vp, &h_dmg_vp);
-			surface_reset_damaged_region(vp->surface);
-			visualizer_update_damaged_region(vp->sess,
-			    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp, 0, 0);
+	while (link != NULL) {
+		comp_apply_motion(list_get_instance(link, pointer_t, link));
+
+		fibril_mutex_lock(&pointer_list_mtx);
+		link = list_next(link, &pointer_list);
+		fibril_mutex_unlock(&pointer_list_mtx);
+	}
+}
+
+/** Repaint the damage collected since the previous frame.
+ *
+ * There is no vertical retrace notification from the visualizers, so the
+ * repaints are paced by a nominal refresh interval. Damage reported in the
+ * meantime is merged and painted at once. Pointer motion is applied at the
+ * start of the frame, so that fast pointing devices move the pointer (and
+ * windows dragged by it) once per frame rather than once per event.
+ */
+static errno_t comp_repaint_fibril(void *arg)
+{
+	region_t dmg;
+	region_init(&dmg);
+
+	struct timespec next;
+	getuptime(&next);
+
+	while (true) {
+		fibril_mutex_lock(&damage_mtx);
+
+		while (region_is_empty(&damage) && !motion_pending && !damage_lost)
+			fibril_condvar_wait(&damage_cv, &damage_mtx);
+
+		struct timespec now;
+		getuptime(&now);
+		if (ts_gt(&next, &now)) {
+			fibril_mutex_unlock(&damage_mtx);
+			fibril_usleep(NSEC2USEC(ts_sub_diff(&next, &now)));
+			fibril_mutex_lock(&damage_mtx);
+			getuptime(&now);
+		}
+
+		if (motion_pending) {
+			motion_pending = false;
+			fibril_mutex_unlock(&damage_mtx);
+			comp_apply_motion_all();
+			fibril_mutex_lock(&damage_mtx);
+		}
+
+		/* Swap the regions so that both keep their memory. */
+		region_t pending = damage;
+		damage = dmg;
+		dmg = pending;
+
+		/*
+		 * A region that has any memory can always take the whole
+		 * desktop. If even that fails, try again in the next frame.
+		 */
+		if (damage_lost) {
+			errno_t rc = region_union_rect(&dmg,
+			    0, 0, UINT32_MAX, UINT32_MAX);
+			damage_lost = (rc != EOK);
 		}
+
+		fibril_mutex_unlock(&damage_mtx);
+
+		next = now;
+		ts_add_diff(&next, USEC2NSEC(REPAINT_INTERVAL));
+
+		comp_repaint(&dmg);
+		region_clear(&dmg);
 	}
 
-	fibril_mutex_unlock(&viewport_list_mtx);
+	return EOK;
 }
 
 static void comp_window_get_event(window_t *win, ipc_call_t *icall)
@@ -639,9 +1264,13 @@ static void comp_window_damage(window_t *win, ipc_call_t *icall)
 	double height = IPC_GET_ARG4(*icall);
 
 	if ((width == 0) || (height == 0)) {
+		fibril_mutex_lock(&window_list_mtx);
+		comp_window_scan_translucent(win, 0, 0, UINT32_MAX, UINT32_MAX);
+		fibril_mutex_unlock(&window_list_mtx);
 		comp_damage(0, 0, UINT32_MAX, UINT32_MAX);
 	} else {
 		fibril_mutex_lock(&window_list_mtx);
+		comp_window_scan_translucent(win, x, y, width, height);
 		sysarg_t x_dmg_glob, y_dmg_glob, w_dmg_glob, h_dmg_glob;
 		comp_coord_bounding_rect(x - 1, y - 1, width + 2, height + 2,
 		    win->transform, &x_dmg_glob, &y_dmg_glob, &w_dmg_glob, &h_dmg_glob);
@@ -763,6 +1392,9 @@ static void comp_window_resize(window_t *win, ipc_call_t *icall)
 	sysarg_t new_height = 0;
 	surface_get_resolution(win->surface, &new_width, &new_height);
 
+	/* Nothing is known about the content until the client damages it. */
+	win->translucent = (region_rect_t) { 0, 0, new_width, new_height };
+
 	if (placement_flags & WINDOW_PLACEMENT_CENTER_X)
 		win->dx = viewport_bound_rect.x + viewport_bound_rect.w / 2 -
 		    new_width / 2;
@@ -1540,20 +2172,43 @@ static errno_t comp_abs_move(input_t *input, unsigned x, unsigned y,
 	pos_in_viewport.x = x * width / max_x;
 	pos_in_viewport.y = y * height / max_y;
 
-	/* Calculate offset from pointer */
+	/* Calculate offset from pointer (including the pending motion) */
 	fibril_mutex_lock(&pointer_list_mtx);
 	desktop_vector_t delta;
-	delta.x = (vp_pos.x + pos_in_viewport.x) - pointer->pos.x;
-	delta.y = (vp_pos.y + pos_in_viewport.y) - pointer->pos.y;
+	delta.x = (vp_pos.x + pos_in_viewport.x) -
+	    (pointer->pos.x + pointer->motion.x);
+	delta.y = (vp_pos.y + pos_in_viewport.y) -
+	    (pointer->pos.y + pointer->motion.y);
 	fibril_mutex_unlock(&pointer_list_mtx);
 
 	return comp_mouse_move(input, delta.x, delta.y);
 }
 
+/** Pointer has moved (relative mode).
+ *
+ * The motion is only accumulated, it is applied by the repaint fibril
+ * once per frame (or before the next button event).
+ */
 static errno_t comp_mouse_move(input_t *input, int dx, int dy)
 {
 	pointer_t *pointer = input_pointer(input);
 
+	fibril_mutex_lock(&pointer_list_mtx);
+	pointer->motion.x += dx;
+	pointer->motion.y += dy;
+	fibril_mutex_unlock(&pointer_list_mtx);
+
+	fibril_mutex_lock(&damage_mtx);
+	motion_pending = true;
+	fibril_condvar_signal(&damage_cv);
+	fibril_mutex_unlock(&damage_mtx);
+
+	return EOK;
+}
+
+/** Move pointer and whatever it drags. */
+static void comp_pointer_move(pointer_t *pointer, int dx, int dy)
+{
 	comp_update_viewport_bound_rect();
 
 	/* Update pointer position. */
@@ -1658,14 +2313,28 @@ static errno_t comp_mouse_move(input_t *input, int dx, int dy)
 		fibril_mutex_unlock(&pointer_list_mtx);
 		fibril_mutex_unlock(&window_list_mtx);
 	}
+}
 
-	return EOK;
+/** Apply the motion accumulated by comp_mouse_move(). */
+static void comp_apply_motion(pointer_t *pointer)
+{
+	fibril_mutex_lock(&pointer_list_mtx);
+	desktop_vector_t motion = pointer->motion;
+	pointer->motion.x = 0;
+	pointer->motion.y = 0;
+	fibril_mutex_unlock(&pointer_list_mtx);
+
+	if ((motion.x != 0) || (motion.y != 0))
+		comp_pointer_move(pointer, motion.x, motion.y);
 }
 
 static errno_t comp_mouse_button(input_t *input, int bnum, int bpress)
 {
 	pointer_t *pointer = input_pointer(input);
 
+	/* The button applies to where the pointer is now. */
+	comp_apply_motion(pointer);
+
 	fibril_mutex_lock(&window_list_mtx);
 	fibril_mutex_lock(&pointer_list_mtx);
 	window_t *win = NULL;
@@ -2283,10 +2952,26 @@ static errno_t compositor_srv_init(char *input_svc, char *name)
 	/* Color of the viewport background. Must be opaque. */
 	bg_color = PIXEL(255, 69, 51, 103);
 
+	/* Start painting the damage. */
+	errno_t rc = comp_painters_init();
+	if (rc != EOK) {
+		printf("%s: Unable to create painters\n", NAME);
+		return rc;
+	}
+
+	region_init(&damage);
+	fid_t repaint_fid = fibril_create(comp_repaint_fibril, NULL);
+	if (repaint_fid == 0) {
+		printf("%s: Unable to create repaint fibril\n", NAME);
+		return ENOMEM;
+	}
+
+	fibril_add_ready(repaint_fid);
+
 	/* Register compositor server. */
 	async_set_fallback_port_handler(client_connection, NULL);
 
-	errno_t rc = loc_server_register(NAME);
+	rc = loc_server_register(NAME);
 	if (rc != EOK) {
 		printf("%s: Unable to register server (%s)\n", NAME, str_error(rc));
 		return -1;
@@ -291,8 +291,14 @@ static errno_t input_ev_button(input_t *input, int bnum, int bpress)
 	return EOK;
 }
 
-/** Process a character from the client (TTY emulation). */
-static void cons_write_char(console_t *cons, wchar_t ch)
+/** Process a character from the client (TTY emulation).
+ *
+ * The character is written to the console buffer.
+ *
+ * @return True if the output needs to be updated (more than the
+ *         character itself changed, e.g. the console scrolled).
+ */
+static bool cons_write_char(console_t *cons, wchar_t ch)
 {
 	sysarg_t updated = 0;
 
@@ -316,8 +322,7 @@ static void cons_write_char(console_t *cons, wchar_t ch)
 
 	fibril_mutex_unlock(&cons->mtx);
 
-	if (updated > 1)
-		cons_update(cons);
+	return (updated > 1);
 }
 
 static void cons_set_cursor_vis(console_t *cons, bool visible)
@@ -387,9 +392,20 @@ static errno_t cons_write(con_srv_t *srv, void *data, size_t size, size_t *nwrit
 {
 	console_t *cons = srv_to_console(srv);
 
+	/*
+	 * The output is updated once for the whole buffer, so lines
+	 * scrolled out within it are never drawn and the output server
+	 * gets to scroll by several rows at once.
+	 */
+	bool update = false;
 	size_t off = 0;
-	while (off < size)
-		cons_write_char(cons, str_decode(data, &off, size));
+	while (off < size) {
+		if (cons_write_char(cons, str_decode(data, &off, size)))
+			update = true;
+	}
+
+	if (update)
+		cons_update(cons);
 
 	*nwritten = size;
 	return EOK;
@@ -49,12 +49,15 @@
 #include <ipc/services.h>
 #include <ipc/input.h>
 #include <loc.h>
+#include <macros.h>
+#include <mem.h>
 #include <ns.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
 #include <str_error.h>
+#include <time.h>
 
 #include "input.h"
 #include "kbd.h"
@@ -83,6 +86,22 @@ typedef struct {
 
 	/** Client callback session */
 	async_sess_t *sess;
+
+	/** Protects the event queue */
+	fibril_mutex_t lock;
+	/** Signalled when events are queued or the client is closing */
+	fibril_condvar_t cv;
+
+	/** Events waiting for delivery */
+	input_batch_event_t *queue;
+	size_t queue_count;
+	/** Allocated size of the queue (in events) */
+	size_t queue_size;
+
+	/** Delivery fibril is running */
+	bool delivering;
+	/** Delivery fibril should terminate */
+	bool closing;
 } client_t;
 
 /** List of clients */
@@ -115,6 +134,8 @@ static void *client_data_create(void)
 	link_initialize(&client->link);
 	client->active = false;
 	client->sess = NULL;
+	fibril_mutex_initialize(&client->lock);
+	fibril_condvar_initialize(&client->cv);
 
 	list_append(&client->link, &clients);
 
@@ -126,9 +147,181 @@ static void client_data_destroy(void *data)
 	client_t *client = (client_t *) data;
 
 	list_remove(&client->link);
+	free(client->queue);
 	free(client);
 }
 
+/** Make room for one more event in the queue of a client
+ *
+ * @param client Client, its lock must be held
+ *
+ * @return True on success, false if out of memory
+ */
+static bool client_queue_reserve(client_t *client)
+{
+	if (client->queue_count < client->queue_size)
+		return true;
+
+	size_t size = (client->queue_size > 0) ?
+	    2 * client->queue_size : INPUT_BATCH_MAX;
+	input_batch_event_t *queue = realloc(client->queue,
+	    size * sizeof(input_batch_event_t));
+	if (queue == NULL)
+		return false;
+
+	client->queue = queue;
+	client->queue_size = size;
+	return true;
+}
+
+/** Queue event for delivery to a client
+ *
+ * Consecutive pointer motion is merged into a single event, so that
+ * a client busy with the previous batch receives just the total motion.
+ * Other events are never merged, the queue grows until the client
+ * catches up.
+ *
+ * @param client Client
+ * @param type   Event notification method
+ * @param arg1   First argument
+ * @param arg2   Second argument
+ * @param arg3   Third argument
+ * @param arg4   Fourth argument
+ */
+static void client_push_event(client_t *client, input_notif_t type,
+    uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4)
+{
+	struct timespec now;
+	getuptime(&now);
+	uint64_t usec = SEC2USEC(now.tv_sec) + NSEC2USEC(now.tv_nsec);
+
+	fibril_mutex_lock(&client->lock);
+
+	input_batch_event_t *last = (client->queue_count > 0) ?
+	    &client->queue[client->queue_count - 1] : NULL;
+
+	if ((last != NULL) && (last->type == type) &&
+	    (type == INPUT_EVENT_MOVE)) {
+		last->arg[0] = (int32_t) last->arg[0] + (int32_t) arg1;
+		last->arg[1] = (int32_t) last->arg[1] + (int32_t) arg2;
+		last->usec = usec;
+	} else if ((last != NULL) && (last->type == type) &&
+	    (type == INPUT_EVENT_ABS_MOVE) &&
+	    (last->arg[2] == arg3) && (last->arg[3] == arg4)) {
+		last->arg[0] = arg1;
+		last->arg[1] = arg2;
+		last->usec = usec;
+	} else if (client_queue_reserve(client)) {
+		input_batch_event_t *event = &client->queue[client->queue_count++];
+		event->type = type;
+		event->arg[0] = arg1;
+		event->arg[1] = arg2;
+		event->arg[2] = arg3;
+		event->arg[3] = arg4;
+		event->usec = usec;
+	} else {
+		printf("%s: Error queueing event. Out of memory.\n", NAME);
+	}
+
+	fibril_condvar_signal(&client->cv);
+	fibril_mutex_unlock(&client->lock);
+}
+
+/** Queue event for delivery to the active client */
+static void push_event(input_notif_t type, uint32_t arg1, uint32_t arg2,
+    uint32_t arg3, uint32_t arg4)
+{
+	list_foreach(clients, link, client_t, client) {
+		if (client->active)
+			client_push_event(client, type, arg1, arg2, arg3, arg4);
+	}
+}
+
+/** Deliver queued events to a client
+ *
+ * Events queued so far are sent in batches of up to INPUT_BATCH_MAX
+ * events. The next batch is not sent before the client has processed
+ * the previous one, events arriving meanwhile are queued (and pointer
+ * motion merged).
+ *
+ * @param arg Client
+ *
+ * @return Zero
+ */
+static errno_t client_delivery_fibril(void *arg)
+{
+	client_t *client = (client_t *) arg;
+	input_batch_event_t batch[INPUT_BATCH_MAX];
+
+	while (true) {
+		fibril_mutex_lock(&client->lock);
+		while ((client->queue_count == 0) && (!client->closing))
+			fibril_condvar_wait(&client->cv, &client->lock);
+
+		if (client->closing) {
+			client->delivering = false;
+			fibril_condvar_broadcast(&client->cv);
+			fibril_mutex_unlock(&client->lock);
+			return 0;
+		}
+
+		size_t count = min(client->queue_count, (size_t) INPUT_BATCH_MAX);
+		memcpy(batch, client->queue, count * sizeof(input_batch_event_t));
+		client->queue_count -= count;
+		memmove(client->queue, client->queue + count,
+		    client->queue_count * sizeof(input_batch_event_t));
+		fibril_mutex_unlock(&client->lock);
+
+		async_exch_t *exch = async_exchange_begin(client->sess);
+		aid_t req = async_send_1(exch, INPUT_EVENT_BATCH, count, NULL);
+		errno_t rc = async_data_write_start(exch, batch,
+		    count * sizeof(input_batch_event_t));
+		async_exchange_end(exch);
+
+		if (rc != EOK) {
+			async_forget(req);
+			continue;
+		}
+
+		async_wait_for(req, NULL);
+	}
+}
+
+/** Start delivering events to a client
+ *
+ * @param client Client with a callback session
+ *
+ * @return EOK on success, ENOMEM if the fibril cannot be created
+ */
+static errno_t client_delivery_start(client_t *client)
+{
+	fid_t fid = fibril_create(client_delivery_fibril, client);
+	if (fid == 0)
+		return ENOMEM;
+
+	client->delivering = true;
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+/** Stop delivering events to a client
+ *
+ * Waits for the batch being delivered, the rest of the events is
+ * discarded.
+ *
+ * @param client Client
+ */
+static void client_delivery_stop(client_t *client)
+{
+	fibril_mutex_lock(&client->lock);
+	client->closing = true;
+	fibril_condvar_broadcast(&client->cv);
+	while (client->delivering)
+		fibril_condvar_wait(&client->cv, &client->lock);
+	client->queue_count = 0;
+	fibril_mutex_unlock(&client->lock);
+}
+
 void kbd_push_data(kbd_dev_t *kdev, sysarg_t data)
 {
 	(*kdev->ctl_ops->parse)(data);
@@ -241,37 +434,23 @@ void kbd_push_event(kbd_dev_t *kdev, int type, unsigned int key)
 
 	ev.c = layout_parse_ev(kdev->active_layout, &ev);
 
-	list_foreach(clients, link, client_t, client) {
-		if (client->active) {
-			async_exch_t *exch = async_exchange_begin(client->sess);
-			async_msg_4(exch, INPUT_EVENT_KEY, ev.type, ev.key, ev.mods, ev.c);
-			async_exchange_end(exch);
-		}
-	}
+	push_event(INPUT_EVENT_KEY, ev.type, ev.key, ev.mods, ev.c);
 }
 
 /** Mouse pointer has moved (relative mode). */
 void mouse_push_event_move(mouse_dev_t *mdev, int dx, int dy, int dz)
 {
-	list_foreach(clients, link, client_t, client) {
-		if (client->active) {
-			async_exch_t *exch = async_exchange_begin(client->sess);
-
-			if ((dx) || (dy))
-				async_msg_2(exch, INPUT_EVENT_MOVE, dx, dy);
+	if ((dx) || (dy))
+		push_event(INPUT_EVENT_MOVE, dx, dy, 0, 0);
 
-			if (dz) {
-				// TODO: Implement proper wheel support
-				keycode_t code = dz > 0 ? KC_UP : KC_DOWN;
+	if (dz) {
+		// TODO: Implement proper wheel support
+		keycode_t code = dz > 0 ? KC_UP : KC_DOWN;
 
-				for (unsigned int i = 0; i < 3; i++)
-					async_msg_4(exch, INPUT_EVENT_KEY, KEY_PRESS, code, 0, 0);
+		for (unsigned int i = 0; i < 3; i++)
+			push_event(INPUT_EVENT_KEY, KEY_PRESS, code, 0, 0);
 
-				async_msg_4(exch, INPUT_EVENT_KEY, KEY_RELEASE, code, 0, 0);
-			}
-
-			async_exchange_end(exch);
-		}
+		push_event(INPUT_EVENT_KEY, KEY_RELEASE, code, 0, 0);
 	}
 }
 
@@ -279,27 +458,14 @@ void mouse_push_event_move(mouse_dev_t *mdev, int dx, int dy, int dz)
 void mouse_push_event_abs_move(mouse_dev_t *mdev, unsigned int x, unsigned int y,
     unsigned int max_x, unsigned int max_y)
 {
-	list_foreach(clients, link, client_t, client) {
-		if (client->active) {
-			if ((max_x) && (max_y)) {
-				async_exch_t *exch = async_exchange_begin(client->sess);
-				async_msg_4(exch, INPUT_EVENT_ABS_MOVE, x, y, max_x, max_y);
-				async_exchange_end(exch);
-			}
-		}
-	}
+	if ((max_x) && (max_y))
+		push_event(INPUT_EVENT_ABS_MOVE, x, y, max_x, max_y);
 }
 
 /** Mouse button has been pressed. */
 void mouse_push_event_button(mouse_dev_t *mdev, int bnum, int press)
 {
-	list_foreach(clients, link, client_t, client) {
-		if (client->active) {
-			async_exch_t *exch = async_exchange_begin(client->sess);
-			async_msg_2(exch, INPUT_EVENT_BUTTON, bnum, press);
-			async_exchange_end(exch);
-		}
-	}
+	push_event(INPUT_EVENT_BUTTON, bnum, press, 0, 0);
 }
 
 /** Arbitrate client actiovation */
@@ -309,12 +475,13 @@ static void client_arbitration(void)
 	list_foreach(clients, link, client_t, client)
 		client->active = ((active) && (client == active_client));
 
-	/* Notify clients about the arbitration */
+	/*
+	 * Notify clients about the arbitration. The notification is
+	 * queued, so that it is delivered after the pending events.
+	 */
 	list_foreach(clients, link, client_t, client) {
-		async_exch_t *exch = async_exchange_begin(client->sess);
-		async_msg_0(exch, client->active ?
-		    INPUT_EVENT_ACTIVE : INPUT_EVENT_DEACTIVE);
-		async_exchange_end(exch);
+		client_push_event(client, client->active ?
+		    INPUT_EVENT_ACTIVE : INPUT_EVENT_DEACTIVE, 0, 0, 0, 0);
 	}
 }
 
@@ -335,6 +502,7 @@ static void client_connection(ipc_call_t *icall, void *arg)
 
 		if (!IPC_GET_IMETHOD(call)) {
 			if (client->sess != NULL) {
+				client_delivery_stop(client);
 				async_hangup(client->sess);
 				client->sess = NULL;
 			}
@@ -348,7 +516,13 @@ static void client_connection(ipc_call_t *icall, void *arg)
 		if (sess != NULL) {
 			if (client->sess == NULL) {
 				client->sess = sess;
-				async_answer_0(&call, EOK);
+				errno_t rc = client_delivery_start(client);
+				if (rc != EOK) {
+					client->sess = NULL;
+					async_hangup(sess);
+				}
+
+				async_answer_0(&call, rc);
 			} else
 				async_answer_0(&call, ELIMIT);
 		} else {
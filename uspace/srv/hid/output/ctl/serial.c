@@ -111,6 +111,13 @@ static void serial_flush(outdev_t *dev)
 	vt100_flush(state);
 }
 
+static void serial_scroll(outdev_t *dev, sysarg_t rows)
+{
+	vt100_state_t *state = (vt100_state_t *) dev->data;
+
+	vt100_scroll(state, rows);
+}
+
 static outdev_ops_t serial_ops = {
 	.yield = serial_yield,
 	.claim = serial_claim,
@@ -118,7 +125,8 @@ static outdev_ops_t serial_ops = {
 	.get_caps = serial_get_caps,
 	.cursor_update = serial_cursor_update,
 	.char_update = serial_char_update,
-	.flush = serial_flush
+	.flush = serial_flush,
+	.scroll = serial_scroll
 };
 
 errno_t serial_init(vt100_putwchar_t putwchar_fn,
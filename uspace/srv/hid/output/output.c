@@ -68,6 +68,7 @@ outdev_t *outdev_register(outdev_ops_t *ops, void *data)
 
 	dev->ops = *ops;
 	dev->data = data;
+	dev->top_row = 0;
 
 	ops->get_dimensions(dev, &dev->cols, &dev->rows);
 	dev->backbuf = chargrid_create(dev->cols, dev->rows,
@@ -266,6 +267,19 @@ static void srv_set_rgb_color(ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+/** Scroll the device and its back buffer.
+ *
+ * The back buffer is cyclic, so it is scrolled just by moving its
+ * top row. The rows that appear at the bottom still hold the rows
+ * that disappeared at the top, they are redrawn by the caller.
+ */
+static void srv_scroll(outdev_t *dev, sysarg_t rows)
+{
+	dev->ops.scroll(dev, rows);
+	dev->backbuf->top_row = (dev->backbuf->top_row + rows) %
+	    dev->backbuf->rows;
+}
+
 static bool srv_update_scroll(outdev_t *dev, chargrid_t *buf)
 {
 	assert(dev->ops.char_update);
@@ -275,15 +289,32 @@ static bool srv_update_scroll(outdev_t *dev, chargrid_t *buf)
 	if (dev->top_row == top_row)
 		return false;
 
+	/*
+	 * If the contents of the buffer just moved up (which is what
+	 * happens when the console scrolls), the device can scroll
+	 * on its own and only the new rows at the bottom are redrawn.
+	 * Otherwise every changed cell gets redrawn. Either way, all
+	 * the cells are compared, so that even a wrong guess of the
+	 * scroll amount (e.g. after switching consoles) is harmless.
+	 */
+	sysarg_t fresh = 0;
+	if ((dev->ops.scroll) && (buf->cols == dev->cols) &&
+	    (buf->rows == dev->rows)) {
+		fresh = (top_row + dev->rows - dev->top_row) % dev->rows;
+		srv_scroll(dev, fresh);
+	}
+
 	dev->top_row = top_row;
 
 	for (sysarg_t y = 0; y < dev->rows; y++) {
+		bool redraw = (y >= dev->rows - fresh);
+
 		for (sysarg_t x = 0; x < dev->cols; x++) {
 			charfield_t *front_field =
 			    chargrid_charfield_at(buf, x, y);
 			charfield_t *back_field =
 			    chargrid_charfield_at(dev->backbuf, x, y);
-			bool update = false;
+			bool update = redraw;
 
 			if (front_field->ch != back_field->ch) {
 				back_field->ch = front_field->ch;
@@ -56,6 +56,13 @@ typedef struct {
 	    sysarg_t prev_row, sysarg_t col, sysarg_t row, bool visible);
 	void (*char_update)(struct outdev *dev, sysarg_t col, sysarg_t row);
 	void (*flush)(struct outdev *dev);
+
+	/**
+	 * Scroll the whole screen up by the given number of rows
+	 * (less than the number of rows of the device). The contents
+	 * of the rows that appear at the bottom are undefined. Optional.
+	 */
+	void (*scroll)(struct outdev *dev, sysarg_t rows);
 } outdev_ops_t;
 
 typedef struct outdev {
@@ -36,6 +36,7 @@
 #include <as.h>
 #include <ddi.h>
 #include <io/chargrid.h>
+#include <mem.h>
 #include "../output.h"
 #include "ega.h"
 
@@ -173,6 +174,12 @@ static void ega_flush(outdev_t *dev)
 {
 }
 
+static void ega_scroll(outdev_t *dev, sysarg_t rows)
+{
+	memmove(ega.addr, ega.addr + FB_POS(0, rows),
+	    FB_POS(0, ega.rows - rows));
+}
+
 static outdev_ops_t ega_ops = {
 	.yield = ega_yield,
 	.claim = ega_claim,
@@ -180,7 +187,8 @@ static outdev_ops_t ega_ops = {
 	.get_caps = ega_get_caps,
 	.cursor_update = ega_cursor_update,
 	.char_update = ega_char_update,
-	.flush = ega_flush
+	.flush = ega_flush,
+	.scroll = ega_scroll
 };
 
 errno_t ega_init(void)
@@ -91,6 +91,17 @@ static void vt100_set_pos(vt100_state_t *state, sysarg_t col, sysarg_t row)
 	state->control_puts(control);
 }
 
+/** DEC Set Top and Bottom Margins (of the scrolling region). */
+static void vt100_set_margins(vt100_state_t *state, sysarg_t top,
+    sysarg_t bottom)
+{
+	char control[MAX_CONTROL];
+
+	snprintf(control, MAX_CONTROL, "\033[%" PRIun ";%" PRIun "r",
+	    top + 1, bottom + 1);
+	state->control_puts(control);
+}
+
 static void vt100_set_sgr(vt100_state_t *state, char_attrs_t attrs)
 {
 	switch (attrs.type) {
@@ -166,6 +177,9 @@ vt100_state_t *vt100_state_create(sysarg_t cols, sysarg_t rows,
 	state->control_puts("\033[2J");
 	state->control_puts("\033[?25l");
 
+	/* Scroll the whole screen (this also homes the cursor). */
+	vt100_set_margins(state, 0, rows - 1);
+
 	return state;
 }
 
@@ -230,6 +244,19 @@ void vt100_putwchar(vt100_state_t *state, wchar_t ch)
 	}
 }
 
+/** Scroll the screen up.
+ *
+ * The scrolling region spans the whole screen, so an Index (IND)
+ * at its bottom margin moves the contents up by one row.
+ */
+void vt100_scroll(vt100_state_t *state, sysarg_t rows)
+{
+	vt100_goto(state, 0, state->rows - 1);
+
+	for (sysarg_t i = 0; i < rows; i++)
+		state->control_puts("\033D");
+}
+
 void vt100_flush(vt100_state_t *state)
 {
 	state->flush();
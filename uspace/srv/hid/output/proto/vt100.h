@@ -64,6 +64,7 @@ extern void vt100_goto(vt100_state_t *, sysarg_t, sysarg_t);
 extern void vt100_set_attr(vt100_state_t *, char_attrs_t);
 extern void vt100_cursor_visibility(vt100_state_t *, bool);
 extern void vt100_putwchar(vt100_state_t *, wchar_t);
+extern void vt100_scroll(vt100_state_t *, sysarg_t);
 extern void vt100_flush(vt100_state_t *);
 
 #endif
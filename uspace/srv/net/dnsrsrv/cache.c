@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup dnsrsrv
+ * @{
+ */
+/**
+ * @file
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <stdlib.h>
+#include <str.h>
+#include <time.h>
+#include "cache.h"
+#include "dns_type.h"
+
+/** Maximum number of cached answers */
+#define DNS_CACHE_MAX		512
+/** Upper limit for the time to live of a positive answer in seconds */
+#define DNS_CACHE_TTL_MAX	(24 * 60 * 60)
+/** Time to live of a negative answer in seconds */
+#define DNS_CACHE_NEG_TTL	60
+/** Minimum number of hits in the prefetch window to refresh an entry */
+#define DNS_CACHE_PREFETCH_HITS	2
+/** Fraction of the time to live left at which an entry is refreshed */
+#define DNS_CACHE_PREFETCH_DIV	10
+
+/** Cache lookup key */
+typedef struct {
+	const char *name;
+	dns_qtype_t qtype;
+} dns_cache_key_t;
+
+static FIBRIL_MUTEX_INITIALIZE(dns_cache_lock);
+/** Signalled when a pending entry receives its answer */
+static FIBRIL_CONDVAR_INITIALIZE(dns_cache_cv);
+/** Cached answers (of dns_cache_entry_t) */
+static hash_table_t dns_cache_map;
+/** Cached answers, least recently used first */
+static LIST_INITIALIZE(dns_cache_lru);
+static dnsr_cache_stat_t dns_cache_stat;
+
+/** Hash a cache key.
+ *
+ * Domain names compare case-insensitively (RFC 4343), so the name is
+ * hashed in lower case.
+ */
+static size_t dns_cache_key_hash(void *arg)
+{
+	dns_cache_key_t *key = (dns_cache_key_t *) arg;
+	size_t hash = key->qtype;
+
+	for (const char *cp = key->name; *cp != '\0'; cp++)
+		hash = hash * 31 + (uint8_t) tolower((uint8_t) *cp);
+
+	return hash_mix(hash);
+}
+
+static size_t dns_cache_hash(const ht_link_t *item)
+{
+	dns_cache_entry_t *entry =
+	    hash_table_get_inst(item, dns_cache_entry_t, cache_link);
+	dns_cache_key_t key = {
+		.name = entry->name,
+		.qtype = entry->qtype
+	};
+
+	return dns_cache_key_hash(&key);
+}
+
+static bool dns_cache_key_equal(void *arg, const ht_link_t *item)
+{
+	dns_cache_key_t *key = (dns_cache_key_t *) arg;
+	dns_cache_entry_t *entry =
+	    hash_table_get_inst(item, dns_cache_entry_t, cache_link);
+
+	return entry->qtype == key->qtype &&
+	    str_casecmp(entry->name, key->name) == 0;
+}
+
+static void dns_cache_entry_release(dns_cache_entry_t *entry)
+{
+	assert(entry->refcnt > 0);
+	if (--entry->refcnt > 0)
+		return;
+
+	free(entry->name);
+	free(entry->cname);
+	free(entry);
+}
+
+static void dns_cache_remove_callback(ht_link_t *item)
+{
+	dns_cache_entry_t *entry =
+	    hash_table_get_inst(item, dns_cache_entry_t, cache_link);
+
+	list_remove(&entry->lru_link);
+	--dns_cache_stat.entries;
+	if (entry->rc != EOK && !entry->pending)
+		--dns_cache_stat.negative;
+
+	dns_cache_entry_release(entry);
+}
+
+static hash_table_ops_t dns_cache_ops = {
+	.hash = dns_cache_hash,
+	.key_hash = dns_cache_key_hash,
+	.key_equal = dns_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = dns_cache_remove_callback
+};
+
+errno_t dns_cache_init(void)
+{
+	if (!hash_table_create(&dns_cache_map, 0, 0, &dns_cache_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
+static dns_cache_entry_t *dns_cache_find(const char *name, dns_qtype_t qtype)
+{
+	dns_cache_key_t key = {
+		.name = name,
+		.qtype = qtype
+	};
+
+	ht_link_t *link = hash_table_find(&dns_cache_map, &key);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, dns_cache_entry_t, cache_link);
+}
+
+/** Make room for a new entry by discarding the least recently used one.
+ *
+ * Entries with a query in progress are never discarded.
+ */
+static void dns_cache_evict(void)
+{
+	list_foreach(dns_cache_lru, lru_link, dns_cache_entry_t, entry) {
+		if (!entry->pending) {
+			hash_table_remove_item(&dns_cache_map, &entry->cache_link);
+			return;
+		}
+	}
+}
+
+/** Create a pending cache entry.
+ *
+ * @return New entry or @c NULL if out of memory
+ */
+static dns_cache_entry_t *dns_cache_entry_create(const char *name,
+    dns_qtype_t qtype)
+{
+	dns_cache_entry_t *entry = calloc(1, sizeof(dns_cache_entry_t));
+	if (entry == NULL)
+		return NULL;
+
+	entry->name = str_dup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		return NULL;
+	}
+
+	if (dns_cache_stat.entries >= DNS_CACHE_MAX)
+		dns_cache_evict();
+
+	entry->refcnt = 1;
+	entry->qtype = qtype;
+	entry->pending = true;
+	link_initialize(&entry->lru_link);
+
+	hash_table_insert(&dns_cache_map, &entry->cache_link);
+	list_append(&entry->lru_link, &dns_cache_lru);
+	++dns_cache_stat.entries;
+
+	return entry;
+}
+
+/** Copy the answer stored in a cache entry.
+ *
+ * @return The cached result or ENOMEM
+ */
+static errno_t dns_cache_entry_get(dns_cache_entry_t *entry,
+    dns_host_info_t *info)
+{
+	if (entry->rc != EOK)
+		return entry->rc;
+
+	info->cname = str_dup(entry->cname);
+	if (info->cname == NULL)
+		return ENOMEM;
+
+	info->addr = entry->addr;
+	info->ttl = entry->ttl;
+	return EOK;
+}
+
+/** Look up an answer in the resolver cache.
+ *
+ * If another fibril is already resolving the same query, wait for it to
+ * finish and return its answer. If the name is not cached (or the entry
+ * expired), the caller becomes responsible for resolving it and must report
+ * the result using dns_cache_update(), whatever it is. If the entry is about
+ * to expire, the caller should refresh it and report the result using
+ * dns_cache_refresh().
+ *
+ * @param name Queried name
+ * @param qtype Query type
+ * @param info Place to store the answer on a cache hit
+ * @param res Place to store the outcome of the lookup
+ *
+ * @return Cached result if @a res is @c dcr_hit or @c dcr_prefetch
+ */
+errno_t dns_cache_lookup(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info, dns_cache_res_t *res)
+{
+	struct timespec now;
+	errno_t rc;
+
+	getuptime(&now);
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	dns_cache_entry_t *entry = dns_cache_find(name, qtype);
+	if (entry == NULL) {
+		/* Without an entry the query simply cannot be coalesced */
+		(void) dns_cache_entry_create(name, qtype);
+		++dns_cache_stat.misses;
+		fibril_mutex_unlock(&dns_cache_lock);
+		*res = dcr_miss;
+		return EOK;
+	}
+
+	if (entry->pending) {
+		++dns_cache_stat.coalesced;
+		++entry->refcnt;
+
+		while (entry->pending)
+			fibril_condvar_wait(&dns_cache_cv, &dns_cache_lock);
+
+		rc = dns_cache_entry_get(entry, info);
+		dns_cache_entry_release(entry);
+		fibril_mutex_unlock(&dns_cache_lock);
+		*res = dcr_hit;
+		return rc;
+	}
+
+	if (entry->expires <= now.tv_sec) {
+		if (entry->rc != EOK)
+			--dns_cache_stat.negative;
+
+		entry->pending = true;
+		++dns_cache_stat.misses;
+		fibril_mutex_unlock(&dns_cache_lock);
+		*res = dcr_miss;
+		return EOK;
+	}
+
+	list_remove(&entry->lru_link);
+	list_append(&entry->lru_link, &dns_cache_lru);
+
+	/* Only hits close to the expiration count as a reason to refresh */
+	time_t left = entry->expires - now.tv_sec;
+	if (left <= entry->ttl / DNS_CACHE_PREFETCH_DIV)
+		++entry->hits;
+
+	*res = dcr_hit;
+	if (entry->rc == EOK) {
+		++dns_cache_stat.hits;
+
+		/* Refresh popular entries before they expire */
+		if (!entry->prefetching &&
+		    entry->hits >= DNS_CACHE_PREFETCH_HITS) {
+			entry->prefetching = true;
+			++dns_cache_stat.prefetches;
+			*res = dcr_prefetch;
+		}
+	} else {
+		++dns_cache_stat.neg_hits;
+	}
+
+	rc = dns_cache_entry_get(entry, info);
+	fibril_mutex_unlock(&dns_cache_lock);
+	return rc;
+}
+
+static void dns_cache_store(const char *name, dns_qtype_t qtype, errno_t rc,
+    dns_host_info_t *info, bool refresh)
+{
+	struct timespec now;
+	uint32_t ttl;
+
+	getuptime(&now);
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	dns_cache_entry_t *entry = dns_cache_find(name, qtype);
+	if (entry != NULL)
+		entry->prefetching = false;
+
+	if (rc != EOK && rc != ENOENT) {
+		/* A failed query never replaces a valid answer */
+		if (entry == NULL || refresh ||
+		    (!entry->pending && entry->expires > now.tv_sec)) {
+			fibril_mutex_unlock(&dns_cache_lock);
+			return;
+		}
+	}
+
+	if (entry == NULL) {
+		entry = dns_cache_entry_create(name, qtype);
+		if (entry == NULL) {
+			fibril_mutex_unlock(&dns_cache_lock);
+			return;
+		}
+	}
+
+	if (entry->rc != EOK && !entry->pending)
+		--dns_cache_stat.negative;
+
+	free(entry->cname);
+	entry->cname = NULL;
+
+	if (rc == EOK) {
+		entry->cname = str_dup(info->cname);
+		if (entry->cname == NULL)
+			rc = ENOMEM;
+	}
+
+	switch (rc) {
+	case EOK:
+		entry->addr = info->addr;
+		ttl = min(info->ttl, DNS_CACHE_TTL_MAX);
+		break;
+	case ENOENT:
+		ttl = DNS_CACHE_NEG_TTL;
+		++dns_cache_stat.negative;
+		break;
+	default:
+		/* Report the error to the waiters, but do not cache it */
+		ttl = 0;
+		++dns_cache_stat.negative;
+		break;
+	}
+
+	entry->rc = rc;
+	entry->ttl = ttl;
+	entry->expires = now.tv_sec + ttl;
+	entry->hits = 0;
+	entry->pending = false;
+
+	fibril_condvar_broadcast(&dns_cache_cv);
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** Store the result of a query in the resolver cache.
+ *
+ * Must be called after dns_cache_lookup() returned @c dcr_miss. Positive
+ * answers are kept for their time to live, answers saying that the name
+ * does not resolve (ENOENT) for DNS_CACHE_NEG_TTL seconds. Other errors
+ * are only passed to the fibrils waiting for the query.
+ *
+ * @param name Queried name
+ * @param qtype Query type
+ * @param rc Result of the query
+ * @param info Answer if @a rc is EOK
+ */
+void dns_cache_update(const char *name, dns_qtype_t qtype, errno_t rc,
+    dns_host_info_t *info)
+{
+	dns_cache_store(name, qtype, rc, info, false);
+}
+
+/** Store the result of a background refresh in the resolver cache.
+ *
+ * Must be called after dns_cache_lookup() returned @c dcr_prefetch. Unlike
+ * dns_cache_update(), errors other than ENOENT leave the entry untouched.
+ *
+ * @param name Queried name
+ * @param qtype Query type
+ * @param rc Result of the query
+ * @param info Answer if @a rc is EOK
+ */
+void dns_cache_refresh(const char *name, dns_qtype_t qtype, errno_t rc,
+    dns_host_info_t *info)
+{
+	dns_cache_store(name, qtype, rc, info, true);
+}
+
+static bool dns_cache_flush_entry(ht_link_t *item, void *arg)
+{
+	dns_cache_entry_t *entry =
+	    hash_table_get_inst(item, dns_cache_entry_t, cache_link);
+
+	if (!entry->pending)
+		hash_table_remove_item(&dns_cache_map, item);
+
+	return true;
+}
+
+/** Discard all cached answers. */
+void dns_cache_flush(void)
+{
+	fibril_mutex_lock(&dns_cache_lock);
+	hash_table_apply(&dns_cache_map, dns_cache_flush_entry, NULL);
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** Get resolver cache statistics. */
+void dns_cache_get_stat(dnsr_cache_stat_t *stat)
+{
+	fibril_mutex_lock(&dns_cache_lock);
+	*stat = dns_cache_stat;
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** @}
+ */
@@ -36,11 +36,14 @@
 #ifndef DNS_TYPE_H
 #define DNS_TYPE_H
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
+#include <errno.h>
 #include <inet/inet.h>
 #include <inet/addr.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 #include "dns_std.h"
 
 /** Encoded DNS PDU */
@@ -116,8 +119,53 @@ typedef struct {
 	char *cname;
 	/** Host address */
 	inet_addr_t addr;
+	/** Number of seconds the answer may be cached */
+	uint32_t ttl;
 } dns_host_info_t;
 
+/** Resolver cache entry */
+typedef struct {
+	/** Link to dns_cache_map */
+	ht_link_t cache_link;
+	/** Link to dns_cache_lru */
+	link_t lru_link;
+	/** Number of references (the cache holds one while linked) */
+	unsigned refcnt;
+
+	/** Queried name */
+	char *name;
+	/** Query type */
+	dns_qtype_t qtype;
+
+	/** A query for this entry is in progress, wait for it */
+	bool pending;
+	/** A refresh of this entry has been started in the background */
+	bool prefetching;
+
+	/** Cached result (EOK for a positive answer) */
+	errno_t rc;
+	/** Canonical name (positive answer only) */
+	char *cname;
+	/** Host address (positive answer only) */
+	inet_addr_t addr;
+	/** Time to live the entry was stored with */
+	uint32_t ttl;
+	/** Uptime in seconds at which the entry expires */
+	time_t expires;
+	/** Number of hits in the last tenth of the lifetime of the answer */
+	unsigned hits;
+} dns_cache_entry_t;
+
+/** Outcome of a resolver cache lookup */
+typedef enum {
+	/** The answer was found in the cache */
+	dcr_hit,
+	/** The answer was found, but the caller should refresh it */
+	dcr_prefetch,
+	/** The caller must resolve the name and call dns_cache_update() */
+	dcr_miss
+} dns_cache_res_t;
+
 typedef struct {
 } dnsr_client_t;
 
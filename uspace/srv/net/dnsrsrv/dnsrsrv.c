@@ -45,6 +45,7 @@
 #include <str.h>
 #include <task.h>
 
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "query.h"
@@ -59,6 +60,12 @@ static errno_t dnsr_init(void)
 	errno_t rc;
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_init()");
 
+	rc = dns_cache_init();
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed initializing cache.");
+		return ENOMEM;
+	}
+
 	rc = transport_init();
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed initializing transport.");
@@ -203,9 +210,48 @@ static void dnsr_set_srvaddr_srv(dnsr_client_t *client, ipc_call_t *icall)
 		return;
 	}
 
+	/* Answers from the previous server are no longer relevant */
+	dns_cache_flush();
+
+	async_answer_0(icall, rc);
+}
+
+static void dnsr_get_cache_stat_srv(dnsr_client_t *client, ipc_call_t *icall)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_get_cache_stat_srv()");
+
+	ipc_call_t call;
+	size_t size;
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size != sizeof(dnsr_cache_stat_t)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	dnsr_cache_stat_t stat;
+	dns_cache_get_stat(&stat);
+
+	errno_t rc = async_data_read_finalize(&call, &stat, size);
+	if (rc != EOK)
+		async_answer_0(&call, rc);
+
 	async_answer_0(icall, rc);
 }
 
+static void dnsr_flush_cache_srv(dnsr_client_t *client, ipc_call_t *icall)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_flush_cache_srv()");
+
+	dns_cache_flush();
+	async_answer_0(icall, EOK);
+}
+
 static void dnsr_client_conn(ipc_call_t *icall, void *arg)
 {
 	dnsr_client_t client;
@@ -236,6 +282,12 @@ static void dnsr_client_conn(ipc_call_t *icall, void *arg)
 		case DNSR_SET_SRVADDR:
 			dnsr_set_srvaddr_srv(&client, &call);
 			break;
+		case DNSR_GET_CACHE_STAT:
+			dnsr_get_cache_stat_srv(&client, &call);
+			break;
+		case DNSR_FLUSH_CACHE:
+			dnsr_flush_cache_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -34,10 +34,13 @@
  */
 
 #include <errno.h>
+#include <fibril.h>
 #include <io/log.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 #include <str.h>
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "dns_type.h"
@@ -46,6 +49,12 @@
 
 static uint16_t msg_id;
 
+/** Background refresh of a cache entry */
+typedef struct {
+	char *name;
+	dns_qtype_t qtype;
+} dns_prefetch_t;
+
 static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
     dns_host_info_t *info)
 {
@@ -89,6 +98,9 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 	list_append(&question->msg, &msg->question);
 
+	/* The answer can only be cached as long as every record it uses */
+	uint32_t ttl = UINT32_MAX;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "dns_name_query: send DNS request");
 	dns_message_t *amsg;
 	errno_t rc = dns_request(msg, &amsg);
@@ -129,6 +141,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			/* Continue looking for the more canonical name */
 			free(sname);
 			sname = cname;
+			ttl = min(ttl, rr->ttl);
 		}
 
 		if ((qtype == DTYPE_A) && (rr->rtype == DTYPE_A) &&
@@ -146,6 +159,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 			inet_addr_set(dns_uint32_t_decode(rr->rdata, rr->rdata_size),
 			    &info->addr);
+			info->ttl = min(ttl, rr->ttl);
 
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
@@ -171,6 +185,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			dns_addr128_t_decode(rr->rdata, rr->rdata_size, addr);
 
 			inet_addr_set6(addr, &info->addr);
+			info->ttl = min(ttl, rr->ttl);
 
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
@@ -186,7 +201,80 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 	dns_message_destroy(amsg);
 	free(sname);
 
-	return EIO;
+	return ENOENT;
+}
+
+static errno_t dns_prefetch_fibril(void *arg)
+{
+	dns_prefetch_t *prefetch = (dns_prefetch_t *) arg;
+	dns_host_info_t info;
+
+	memset(&info, 0, sizeof(info));
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Refreshing '%s'", prefetch->name);
+
+	errno_t rc = dns_name_query(prefetch->name, prefetch->qtype, &info);
+	dns_cache_refresh(prefetch->name, prefetch->qtype, rc, &info);
+
+	free(info.cname);
+	free(prefetch->name);
+	free(prefetch);
+	return EOK;
+}
+
+/** Start refreshing a cache entry in the background.
+ *
+ * If this fails, the entry is simply queried again once it expires.
+ */
+static void dns_prefetch_start(const char *name, dns_qtype_t qtype)
+{
+	dns_prefetch_t *prefetch = calloc(1, sizeof(dns_prefetch_t));
+	if (prefetch == NULL)
+		goto error;
+
+	prefetch->name = str_dup(name);
+	prefetch->qtype = qtype;
+	if (prefetch->name == NULL)
+		goto error;
+
+	fid_t fid = fibril_create(dns_prefetch_fibril, prefetch);
+	if (fid == 0)
+		goto error;
+
+	fibril_add_ready(fid);
+	return;
+error:
+	if (prefetch != NULL)
+		free(prefetch->name);
+	free(prefetch);
+	/* Clear the prefetching flag without touching the cached answer */
+	dns_cache_refresh(name, qtype, ENOMEM, NULL);
+}
+
+/** Resolve a query, consulting the resolver cache first.
+ *
+ * @return EOK on success, ENOENT if the name does not resolve or
+ *         another error code
+ */
+static errno_t dns_name_query_cached(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info)
+{
+	dns_cache_res_t res;
+
+	errno_t rc = dns_cache_lookup(name, qtype, info, &res);
+	switch (res) {
+	case dcr_hit:
+		return rc;
+	case dcr_prefetch:
+		dns_prefetch_start(name, qtype);
+		return rc;
+	case dcr_miss:
+		break;
+	}
+
+	rc = dns_name_query(name, qtype, info);
+	dns_cache_update(name, qtype, rc, info);
+	return rc;
 }
 
 errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
@@ -199,22 +287,26 @@ errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
 
 	switch (ver) {
 	case ip_any:
-		rc = dns_name_query(name, DTYPE_AAAA, info);
+		rc = dns_name_query_cached(name, DTYPE_AAAA, info);
 
 		if (rc != EOK)
-			rc = dns_name_query(name, DTYPE_A, info);
+			rc = dns_name_query_cached(name, DTYPE_A, info);
 
 		break;
 	case ip_v4:
-		rc = dns_name_query(name, DTYPE_A, info);
+		rc = dns_name_query_cached(name, DTYPE_A, info);
 		break;
 	case ip_v6:
-		rc = dns_name_query(name, DTYPE_AAAA, info);
+		rc = dns_name_query_cached(name, DTYPE_AAAA, info);
 		break;
 	default:
 		rc = EINVAL;
 	}
 
+	/* Clients expect EIO if the name does not resolve */
+	if (rc == ENOENT)
+		rc = EIO;
+
 	if (rc == EOK)
 		*rinfo = info;
 	else
@@ -102,10 +102,17 @@ errno_t arp_translate(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
 		return EOK;
 	}
 
-	errno_t rc = atrans_lookup(ip_addr, mac_addr);
-	if (rc == EOK)
+	bool refresh;
+	errno_t rc = atrans_lookup(ip_addr, mac_addr, &refresh);
+	if (rc == EOK && !refresh)
 		return EOK;
 
+	if (rc == EAGAIN) {
+		/* Another fibril has already sent a request */
+		return atrans_lookup_timeout(ip_addr, ARP_REQUEST_TIMEOUT,
+		    mac_addr);
+	}
+
 	arp_eth_packet_t packet;
 
 	packet.opcode = aop_request;
@@ -114,9 +121,14 @@ errno_t arp_translate(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
 	addr48(addr48_broadcast, packet.target_hw_addr);
 	packet.target_proto_addr = ip_addr;
 
-	rc = arp_send_packet(nic, &packet);
-	if (rc != EOK)
-		return rc;
+	errno_t rc1 = arp_send_packet(nic, &packet);
+
+	/* A stale entry remains usable while we wait for confirmation */
+	if (rc == EOK)
+		return EOK;
+
+	if (rc1 != EOK)
+		return rc1;
 
 	return atrans_lookup_timeout(ip_addr, ARP_REQUEST_TIMEOUT, mac_addr);
 }
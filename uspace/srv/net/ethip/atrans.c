@@ -34,7 +34,8 @@
  * @brief
  */
 
-#include <adt/list.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/iplink_srv.h>
@@ -43,41 +44,160 @@
 #include "atrans.h"
 #include "ethip.h"
 
-/** Address translation list (of ethip_atrans_t) */
+/** Time in seconds after which a reachable entry becomes stale */
+#define ATRANS_REACHABLE_TIME	30
+/** Time in seconds after which a stale entry is discarded */
+#define ATRANS_STALE_TIME	(20 * 60)
+/** Time in seconds after which an unanswered request may be repeated */
+#define ATRANS_INCOMPLETE_TIME	3
+/** Time in seconds after which an incomplete entry nobody waits for is discarded */
+#define ATRANS_INCOMPLETE_EXPIRE	(10 * ATRANS_INCOMPLETE_TIME)
+/** Time in seconds between sweeps of expired entries */
+#define ATRANS_PURGE_INTERVAL	30
+
+/** Address translation table (of ethip_atrans_t) */
 static FIBRIL_MUTEX_INITIALIZE(atrans_list_lock);
-static LIST_INITIALIZE(atrans_list);
+static hash_table_t atrans_table;
+static bool atrans_table_initialized = false;
 static FIBRIL_CONDVAR_INITIALIZE(atrans_cv);
+/** Time of the last sweep of expired entries */
+static struct timespec atrans_last_purge;
 
-static ethip_atrans_t *atrans_find(addr32_t ip_addr)
+static size_t atrans_key_hash(void *key)
+{
+	return hash_mix32(*(addr32_t *) key);
+}
+
+static size_t atrans_hash(const ht_link_t *item)
+{
+	ethip_atrans_t *atrans =
+	    hash_table_get_inst(item, ethip_atrans_t, atrans_link);
+	return atrans_key_hash(&atrans->ip_addr);
+}
+
+static bool atrans_key_equal(void *key, const ht_link_t *item)
+{
+	ethip_atrans_t *atrans =
+	    hash_table_get_inst(item, ethip_atrans_t, atrans_link);
+	return atrans->ip_addr == *(addr32_t *) key;
+}
+
+static void atrans_remove_callback(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, ethip_atrans_t, atrans_link));
+}
+
+static hash_table_ops_t atrans_table_ops = {
+	.hash = atrans_hash,
+	.key_hash = atrans_key_hash,
+	.key_equal = atrans_key_equal,
+	.equal = NULL,
+	.remove_callback = atrans_remove_callback
+};
+
+/** Make sure the translation table exists.
+ *
+ * Must be called with atrans_list_lock held.
+ */
+static errno_t atrans_table_init(void)
+{
+	if (atrans_table_initialized)
+		return EOK;
+
+	if (!hash_table_create(&atrans_table, 0, 0, &atrans_table_ops))
+		return ENOMEM;
+
+	getuptime(&atrans_last_purge);
+	atrans_table_initialized = true;
+	return EOK;
+}
+
+/** Number of seconds since the entry last changed state */
+static time_t atrans_age(ethip_atrans_t *atrans, struct timespec *now)
 {
-	list_foreach(atrans_list, atrans_list, ethip_atrans_t, atrans) {
-		if (atrans->ip_addr == ip_addr)
-			return atrans;
+	return now->tv_sec - atrans->updated.tv_sec;
+}
+
+static bool atrans_purge_expired(ht_link_t *item, void *arg)
+{
+	ethip_atrans_t *atrans =
+	    hash_table_get_inst(item, ethip_atrans_t, atrans_link);
+	struct timespec *now = (struct timespec *) arg;
+
+	switch (atrans->state) {
+	case ats_incomplete:
+		/* Every new request makes the entry young again */
+		if (atrans_age(atrans, now) >= ATRANS_INCOMPLETE_EXPIRE)
+			hash_table_remove_item(&atrans_table, item);
+		break;
+	case ats_stale:
+		if (atrans_age(atrans, now) >= ATRANS_STALE_TIME)
+			hash_table_remove_item(&atrans_table, item);
+		break;
+	case ats_reachable:
+		/* Entries nobody looks up only turn stale in lookup */
+		if (atrans_age(atrans, now) >= ATRANS_REACHABLE_TIME + ATRANS_STALE_TIME)
+			hash_table_remove_item(&atrans_table, item);
+		break;
 	}
 
-	return NULL;
+	return true;
+}
+
+/** Discard expired entries once in a while.
+ *
+ * Must be called with atrans_list_lock held.
+ */
+static void atrans_purge(struct timespec *now)
+{
+	if (now->tv_sec - atrans_last_purge.tv_sec < ATRANS_PURGE_INTERVAL)
+		return;
+
+	hash_table_apply(&atrans_table, atrans_purge_expired, now);
+	atrans_last_purge = *now;
+}
+
+static ethip_atrans_t *atrans_find(addr32_t ip_addr)
+{
+	ht_link_t *link = hash_table_find(&atrans_table, &ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, ethip_atrans_t, atrans_link);
 }
 
 errno_t atrans_add(addr32_t ip_addr, addr48_t mac_addr)
 {
 	ethip_atrans_t *atrans;
-	ethip_atrans_t *prev;
+	struct timespec now;
 
-	atrans = calloc(1, sizeof(ethip_atrans_t));
-	if (atrans == NULL)
-		return ENOMEM;
-
-	atrans->ip_addr = ip_addr;
-	addr48(mac_addr, atrans->mac_addr);
+	getuptime(&now);
 
 	fibril_mutex_lock(&atrans_list_lock);
-	prev = atrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->atrans_list);
-		free(prev);
+	errno_t rc = atrans_table_init();
+	if (rc != EOK) {
+		fibril_mutex_unlock(&atrans_list_lock);
+		return rc;
 	}
 
-	list_append(&atrans->atrans_list, &atrans_list);
+	atrans_purge(&now);
+
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL) {
+		atrans = calloc(1, sizeof(ethip_atrans_t));
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_list_lock);
+			return ENOMEM;
+		}
+
+		atrans->ip_addr = ip_addr;
+		hash_table_insert(&atrans_table, &atrans->atrans_link);
+	}
+
+	addr48(mac_addr, atrans->mac_addr);
+	atrans->state = ats_reachable;
+	atrans->updated = now;
+
 	fibril_mutex_unlock(&atrans_list_lock);
 	fibril_condvar_broadcast(&atrans_cv);
 
@@ -86,38 +206,105 @@ errno_t atrans_add(addr32_t ip_addr, addr48_t mac_addr)
 
 errno_t atrans_remove(addr32_t ip_addr)
 {
-	ethip_atrans_t *atrans;
-
 	fibril_mutex_lock(&atrans_list_lock);
-	atrans = atrans_find(ip_addr);
-	if (atrans == NULL) {
+	if (!atrans_table_initialized ||
+	    hash_table_remove(&atrans_table, &ip_addr) == 0) {
 		fibril_mutex_unlock(&atrans_list_lock);
 		return ENOENT;
 	}
 
-	list_remove(&atrans->atrans_list);
 	fibril_mutex_unlock(&atrans_list_lock);
-	free(atrans);
-
 	return EOK;
 }
 
-static errno_t atrans_lookup_locked(addr32_t ip_addr, addr48_t mac_addr)
+/** Look up address translation.
+ *
+ * Must be called with atrans_list_lock held.
+ *
+ * @param ip_addr   IPv4 address
+ * @param mac_addr  Place to store the MAC address
+ * @param refresh   Place to store true if the entry should be confirmed
+ *                  by sending a new request, or NULL
+ *
+ * @return EOK if the MAC address is known, EAGAIN if a request for it is
+ *         pending or ENOENT if the caller should send a request. In the
+ *         latter case an incomplete entry is created, so that other callers
+ *         wait for the reply instead of sending their own requests.
+ */
+static errno_t atrans_lookup_locked(addr32_t ip_addr, addr48_t mac_addr,
+    bool *refresh)
 {
+	struct timespec now;
+
+	getuptime(&now);
+
+	if (refresh != NULL)
+		*refresh = false;
+
+	errno_t rc = atrans_table_init();
+	if (rc != EOK)
+		return rc;
+
+	atrans_purge(&now);
+
 	ethip_atrans_t *atrans = atrans_find(ip_addr);
-	if (atrans == NULL)
+	if (atrans == NULL) {
+		atrans = calloc(1, sizeof(ethip_atrans_t));
+		if (atrans == NULL)
+			return ENOMEM;
+
+		atrans->ip_addr = ip_addr;
+		atrans->state = ats_incomplete;
+		atrans->updated = now;
+		hash_table_insert(&atrans_table, &atrans->atrans_link);
 		return ENOENT;
+	}
+
+	switch (atrans->state) {
+	case ats_incomplete:
+		if (atrans_age(atrans, &now) < ATRANS_INCOMPLETE_TIME)
+			return EAGAIN;
+
+		/* The request went unanswered, try again */
+		atrans->updated = now;
+		return ENOENT;
+	case ats_reachable:
+		if (atrans_age(atrans, &now) >= ATRANS_REACHABLE_TIME) {
+			atrans->state = ats_stale;
+			atrans->updated = now;
+			if (refresh != NULL)
+				*refresh = true;
+		}
+		break;
+	case ats_stale:
+		if (atrans_age(atrans, &now) >= ATRANS_STALE_TIME) {
+			atrans->state = ats_incomplete;
+			atrans->updated = now;
+			return ENOENT;
+		}
+		break;
+	}
 
 	addr48(atrans->mac_addr, mac_addr);
 	return EOK;
 }
 
-errno_t atrans_lookup(addr32_t ip_addr, addr48_t mac_addr)
+/** Look up address translation.
+ *
+ * @param ip_addr   IPv4 address
+ * @param mac_addr  Place to store the MAC address
+ * @param refresh   Place to store true if the entry has just become stale
+ *                  and the caller should confirm it by sending a request
+ *
+ * @return EOK if the MAC address is known, EAGAIN if a request for it is
+ *         pending or ENOENT if the caller should send a request.
+ */
+errno_t atrans_lookup(addr32_t ip_addr, addr48_t mac_addr, bool *refresh)
 {
 	errno_t rc;
 
 	fibril_mutex_lock(&atrans_list_lock);
-	rc = atrans_lookup_locked(ip_addr, mac_addr);
+	rc = atrans_lookup_locked(ip_addr, mac_addr, refresh);
 	fibril_mutex_unlock(&atrans_list_lock);
 
 	return rc;
@@ -149,7 +336,7 @@ errno_t atrans_lookup_timeout(addr32_t ip_addr, usec_t timeout,
 
 	fibril_mutex_lock(&atrans_list_lock);
 
-	while ((rc = atrans_lookup_locked(ip_addr, mac_addr)) == ENOENT &&
+	while ((rc = atrans_lookup_locked(ip_addr, mac_addr, NULL)) == EAGAIN &&
 	    !timedout) {
 		fibril_condvar_wait(&atrans_cv, &atrans_list_lock);
 	}
@@ -158,6 +345,9 @@ errno_t atrans_lookup_timeout(addr32_t ip_addr, usec_t timeout,
 	(void) fibril_timer_clear(t);
 	fibril_timer_destroy(t);
 
+	if (rc == EAGAIN)
+		rc = ENOENT;
+
 	return rc;
 }
 
@@ -39,11 +39,12 @@
 
 #include <inet/iplink_srv.h>
 #include <inet/addr.h>
+#include <stdbool.h>
 #include "ethip.h"
 
 extern errno_t atrans_add(addr32_t, addr48_t);
 extern errno_t atrans_remove(addr32_t);
-extern errno_t atrans_lookup(addr32_t, addr48_t);
+extern errno_t atrans_lookup(addr32_t, addr48_t, bool *);
 extern errno_t atrans_lookup_timeout(addr32_t, usec_t, addr48_t);
 
 #endif
@@ -36,9 +36,11 @@
  * Based on the IETF RFC 894 standard.
  */
 
+#include <assert.h>
 #include <async.h>
 #include <errno.h>
 #include <inet/iplink_srv.h>
+#include <ipc/iplink.h>
 #include <io/log.h>
 #include <loc.h>
 #include <stdio.h>
@@ -268,6 +270,80 @@ errno_t ethip_received(iplink_srv_t *srv, void *data, size_t size)
 	return rc;
 }
 
+/** Process several received Ethernet frames
+ *
+ * IP frames among them are delivered to the IP link client in one batch.
+ *
+ * @param srv    IP link server
+ * @param data   Frames stored back to back
+ * @param sizes  Sizes of the individual frames
+ * @param count  Number of frames, at most IPLINK_EV_RECV_BATCH_MAX
+ *
+ * @return EOK on success or an error code
+ */
+errno_t ethip_received_batch(iplink_srv_t *srv, void *data, size_t *sizes,
+    size_t count)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_received_batch(): srv=%p, "
+	    "count=%zu", srv, count);
+	ethip_nic_t *nic = (ethip_nic_t *) srv->arg;
+
+	eth_frame_t frame[IPLINK_EV_RECV_BATCH_MAX];
+	iplink_recv_sdu_t sdu[IPLINK_EV_RECV_BATCH_MAX];
+	ip_ver_t ver[IPLINK_EV_RECV_BATCH_MAX];
+	size_t nframes = 0;
+	size_t nsdus = 0;
+	uint8_t *pdu = data;
+	errno_t rc = EOK;
+
+	assert(count <= IPLINK_EV_RECV_BATCH_MAX);
+
+	for (size_t i = 0; i < count; i++) {
+		eth_frame_t *fr = &frame[nframes];
+		errno_t rc1 = eth_pdu_decode(pdu, sizes[i], fr);
+		pdu += sizes[i];
+		if (rc1 != EOK) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, " - eth_pdu_decode failed");
+			rc = rc1;
+			continue;
+		}
+
+		nframes++;
+
+		switch (fr->etype_len) {
+		case ETYPE_ARP:
+			arp_received(nic, fr);
+			break;
+		case ETYPE_IP:
+			sdu[nsdus].data = fr->data;
+			sdu[nsdus].size = fr->size;
+			ver[nsdus++] = ip_v4;
+			break;
+		case ETYPE_IPV6:
+			sdu[nsdus].data = fr->data;
+			sdu[nsdus].size = fr->size;
+			ver[nsdus++] = ip_v6;
+			break;
+		default:
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "Unknown ethertype 0x%" PRIx16,
+			    fr->etype_len);
+		}
+	}
+
+	if (nsdus > 0) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, " - call iplink_ev_recv_batch");
+		errno_t rc1 = iplink_ev_recv_batch(&nic->iplink, sdu, ver,
+		    nsdus);
+		if (rc1 != EOK)
+			rc = rc1;
+	}
+
+	for (size_t i = 0; i < nframes; i++)
+		free(frame[i].data);
+
+	return rc;
+}
+
 static errno_t ethip_get_mtu(iplink_srv_t *srv, size_t *mtu)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_get_mtu()");
@@ -37,6 +37,7 @@
 #ifndef ETHIP_H_
 #define ETHIP_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <async.h>
 #include <inet/iplink_srv.h>
@@ -44,6 +45,7 @@
 #include <loc.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 
 typedef struct {
 	link_t link;
@@ -108,15 +110,30 @@ typedef struct {
 	addr32_t target_proto_addr;
 } arp_eth_packet_t;
 
+/** Address translation entry state */
+typedef enum {
+	/** Request has been sent, MAC address is not known yet */
+	ats_incomplete,
+	/** MAC address has been confirmed recently */
+	ats_reachable,
+	/** MAC address may be out of date and should be confirmed again */
+	ats_stale
+} ethip_atrans_state_t;
+
 /** Address translation table element */
 typedef struct {
-	link_t atrans_list;
+	/** Link to atrans_table */
+	ht_link_t atrans_link;
 	addr32_t ip_addr;
 	addr48_t mac_addr;
+	ethip_atrans_state_t state;
+	/** Time of the last state change */
+	struct timespec updated;
 } ethip_atrans_t;
 
 extern errno_t ethip_iplink_init(ethip_nic_t *);
 extern errno_t ethip_received(iplink_srv_t *, void *, size_t);
+extern errno_t ethip_received_batch(iplink_srv_t *, void *, size_t *, size_t);
 
 #endif
 
@@ -282,6 +282,59 @@ static void ethip_nic_received(ethip_nic_t *nic, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void ethip_nic_received_batch(ethip_nic_t *nic, ipc_call_t *call)
+{
+	errno_t rc;
+	size_t *sizes;
+	void *data;
+	size_t size;
+
+	size_t count = IPC_GET_ARG1(*call);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_received_batch() nic=%p, "
+	    "count=%zu", nic, count);
+
+	if (count < 1 || count > NIC_EV_RECEIVED_BATCH_MAX) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	rc = async_data_write_accept((void **) &sizes, false,
+	    count * sizeof(size_t), count * sizeof(size_t), 0, &size);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "data_write_accept() failed");
+		async_answer_0(call, rc);
+		return;
+	}
+
+	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "data_write_accept() failed");
+		free(sizes);
+		async_answer_0(call, rc);
+		return;
+	}
+
+	size_t total = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (sizes[i] > size - total) {
+			rc = EINVAL;
+			break;
+		}
+		total += sizes[i];
+	}
+
+	if (rc == EOK)
+		rc = ethip_received_batch(&nic->iplink, data, sizes, count);
+
+	free(data);
+	free(sizes);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_received_batch() done, "
+	    "rc=%s", str_error_name(rc));
+	async_answer_0(call, rc);
+}
+
 static void ethip_nic_device_state(ethip_nic_t *nic, ipc_call_t *call)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_device_state()");
@@ -313,6 +366,9 @@ static void ethip_nic_cb_conn(ipc_call_t *icall, void *arg)
 		case NIC_EV_DEVICE_STATE:
 			ethip_nic_device_state(nic, &call);
 			break;
+		case NIC_EV_RECEIVED_BATCH:
+			ethip_nic_received_batch(nic, &call);
+			break;
 		default:
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "unknown IPC method: %" PRIun, IPC_GET_IMETHOD(call));
 			async_answer_0(&call, ENOTSUP);
@@ -34,6 +34,7 @@
  * @brief
  */
 
+#include <adt/hash_table.h>
 #include <bitops.h>
 #include <errno.h>
 #include <fibril_synch.h>
@@ -52,6 +53,40 @@ static FIBRIL_MUTEX_INITIALIZE(addr_list_lock);
 static LIST_INITIALIZE(addr_list);
 static sysarg_t addr_id = 0;
 
+/** Address objects hashed by their host address (of inet_addrobj_t) */
+static hash_table_t addr_table;
+static bool addr_table_initialized = false;
+
+static size_t inet_addrobj_key_hash(void *key)
+{
+	return inet_addr_hash((inet_addr_t *) key);
+}
+
+static size_t inet_addrobj_hash(const ht_link_t *item)
+{
+	inet_addrobj_t *aobj =
+	    hash_table_get_inst(item, inet_addrobj_t, addr_link);
+	inet_addr_t addr;
+
+	inet_naddr_addr(&aobj->naddr, &addr);
+	return inet_addrobj_key_hash(&addr);
+}
+
+static bool inet_addrobj_key_equal(void *key, const ht_link_t *item)
+{
+	inet_addrobj_t *aobj =
+	    hash_table_get_inst(item, inet_addrobj_t, addr_link);
+	return inet_naddr_compare(&aobj->naddr, (inet_addr_t *) key);
+}
+
+static hash_table_ops_t addr_table_ops = {
+	.hash = inet_addrobj_hash,
+	.key_hash = inet_addrobj_key_hash,
+	.key_equal = inet_addrobj_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
 inet_addrobj_t *inet_addrobj_new(void)
 {
 	inet_addrobj_t *addr = calloc(1, sizeof(inet_addrobj_t));
@@ -89,7 +124,17 @@ errno_t inet_addrobj_add(inet_addrobj_t *addr)
 		return EEXIST;
 	}
 
+	if (!addr_table_initialized) {
+		if (!hash_table_create(&addr_table, 0, 0, &addr_table_ops)) {
+			fibril_mutex_unlock(&addr_list_lock);
+			return ENOMEM;
+		}
+
+		addr_table_initialized = true;
+	}
+
 	list_append(&addr->addr_list, &addr_list);
+	hash_table_insert(&addr_table, &addr->addr_link);
 	fibril_mutex_unlock(&addr_list_lock);
 
 	return EOK;
@@ -99,6 +144,8 @@ void inet_addrobj_remove(inet_addrobj_t *addr)
 {
 	fibril_mutex_lock(&addr_list_lock);
 	list_remove(&addr->addr_list);
+	if (link_in_use(&addr->addr_link.link))
+		hash_table_remove_item(&addr_table, &addr->addr_link);
 	fibril_mutex_unlock(&addr_list_lock);
 }
 
@@ -113,6 +160,26 @@ inet_addrobj_t *inet_addrobj_find(inet_addr_t *addr, inet_addrobj_find_t find)
 {
 	fibril_mutex_lock(&addr_list_lock);
 
+	if (find == iaf_addr) {
+		ht_link_t *link = NULL;
+
+		if (addr_table_initialized)
+			link = hash_table_find(&addr_table, addr);
+		fibril_mutex_unlock(&addr_list_lock);
+
+		if (link == NULL) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG,
+			    "inet_addrobj_find: Not found");
+			return NULL;
+		}
+
+		inet_addrobj_t *naddr =
+		    hash_table_get_inst(link, inet_addrobj_t, addr_link);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
+		    naddr);
+		return naddr;
+	}
+
 	list_foreach(addr_list, addr_list, inet_addrobj_t, naddr) {
 		switch (find) {
 		case iaf_net:
@@ -55,11 +55,14 @@ static FIBRIL_MUTEX_INITIALIZE(ip_ident_lock);
 static uint16_t ip_ident = 0;
 
 static errno_t inet_iplink_recv(iplink_t *, iplink_recv_sdu_t *, ip_ver_t);
+static errno_t inet_iplink_recv_batch(iplink_t *, iplink_recv_sdu_t *,
+    ip_ver_t *, size_t);
 static errno_t inet_iplink_change_addr(iplink_t *, addr48_t);
 static inet_link_t *inet_link_get_by_id_locked(sysarg_t);
 
 static iplink_ev_ops_t inet_iplink_ev_ops = {
 	.recv = inet_iplink_recv,
+	.recv_batch = inet_iplink_recv_batch,
 	.change_addr = inet_iplink_change_addr,
 };
 
@@ -120,6 +123,29 @@ static errno_t inet_iplink_recv(iplink_t *iplink, iplink_recv_sdu_t *sdu, ip_ver
 	return rc;
 }
 
+/** Receive several SDUs.
+ *
+ * Datagrams for local clients are collected while the SDUs are processed
+ * and then delivered to each client in as few exchanges as possible.
+ */
+static errno_t inet_iplink_recv_batch(iplink_t *iplink,
+    iplink_recv_sdu_t *sdus, ip_ver_t *vers, size_t count)
+{
+	inet_batch_t batch;
+	errno_t rc = EOK;
+
+	inet_batch_begin(&batch);
+
+	for (size_t i = 0; i < count; i++) {
+		errno_t rc1 = inet_iplink_recv(iplink, &sdus[i], vers[i]);
+		if (rc1 != EOK)
+			rc = rc1;
+	}
+
+	inet_batch_end(&batch);
+	return rc;
+}
+
 static errno_t inet_iplink_change_addr(iplink_t *iplink, addr48_t mac)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_iplink_change_addr(): "
@@ -35,6 +35,7 @@
  */
 
 #include <adt/list.h>
+#include <assert.h>
 #include <async.h>
 #include <errno.h>
 #include <str_error.h>
@@ -43,6 +44,7 @@
 #include <ipc/inet.h>
 #include <ipc/services.h>
 #include <loc.h>
+#include <mem.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -78,6 +80,9 @@ static inet_addr_t multicast_all_nodes = {
 	.addr6 = { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 }
 };
 
+/** Batch being received by the current fibril, NULL if none */
+static fibril_local inet_batch_t *cur_batch;
+
 static FIBRIL_MUTEX_INITIALIZE(client_list_lock);
 static LIST_INITIALIZE(client_list);
 
@@ -481,6 +486,160 @@ errno_t inet_ev_recv(inet_client_t *client, inet_dgram_t *dgram)
 	return retval;
 }
 
+/** Deliver several datagrams to a client in a single exchange
+ *
+ * @param client Client
+ * @param dgrams Datagrams
+ * @param count  Number of datagrams, at most INET_EV_RECV_BATCH_MAX
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t inet_ev_recv_batch(inet_client_t *client,
+    inet_batch_dgram_t **dgrams, size_t count)
+{
+	inet_ev_recv_desc_t desc[INET_EV_RECV_BATCH_MAX];
+	size_t total = 0;
+
+	assert(count <= INET_EV_RECV_BATCH_MAX);
+
+	for (size_t i = 0; i < count; i++) {
+		desc[i].src = dgrams[i]->dgram.src;
+		desc[i].dest = dgrams[i]->dgram.dest;
+		desc[i].tos = dgrams[i]->dgram.tos;
+		desc[i].iplink = dgrams[i]->dgram.iplink;
+		desc[i].size = dgrams[i]->dgram.size;
+		total += dgrams[i]->dgram.size;
+	}
+
+	uint8_t *data = malloc(total);
+	if (data == NULL)
+		return ENOMEM;
+
+	uint8_t *dst = data;
+	for (size_t i = 0; i < count; i++) {
+		memcpy(dst, dgrams[i]->dgram.data, dgrams[i]->dgram.size);
+		dst += dgrams[i]->dgram.size;
+	}
+
+	async_exch_t *exch = async_exchange_begin(client->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, INET_EV_RECV_BATCH, count, &answer);
+
+	errno_t rc = async_data_write_start(exch, desc,
+	    count * sizeof(inet_ev_recv_desc_t));
+	if (rc == EOK)
+		rc = async_data_write_start(exch, data, total);
+	async_exchange_end(exch);
+	free(data);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	return retval;
+}
+
+/** Queue datagram in a batch.
+ *
+ * @param batch Batch
+ * @param dgram Datagram, its data are copied
+ * @param proto Protocol of the receiving client
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t inet_batch_queue(inet_batch_t *batch, inet_dgram_t *dgram,
+    uint8_t proto)
+{
+	inet_batch_dgram_t *bdgram;
+
+	bdgram = malloc(sizeof(inet_batch_dgram_t) + dgram->size);
+	if (bdgram == NULL)
+		return ENOMEM;
+
+	bdgram->proto = proto;
+	bdgram->dgram = *dgram;
+	bdgram->dgram.data = bdgram + 1;
+	memcpy(bdgram->dgram.data, dgram->data, dgram->size);
+
+	list_append(&bdgram->link, &batch->dgrams);
+	return EOK;
+}
+
+/** Start collecting locally delivered datagrams in a batch.
+ *
+ * Until inet_batch_end() is called, datagrams destined to clients that
+ * are received by the current fibril are queued in @a batch instead of
+ * being delivered one at a time.
+ *
+ * @param batch Batch
+ */
+void inet_batch_begin(inet_batch_t *batch)
+{
+	list_initialize(&batch->dgrams);
+	cur_batch = batch;
+}
+
+/** Deliver datagrams collected in a batch.
+ *
+ * Datagrams for each client are delivered in order, up to
+ * INET_EV_RECV_BATCH_MAX of them in a single exchange.
+ *
+ * @param batch Batch
+ */
+void inet_batch_end(inet_batch_t *batch)
+{
+	inet_batch_dgram_t *sel[INET_EV_RECV_BATCH_MAX];
+	inet_batch_dgram_t *bdgram;
+	inet_client_t *client;
+	uint8_t proto;
+	size_t count;
+	errno_t rc;
+
+	cur_batch = NULL;
+
+	while (!list_empty(&batch->dgrams)) {
+		bdgram = list_get_instance(list_first(&batch->dgrams),
+		    inet_batch_dgram_t, link);
+		proto = bdgram->proto;
+
+		count = 0;
+		list_foreach_safe(batch->dgrams, cur, next) {
+			bdgram = list_get_instance(cur, inet_batch_dgram_t,
+			    link);
+			if (bdgram->proto != proto)
+				continue;
+
+			list_remove(cur);
+			sel[count++] = bdgram;
+			if (count == INET_EV_RECV_BATCH_MAX)
+				break;
+		}
+
+		/* The client might have gone away in the meantime */
+		client = inet_client_find(proto);
+		if (client != NULL) {
+			if (count == 1)
+				rc = inet_ev_recv(client, &sel[0]->dgram);
+			else
+				rc = inet_ev_recv_batch(client, sel, count);
+
+			if (rc != EOK) {
+				log_msg(LOG_DEFAULT, LVL_DEBUG, "Failed "
+				    "delivering %zu datagrams: %s", count,
+				    str_error_name(rc));
+			}
+		}
+
+		for (size_t i = 0; i < count; i++)
+			free(sel[i]);
+	}
+}
+
 errno_t inet_recv_dgram_local(inet_dgram_t *dgram, uint8_t proto)
 {
 	inet_client_t *client;
@@ -501,6 +660,10 @@ errno_t inet_recv_dgram_local(inet_dgram_t *dgram, uint8_t proto)
 		return ENOENT;
 	}
 
+	if (cur_batch != NULL && inet_batch_queue(cur_batch, dgram,
+	    proto) == EOK)
+		return EOK;
+
 	return inet_ev_recv(client, dgram);
 }
 
@@ -37,6 +37,7 @@
 #ifndef INETSRV_H_
 #define INETSRV_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <stdbool.h>
 #include <inet/addr.h>
@@ -54,6 +55,22 @@ typedef struct {
 	link_t client_list;
 } inet_client_t;
 
+/** Datagram queued for delivery to a client */
+typedef struct {
+	/** Link to @c inet_batch_t.dgrams */
+	link_t link;
+	/** Protocol of the receiving client */
+	uint8_t proto;
+	/** Datagram, the data are stored right after this structure */
+	inet_dgram_t dgram;
+} inet_batch_dgram_t;
+
+/** Datagrams received in one link batch, delivered to clients together */
+typedef struct {
+	/** Queued datagrams (inet_batch_dgram_t) */
+	list_t dgrams;
+} inet_batch_t;
+
 /** Inetping Client */
 typedef struct {
 	/** Callback session */
@@ -114,6 +131,8 @@ typedef struct {
 
 typedef struct {
 	link_t addr_list;
+	/** Link to table of addresses hashed by host address */
+	ht_link_t addr_link;
 	sysarg_t id;
 	inet_naddr_t naddr;
 	inet_link_t *ilink;
@@ -123,6 +142,8 @@ typedef struct {
 /** Static route configuration */
 typedef struct {
 	link_t sroute_list;
+	/** Link to the list of routes in a routing trie node */
+	link_t fib_list;
 	sysarg_t id;
 	/** Destination network */
 	inet_naddr_t dest;
@@ -155,6 +176,8 @@ extern errno_t inet_recv_packet(inet_packet_t *);
 extern errno_t inet_route_packet(inet_dgram_t *, uint8_t, uint8_t, int);
 extern errno_t inet_get_srcaddr(inet_addr_t *, uint8_t, inet_addr_t *);
 extern errno_t inet_recv_dgram_local(inet_dgram_t *, uint8_t);
+extern void inet_batch_begin(inet_batch_t *);
+extern void inet_batch_end(inet_batch_t *);
 
 #endif
 
@@ -159,10 +159,17 @@ errno_t ndp_translate(addr128_t src_addr, addr128_t ip_addr, addr48_t mac_addr,
 		return EOK;
 	}
 
-	errno_t rc = ntrans_lookup(ip_addr, mac_addr);
-	if (rc == EOK)
+	bool refresh;
+	errno_t rc = ntrans_lookup(ip_addr, mac_addr, &refresh);
+	if (rc == EOK && !refresh)
 		return EOK;
 
+	if (rc == EAGAIN) {
+		/* Another fibril has already sent a solicitation */
+		return ntrans_lookup_timeout(ip_addr, NDP_REQUEST_TIMEOUT,
+		    mac_addr);
+	}
+
 	ndp_packet_t packet;
 
 	packet.opcode = ICMPV6_NEIGHBOUR_SOLICITATION;
@@ -172,11 +179,14 @@ errno_t ndp_translate(addr128_t src_addr, addr128_t ip_addr, addr48_t mac_addr,
 	addr48_solicited_node(ip_addr, packet.target_hw_addr);
 	ndp_solicited_node_ip(ip_addr, packet.target_proto_addr);
 
-	rc = ndp_send_packet(ilink, &packet);
-	if (rc != EOK)
-		return rc;
+	errno_t rc1 = ndp_send_packet(ilink, &packet);
+
+	/* A stale entry remains usable while we wait for confirmation */
+	if (rc == EOK)
+		return EOK;
 
-	(void) ntrans_wait_timeout(NDP_REQUEST_TIMEOUT);
+	if (rc1 != EOK)
+		return rc1;
 
-	return ntrans_lookup(ip_addr, mac_addr);
+	return ntrans_lookup_timeout(ip_addr, NDP_REQUEST_TIMEOUT, mac_addr);
 }
@@ -34,17 +34,143 @@
  * @brief
  */
 
-#include <adt/list.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/iplink_srv.h>
+#include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 #include "ntrans.h"
 
-/** Address translation list (of inet_ntrans_t) */
+/** Time in seconds after which a reachable entry becomes stale */
+#define NTRANS_REACHABLE_TIME	30
+/** Time in seconds after which a stale entry is discarded */
+#define NTRANS_STALE_TIME	(20 * 60)
+/** Time in seconds after which an unanswered solicitation may be repeated */
+#define NTRANS_INCOMPLETE_TIME	3
+/** Time in seconds after which an incomplete entry nobody waits for is discarded */
+#define NTRANS_INCOMPLETE_EXPIRE	(10 * NTRANS_INCOMPLETE_TIME)
+/** Time in seconds between sweeps of expired entries */
+#define NTRANS_PURGE_INTERVAL	30
+
+/** Address translation table (of inet_ntrans_t) */
 static FIBRIL_MUTEX_INITIALIZE(ntrans_list_lock);
-static LIST_INITIALIZE(ntrans_list);
+static hash_table_t ntrans_table;
+static bool ntrans_table_initialized = false;
 static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
+/** Time of the last sweep of expired entries */
+static struct timespec ntrans_last_purge;
+
+static size_t ntrans_key_hash(void *key)
+{
+	uint8_t *addr = (uint8_t *) key;
+	size_t hash = 0;
+
+	for (size_t i = 0; i < sizeof(addr128_t); i += sizeof(uint32_t)) {
+		hash = hash_combine(hash, (addr[i] << 24) |
+		    (addr[i + 1] << 16) | (addr[i + 2] << 8) | addr[i + 3]);
+	}
+
+	return hash_mix(hash);
+}
+
+static size_t ntrans_hash(const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans =
+	    hash_table_get_inst(item, inet_ntrans_t, ntrans_link);
+	return ntrans_key_hash(ntrans->ip_addr);
+}
+
+static bool ntrans_key_equal(void *key, const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans =
+	    hash_table_get_inst(item, inet_ntrans_t, ntrans_link);
+	return addr128_compare(ntrans->ip_addr, (uint8_t *) key);
+}
+
+static void ntrans_remove_callback(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, inet_ntrans_t, ntrans_link));
+}
+
+static hash_table_ops_t ntrans_table_ops = {
+	.hash = ntrans_hash,
+	.key_hash = ntrans_key_hash,
+	.key_equal = ntrans_key_equal,
+	.equal = NULL,
+	.remove_callback = ntrans_remove_callback
+};
+
+/** Make sure the translation table exists
+ *
+ * Must be called with ntrans_list_lock held.
+ *
+ * @return EOK on success
+ * @return ENOMEM if not enough memory
+ *
+ */
+static errno_t ntrans_table_init(void)
+{
+	if (ntrans_table_initialized)
+		return EOK;
+
+	if (!hash_table_create(&ntrans_table, 0, 0, &ntrans_table_ops))
+		return ENOMEM;
+
+	getuptime(&ntrans_last_purge);
+	ntrans_table_initialized = true;
+	return EOK;
+}
+
+/** Number of seconds since the entry last changed state */
+static time_t ntrans_age(inet_ntrans_t *ntrans, struct timespec *now)
+{
+	return now->tv_sec - ntrans->updated.tv_sec;
+}
+
+static bool ntrans_purge_expired(ht_link_t *item, void *arg)
+{
+	inet_ntrans_t *ntrans =
+	    hash_table_get_inst(item, inet_ntrans_t, ntrans_link);
+	struct timespec *now = (struct timespec *) arg;
+
+	switch (ntrans->state) {
+	case nts_incomplete:
+		/* Every new solicitation makes the entry young again */
+		if (ntrans_age(ntrans, now) >= NTRANS_INCOMPLETE_EXPIRE)
+			hash_table_remove_item(&ntrans_table, item);
+		break;
+	case nts_stale:
+		if (ntrans_age(ntrans, now) >= NTRANS_STALE_TIME)
+			hash_table_remove_item(&ntrans_table, item);
+		break;
+	case nts_reachable:
+		/* Entries nobody looks up only turn stale in lookup */
+		if (ntrans_age(ntrans, now) >= NTRANS_REACHABLE_TIME + NTRANS_STALE_TIME)
+			hash_table_remove_item(&ntrans_table, item);
+		break;
+	}
+
+	return true;
+}
+
+/** Discard expired entries once in a while
+ *
+ * Must be called with ntrans_list_lock held.
+ *
+ * @param now Current time
+ *
+ */
+static void ntrans_purge(struct timespec *now)
+{
+	if (now->tv_sec - ntrans_last_purge.tv_sec < NTRANS_PURGE_INTERVAL)
+		return;
+
+	hash_table_apply(&ntrans_table, ntrans_purge_expired, now);
+	ntrans_last_purge = *now;
+}
 
 /** Look for address in translation table
  *
@@ -55,15 +181,16 @@ static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
  */
 static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 {
-	list_foreach(ntrans_list, ntrans_list, inet_ntrans_t, ntrans) {
-		if (addr128_compare(ntrans->ip_addr, ip_addr))
-			return ntrans;
-	}
+	ht_link_t *link = hash_table_find(&ntrans_table, ip_addr);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, inet_ntrans_t, ntrans_link);
 }
 
 /** Add entry to translation table
+ *
+ * An existing entry for the same address is updated and marked reachable.
  *
  * @param ip_addr  IPv6 address of the new entry
  * @param mac_addr MAC address of the new entry
@@ -75,23 +202,35 @@ static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 errno_t ntrans_add(addr128_t ip_addr, addr48_t mac_addr)
 {
 	inet_ntrans_t *ntrans;
-	inet_ntrans_t *prev;
-
-	ntrans = calloc(1, sizeof(inet_ntrans_t));
-	if (ntrans == NULL)
-		return ENOMEM;
+	struct timespec now;
 
-	addr128(ip_addr, ntrans->ip_addr);
-	addr48(mac_addr, ntrans->mac_addr);
+	getuptime(&now);
 
 	fibril_mutex_lock(&ntrans_list_lock);
-	prev = ntrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->ntrans_list);
-		free(prev);
+	errno_t rc = ntrans_table_init();
+	if (rc != EOK) {
+		fibril_mutex_unlock(&ntrans_list_lock);
+		return rc;
+	}
+
+	ntrans_purge(&now);
+
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL) {
+		ntrans = calloc(1, sizeof(inet_ntrans_t));
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_list_lock);
+			return ENOMEM;
+		}
+
+		addr128(ip_addr, ntrans->ip_addr);
+		hash_table_insert(&ntrans_table, &ntrans->ntrans_link);
 	}
 
-	list_append(&ntrans->ntrans_list, &ntrans_list);
+	addr48(mac_addr, ntrans->mac_addr);
+	ntrans->state = nts_reachable;
+	ntrans->updated = now;
+
 	fibril_mutex_unlock(&ntrans_list_lock);
 	fibril_condvar_broadcast(&ntrans_cv);
 
@@ -108,62 +247,155 @@ errno_t ntrans_add(addr128_t ip_addr, addr48_t mac_addr)
  */
 errno_t ntrans_remove(addr128_t ip_addr)
 {
-	inet_ntrans_t *ntrans;
-
 	fibril_mutex_lock(&ntrans_list_lock);
-	ntrans = ntrans_find(ip_addr);
-	if (ntrans == NULL) {
+	if (!ntrans_table_initialized ||
+	    hash_table_remove(&ntrans_table, ip_addr) == 0) {
 		fibril_mutex_unlock(&ntrans_list_lock);
 		return ENOENT;
 	}
 
-	list_remove(&ntrans->ntrans_list);
 	fibril_mutex_unlock(&ntrans_list_lock);
-	free(ntrans);
-
 	return EOK;
 }
 
 /** Translate IPv6 address to MAC address using the translation table
+ *
+ * Must be called with ntrans_list_lock held.
  *
  * @param ip_addr  IPv6 address to be translated
  * @param mac_addr MAC address to be assigned
+ * @param refresh  Place to store true if the entry should be confirmed by
+ *                 sending a new solicitation, or NULL
  *
  * @return EOK on success
- * @return ENOENT when no such address found
+ * @return EAGAIN if a solicitation for the address is pending
+ * @return ENOENT if the caller should send a solicitation; an incomplete
+ *         entry is created so that other callers wait for the reply
+ * @return ENOMEM if not enough memory
  *
  */
-errno_t ntrans_lookup(addr128_t ip_addr, addr48_t mac_addr)
+static errno_t ntrans_lookup_locked(addr128_t ip_addr, addr48_t mac_addr,
+    bool *refresh)
 {
-	fibril_mutex_lock(&ntrans_list_lock);
+	struct timespec now;
+
+	getuptime(&now);
+
+	if (refresh != NULL)
+		*refresh = false;
+
+	errno_t rc = ntrans_table_init();
+	if (rc != EOK)
+		return rc;
+
+	ntrans_purge(&now);
+
 	inet_ntrans_t *ntrans = ntrans_find(ip_addr);
 	if (ntrans == NULL) {
-		fibril_mutex_unlock(&ntrans_list_lock);
+		ntrans = calloc(1, sizeof(inet_ntrans_t));
+		if (ntrans == NULL)
+			return ENOMEM;
+
+		addr128(ip_addr, ntrans->ip_addr);
+		ntrans->state = nts_incomplete;
+		ntrans->updated = now;
+		hash_table_insert(&ntrans_table, &ntrans->ntrans_link);
 		return ENOENT;
 	}
 
-	fibril_mutex_unlock(&ntrans_list_lock);
+	switch (ntrans->state) {
+	case nts_incomplete:
+		if (ntrans_age(ntrans, &now) < NTRANS_INCOMPLETE_TIME)
+			return EAGAIN;
+
+		/* The solicitation went unanswered, try again */
+		ntrans->updated = now;
+		return ENOENT;
+	case nts_reachable:
+		if (ntrans_age(ntrans, &now) >= NTRANS_REACHABLE_TIME) {
+			ntrans->state = nts_stale;
+			ntrans->updated = now;
+			if (refresh != NULL)
+				*refresh = true;
+		}
+		break;
+	case nts_stale:
+		if (ntrans_age(ntrans, &now) >= NTRANS_STALE_TIME) {
+			ntrans->state = nts_incomplete;
+			ntrans->updated = now;
+			return ENOENT;
+		}
+		break;
+	}
+
 	addr48(ntrans->mac_addr, mac_addr);
 	return EOK;
 }
 
-/** Wait on translation table CV for some time
+/** Translate IPv6 address to MAC address using the translation table
  *
- * @param timeout Timeout in microseconds
+ * @param ip_addr  IPv6 address to be translated
+ * @param mac_addr MAC address to be assigned
+ * @param refresh  Place to store true if the entry has just become stale
+ *                 and the caller should confirm it by sending a solicitation
  *
- * @return EOK if woken up by another fibril
- * @return ETIMEOUT if timed out
+ * @return EOK on success
+ * @return EAGAIN if a solicitation for the address is pending
+ * @return ENOENT if the caller should send a solicitation
+ * @return ENOMEM if not enough memory
  *
  */
-errno_t ntrans_wait_timeout(usec_t timeout)
+errno_t ntrans_lookup(addr128_t ip_addr, addr48_t mac_addr, bool *refresh)
 {
 	fibril_mutex_lock(&ntrans_list_lock);
-	errno_t rc = fibril_condvar_wait_timeout(&ntrans_cv, &ntrans_list_lock,
-	    timeout);
+	errno_t rc = ntrans_lookup_locked(ip_addr, mac_addr, refresh);
 	fibril_mutex_unlock(&ntrans_list_lock);
 
 	return rc;
 }
 
+/** Wait for a pending translation to complete
+ *
+ * @param ip_addr  IPv6 address to be translated
+ * @param timeout  Timeout in microseconds
+ * @param mac_addr MAC address to be assigned
+ *
+ * @return EOK on success
+ * @return ENOENT if the translation did not complete in time
+ *
+ */
+errno_t ntrans_lookup_timeout(addr128_t ip_addr, usec_t timeout,
+    addr48_t mac_addr)
+{
+	struct timespec deadline;
+	struct timespec now;
+	nsec_t remain;
+	errno_t rc;
+
+	getuptime(&deadline);
+	ts_add_diff(&deadline, USEC2NSEC(timeout));
+
+	fibril_mutex_lock(&ntrans_list_lock);
+
+	/* Other translations completing wake us up as well */
+	while ((rc = ntrans_lookup_locked(ip_addr, mac_addr, NULL)) == EAGAIN) {
+		getuptime(&now);
+		remain = ts_sub_diff(&deadline, &now);
+		if (remain <= 0)
+			break;
+
+		if (fibril_condvar_wait_timeout(&ntrans_cv, &ntrans_list_lock,
+		    NSEC2USEC(remain)) == ETIMEOUT)
+			break;
+	}
+
+	fibril_mutex_unlock(&ntrans_list_lock);
+
+	if (rc == EAGAIN)
+		rc = ENOENT;
+
+	return rc;
+}
+
 /** @}
  */
@@ -37,20 +37,37 @@
 #ifndef NTRANS_H_
 #define NTRANS_H_
 
+#include <adt/hash_table.h>
 #include <inet/iplink_srv.h>
 #include <inet/addr.h>
+#include <stdbool.h>
+#include <time.h>
+
+/** Neighbour cache entry state */
+typedef enum {
+	/** Solicitation has been sent, MAC address is not known yet */
+	nts_incomplete,
+	/** MAC address has been confirmed recently */
+	nts_reachable,
+	/** MAC address may be out of date and should be confirmed again */
+	nts_stale
+} inet_ntrans_state_t;
 
 /** Address translation table element */
 typedef struct {
-	link_t ntrans_list;
+	/** Link to ntrans_table */
+	ht_link_t ntrans_link;
 	addr128_t ip_addr;
 	addr48_t mac_addr;
+	inet_ntrans_state_t state;
+	/** Time of the last state change */
+	struct timespec updated;
 } inet_ntrans_t;
 
 extern errno_t ntrans_add(addr128_t, addr48_t);
 extern errno_t ntrans_remove(addr128_t);
-extern errno_t ntrans_lookup(addr128_t, addr48_t);
-extern errno_t ntrans_wait_timeout(usec_t);
+extern errno_t ntrans_lookup(addr128_t, addr48_t, bool *);
+extern errno_t ntrans_lookup_timeout(addr128_t, usec_t, addr48_t);
 
 #endif
 
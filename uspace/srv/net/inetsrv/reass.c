@@ -34,61 +34,160 @@
  * @brief Datagram reassembly.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "inetsrv.h"
 #include "inet_std.h"
 #include "reass.h"
 
-/** Datagram being reassembled.
+/** Time in seconds after which an incomplete datagram is discarded */
+#define REASS_TIMEOUT	30
+
+/** Maximum memory in bytes held by all datagrams being reassembled */
+#define REASS_MEM_MAX	(4 * 1024 * 1024)
+
+/** Datagram reassembly key.
  *
- * Uniquely identified by (source address, destination address, protocol,
- * identification) per RFC 791 sec. 2.3 / Fragmentation.
+ * Uniquely identifies a datagram by (source address, destination address,
+ * protocol, identification) per RFC 791 sec. 2.3 / Fragmentation.
  */
 typedef struct {
-	link_t map_link;
-	/** List of fragments, @c reass_frag_t */
-	list_t frags;
-} reass_dgram_t;
+	inet_addr_t src;
+	inet_addr_t dest;
+	uint8_t proto;
+	uint32_t ident;
+} reass_key_t;
 
-/** One datagram fragment */
+/** Hole in a datagram being reassembled, see RFC 815. */
 typedef struct {
 	link_t dgram_link;
-	inet_packet_t packet;
-} reass_frag_t;
+	/** Offset of the first missing byte */
+	size_t first;
+	/** Offset of the byte past the last missing byte */
+	size_t last;
+} reass_hole_t;
 
-/** Datagram map, list of reass_dgram_t */
-static LIST_INITIALIZE(reass_dgram_map);
+/** Datagram being reassembled. */
+typedef struct {
+	/** Link to reass_dgram_map */
+	ht_link_t map_link;
+	/** Link to reass_dgram_age, oldest first */
+	link_t age_link;
+	reass_key_t key;
+
+	/** Local link ID of the first received fragment */
+	service_id_t link_id;
+	/** Type of service of the first received fragment */
+	uint8_t tos;
+
+	/** Reassembly buffer */
+	uint8_t *data;
+	/** Allocated size of @c data */
+	size_t alloc_size;
+	/** Datagram size, known once the last fragment arrives */
+	size_t size;
+	/** Missing parts of the datagram, @c reass_hole_t */
+	list_t holes;
+
+	/** Time when the first fragment arrived */
+	struct timespec created;
+} reass_dgram_t;
+
+/** Datagram map, hash table of reass_dgram_t */
+static hash_table_t reass_dgram_map;
+static bool reass_dgram_map_initialized = false;
+/** Datagrams being reassembled, in the order of arrival */
+static LIST_INITIALIZE(reass_dgram_age);
+/** Memory in bytes held by reassembly buffers */
+static size_t reass_mem = 0;
 /** Protects access to @c reass_dgram_map */
 static FIBRIL_MUTEX_INITIALIZE(reass_dgram_map_lock);
 
-static reass_dgram_t *reass_dgram_new(void);
 static reass_dgram_t *reass_dgram_get(inet_packet_t *);
 static errno_t reass_dgram_insert_frag(reass_dgram_t *, inet_packet_t *);
 static bool reass_dgram_complete(reass_dgram_t *);
 static void reass_dgram_remove(reass_dgram_t *);
 static errno_t reass_dgram_deliver(reass_dgram_t *);
 static void reass_dgram_destroy(reass_dgram_t *);
+static void reass_expire(struct timespec *);
+
+static size_t reass_key_hash(void *arg)
+{
+	reass_key_t *key = (reass_key_t *) arg;
+	size_t hash;
+
+	hash = inet_addr_hash(&key->src);
+	hash = hash_combine(hash, inet_addr_hash(&key->dest));
+	hash = hash_combine(hash, key->proto);
+	hash = hash_combine(hash, key->ident);
+	return hash;
+}
+
+static size_t reass_dgram_hash(const ht_link_t *item)
+{
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t,
+	    map_link);
+	return reass_key_hash(&rdg->key);
+}
+
+static bool reass_key_equal(void *arg, const ht_link_t *item)
+{
+	reass_key_t *key = (reass_key_t *) arg;
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t,
+	    map_link);
+
+	return inet_addr_compare(&rdg->key.src, &key->src) &&
+	    inet_addr_compare(&rdg->key.dest, &key->dest) &&
+	    rdg->key.proto == key->proto &&
+	    rdg->key.ident == key->ident;
+}
+
+static hash_table_ops_t reass_dgram_map_ops = {
+	.hash = reass_dgram_hash,
+	.key_hash = reass_key_hash,
+	.key_equal = reass_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
 
 /** Queue packet for datagram reassembly.
  *
  * @param packet	Packet
- * @return		EOK on success or ENOMEM.
+ * @return		EOK on success, ENOMEM or ELIMIT.
  */
 errno_t inet_reass_queue_packet(inet_packet_t *packet)
 {
 	reass_dgram_t *rdg;
+	struct timespec now;
 	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_reass_queue_packet()");
 
+	getuptime(&now);
+
 	fibril_mutex_lock(&reass_dgram_map_lock);
 
+	if (!reass_dgram_map_initialized) {
+		if (!hash_table_create(&reass_dgram_map, 0, 0,
+		    &reass_dgram_map_ops)) {
+			fibril_mutex_unlock(&reass_dgram_map_lock);
+			return ENOMEM;
+		}
+
+		reass_dgram_map_initialized = true;
+	}
+
+	/* Drop datagrams which have timed out */
+	reass_expire(&now);
+
 	/* Get existing or new datagram */
 	rdg = reass_dgram_get(packet);
 	if (rdg == NULL) {
@@ -100,8 +199,13 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 
 	/* Insert fragment into the datagram */
 	rc = reass_dgram_insert_frag(rdg, packet);
-	if (rc != EOK)
-		return ENOMEM;
+	if (rc != EOK) {
+		/* The datagram cannot be completed any more, drop it */
+		reass_dgram_remove(rdg);
+		fibril_mutex_unlock(&reass_dgram_map_lock);
+		reass_dgram_destroy(rdg);
+		return rc;
+	}
 
 	/* Check if datagram is complete */
 	if (reass_dgram_complete(rdg)) {
@@ -115,117 +219,194 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 		return rc;
 	}
 
+	/* Evict the oldest datagrams if we are using too much memory */
+	while (reass_mem > REASS_MEM_MAX) {
+		reass_dgram_t *oldest = list_get_instance(
+		    list_first(&reass_dgram_age), reass_dgram_t, age_link);
+
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly memory exhausted, "
+		    "dropping datagram.");
+		reass_dgram_remove(oldest);
+		reass_dgram_destroy(oldest);
+	}
+
 	fibril_mutex_unlock(&reass_dgram_map_lock);
 	return EOK;
 }
 
-/** Get datagram reassembly structure for packet.
+/** Drop datagrams which could not be reassembled in time.
  *
- * @param packet	Packet
- * @return		Datagram reassembly structure matching @a packet
+ * @param now		Current time
  */
-static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
+static void reass_expire(struct timespec *now)
 {
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 
-	list_foreach(reass_dgram_map, map_link, reass_dgram_t, rdg) {
-		link_t *f1_link = list_first(&rdg->frags);
-		assert(f1_link != NULL);
+	while (!list_empty(&reass_dgram_age)) {
+		reass_dgram_t *rdg = list_get_instance(
+		    list_first(&reass_dgram_age), reass_dgram_t, age_link);
 
-		reass_frag_t *f1 = list_get_instance(f1_link, reass_frag_t,
-		    dgram_link);
+		if (now->tv_sec - rdg->created.tv_sec < REASS_TIMEOUT)
+			break;
 
-		if ((inet_addr_compare(&f1->packet.src, &packet->src)) &&
-		    (inet_addr_compare(&f1->packet.dest, &packet->dest)) &&
-		    (f1->packet.proto == packet->proto) &&
-		    (f1->packet.ident == packet->ident)) {
-			/* Match */
-			return rdg;
-		}
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly timed out, "
+		    "dropping datagram.");
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
 	}
-
-	/* No existing reassembly structure. Create a new one. */
-	return reass_dgram_new();
 }
 
-/** Create new datagram reassembly structure.
+/** Get datagram reassembly structure for packet.
  *
- * @return New datagram reassembly structure.
+ * @param packet	Packet
+ * @return		Datagram reassembly structure matching @a packet
  */
-static reass_dgram_t *reass_dgram_new(void)
+static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
 {
+	reass_key_t key;
 	reass_dgram_t *rdg;
+	reass_hole_t *hole;
 
+	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+
+	key.src = packet->src;
+	key.dest = packet->dest;
+	key.proto = packet->proto;
+	key.ident = packet->ident;
+
+	ht_link_t *link = hash_table_find(&reass_dgram_map, &key);
+	if (link != NULL)
+		return hash_table_get_inst(link, reass_dgram_t, map_link);
+
+	/* No existing reassembly structure. Create a new one. */
 	rdg = calloc(1, sizeof(reass_dgram_t));
 	if (rdg == NULL)
 		return NULL;
 
-	list_append(&rdg->map_link, &reass_dgram_map);
-	list_initialize(&rdg->frags);
+	/* Initially the whole datagram is missing */
+	hole = calloc(1, sizeof(reass_hole_t));
+	if (hole == NULL) {
+		free(rdg);
+		return NULL;
+	}
+
+	hole->first = 0;
+	hole->last = SIZE_MAX;
+
+	rdg->key = key;
+	rdg->link_id = packet->link_id;
+	rdg->tos = packet->tos;
+	rdg->size = SIZE_MAX;
+	list_initialize(&rdg->holes);
+	list_append(&hole->dgram_link, &rdg->holes);
+	getuptime(&rdg->created);
+
+	hash_table_insert(&reass_dgram_map, &rdg->map_link);
+	list_append(&rdg->age_link, &reass_dgram_age);
 
 	return rdg;
 }
 
-static reass_frag_t *reass_frag_new(void)
+/** Make sure the reassembly buffer can hold @a size bytes.
+ *
+ * @param rdg		Datagram reassembly structure
+ * @param size		Required size
+ * @return		EOK on success or ENOMEM
+ */
+static errno_t reass_dgram_reserve(reass_dgram_t *rdg, size_t size)
 {
-	reass_frag_t *frag;
+	if (size <= rdg->alloc_size)
+		return EOK;
 
-	frag = calloc(1, sizeof(reass_frag_t));
-	if (frag == NULL)
-		return NULL;
-
-	link_initialize(&frag->dgram_link);
+	/* Grow geometrically to avoid copying on every fragment */
+	size_t nsize = max(size, 2 * rdg->alloc_size);
+	uint8_t *ndata = realloc(rdg->data, nsize);
+	if (ndata == NULL)
+		return ENOMEM;
 
-	return frag;
+	reass_mem += nsize - rdg->alloc_size;
+	rdg->data = ndata;
+	rdg->alloc_size = nsize;
+	return EOK;
 }
 
+/** Insert fragment into datagram.
+ *
+ * The fragment data is copied directly to its place in the reassembly
+ * buffer and the list of holes is updated according to RFC 815.
+ *
+ * @param rdg		Datagram reassembly structure
+ * @param packet	Fragment
+ * @return		EOK on success, ENOMEM or ELIMIT
+ */
 static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet)
 {
-	reass_frag_t *frag;
-	void *data_copy;
-	link_t *link;
+	size_t fragoff_limit;
+	size_t first = packet->offs;
+	size_t last = packet->offs + packet->size;
+	errno_t rc;
 
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 
-	frag = reass_frag_new();
-
-	/* Clone the packet */
+	/* Upper bound for fragment offset field */
+	fragoff_limit = 1 << (FF_FRAGOFF_h - FF_FRAGOFF_l + 1);
 
-	data_copy = malloc(packet->size);
-	if (data_copy == NULL) {
-		free(frag);
-		return ENOMEM;
-	}
+	/* Verify that total size of datagram is within reasonable bounds */
+	if (last > FRAG_OFFS_UNIT * fragoff_limit)
+		return ELIMIT;
 
-	memcpy(data_copy, packet->data, packet->size);
+	/* Fragments must not extend past the end of the datagram */
+	if (last > rdg->size || (!packet->mf && last < rdg->size &&
+	    rdg->size != SIZE_MAX))
+		return EINVAL;
 
-	frag->packet = *packet;
-	frag->packet.data = data_copy;
+	rc = reass_dgram_reserve(rdg, last);
+	if (rc != EOK)
+		return rc;
 
-	/*
-	 * XXX Make resource-consuming attacks harder, eliminate any duplicate
-	 * data immediately. Possibly eliminate redundant packet headers.
-	 */
+	memcpy(rdg->data + first, packet->data, packet->size);
 
-	/*
-	 * Insert into the list, which is sorted by offs member ascending.
-	 */
+	if (!packet->mf)
+		rdg->size = last;
 
-	link = list_first(&rdg->frags);
-	while (link != NULL) {
-		reass_frag_t *qf = list_get_instance(link, reass_frag_t,
+	list_foreach_safe(rdg->holes, cur, next) {
+		reass_hole_t *hole = list_get_instance(cur, reass_hole_t,
 		    dgram_link);
 
-		if (qf->packet.offs >= packet->offs)
-			break;
+		/* Discard the part of the hole beyond the end of datagram */
+		if (hole->last > rdg->size)
+			hole->last = rdg->size;
 
-		link = list_next(link, &rdg->frags);
-	}
+		if (hole->first >= hole->last) {
+			list_remove(&hole->dgram_link);
+			free(hole);
+			continue;
+		}
 
-	if (link != NULL)
-		list_insert_after(&frag->dgram_link, link);
-	else
-		list_append(&frag->dgram_link, &rdg->frags);
+		/* Fragment does not touch this hole */
+		if (first >= hole->last || last <= hole->first)
+			continue;
+
+		/* The fragment fills the hole at least partially */
+		if (first > hole->first && last < hole->last) {
+			/* Split the hole in two */
+			reass_hole_t *nhole = calloc(1, sizeof(reass_hole_t));
+			if (nhole == NULL)
+				return ENOMEM;
+
+			nhole->first = last;
+			nhole->last = hole->last;
+			hole->last = first;
+			list_insert_after(&nhole->dgram_link, &hole->dgram_link);
+		} else if (first > hole->first) {
+			hole->last = first;
+		} else if (last < hole->last) {
+			hole->first = last;
+		} else {
+			list_remove(&hole->dgram_link);
+			free(hole);
+		}
+	}
 
 	return EOK;
 }
@@ -237,42 +418,9 @@ static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet
  */
 static bool reass_dgram_complete(reass_dgram_t *rdg)
 {
-	reass_frag_t *frag, *prev;
-	link_t *link;
-
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	assert(!list_empty(&rdg->frags));
-
-	link = list_first(&rdg->frags);
-	assert(link != NULL);
-
-	frag = list_get_instance(link, reass_frag_t,
-	    dgram_link);
-
-	/* First fragment must be at offset zero */
-	if (frag->packet.offs != 0)
-		return false;
-
-	prev = frag;
-
-	while (true) {
-		link = list_next(link, &rdg->frags);
-		if (link == NULL)
-			break;
 
-		/* Each next fragment must follow immediately or overlap */
-		frag = list_get_instance(link, reass_frag_t, dgram_link);
-		if (frag->packet.offs > prev->packet.offs + prev->packet.size)
-			return false;
-
-		/* No more fragments - datagram is complete */
-		if (!frag->packet.mf)
-			return true;
-
-		prev = frag;
-	}
-
-	return false;
+	return list_empty(&rdg->holes);
 }
 
 /** Remove datagram from reassembly map.
@@ -282,7 +430,9 @@ static bool reass_dgram_complete(reass_dgram_t *rdg)
 static void reass_dgram_remove(reass_dgram_t *rdg)
 {
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	list_remove(&rdg->map_link);
+	hash_table_remove_item(&reass_dgram_map, &rdg->map_link);
+	list_remove(&rdg->age_link);
+	reass_mem -= rdg->alloc_size;
 }
 
 /** Deliver complete datagram.
@@ -291,72 +441,17 @@ static void reass_dgram_remove(reass_dgram_t *rdg)
  */
 static errno_t reass_dgram_deliver(reass_dgram_t *rdg)
 {
-	size_t dgram_size;
-	size_t fragoff_limit;
 	inet_dgram_t dgram;
-	uint8_t proto;
-	reass_frag_t *frag;
-	errno_t rc;
-
-	/*
-	 * Potentially there could be something beyond the first packet
-	 * that has !MF. Make sure we ignore that.
-	 */
-	frag = NULL;
-	list_foreach(rdg->frags, dgram_link, reass_frag_t, cfrag) {
-		if (!cfrag->packet.mf) {
-			frag = cfrag;
-			break;
-		}
-	}
-
-	assert(frag != NULL);
-	assert(!frag->packet.mf);
-
-	dgram_size = frag->packet.offs + frag->packet.size;
-
-	/* Upper bound for fragment offset field */
-	fragoff_limit = 1 << (FF_FRAGOFF_h - FF_FRAGOFF_l + 1);
-
-	/* Verify that total size of datagram is within reasonable bounds */
-	if (dgram_size > FRAG_OFFS_UNIT * fragoff_limit)
-		return ELIMIT;
-
-	dgram.data = calloc(dgram_size, 1);
-	if (dgram.data == NULL)
-		return ENOMEM;
 
 	/* XXX What if different fragments came from different link? */
-	dgram.iplink = frag->packet.link_id;
-	dgram.size = dgram_size;
-	dgram.src = frag->packet.src;
-	dgram.dest = frag->packet.dest;
-	dgram.tos = frag->packet.tos;
-	proto = frag->packet.proto;
-
-	/* Pull together data from individual fragments */
-
-	size_t doffs = 0;
-
-	list_foreach(rdg->frags, dgram_link, reass_frag_t, cfrag) {
-		size_t cb, ce;
-
-		cb = max(doffs, cfrag->packet.offs);
-		ce = min(dgram_size, cfrag->packet.offs + cfrag->packet.size);
-
-		if (ce > cb) {
-			memcpy(dgram.data + cb,
-			    cfrag->packet.data + cb - cfrag->packet.offs,
-			    ce - cb);
-		}
-
-		if (!cfrag->packet.mf)
-			break;
-	}
-
-	rc = inet_recv_dgram_local(&dgram, proto);
-	free(dgram.data);
-	return rc;
+	dgram.iplink = rdg->link_id;
+	dgram.data = rdg->data;
+	dgram.size = rdg->size;
+	dgram.src = rdg->key.src;
+	dgram.dest = rdg->key.dest;
+	dgram.tos = rdg->tos;
+
+	return inet_recv_dgram_local(&dgram, rdg->key.proto);
 }
 
 /** Destroy datagram reassembly structure.
@@ -365,16 +460,16 @@ static errno_t reass_dgram_deliver(reass_dgram_t *rdg)
  */
 static void reass_dgram_destroy(reass_dgram_t *rdg)
 {
-	while (!list_empty(&rdg->frags)) {
-		link_t *flink = list_first(&rdg->frags);
-		reass_frag_t *frag = list_get_instance(flink, reass_frag_t,
+	while (!list_empty(&rdg->holes)) {
+		link_t *hlink = list_first(&rdg->holes);
+		reass_hole_t *hole = list_get_instance(hlink, reass_hole_t,
 		    dgram_link);
 
-		list_remove(&frag->dgram_link);
-		free(frag->packet.data);
-		free(frag);
+		list_remove(&hole->dgram_link);
+		free(hole);
 	}
 
+	free(rdg->data);
 	free(rdg);
 }
 
@@ -34,6 +34,7 @@
  * @brief
  */
 
+#include <adt/hash_table.h>
 #include <bitops.h>
 #include <errno.h>
 #include <fibril_synch.h>
@@ -45,10 +46,226 @@
 #include "inetsrv.h"
 #include "inet_link.h"
 
+/** Maximum number of destinations remembered in the route cache */
+#define SROUTE_CACHE_MAX	1024
+
+/** Node of a binary trie of static routes
+ *
+ * A node at depth @c n corresponds to the network prefix given by the path
+ * from the root and of length @c n bits.
+ */
+typedef struct sroute_node {
+	struct sroute_node *parent;
+	struct sroute_node *child[2];
+	/** Routes to this network prefix (of inet_sroute_t) */
+	list_t routes;
+} sroute_node_t;
+
+/** Route cache entry */
+typedef struct {
+	ht_link_t cache_link;
+	/** Destination address */
+	inet_addr_t dest;
+	/** Route to @c dest or @c NULL if there is none */
+	inet_sroute_t *sroute;
+} sroute_cache_entry_t;
+
 static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
 static sysarg_t sroute_id = 0;
 
+/** Routing trie roots for IPv4 and IPv6 */
+static sroute_node_t *sroute_root4 = NULL;
+static sroute_node_t *sroute_root6 = NULL;
+
+/** Per-destination route cache (of sroute_cache_entry_t) */
+static hash_table_t sroute_cache;
+static bool sroute_cache_initialized = false;
+
+static size_t sroute_cache_key_hash(void *key)
+{
+	return inet_addr_hash((inet_addr_t *) key);
+}
+
+static size_t sroute_cache_hash(const ht_link_t *item)
+{
+	sroute_cache_entry_t *entry =
+	    hash_table_get_inst(item, sroute_cache_entry_t, cache_link);
+	return sroute_cache_key_hash(&entry->dest);
+}
+
+static bool sroute_cache_key_equal(void *key, const ht_link_t *item)
+{
+	sroute_cache_entry_t *entry =
+	    hash_table_get_inst(item, sroute_cache_entry_t, cache_link);
+	return inet_addr_compare(&entry->dest, (inet_addr_t *) key);
+}
+
+static void sroute_cache_remove_callback(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, sroute_cache_entry_t, cache_link));
+}
+
+static hash_table_ops_t sroute_cache_ops = {
+	.hash = sroute_cache_hash,
+	.key_hash = sroute_cache_key_hash,
+	.key_equal = sroute_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = sroute_cache_remove_callback
+};
+
+/** Forget all cached routes.
+ *
+ * Must be called with sroute_list_lock held whenever the set of routes
+ * changes.
+ */
+static void sroute_cache_flush(void)
+{
+	if (sroute_cache_initialized)
+		hash_table_clear(&sroute_cache);
+}
+
+/** Get bit @a i of an address, counting from the most significant one. */
+static unsigned sroute_addr_bit(ip_ver_t ver, addr32_t v4, addr128_t v6,
+    unsigned i)
+{
+	if (ver == ip_v4)
+		return (v4 >> (31 - i)) & 1;
+
+	return (v6[i / 8] >> (7 - i % 8)) & 1;
+}
+
+/** Find trie node for network @a dest.
+ *
+ * @param dest   Destination network
+ * @param create Create the node and the path to it if they do not exist
+ *
+ * @return Trie node or @c NULL if not found or out of memory
+ */
+static sroute_node_t *sroute_node_get(inet_naddr_t *dest, bool create)
+{
+	addr32_t v4;
+	addr128_t v6;
+	uint8_t bits;
+	ip_ver_t ver = inet_naddr_get(dest, &v4, &v6, &bits);
+	sroute_node_t **rootp;
+
+	switch (ver) {
+	case ip_v4:
+		rootp = &sroute_root4;
+		break;
+	case ip_v6:
+		rootp = &sroute_root6;
+		break;
+	default:
+		return NULL;
+	}
+
+	if (*rootp == NULL) {
+		if (!create)
+			return NULL;
+
+		*rootp = calloc(1, sizeof(sroute_node_t));
+		if (*rootp == NULL)
+			return NULL;
+
+		list_initialize(&(*rootp)->routes);
+	}
+
+	sroute_node_t *node = *rootp;
+	for (unsigned i = 0; i < bits; i++) {
+		unsigned bit = sroute_addr_bit(ver, v4, v6, i);
+		if (node->child[bit] == NULL) {
+			if (!create)
+				return NULL;
+
+			sroute_node_t *child = calloc(1, sizeof(sroute_node_t));
+			if (child == NULL)
+				return NULL;
+
+			list_initialize(&child->routes);
+			child->parent = node;
+			node->child[bit] = child;
+		}
+
+		node = node->child[bit];
+	}
+
+	return node;
+}
+
+/** Free trie nodes which no longer lead to any route.
+ *
+ * @param node Node from which to start pruning towards the root
+ */
+static void sroute_node_prune(sroute_node_t *node)
+{
+	while (node != NULL && list_empty(&node->routes) &&
+	    node->child[0] == NULL && node->child[1] == NULL) {
+		sroute_node_t *parent = node->parent;
+
+		if (parent == NULL) {
+			if (node == sroute_root4)
+				sroute_root4 = NULL;
+			else
+				sroute_root6 = NULL;
+		} else if (parent->child[0] == node) {
+			parent->child[0] = NULL;
+		} else {
+			parent->child[1] = NULL;
+		}
+
+		free(node);
+		node = parent;
+	}
+}
+
+/** Longest prefix match lookup in the routing trie.
+ *
+ * Must be called with sroute_list_lock held.
+ *
+ * @param addr Destination address
+ * @return Most specific route to @a addr or @c NULL
+ */
+static inet_sroute_t *sroute_trie_lookup(inet_addr_t *addr)
+{
+	addr32_t v4;
+	addr128_t v6;
+	ip_ver_t ver = inet_addr_get(addr, &v4, &v6);
+	sroute_node_t *node;
+	unsigned bits;
+
+	switch (ver) {
+	case ip_v4:
+		node = sroute_root4;
+		bits = 32;
+		break;
+	case ip_v6:
+		node = sroute_root6;
+		bits = 128;
+		break;
+	default:
+		return NULL;
+	}
+
+	inet_sroute_t *best = NULL;
+	unsigned i = 0;
+
+	while (node != NULL) {
+		if (!list_empty(&node->routes)) {
+			best = list_get_instance(list_first(&node->routes),
+			    inet_sroute_t, fib_list);
+		}
+
+		if (i == bits)
+			break;
+
+		node = node->child[sroute_addr_bit(ver, v4, v6, i++)];
+	}
+
+	return best;
+}
+
 inet_sroute_t *inet_sroute_new(void)
 {
 	inet_sroute_t *sroute = calloc(1, sizeof(inet_sroute_t));
@@ -60,6 +277,7 @@ inet_sroute_t *inet_sroute_new(void)
 	}
 
 	link_initialize(&sroute->sroute_list);
+	link_initialize(&sroute->fib_list);
 	fibril_mutex_lock(&sroute_list_lock);
 	sroute->id = ++sroute_id;
 	fibril_mutex_unlock(&sroute_list_lock);
@@ -78,6 +296,16 @@ void inet_sroute_add(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
 	list_append(&sroute->sroute_list, &sroute_list);
+
+	sroute_node_t *node = sroute_node_get(&sroute->dest, true);
+	if (node != NULL) {
+		list_append(&sroute->fib_list, &node->routes);
+	} else {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed adding static route "
+		    "to routing table. Out of memory.");
+	}
+
+	sroute_cache_flush();
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
@@ -85,47 +313,65 @@ void inet_sroute_remove(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
 	list_remove(&sroute->sroute_list);
+
+	if (link_in_use(&sroute->fib_list)) {
+		list_remove(&sroute->fib_list);
+		sroute_node_prune(sroute_node_get(&sroute->dest, false));
+	}
+
+	sroute_cache_flush();
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
 /** Find static route object matching address @a addr.
+ *
+ * The most specific route is looked up in the routing trie of the respective
+ * address family and remembered in the route cache.
  *
  * @param addr	Address
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
-	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
+	inet_sroute_t *best;
 
 	fibril_mutex_lock(&sroute_list_lock);
 
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
+	if (!sroute_cache_initialized) {
+		sroute_cache_initialized = hash_table_create(&sroute_cache, 0,
+		    0, &sroute_cache_ops);
+	}
 
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
+	if (sroute_cache_initialized) {
+		ht_link_t *link = hash_table_find(&sroute_cache, addr);
+		if (link != NULL) {
+			best = hash_table_get_inst(link, sroute_cache_entry_t,
+			    cache_link)->sroute;
+			fibril_mutex_unlock(&sroute_list_lock);
+			return best;
+		}
+	}
 
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
+	best = sroute_trie_lookup(addr);
+	if (best != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found %p",
+		    best);
+	} else {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
+	}
 
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
+	if (sroute_cache_initialized) {
+		if (hash_table_size(&sroute_cache) >= SROUTE_CACHE_MAX)
+			hash_table_clear(&sroute_cache);
 
-			best = sroute;
-			best_bits = dest_bits;
+		sroute_cache_entry_t *entry =
+		    calloc(1, sizeof(sroute_cache_entry_t));
+		if (entry != NULL) {
+			entry->dest = *addr;
+			entry->sroute = best;
+			hash_table_insert(&sroute_cache, &entry->cache_link);
 		}
 	}
 
-	if (best == NULL)
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
-
 	fibril_mutex_unlock(&sroute_list_lock);
 
 	return best;